@@ -0,0 +1,148 @@
+// Times scans of tables of more or less compressible data, stored uncompressed and LZ4 compressed
+// Usage: bench_compression [num_rows] [num_scans]
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "compression.h"
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/scan_aggregate.h"
+#include "zone_map.h"
+
+#define BENCH_PATH "bench_compression.dat"
+#define DEFAULT_ROWS 100000
+#define DEFAULT_SCANS 10
+#define BENCH_STRING_COUNT 3
+#define BENCH_STRING_SIZE 32
+#define BENCH_DISTINCT_VALUES 40
+
+// How much of each string is random: none of it, an 8 character suffix or all of it
+typedef enum { DATA_REPETITIVE, DATA_MIXED, DATA_RANDOM } data_shape_t;
+static const char* shape_names[] = {"repetitive", "mixed", "random"};
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void fill_string(char* text, data_shape_t shape, long row, int column, uint32_t* seed) {
+  // BENCH_STRING_SIZE characters, the value has two digits
+  snprintf(text, BENCH_STRING_SIZE + 1, "location-%02lu-of-a-low-cardinality",
+           (unsigned long)(row * 7919 + column) % BENCH_DISTINCT_VALUES);
+  size_t random_from = shape == DATA_RANDOM ? 0 : shape == DATA_MIXED ? BENCH_STRING_SIZE - 8 : BENCH_STRING_SIZE;
+  for (size_t i = random_from; i < BENCH_STRING_SIZE; i++) {
+    *seed = *seed * 1103515245u + 12345u;
+    text[i] = (char)('!' + (*seed >> 16) % 94);
+  }
+  text[BENCH_STRING_SIZE] = '\0';
+}
+
+static int64_t run_scans(dbms_session_t* session, long num_scans, bool is_cold) {
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 1}};
+  int64_t sum = 0;
+  for (long scan = 0; scan < num_scans; scan++) {
+    // Drops the clean table pages from the OS page cache, so the scan reads the device
+    if (is_cold) {
+      posix_fadvise(session->fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    Operator* op = scan_aggregate_create(session, NULL, aggregates, 2, NULL);
+    OP_OPEN(op);
+    tuple_t* result = OP_NEXT(op);
+    sum += result ? result->attributes[1].int_value : 0;
+    OP_CLOSE(op);
+    operator_free(op);
+  }
+  return sum;
+}
+
+static void run_compression(data_shape_t shape, uint8_t compression, long num_rows, long num_scans) {
+  // Null byte, two INTs and three 32-byte strings, padded to 112 bytes
+  catalog_record_t records[3 + BENCH_STRING_COUNT] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0},
+                                                      {"value", 4, ATTRIBUTE_TYPE_INT, 1}};
+  for (int i = 0; i < BENCH_STRING_COUNT; i++) {
+    catalog_record_t* record = &records[2 + i];
+    snprintf(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE, "text%d", i);
+    record->attribute_size = BENCH_STRING_SIZE;
+    record->attribute_type = ATTRIBUTE_TYPE_STRING;
+    record->attribute_order = 2 + i;
+  }
+  records[2 + BENCH_STRING_COUNT] = (catalog_record_t){PADDING_NAME, 7, ATTRIBUTE_TYPE_UNUSED, 2 + BENCH_STRING_COUNT};
+  system_catalog_t catalog = {.records = records,
+                              .record_count = 3 + BENCH_STRING_COUNT,
+                              .tuple_size = NULL_BYTE_SIZE + 8 + BENCH_STRING_COUNT * BENCH_STRING_SIZE + 7,
+                              .compression = compression};
+  dbms_create_table(BENCH_PATH, &catalog);
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    exit(1);
+  }
+  dbms_add_session(manager, session);
+  char name[32];
+  snprintf(name, sizeof(name), "%s/%s", shape_names[shape], compression == CATALOG_COMPRESSION_LZ4 ? "lz4" : "none");
+
+  char texts[BENCH_STRING_COUNT][BENCH_STRING_SIZE + 1];
+  uint32_t seed = 1;
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[2 + BENCH_STRING_COUNT] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i},
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)((i * 7919) % 1000)}};
+    for (int j = 0; j < BENCH_STRING_COUNT; j++) {
+      fill_string(texts[j], shape, i, j, &seed);
+      attrs[2 + j] = (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING, .string_value = texts[j]};
+    }
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      exit(1);
+    }
+  }
+  dbms_flush_buffer_pool(session);
+  double fill_time = elapsed_seconds(&start);
+
+  uint64_t page_bytes = (uint64_t)session->page_count * dbms_page_size(session->catalog);
+  uint64_t stored_bytes = session->compression_map ? compression_map_stored_size(session->compression_map) : page_bytes;
+  printf("%-16s fill:  %ld rows on %u pages in %.3f s, %.2f MB stored (ratio %.2f)\n", name, num_rows,
+         session->page_count, fill_time, stored_bytes / 1e6, (double)page_bytes / stored_bytes);
+
+  // Every scan reads all pages: the buffer pool holds BUFFER_POOL_SIZE frames
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int64_t sum = run_scans(session, num_scans, false);
+  double warm_time = elapsed_seconds(&start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  sum += run_scans(session, num_scans, true);
+  double cold_time = elapsed_seconds(&start);
+  printf("%-16s scan:  cached %.2f ns/row, uncached %.2f ns/row, %.2f MB read per scan (sum %lld)\n", name,
+         warm_time * 1e9 / ((double)num_rows * num_scans), cold_time * 1e9 / ((double)num_rows * num_scans),
+         stored_bytes / 1e6, (long long)sum);
+
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(BENCH_PATH COMPRESSION_MAP_FILE_EXTENSION);
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_scans = argc > 2 ? atol(argv[2]) : DEFAULT_SCANS;
+  if (num_rows <= 0 || num_scans <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_scans]\n", argv[0]);
+    return 1;
+  }
+
+  data_shape_t shapes[] = {DATA_REPETITIVE, DATA_MIXED, DATA_RANDOM};
+  for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+    run_compression(shapes[i], CATALOG_COMPRESSION_NONE, num_rows, num_scans);
+    run_compression(shapes[i], CATALOG_COMPRESSION_LZ4, num_rows, num_scans);
+  }
+  return 0;
+}
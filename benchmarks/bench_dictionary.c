@@ -0,0 +1,139 @@
+// Times string equality scans of a table with low-cardinality string columns, stored plain and dictionary encoded
+// Usage: bench_dictionary [num_rows] [num_scans]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dbms.h"
+#include "dictionary.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "zone_map.h"
+
+#define BENCH_PATH "bench_dictionary.dat"
+#define DEFAULT_ROWS 100000
+#define DEFAULT_SCANS 10
+#define BENCH_STRING_COUNT 3
+#define BENCH_STRING_SIZE 32
+#define BENCH_DISTINCT_VALUES 40
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void run_encoding(bool is_encoded, long num_rows, long num_scans) {
+  // Plain: null byte, an INT and three 32-byte strings, padded to 104 bytes. Encoded: 2-byte codes, 16 bytes.
+  catalog_record_t records[2 + BENCH_STRING_COUNT] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0}};
+  for (int i = 0; i < BENCH_STRING_COUNT; i++) {
+    catalog_record_t* record = &records[1 + i];
+    snprintf(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE, "text%d", i);
+    record->attribute_size = BENCH_STRING_SIZE;
+    record->attribute_type = ATTRIBUTE_TYPE_STRING;
+    record->attribute_order = 1 + i;
+  }
+  records[1 + BENCH_STRING_COUNT] = (catalog_record_t){PADDING_NAME, 3, ATTRIBUTE_TYPE_UNUSED, 1 + BENCH_STRING_COUNT};
+  system_catalog_t catalog = {.records = records, .record_count = 2 + BENCH_STRING_COUNT};
+  if (is_encoded) {
+    for (int i = 0; i < BENCH_STRING_COUNT; i++) {
+      dbms_set_dictionary_encoded(&catalog, 1 + i);
+    }
+    records[1 + BENCH_STRING_COUNT].attribute_size = 5;
+  }
+  catalog.tuple_size = NULL_BYTE_SIZE;
+  for (uint8_t i = 0; i < catalog.record_count; i++) {
+    catalog.tuple_size += dbms_get_stored_size(&catalog, i);
+  }
+  dbms_create_table(BENCH_PATH, &catalog);
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    exit(1);
+  }
+  dbms_add_session(manager, session);
+  const char* name = is_encoded ? "dictionary" : "plain";
+
+  char values[BENCH_DISTINCT_VALUES][BENCH_STRING_SIZE + 1];
+  for (int i = 0; i < BENCH_DISTINCT_VALUES; i++) {
+    snprintf(values[i], sizeof(values[i]), "location-%02d-of-a-low-cardinality", i);
+  }
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[1 + BENCH_STRING_COUNT] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i}};
+    for (int j = 0; j < BENCH_STRING_COUNT; j++) {
+      attrs[1 + j] = (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING,
+                                         .string_value = values[(i * 7919 + j) % BENCH_DISTINCT_VALUES]};
+    }
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      exit(1);
+    }
+  }
+  dbms_flush_buffer_pool(session);
+  printf("%-10s fill:      %ld rows on %u pages (%llu per page) in %.3f s\n", name, num_rows, session->page_count,
+         (unsigned long long)dbms_catalog_tuples_per_page(session->catalog), elapsed_seconds(&start));
+
+  // 2.5% selectivity on one string column
+  proposition_t proposition = {.attribute_index = 1,
+                               .operator= OPERATOR_EQUAL,
+                               .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = values[7]}};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  aggregate_t aggregate = {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR};
+
+  // Raw page kernels: code compare (or strncmp) into the predicate mask
+  int64_t matched = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* op = scan_aggregate_create(session, &criteria, &aggregate, 1, NULL);
+    OP_OPEN(op);
+    tuple_t* result = OP_NEXT(op);
+    matched += result ? result->attributes[0].int_value : 0;
+    OP_CLOSE(op);
+    operator_free(op);
+  }
+  double aggregate_time = elapsed_seconds(&start);
+  printf("%-10s aggregate: %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, aggregate_time,
+         aggregate_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+
+  // Decoded tuples through SeqScan -> Filter
+  matched = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* filter = filter_create(seq_scan_create(session, NULL), session, &criteria, NULL);
+    OP_OPEN(filter);
+    while (OP_NEXT(filter)) {
+      matched++;
+    }
+    OP_CLOSE(filter);
+    operator_free(filter);
+  }
+  double filter_time = elapsed_seconds(&start);
+  printf("%-10s filter:    %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, filter_time,
+         filter_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(BENCH_PATH DICTIONARY_FILE_EXTENSION);
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_scans = argc > 2 ? atol(argv[2]) : DEFAULT_SCANS;
+  if (num_rows <= 0 || num_scans <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_scans]\n", argv[0]);
+    return 1;
+  }
+
+  run_encoding(false, num_rows, num_scans);
+  run_encoding(true, num_rows, num_scans);
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Counts dTLB misses and times random frame accesses in a large buffer pool arena on 4 KB and on 2 MB pages
+// Usage: bench_huge_pages [arena_mb] [num_accesses]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dbms.h"
+#include "ssdio.h"
+
+#if defined(ON_LINUX)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#endif
+
+#define DEFAULT_ARENA_MB 1024
+#define DEFAULT_ACCESSES 20000000
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Opens a user-space dTLB load miss counter for this process, -1 if the kernel or CPU does not expose one
+static int open_dtlb_counter(void) {
+#if defined(ON_LINUX)
+  struct perf_event_attr attr = {0};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+// Kilobytes of this process backed by transparent huge pages
+static long anon_huge_kb(void) {
+  FILE* file = fopen("/proc/self/smaps_rollup", "r");
+  if (!file) {
+    return -1;
+  }
+  char line[256];
+  long kb = -1;
+  while (fgets(line, sizeof(line), file)) {
+    if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) {
+      break;
+    }
+  }
+  fclose(file);
+  return kb;
+}
+
+static void run_arena(size_t arena_size, bool use_huge_pages, long num_accesses) {
+  uint8_t backing = SSDIO_FRAMES_HEAP;
+  char* frames = ssdio_alloc_frames(arena_size, use_huge_pages, &backing);
+  if (!frames) {
+    fprintf(stderr, "Failed to allocate %zu MB of frames\n", arena_size >> 20);
+    exit(1);
+  }
+  // Fault every frame in, the way a warm buffer pool would be
+  for (size_t offset = 0; offset < arena_size; offset += 4096) {
+    frames[offset] = (char)(offset >> 12);
+  }
+  const char* names[] = {"4K heap", "hugetlb", "THP"};
+  long huge_kb = backing == SSDIO_FRAMES_THP ? anon_huge_kb() : -1;
+
+  // Each access reads a random frame's header and one random tuple-sized word of its data
+  size_t frame_count = arena_size / PAGE_SIZE;
+  int counter = open_dtlb_counter();
+#if defined(ON_LINUX)
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+  uint64_t seed = 88172645463325252ull;
+  uint64_t sum = 0;
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_accesses; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    const page_t* page = (const page_t*)(frames + (seed % frame_count) * PAGE_SIZE);
+    sum += page->free_space_head + (uint8_t)page->data[(seed >> 40) % DATA_SIZE];
+  }
+  double access_time = elapsed_seconds(&start);
+  long long misses = -1;
+#if defined(ON_LINUX)
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) {
+      misses = -1;
+    }
+    close(counter);
+  }
+#endif
+
+  printf("%-8s %zu MB: %.2f ns/access", names[backing], arena_size >> 20, access_time * 1e9 / num_accesses);
+  if (misses >= 0) {
+    printf(", %.3f dTLB misses/access", (double)misses / num_accesses);
+  } else {
+    printf(", dTLB counter unavailable");
+  }
+  if (huge_kb >= 0) {
+    printf(", %ld MB on huge pages", huge_kb >> 10);
+  }
+  printf(" (sum %llu)\n", (unsigned long long)sum);
+  ssdio_free_frames(frames, arena_size, backing);
+}
+
+int main(int argc, char** argv) {
+  long arena_mb = argc > 1 ? atol(argv[1]) : DEFAULT_ARENA_MB;
+  long num_accesses = argc > 2 ? atol(argv[2]) : DEFAULT_ACCESSES;
+  if (arena_mb <= 0 || num_accesses <= 0) {
+    fprintf(stderr, "Usage: %s [arena_mb] [num_accesses]\n", argv[0]);
+    return 1;
+  }
+
+  size_t arena_size = (size_t)arena_mb << 20;
+  run_arena(arena_size, false, num_accesses);
+  run_arena(arena_size, true, num_accesses);
+  return 0;
+}
@@ -0,0 +1,121 @@
+// Times building a hash index and probing it with point lookups
+// Usage: bench_index [num_rows] [num_lookups]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dbms.h"
+#include "index.h"
+#include "ssdio.h"
+
+#define BENCH_PATH "bench_index.dat"
+#define DEFAULT_ROWS 1000000
+#define DEFAULT_LOOKUPS 1000000
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_lookups = argc > 2 ? atol(argv[2]) : DEFAULT_LOOKUPS;
+  if (num_rows <= 0 || num_lookups <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_lookups]\n", argv[0]);
+    return 1;
+  }
+
+  // 16-byte tuples: null byte, two INTs and padding
+  catalog_record_t records[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0}, {"value", 4, ATTRIBUTE_TYPE_INT, 1}, {PADDING_NAME, 7, ATTRIBUTE_TYPE_UNUSED, 2}};
+  system_catalog_t catalog = {.records = records, .record_count = 3, .tuple_size = NULL_BYTE_SIZE + 4 + 4 + 7};
+  dbms_create_table(BENCH_PATH, &catalog);
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    return 1;
+  }
+  dbms_add_session(manager, session);
+
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[2] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i},
+                                  {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)(i % 1000)}};
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      return 1;
+    }
+  }
+  printf("fill:    %ld rows in %.3f s\n", num_rows, elapsed_seconds(&start));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  session->indexes[0] = index_create(session, 0);
+  if (!session->indexes[0]) {
+    fprintf(stderr, "Index creation failed\n");
+    return 1;
+  }
+  printf("build:   %.3f s\n", elapsed_seconds(&start));
+
+  // Slabs plus the bucket array, divided over the entries
+  index_t* idx = session->indexes[0];
+  size_t memory = idx->capacity * sizeof(idx->buckets[0]);
+  for (index_slab_t* slab = idx->allocator.slabs; slab; slab = slab->next) {
+    memory += sizeof(index_slab_t) + INDEX_SLAB_BLOCKS * idx->allocator.block_size;
+  }
+  printf("memory:  %.1f bytes/entry (%zu buckets)\n", (double)memory / (double)idx->num_records, idx->bucket_count);
+
+  // Probe the in-memory chains directly so table page reads are not timed
+  uint64_t seed = 88172645463325252ULL;
+  size_t found = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_lookups; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    attribute_value_t key = {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)(seed % (uint64_t)num_rows)};
+    size_t count = 0;
+    tuple_id_t* tuple_ids = index_lookup(idx, &key, &count);
+    found += count;
+    free(tuple_ids);
+  }
+  double lookup_time = elapsed_seconds(&start);
+  printf("lookup:  %ld probes in %.3f s (%.1f ns/probe, %zu hits)\n", num_lookups, lookup_time,
+         lookup_time * 1e9 / (double)num_lookups, found);
+
+  // Absent keys, mostly answered by the Bloom filter without walking a bucket
+  found = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_lookups; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    attribute_value_t key = {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)(num_rows + seed % (uint64_t)num_rows)};
+    size_t count = 0;
+    tuple_id_t* tuple_ids = index_lookup(idx, &key, &count);
+    found += count;
+    free(tuple_ids);
+  }
+  double miss_time = elapsed_seconds(&start);
+  printf("miss:    %ld probes in %.3f s (%.1f ns/probe, %zu hits)\n", num_lookups, miss_time,
+         miss_time * 1e9 / (double)num_lookups, found);
+
+  // Close the file first so only releasing the chains is timed
+  index_sync(idx);
+  ssdio_close(idx->fd);
+  idx->fd = -1;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  index_free(idx);
+  session->indexes[0] = NULL;
+  printf("free:    %.3f s\n", elapsed_seconds(&start));
+
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ".id" INDEX_FILE_EXTENSION);
+  return 0;
+}
@@ -0,0 +1,133 @@
+// Times narrow-predicate scans of a wide table stored with NSM, PAX and occupancy bitmap pages
+// Usage: bench_layout [num_rows] [num_scans]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "zone_map.h"
+
+#define BENCH_PATH "bench_layout.dat"
+#define DEFAULT_ROWS 100000
+#define DEFAULT_SCANS 10
+#define BENCH_STRING_COUNT 6
+#define BENCH_STRING_SIZE 32
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void run_layout(uint8_t layout, long num_rows, long num_scans) {
+  // 208-byte tuples: null byte, two INTs, six 32-byte strings and padding
+  catalog_record_t records[3 + BENCH_STRING_COUNT] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0},
+                                                      {"value", 4, ATTRIBUTE_TYPE_INT, 1}};
+  for (int i = 0; i < BENCH_STRING_COUNT; i++) {
+    catalog_record_t* record = &records[2 + i];
+    snprintf(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE, "text%d", i);
+    record->attribute_size = BENCH_STRING_SIZE;
+    record->attribute_type = ATTRIBUTE_TYPE_STRING;
+    record->attribute_order = 2 + i;
+  }
+  records[2 + BENCH_STRING_COUNT] = (catalog_record_t){PADDING_NAME, 7, ATTRIBUTE_TYPE_UNUSED, 2 + BENCH_STRING_COUNT};
+  system_catalog_t catalog = {.records = records,
+                              .record_count = 3 + BENCH_STRING_COUNT,
+                              .tuple_size = NULL_BYTE_SIZE + 8 + BENCH_STRING_COUNT * BENCH_STRING_SIZE + 7,
+                              .layout = layout};
+  dbms_create_table(BENCH_PATH, &catalog);
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    exit(1);
+  }
+  dbms_add_session(manager, session);
+  const char* name = layout == CATALOG_LAYOUT_PAX ? "pax" : layout == CATALOG_LAYOUT_BITMAP ? "bitmap" : "nsm";
+
+  // Values are spread over every page so the zone map cannot skip any
+  char text[BENCH_STRING_SIZE + 1];
+  memset(text, 'x', BENCH_STRING_SIZE);
+  text[BENCH_STRING_SIZE] = '\0';
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[2 + BENCH_STRING_COUNT] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i},
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)((i * 7919) % 1000)}};
+    for (int j = 0; j < BENCH_STRING_COUNT; j++) {
+      attrs[2 + j] = (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING, .string_value = text};
+    }
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      exit(1);
+    }
+  }
+  dbms_flush_buffer_pool(session);
+  printf("%s fill:      %ld rows on %u pages (%llu per page) in %.3f s\n", name, num_rows, session->page_count,
+         (unsigned long long)dbms_catalog_tuples_per_page(session->catalog), elapsed_seconds(&start));
+
+  // 10% selectivity on one 4-byte column of a 208-byte row
+  proposition_t proposition = {.attribute_index = 1,
+                               .operator= OPERATOR_LESS_THAN,
+                               .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 0}};
+
+  // Raw page kernels: predicate mask then packed SIMD reduction
+  int64_t matched = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* op = scan_aggregate_create(session, &criteria, aggregates, 2, NULL);
+    OP_OPEN(op);
+    tuple_t* result = OP_NEXT(op);
+    matched += result ? result->attributes[0].int_value : 0;
+    OP_CLOSE(op);
+    operator_free(op);
+  }
+  double aggregate_time = elapsed_seconds(&start);
+  printf("%s aggregate: %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, aggregate_time,
+         aggregate_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+
+  // Decoded tuples through SeqScan -> Filter
+  matched = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* filter = filter_create(seq_scan_create(session, NULL), session, &criteria, NULL);
+    OP_OPEN(filter);
+    while (OP_NEXT(filter)) {
+      matched++;
+    }
+    OP_CLOSE(filter);
+    operator_free(filter);
+  }
+  double filter_time = elapsed_seconds(&start);
+  printf("%s filter:    %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, filter_time,
+         filter_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ZONE_MAP_FILE_EXTENSION);
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_scans = argc > 2 ? atol(argv[2]) : DEFAULT_SCANS;
+  if (num_rows <= 0 || num_scans <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_scans]\n", argv[0]);
+    return 1;
+  }
+
+  run_layout(CATALOG_LAYOUT_NSM, num_rows, num_scans);
+  run_layout(CATALOG_LAYOUT_PAX, num_rows, num_scans);
+  run_layout(CATALOG_LAYOUT_BITMAP, num_rows, num_scans);
+  return 0;
+}
@@ -0,0 +1,124 @@
+// Times scans of a table through the buffer pool and through a read-only session over the mapped file
+// Usage: bench_mmap [num_rows] [num_scans]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "zone_map.h"
+
+#define BENCH_PATH "bench_mmap.dat"
+#define DEFAULT_ROWS 100000
+#define DEFAULT_SCANS 10
+#define BENCH_STRING_SIZE 32
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void run_scans(dbms_session_t* session, const char* name, long num_rows, long num_scans) {
+  // 10% selectivity on one INT column
+  proposition_t proposition = {.attribute_index = 1,
+                               .operator= OPERATOR_LESS_THAN,
+                               .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 0}};
+
+  // Raw page kernels, no tuple decoding either way
+  int64_t matched = 0;
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* op = scan_aggregate_create(session, &criteria, aggregates, 2, NULL);
+    OP_OPEN(op);
+    tuple_t* result = OP_NEXT(op);
+    matched += result ? result->attributes[0].int_value : 0;
+    OP_CLOSE(op);
+    operator_free(op);
+  }
+  double aggregate_time = elapsed_seconds(&start);
+  printf("%-6s aggregate: %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, aggregate_time,
+         aggregate_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+
+  // Decoded tuples through SeqScan -> Filter
+  matched = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long scan = 0; scan < num_scans; scan++) {
+    Operator* filter = filter_create(seq_scan_create(session, NULL), session, &criteria, NULL);
+    OP_OPEN(filter);
+    while (OP_NEXT(filter)) {
+      matched++;
+    }
+    OP_CLOSE(filter);
+    operator_free(filter);
+  }
+  double filter_time = elapsed_seconds(&start);
+  printf("%-6s filter:    %ld scans in %.3f s (%.2f ns/row, %lld matched)\n", name, num_scans, filter_time,
+         filter_time * 1e9 / ((double)num_rows * num_scans), (long long)matched);
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_scans = argc > 2 ? atol(argv[2]) : DEFAULT_SCANS;
+  if (num_rows <= 0 || num_scans <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_scans]\n", argv[0]);
+    return 1;
+  }
+
+  // Null byte, two INTs and a 32-byte string, padded to 48 bytes
+  catalog_record_t records[] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0},
+                                {"value", 4, ATTRIBUTE_TYPE_INT, 1},
+                                {"text", BENCH_STRING_SIZE, ATTRIBUTE_TYPE_STRING, 2},
+                                {PADDING_NAME, 7, ATTRIBUTE_TYPE_UNUSED, 3}};
+  system_catalog_t catalog = {.records = records,
+                              .record_count = 4,
+                              .tuple_size = NULL_BYTE_SIZE + 8 + BENCH_STRING_SIZE + 7};
+  dbms_create_table(BENCH_PATH, &catalog);
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    return 1;
+  }
+  dbms_add_session(manager, session);
+
+  char text[BENCH_STRING_SIZE + 1];
+  memset(text, 'x', BENCH_STRING_SIZE);
+  text[BENCH_STRING_SIZE] = '\0';
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i},
+                                 {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)((i * 7919) % 1000)},
+                                 {.type = ATTRIBUTE_TYPE_STRING, .string_value = text}};
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      return 1;
+    }
+  }
+  dbms_flush_buffer_pool(session);
+  printf("%ld rows on %u pages\n", num_rows, session->page_count);
+
+  // The read-write session stays open next to the mapped one
+  dbms_session_t* mapped = dbms_open_dbms_session(BENCH_PATH, DBMS_OPEN_READONLY | DBMS_OPEN_MMAP);
+  if (!mapped) {
+    fprintf(stderr, "Failed to map benchmark table\n");
+    return 1;
+  }
+  run_scans(session, "pool", num_rows, num_scans);
+  run_scans(mapped, "mmap", num_rows, num_scans);
+
+  dbms_free_dbms_session(mapped);
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ZONE_MAP_FILE_EXTENSION);
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Times scans and point lookups of the same table stored with 4 KB to 64 KB pages, uncompressed and LZ4 compressed
+// Usage: bench_page_size [num_rows] [num_scans] [num_lookups]
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "compression.h"
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/scan_aggregate.h"
+#include "zone_map.h"
+
+#define BENCH_PATH "bench_page_size.dat"
+#define DEFAULT_ROWS 100000
+#define DEFAULT_SCANS 10
+#define DEFAULT_LOOKUPS 20000
+#define BENCH_STRING_COUNT 3
+#define BENCH_STRING_SIZE 32
+#define BENCH_DISTINCT_VALUES 40
+
+static double elapsed_seconds(const struct timespec* start) {
+  struct timespec end = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Low-cardinality text with an 8 character random suffix, compressible but not trivially
+static void fill_string(char* text, long row, int column, uint32_t* seed) {
+  // BENCH_STRING_SIZE characters, the value has two digits
+  snprintf(text, BENCH_STRING_SIZE + 1, "location-%02lu-of-a-low-cardinality",
+           (unsigned long)(row * 7919 + column) % BENCH_DISTINCT_VALUES);
+  for (size_t i = BENCH_STRING_SIZE - 8; i < BENCH_STRING_SIZE; i++) {
+    *seed = *seed * 1103515245u + 12345u;
+    text[i] = (char)('!' + (*seed >> 16) % 94);
+  }
+  text[BENCH_STRING_SIZE] = '\0';
+}
+
+static void run_page_size(uint32_t page_size, uint8_t compression, long num_rows, long num_scans, long num_lookups) {
+  // Null byte, two INTs and three 32-byte strings, padded to 112 bytes
+  catalog_record_t records[3 + BENCH_STRING_COUNT] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0},
+                                                      {"value", 4, ATTRIBUTE_TYPE_INT, 1}};
+  for (int i = 0; i < BENCH_STRING_COUNT; i++) {
+    catalog_record_t* record = &records[2 + i];
+    snprintf(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE, "text%d", i);
+    record->attribute_size = BENCH_STRING_SIZE;
+    record->attribute_type = ATTRIBUTE_TYPE_STRING;
+    record->attribute_order = 2 + i;
+  }
+  records[2 + BENCH_STRING_COUNT] = (catalog_record_t){PADDING_NAME, 7, ATTRIBUTE_TYPE_UNUSED, 2 + BENCH_STRING_COUNT};
+  system_catalog_t catalog = {.records = records,
+                              .record_count = 3 + BENCH_STRING_COUNT,
+                              .tuple_size = NULL_BYTE_SIZE + 8 + BENCH_STRING_COUNT * BENCH_STRING_SIZE + 7,
+                              .compression = compression,
+                              .page_size = page_size};
+  if (!dbms_create_table(BENCH_PATH, &catalog)) {
+    fprintf(stderr, "Failed to create benchmark table\n");
+    exit(1);
+  }
+
+  dbms_manager_t* manager = dbms_init_dbms_manager();
+  dbms_session_t* session = dbms_init_dbms_session(BENCH_PATH);
+  if (!manager || !session) {
+    fprintf(stderr, "Failed to open benchmark table\n");
+    exit(1);
+  }
+  dbms_add_session(manager, session);
+  char name[32];
+  snprintf(name, sizeof(name), "%uK/%s", page_size / 1024, compression == CATALOG_COMPRESSION_LZ4 ? "lz4" : "none");
+
+  char texts[BENCH_STRING_COUNT][BENCH_STRING_SIZE + 1];
+  uint32_t seed = 1;
+  struct timespec start = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < num_rows; i++) {
+    attribute_value_t attrs[2 + BENCH_STRING_COUNT] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i},
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)((i * 7919) % 1000)}};
+    for (int j = 0; j < BENCH_STRING_COUNT; j++) {
+      fill_string(texts[j], i, j, &seed);
+      attrs[2 + j] = (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING, .string_value = texts[j]};
+    }
+    if (!dbms_insert_tuple(session, attrs)) {
+      fprintf(stderr, "Insert failed at row %ld\n", i);
+      exit(1);
+    }
+  }
+  dbms_flush_buffer_pool(session);
+  double fill_time = elapsed_seconds(&start);
+
+  uint64_t page_bytes = (uint64_t)session->page_count * page_size;
+  uint64_t stored_bytes = session->compression_map ? compression_map_stored_size(session->compression_map) : page_bytes;
+  printf("%-10s fill:   %ld rows on %u pages in %.3f s, %.2f MB stored (ratio %.2f)\n", name, num_rows,
+         session->page_count, fill_time, stored_bytes / 1e6, (double)page_bytes / stored_bytes);
+
+  // Every scan reads all pages: the buffer pool holds BUFFER_POOL_SIZE frames
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 1}};
+  int64_t sum = 0;
+  double scan_times[2] = {0};
+  for (int is_cold = 0; is_cold < 2; is_cold++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long scan = 0; scan < num_scans; scan++) {
+      // Drops the clean table pages from the OS page cache, so the scan reads the device
+      if (is_cold) {
+        posix_fadvise(session->fd, 0, 0, POSIX_FADV_DONTNEED);
+      }
+      Operator* op = scan_aggregate_create(session, NULL, aggregates, 2, NULL);
+      OP_OPEN(op);
+      tuple_t* result = OP_NEXT(op);
+      sum += result ? result->attributes[1].int_value : 0;
+      OP_CLOSE(op);
+      operator_free(op);
+    }
+    scan_times[is_cold] = elapsed_seconds(&start);
+  }
+  printf("%-10s scan:   cached %.2f ns/row, uncached %.2f ns/row (sum %lld)\n", name,
+         scan_times[0] * 1e9 / ((double)num_rows * num_scans), scan_times[1] * 1e9 / ((double)num_rows * num_scans),
+         (long long)sum);
+
+  // Random rows, almost always on a page that is not in the buffer pool
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  int64_t found = 0;
+  double lookup_times[2] = {0};
+  for (int is_cold = 0; is_cold < 2; is_cold++) {
+    uint32_t lookup_seed = 7;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < num_lookups; i++) {
+      if (is_cold && i % 256 == 0) {
+        posix_fadvise(session->fd, 0, 0, POSIX_FADV_DONTNEED);
+      }
+      lookup_seed = lookup_seed * 1103515245u + 12345u;
+      uint64_t row = ((uint64_t)lookup_seed << 16 ^ lookup_seed >> 8) % (uint64_t)num_rows;
+      tuple_t* tuple = dbms_get_tuple(
+          session, (tuple_id_t){.page_id = row / tuples_per_page + 1, .slot_id = row % tuples_per_page});
+      found += tuple && tuple->attributes[0].int_value == (int32_t)row;
+    }
+    lookup_times[is_cold] = elapsed_seconds(&start);
+  }
+  printf("%-10s lookup: cached %.2f us, uncached %.2f us, %.1f KB read per miss (%lld found)\n", name,
+         lookup_times[0] * 1e6 / num_lookups, lookup_times[1] * 1e6 / num_lookups,
+         (double)stored_bytes / session->page_count / 1024, (long long)found);
+
+  dbms_free_dbms_manager(manager);
+  remove(BENCH_PATH);
+  remove(BENCH_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(BENCH_PATH COMPRESSION_MAP_FILE_EXTENSION);
+}
+
+int main(int argc, char** argv) {
+  long num_rows = argc > 1 ? atol(argv[1]) : DEFAULT_ROWS;
+  long num_scans = argc > 2 ? atol(argv[2]) : DEFAULT_SCANS;
+  long num_lookups = argc > 3 ? atol(argv[3]) : DEFAULT_LOOKUPS;
+  if (num_rows <= 0 || num_scans <= 0 || num_lookups <= 0) {
+    fprintf(stderr, "Usage: %s [num_rows] [num_scans] [num_lookups]\n", argv[0]);
+    return 1;
+  }
+
+  for (uint32_t page_size = MIN_PAGE_SIZE; page_size <= MAX_PAGE_SIZE; page_size *= 2) {
+    run_page_size(page_size, CATALOG_COMPRESSION_NONE, num_rows, num_scans, num_lookups);
+    run_page_size(page_size, CATALOG_COMPRESSION_LZ4, num_rows, num_scans, num_lookups);
+  }
+  return 0;
+}
@@ -19,6 +19,14 @@ uint32_t load_u32(const void* p);
  */
 uint64_t load_u64(const void* p);
 
+/**
+ * @brief Load a misaligned little-endian 16-bit unsigned integer from memory.
+ *
+ * @param p Pointer to the memory location.
+ * @return The loaded value.
+ */
+uint16_t load_u16(const void* p);
+
 /**
  * @brief Load a misaligned 8-bit unsigned integer from memory.
  *
@@ -59,6 +67,14 @@ void store_u32(void* p, uint32_t v);
  */
 void store_u64(void* p, uint64_t v);
 
+/**
+ * @brief Store an unsigned 16-bit integer into misaligned memory.
+ *
+ * @param p Pointer to the memory location.
+ * @param v The value to store.
+ */
+void store_u16(void* p, uint16_t v);
+
 /**
  * @brief Store an unsigned 8-bit integer into misaligned memory.
  *
@@ -0,0 +1,89 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Default size of the first chunk of an arena
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+// Chunks grow by doubling up to this size (larger requests get a dedicated chunk)
+#define ARENA_MAX_CHUNK_SIZE (4 * 1024 * 1024)
+// Every allocation is aligned to this many bytes
+#define ARENA_ALIGNMENT 16
+
+typedef struct arena_chunk {
+  struct arena_chunk* next;
+  size_t size;  // Usable bytes in data
+  size_t used;
+  _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+} arena_chunk_t;
+
+typedef struct {
+  arena_chunk_t* head;  // Chunk currently being bumped (most recent first)
+  size_t chunk_size;    // Size of the next chunk to allocate
+  size_t initial_chunk_size;
+  size_t bytes_allocated;  // Total bytes handed out since the last reset
+} arena_t;
+
+/**
+ * @brief Creates a bump-pointer arena
+ *
+ * @param chunk_size Size of the first chunk (0 for ARENA_DEFAULT_CHUNK_SIZE)
+ * @return Pointer to the arena, or NULL on failure
+ */
+arena_t* arena_create(size_t chunk_size);
+
+/**
+ * @brief Allocates memory from the arena
+ * Memory is aligned to ARENA_ALIGNMENT and stays valid until arena_reset or arena_free.
+ *
+ * @param arena Pointer to the arena
+ * @param size Number of bytes to allocate
+ * @return Pointer to the memory, or NULL on failure
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/**
+ * @brief Allocates zeroed memory for an array from the arena
+ *
+ * @param arena Pointer to the arena
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return Pointer to the zeroed memory, or NULL on failure
+ */
+void* arena_calloc(arena_t* arena, size_t count, size_t size);
+
+/**
+ * @brief Duplicates a string into the arena
+ *
+ * @param arena Pointer to the arena
+ * @param str String to copy
+ * @return Pointer to the copy, or NULL on failure
+ */
+char* arena_strdup(arena_t* arena, const char* str);
+
+/**
+ * @brief Duplicates at most n characters of a string into the arena (always null-terminated)
+ *
+ * @param arena Pointer to the arena
+ * @param str String to copy
+ * @param n Maximum number of characters to copy
+ * @return Pointer to the copy, or NULL on failure
+ */
+char* arena_strndup(arena_t* arena, const char* str, size_t n);
+
+/**
+ * @brief Releases every allocation at once, keeping the first chunk for reuse
+ *
+ * @param arena Pointer to the arena
+ */
+void arena_reset(arena_t* arena);
+
+/**
+ * @brief Frees the arena and all of its chunks
+ *
+ * @param arena Pointer to the arena
+ */
+void arena_free(arena_t* arena);
+
+#endif /* ARENA_H */
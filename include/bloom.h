@@ -0,0 +1,56 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Blocked Bloom filter: every key sets (and a probe tests) BLOOM_HASH_COUNT bits of a single
+// cache-line block, so a probe costs at most one cache miss
+#define BLOOM_CACHE_LINE_SIZE 64
+#define BLOOM_BLOCK_WORDS (BLOOM_CACHE_LINE_SIZE / sizeof(uint64_t))
+#define BLOOM_BITS_PER_KEY 10
+#define BLOOM_HASH_COUNT 7  // 9 bits of the second hash select each bit within the 512-bit block
+
+typedef struct {
+  _Alignas(BLOOM_CACHE_LINE_SIZE) uint64_t words[BLOOM_BLOCK_WORDS];
+} bloom_block_t;
+
+typedef struct {
+  bloom_block_t* blocks;
+  uint64_t block_mask;  // Block count - 1, the count is a power of two
+  uint64_t capacity;    // Keys the filter is sized for at BLOOM_BITS_PER_KEY
+} bloom_filter_t;
+
+/**
+ * @brief Creates an empty Bloom filter
+ *
+ * @param capacity Number of keys to size the filter for
+ * @return Pointer to the filter, or NULL on failure
+ */
+bloom_filter_t* bloom_create(uint64_t capacity);
+
+/**
+ * @brief Frees the filter
+ *
+ * @param filter Pointer to the filter
+ */
+void bloom_free(bloom_filter_t* filter);
+
+/**
+ * @brief Adds a key to the filter
+ *
+ * @param filter Pointer to the filter
+ * @param key The key (e.g. an index key, it is mixed before use)
+ */
+void bloom_add(bloom_filter_t* filter, uint64_t key);
+
+/**
+ * @brief Checks whether a key may have been added
+ *
+ * @param filter Pointer to the filter
+ * @param key The key
+ * @return false if the key was definitely never added, true if it may have been
+ */
+bool bloom_may_contain(const bloom_filter_t* filter, uint64_t key);
+
+#endif /* BLOOM_H */
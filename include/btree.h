@@ -0,0 +1,173 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "dbms.h"
+
+// Index files are named <table file>.<attribute name>.bpt
+#define BTREE_FILE_EXTENSION ".bpt"
+#define BTREE_MAGIC "SSDBPT01"
+#define BTREE_MAX_HEIGHT 16
+// Leaves are filled to this percentage by btree_create so later inserts do not split at once
+#define BTREE_BULK_FILL_PERCENT 90
+
+// Leaf entry, ordered by (key, page_id, slot_id) so duplicate keys still have a unique position
+typedef struct {
+  uint64_t key;  // Order-preserving encoding of the attribute value (see btree_normalize_key)
+  uint64_t page_id;
+  uint64_t slot_id;
+} btree_entry_t;
+
+typedef struct {
+  uint32_t is_leaf;
+  uint32_t count;        // Entries (leaf) or separators (internal node)
+  uint64_t next_leaf;    // Right sibling of a leaf (0 for the last leaf)
+  uint64_t first_child;  // Internal nodes: child holding everything below the first separator
+  uint64_t reserved;
+} btree_node_header_t;
+
+// Internal node slot: child holds the entries >= separator (and < the next separator)
+typedef struct {
+  btree_entry_t separator;
+  uint64_t child;
+} btree_branch_t;
+
+#define BTREE_LEAF_CAPACITY ((PAGE_SIZE - sizeof(btree_node_header_t)) / sizeof(btree_entry_t))
+#define BTREE_BRANCH_CAPACITY ((PAGE_SIZE - sizeof(btree_node_header_t)) / sizeof(btree_branch_t))
+
+// Node layout within an 8 KB page (page 0 of the file holds btree_meta_t)
+typedef struct {
+  btree_node_header_t header;
+  union {
+    btree_entry_t entries[BTREE_LEAF_CAPACITY];
+    btree_branch_t branches[BTREE_BRANCH_CAPACITY];
+  };
+} btree_node_t;
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint8_t attribute_index;
+  uint8_t attribute_type;
+  uint16_t reserved;
+  uint64_t root_page;
+  uint64_t page_count;  // Pages in the file, including this one
+  uint64_t entry_count;
+  uint32_t height;      // 1 when the root is a leaf
+} btree_meta_t;
+
+struct btree {
+  int fd;
+  uint16_t file_id;  // Identifies the file's pages in the session buffer pool
+  uint8_t attribute_index;
+  uint8_t attribute_type;
+  char* filename;
+  uint64_t root_page;
+  uint64_t page_count;
+  uint64_t entry_count;
+  uint32_t height;
+  bool meta_dirty;  // Meta page needs to be rewritten by btree_sync
+};
+
+/**
+ * @brief Encodes an attribute value as an unsigned key with the same ordering
+ * INT, FLOAT and BOOL encodings are exact. STRING keys are the first 8 bytes, so equal
+ * keys only mean equal prefixes and matches must be checked against the tuple.
+ *
+ * @param value Pointer to the attribute value
+ * @return The order-preserving key
+ */
+uint64_t btree_normalize_key(const attribute_value_t* value);
+
+/**
+ * @brief Builds a B+tree index file for an attribute from the current table contents
+ * Existing index files for the attribute are overwritten. Entries are sorted and loaded bottom-up.
+ *
+ * @param session The active session
+ * @param attribute_index The index of the attribute to index
+ * @return Pointer to the created index, or NULL on failure
+ */
+btree_t* btree_create(dbms_session_t* session, uint8_t attribute_index);
+
+/**
+ * @brief Opens an existing B+tree index file for an attribute
+ * Only the meta page is read, so opening does not depend on the size of the index.
+ *
+ * @param session The active session
+ * @param attribute_index The index of the attribute
+ * @return Pointer to the index, or NULL if there is no (valid) index file
+ */
+btree_t* btree_open(dbms_session_t* session, uint8_t attribute_index);
+
+/**
+ * @brief Writes the index metadata into its meta page in the buffer pool
+ *
+ * @param session The active session
+ * @param tree Pointer to the index
+ * @return true on success, false on failure
+ */
+bool btree_sync(dbms_session_t* session, btree_t* tree);
+
+/**
+ * @brief Writes back the index pages, closes the file and frees the index
+ *
+ * @param session The active session
+ * @param tree Pointer to the index
+ */
+void btree_close(dbms_session_t* session, btree_t* tree);
+
+/**
+ * @brief Inserts an entry, splitting nodes up to the root as needed
+ *
+ * @param session The active session
+ * @param tree Pointer to the index
+ * @param value Attribute value of the tuple
+ * @param tuple_id The tuple ID
+ * @return true on success, false on failure
+ */
+bool btree_insert(dbms_session_t* session, btree_t* tree, const attribute_value_t* value, tuple_id_t tuple_id);
+
+/**
+ * @brief Removes the entry of a tuple
+ * Nodes are not merged when they underflow, empty leaves are skipped by range scans.
+ *
+ * @param session The active session
+ * @param tree Pointer to the index
+ * @param value Attribute value of the tuple
+ * @param tuple_id The tuple ID
+ * @return true if found and removed
+ */
+bool btree_delete(dbms_session_t* session, btree_t* tree, const attribute_value_t* value, tuple_id_t tuple_id);
+
+/**
+ * @brief Adds a tuple to every B+tree index of the session
+ * The tuple's buffer page must be pinned, index pages are loaded through the same pool.
+ *
+ * @param session The active session
+ * @param tuple The inserted tuple
+ */
+void btree_insert_tuple(dbms_session_t* session, const tuple_t* tuple);
+
+/**
+ * @brief Removes a tuple from every B+tree index of the session
+ * The tuple's buffer page must be pinned, index pages are loaded through the same pool.
+ *
+ * @param session The active session
+ * @param tuple The tuple being deleted or updated
+ */
+void btree_delete_tuple(dbms_session_t* session, const tuple_t* tuple);
+
+/**
+ * @brief Retrieves the tuple IDs of all entries with low_key <= key <= high_key
+ * Descends once to the first leaf, then follows the leaf sibling links.
+ *
+ * @param session The active session
+ * @param tree Pointer to the index
+ * @param low_key Lower bound (normalized, inclusive)
+ * @param high_key Upper bound (normalized, inclusive)
+ * @param out_count Pointer to store the number of results
+ * @return Malloc'd array of tuple_id_t in key order (caller must free), or NULL if none found
+ */
+tuple_id_t* btree_range(dbms_session_t* session, btree_t* tree, uint64_t low_key, uint64_t high_key,
+                        size_t* out_count);
+
+#endif /* BTREE_H */
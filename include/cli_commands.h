@@ -10,18 +10,30 @@
 #define CLI_FILL_COMMAND "fill"
 
 #define CLI_CREATE_TABLE_COMMAND "create"
+#define CLI_LAYOUT_OPTION "--layout"
+#define CLI_DICTIONARY_OPTION "--dictionary"
+#define CLI_COMPRESSION_OPTION "--compression"
+#define CLI_PAGE_SIZE_OPTION "--page-size"
 #define CLI_OPEN_TABLE_COMMAND "open"
+#define CLI_READONLY_OPTION "--readonly"
+#define CLI_MMAP_OPTION "--mmap"
 #define CLI_SPLIT_COMMAND "split"
 #define CLI_TIME_COMMAND "time"
 #define CLI_QUERY_COMMAND "query"
 #define CLI_INDEX_COMMAND "index"
+#define CLI_BTREE_COMMAND "btree"
+#define CLI_VACUUM_COMMAND "vacuum"
+#define CLI_PUNCH_HOLE_OPTION "--punch-hole"
+#define CLI_ANALYZE_COMMAND "analyze"
 
 #define CLI_QUERY_SELECT_COMMAND "select"
 #define CLI_QUERY_PIPELINE_COMMAND "pipeline"
 #define CLI_QUERY_JOIN_COMMAND "join"
+#define CLI_QUERY_AGGREGATE_COMMAND "aggregate"
 
 #define MAX_SPLITS 16
 #define MAX_QUERY_SELECT_PROPOSITIONS 32
+#define MAX_QUERY_AGGREGATES 32
 
 #define CLI_SUCCESS_RETURN_CODE 1
 #define CLI_FAILURE_RETURN_CODE -1
@@ -104,7 +116,8 @@ int cli_fill_command(dbms_session_t* session, char* input_line);
  * @brief Creates a new table via CLI
  *
  * @param manager Pointer to the DBMS manager
- * @param input_line Input line (not used)
+ * @param input_line Input line (<table_path> [--layout nsm|pax|slotted|bitmap] [--dictionary <attribute>[,<attribute>...]]
+ * [--compression none|lz4] [--page-size <bytes>])
  * @return CLI return code
  */
 int cli_create_table_command(dbms_manager_t* manager, const char* input_line);
@@ -113,7 +126,7 @@ int cli_create_table_command(dbms_manager_t* manager, const char* input_line);
  * @brief Opens an existing table via CLI
  *
  * @param manager Pointer to the DBMS manager
- * @param input_line Input line containing the table filename
+ * @param input_line Input line containing the table filename, then --readonly and --mmap if given
  * @return CLI return code
  */
 int cli_open_command(dbms_manager_t* manager, const char* input_line);
@@ -127,6 +140,47 @@ int cli_open_command(dbms_manager_t* manager, const char* input_line);
  */
 int cli_split_command(dbms_manager_t* manager, char* input_line);
 
+/**
+ * @brief Starts a vacuum of a table, run in steps by cli_background_step between commands
+ *
+ * @param manager Pointer to the DBMS manager
+ * @param input_line Input line containing the table name and optionally --punch-hole
+ * @return CLI return code
+ */
+int cli_vacuum_command(dbms_manager_t* manager, char* input_line);
+
+/**
+ * @brief Samples a table and saves its statistics for the cost model
+ *
+ * @param manager Pointer to the DBMS manager
+ * @param input_line Input line containing the table name and optionally the number of pages to sample
+ * @return CLI return code
+ */
+int cli_analyze_command(dbms_manager_t* manager, char* input_line);
+
+/**
+ * @brief Checks whether a vacuum is running on any table
+ *
+ * @param manager Pointer to the DBMS manager
+ * @return true if cli_background_step has work to do
+ */
+bool cli_has_background_work(const dbms_manager_t* manager);
+
+/**
+ * @brief Runs one bounded step of every running vacuum
+ *
+ * @param manager Pointer to the DBMS manager
+ * @return true if a vacuum finished, its summary is printed by cli_background_finish
+ */
+bool cli_background_step(dbms_manager_t* manager);
+
+/**
+ * @brief Prints the summary of every finished vacuum and frees it
+ *
+ * @param manager Pointer to the DBMS manager
+ */
+void cli_background_finish(dbms_manager_t* manager);
+
 /**
  * @brief Times the execution of a command
  *
@@ -173,12 +227,30 @@ int cli_query_pipeline(dbms_manager_t* manager, char* input_line);
 int cli_query_join(dbms_manager_t* manager, char* input_line);
 
 /**
- * @brief Creates an index on the chosen attribute
+ * @brief Executes a grouped aggregate query using the HashAggregate operator
+ *
+ * @param manager Pointer to the DBMS manager
+ * @param input_line Input line containing aggregates, group by attributes, predicates and table name
+ * @return CLI return code
+ */
+int cli_query_aggregate(dbms_manager_t* manager, char* input_line);
+
+/**
+ * @brief Creates a hash index on the chosen attribute, or a composite one on a comma separated list
  *
  * @param manager Pointer to the DBMS session
- * @param input_line Input line containing index attribute
+ * @param input_line Input line containing the index attribute(s), in key order
  * @return CLI return code
  */
 int cli_index_command(dbms_session_t* session, char* input_line);
 
+/**
+ * @brief Builds (or rebuilds) a persistent B+tree index on the chosen attribute
+ *
+ * @param session Pointer to the DBMS session
+ * @param input_line Input line containing index attribute
+ * @return CLI return code
+ */
+int cli_btree_command(dbms_session_t* session, char* input_line);
+
 #endif /* CLI_COMMANDS_H */
@@ -0,0 +1,156 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include "dbms.h"
+
+// On-disk format: <table file>.pgm
+// The pages of a compressed table are stored LZ4 compressed in variable-size extents of the table
+// file, after the catalog page (PAGE_SIZE whatever the size of the table's pages). This map holds the magic, the page count, the end of the allocated
+// extents and then one compression_extent_t per page, in page order. It is replaced atomically
+// (written to a temporary file then renamed) and, unlike the zone map, cannot be rebuilt.
+#define COMPRESSION_MAP_FILE_EXTENSION ".pgm"
+#define COMPRESSION_MAP_FILE_MAGIC "SSDPGM01"
+#define COMPRESSION_EXTENT_UNIT 512  // Extents are whole units, so writes stay sector aligned
+
+typedef struct {
+  uint64_t offset;    // Byte offset of the extent in the table file
+  uint32_t length;    // Compressed size of the page, the page size if stored as is (it did not shrink)
+  uint32_t capacity;  // Size of the extent, a multiple of COMPRESSION_EXTENT_UNIT
+} compression_extent_t;
+
+struct compression_map {
+  char* filename;
+  uint32_t page_size;              // Size of the table's pages
+  uint64_t page_count;
+  uint64_t capacity;               // Allocated entries of extents
+  compression_extent_t* extents;   // Extent of page p at p - 1
+  uint64_t file_end;               // End of the last extent, new extents are appended there
+  compression_extent_t* free_extents;  // Unused extents (only offset and capacity are set)
+  uint64_t free_count;
+  uint64_t free_capacity;
+  compression_extent_t* released_extents;  // Freed since the last sync, the map on disk still uses them
+  uint64_t released_count;
+  uint64_t released_capacity;
+  bool is_dirty;   // Extents changed since the last sync
+  char* buffer;    // Compressed page being written
+};
+
+/**
+ * @brief Returns the largest size LZ4 can compress an input of the given size to
+ *
+ * @param size Input size in bytes
+ * @return Worst case compressed size in bytes
+ */
+size_t compression_lz4_bound(size_t size);
+
+/**
+ * @brief Compresses a buffer into the LZ4 block format
+ *
+ * @param source Input bytes
+ * @param size Input size in bytes
+ * @param destination Output buffer
+ * @param capacity Size of the output buffer
+ * @return Compressed size in bytes, or 0 if it does not fit in the output buffer
+ */
+size_t compression_lz4_compress(const void* source, size_t size, void* destination, size_t capacity);
+
+/**
+ * @brief Decompresses an LZ4 block, checking every length and offset against the buffers
+ *
+ * @param source Compressed bytes
+ * @param size Compressed size in bytes
+ * @param destination Output buffer
+ * @param destination_size Exact decompressed size
+ * @return true on success, false if the block is corrupt or does not decompress to destination_size bytes
+ */
+bool compression_lz4_decompress(const void* source, size_t size, void* destination, size_t destination_size);
+
+/**
+ * @brief Writes the first page and the map of a new compressed table
+ *
+ * @param table_filename Name of the table's database file
+ * @param fd File descriptor of the table file, its catalog page already written
+ * @param first_page The initialized first page
+ * @param page_size Size of the table's pages (see dbms_page_size)
+ * @return true on success, false on failure
+ */
+bool compression_map_create(const char* table_filename, int fd, const page_t* first_page, uint32_t page_size);
+
+/**
+ * @brief Loads the map of a compressed table
+ *
+ * @param table_filename Name of the table's database file
+ * @param page_size Size of the table's pages (see dbms_page_size)
+ * @return Pointer to the map, or NULL on failure
+ */
+compression_map_t* compression_map_open(const char* table_filename, uint32_t page_size);
+
+/**
+ * @brief Reads and decompresses a page, safe to call from several threads while no page is written
+ *
+ * @param map Pointer to the map
+ * @param fd File descriptor of the table file
+ * @param page_id The page (1 to page_count)
+ * @param page Filled with the page
+ * @return true on success, false on failure
+ */
+bool compression_map_read_page(const compression_map_t* map, int fd, uint64_t page_id, page_t* page);
+
+/**
+ * @brief Compresses and writes a page, in place if it still fits its extent, else to another extent
+ * A page_id of page_count + 1 appends a page.
+ *
+ * @param map Pointer to the map
+ * @param fd File descriptor of the table file
+ * @param page_id The page (1 to page_count + 1)
+ * @param page The page
+ * @return true on success, false on failure
+ */
+bool compression_map_write_page(compression_map_t* map, int fd, uint64_t page_id, const page_t* page);
+
+/**
+ * @brief Writes the map to disk, then lets the extents freed since the last sync be reused
+ * Must be called after the table file is flushed, see dbms_flush_buffer_pool.
+ *
+ * @param map Pointer to the map (may be NULL)
+ * @return true on success (or if nothing changed), false on failure
+ */
+bool compression_map_sync(compression_map_t* map);
+
+/**
+ * @brief Drops the pages past page_count, their extents are freed by the next sync
+ *
+ * @param map Pointer to the map (may be NULL)
+ * @param page_count The new number of pages
+ * @return true on success, false on failure
+ */
+bool compression_map_truncate(compression_map_t* map, uint64_t page_count);
+
+/**
+ * @brief Cuts the free space after the last extent off the table file, optionally deallocating the
+ * free extents left between pages as well
+ * Must be called after compression_map_sync, so no extent is still used by the map on disk.
+ *
+ * @param map Pointer to the map (may be NULL)
+ * @param fd File descriptor of the table file
+ * @param punch_holes Punch the free extents out of the file (see ssdio_punch_hole)
+ * @return true on success, false on failure
+ */
+bool compression_map_trim(compression_map_t* map, int fd, bool punch_holes);
+
+/**
+ * @brief Returns the bytes of the table file taken by the page extents
+ *
+ * @param map Pointer to the map (may be NULL)
+ * @return Sum of the extent capacities (0 if map is NULL)
+ */
+uint64_t compression_map_stored_size(const compression_map_t* map);
+
+/**
+ * @brief Frees the map
+ *
+ * @param map Pointer to the map (may be NULL)
+ */
+void compression_map_free(compression_map_t* map);
+
+#endif /* COMPRESSION_H */
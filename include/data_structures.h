@@ -8,15 +8,25 @@
 #define FNV_PRIME_64 0x100000001b3UL
 #define FNV_OFFSET_BASIS_64 0xcbf29ce484222325UL
 
-typedef struct hash_node {
+// Open addressing with linear probing. Every slot has a control byte, HASH_TABLE_EMPTY or the low 7 bits
+// of the key's hash, so a probe compares HASH_TABLE_GROUP_SIZE control bytes at once and only touches the
+// slots whose tag matches. Deletion shifts the following entries back, so there are no tombstones.
+#define HASH_TABLE_GROUP_SIZE 16
+#define HASH_TABLE_EMPTY 0x80
+#define HASH_TABLE_MIN_CAPACITY 16
+#define HASH_TABLE_MAX_LOAD_NUMERATOR 7  // Grows past 7/8 full
+#define HASH_TABLE_MAX_LOAD_DENOMINATOR 8
+
+typedef struct {
   uint64_t key;
   uint64_t value;
-  struct hash_node* next;
-} hash_node_t;
+} hash_slot_t;
 
 typedef struct {
-  hash_node_t** buckets;
-  size_t bucket_count;
+  uint8_t* control;    // capacity bytes, then a copy of the first HASH_TABLE_GROUP_SIZE for wrapping probes
+  hash_slot_t* slots;  // Inline entries
+  size_t capacity;     // Power of two
+  size_t count;
 } hash_table_t;
 
 /**
@@ -30,11 +40,12 @@ uint64_t fnv1a_hash(uint64_t key);
 
 /**
  * @brief Initializes a hash table
+ * The table doubles its capacity when it gets too full, so the count is only a sizing hint.
  *
- * @param bucket_count Number of buckets in the hash table
+ * @param expected_count Number of entries the table should hold without growing
  * @return Pointer to the initialized hash table, or NULL on failure
  */
-hash_table_t* hash_table_init(size_t bucket_count);
+hash_table_t* hash_table_init(size_t expected_count);
 
 /**
  * @brief Frees a hash table
@@ -44,7 +55,7 @@ hash_table_t* hash_table_init(size_t bucket_count);
 void hash_table_free(hash_table_t* table);
 
 /**
- * @brief Inserts a key-value pair into the hash table
+ * @brief Inserts a key-value pair into the hash table, replacing the value if the key exists
  *
  * @param table Pointer to the hash table
  * @param key The key to insert
@@ -7,13 +7,37 @@
 
 #include "data_structures.h"
 
+// Default table page size, also the size of the catalog page and of the pages of every side file
 #define PAGE_SIZE 8192
-#define DATA_SIZE (PAGE_SIZE - 32)
+#define PAGE_HEADER_SIZE 32
+#define DATA_SIZE (PAGE_SIZE - PAGE_HEADER_SIZE)
+// Table page sizes, a power of two chosen when the table is created (see dbms_page_size)
+#define MIN_PAGE_SIZE 4096
+#define MAX_PAGE_SIZE 65536
 #define NULL_BYTE_SIZE 1
 #define FREE_POINTER_OFFSET (NULL_BYTE_SIZE * sizeof(uint64_t))
 
 #define CATALOG_RECORD_SIZE 64
 #define CATALOG_ATTRIBUTE_NAME_SIZE (CATALOG_RECORD_SIZE - 3)
+// The last record slot of the catalog page holds catalog_options_t
+#define CATALOG_MAX_RECORDS (PAGE_SIZE / CATALOG_RECORD_SIZE - 1)
+#define CATALOG_OPTIONS_MAGIC "SSDOPT01"
+
+// Page layouts, chosen when the table is created
+#define CATALOG_LAYOUT_NSM 0  // Tuples stored back to back, each starting with its null byte
+#define CATALOG_LAYOUT_PAX 1  // A presence bitmap, then one minipage per attribute with its value for every slot
+#define CATALOG_LAYOUT_SLOTTED 2  // A slot directory and variable-length records, strings stored unpadded
+#define CATALOG_LAYOUT_BITMAP 3   // An occupancy bitmap, then tuples stored back to back without a null byte
+// PAX and bitmap pages start with one occupancy bit per slot, in 64-bit words
+#define DBMS_BITMAP_WORD_BITS 64
+
+// Dictionary encoded STRING attributes store the code of their value in the pages (see dictionary.h)
+#define CATALOG_DICTIONARY_CODE_SIZE 2
+#define CATALOG_DICTIONARY_BITMAP_SIZE ((CATALOG_MAX_RECORDS + 7) / 8)
+
+// Page compression, chosen when the table is created (see compression.h)
+#define CATALOG_COMPRESSION_NONE 0  // Pages stored as is, page p at PAGE_SIZE + (p - 1) * page size
+#define CATALOG_COMPRESSION_LZ4 1   // Pages LZ4 compressed into variable-size extents
 
 #define ATTRIBUTE_TYPE_UNUSED 0
 #define ATTRIBUTE_TYPE_INT 1
@@ -22,19 +46,46 @@
 #define ATTRIBUTE_TYPE_BOOL 4
 
 // TODO: Create buffer pool
-#define BUFFER_POOL_SIZE 4
+// Frames per session, production builds raise it (-DBUFFER_POOL_SIZE=<frames>)
+#ifndef BUFFER_POOL_SIZE
+#  define BUFFER_POOL_SIZE 4
+#endif
 
 #define PADDING_NAME "PADDING"
 
+// Buffer pool frames can hold pages of the table file or of its index files
+#define DBMS_TABLE_FILE_ID 0
+#define DBMS_PAGE_TABLE_KEY(file_id, page_id) (((uint64_t)(file_id) << 48) | (uint64_t)(page_id))
+// Joins the attribute names in the file name of an index over several attributes
+#define DBMS_INDEX_NAME_SEPARATOR '+'
+
+// Session open flags (see dbms_open_dbms_session)
+#define DBMS_OPEN_READONLY 0x1  // Inserts, updates, deletes and truncation are rejected
+#define DBMS_OPEN_MMAP 0x2      // Table file mapped into memory, requires DBMS_OPEN_READONLY
+
 // Forward declaration for index
 typedef struct index index_t;
+// Forward declaration for B+tree index
+typedef struct btree btree_t;
+// Forward declaration for zone map
+typedef struct zone_map zone_map_t;
+// Forward declaration for the dictionary of the encoded attributes
+typedef struct dictionary dictionary_t;
+// Forward declaration for the extent map of a compressed table
+typedef struct compression_map compression_map_t;
+// Forward declaration for the overflow file of a slotted table
+typedef struct overflow_file overflow_file_t;
+// Forward declaration for a vacuum in progress
+typedef struct vacuum vacuum_t;
+// Forward declaration for the statistics of an analyzed table
+typedef struct table_stats table_stats_t;
 
 typedef struct {
   uint64_t next_page;
   uint64_t prev_page;
   uint64_t free_space_head;
   uint64_t tuples_per_page;
-  char data[DATA_SIZE];
+  char data[DATA_SIZE];  // Runs on to the end of the page in tables with pages larger than PAGE_SIZE
 } page_t;
 
 typedef struct {
@@ -49,14 +100,29 @@ typedef struct {
   uint8_t attribute_order;
 } catalog_record_t;
 
+// Table options, stored after the records (a zero attribute_size byte still ends the record list)
+typedef struct {
+  char magic[8];
+  uint8_t layout;
+  uint8_t dictionary_attributes[CATALOG_DICTIONARY_BITMAP_SIZE];  // Bit per attribute order
+  uint8_t compression;
+  uint8_t page_shift;  // log2 of the table page size, 0 for PAGE_SIZE
+  char reserved[CATALOG_RECORD_SIZE - 11 - CATALOG_DICTIONARY_BITMAP_SIZE];
+} catalog_options_t;
+
 typedef struct {
   catalog_record_t* records;
   uint16_t tuple_size;
   uint8_t record_count;
+  uint8_t layout;  // CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX, CATALOG_LAYOUT_SLOTTED or CATALOG_LAYOUT_BITMAP
+  uint8_t dictionary_attributes[CATALOG_DICTIONARY_BITMAP_SIZE];  // Bit per attribute position, set if encoded
+  uint8_t compression;  // CATALOG_COMPRESSION_NONE or CATALOG_COMPRESSION_LZ4
+  uint32_t page_size;   // Bytes per table page, 0 for PAGE_SIZE (see dbms_page_size)
 } system_catalog_t;
 
 typedef struct {
   uint8_t type;
+  uint32_t dictionary_code;  // Page code of a STRING of a dictionary encoded attribute, set when a page is decoded
   union {
     int32_t int_value;
     float float_value;
@@ -74,8 +140,11 @@ typedef struct {
 typedef struct {
   bool is_free;
   bool is_dirty;
+  bool is_decoded;  // True once tuples[] reflects the page bytes
   uint32_t pin_count;
   uint32_t last_updated;
+  uint16_t file_id;  // DBMS_TABLE_FILE_ID, or the index file the page belongs to
+  int fd;            // File the page is written back to
   uint64_t page_id;
   page_t* page;
   tuple_t* tuples;
@@ -84,6 +153,9 @@ typedef struct {
 typedef struct {
   uint32_t page_count;
   hash_table_t* page_table;
+  char* frames;  // Memory of the frames, a frame holding a mapped table page points into the mapping instead
+  size_t frames_size;
+  uint8_t frame_backing;  // SSDIO_FRAMES_*, huge pages once the frames span 2 MB
   buffer_page_t buffer_pages[BUFFER_POOL_SIZE];
 } buffer_pool_t;
 
@@ -96,6 +168,18 @@ typedef struct {
   system_catalog_t* catalog;
   buffer_pool_t* buffer_pool;
   index_t** indexes;
+  index_t** composite_indexes;  // Hash indexes over several attributes
+  size_t composite_index_count;
+  btree_t** btrees;  // On-disk B+tree per attribute (NULL if none)
+  zone_map_t* zone_map;  // Per-page min/max of the INT and FLOAT attributes (NULL if none)
+  dictionary_t* dictionary;  // Values of the dictionary encoded attributes (NULL if none)
+  compression_map_t* compression_map;  // Extents of the compressed pages (NULL if the table is not compressed)
+  overflow_file_t* overflow;  // Strings of the records too long for a slotted page (NULL if not slotted)
+  vacuum_t* vacuum;  // Vacuum run in steps between commands (NULL if none)
+  table_stats_t* stats;  // Distributions sampled by the last analyze (NULL if never analyzed)
+  bool is_readonly;     // Opened with DBMS_OPEN_READONLY
+  const char* mapping;  // Table file mapped read-only (NULL unless opened with DBMS_OPEN_MMAP)
+  size_t mapping_size;
 } dbms_session_t;
 
 typedef struct {
@@ -112,6 +196,52 @@ typedef struct {
  */
 bool dbms_create_table(const char* filename, const system_catalog_t* catalog);
 
+/**
+ * @brief Builds the name of an index file kept next to a table (<table file>.<attribute><extension>)
+ *
+ * @param table_filename Name of the table's database file
+ * @param attribute_name Name of the indexed attribute
+ * @param extension Extension of the index kind (e.g. ".bpt")
+ * @return Malloc'd filename (caller must free), or NULL on failure
+ */
+char* dbms_get_index_filename(const char* table_filename, const char* attribute_name, const char* extension);
+
+/**
+ * @brief Builds the name of an index file over several attributes
+ * The attribute names are joined by DBMS_INDEX_NAME_SEPARATOR (<table file>.<name>+<name><extension>),
+ * a single attribute gives the same name as dbms_get_index_filename.
+ *
+ * @param table_filename Name of the table's database file
+ * @param catalog The table's system catalog
+ * @param attribute_indexes Indexed attributes, in key order
+ * @param attribute_count Number of indexed attributes
+ * @param extension Extension of the index kind (e.g. ".hix")
+ * @return Malloc'd filename (caller must free), or NULL on failure
+ */
+char* dbms_get_composite_index_filename(const char* table_filename, const system_catalog_t* catalog,
+                                        const uint8_t* attribute_indexes, uint8_t attribute_count,
+                                        const char* extension);
+
+/**
+ * @brief Adds a composite hash index to the session, which then keeps it up to date and frees it
+ *
+ * @param session Pointer to the DBMS session
+ * @param index The index (from index_create_composite or index_open_composite)
+ * @return true on success, false on failure
+ */
+bool dbms_add_composite_index(dbms_session_t* session, index_t* index);
+
+/**
+ * @brief Finds the open composite hash index over exactly the given attributes
+ *
+ * @param session Pointer to the DBMS session
+ * @param attribute_indexes Indexed attributes, in key order
+ * @param attribute_count Number of indexed attributes
+ * @return The index, or NULL if there is none
+ */
+index_t* dbms_find_composite_index(const dbms_session_t* session, const uint8_t* attribute_indexes,
+                                   uint8_t attribute_count);
+
 /**
  * @brief Initializes the DBMS manager
  *
@@ -152,6 +282,19 @@ bool dbms_remove_session(dbms_manager_t* manager, dbms_session_t* session);
  */
 dbms_session_t* dbms_init_dbms_session(const char* filename);
 
+/**
+ * @brief Initializes a DBMS session with open flags
+ *
+ * With DBMS_OPEN_MMAP the table file is mapped for the lifetime of the session: pages are read in
+ * place instead of being copied into buffer pool frames, and SeqScan and ScanAggregate read them
+ * without going through the pool at all. Only uncompressed tables can be mapped.
+ *
+ * @param filename Name of the database file to open
+ * @param flags DBMS_OPEN_READONLY and DBMS_OPEN_MMAP, or 0 for a read-write session
+ * @return Pointer to the DBMS session on success, NULL on failure
+ */
+dbms_session_t* dbms_open_dbms_session(const char* filename, uint8_t flags);
+
 /**
  * @brief Frees a DBMS session
  *
@@ -193,6 +336,53 @@ void dbms_free_catalog_records(system_catalog_t catalog);
  */
 buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id);
 
+/**
+ * @brief Retrieves a buffer page without decoding its tuples
+ *
+ * Same as dbms_get_buffer_page, but only the raw page bytes are guaranteed to be valid.
+ * The tuples array of the returned page must not be used unless is_decoded is set.
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_id ID of the page to retrieve
+ * @return Pointer to the buffer page, or NULL if not found
+ */
+buffer_page_t* dbms_get_raw_buffer_page(dbms_session_t* session, uint64_t page_id);
+
+/**
+ * @brief Returns a page of a mapped table in place
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_id The page (1 to page_count)
+ * @return Pointer into the mapping, or NULL if the session is not mapped or the page does not exist
+ */
+const page_t* dbms_get_mapped_page(const dbms_session_t* session, uint64_t page_id);
+
+/**
+ * @brief Allocates a page view: a buffer page outside the buffer pool with its own tuples
+ *
+ * @param session Pointer to the DBMS session
+ * @return Pointer to the view, or NULL on failure (free with dbms_free_page_view)
+ */
+buffer_page_t* dbms_alloc_page_view(const dbms_session_t* session);
+
+/**
+ * @brief Points a page view at a page of a mapped table and decodes its tuples
+ *
+ * @param session Pointer to the DBMS session
+ * @param view Page view from dbms_alloc_page_view
+ * @param page_id The page (1 to page_count)
+ * @return true on success, false if the session is not mapped or the page does not exist
+ */
+bool dbms_view_mapped_page(dbms_session_t* session, buffer_page_t* view, uint64_t page_id);
+
+/**
+ * @brief Frees a page view
+ *
+ * @param session Pointer to the DBMS session the view was allocated for
+ * @param view Page view (may be NULL)
+ */
+void dbms_free_page_view(const dbms_session_t* session, buffer_page_t* view);
+
 /**
  * @brief Runs the buffer pool eviction policy to free up a buffer page
  * If there is a free page in the cache, that is the one that is returned.
@@ -204,6 +394,29 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id);
  */
 buffer_page_t* dbms_run_buffer_pool_policy(dbms_session_t* session, uint64_t* target_index);
 
+/**
+ * @brief Reads a table page from disk, decompressing it if the table is compressed
+ * Does not go through the buffer pool, and is safe to call from several threads while no page is written.
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_id The page (1 to page_count)
+ * @param page Filled with the page, dbms_page_size() bytes
+ * @return true on success, false on failure
+ */
+bool dbms_read_table_page(const dbms_session_t* session, uint64_t page_id, page_t* page);
+
+/**
+ * @brief Writes a table page to disk, compressing it if the table is compressed
+ * Does not go through the buffer pool. A page_id of page_count + 1 appends a page, the caller then
+ * increments page_count.
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_id The page (1 to page_count + 1)
+ * @param page The page, dbms_page_size() bytes
+ * @return true on success, false on failure
+ */
+bool dbms_write_table_page(dbms_session_t* session, uint64_t page_id, const page_t* page);
+
 /**
  * @brief Flushes a single buffer page to disk if it is dirty
  *
@@ -229,6 +442,107 @@ void dbms_flush_buffer_pool(dbms_session_t* session);
  */
 off_t dbms_get_attribute_offset(const system_catalog_t* catalog, uint8_t attribute_position);
 
+/**
+ * @brief Calculates where the values of an attribute start within a page's data
+ * The value of slot s is at data + offset + s * dbms_get_column_stride(). For NSM pages this is the
+ * attribute offset within a tuple, for PAX pages the start of the attribute's minipage and for bitmap
+ * pages the attribute offset within the first tuple after the bitmap. Slotted pages have no fixed
+ * positions, the offset is into the columns filled by dbms_unpack_page().
+ *
+ * @param catalog Pointer to the system catalog
+ * @param attribute_position Position of the attribute (0-based index)
+ * @return Byte offset of the slot 0 value within the page data
+ */
+off_t dbms_get_column_offset(const system_catalog_t* catalog, uint8_t attribute_position);
+
+/**
+ * @brief Returns the distance between the values of an attribute in consecutive slots
+ *
+ * @param catalog Pointer to the system catalog
+ * @param attribute_position Position of the attribute (0-based index)
+ * @return The tuple size for NSM pages (without the null byte for bitmap pages), the attribute size for PAX
+ *         and slotted pages (0 if not found)
+ */
+size_t dbms_get_column_stride(const system_catalog_t* catalog, uint8_t attribute_position);
+
+/**
+ * @brief Returns the size of the columns dbms_unpack_page() fills for a slotted table
+ *
+ * @param catalog Pointer to the system catalog
+ * @return Size in bytes (0 if the table is not slotted)
+ */
+size_t dbms_get_unpacked_size(const system_catalog_t* catalog);
+
+/**
+ * @brief Copies attributes of the live records of a slotted page to fixed positions, strings zero padded
+ * The value of slot s is then at columns + dbms_get_column_offset() + s * dbms_get_column_stride(), so
+ * page kernels can scan slotted pages like PAX ones. Safe to call from several threads.
+ *
+ * @param session Pointer to the DBMS session
+ * @param page Pointer to the page
+ * @param attributes Whether to copy each used attribute
+ * @param columns Filled with the values, dbms_get_unpacked_size() bytes
+ * @return true on success, false if an overflow chain cannot be read
+ */
+bool dbms_unpack_page(const dbms_session_t* session, const page_t* page, const bool* attributes, char* columns);
+
+/**
+ * @brief Checks whether an attribute is dictionary encoded
+ *
+ * @param catalog Pointer to the system catalog
+ * @param attribute_position Position of the attribute (0-based index)
+ * @return true if the pages store a code for the attribute's value
+ */
+bool dbms_is_dictionary_encoded(const system_catalog_t* catalog, uint8_t attribute_position);
+
+/**
+ * @brief Marks a STRING attribute as dictionary encoded, before the table is created
+ * The attribute then takes CATALOG_DICTIONARY_CODE_SIZE bytes of the tuple size (see dbms_get_stored_size).
+ *
+ * @param catalog Pointer to the system catalog
+ * @param attribute_position Position of the attribute (0-based index)
+ * @return true on success, false if the attribute is not a STRING or is already encoded
+ */
+bool dbms_set_dictionary_encoded(system_catalog_t* catalog, uint8_t attribute_position);
+
+/**
+ * @brief Returns the bytes an attribute takes in a page
+ *
+ * @param catalog Pointer to the system catalog
+ * @param attribute_position Position of the attribute (0-based index)
+ * @return CATALOG_DICTIONARY_CODE_SIZE if the attribute is dictionary encoded, else its size (0 if not found)
+ */
+size_t dbms_get_stored_size(const system_catalog_t* catalog, uint8_t attribute_position);
+
+/**
+ * @brief Checks whether a slot of a page holds a tuple
+ *
+ * @param catalog Pointer to the system catalog
+ * @param page Pointer to the page
+ * @param slot_id The slot
+ * @return true if the slot is in use
+ */
+bool dbms_is_slot_live(const system_catalog_t* catalog, const page_t* page, uint64_t slot_id);
+
+/**
+ * @brief Returns the first slot at or after slot_id that holds a tuple
+ * Pages with an occupancy bitmap skip a whole word of free slots at a time.
+ *
+ * @param catalog Pointer to the system catalog
+ * @param page Pointer to the page
+ * @param slot_id The first slot to check
+ * @return The live slot, or dbms_catalog_tuples_per_page() if there is none
+ */
+uint64_t dbms_next_live_slot(const system_catalog_t* catalog, const page_t* page, uint64_t slot_id);
+
+/**
+ * @brief Checks whether the layout starts its pages with an occupancy bitmap (PAX and bitmap pages)
+ *
+ * @param catalog Pointer to the system catalog
+ * @return true if bit s of the 64-bit words at the start of page->data is set for each live slot s
+ */
+bool dbms_has_occupancy_bitmap(const system_catalog_t* catalog);
+
 /**
  * @brief Retrieves a catalog record by attribute position
  *
@@ -266,7 +580,42 @@ bool dbms_init_page(const system_catalog_t* catalog, page_t* page, uint64_t page
 uint8_t dbms_catalog_num_used(const system_catalog_t* catalog);
 
 /**
- * @brief Returns the number of tuples that can fit in a page based on the catalog
+ * @brief Returns the size of the table's pages
+ * Pages of a table larger than PAGE_SIZE use page->data past DATA_SIZE, up to dbms_data_size().
+ *
+ * @param catalog Pointer to the system catalog
+ * @return catalog->page_size, or PAGE_SIZE if it is not set
+ */
+uint32_t dbms_page_size(const system_catalog_t* catalog);
+
+/**
+ * @brief Returns the bytes of page->data in the table's pages
+ *
+ * @param catalog Pointer to the system catalog
+ * @return The page size minus PAGE_HEADER_SIZE
+ */
+size_t dbms_data_size(const system_catalog_t* catalog);
+
+/**
+ * @brief Returns the size of the buffers table pages are read into
+ * Buffer pool frames also hold PAGE_SIZE index pages, so they are never smaller than PAGE_SIZE.
+ *
+ * @param catalog Pointer to the system catalog
+ * @return The larger of the page size and PAGE_SIZE
+ */
+size_t dbms_frame_size(const system_catalog_t* catalog);
+
+/**
+ * @brief Checks whether a table page size is supported
+ *
+ * @param page_size Bytes per page
+ * @return true for a power of two from MIN_PAGE_SIZE to MAX_PAGE_SIZE
+ */
+bool dbms_is_valid_page_size(uint32_t page_size);
+
+/**
+ * @brief Returns the number of tuples that can fit in a page based on the catalog and its layout
+ * For slotted pages this is the most slots a page can have, reached when every record is minimal.
  *
  * @param catalog Pointer to the system catalog
  * @return Number of tuples per page
@@ -315,6 +664,30 @@ tuple_t* dbms_update_tuple(dbms_session_t* session, tuple_id_t tuple_id, attribu
  */
 bool dbms_delete_tuple(dbms_session_t* session, tuple_id_t tuple_id);
 
+/**
+ * @brief Moves a tuple to the first page before it with room for it
+ * The tuple is inserted on the new page and deleted from the old one, so every index and the zone
+ * map follow it. Its tuple ID changes.
+ *
+ * @param session Pointer to the DBMS session
+ * @param tuple_id The ID of the tuple to move
+ * @param first_page_id First page to look for room on, pages from it up to the tuple's page are tried
+ * @return Pointer to the moved tuple, or NULL if it is null or no page has room
+ */
+tuple_t* dbms_relocate_tuple(dbms_session_t* session, tuple_id_t tuple_id, uint64_t first_page_id);
+
+/**
+ * @brief Drops the table pages past page_count and gives their space back to the file system
+ * The buffer pool is flushed first. An uncompressed table file is truncated after the last page,
+ * a compressed one after its last extent.
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_count The number of pages to keep, every tuple on the dropped pages must be deleted
+ * @param punch_holes Also deallocate the free extents left between the pages of a compressed table
+ * @return true on success, false on failure (or if a dropped page is pinned)
+ */
+bool dbms_truncate_table(dbms_session_t* session, uint32_t page_count, bool punch_holes);
+
 /**
  * @brief Retrieves a tuple by its tuple ID
  *
@@ -334,6 +707,37 @@ tuple_t* dbms_get_tuple(dbms_session_t* session, tuple_id_t tuple_id);
  */
 buffer_page_t* dbms_pin_page(dbms_session_t* session, uint64_t page_id);
 
+/**
+ * @brief Pins a buffer page without decoding its tuples (see dbms_get_raw_buffer_page)
+ *
+ * @param session Pointer to the DBMS session
+ * @param page_id ID of the page to pin
+ * @return Pointer to the pinned buffer page, or NULL on failure
+ */
+buffer_page_t* dbms_pin_raw_page(dbms_session_t* session, uint64_t page_id);
+
+/**
+ * @brief Pins a page of another file (e.g. an index file) in the session's buffer pool
+ * The page shares frames and the eviction policy with the table pages, but is never decoded
+ * into tuples. Dirty pages are written back to the given file.
+ *
+ * @param session Pointer to the DBMS session
+ * @param fd File descriptor of the file
+ * @param file_id Identifier of the file in the buffer pool (must not be DBMS_TABLE_FILE_ID)
+ * @param page_id ID of the page within the file
+ * @param is_new If true, the page is not read from disk but zeroed and marked dirty
+ * @return Pointer to the pinned buffer page, or NULL on failure
+ */
+buffer_page_t* dbms_pin_file_page(dbms_session_t* session, int fd, uint16_t file_id, uint64_t page_id, bool is_new);
+
+/**
+ * @brief Writes back and drops every buffer pool page belonging to a file
+ *
+ * @param session Pointer to the DBMS session
+ * @param file_id Identifier of the file in the buffer pool
+ */
+void dbms_flush_file_pages(dbms_session_t* session, uint16_t file_id);
+
 /**
  * @brief Unpins a buffer page, decrementing its reference count.
  * Page becomes eligible for eviction when pin_count reaches 0.
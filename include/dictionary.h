@@ -0,0 +1,110 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include "dbms.h"
+
+// On-disk format: <table file>.dct
+// The magic, then every value in the order it was added: the attribute position (one byte) and the
+// value zero padded to the attribute size. A value's code is its position among the values of its
+// attribute, so codes never change and the file is only appended to.
+#define DICTIONARY_FILE_EXTENSION ".dct"
+#define DICTIONARY_FILE_MAGIC "SSDDCT01"
+#define DICTIONARY_MAX_CODES (1u << (8 * CATALOG_DICTIONARY_CODE_SIZE))
+#define DICTIONARY_NO_CODE UINT32_MAX  // Code of a value that is not in the dictionary, matches no page code
+
+typedef struct {
+  uint8_t attribute_index;
+  uint8_t value_size;   // Attribute size, values are zero padded to it
+  uint32_t count;
+  uint32_t capacity;
+  char* values;         // The value of code c starts at c * value_size, not terminated when it fills it
+  hash_table_t* codes;  // Hash of a value -> its code
+} dictionary_column_t;
+
+struct dictionary {
+  int fd;
+  char* filename;
+  off_t file_size;              // End of the last complete entry, the next one is written there
+  bool is_dirty;                // Entries were written since the last sync
+  uint8_t attribute_count;
+  int16_t* attribute_columns;   // Column of each attribute, -1 if it is not encoded
+  uint8_t column_count;
+  dictionary_column_t* columns;
+};
+
+/**
+ * @brief Writes the empty dictionary file of a new table, or removes a stale one if no attribute is encoded
+ *
+ * @param table_filename Name of the table's database file
+ * @param catalog The table's system catalog
+ * @return true on success, false on failure
+ */
+bool dictionary_create(const char* table_filename, const system_catalog_t* catalog);
+
+/**
+ * @brief Loads the dictionary of a table
+ *
+ * @param session The active session (its catalog must be read)
+ * @return Pointer to the dictionary, or NULL if no attribute is encoded (or on failure)
+ */
+dictionary_t* dictionary_open(const dbms_session_t* session);
+
+/**
+ * @brief Flushes the entries written since the last sync to disk
+ * Must be called before table pages holding their codes are written, see dbms_flush_buffer_pool.
+ *
+ * @param dictionary Pointer to the dictionary (may be NULL)
+ * @return true on success (or if nothing changed), false on failure
+ */
+bool dictionary_sync(dictionary_t* dictionary);
+
+/**
+ * @brief Closes the dictionary file and frees the dictionary
+ *
+ * @param dictionary Pointer to the dictionary (may be NULL)
+ */
+void dictionary_free(dictionary_t* dictionary);
+
+/**
+ * @brief Returns the code of a value, adding the value to the dictionary if it is new
+ * The value is truncated to the attribute size, as it would be stored in a page.
+ *
+ * @param dictionary Pointer to the dictionary
+ * @param attribute_index The encoded attribute
+ * @param value The value
+ * @param code_out Set to the value's code
+ * @return true on success, false if the attribute is not encoded, the dictionary is full or on failure
+ */
+bool dictionary_encode(dictionary_t* dictionary, uint8_t attribute_index, const char* value, uint32_t* code_out);
+
+/**
+ * @brief Finds the code of a value without adding it
+ *
+ * @param dictionary Pointer to the dictionary
+ * @param attribute_index The encoded attribute
+ * @param value The value
+ * @return The code, or DICTIONARY_NO_CODE if no stored value equals it
+ */
+uint32_t dictionary_lookup(const dictionary_t* dictionary, uint8_t attribute_index, const char* value);
+
+/**
+ * @brief Returns the value of a code
+ *
+ * @param dictionary Pointer to the dictionary
+ * @param attribute_index The encoded attribute
+ * @param code The code
+ * @return The value, zero padded to the attribute size and not terminated when it fills it ("" if the code is
+ * unknown)
+ */
+const char* dictionary_decode(const dictionary_t* dictionary, uint8_t attribute_index, uint32_t code);
+
+/**
+ * @brief Returns the number of distinct values of an encoded attribute
+ *
+ * @param dictionary Pointer to the dictionary (may be NULL)
+ * @param attribute_index The attribute
+ * @return Number of codes in use (0 if the attribute is not encoded)
+ */
+uint32_t dictionary_count(const dictionary_t* dictionary, uint8_t attribute_index);
+
+#endif /* DICTIONARY_H */
@@ -1,6 +1,7 @@
 #ifndef EXECUTOR_H
 #define EXECUTOR_H
 
+#include "arena.h"
 #include "dbms.h"
 
 typedef struct Operator Operator;
@@ -19,6 +20,8 @@ struct Operator {
 
     Operator** children;                  // Child operators (NULL for leaf nodes)
     int child_count;
+
+    arena_t* arena;                       // Region the operator was allocated from (NULL for heap)
 };
 
 // Convenience macros
@@ -27,8 +30,30 @@ struct Operator {
 #define OP_CLOSE(op) ((op)->close(op))
 #define OP_RESET(op) ((op)->reset(op))
 
+/**
+ * @brief Allocates zeroed operator memory from an arena, or from the heap when arena is NULL
+ * Memory taken from an arena is released all at once by arena_reset/arena_free.
+ *
+ * @param arena Arena to allocate from (may be NULL)
+ * @param count Number of elements
+ * @param size Size of each element
+ * @return Pointer to the zeroed memory, or NULL on failure
+ */
+void* operator_alloc(arena_t* arena, size_t count, size_t size);
+
+/**
+ * @brief Releases memory obtained with operator_alloc for an operator
+ * Does nothing when the operator lives in an arena.
+ *
+ * @param op Operator that owns the memory
+ * @param ptr Pointer to release (may be NULL)
+ */
+void operator_release(const Operator* op, void* ptr);
+
 /**
  * @brief Frees an operator and its children recursively
+ * Operators created in an arena only release their heap-side resources (files, growable tables);
+ * their memory is reclaimed with the arena.
  *
  * @param op Pointer to the operator to free
  */
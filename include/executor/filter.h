@@ -7,17 +7,21 @@
 typedef struct {
     dbms_session_t* session;
     selection_criteria_t* criteria;
+    uint32_t* proposition_codes;  // Per proposition, resolved on open (see query_resolve_codes)
 } FilterState;
 
 /**
  * @brief Creates a Filter operator that applies a predicate to tuples
+ * An = or != on a dictionary encoded attribute compares the tuple's page code with the code of the
+ * constant, looked up once when the operator is opened, so the child must return the session's tuples.
  *
  * @param child The child operator to filter
  * @param session Pointer to the DBMS session
  * @param criteria The selection criteria (predicates) to apply
+ * @param arena Arena to allocate the operator from (NULL for heap)
  * @return Pointer to the created operator, or NULL on failure
  */
-Operator* filter_create(Operator* child, dbms_session_t* session, selection_criteria_t* criteria);
+Operator* filter_create(Operator* child, dbms_session_t* session, selection_criteria_t* criteria, arena_t* arena);
 
 #endif /* FILTER_H */
 
@@ -0,0 +1,102 @@
+#ifndef HASH_AGGREGATE_H
+#define HASH_AGGREGATE_H
+
+#include "executor/executor.h"
+
+#define AGGREGATE_COUNT 1
+#define AGGREGATE_SUM 2
+#define AGGREGATE_MIN 3
+#define AGGREGATE_MAX 4
+#define AGGREGATE_AVG 5
+
+// Attribute index used by COUNT(*)
+#define AGGREGATE_COUNT_STAR UINT8_MAX
+
+// Memory budget (in groups) used when the caller passes 0
+#define HASH_AGGREGATE_DEFAULT_MAX_GROUPS 65536
+// Number of spill partitions created each time the group table overflows
+#define HASH_AGGREGATE_SPILL_PARTITIONS 16
+// Each spill level consumes log2(HASH_AGGREGATE_SPILL_PARTITIONS) bits of the group hash
+#define HASH_AGGREGATE_SPILL_BITS 4
+#define HASH_AGGREGATE_MAX_SPILL_DEPTH 12
+
+typedef struct {
+    uint8_t function;         // AGGREGATE_* function
+    uint8_t attribute_index;  // Input attribute (AGGREGATE_COUNT_STAR for COUNT(*))
+} aggregate_t;
+
+// Forward declarations (defined in hash_aggregate.c)
+typedef struct AggregateGroupTable AggregateGroupTable;
+typedef struct AggregateSpillPartition AggregateSpillPartition;
+
+typedef struct {
+    dbms_session_t* session;
+    uint8_t* group_indices;        // Child attribute indices to group by
+    uint8_t group_count;
+    bool* encoded_groups;          // Group columns of dictionary encoded attributes, grouped by their code
+    char* group_strings;           // Values of the encoded group columns, decoded for the output tuple
+    aggregate_t* aggregates;       // Aggregates to compute per group
+    uint8_t aggregate_count;
+    size_t max_groups;             // Groups held in memory before spilling
+
+    AggregateGroupTable* groups;   // Open-addressing group table for the current pass
+    bool built;                    // True once the child has been drained
+    size_t emit_index;             // Next group to emit from the current pass
+
+    // Spilling
+    AggregateSpillPartition* pending;  // Partitions waiting to be aggregated
+    AggregateSpillPartition* active;   // Spill target for the current pass (NULL if nothing spilled)
+    uint8_t spill_depth;               // Depth of the current pass (0 = child input)
+    size_t spilled_rows;               // Total rows written to spill files (for diagnostics)
+
+    // Scratch row used for aggregation
+    attribute_value_t* key_scratch;
+    attribute_value_t* input_scratch;
+
+    tuple_t output_tuple;          // Reusable output tuple (group columns, then aggregates)
+    attribute_value_t* output_attrs;
+} HashAggregateState;
+
+/**
+ * @brief Creates a HashAggregate operator (GROUP BY with COUNT/SUM/MIN/MAX/AVG)
+ * Output tuples contain the group columns followed by one attribute per aggregate.
+ * COUNT produces an INT, AVG a FLOAT, and SUM/MIN/MAX the type of their input.
+ * When more than max_groups groups are seen, rows of new groups are hash-partitioned
+ * into temporary spill files and aggregated in later passes. Group columns of dictionary
+ * encoded attributes are hashed and compared by their page code (the child must return the
+ * session's tuples) and only decoded when a group is emitted.
+ *
+ * @param child The child operator to aggregate
+ * @param session Pointer to the DBMS session
+ * @param group_indices Child attribute indices to group by (may be NULL if group_count is 0)
+ * @param group_count Number of group by columns
+ * @param aggregates Array of aggregates to compute
+ * @param aggregate_count Number of aggregates
+ * @param max_groups Memory budget in groups (0 for HASH_AGGREGATE_DEFAULT_MAX_GROUPS)
+ * @param arena Arena for the operator and its fixed-size state (NULL for heap); the group table
+ *              grows and spills independently and always stays on the heap
+ * @return Pointer to the created operator, or NULL on failure
+ */
+Operator* hash_aggregate_create(Operator* child, dbms_session_t* session,
+                                uint8_t* group_indices, uint8_t group_count,
+                                aggregate_t* aggregates, uint8_t aggregate_count,
+                                size_t max_groups, arena_t* arena);
+
+/**
+ * @brief Checks whether an aggregate function can be applied to an attribute type
+ *
+ * @param function The AGGREGATE_* function
+ * @param attribute_type The ATTRIBUTE_TYPE_* of the input attribute
+ * @return true if supported, false otherwise
+ */
+bool hash_aggregate_supports(uint8_t function, uint8_t attribute_type);
+
+/**
+ * @brief Returns the lowercase name of an aggregate function (e.g. "sum")
+ *
+ * @param function The AGGREGATE_* function
+ * @return Name of the function, or "unknown"
+ */
+const char* hash_aggregate_function_name(uint8_t function);
+
+#endif /* HASH_AGGREGATE_H */
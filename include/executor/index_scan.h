@@ -0,0 +1,65 @@
+#ifndef INDEX_SCAN_H
+#define INDEX_SCAN_H
+
+#include "btree.h"
+#include "executor/executor.h"
+#include "index.h"
+#include "query.h"
+
+typedef struct {
+    dbms_session_t* session;
+    uint8_t attribute_index;             // Indexed attribute (the first key attribute of a composite index)
+    index_t* index;                      // Hash index for an equality lookup
+    attribute_value_t keys[INDEX_MAX_ATTRIBUTES];  // Equality value of each key attribute (string_value is not owned)
+
+    btree_t* btree;                      // Set for a range scan over a B+tree index
+    uint64_t low_key;                    // Normalized range bounds (inclusive)
+    uint64_t high_key;
+    proposition_t* bounds;               // Propositions folded into the range, checked per tuple
+    size_t bound_count;
+
+    tuple_id_t* tuple_ids;               // Matches from the index, sorted by page (NULL until opened)
+    size_t tuple_id_count;
+    size_t position;                     // Next tuple ID to visit
+    buffer_page_t* current_buffer_page;  // Currently pinned page
+} IndexScanState;
+
+/**
+ * @brief Creates an IndexScan operator for an equality lookup on an indexed attribute
+ * Tuple IDs from index_lookup are sorted by page so each page is pinned once. The index compares
+ * the actual values, so every tuple it returns matches the key.
+ *
+ * @param session Pointer to the DBMS session (must have an index on the attribute)
+ * @param proposition Equality proposition on the indexed attribute (its value must outlive the operator)
+ * @param arena Arena to allocate the operator from (NULL for heap)
+ * @return Pointer to the created operator, or NULL on failure
+ */
+Operator* index_scan_create(dbms_session_t* session, const proposition_t* proposition, arena_t* arena);
+
+/**
+ * @brief Creates an IndexScan operator for the propositions on one indexed attribute
+ * Prefers a B+tree: every =, <, <=, > and >= on the attribute is folded into one key range
+ * (BETWEEN is written as two propositions) and the leaf chain is walked once. Otherwise the hash
+ * index picked by query_find_hash_index is used: a composite index when all of its attributes have
+ * equality propositions, or an equality on a hash indexed attribute. Returned tuples satisfy the
+ * folded propositions. On an analyzed table the most selective B+tree attribute is picked, and an
+ * index the cost model finds more expensive than a sequential scan is not used.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria (proposition values must outlive the operator)
+ * @param arena Arena to allocate the operator from (NULL for heap)
+ * @return Pointer to the created operator, or NULL if no index applies (or none is worth it)
+ */
+Operator* index_scan_create_for_criteria(dbms_session_t* session, const selection_criteria_t* criteria,
+                                         arena_t* arena);
+
+/**
+ * @brief Finds a proposition that an IndexScan can serve
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria
+ * @return The first equality proposition on an indexed attribute, or NULL if there is none
+ */
+const proposition_t* index_scan_find_proposition(const dbms_session_t* session, const selection_criteria_t* criteria);
+
+#endif /* INDEX_SCAN_H */
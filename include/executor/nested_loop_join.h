@@ -2,6 +2,7 @@
 #define NESTED_LOOP_JOIN_H
 
 #include "executor/executor.h"
+#include "index.h"
 
 typedef struct {
     dbms_session_t* session;
@@ -13,6 +14,13 @@ typedef struct {
     attribute_value_t* combined_attrs;
     uint8_t outer_attr_count;
     uint8_t inner_attr_count;
+
+    // Equi-join only (see nested_loop_join_create_equi)
+    bool is_equi_join;
+    uint8_t outer_join_attribute;
+    uint8_t inner_join_attribute;
+    const index_t* inner_index;        // Hash index on the inner join attribute, its Bloom filter prunes outer tuples
+    uint64_t outer_pruned;             // Outer tuples the inner side was not scanned for
 } NestedLoopJoinState;
 
 /**
@@ -25,12 +33,40 @@ typedef struct {
  * @param session Pointer to the DBMS session
  * @param outer_column_count Number of attributes from outer relation
  * @param inner_column_count Number of attributes from inner relation
+ * @param arena Arena to allocate the operator from (NULL for heap)
  * @return Pointer to the created operator, or NULL on failure
  */
 Operator* nested_loop_join_create(Operator* outer, Operator* inner,
                                   dbms_session_t* session,
                                   uint8_t outer_column_count,
-                                  uint8_t inner_column_count);
+                                  uint8_t inner_column_count,
+                                  arena_t* arena);
+
+/**
+ * @brief Creates a Nested Loop Join operator that only combines tuples whose join attributes are equal
+ * When the inner table has a single-attribute hash index on its join attribute, the index's
+ * Bloom filter is probed with each outer value first and the inner relation is not scanned
+ * at all for values it definitely does not hold.
+ *
+ * @param outer The outer (left) child operator
+ * @param inner The inner (right) child operator
+ * @param session Pointer to the DBMS session
+ * @param outer_column_count Number of attributes from outer relation
+ * @param inner_column_count Number of attributes from inner relation
+ * @param outer_join_attribute Join attribute of the outer tuples
+ * @param inner_join_attribute Join attribute of the inner tuples (same type)
+ * @param inner_index Hash index on inner_join_attribute (may be NULL)
+ * @param arena Arena to allocate the operator from (NULL for heap)
+ * @return Pointer to the created operator, or NULL on failure
+ */
+Operator* nested_loop_join_create_equi(Operator* outer, Operator* inner,
+                                       dbms_session_t* session,
+                                       uint8_t outer_column_count,
+                                       uint8_t inner_column_count,
+                                       uint8_t outer_join_attribute,
+                                       uint8_t inner_join_attribute,
+                                       const index_t* inner_index,
+                                       arena_t* arena);
 
 #endif /* NESTED_LOOP_JOIN_H */
 
@@ -26,11 +26,12 @@ typedef struct {
  * @param column_indices Array of attribute indices to include in projection
  * @param column_count Number of columns to project
  * @param is_distinct If true, eliminate duplicate tuples
+ * @param arena Arena to allocate the operator from (NULL for heap)
  * @return Pointer to the created operator, or NULL on failure
  */
 Operator* project_create(Operator* child, dbms_session_t* session,
                          uint8_t* column_indices, uint8_t column_count,
-                         bool is_distinct);
+                         bool is_distinct, arena_t* arena);
 
 #endif /* PROJECT_H */
 
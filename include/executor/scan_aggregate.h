@@ -0,0 +1,58 @@
+#ifndef SCAN_AGGREGATE_H
+#define SCAN_AGGREGATE_H
+
+#include "executor/executor.h"
+#include "executor/hash_aggregate.h"
+#include "query.h"
+
+// Forward declaration (defined in scan_aggregate.c)
+typedef struct ScanAggregateAccumulator ScanAggregateAccumulator;
+
+typedef struct {
+    dbms_session_t* session;
+    selection_criteria_t* criteria;          // Predicates applied before aggregating (not owned)
+    aggregate_t* aggregates;
+    uint8_t aggregate_count;
+    bool done;                               // True once the single result row was returned
+
+    uint64_t tuples_per_page;
+    off_t* proposition_offsets;              // Page data offset of each predicate attribute's slot 0 value
+    size_t* proposition_strides;             // Bytes between consecutive slots (contiguous on PAX pages)
+    uint32_t* proposition_codes;             // Code of the constant of each predicate on a dictionary encoded attribute
+    uint8_t** proposition_matches;           // Per code result of each ordering predicate on an encoded attribute
+    off_t* aggregate_offsets;                // Page data offset of each aggregate input's slot 0 value
+    size_t* aggregate_strides;
+    uint8_t* mask;                           // Per-slot selection mask of the current page
+    void* column;                            // Selected values of the current page, packed for SIMD reduction
+    bool* unpacked_attributes;               // Attributes the predicates and aggregates read (slotted tables only)
+    char* unpacked_columns;                  // The current slotted page's records unpacked into columns, else NULL
+    ScanAggregateAccumulator* accumulators;
+    uint64_t rows_matched;
+    index_t* count_index;                    // Answers COUNT-only aggregates of one equality from the hash index
+
+    tuple_t output_tuple;                    // Reusable output tuple (one attribute per aggregate)
+    attribute_value_t* output_attrs;
+} ScanAggregateState;
+
+/**
+ * @brief Creates a ScanAggregate operator for ungrouped aggregates over a whole table
+ * Reads each page raw (tuples are never decoded into tuple_t), evaluates the predicates
+ * into a selection mask at the catalog attribute offsets (contiguous columns on PAX pages, the
+ * records of slotted pages are first unpacked into such columns), packs the selected values and reduces them with SIMD sum/min/max kernels. Equalities on dictionary encoded
+ * attributes compare the codes on the page to the constant's code, other comparisons look the codes up in a
+ * table evaluated once per dictionary value. Produces a single row with the same
+ * output types as hash_aggregate_create without group columns. When every aggregate is a
+ * COUNT and the only predicate is an equality on a hash-indexed attribute, the count comes
+ * from the index and no table page is read.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria to apply (may be NULL)
+ * @param aggregates Array of aggregates to compute
+ * @param aggregate_count Number of aggregates
+ * @param arena Arena to allocate the operator from (NULL for heap)
+ * @return Pointer to the created operator, or NULL on failure
+ */
+Operator* scan_aggregate_create(dbms_session_t* session, selection_criteria_t* criteria, aggregate_t* aggregates,
+                                uint8_t aggregate_count, arena_t* arena);
+
+#endif /* SCAN_AGGREGATE_H */
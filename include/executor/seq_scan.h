@@ -2,22 +2,39 @@
 #define SEQ_SCAN_H
 
 #include "executor/executor.h"
+#include "query.h"
 
 typedef struct {
     dbms_session_t* session;
     uint64_t current_page_id;
     uint64_t current_slot_id;
     uint64_t tuples_per_page;
-    buffer_page_t* current_buffer_page;  // Currently pinned page
+    buffer_page_t* current_buffer_page;  // Currently pinned page, or page_view
+    buffer_page_t* page_view;            // Decodes the pages of a mapped table in place of the buffer pool (NULL if not mapped)
+    const selection_criteria_t* criteria;  // Pages the zone map rules out are not read (not owned, may be NULL)
+    uint64_t pages_skipped;              // Pages skipped by the current scan
 } SeqScanState;
 
 /**
  * @brief Creates a SeqScan operator for sequential table scanning
  *
  * @param session Pointer to the DBMS session
+ * @param arena Arena to allocate the operator from (NULL for heap)
  * @return Pointer to the created operator, or NULL on failure
  */
-Operator* seq_scan_create(dbms_session_t* session);
+Operator* seq_scan_create(dbms_session_t* session, arena_t* arena);
+
+/**
+ * @brief Creates a SeqScan operator that skips the pages whose zone map ranges cannot satisfy
+ * the criteria (every proposition must hold). Tuples of the pages read are returned unfiltered,
+ * the criteria still have to be applied by a Filter above the scan.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria used to skip pages (may be NULL, must outlive the operator)
+ * @param arena Arena to allocate the operator from (NULL for heap)
+ * @return Pointer to the created operator, or NULL on failure
+ */
+Operator* seq_scan_create_for_criteria(dbms_session_t* session, const selection_criteria_t* criteria, arena_t* arena);
 
 #endif /* SEQ_SCAN_H */
 
@@ -1,23 +1,111 @@
 #ifndef INDEX_H
 #define INDEX_H
 
+#include "bloom.h"
 #include "dbms.h"
 
 // Configuration for Lazy-Split Linear Hashing
-// Split when load factor > 0.75 AND the split candidate chain > 3 nodes
+// Split when the primary blocks are > 75% full AND the split candidate has an overflow block
 #define LOAD_FACTOR_NUMERATOR 3
 #define LOAD_FACTOR_DENOMINATOR 4
-#define LAZY_SPLIT_THRESHOLD 3 
+#define LAZY_SPLIT_THRESHOLD 2 // Blocks in the candidate chain
 
-// Simple chained hash node for storing Tuple IDs
-typedef struct index_node {
+// Bucket block of two cache lines. Probes compare the keys in the first line and only
+// read the second one (packed tuple IDs and the overflow link) on a match or to move on.
+// Keys are the INT, FLOAT or BOOL value itself, or a hash for STRING (see index_encode_key)
+// and for composite keys, whose encoded values are then kept per entry and compared on a match.
+#define INDEX_BLOCK_ENTRIES 7
+#define INDEX_CACHE_LINE_SIZE 64
+// Tuple IDs are packed as (page_id << INDEX_SLOT_BITS) | slot_id
+#define INDEX_SLOT_BITS 16
+// Composite indexes cover up to this many attributes
+#define INDEX_MAX_ATTRIBUTES 4
+#define INDEX_MAX_VALUE_SIZE (INDEX_MAX_ATTRIBUTES * UINT8_MAX)
+
+typedef struct index_block {
+  _Alignas(INDEX_CACHE_LINE_SIZE) uint64_t keys[INDEX_BLOCK_ENTRIES];
+  uint32_t count;  // Entries used, every block but the first of a chain is full
+  uint32_t reserved;
+  uint64_t tuple_ids[INDEX_BLOCK_ENTRIES];
+  struct index_block* next;  // Overflow block
+  unsigned char* values[];   // STRING and composite indexes only: a third cache line with each entry's encoded values
+} index_block_t;
+
+// Blocks are carved from slabs instead of being allocated one by one
+#define INDEX_SLAB_BLOCKS 512
+
+typedef struct index_slab {
+  struct index_slab* next;
+  size_t used;  // Blocks handed out from this slab so far
+  _Alignas(INDEX_CACHE_LINE_SIZE) unsigned char blocks[];  // INDEX_SLAB_BLOCKS blocks of block_size bytes
+} index_slab_t;
+
+typedef struct {
+  index_slab_t* slabs;        // Most recent slab first, new blocks are bumped from the head
+  index_block_t* free_blocks; // Emptied blocks, linked through next and reused first
+  size_t block_size;          // sizeof(index_block_t), plus a cache line of value pointers when values are kept
+} index_allocator_t;
+
+// On-disk format: <table file>.<attribute name>.hix, <table file>.<name>+<name>....hix for composite indexes
+// Page 0 holds index_file_meta_t. Buckets are stored in groups of INDEX_FILE_GROUP_BUCKETS,
+// each group is a primary page followed by overflow pages holding the entries of its buckets
+// in bucket order, and a chain of directory pages maps each group to its primary page.
+#define INDEX_FILE_EXTENSION ".hix"
+#define INDEX_FILE_MAGIC "SSDHIX01"
+#define INDEX_FILE_GROUP_BUCKETS 64
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint8_t attribute_count;
+  uint8_t reserved;
+  uint16_t value_size;  // Bytes of encoded values stored per entry
+  uint8_t attribute_indexes[INDEX_MAX_ATTRIBUTES];
+  uint8_t attribute_types[INDEX_MAX_ATTRIBUTES];
+  uint64_t initial_bucket_count;
+  uint64_t bucket_count;
+  uint64_t level;
+  uint64_t next_split;
+  uint64_t num_records;
+  uint64_t page_count;      // Pages in the file, including this one
+  uint64_t directory_page;  // First directory page
+  uint64_t free_page;       // First unused page (chained through next_page), 0 if none
+} index_file_meta_t;
+
+typedef struct {
+  uint64_t next_page;  // Next overflow (or directory, or free) page, 0 for the last one
+  uint64_t first;      // Group of a group page, first group covered by a directory page
+  uint64_t count;      // Entries used in this page
+} index_file_page_header_t;
+
+// STRING and composite indexes follow each entry with value_size bytes of encoded values
+typedef struct {
   uint64_t key;
   tuple_id_t tuple_id;
-  struct index_node* next;
-} index_node_t;
+} index_file_entry_t;
+
+#define INDEX_FILE_PAGE_ENTRIES ((PAGE_SIZE - sizeof(index_file_page_header_t)) / sizeof(index_file_entry_t))
+#define INDEX_FILE_DIRECTORY_ENTRIES ((PAGE_SIZE - sizeof(index_file_page_header_t)) / sizeof(uint64_t))
+
+typedef struct {
+  index_file_page_header_t header;
+  union {
+    index_file_entry_t entries[INDEX_FILE_PAGE_ENTRIES];
+    unsigned char data[PAGE_SIZE - sizeof(index_file_page_header_t)];  // Entries with their string values
+    uint64_t group_pages[INDEX_FILE_DIRECTORY_ENTRIES];  // Primary page of each group
+  };
+} index_file_page_t;
+
+// Pages of the index file that currently hold one bucket group (or the directory)
+typedef struct {
+  uint64_t* page_ids;  // Primary page first, then its overflow pages
+  size_t count;
+  size_t capacity;
+  bool is_dirty;       // In-memory chain differs from the pages on disk
+} index_page_list_t;
 
 struct index {
-  index_node_t** buckets;
+  index_block_t** buckets;
   
   // Linear Hashing State
   size_t capacity;
@@ -26,10 +114,32 @@ struct index {
   size_t num_records;           // Total records in index
   size_t level;                 // Current level (L)
   size_t next_split;            // Split pointer (p)
+
+  index_allocator_t allocator;  // Block storage, released slab by slab in index_free
+  bloom_filter_t* bloom;        // Keys of the entries, probed before the buckets (rebuilt once outgrown)
+
+  // Persistence (fd is -1 when the index only lives in memory)
+  int fd;
+  char* filename;
+  uint8_t attribute_count;                          // Key attributes, more than one for a composite index
+  uint8_t attribute_indexes[INDEX_MAX_ATTRIBUTES];  // In key order
+  uint8_t attribute_types[INDEX_MAX_ATTRIBUTES];
+  uint8_t value_sizes[INDEX_MAX_ATTRIBUTES];        // Encoded bytes of each key attribute
+  uint16_t value_size;              // Encoded value bytes kept per entry, 0 when the key alone is exact
+  size_t file_entry_size;           // Bytes per entry in a group page
+  size_t file_page_entries;         // Entries per group page
+  index_page_list_t* group_pages;   // Per bucket group (capacity / INDEX_FILE_GROUP_BUCKETS entries), written back by index_sync
+  index_page_list_t directory_pages;
+  index_page_list_t free_pages;     // Unused pages of the file, reused before the file grows
+  uint64_t page_count;
+  bool meta_dirty;
 };
 
 /**
  * @brief Creates and populates an index for a specific attribute
+ * The table pages are scanned in parallel and the entries partitioned by bucket, then the
+ * buckets are built once at their final count (no splits) and written to the index file,
+ * replacing any previous one.
  *
  * @param session The active session
  * @param attribute_index The index of the attribute to index
@@ -37,8 +147,58 @@ struct index {
  */
 index_t* index_create(dbms_session_t* session, uint8_t attribute_index);
 
+/**
+ * @brief Loads the index of an attribute from its index file
+ * Only the index file is read, the table is not scanned.
+ *
+ * @param session The active session
+ * @param attribute_index The index of the attribute
+ * @return Pointer to the index, or NULL if there is no (valid) index file
+ */
+index_t* index_open(dbms_session_t* session, uint8_t attribute_index);
+
+/**
+ * @brief Creates and populates a composite index over several attributes
+ * Built and persisted like index_create, in <table file>.<name>+<name>....hix. An open index
+ * on the same attributes must be freed first.
+ *
+ * @param session The active session
+ * @param attribute_indexes The attributes of the key, in key order
+ * @param attribute_count Number of key attributes (2 to INDEX_MAX_ATTRIBUTES)
+ * @return Pointer to the created index, or NULL on failure
+ */
+index_t* index_create_composite(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count);
+
+/**
+ * @brief Loads a composite index from its index file
+ *
+ * @param session The active session
+ * @param attribute_indexes The attributes of the key, in key order
+ * @param attribute_count Number of key attributes
+ * @return Pointer to the index, or NULL if there is no (valid) index file
+ */
+index_t* index_open_composite(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count);
+
+/**
+ * @brief Collects the key values of a tuple in key order
+ *
+ * @param idx Pointer to the index
+ * @param attributes The tuple's attribute values
+ * @param values Output, one value per key attribute (strings are not copied)
+ */
+void index_get_key_values(const index_t* idx, const attribute_value_t* attributes, attribute_value_t* values);
+
+/**
+ * @brief Writes the bucket groups changed since the last sync, the directory and the metadata to the index file
+ *
+ * @param idx Pointer to the index
+ * @return true on success (or if the index is not persisted), false on failure
+ */
+bool index_sync(index_t* idx);
+
 /**
  * @brief Frees the index memory
+ * Persisted indexes are synced and their file is closed first.
  * 
  * @param idx Pointer to the index
  */
@@ -46,39 +206,70 @@ void index_free(index_t* idx);
 
 /**
  * @brief Inserts an entry into the index using Lazy-Split Linear Hashing
+ * STRING values are copied, the index owns its keys.
  * 
  * @param idx Pointer to the index
- * @param key Hash of the attribute value
+ * @param values The key values, one per key attribute in key order (see index_get_key_values)
  * @param tuple_id The tuple ID
  */
-void index_insert(index_t* idx, uint64_t key, tuple_id_t tuple_id);
+void index_insert(index_t* idx, const attribute_value_t* values, tuple_id_t tuple_id);
 
 /**
  * @brief Removes a specific tuple entry from the index
  * 
  * @param idx Pointer to the index
- * @param key Hash of the attribute value
+ * @param values The key values of the tuple
  * @param tuple_id The tuple ID to remove
  * @return true if found and removed
  */
-bool index_delete(index_t* idx, uint64_t key, tuple_id_t tuple_id);
+bool index_delete(index_t* idx, const attribute_value_t* values, tuple_id_t tuple_id);
 
 /**
- * @brief Retrieves all Tuple IDs matching the key
+ * @brief Retrieves all Tuple IDs whose key values equal the given values
+ * Keys are compared exactly, so there are no hash collision false positives.
  * 
  * @param idx Pointer to the index
- * @param key Hash of the attribute value
+ * @param values The values to look up, one per key attribute in key order
  * @param out_count Pointer to store the number of results
  * @return Malloc'd array of tuple_id_t (caller must free), or NULL if none found
  */
-tuple_id_t* index_lookup(index_t* idx, uint64_t key, size_t* out_count);
+tuple_id_t* index_lookup(index_t* idx, const attribute_value_t* values, size_t* out_count);
+
+/**
+ * @brief Checks the index's Bloom filter for the given values without walking a bucket
+ * Deleted keys may still be reported, keys that were never inserted are not (but for the
+ * filter's false positives).
+ *
+ * @param idx Pointer to the index
+ * @param values The values to probe, one per key attribute in key order
+ * @return false if no entry has these values, true if one may have
+ */
+bool index_may_contain(const index_t* idx, const attribute_value_t* values);
+
+/**
+ * @brief Counts the entries whose key values equal the given values without reading table pages
+ *
+ * @param idx Pointer to the index
+ * @param values The values to count, one per key attribute in key order
+ * @return Number of matching tuples
+ */
+size_t index_count(index_t* idx, const attribute_value_t* values);
+
+/**
+ * @brief Sorts tuple IDs by page, then slot, so matching pages can be visited once each
+ *
+ * @param tuple_ids Array of tuple IDs (e.g. from index_lookup)
+ * @param count Number of tuple IDs
+ */
+void index_sort_tuple_ids(tuple_id_t* tuple_ids, size_t count);
 
 /**
- * @brief Helper to hash an attribute value
+ * @brief Encodes an attribute value as an index key
+ * INT, FLOAT and BOOL keys are the value itself, STRING keys are a hash of the string.
  * 
  * @param value Pointer to the attribute value
- * @return uint64_t hash
+ * @return uint64_t key
  */
-uint64_t index_hash_attribute(const attribute_value_t* value);
+uint64_t index_encode_key(const attribute_value_t* value);
 
 #endif /* INDEX_H */
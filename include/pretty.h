@@ -13,6 +13,13 @@
  */
 void print_catalog(const system_catalog_t* catalog);
 
+/**
+ * @brief Prints the statistics of an analyzed table to stdout
+ *
+ * @param session Pointer to the DBMS session
+ */
+void print_stats(const dbms_session_t* session);
+
 /**
  * @brief Prints the contents of a page to stdout
  *
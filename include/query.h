@@ -1,6 +1,7 @@
 #ifndef QUERY_H
 #define QUERY_H
 
+#include "arena.h"
 #include "dbms.h"
 
 #define OPERATOR_EQUAL 1
@@ -16,6 +17,9 @@ typedef struct {
   attribute_value_t value;
 } proposition_t;
 
+// Code query_resolve_codes gives a proposition that is compared on the decoded values
+#define QUERY_COMPARE_VALUES (UINT32_MAX - 1)
+
 typedef struct {
   proposition_t* propositions;
   size_t proposition_count;
@@ -26,10 +30,23 @@ typedef struct {
   attribute_value_t** rows;
   size_t row_count;
   size_t column_count;
+  size_t row_capacity;  // Allocated length of rows (grows by doubling)
+  arena_t* arena;       // Region holding the result, its rows and their strings
+  bool owns_arena;      // True if query_free_query_result frees the arena
 } query_result_t;
 
+/**
+ * @brief Callback invoked for each row streamed by query_select_stream
+ *
+ * @param tuple The matching tuple (points into the buffer pool, only valid during the call)
+ * @param context User provided context
+ * @return true to continue streaming, false to stop
+ */
+typedef bool (*query_row_callback_t)(const tuple_t* tuple, void* context);
+
 /**
  * @brief Frees the memory allocated for a query result
+ * Results built in a caller's arena are left for the caller to reset/free.
  *
  * @param result Pointer to the query result to free
  */
@@ -45,6 +62,59 @@ void query_free_query_result(query_result_t* result);
  */
 query_result_t* query_select(dbms_session_t* session, selection_criteria_t* criteria);
 
+/**
+ * @brief Executes a SELECT query, materializing the result in the given arena
+ * The result, its column names, rows and strings are all allocated from the arena
+ * and are released together with it.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria Pointer to the selection criteria
+ * @param arena Arena to allocate the result from
+ * @return Pointer to the query result, or NULL on failure
+ */
+query_result_t* query_select_arena(dbms_session_t* session, selection_criteria_t* criteria, arena_t* arena);
+
+/**
+ * @brief Executes a SELECT query and streams each matching tuple to a callback
+ * Nothing is copied, the callback sees the tuples in place.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria Pointer to the selection criteria
+ * @param callback Function called for each matching tuple
+ * @param context User context passed to the callback
+ * @return Number of tuples passed to the callback (-1 on failure)
+ */
+int query_select_stream(dbms_session_t* session, selection_criteria_t* criteria, query_row_callback_t callback,
+                        void* context);
+
+/**
+ * @brief Finds the hash index that answers equality propositions of the criteria
+ * A composite index applies when every one of its attributes has an equality proposition, the one
+ * covering the most attributes wins. Otherwise the first equality on a hash indexed attribute is used, or
+ * the most selective one once the table is analyzed (see stats_analyze). An analyzed table also gets NULL
+ * when the cost model estimates a sequential scan to be cheaper than fetching the matches.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria
+ * @param keys Output, the equality value of each key attribute in key order (room for INDEX_MAX_ATTRIBUTES,
+ *             strings are not copied)
+ * @return The index to pass keys to index_lookup with, or NULL if no hash index applies
+ */
+index_t* query_find_hash_index(const dbms_session_t* session, const selection_criteria_t* criteria,
+                               attribute_value_t* keys);
+
+/**
+ * @brief Resolves the constant of every = and != proposition on a dictionary encoded attribute to its code
+ * Tuples decoded from the table's pages carry the page code of those attributes (dictionary_code), so the
+ * propositions are decided by an integer compare instead of a string compare.
+ *
+ * @param session Pointer to the DBMS session
+ * @param criteria The selection criteria
+ * @param codes Output, per proposition: the constant's code, DICTIONARY_NO_CODE if the dictionary does not hold
+ *              it (no tuple equals it), or QUERY_COMPARE_VALUES if the proposition compares the values
+ */
+void query_resolve_codes(const dbms_session_t* session, const selection_criteria_t* criteria, uint32_t* codes);
+
 /**
  * @brief Executes a DELETE query on the DBMS session with the given selection criteria
  *
@@ -0,0 +1,80 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Sums an array of 32-bit integers into a 64-bit accumulator
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values
+ * @return The sum of all values
+ */
+int64_t simd_sum_i32(const int32_t* values, size_t count);
+
+/**
+ * @brief Returns the minimum of an array of 32-bit integers
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values (must be greater than 0)
+ * @return The minimum value
+ */
+int32_t simd_min_i32(const int32_t* values, size_t count);
+
+/**
+ * @brief Returns the maximum of an array of 32-bit integers
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values (must be greater than 0)
+ * @return The maximum value
+ */
+int32_t simd_max_i32(const int32_t* values, size_t count);
+
+/**
+ * @brief Sums an array of 32-bit floats, accumulating in double precision
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values
+ * @return The sum of all values
+ */
+double simd_sum_f32(const float* values, size_t count);
+
+/**
+ * @brief Returns the minimum of an array of 32-bit floats
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values (must be greater than 0)
+ * @return The minimum value
+ */
+float simd_min_f32(const float* values, size_t count);
+
+/**
+ * @brief Returns the maximum of an array of 32-bit floats
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values (must be greater than 0)
+ * @return The maximum value
+ */
+float simd_max_f32(const float* values, size_t count);
+
+/**
+ * @brief Finds the positions of a key in an array of 64-bit values
+ *
+ * @param values Pointer to the values (no alignment requirement)
+ * @param count Number of values (at most 32)
+ * @param key Value to look for
+ * @return Bitmask with bit i set when values[i] == key
+ */
+uint32_t simd_match_u64(const uint64_t* values, size_t count, uint64_t key);
+
+/**
+ * @brief Finds the positions of a byte in 16 consecutive bytes
+ *
+ * @param bytes Pointer to the 16 bytes (no alignment requirement)
+ * @param byte Byte to look for
+ * @return Bitmask with bit i set when bytes[i] == byte
+ */
+uint32_t simd_match_u8x16(const uint8_t* bytes, uint8_t byte);
+
+#endif /* SIMD_H */
@@ -0,0 +1,247 @@
+#ifndef SLOTTED_H
+#define SLOTTED_H
+
+#include "dbms.h"
+
+// Slotted page: page->data starts with a slot directory and ends with a heap of records growing down
+// towards it from the end of the data (dbms_data_size). page->tuples_per_page is the number of directory entries and page->free_space_head the
+// start of the heap. A directory entry is the record's offset in page->data (0 if the slot is free)
+// and its allocated length. Records move when the page is compacted, slot ids never do.
+//
+// Record: the null byte, the fixed-size values (INT, FLOAT, BOOL and dictionary codes) in attribute
+// order, one length byte per plain STRING and then the string bytes, unpadded. A record longer than
+// SLOTTED_INLINE_LIMIT keeps its string bytes in the overflow file, the record then ends with the
+// first overflow page of their chain instead (SLOTTED_OVERFLOW_FLAG set in its directory length).
+#define SLOTTED_SLOT_SIZE 4
+#define SLOTTED_OVERFLOW_FLAG 0x8000
+#define SLOTTED_LENGTH_MASK 0x7FFF
+#define SLOTTED_INLINE_LIMIT(data_size) ((data_size) / 4)
+#define SLOTTED_OVERFLOW_POINTER_SIZE sizeof(uint64_t)
+
+// On-disk format: <table file>.ovf
+// A header page holding the magic, the page count and the head of the free page list, then pages of
+// string bytes, each starting with the next page of its chain and the bytes it holds.
+#define OVERFLOW_FILE_EXTENSION ".ovf"
+#define OVERFLOW_FILE_MAGIC "SSDOVF01"
+#define OVERFLOW_PAGE_HEADER_SIZE 16
+#define OVERFLOW_PAGE_CAPACITY (PAGE_SIZE - OVERFLOW_PAGE_HEADER_SIZE)
+#define OVERFLOW_NO_PAGE 0
+
+typedef struct {
+  uint8_t attribute_count;                   // Used attributes
+  uint8_t types[CATALOG_MAX_RECORDS];        // Attribute type, a dictionary encoded STRING is stored as its code
+  bool is_variable[CATALOG_MAX_RECORDS];     // Plain STRING, stored with a length byte
+  uint16_t offsets[CATALOG_MAX_RECORDS];     // Offset of the value, or of the length byte, in the record
+  uint8_t sizes[CATALOG_MAX_RECORDS];        // Stored size, the largest length of a variable attribute
+  uint16_t prefix_size;                      // Null byte, fixed-size values and length bytes
+  uint16_t min_record_size;                  // Every record takes at least this much, room for an overflow stub
+  uint16_t max_record_size;                  // Record with every string at full length
+} slotted_format_t;
+
+struct overflow_file {
+  int fd;
+  char* filename;
+  uint64_t page_count;   // Pages after the header page
+  uint64_t free_head;    // First page of the free list, OVERFLOW_NO_PAGE if empty
+  uint64_t* released;    // Chains freed since the last sync, table pages on disk may still point to them
+  size_t released_count;
+  size_t released_capacity;
+  bool is_dirty;         // Pages or the header changed since the last sync
+};
+
+/**
+ * @brief Resolves where each attribute is stored in the records of a slotted table
+ *
+ * @param catalog Pointer to the system catalog
+ * @param format Filled with the record format
+ */
+void slotted_get_format(const system_catalog_t* catalog, slotted_format_t* format);
+
+/**
+ * @brief Returns how many slots a page can have, every record taking at least min_record_size bytes
+ *
+ * @param catalog Pointer to the system catalog
+ * @return Maximum directory entries of a page
+ */
+uint64_t slotted_max_slots(const system_catalog_t* catalog);
+
+/**
+ * @brief Encodes a tuple into a record with its strings inline
+ *
+ * @param format The record format
+ * @param attributes The attribute values
+ * @param codes The codes of the dictionary encoded attributes (see dbms_insert_tuple)
+ * @param record Filled with the record, at least max_record_size bytes
+ * @return Length of the record
+ */
+size_t slotted_encode_record(const slotted_format_t* format, const attribute_value_t* attributes,
+                             const uint32_t* codes, char* record);
+
+/**
+ * @brief Resolves where each attribute's value is in a record
+ *
+ * @param format The record format
+ * @param record The record
+ * @param strings The string bytes, after the prefix for an inline record or read from the overflow file
+ * @param values Filled with a pointer to each value
+ * @param lengths Filled with the length of each value (the stored size for fixed-size attributes)
+ */
+void slotted_locate_values(const slotted_format_t* format, const char* record, const char* strings,
+                           const char** values, uint8_t* lengths);
+
+/**
+ * @brief Returns the number of string bytes of a record, inline or in the overflow file
+ *
+ * @param format The record format
+ * @param record The record
+ * @return Sum of the length bytes
+ */
+size_t slotted_strings_size(const slotted_format_t* format, const char* record);
+
+/**
+ * @brief Initializes an empty slotted page
+ *
+ * @param page Pointer to the page
+ * @param data_size Bytes of page->data, see dbms_data_size
+ */
+void slotted_init_page(page_t* page, size_t data_size);
+
+/**
+ * @brief Checks whether a slot of a slotted page holds a record
+ *
+ * @param page Pointer to the page
+ * @param slot_id The slot
+ * @return true if the slot is in use
+ */
+bool slotted_is_live(const page_t* page, uint64_t slot_id);
+
+/**
+ * @brief Returns the record of a slot
+ *
+ * @param page Pointer to the page
+ * @param slot_id The slot
+ * @param is_overflow Set to whether the record's strings are in the overflow file (may be NULL)
+ * @return Pointer to the record, or NULL if the slot is free
+ */
+const char* slotted_get_record(const page_t* page, uint64_t slot_id, bool* is_overflow);
+
+/**
+ * @brief Returns the first free slot of a page
+ *
+ * @param page Pointer to the page
+ * @return The lowest free directory entry, or the next new one (tuples_per_page)
+ */
+uint64_t slotted_find_free_slot(const page_t* page);
+
+/**
+ * @brief Checks whether a record of the given length can be added to a page, after compaction if needed
+ *
+ * @param page Pointer to the page
+ * @param size Record length
+ * @param max_slots See slotted_max_slots
+ * @param data_size Bytes of page->data, see dbms_data_size
+ * @return true if slotted_allocate() will succeed for slotted_find_free_slot()
+ */
+bool slotted_has_space(const page_t* page, size_t size, uint64_t max_slots, size_t data_size);
+
+/**
+ * @brief Allocates a record for a slot, replacing the record it held, compacting the page if needed
+ *
+ * @param page Pointer to the page
+ * @param slot_id The slot, at most tuples_per_page
+ * @param size Record length, at least min_record_size
+ * @param is_overflow Whether the record's strings are in the overflow file
+ * @param data_size Bytes of page->data, see dbms_data_size
+ * @return Pointer to the record to fill, or NULL if the page does not have the space (the page is unchanged)
+ */
+char* slotted_allocate(page_t* page, uint64_t slot_id, size_t size, bool is_overflow, size_t data_size);
+
+/**
+ * @brief Frees the record of a slot, dropping free entries from the end of the directory
+ *
+ * @param page Pointer to the page
+ * @param slot_id The slot
+ * @param data_size Bytes of page->data, see dbms_data_size
+ */
+void slotted_release(page_t* page, uint64_t slot_id, size_t data_size);
+
+/**
+ * @brief Moves the records to the end of the page so its free space is contiguous, slots keep their ids
+ *
+ * @param page Pointer to the page
+ * @param data_size Bytes of page->data, see dbms_data_size
+ */
+void slotted_compact(page_t* page, size_t data_size);
+
+/**
+ * @brief Writes the overflow file of a new slotted table, or removes a stale one for another layout
+ *
+ * @param table_filename Name of the table's database file
+ * @param catalog The table's system catalog
+ * @return true on success, false on failure
+ */
+bool slotted_overflow_create(const char* table_filename, const system_catalog_t* catalog);
+
+/**
+ * @brief Opens the overflow file of a slotted table
+ *
+ * @param session The active session (its catalog must be read)
+ * @return Pointer to the overflow file, or NULL if the table is not slotted (or on failure)
+ */
+overflow_file_t* slotted_overflow_open(const dbms_session_t* session);
+
+/**
+ * @brief Writes string bytes to a new chain of overflow pages
+ *
+ * @param overflow Pointer to the overflow file
+ * @param data The bytes
+ * @param size Number of bytes (at least 1)
+ * @return First page of the chain, or OVERFLOW_NO_PAGE on failure
+ */
+uint64_t slotted_overflow_write(overflow_file_t* overflow, const char* data, size_t size);
+
+/**
+ * @brief Reads the bytes of a chain, safe to call from several threads while no chain is written
+ *
+ * @param overflow Pointer to the overflow file
+ * @param first_page First page of the chain
+ * @param data Filled with the bytes
+ * @param size Number of bytes the chain holds
+ * @return true on success, false if the chain is corrupt or on failure
+ */
+bool slotted_overflow_read(const overflow_file_t* overflow, uint64_t first_page, char* data, size_t size);
+
+/**
+ * @brief Frees a chain, its pages are reused once the table pages are flushed (see slotted_overflow_reclaim)
+ *
+ * @param overflow Pointer to the overflow file
+ * @param first_page First page of the chain
+ * @return true on success, false on failure
+ */
+bool slotted_overflow_release(overflow_file_t* overflow, uint64_t first_page);
+
+/**
+ * @brief Writes the header and flushes the overflow file to disk
+ * Must be called before table pages pointing to new chains are written, see dbms_flush_buffer_pool.
+ *
+ * @param overflow Pointer to the overflow file (may be NULL)
+ * @return true on success (or if nothing changed), false on failure
+ */
+bool slotted_overflow_sync(overflow_file_t* overflow);
+
+/**
+ * @brief Adds the chains released since the last call to the free list
+ * Must be called once the table pages that stopped pointing to them are on disk.
+ *
+ * @param overflow Pointer to the overflow file (may be NULL)
+ */
+void slotted_overflow_reclaim(overflow_file_t* overflow);
+
+/**
+ * @brief Closes the overflow file and frees it
+ *
+ * @param overflow Pointer to the overflow file (may be NULL)
+ */
+void slotted_overflow_free(overflow_file_t* overflow);
+
+#endif /* SLOTTED_H */
@@ -15,6 +15,12 @@
 #  define ON_MAC 1
 #endif
 
+// Memory backing buffer pool frames (see ssdio_alloc_frames)
+#define SSDIO_FRAMES_HEAP 0     // aligned_alloc, 4 KB pages
+#define SSDIO_FRAMES_HUGETLB 1  // Explicit 2 MB pages (MAP_HUGETLB) from the pool reserved in vm.nr_hugepages
+#define SSDIO_FRAMES_THP 2      // 2 MB aligned anonymous mapping with transparent huge pages requested
+#define SSDIO_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 /**
  * @brief Opens a file for SSD-DBMS
  *
@@ -60,6 +66,28 @@ bool ssdio_read_page(int fd, uint64_t page_id, page_t* page);
  */
 bool ssdio_write_page(int fd, uint64_t page_id, const page_t* page);
 
+/**
+ * @brief Reads a page of a table file, page p is stored at PAGE_SIZE + (p - 1) * page_size
+ *
+ * @param fd File descriptor of the table file
+ * @param page_id ID of the page to read (1 or more, page 0 is the catalog)
+ * @param page_size Size of the table's pages
+ * @param page Pointer to store the read page, page_size bytes
+ * @return true on success, false on failure
+ */
+bool ssdio_read_table_page(int fd, uint64_t page_id, uint32_t page_size, page_t* page);
+
+/**
+ * @brief Writes a page of a table file, see ssdio_read_table_page
+ *
+ * @param fd File descriptor of the table file
+ * @param page_id ID of the page to write (1 or more)
+ * @param page_size Size of the table's pages
+ * @param page Pointer to the page to write, page_size bytes
+ * @return true on success, false on failure
+ */
+bool ssdio_write_table_page(int fd, uint64_t page_id, uint32_t page_size, const page_t* page);
+
 /**
  * @brief Reads the system catalog from SSD-DBMS
  *
@@ -86,4 +114,67 @@ bool ssdio_write_catalog(int fd, const system_catalog_t* catalog);
  */
 off_t ssdio_get_file_size(int fd);
 
+/**
+ * @brief Truncates (or extends) a file to the given size
+ *
+ * @param fd File descriptor
+ * @param size New size of the file in bytes
+ * @return true on success, false on failure
+ */
+bool ssdio_truncate(int fd, off_t size);
+
+/**
+ * @brief Deallocates a byte range of a file without changing its size (Linux only)
+ *
+ * The range reads back as zeros afterwards.
+ *
+ * @param fd File descriptor
+ * @param offset Start of the range in bytes
+ * @param length Length of the range in bytes
+ * @return true on success, false if the platform or file system does not support it
+ */
+bool ssdio_punch_hole(int fd, off_t offset, off_t length);
+
+/**
+ * @brief Maps a file read-only into memory and asks for it to be read in (MADV_WILLNEED)
+ *
+ * The mapping is shared, it sees later writes to the file through other descriptors.
+ *
+ * @param fd File descriptor
+ * @param size Bytes to map from the start of the file
+ * @return Start of the mapping, or NULL on failure
+ */
+const char* ssdio_map(int fd, size_t size);
+
+/**
+ * @brief Unmaps a file mapped with ssdio_map
+ *
+ * @param mapping Start of the mapping (may be NULL)
+ * @param size Size given to ssdio_map
+ */
+void ssdio_unmap(const char* mapping, size_t size);
+
+/**
+ * @brief Allocates zeroed, PAGE_SIZE aligned memory for buffer pool frames
+ *
+ * With use_huge_pages and at least SSDIO_HUGE_PAGE_SIZE bytes, explicit huge pages (MAP_HUGETLB) are tried
+ * first, then an anonymous mapping aligned to SSDIO_HUGE_PAGE_SIZE with madvise(MADV_HUGEPAGE), so random frame
+ * accesses need one TLB entry per 2 MB instead of per 4 KB. Falls back to aligned_alloc.
+ *
+ * @param size Bytes to allocate, a multiple of PAGE_SIZE
+ * @param use_huge_pages When false, always use aligned_alloc
+ * @param backing Set to the SSDIO_FRAMES_* backing that was used
+ * @return Start of the frames, or NULL on failure
+ */
+char* ssdio_alloc_frames(size_t size, bool use_huge_pages, uint8_t* backing);
+
+/**
+ * @brief Frees frames allocated with ssdio_alloc_frames
+ *
+ * @param frames Start of the frames (may be NULL)
+ * @param size Size given to ssdio_alloc_frames
+ * @param backing Backing set by ssdio_alloc_frames
+ */
+void ssdio_free_frames(char* frames, size_t size, uint8_t backing);
+
 #endif /* SSDIO_H */
@@ -0,0 +1,151 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "dbms.h"
+#include "query.h"
+
+// On-disk format: <table file>.sts, written by stats_analyze
+// Page 0 holds stats_file_meta_t followed by one stats_column_t per attribute, continued on the
+// next pages when the attributes do not fit in one.
+#define STATS_FILE_EXTENSION ".sts"
+#define STATS_FILE_MAGIC "SSDSTS01"
+#define STATS_SAMPLE_PAGES 300      // Table pages read by an analyze, every page of smaller tables
+#define STATS_HISTOGRAM_BUCKETS 32  // Equi-depth buckets per attribute
+#define STATS_HLL_BITS 12           // log2 of the HyperLogLog registers (about 1.6% standard error)
+
+// Cost model, in units of one sequential page read
+#define STATS_SEQ_PAGE_COST 1.0
+#define STATS_RANDOM_PAGE_COST 1.5  // SSD random reads cost little more than sequential ones
+#define STATS_CPU_TUPLE_COST 0.01
+
+// Keys are btree_normalize_key encodings, so INT, FLOAT and BOOL are exact and STRING is an 8 byte prefix
+typedef struct {
+  uint8_t attribute_type;
+  uint8_t bucket_count;    // Histogram buckets, 0 if no live tuple was sampled
+  uint8_t reserved[6];
+  double distinct_count;   // HyperLogLog estimate of the sample, scaled to the table
+  uint64_t min_key;
+  uint64_t max_key;
+  uint64_t bounds[STATS_HISTOGRAM_BUCKETS + 1];  // Bucket i holds the values from bounds[i] to bounds[i + 1]
+} stats_column_t;
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint8_t column_count;
+  uint8_t reserved;
+  uint16_t tuple_size;
+  uint64_t page_count;     // Table pages when analyzed
+  uint64_t pages_sampled;
+  double row_count;        // Live tuples when analyzed
+  double null_fraction;    // Null (free) tuple slots among the sampled slots, attributes themselves are never NULL
+} stats_file_meta_t;
+
+struct table_stats {
+  stats_file_meta_t meta;
+  stats_column_t* columns;  // One per attribute
+};
+
+/**
+ * @brief Loads the statistics of a table written by its last analyze
+ *
+ * @param session The active session
+ * @return Pointer to the statistics, or NULL if the table was never analyzed (or the file does not match it)
+ */
+table_stats_t* stats_open(const dbms_session_t* session);
+
+/**
+ * @brief Samples the table pages and replaces the session's statistics and their file
+ * Row count, null fraction, min/max, an equi-depth histogram and a HyperLogLog distinct count are
+ * kept per attribute. Pages are picked uniformly and read in file order. The row count, and the
+ * min/max of INT and FLOAT attributes, come from the zone map when there is one.
+ *
+ * @param session The active session
+ * @param sample_pages Pages to read (every page if the table has no more, 0 for STATS_SAMPLE_PAGES)
+ * @return true on success, false on failure (the previous statistics are kept)
+ */
+bool stats_analyze(dbms_session_t* session, uint64_t sample_pages);
+
+/**
+ * @brief Frees the statistics
+ *
+ * @param stats Pointer to the statistics (may be NULL)
+ */
+void stats_free(table_stats_t* stats);
+
+/**
+ * @brief Estimates the live tuples of the table, scaling the analyzed row count to the current page count
+ *
+ * @param session The active session
+ * @return The estimate (page_count times tuples per page if the table was never analyzed)
+ */
+double stats_row_count(const dbms_session_t* session);
+
+/**
+ * @brief Estimates the fraction of tuples satisfying the propositions on one attribute
+ * Ranges are read off the histogram, an equality is the share of the histogram a frequent value
+ * fills, otherwise 1 / distinct count (at most one bucket), and 0 outside min/max.
+ *
+ * @param session The active session (must have statistics)
+ * @param criteria The selection criteria
+ * @param attribute_index The attribute whose propositions are combined
+ * @return Selectivity between 0 and 1 (1 without statistics or propositions on the attribute)
+ */
+double stats_attribute_selectivity(const dbms_session_t* session, const selection_criteria_t* criteria,
+                                   uint8_t attribute_index);
+
+/**
+ * @brief Estimates the fraction of tuples satisfying every proposition, taking attributes as independent
+ *
+ * @param session The active session
+ * @param criteria The selection criteria
+ * @return Selectivity between 0 and 1 (1 without statistics)
+ */
+double stats_selectivity(const dbms_session_t* session, const selection_criteria_t* criteria);
+
+/**
+ * @brief Cost of reading every table page in order
+ *
+ * @param session The active session
+ * @return Estimated cost
+ */
+double stats_seq_scan_cost(const dbms_session_t* session);
+
+/**
+ * @brief Cost of fetching the matches of an index lookup, page by page
+ * The pages touched by the matches are estimated with Cardenas' formula, each is read at random
+ * and decoded whole.
+ *
+ * @param session The active session
+ * @param selectivity Fraction of the tuples the index returns
+ * @param probe_pages Index pages read to find the matches
+ * @return Estimated cost
+ */
+double stats_index_scan_cost(const dbms_session_t* session, double selectivity, double probe_pages);
+
+/**
+ * @brief Decides between an index lookup and a sequential scan
+ *
+ * @param session The active session
+ * @param selectivity Fraction of the tuples the index returns
+ * @param probe_pages Index pages read to find the matches
+ * @return true if the index is cheaper, always true when the table was never analyzed
+ */
+bool stats_prefer_index_scan(const dbms_session_t* session, double selectivity, double probe_pages);
+
+/**
+ * @brief Cost of a nested loop join that rescans the inner table per outer tuple
+ * For an equi-join whose inner attribute has a Bloom filter, only the outer tuples with a value
+ * the inner table holds (by the ratio of distinct counts) scan the inner table.
+ *
+ * @param outer Session of the outer table
+ * @param inner Session of the inner table
+ * @param outer_attribute Join attribute of the outer table (-1 for a cross product)
+ * @param inner_attribute Join attribute of the inner table (-1 for a cross product)
+ * @param is_inner_filtered True if the inner attribute has a Bloom filter
+ * @return Estimated cost
+ */
+double stats_nested_loop_cost(const dbms_session_t* outer, const dbms_session_t* inner, int outer_attribute,
+                              int inner_attribute, bool is_inner_filtered);
+
+#endif /* STATS_H */
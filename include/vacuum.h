@@ -0,0 +1,47 @@
+#ifndef VACUUM_H
+#define VACUUM_H
+
+#include "dbms.h"
+
+// A vacuum empties the tail pages of a table by moving their tuples into the free slots of earlier
+// pages, then truncates the table after its last page with live tuples. It runs in bounded steps so
+// it can be interleaved with other commands.
+#define VACUUM_STEP_BUDGET 64  // Tuples moved plus pages emptied per step
+
+struct vacuum {
+  bool punch_holes;         // Deallocate the free extents of a compressed table as well
+  bool is_done;
+  uint64_t target_page_id;  // Every page before it was found full, moved tuples go to it or later
+  uint32_t start_page_count;
+  uint64_t tuples_moved;
+  uint64_t pages_freed;
+};
+
+/**
+ * @brief Starts a vacuum of a table
+ *
+ * @param session The session of the table
+ * @param punch_holes Also punch the free extents out of the file of a compressed table
+ * @return Pointer to the vacuum, or NULL on failure
+ */
+vacuum_t* vacuum_start(dbms_session_t* session, bool punch_holes);
+
+/**
+ * @brief Runs one step of a vacuum, moving at most budget tuples out of the tail pages
+ * The table is truncated at the end of every step that emptied pages.
+ *
+ * @param session The session of the table
+ * @param vacuum Pointer to the vacuum
+ * @param budget Tuples moved plus pages emptied before the step returns
+ * @return true if work remains, false once the vacuum is done (or failed)
+ */
+bool vacuum_step(dbms_session_t* session, vacuum_t* vacuum, size_t budget);
+
+/**
+ * @brief Frees a vacuum
+ *
+ * @param vacuum Pointer to the vacuum (may be NULL)
+ */
+void vacuum_free(vacuum_t* vacuum);
+
+#endif /* VACUUM_H */
@@ -0,0 +1,117 @@
+#ifndef ZONE_MAP_H
+#define ZONE_MAP_H
+
+#include "dbms.h"
+#include "query.h"
+
+// On-disk format: <table file>.zmp
+// Page 0 holds zone_map_file_meta_t, the following pages hold one entry per table page:
+// its live tuple count, then the min and max of every INT and FLOAT attribute.
+#define ZONE_MAP_FILE_EXTENSION ".zmp"
+#define ZONE_MAP_FILE_MAGIC "SSDZMP01"
+
+// INT and FLOAT values are both exact as doubles
+typedef struct {
+  double min;
+  double max;
+} zone_range_t;
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint8_t column_count;
+  uint8_t is_clean;  // 0 from the first change after a sync until the next sync, the file is rebuilt if so
+  uint16_t tuple_size;
+  uint64_t page_count;  // Table pages covered by the file
+} zone_map_file_meta_t;
+
+struct zone_map {
+  int fd;
+  char* filename;
+  uint8_t attribute_count;
+  int16_t* attribute_columns;  // Column of each attribute, -1 if it is not tracked
+  uint8_t column_count;
+  uint8_t* column_attributes;  // Attribute index of each column
+  uint8_t* column_types;
+  off_t* column_offsets;       // Byte offset of each column's slot 0 value within the page data
+  size_t* column_strides;      // Bytes between the values of consecutive slots
+  uint16_t tuple_size;
+  uint64_t tuples_per_page;
+
+  uint64_t page_count;         // Table pages covered, page_id 1 is entry 0
+  uint64_t capacity;
+  uint32_t* tuple_counts;      // Live tuples per page
+  zone_range_t* ranges;        // column_count ranges per page, empty (min > max) without live tuples
+
+  size_t entry_size;           // Bytes per page entry in the file
+  size_t file_page_entries;    // Entries per file page
+  bool* dirty_pages;           // Per file page, written back by zone_map_sync
+  bool is_clean;               // The file matches the table as of the last sync
+  uint64_t pages_skipped;      // Table pages skipped by scans since the session was opened
+};
+
+/**
+ * @brief Opens the zone map of a table, building it from the table pages when the file is
+ * missing or was not synced after the last change
+ *
+ * @param session The active session
+ * @return Pointer to the zone map, or NULL if the table has no INT or FLOAT attribute (or on failure)
+ */
+zone_map_t* zone_map_open(dbms_session_t* session);
+
+/**
+ * @brief Writes the changed entries to the zone map file and marks it clean
+ * Must only be called once the table pages are on disk, see dbms_flush_buffer_pool.
+ *
+ * @param zone_map Pointer to the zone map
+ * @return true on success (or if nothing changed), false on failure
+ */
+bool zone_map_sync(zone_map_t* zone_map);
+
+/**
+ * @brief Closes the zone map file and frees the zone map
+ * Unsynced changes are dropped, the file is rebuilt when the table is opened again.
+ *
+ * @param zone_map Pointer to the zone map
+ */
+void zone_map_free(zone_map_t* zone_map);
+
+/**
+ * @brief Widens the ranges of a tuple's page to its values
+ *
+ * @param zone_map Pointer to the zone map (may be NULL)
+ * @param tuple The inserted tuple
+ */
+void zone_map_insert_tuple(zone_map_t* zone_map, const tuple_t* tuple);
+
+/**
+ * @brief Removes a tuple from the ranges of its page
+ * A range is recomputed from the page's other tuples when the tuple held its min or max.
+ *
+ * @param zone_map Pointer to the zone map (may be NULL)
+ * @param buffer_page The decoded buffer page holding the tuple
+ * @param tuple The tuple being deleted or updated, still live
+ */
+void zone_map_delete_tuple(zone_map_t* zone_map, const buffer_page_t* buffer_page, const tuple_t* tuple);
+
+/**
+ * @brief Checks whether no tuple of a page can satisfy every proposition
+ * Pages without live tuples are always skipped. Skipped pages are counted in pages_skipped.
+ *
+ * @param zone_map Pointer to the zone map (may be NULL, nothing is skipped then)
+ * @param page_id The table page
+ * @param criteria The conjunctive selection criteria (may be NULL)
+ * @return true if the page does not need to be read
+ */
+bool zone_map_can_skip_page(zone_map_t* zone_map, uint64_t page_id, const selection_criteria_t* criteria);
+
+/**
+ * @brief Drops the entries of the table pages past page_count and shrinks the zone map file to match
+ *
+ * @param zone_map Pointer to the zone map (may be NULL)
+ * @param page_count The new number of table pages
+ * @return true on success, false on failure
+ */
+bool zone_map_truncate(zone_map_t* zone_map, uint64_t page_count);
+
+#endif /* ZONE_MAP_H */
@@ -14,6 +14,12 @@ uint64_t load_u64(const void* p) {
   return v;
 }
 
+uint16_t load_u16(const void* p) {
+  uint16_t v;
+  memcpy(&v, p, sizeof v);
+  return v;
+}
+
 uint8_t load_u8(const void* p) {
   uint8_t v;
   memcpy(&v, p, sizeof v);
@@ -40,6 +46,10 @@ void store_u64(void* p, uint64_t v) {
   memcpy(p, &v, sizeof v);
 }
 
+void store_u16(void* p, uint16_t v) {
+  memcpy(p, &v, sizeof v);
+}
+
 void store_u8(void* p, uint8_t v) {
   memcpy(p, &v, sizeof v);
 }
@@ -0,0 +1,141 @@
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN_UP(n) (((n) + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+static arena_chunk_t* arena_new_chunk(size_t size) {
+  arena_chunk_t* chunk = malloc(sizeof(arena_chunk_t) + size);
+  if (chunk == NULL) {
+    fprintf(stderr, "Memory allocation failed for arena chunk of %zu bytes\n", size);
+    return NULL;
+  }
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+  return chunk;
+}
+
+arena_t* arena_create(size_t chunk_size) {
+  if (chunk_size == 0) {
+    chunk_size = ARENA_DEFAULT_CHUNK_SIZE;
+  }
+  chunk_size = ARENA_ALIGN_UP(chunk_size);
+
+  arena_t* arena = malloc(sizeof(arena_t));
+  if (arena == NULL) {
+    fprintf(stderr, "Memory allocation failed for arena\n");
+    return NULL;
+  }
+
+  arena->head = arena_new_chunk(chunk_size);
+  if (arena->head == NULL) {
+    free(arena);
+    return NULL;
+  }
+  arena->initial_chunk_size = chunk_size;
+  arena->chunk_size = chunk_size;
+  arena->bytes_allocated = 0;
+  return arena;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+  if (arena == NULL) {
+    return NULL;
+  }
+  if (size == 0) {
+    size = 1;
+  }
+  if (size > SIZE_MAX - ARENA_ALIGNMENT) {
+    fprintf(stderr, "Arena allocation of %zu bytes is too large\n", size);
+    return NULL;
+  }
+  size = ARENA_ALIGN_UP(size);
+
+  arena_chunk_t* chunk = arena->head;
+  if (chunk == NULL || chunk->size - chunk->used < size) {
+    // Grow geometrically so a long query needs O(log n) chunks, oversized requests get their own chunk
+    if (arena->chunk_size < ARENA_MAX_CHUNK_SIZE) {
+      arena->chunk_size *= 2;
+    }
+    size_t new_size = size > arena->chunk_size ? size : arena->chunk_size;
+    chunk = arena_new_chunk(new_size);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->next = arena->head;
+    arena->head = chunk;
+  }
+
+  void* ptr = chunk->data + chunk->used;
+  chunk->used += size;
+  arena->bytes_allocated += size;
+  return ptr;
+}
+
+void* arena_calloc(arena_t* arena, size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    fprintf(stderr, "Arena allocation of %zu items of %zu bytes overflows\n", count, size);
+    return NULL;
+  }
+  void* ptr = arena_alloc(arena, count * size);
+  if (ptr != NULL) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+char* arena_strdup(arena_t* arena, const char* str) {
+  if (str == NULL) {
+    return NULL;
+  }
+  return arena_strndup(arena, str, strlen(str));
+}
+
+char* arena_strndup(arena_t* arena, const char* str, size_t n) {
+  if (str == NULL) {
+    return NULL;
+  }
+  size_t length = strnlen(str, n);
+  char* copy = arena_alloc(arena, length + 1);
+  if (copy == NULL) {
+    return NULL;
+  }
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+void arena_reset(arena_t* arena) {
+  if (arena == NULL || arena->head == NULL) {
+    return;
+  }
+
+  // The first chunk is the oldest one, at the tail of the list
+  arena_chunk_t* chunk = arena->head;
+  while (chunk->next != NULL) {
+    arena_chunk_t* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  chunk->used = 0;
+  arena->head = chunk;
+  arena->chunk_size = arena->initial_chunk_size;
+  arena->bytes_allocated = 0;
+}
+
+void arena_free(arena_t* arena) {
+  if (arena == NULL) {
+    return;
+  }
+  arena_chunk_t* chunk = arena->head;
+  while (chunk != NULL) {
+    arena_chunk_t* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
@@ -0,0 +1,96 @@
+#include "bloom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOOM_BIT_INDEX_BITS 9  // log2 of the bits in a block
+#define BLOOM_BIT_INDEX_MASK ((1u << BLOOM_BIT_INDEX_BITS) - 1)
+
+_Static_assert(sizeof(bloom_block_t) == BLOOM_CACHE_LINE_SIZE, "Bloom block must be one cache line");
+_Static_assert(BLOOM_HASH_COUNT * BLOOM_BIT_INDEX_BITS <= 64, "Bit indexes must fit in one hash");
+
+static uint64_t mix(uint64_t key, uint64_t seed);
+static void block_mask(uint64_t hash, uint64_t* mask);
+
+bloom_filter_t* bloom_create(uint64_t capacity) {
+  bloom_filter_t* filter = calloc(1, sizeof(bloom_filter_t));
+  if (!filter) {
+    fprintf(stderr, "Memory allocation failed for Bloom filter\n");
+    return NULL;
+  }
+
+  uint64_t bits = (capacity ? capacity : 1) * BLOOM_BITS_PER_KEY;
+  uint64_t block_count = 1;
+  while (block_count * BLOOM_CACHE_LINE_SIZE * 8 < bits) {
+    block_count <<= 1;
+  }
+
+  filter->blocks = aligned_alloc(BLOOM_CACHE_LINE_SIZE, block_count * sizeof(bloom_block_t));
+  if (!filter->blocks) {
+    fprintf(stderr, "Memory allocation failed for Bloom filter blocks\n");
+    free(filter);
+    return NULL;
+  }
+  memset(filter->blocks, 0, block_count * sizeof(bloom_block_t));
+  filter->block_mask = block_count - 1;
+  filter->capacity = block_count * BLOOM_CACHE_LINE_SIZE * 8 / BLOOM_BITS_PER_KEY;
+  return filter;
+}
+
+void bloom_free(bloom_filter_t* filter) {
+  if (!filter) {
+    return;
+  }
+  free(filter->blocks);
+  free(filter);
+}
+
+void bloom_add(bloom_filter_t* filter, uint64_t key) {
+  if (!filter) {
+    return;
+  }
+
+  uint64_t mask[BLOOM_BLOCK_WORDS];
+  block_mask(mix(key, 0x9e3779b97f4a7c15ULL), mask);
+  bloom_block_t* block = &filter->blocks[mix(key, 0) & filter->block_mask];
+  for (size_t i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+    block->words[i] |= mask[i];
+  }
+}
+
+bool bloom_may_contain(const bloom_filter_t* filter, uint64_t key) {
+  if (!filter) {
+    return true;
+  }
+
+  uint64_t mask[BLOOM_BLOCK_WORDS];
+  block_mask(mix(key, 0x9e3779b97f4a7c15ULL), mask);
+  const bloom_block_t* block = &filter->blocks[mix(key, 0) & filter->block_mask];
+  // Branch-free over the whole line, the compiler vectorizes it
+  uint64_t missing = 0;
+  for (size_t i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+    missing |= mask[i] & ~block->words[i];
+  }
+  return missing == 0;
+}
+
+// Murmur3 finalizer, the seed gives the block and the bit positions independent hashes
+static uint64_t mix(uint64_t key, uint64_t seed) {
+  key ^= seed;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+// Bits of a key within its block, taken 9 bits at a time from the hash
+static void block_mask(uint64_t hash, uint64_t* mask) {
+  memset(mask, 0, BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+  for (int i = 0; i < BLOOM_HASH_COUNT; i++) {
+    uint32_t bit = (uint32_t)(hash >> (i * BLOOM_BIT_INDEX_BITS)) & BLOOM_BIT_INDEX_MASK;
+    mask[bit >> 6] |= 1ULL << (bit & 63);
+  }
+}
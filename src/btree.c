@@ -0,0 +1,692 @@
+#include "btree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssdio.h"
+
+#define BTREE_VERSION 1
+#define BTREE_META_PAGE_ID 0
+#define BTREE_INITIAL_RESULT_CAPACITY 64
+
+_Static_assert(sizeof(btree_node_t) <= sizeof(page_t), "B+tree node must fit in a page");
+_Static_assert(sizeof(btree_meta_t) <= sizeof(page_t), "B+tree meta must fit in a page");
+
+static char* build_filename(const dbms_session_t* session, uint8_t attribute_index);
+static btree_t* allocate_tree(const dbms_session_t* session, uint8_t attribute_index);
+static void free_tree(btree_t* tree);
+static int compare_entries(const btree_entry_t* a, const btree_entry_t* b);
+static int compare_entries_qsort(const void* a, const void* b);
+static size_t leaf_lower_bound(const btree_node_t* node, const btree_entry_t* entry);
+static size_t branch_upper_bound(const btree_node_t* node, const btree_entry_t* entry);
+static uint64_t branch_child(const btree_node_t* node, size_t position);
+static buffer_page_t* pin_node(dbms_session_t* session, btree_t* tree, uint64_t page_id, bool is_new);
+static uint64_t find_leaf(dbms_session_t* session, btree_t* tree, const btree_entry_t* entry, uint64_t* path);
+static bool insert_into_parent(dbms_session_t* session, btree_t* tree, uint64_t* path, uint32_t depth,
+                               btree_entry_t separator, uint64_t right_page);
+static bool bulk_load(dbms_session_t* session, btree_t* tree, const btree_entry_t* entries, size_t entry_count);
+
+uint64_t btree_normalize_key(const attribute_value_t* value) {
+  if (!value) {
+    return 0;
+  }
+
+  switch (value->type) {
+    case ATTRIBUTE_TYPE_INT:
+      // Flipping the sign bit orders negative numbers before positive ones
+      return (uint64_t)((uint32_t)value->int_value ^ 0x80000000u);
+    case ATTRIBUTE_TYPE_FLOAT: {
+      float f = value->float_value == 0.0f ? 0.0f : value->float_value;  // -0.0 == 0.0
+      uint32_t bits = 0;
+      memcpy(&bits, &f, sizeof(bits));
+      // Negative floats order in reverse of their bits, positive ones after all negatives
+      return (uint64_t)((bits & 0x80000000u) ? ~bits : (bits | 0x80000000u));
+    }
+    case ATTRIBUTE_TYPE_BOOL:
+      return value->bool_value ? 1 : 0;
+    case ATTRIBUTE_TYPE_STRING: {
+      // Big-endian prefix, shorter strings sort first because of the zero padding
+      uint64_t key = 0;
+      const char* str = value->string_value ? value->string_value : "";
+      for (size_t i = 0; i < sizeof(key); i++) {
+        key <<= 8;
+        if (*str) {
+          key |= (uint8_t)*str++;
+        }
+      }
+      return key;
+    }
+    default:
+      return 0;
+  }
+}
+
+btree_t* btree_create(dbms_session_t* session, uint8_t attribute_index) {
+  if (!session || attribute_index >= dbms_catalog_num_used(session->catalog)) {
+    return NULL;
+  }
+
+  // Drop the open index first so none of its pages linger in the buffer pool
+  if (session->btrees && session->btrees[attribute_index]) {
+    btree_close(session, session->btrees[attribute_index]);
+    session->btrees[attribute_index] = NULL;
+  }
+
+  btree_t* tree = allocate_tree(session, attribute_index);
+  if (!tree) {
+    return NULL;
+  }
+
+  tree->fd = ssdio_open(tree->filename, true);
+  if (tree->fd < 0) {
+    fprintf(stderr, "Failed to create index file: %s\n", tree->filename);
+    free_tree(tree);
+    return NULL;
+  }
+
+  // Collect every live tuple's entry
+  size_t entry_count = 0;
+  size_t entry_capacity = BTREE_INITIAL_RESULT_CAPACITY;
+  btree_entry_t* entries = malloc(entry_capacity * sizeof(btree_entry_t));
+  if (!entries) {
+    fprintf(stderr, "Memory allocation failed for index entries\n");
+    btree_close(session, tree);
+    return NULL;
+  }
+
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
+    for (uint64_t slot_id = 0; slot_id < tuples_per_page; slot_id++) {
+      tuple_t* tuple = dbms_get_tuple(session, (tuple_id_t){page_id, slot_id});
+      if (!tuple || tuple->is_null) {
+        continue;
+      }
+
+      if (entry_count == entry_capacity) {
+        entry_capacity *= 2;
+        btree_entry_t* grown = realloc(entries, entry_capacity * sizeof(btree_entry_t));
+        if (!grown) {
+          fprintf(stderr, "Memory allocation failed for index entries\n");
+          free(entries);
+          btree_close(session, tree);
+          return NULL;
+        }
+        entries = grown;
+      }
+      entries[entry_count++] =
+          (btree_entry_t){btree_normalize_key(&tuple->attributes[attribute_index]), page_id, slot_id};
+    }
+  }
+
+  qsort(entries, entry_count, sizeof(btree_entry_t), compare_entries_qsort);
+  bool loaded = bulk_load(session, tree, entries, entry_count);
+  free(entries);
+
+  if (!loaded || !btree_sync(session, tree)) {
+    fprintf(stderr, "Failed to build index file: %s\n", tree->filename);
+    btree_close(session, tree);
+    return NULL;
+  }
+  return tree;
+}
+
+btree_t* btree_open(dbms_session_t* session, uint8_t attribute_index) {
+  if (!session || attribute_index >= dbms_catalog_num_used(session->catalog)) {
+    return NULL;
+  }
+
+  btree_t* tree = allocate_tree(session, attribute_index);
+  if (!tree) {
+    return NULL;
+  }
+
+  // A missing file just means the attribute has no index
+  tree->fd = ssdio_open(tree->filename, false);
+  if (tree->fd < 0) {
+    free_tree(tree);
+    return NULL;
+  }
+
+  buffer_page_t* meta_page = pin_node(session, tree, BTREE_META_PAGE_ID, false);
+  if (!meta_page) {
+    ssdio_close(tree->fd);
+    free_tree(tree);
+    return NULL;
+  }
+
+  btree_meta_t meta;
+  memcpy(&meta, meta_page->page, sizeof(meta));
+  dbms_unpin_page(session, meta_page);
+
+  catalog_record_t* record = dbms_get_catalog_record(session->catalog, attribute_index);
+  if (memcmp(meta.magic, BTREE_MAGIC, sizeof(meta.magic)) != 0 || meta.version != BTREE_VERSION ||
+      meta.attribute_index != attribute_index || !record || meta.attribute_type != record->attribute_type) {
+    fprintf(stderr, "Ignoring invalid index file: %s\n", tree->filename);
+    dbms_flush_file_pages(session, tree->file_id);
+    ssdio_close(tree->fd);
+    free_tree(tree);
+    return NULL;
+  }
+
+  tree->root_page = meta.root_page;
+  tree->page_count = meta.page_count;
+  tree->entry_count = meta.entry_count;
+  tree->height = meta.height;
+  tree->meta_dirty = false;
+  return tree;
+}
+
+bool btree_sync(dbms_session_t* session, btree_t* tree) {
+  if (!session || !tree) {
+    return false;
+  }
+  if (!tree->meta_dirty) {
+    return true;
+  }
+
+  buffer_page_t* meta_page = pin_node(session, tree, BTREE_META_PAGE_ID, false);
+  if (!meta_page) {
+    return false;
+  }
+
+  btree_meta_t meta = {0};
+  memcpy(meta.magic, BTREE_MAGIC, sizeof(meta.magic));
+  meta.version = BTREE_VERSION;
+  meta.attribute_index = tree->attribute_index;
+  meta.attribute_type = tree->attribute_type;
+  meta.root_page = tree->root_page;
+  meta.page_count = tree->page_count;
+  meta.entry_count = tree->entry_count;
+  meta.height = tree->height;
+  memcpy(meta_page->page, &meta, sizeof(meta));
+
+  meta_page->is_dirty = true;
+  dbms_unpin_page(session, meta_page);
+  tree->meta_dirty = false;
+  return true;
+}
+
+void btree_close(dbms_session_t* session, btree_t* tree) {
+  if (!tree) {
+    return;
+  }
+
+  if (session && tree->fd >= 0) {
+    btree_sync(session, tree);
+    dbms_flush_file_pages(session, tree->file_id);
+    ssdio_flush(tree->fd);
+  }
+  if (tree->fd >= 0) {
+    ssdio_close(tree->fd);
+  }
+  free_tree(tree);
+}
+
+bool btree_insert(dbms_session_t* session, btree_t* tree, const attribute_value_t* value, tuple_id_t tuple_id) {
+  if (!session || !tree || !value) {
+    return false;
+  }
+
+  btree_entry_t entry = {btree_normalize_key(value), tuple_id.page_id, tuple_id.slot_id};
+  uint64_t path[BTREE_MAX_HEIGHT];
+  uint64_t leaf_id = find_leaf(session, tree, &entry, path);
+  if (leaf_id == 0) {
+    return false;
+  }
+
+  buffer_page_t* leaf_page = pin_node(session, tree, leaf_id, false);
+  if (!leaf_page) {
+    return false;
+  }
+  btree_node_t* leaf = (btree_node_t*)leaf_page->page;
+  size_t position = leaf_lower_bound(leaf, &entry);
+
+  tree->entry_count++;
+  tree->meta_dirty = true;
+  leaf_page->is_dirty = true;
+
+  if (leaf->header.count < BTREE_LEAF_CAPACITY) {
+    memmove(&leaf->entries[position + 1], &leaf->entries[position],
+            (leaf->header.count - position) * sizeof(btree_entry_t));
+    leaf->entries[position] = entry;
+    leaf->header.count++;
+    dbms_unpin_page(session, leaf_page);
+    return true;
+  }
+
+  // Leaf is full: split it in half, the right half goes to a new page
+  btree_entry_t merged[BTREE_LEAF_CAPACITY + 1];
+  memcpy(merged, leaf->entries, position * sizeof(btree_entry_t));
+  merged[position] = entry;
+  memcpy(&merged[position + 1], &leaf->entries[position], (leaf->header.count - position) * sizeof(btree_entry_t));
+
+  uint64_t right_id = tree->page_count++;
+  buffer_page_t* right_page = pin_node(session, tree, right_id, true);
+  if (!right_page) {
+    tree->page_count--;
+    tree->entry_count--;
+    dbms_unpin_page(session, leaf_page);
+    return false;
+  }
+  btree_node_t* right = (btree_node_t*)right_page->page;
+
+  size_t total = BTREE_LEAF_CAPACITY + 1;
+  size_t left_count = total / 2;
+  memcpy(leaf->entries, merged, left_count * sizeof(btree_entry_t));
+  leaf->header.count = (uint32_t)left_count;
+  right->header.is_leaf = 1;
+  right->header.count = (uint32_t)(total - left_count);
+  memcpy(right->entries, &merged[left_count], right->header.count * sizeof(btree_entry_t));
+  right->header.next_leaf = leaf->header.next_leaf;
+  leaf->header.next_leaf = right_id;
+
+  btree_entry_t separator = right->entries[0];
+  dbms_unpin_page(session, right_page);
+  dbms_unpin_page(session, leaf_page);
+
+  return insert_into_parent(session, tree, path, tree->height - 1, separator, right_id);
+}
+
+bool btree_delete(dbms_session_t* session, btree_t* tree, const attribute_value_t* value, tuple_id_t tuple_id) {
+  if (!session || !tree || !value) {
+    return false;
+  }
+
+  btree_entry_t entry = {btree_normalize_key(value), tuple_id.page_id, tuple_id.slot_id};
+  uint64_t leaf_id = find_leaf(session, tree, &entry, NULL);
+  if (leaf_id == 0) {
+    return false;
+  }
+
+  buffer_page_t* leaf_page = pin_node(session, tree, leaf_id, false);
+  if (!leaf_page) {
+    return false;
+  }
+  btree_node_t* leaf = (btree_node_t*)leaf_page->page;
+  size_t position = leaf_lower_bound(leaf, &entry);
+
+  bool found = position < leaf->header.count && compare_entries(&leaf->entries[position], &entry) == 0;
+  if (found) {
+    // Underfull leaves are left as they are, separators above stay valid bounds
+    memmove(&leaf->entries[position], &leaf->entries[position + 1],
+            (leaf->header.count - position - 1) * sizeof(btree_entry_t));
+    leaf->header.count--;
+    leaf_page->is_dirty = true;
+    tree->entry_count--;
+    tree->meta_dirty = true;
+  }
+
+  dbms_unpin_page(session, leaf_page);
+  return found;
+}
+
+void btree_insert_tuple(dbms_session_t* session, const tuple_t* tuple) {
+  if (!session || !session->btrees || !tuple) {
+    return;
+  }
+
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    if (session->btrees[i] && !btree_insert(session, session->btrees[i], &tuple->attributes[i], tuple->id)) {
+      fprintf(stderr, "Failed to add tuple %llu:%llu to index %s\n", (unsigned long long)tuple->id.page_id,
+              (unsigned long long)tuple->id.slot_id, session->btrees[i]->filename);
+    }
+  }
+}
+
+void btree_delete_tuple(dbms_session_t* session, const tuple_t* tuple) {
+  if (!session || !session->btrees || !tuple) {
+    return;
+  }
+
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    if (session->btrees[i]) {
+      btree_delete(session, session->btrees[i], &tuple->attributes[i], tuple->id);
+    }
+  }
+}
+
+tuple_id_t* btree_range(dbms_session_t* session, btree_t* tree, uint64_t low_key, uint64_t high_key,
+                        size_t* out_count) {
+  if (out_count) {
+    *out_count = 0;
+  }
+  if (!session || !tree || !out_count || low_key > high_key) {
+    return NULL;
+  }
+
+  btree_entry_t low = {low_key, 0, 0};
+  uint64_t leaf_id = find_leaf(session, tree, &low, NULL);
+  if (leaf_id == 0) {
+    return NULL;
+  }
+
+  size_t count = 0;
+  size_t capacity = 0;
+  tuple_id_t* results = NULL;
+  bool first_leaf = true;
+
+  // Walk the leaf chain from the first candidate until a key passes the upper bound
+  while (leaf_id != 0) {
+    buffer_page_t* leaf_page = pin_node(session, tree, leaf_id, false);
+    if (!leaf_page) {
+      break;
+    }
+    btree_node_t* leaf = (btree_node_t*)leaf_page->page;
+
+    size_t position = first_leaf ? leaf_lower_bound(leaf, &low) : 0;
+    first_leaf = false;
+    bool done = false;
+    for (; position < leaf->header.count; position++) {
+      const btree_entry_t* entry = &leaf->entries[position];
+      if (entry->key > high_key) {
+        done = true;
+        break;
+      }
+
+      if (count == capacity) {
+        size_t new_capacity = capacity ? capacity * 2 : BTREE_INITIAL_RESULT_CAPACITY;
+        tuple_id_t* grown = realloc(results, new_capacity * sizeof(tuple_id_t));
+        if (!grown) {
+          fprintf(stderr, "Memory allocation failed for index range results\n");
+          dbms_unpin_page(session, leaf_page);
+          free(results);
+          return NULL;
+        }
+        results = grown;
+        capacity = new_capacity;
+      }
+      results[count++] = (tuple_id_t){entry->page_id, entry->slot_id};
+    }
+
+    leaf_id = done ? 0 : leaf->header.next_leaf;
+    dbms_unpin_page(session, leaf_page);
+  }
+
+  if (count == 0) {
+    free(results);
+    return NULL;
+  }
+  *out_count = count;
+  return results;
+}
+
+static char* build_filename(const dbms_session_t* session, uint8_t attribute_index) {
+  catalog_record_t* record = dbms_get_catalog_record(session->catalog, attribute_index);
+  if (!record) {
+    return NULL;
+  }
+  return dbms_get_index_filename(session->filename, record->attribute_name, BTREE_FILE_EXTENSION);
+}
+
+static btree_t* allocate_tree(const dbms_session_t* session, uint8_t attribute_index) {
+  btree_t* tree = calloc(1, sizeof(btree_t));
+  if (!tree) {
+    fprintf(stderr, "Memory allocation failed for B+tree index\n");
+    return NULL;
+  }
+
+  tree->filename = build_filename(session, attribute_index);
+  if (!tree->filename) {
+    free(tree);
+    return NULL;
+  }
+
+  tree->fd = -1;
+  tree->file_id = (uint16_t)(DBMS_TABLE_FILE_ID + 1 + attribute_index);
+  tree->attribute_index = attribute_index;
+  tree->attribute_type = dbms_get_catalog_record(session->catalog, attribute_index)->attribute_type;
+  return tree;
+}
+
+static void free_tree(btree_t* tree) {
+  free(tree->filename);
+  free(tree);
+}
+
+static int compare_entries(const btree_entry_t* a, const btree_entry_t* b) {
+  if (a->key != b->key) {
+    return a->key < b->key ? -1 : 1;
+  }
+  if (a->page_id != b->page_id) {
+    return a->page_id < b->page_id ? -1 : 1;
+  }
+  if (a->slot_id != b->slot_id) {
+    return a->slot_id < b->slot_id ? -1 : 1;
+  }
+  return 0;
+}
+
+static int compare_entries_qsort(const void* a, const void* b) {
+  return compare_entries((const btree_entry_t*)a, (const btree_entry_t*)b);
+}
+
+// First position in a leaf whose entry is >= entry
+static size_t leaf_lower_bound(const btree_node_t* node, const btree_entry_t* entry) {
+  size_t low = 0;
+  size_t high = node->header.count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (compare_entries(&node->entries[mid], entry) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// Number of separators in an internal node that are <= entry
+static size_t branch_upper_bound(const btree_node_t* node, const btree_entry_t* entry) {
+  size_t low = 0;
+  size_t high = node->header.count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (compare_entries(&node->branches[mid].separator, entry) <= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static uint64_t branch_child(const btree_node_t* node, size_t position) {
+  return position == 0 ? node->header.first_child : node->branches[position - 1].child;
+}
+
+static buffer_page_t* pin_node(dbms_session_t* session, btree_t* tree, uint64_t page_id, bool is_new) {
+  buffer_page_t* buffer_page = dbms_pin_file_page(session, tree->fd, tree->file_id, page_id, is_new);
+  if (!buffer_page) {
+    fprintf(stderr, "Failed to pin page %llu of index file %s\n", (unsigned long long)page_id, tree->filename);
+  }
+  return buffer_page;
+}
+
+// Descends to the leaf that holds (or would hold) entry, only one node is pinned at a time.
+// path[d] receives the internal node visited at depth d when path is not NULL.
+static uint64_t find_leaf(dbms_session_t* session, btree_t* tree, const btree_entry_t* entry, uint64_t* path) {
+  if (tree->height == 0 || tree->height > BTREE_MAX_HEIGHT) {
+    fprintf(stderr, "Index file %s has an invalid height\n", tree->filename);
+    return 0;
+  }
+
+  uint64_t page_id = tree->root_page;
+  for (uint32_t depth = 0; depth + 1 < tree->height; depth++) {
+    buffer_page_t* buffer_page = pin_node(session, tree, page_id, false);
+    if (!buffer_page) {
+      return 0;
+    }
+    const btree_node_t* node = (const btree_node_t*)buffer_page->page;
+    if (path) {
+      path[depth] = page_id;
+    }
+    page_id = branch_child(node, branch_upper_bound(node, entry));
+    dbms_unpin_page(session, buffer_page);
+  }
+  return page_id;
+}
+
+// Adds (separator, right_page) to the internal node at path[depth - 1], splitting upwards as needed
+static bool insert_into_parent(dbms_session_t* session, btree_t* tree, uint64_t* path, uint32_t depth,
+                               btree_entry_t separator, uint64_t right_page) {
+  while (depth > 0) {
+    uint64_t node_id = path[depth - 1];
+    buffer_page_t* node_page = pin_node(session, tree, node_id, false);
+    if (!node_page) {
+      return false;
+    }
+    btree_node_t* node = (btree_node_t*)node_page->page;
+    size_t position = branch_upper_bound(node, &separator);
+    btree_branch_t branch = {separator, right_page};
+    node_page->is_dirty = true;
+
+    if (node->header.count < BTREE_BRANCH_CAPACITY) {
+      memmove(&node->branches[position + 1], &node->branches[position],
+              (node->header.count - position) * sizeof(btree_branch_t));
+      node->branches[position] = branch;
+      node->header.count++;
+      dbms_unpin_page(session, node_page);
+      return true;
+    }
+
+    // Internal split: the middle separator moves up, its child becomes the right node's first child
+    btree_branch_t merged[BTREE_BRANCH_CAPACITY + 1];
+    memcpy(merged, node->branches, position * sizeof(btree_branch_t));
+    merged[position] = branch;
+    memcpy(&merged[position + 1], &node->branches[position], (node->header.count - position) * sizeof(btree_branch_t));
+
+    uint64_t new_id = tree->page_count++;
+    buffer_page_t* new_page = pin_node(session, tree, new_id, true);
+    if (!new_page) {
+      tree->page_count--;
+      dbms_unpin_page(session, node_page);
+      return false;
+    }
+    btree_node_t* new_node = (btree_node_t*)new_page->page;
+
+    size_t total = BTREE_BRANCH_CAPACITY + 1;
+    size_t middle = total / 2;
+    memcpy(node->branches, merged, middle * sizeof(btree_branch_t));
+    node->header.count = (uint32_t)middle;
+    new_node->header.is_leaf = 0;
+    new_node->header.first_child = merged[middle].child;
+    new_node->header.count = (uint32_t)(total - middle - 1);
+    memcpy(new_node->branches, &merged[middle + 1], new_node->header.count * sizeof(btree_branch_t));
+
+    separator = merged[middle].separator;
+    right_page = new_id;
+    dbms_unpin_page(session, new_page);
+    dbms_unpin_page(session, node_page);
+    depth--;
+  }
+
+  // The root split, grow the tree by one level
+  if (tree->height >= BTREE_MAX_HEIGHT) {
+    fprintf(stderr, "Index file %s reached the maximum height\n", tree->filename);
+    return false;
+  }
+
+  uint64_t root_id = tree->page_count++;
+  buffer_page_t* root_page = pin_node(session, tree, root_id, true);
+  if (!root_page) {
+    tree->page_count--;
+    return false;
+  }
+  btree_node_t* root = (btree_node_t*)root_page->page;
+  root->header.is_leaf = 0;
+  root->header.first_child = tree->root_page;
+  root->header.count = 1;
+  root->branches[0] = (btree_branch_t){separator, right_page};
+  dbms_unpin_page(session, root_page);
+
+  tree->root_page = root_id;
+  tree->height++;
+  tree->meta_dirty = true;
+  return true;
+}
+
+// Writes sorted entries into consecutive leaves, then builds each internal level from the one below
+static bool bulk_load(dbms_session_t* session, btree_t* tree, const btree_entry_t* entries, size_t entry_count) {
+  // Page 0 is reserved for the meta page
+  buffer_page_t* meta_page = pin_node(session, tree, BTREE_META_PAGE_ID, true);
+  if (!meta_page) {
+    return false;
+  }
+  dbms_unpin_page(session, meta_page);
+  tree->page_count = 1;
+  tree->meta_dirty = true;
+
+  size_t per_leaf = BTREE_LEAF_CAPACITY * BTREE_BULK_FILL_PERCENT / 100;
+  size_t leaf_count = entry_count == 0 ? 1 : (entry_count + per_leaf - 1) / per_leaf;
+
+  // (first entry, page) of every node on the level being built
+  btree_branch_t* level = malloc(leaf_count * sizeof(btree_branch_t));
+  if (!level) {
+    fprintf(stderr, "Memory allocation failed for index bulk load\n");
+    return false;
+  }
+
+  for (size_t i = 0; i < leaf_count; i++) {
+    uint64_t page_id = tree->page_count++;
+    buffer_page_t* buffer_page = pin_node(session, tree, page_id, true);
+    if (!buffer_page) {
+      free(level);
+      return false;
+    }
+    btree_node_t* leaf = (btree_node_t*)buffer_page->page;
+
+    size_t start = i * per_leaf;
+    size_t count = entry_count - start < per_leaf ? entry_count - start : per_leaf;
+    if (entry_count == 0) {
+      count = 0;
+    }
+    leaf->header.is_leaf = 1;
+    leaf->header.count = (uint32_t)count;
+    leaf->header.next_leaf = i + 1 < leaf_count ? page_id + 1 : 0;  // Leaves are allocated back to back
+    memcpy(leaf->entries, &entries[start], count * sizeof(btree_entry_t));
+    dbms_unpin_page(session, buffer_page);
+
+    level[i].separator = count > 0 ? entries[start] : (btree_entry_t){0, 0, 0};
+    level[i].child = page_id;
+  }
+
+  size_t level_count = leaf_count;
+  uint32_t height = 1;
+  size_t per_node = BTREE_BRANCH_CAPACITY * BTREE_BULK_FILL_PERCENT / 100 + 1;  // Children per internal node
+
+  while (level_count > 1) {
+    size_t node_count = (level_count + per_node - 1) / per_node;
+    for (size_t i = 0; i < node_count; i++) {
+      uint64_t page_id = tree->page_count++;
+      buffer_page_t* buffer_page = pin_node(session, tree, page_id, true);
+      if (!buffer_page) {
+        free(level);
+        return false;
+      }
+      btree_node_t* node = (btree_node_t*)buffer_page->page;
+
+      size_t start = i * per_node;
+      size_t children = level_count - start < per_node ? level_count - start : per_node;
+      node->header.is_leaf = 0;
+      node->header.first_child = level[start].child;
+      node->header.count = (uint32_t)(children - 1);
+      memcpy(node->branches, &level[start + 1], (children - 1) * sizeof(btree_branch_t));
+      dbms_unpin_page(session, buffer_page);
+
+      // Parents are built in place, level[i] is no longer needed once node i is written
+      level[i].separator = level[start].separator;
+      level[i].child = page_id;
+    }
+    level_count = node_count;
+    height++;
+  }
+
+  tree->root_page = level[0].child;
+  tree->height = height;
+  tree->entry_count = entry_count;
+  free(level);
+  return true;
+}
@@ -1,5 +1,6 @@
 #include "cli_commands.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,19 +9,33 @@
 #include "pretty.h"
 #include "query.h"
 #include "index.h"
+#include "btree.h"
+#include "stats.h"
+#include "vacuum.h"
+#include "zone_map.h"
 
 #include "executor/executor.h"
 #include "executor/filter.h"
+#include "executor/hash_aggregate.h"
+#include "executor/index_scan.h"
 #include "executor/nested_loop_join.h"
 #include "executor/project.h"
+#include "executor/scan_aggregate.h"
 #include "executor/seq_scan.h"
 
 static bool populate_attribute_values_from_tokens(system_catalog_t* catalog, char** tokens, uint8_t num_attributes, attribute_value_t* attributes);
 
 static void print_tuple_info(tuple_t* tuple, uint8_t num_attributes, system_catalog_t* catalog);
 
-static bool generate_proposition(char* proposition_str, proposition_t* proposition, const system_catalog_t* catalog);
-static int parse_selection_criteria(dbms_manager_t* manager, char* input_line, selection_criteria_t* criteria, dbms_session_t** out_session);
+static void print_attribute_values(const attribute_value_t* attributes, uint8_t num_attributes);
+
+static bool parse_aggregate_list(char* aggregate_str, const system_catalog_t* catalog, aggregate_t* aggregates,
+                                 uint8_t* aggregate_count, uint8_t* group_indices, uint8_t* group_count);
+
+static bool generate_proposition(char* proposition_str, proposition_t* proposition, const system_catalog_t* catalog,
+                                 arena_t* arena);
+static int parse_selection_criteria(dbms_manager_t* manager, char* input_line, selection_criteria_t* criteria,
+                                    dbms_session_t** out_session, arena_t* arena);
 
 static int cli_table_exec(dbms_session_t* session, char* input_line) {
   char* save_ptr = NULL;
@@ -43,6 +58,8 @@ static int cli_table_exec(dbms_session_t* session, char* input_line) {
     return cli_fill_command(session, input_line);
   } else if (strcmp(command, CLI_INDEX_COMMAND) == 0) {
       return cli_index_command(session, input_line);
+  } else if (strcmp(command, CLI_BTREE_COMMAND) == 0) {
+    return cli_btree_command(session, input_line);
   } else {
     fprintf(stderr, "Unknown command: %s\n", command);
     return CLI_FAILURE_RETURN_CODE;
@@ -109,6 +126,10 @@ int cli_exec(dbms_manager_t* manager, char* input) {
     return cli_time_command(manager, input_line);
   } else if (strcmp(command, CLI_QUERY_COMMAND) == 0) {
     return cli_query_command(manager, input_line);
+  } else if (strcmp(command, CLI_VACUUM_COMMAND) == 0) {
+    return cli_vacuum_command(manager, input_line);
+  } else if (strcmp(command, CLI_ANALYZE_COMMAND) == 0) {
+    return cli_analyze_command(manager, input_line);
   }
 
   // For other commands, the first token is the table name
@@ -128,33 +149,95 @@ int cli_exec(dbms_manager_t* manager, char* input) {
 
 int cli_index_command(dbms_session_t* session, char* input_line) {
     if (!session || !input_line) return CLI_FAILURE_RETURN_CODE;
+    if (session->is_readonly) {
+        fprintf(stderr, "Table '%s' is open read-only\n", session->table_name);
+        return CLI_FAILURE_RETURN_CODE;
+    }
     
-    // input_line should be the attribute name
-    char* attribute_name = input_line;
-    // Trim
-    while (*attribute_name == ' ' || *attribute_name == '\t') attribute_name++;
-    char* end = attribute_name + strlen(attribute_name) - 1;
-    while (end > attribute_name && (*end == ' ' || *end == '\t' || *end == '\n')) *end-- = '\0';
-    
-    catalog_record_t* record = dbms_get_catalog_record_by_name(session->catalog, attribute_name);
-    if (!record) {
-        fprintf(stderr, "Attribute '%s' not found.\n", attribute_name);
+    // input_line is one attribute name, or a comma separated list for a composite index
+    uint8_t attribute_indexes[INDEX_MAX_ATTRIBUTES];
+    uint8_t attribute_count = 0;
+    char* save_ptr = NULL;
+    for (char* attribute_name = strtok_r(input_line, ",", &save_ptr); attribute_name;
+         attribute_name = strtok_r(NULL, ",", &save_ptr)) {
+        // Trim
+        while (*attribute_name == ' ' || *attribute_name == '\t') attribute_name++;
+        char* end = attribute_name + strlen(attribute_name) - 1;
+        while (end > attribute_name && (*end == ' ' || *end == '\t' || *end == '\n')) *end-- = '\0';
+
+        catalog_record_t* record = dbms_get_catalog_record_by_name(session->catalog, attribute_name);
+        if (!record) {
+            fprintf(stderr, "Attribute '%s' not found.\n", attribute_name);
+            return CLI_FAILURE_RETURN_CODE;
+        }
+        if (attribute_count == INDEX_MAX_ATTRIBUTES) {
+            fprintf(stderr, "An index covers at most %d attributes\n", INDEX_MAX_ATTRIBUTES);
+            return CLI_FAILURE_RETURN_CODE;
+        }
+        attribute_indexes[attribute_count++] = record->attribute_order;
+    }
+    if (attribute_count == 0) {
+        fprintf(stderr, "No attribute name provided for index\n");
         return CLI_FAILURE_RETURN_CODE;
     }
 
-    if (session->indexes[record->attribute_order]) {
-        printf("Index already exists for %s\n", attribute_name);
+    index_t* existing = attribute_count == 1 ? session->indexes[attribute_indexes[0]]
+                                             : dbms_find_composite_index(session, attribute_indexes, attribute_count);
+    if (existing) {
+        printf("Index already exists in %s\n", existing->filename);
         return CLI_SUCCESS_RETURN_CODE;
     }
 
-    session->indexes[record->attribute_order] = index_create(session, record->attribute_order);
-    if (session->indexes[record->attribute_order]) {
-        printf("Index created for %s\n", attribute_name);
-        return CLI_SUCCESS_RETURN_CODE;
-    } else {
+    index_t* index = attribute_count == 1 ? index_create(session, attribute_indexes[0])
+                                          : index_create_composite(session, attribute_indexes, attribute_count);
+    if (index && attribute_count == 1) {
+        session->indexes[attribute_indexes[0]] = index;
+    } else if (index && !dbms_add_composite_index(session, index)) {
+        index_free(index);
+        index = NULL;
+    }
+    if (!index) {
         fprintf(stderr, "Failed to create index\n");
         return CLI_FAILURE_RETURN_CODE;
     }
+    printf("Index created in %s\n", index->filename);
+    return CLI_SUCCESS_RETURN_CODE;
+}
+
+int cli_btree_command(dbms_session_t* session, char* input_line) {
+  if (!session || !input_line) {
+    fprintf(stderr, "Invalid session or input line\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (session->is_readonly) {
+    fprintf(stderr, "Table '%s' is open read-only\n", session->table_name);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  char* save_ptr = NULL;
+  char* attribute_name = strtok_r(input_line, " \t\n", &save_ptr);
+  if (!attribute_name) {
+    fprintf(stderr, "No attribute name provided for B+tree index\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  catalog_record_t* record = dbms_get_catalog_record_by_name(session->catalog, attribute_name);
+  if (!record || record->attribute_type == ATTRIBUTE_TYPE_UNUSED) {
+    fprintf(stderr, "Attribute '%s' not found.\n", attribute_name);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  // Rebuilds the index file if one already exists
+  session->btrees[record->attribute_order] = btree_create(session, record->attribute_order);
+  btree_t* tree = session->btrees[record->attribute_order];
+  if (!tree) {
+    fprintf(stderr, "Failed to create B+tree index\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  printf("B+tree index created for %s (%llu entries, height %u) in %s\n", attribute_name,
+         (unsigned long long)tree->entry_count, tree->height, tree->filename);
+  return CLI_SUCCESS_RETURN_CODE;
 }
 
 int cli_insert_command(dbms_session_t* session, char* input_line) {
@@ -214,13 +297,16 @@ int cli_print_command(dbms_session_t* session, char* input_line) {
     token = strtok_r(NULL, " \t\n", &save_ptr);
   }
   if (token_count < 1) {
-    fprintf(stderr, "Usage: print <catalog|page|tuple>\n");
+    fprintf(stderr, "Usage: print <catalog|stats|page|tuple>\n");
     return CLI_FAILURE_RETURN_CODE;
   }
 
   if (strcmp(tokens[0], "catalog") == 0) {
     print_catalog(session->catalog);
     return CLI_SUCCESS_RETURN_CODE;
+  } else if (strcmp(tokens[0], "stats") == 0) {
+    print_stats(session);
+    return CLI_SUCCESS_RETURN_CODE;
   } else if (strcmp(tokens[0], "page") == 0) {
     if (token_count < 2) {
       fprintf(stderr, "Usage: print page <page_number> [print_nulls]\n");
@@ -317,21 +403,19 @@ int cli_delete_command(dbms_session_t* session, char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
   selection_criteria_t criteria = {0};
 
-  if (parse_selection_criteria(NULL, input_line, &criteria, &session) != CLI_SUCCESS_RETURN_CODE) {
+  if (parse_selection_criteria(NULL, input_line, &criteria, &session, arena) != CLI_SUCCESS_RETURN_CODE) {
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
   int num_deletions = query_delete(session, &criteria);
-
-  for (int i = 0; i < criteria.proposition_count; i++) {
-    if (criteria.propositions[i].value.type == ATTRIBUTE_TYPE_STRING && criteria.propositions[i].value.string_value) {
-      // Append row to result
-      free(criteria.propositions[i].value.string_value);
-    }
-  }
-  free(criteria.propositions);
+  arena_free(arena);
 
   if (num_deletions == -1) {
     fprintf(stderr, "Failed to delete tuples\n");
@@ -394,17 +478,14 @@ int cli_update_command(dbms_session_t* session, char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
   selection_criteria_t criteria = {0};
-  parse_selection_criteria(NULL, tokens[0], &criteria, &session);
+  parse_selection_criteria(NULL, tokens[0], &criteria, &session, arena);
   int num_updates = query_update(session, &criteria, attributes);
-
-  for (int i = 0; i < criteria.proposition_count; i++) {
-    if (criteria.propositions[i].value.type == ATTRIBUTE_TYPE_STRING && criteria.propositions[i].value.string_value) {
-      // Append row to result
-      free(criteria.propositions[i].value.string_value);
-    }
-  }
-  free(criteria.propositions);
+  arena_free(arena);
 
   if (num_updates == -1) {
     fprintf(stderr, "Failed to update tuples\n");
@@ -502,13 +583,74 @@ int cli_create_table_command(dbms_manager_t* manager, const char* input_line) {
     fprintf(stderr, "No input line provided for create command\n");
     return CLI_FAILURE_RETURN_CODE;
   }
-  // Assume input_line is the filename
-  const char* filename = input_line;
+  // <table_path> [--layout nsm|pax|slotted|bitmap] [--dictionary <attribute>[,<attribute>...]] [--compression none|lz4]
+  //   [--page-size <bytes>]
+  char filename[PATH_MAX];
+  size_t filename_length = strcspn(input_line, " \t\n");
+  if (filename_length >= sizeof(filename)) {
+    fprintf(stderr, "Database filename is too long\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  memcpy(filename, input_line, filename_length);
+  filename[filename_length] = '\0';
   if (strlen(filename) == 0) {
     fprintf(stderr, "Database filename cannot be empty\n");
     return CLI_FAILURE_RETURN_CODE;
   }
 
+  uint8_t layout = CATALOG_LAYOUT_NSM;
+  uint8_t compression = CATALOG_COMPRESSION_NONE;
+  uint32_t page_size = PAGE_SIZE;
+  const char* dictionary_names = NULL;
+  size_t dictionary_names_length = 0;
+  const char* options = input_line + filename_length;
+  while (*(options += strspn(options, " \t\n")) != '\0') {
+    size_t option_length = strcspn(options, " \t\n");
+    const char* argument = options + option_length;
+    argument += strspn(argument, " \t\n");
+    size_t argument_length = strcspn(argument, " \t\n");
+    if (option_length == strlen(CLI_LAYOUT_OPTION) && strncmp(options, CLI_LAYOUT_OPTION, option_length) == 0 &&
+        argument_length > 0) {
+      if (argument_length == 3 && strncmp(argument, "pax", 3) == 0) {
+        layout = CATALOG_LAYOUT_PAX;
+      } else if (argument_length == 7 && strncmp(argument, "slotted", 7) == 0) {
+        layout = CATALOG_LAYOUT_SLOTTED;
+      } else if (argument_length == 6 && strncmp(argument, "bitmap", 6) == 0) {
+        layout = CATALOG_LAYOUT_BITMAP;
+      } else if (argument_length != 3 || strncmp(argument, "nsm", 3) != 0) {
+        fprintf(stderr, "Unknown page layout '%.*s', expected nsm, pax, slotted or bitmap\n", (int)argument_length,
+                argument);
+        return CLI_FAILURE_RETURN_CODE;
+      }
+    } else if (option_length == strlen(CLI_DICTIONARY_OPTION) &&
+               strncmp(options, CLI_DICTIONARY_OPTION, option_length) == 0 && argument_length > 0) {
+      dictionary_names = argument;
+      dictionary_names_length = argument_length;
+    } else if (option_length == strlen(CLI_COMPRESSION_OPTION) &&
+               strncmp(options, CLI_COMPRESSION_OPTION, option_length) == 0 && argument_length > 0) {
+      if (argument_length == 3 && strncmp(argument, "lz4", 3) == 0) {
+        compression = CATALOG_COMPRESSION_LZ4;
+      } else if (argument_length != 4 || strncmp(argument, "none", 4) != 0) {
+        fprintf(stderr, "Unknown page compression '%.*s', expected none or lz4\n", (int)argument_length, argument);
+        return CLI_FAILURE_RETURN_CODE;
+      }
+    } else if (option_length == strlen(CLI_PAGE_SIZE_OPTION) &&
+               strncmp(options, CLI_PAGE_SIZE_OPTION, option_length) == 0 && argument_length > 0) {
+      char* end = NULL;
+      unsigned long value = strtoul(argument, &end, 10);
+      if (end != argument + argument_length || value > UINT32_MAX || !dbms_is_valid_page_size((uint32_t)value)) {
+        fprintf(stderr, "Invalid page size '%.*s', expected a power of two from %u to %u\n", (int)argument_length,
+                argument, MIN_PAGE_SIZE, MAX_PAGE_SIZE);
+        return CLI_FAILURE_RETURN_CODE;
+      }
+      page_size = (uint32_t)value;
+    } else {
+      fprintf(stderr, "Unknown create option: %s\n", options);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+    options = argument + argument_length;
+  }
+
   // Check if filename exists in manager
   for (size_t i = 0; i < manager->session_count; i++) {
     if (strcmp(manager->sessions[i]->filename, filename) == 0) {
@@ -527,6 +669,9 @@ int cli_create_table_command(dbms_manager_t* manager, const char* input_line) {
   // First byte determines if a record is null
   catalog.tuple_size = NULL_BYTE_SIZE;
   catalog.record_count = 0;
+  catalog.layout = layout;
+  catalog.compression = compression;
+  catalog.page_size = page_size;
 
   // Let user define schema
   while (true) {
@@ -617,8 +762,30 @@ int cli_create_table_command(dbms_manager_t* manager, const char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  // Fit records to 8-byte alignment, minimum 16 bytes
-  if (catalog.tuple_size % 8 != 0 || catalog.tuple_size < 16) {
+  // Encoded attributes store a code in the tuple instead of the string
+  while (dictionary_names_length > 0) {
+    size_t name_length = strcspn(dictionary_names, ",");
+    if (name_length > dictionary_names_length) {
+      name_length = dictionary_names_length;
+    }
+    char attribute_name[CATALOG_ATTRIBUTE_NAME_SIZE] = {0};
+    snprintf(attribute_name, sizeof(attribute_name), "%.*s", (int)name_length, dictionary_names);
+    catalog_record_t* record = dbms_get_catalog_record_by_name(&catalog, attribute_name);
+    uint8_t position = record ? (uint8_t)(record - catalog.records) : 0;
+    if (!record || !dbms_set_dictionary_encoded(&catalog, position)) {
+      fprintf(stderr, "Cannot dictionary encode '%s', expected a STRING attribute listed once\n", attribute_name);
+      dbms_free_catalog_records(catalog);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+    catalog.tuple_size = catalog.tuple_size - record->attribute_size + CATALOG_DICTIONARY_CODE_SIZE;
+
+    size_t consumed = name_length < dictionary_names_length ? name_length + 1 : name_length;
+    dictionary_names += consumed;
+    dictionary_names_length -= consumed;
+  }
+
+  // Fit records to 8-byte alignment, minimum 16 bytes, bitmap pages pack tuples without a free list pointer
+  if (layout != CATALOG_LAYOUT_BITMAP && (catalog.tuple_size % 8 != 0 || catalog.tuple_size < 16)) {
     uint16_t remaining = 8 - (catalog.tuple_size % 8);
     if (catalog.tuple_size < 16) {
       remaining = 16 - catalog.tuple_size;
@@ -640,7 +807,11 @@ int cli_create_table_command(dbms_manager_t* manager, const char* input_line) {
     padding_record->attribute_order = catalog.record_count - 1;
   }
 
-  dbms_create_table(filename, &catalog);
+  if (!dbms_create_table(filename, &catalog)) {
+    fprintf(stderr, "Failed to create table: %s\n", filename);
+    dbms_free_catalog_records(catalog);
+    return CLI_FAILURE_RETURN_CODE;
+  }
 
   printf("Table created successfully: %s\n", filename);
   printf("Use '%s %s' to open the table.\n", CLI_OPEN_TABLE_COMMAND, filename);
@@ -658,13 +829,40 @@ int cli_open_command(dbms_manager_t* manager, const char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  const char* filename = input_line;
+  // <table_path> [--readonly] [--mmap]
+  char filename[PATH_MAX];
+  size_t filename_length = strcspn(input_line, " \t\n");
+  if (filename_length >= sizeof(filename)) {
+    fprintf(stderr, "Table filename is too long\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  memcpy(filename, input_line, filename_length);
+  filename[filename_length] = '\0';
   if (strlen(filename) == 0) {
     fprintf(stderr, "Table filename cannot be empty\n");
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  dbms_session_t* session = dbms_init_dbms_session(filename);
+  uint8_t flags = 0;
+  const char* options = input_line + filename_length;
+  while (*(options += strspn(options, " \t\n")) != '\0') {
+    size_t option_length = strcspn(options, " \t\n");
+    if (option_length == strlen(CLI_READONLY_OPTION) && strncmp(options, CLI_READONLY_OPTION, option_length) == 0) {
+      flags |= DBMS_OPEN_READONLY;
+    } else if (option_length == strlen(CLI_MMAP_OPTION) && strncmp(options, CLI_MMAP_OPTION, option_length) == 0) {
+      flags |= DBMS_OPEN_MMAP;
+    } else {
+      fprintf(stderr, "Unknown open option: %.*s\n", (int)option_length, options);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+    options += option_length;
+  }
+  if ((flags & DBMS_OPEN_MMAP) && !(flags & DBMS_OPEN_READONLY)) {
+    fprintf(stderr, "%s requires %s\n", CLI_MMAP_OPTION, CLI_READONLY_OPTION);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  dbms_session_t* session = dbms_open_dbms_session(filename, flags);
   if (!session) {
     fprintf(stderr, "Failed to open table: %s\n", filename);
     return CLI_FAILURE_RETURN_CODE;
@@ -685,7 +883,8 @@ int cli_open_command(dbms_manager_t* manager, const char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  printf("Table '%s' opened successfully.\n", session->table_name);
+  printf("Table '%s' opened successfully%s.\n", session->table_name,
+         session->mapping ? " (read-only, mapped)" : session->is_readonly ? " (read-only)" : "");
   return CLI_SUCCESS_RETURN_CODE;
 }
 
@@ -740,13 +939,15 @@ int cli_split_command(dbms_manager_t* manager, char* input_line) {
       end--;
     }
 
-    // Split command cannot be another split, create, open, time, or query command
+    // Split command cannot be another split, create, open, time, query, vacuum or analyze command
     if (strncmp(command_line, CLI_SPLIT_COMMAND, strlen(CLI_SPLIT_COMMAND)) == 0 ||
         strncmp(command_line, CLI_CREATE_TABLE_COMMAND, strlen(CLI_CREATE_TABLE_COMMAND)) == 0 ||
         strncmp(command_line, CLI_OPEN_TABLE_COMMAND, strlen(CLI_OPEN_TABLE_COMMAND)) == 0 ||
         strncmp(command_line, CLI_TIME_COMMAND, strlen(CLI_TIME_COMMAND)) == 0 ||
-        strncmp(command_line, CLI_QUERY_COMMAND, strlen(CLI_QUERY_COMMAND)) == 0) {
-      fprintf(stderr, "Nested split, create, open, time, and query commands are not allowed\n");
+        strncmp(command_line, CLI_QUERY_COMMAND, strlen(CLI_QUERY_COMMAND)) == 0 ||
+        strncmp(command_line, CLI_VACUUM_COMMAND, strlen(CLI_VACUUM_COMMAND)) == 0 ||
+        strncmp(command_line, CLI_ANALYZE_COMMAND, strlen(CLI_ANALYZE_COMMAND)) == 0) {
+      fprintf(stderr, "Nested split, create, open, time, query, vacuum and analyze commands are not allowed\n");
       return CLI_FAILURE_RETURN_CODE;
     }
 
@@ -863,6 +1064,120 @@ int cli_time_command(dbms_manager_t* manager, char* input_line) {
   return CLI_SUCCESS_RETURN_CODE;
 }
 
+int cli_vacuum_command(dbms_manager_t* manager, char* input_line) {
+  if (!manager) {
+    fprintf(stderr, "Invalid manager\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (!input_line) {
+    fprintf(stderr, "No input line provided for vacuum command\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  char* save_ptr = NULL;
+  char* table_name = strtok_r(input_line, " \t\n", &save_ptr);
+  char* option = strtok_r(NULL, " \t\n", &save_ptr);
+  bool punch_holes = false;
+  if (option && strcmp(option, CLI_PUNCH_HOLE_OPTION) == 0) {
+    punch_holes = true;
+  } else if (option) {
+    fprintf(stderr, "Unknown vacuum option: %s\n", option);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  dbms_session_t* session = table_name ? get_session_by_name(manager, table_name) : NULL;
+  if (!session) {
+    fprintf(stderr, "Table '%s' not found in DBMS manager\n", table_name ? table_name : "");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (session->vacuum) {
+    fprintf(stderr, "Table '%s' is already being vacuumed\n", table_name);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (session->is_readonly) {
+    fprintf(stderr, "Table '%s' is open read-only\n", table_name);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  session->vacuum = vacuum_start(session, punch_holes);
+  if (!session->vacuum) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  printf("Vacuum of '%s' started on %u pages.\n", session->table_name, session->page_count);
+  return CLI_SUCCESS_RETURN_CODE;
+}
+
+int cli_analyze_command(dbms_manager_t* manager, char* input_line) {
+  if (!manager) {
+    fprintf(stderr, "Invalid manager\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (!input_line) {
+    fprintf(stderr, "No input line provided for analyze command\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  char* save_ptr = NULL;
+  char* table_name = strtok_r(input_line, " \t\n", &save_ptr);
+  char* sample_str = strtok_r(NULL, " \t\n", &save_ptr);
+  uint64_t sample_pages = 0;
+  if (sample_str) {
+    char* end = NULL;
+    sample_pages = strtoull(sample_str, &end, 10);
+    if (*end != '\0' || sample_pages == 0) {
+      fprintf(stderr, "Invalid number of pages to sample: %s\n", sample_str);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+  }
+
+  dbms_session_t* session = table_name ? get_session_by_name(manager, table_name) : NULL;
+  if (!session) {
+    fprintf(stderr, "Table '%s' not found in DBMS manager\n", table_name ? table_name : "");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  if (!stats_analyze(session, sample_pages)) {
+    fprintf(stderr, "Failed to analyze table '%s'\n", table_name);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  print_stats(session);
+  return CLI_SUCCESS_RETURN_CODE;
+}
+
+bool cli_has_background_work(const dbms_manager_t* manager) {
+  for (size_t i = 0; manager && i < manager->session_count; i++) {
+    if (manager->sessions[i]->vacuum) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cli_background_step(dbms_manager_t* manager) {
+  bool is_finished = false;
+  for (size_t i = 0; manager && i < manager->session_count; i++) {
+    dbms_session_t* session = manager->sessions[i];
+    if (session->vacuum && !vacuum_step(session, session->vacuum, VACUUM_STEP_BUDGET)) {
+      is_finished = true;
+    }
+  }
+  return is_finished;
+}
+
+void cli_background_finish(dbms_manager_t* manager) {
+  for (size_t i = 0; manager && i < manager->session_count; i++) {
+    dbms_session_t* session = manager->sessions[i];
+    if (!session->vacuum || !session->vacuum->is_done) {
+      continue;
+    }
+    printf("Vacuum of '%s' done: moved %llu tuples, freed %llu of %u pages.\n", session->table_name,
+           (unsigned long long)session->vacuum->tuples_moved, (unsigned long long)session->vacuum->pages_freed,
+           session->vacuum->start_page_count);
+    vacuum_free(session->vacuum);
+    session->vacuum = NULL;
+  }
+}
+
 int cli_query_command(dbms_manager_t* manager, char* input_line) {
   if (!manager) {
     fprintf(stderr, "Invalid manager\n");
@@ -887,6 +1202,8 @@ int cli_query_command(dbms_manager_t* manager, char* input_line) {
     return cli_query_pipeline(manager, save_ptr);
   } else if (strcmp(command, CLI_QUERY_JOIN_COMMAND) == 0) {
     return cli_query_join(manager, save_ptr);
+  } else if (strcmp(command, CLI_QUERY_AGGREGATE_COMMAND) == 0) {
+    return cli_query_aggregate(manager, save_ptr);
   } else {
     fprintf(stderr, "Unknown query command: %s\n", command);
     return CLI_FAILURE_RETURN_CODE;
@@ -903,28 +1220,33 @@ int cli_query_select(dbms_manager_t* manager, char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
+  // Propositions and the materialized result share one region for the whole query
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
   selection_criteria_t criteria = {0};
   dbms_session_t* session = NULL;
 
-  if (parse_selection_criteria(manager, input_line, &criteria, &session) != CLI_SUCCESS_RETURN_CODE) {
+  if (parse_selection_criteria(manager, input_line, &criteria, &session, arena) != CLI_SUCCESS_RETURN_CODE) {
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  query_result_t* result = query_select(session, &criteria);
-
-  for (int i = 0; i < criteria.proposition_count; i++) {
-    if (criteria.propositions[i].value.type == ATTRIBUTE_TYPE_STRING && criteria.propositions[i].value.string_value) {
-      free(criteria.propositions[i].value.string_value);
-    }
-  }
-  free(criteria.propositions);
-
+  uint64_t pages_skipped = session->zone_map ? session->zone_map->pages_skipped : 0;
+  query_result_t* result = query_select_arena(session, &criteria, arena);
   if (!result) {
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
   print_query_result(result);
-  query_free_query_result(result);
+  if (session->zone_map) {
+    printf("%llu of %u pages skipped by the zone map\n",
+           (unsigned long long)(session->zone_map->pages_skipped - pages_skipped),
+           session->page_count);
+  }
+  arena_free(arena);
   return CLI_SUCCESS_RETURN_CODE;
 }
 
@@ -938,11 +1260,18 @@ int cli_query_pipeline(dbms_manager_t* manager, char* input_line) {
     return CLI_FAILURE_RETURN_CODE;
   }
 
+  // One region for the whole query: propositions, operators and their state
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
   // Parse selection criteria (reuses existing parsing logic)
   selection_criteria_t criteria = {0};
   dbms_session_t* session = NULL;
 
-  if (parse_selection_criteria(manager, input_line, &criteria, &session) != CLI_SUCCESS_RETURN_CODE) {
+  if (parse_selection_criteria(manager, input_line, &criteria, &session, arena) != CLI_SUCCESS_RETURN_CODE) {
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
@@ -950,37 +1279,42 @@ int cli_query_pipeline(dbms_manager_t* manager, char* input_line) {
   uint8_t num_columns = dbms_catalog_num_used(session->catalog);
 
   // Create column indices array for all columns (SELECT *)
-  uint8_t* column_indices = malloc(num_columns * sizeof(uint8_t));
+  uint8_t* column_indices = arena_alloc(arena, num_columns * sizeof(uint8_t));
   if (!column_indices) {
     fprintf(stderr, "Memory allocation failed for column indices\n");
-    goto cleanup_criteria;
+    goto cleanup_arena;
   }
   for (uint8_t i = 0; i < num_columns; i++) {
     column_indices[i] = i;
   }
 
-  // Build operator tree: Project -> Filter -> SeqScan
-  Operator* seq_scan = seq_scan_create(session);
-  if (!seq_scan) {
+  // Build operator tree: Project -> Filter -> (IndexScan | SeqScan)
+  // A range on a B+tree attribute or an equality on a hash indexed one only visits the matching
+  // pages, the Filter applies the rest
+  // Otherwise the SeqScan skips the pages the zone map rules out
+  Operator* scan = index_scan_create_for_criteria(session, &criteria, arena);
+  SeqScanState* seq_scan_state = NULL;
+  if (!scan) {
+    scan = seq_scan_create_for_criteria(session, &criteria, arena);
+    seq_scan_state = scan ? (SeqScanState*)scan->state : NULL;
+  }
+  if (!scan) {
     fprintf(stderr, "Failed to create SeqScan operator\n");
-    free(column_indices);
-    goto cleanup_criteria;
+    goto cleanup_arena;
   }
 
-  Operator* filter = filter_create(seq_scan, session, &criteria);
+  Operator* filter = filter_create(scan, session, &criteria, arena);
   if (!filter) {
     fprintf(stderr, "Failed to create Filter operator\n");
-    operator_free(seq_scan);
-    free(column_indices);
-    goto cleanup_criteria;
+    operator_free(scan);
+    goto cleanup_arena;
   }
 
-  Operator* project = project_create(filter, session, column_indices, num_columns, false);
+  Operator* project = project_create(filter, session, column_indices, num_columns, false, arena);
   if (!project) {
     fprintf(stderr, "Failed to create Project operator\n");
     operator_free(filter);
-    free(column_indices);
-    goto cleanup_criteria;
+    goto cleanup_arena;
   }
 
   // Execute pipeline
@@ -999,29 +1333,24 @@ int cli_query_pipeline(dbms_manager_t* manager, char* input_line) {
 
   printf("----------------------------------------\n");
   printf("%d tuple%s returned\n", tuple_count, tuple_count == 1 ? "" : "s");
+  if (seq_scan_state && session->zone_map) {
+    printf("%llu of %u pages skipped by the zone map\n", (unsigned long long)seq_scan_state->pages_skipped,
+           session->page_count);
+  }
+  if (session->stats) {
+    printf("%s chosen, %.0f tuples estimated by the statistics\n", seq_scan_state ? "SeqScan" : "IndexScan",
+           stats_row_count(session) * stats_selectivity(session, &criteria));
+  }
 
-  // Cleanup
+  // Cleanup (operators release their heap-side resources, everything else goes with the arena)
   OP_CLOSE(project);
   operator_free(project);
-  free(column_indices);
-
-  // Free criteria propositions
-  for (int i = 0; i < criteria.proposition_count; i++) {
-    if (criteria.propositions[i].value.type == ATTRIBUTE_TYPE_STRING && criteria.propositions[i].value.string_value) {
-      free(criteria.propositions[i].value.string_value);
-    }
-  }
-  free(criteria.propositions);
+  arena_free(arena);
 
   return CLI_SUCCESS_RETURN_CODE;
 
-cleanup_criteria:
-  for (int i = 0; i < criteria.proposition_count; i++) {
-    if (criteria.propositions[i].value.type == ATTRIBUTE_TYPE_STRING && criteria.propositions[i].value.string_value) {
-      free(criteria.propositions[i].value.string_value);
-    }
-  }
-  free(criteria.propositions);
+cleanup_arena:
+  arena_free(arena);
   return CLI_FAILURE_RETURN_CODE;
 }
 
@@ -1041,7 +1370,16 @@ int cli_query_join(dbms_manager_t* manager, char* input_line) {
   char* table_b_name = strtok_r(NULL, " \t\n", &save_ptr);
 
   if (!table_a_name || !table_b_name) {
-    fprintf(stderr, "Usage: query join <table_A> <table_B>\n");
+    fprintf(stderr, "Usage: query join <table_A> <table_B> [on <attribute_A> = <attribute_B>]\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  // Optional equi-join condition
+  char* on_keyword = strtok_r(NULL, " \t\n", &save_ptr);
+  char* attribute_a_name = strtok_r(NULL, " \t\n=", &save_ptr);
+  char* attribute_b_name = strtok_r(NULL, " \t\n=", &save_ptr);
+  if (on_keyword && (strcmp(on_keyword, "on") != 0 || !attribute_a_name || !attribute_b_name)) {
+    fprintf(stderr, "Usage: query join <table_A> <table_B> [on <attribute_A> = <attribute_B>]\n");
     return CLI_FAILURE_RETURN_CODE;
   }
 
@@ -1062,26 +1400,84 @@ int cli_query_join(dbms_manager_t* manager, char* input_line) {
   uint8_t outer_col_count = dbms_catalog_num_used(session_a->catalog);
   uint8_t inner_col_count = dbms_catalog_num_used(session_b->catalog);
 
-  // Build operator tree: NestedLoopJoin -> (SeqScan(A), SeqScan(B))
-  Operator* seq_scan_a = seq_scan_create(session_a);
-  if (!seq_scan_a) {
-    fprintf(stderr, "Failed to create SeqScan operator for table '%s'\n", table_a_name);
+  catalog_record_t* record_a = NULL;
+  catalog_record_t* record_b = NULL;
+  if (on_keyword) {
+    record_a = dbms_get_catalog_record_by_name(session_a->catalog, attribute_a_name);
+    record_b = dbms_get_catalog_record_by_name(session_b->catalog, attribute_b_name);
+    if (!record_a || !record_b) {
+      fprintf(stderr, "Attribute '%s' not found\n", !record_a ? attribute_a_name : attribute_b_name);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+    if (record_a->attribute_type != record_b->attribute_type) {
+      fprintf(stderr, "Join attributes '%s' and '%s' have different types\n", attribute_a_name, attribute_b_name);
+      return CLI_FAILURE_RETURN_CODE;
+    }
+  }
+
+  // With statistics on both tables the cost model picks the outer table, A's attributes are still printed first
+  bool is_swapped = false;
+  if (session_a->stats && session_b->stats) {
+    int attribute_a = record_a ? record_a->attribute_order : -1;
+    int attribute_b = record_b ? record_b->attribute_order : -1;
+    double a_outer_cost = stats_nested_loop_cost(session_a, session_b, attribute_a, attribute_b,
+                                                 record_b && session_b->indexes[attribute_b]);
+    double b_outer_cost = stats_nested_loop_cost(session_b, session_a, attribute_b, attribute_a,
+                                                 record_a && session_a->indexes[attribute_a]);
+    is_swapped = b_outer_cost < a_outer_cost;
+  }
+  dbms_session_t* outer_session = is_swapped ? session_b : session_a;
+  dbms_session_t* inner_session = is_swapped ? session_a : session_b;
+  const char* outer_name = is_swapped ? table_b_name : table_a_name;
+  const char* inner_name = is_swapped ? table_a_name : table_b_name;
+  catalog_record_t* outer_record = is_swapped ? record_b : record_a;
+  catalog_record_t* inner_record = is_swapped ? record_a : record_b;
+  uint8_t a_offset = is_swapped ? inner_col_count : 0;
+  uint8_t b_offset = is_swapped ? 0 : outer_col_count;
+  if (is_swapped) {
+    uint8_t col_count = outer_col_count;
+    outer_col_count = inner_col_count;
+    inner_col_count = col_count;
+  }
+
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  // Build operator tree: NestedLoopJoin -> (SeqScan(outer), SeqScan(inner))
+  Operator* seq_scan_outer = seq_scan_create(outer_session, arena);
+  if (!seq_scan_outer) {
+    fprintf(stderr, "Failed to create SeqScan operator for table '%s'\n", outer_name);
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  Operator* seq_scan_b = seq_scan_create(session_b);
-  if (!seq_scan_b) {
-    fprintf(stderr, "Failed to create SeqScan operator for table '%s'\n", table_b_name);
-    operator_free(seq_scan_a);
+  Operator* seq_scan_inner = seq_scan_create(inner_session, arena);
+  if (!seq_scan_inner) {
+    fprintf(stderr, "Failed to create SeqScan operator for table '%s'\n", inner_name);
+    operator_free(seq_scan_outer);
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
-  // Use session_a as the primary session for the join (for pin management)
-  Operator* join = nested_loop_join_create(seq_scan_a, seq_scan_b, session_a, outer_col_count, inner_col_count);
+  // Use the outer session as the primary session for the join (for pin management)
+  // An equi-join skips the inner scan for outer values the Bloom filter of the inner hash index rules out
+  Operator* join = NULL;
+  if (on_keyword) {
+    join = nested_loop_join_create_equi(seq_scan_outer, seq_scan_inner, outer_session, outer_col_count,
+                                        inner_col_count, outer_record->attribute_order,
+                                        inner_record->attribute_order,
+                                        inner_session->indexes[inner_record->attribute_order], arena);
+  } else {
+    join = nested_loop_join_create(seq_scan_outer, seq_scan_inner, outer_session, outer_col_count, inner_col_count,
+                                   arena);
+  }
   if (!join) {
     fprintf(stderr, "Failed to create NestedLoopJoin operator\n");
-    operator_free(seq_scan_a);
-    operator_free(seq_scan_b);
+    operator_free(seq_scan_outer);
+    operator_free(seq_scan_inner);
+    arena_free(arena);
     return CLI_FAILURE_RETURN_CODE;
   }
 
@@ -1091,16 +1487,18 @@ int cli_query_join(dbms_manager_t* manager, char* input_line) {
   printf("Join Query Results (%s x %s):\n", table_a_name, table_b_name);
   printf("----------------------------------------\n");
 
+  uint8_t a_col_count = dbms_catalog_num_used(session_a->catalog);
+  uint8_t b_col_count = dbms_catalog_num_used(session_b->catalog);
   int tuple_count = 0;
   tuple_t* tuple;
   while ((tuple = OP_NEXT(join)) != NULL) {
-    // Print combined tuple manually (outer attrs, then inner attrs)
+    // Print combined tuple manually (A attrs, then B attrs)
     printf("(");
 
-    // Print outer table attributes
-    for (uint8_t i = 0; i < outer_col_count; i++) {
+    // Print table A attributes
+    for (uint8_t i = 0; i < a_col_count; i++) {
       if (i > 0) printf(", ");
-      attribute_value_t* attr = &tuple->attributes[i];
+      attribute_value_t* attr = &tuple->attributes[a_offset + i];
       switch (attr->type) {
         case ATTRIBUTE_TYPE_INT:
           printf("%d", attr->int_value);
@@ -1119,10 +1517,10 @@ int cli_query_join(dbms_manager_t* manager, char* input_line) {
 
     printf(" | ");
 
-    // Print inner table attributes
-    for (uint8_t i = 0; i < inner_col_count; i++) {
+    // Print table B attributes
+    for (uint8_t i = 0; i < b_col_count; i++) {
       if (i > 0) printf(", ");
-      attribute_value_t* attr = &tuple->attributes[outer_col_count + i];
+      attribute_value_t* attr = &tuple->attributes[b_offset + i];
       switch (attr->type) {
         case ATTRIBUTE_TYPE_INT:
           printf("%d", attr->int_value);
@@ -1145,12 +1543,135 @@ int cli_query_join(dbms_manager_t* manager, char* input_line) {
 
   printf("----------------------------------------\n");
   printf("%d tuple%s returned\n", tuple_count, tuple_count == 1 ? "" : "s");
+  if (is_swapped) {
+    printf("'%s' scanned as the outer table, chosen by the statistics\n", outer_name);
+  }
+  if (on_keyword && inner_session->indexes[inner_record->attribute_order]) {
+    NestedLoopJoinState* join_state = (NestedLoopJoinState*)join->state;
+    printf("%llu outer tuple%s pruned by the Bloom filter\n", (unsigned long long)join_state->outer_pruned,
+           join_state->outer_pruned == 1 ? "" : "s");
+  }
 
   // Cleanup
   OP_CLOSE(join);
   operator_free(join);
+  arena_free(arena);
+
+  return CLI_SUCCESS_RETURN_CODE;
+}
+
+int cli_query_aggregate(dbms_manager_t* manager, char* input_line) {
+  if (!manager) {
+    fprintf(stderr, "Invalid manager\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  if (!input_line) {
+    fprintf(stderr, "No input line provided for aggregate command\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  // Split the aggregate list from the selection criteria
+  char* separator = strchr(input_line, '|');
+  if (!separator) {
+    fprintf(stderr, "Usage: query aggregate <aggregate1>, ... [by <attribute1>, ...] | [<proposition1>; ...] <table_name>\n");
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  *separator = '\0';
+  char* aggregate_str = input_line;
+  char* criteria_str = separator + 1;
+
+  // One region for the whole query: propositions, operators and their state
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return CLI_FAILURE_RETURN_CODE;
+  }
+  selection_criteria_t criteria = {0};
+  dbms_session_t* session = NULL;
+
+  if (parse_selection_criteria(manager, criteria_str, &criteria, &session, arena) != CLI_SUCCESS_RETURN_CODE) {
+    arena_free(arena);
+    return CLI_FAILURE_RETURN_CODE;
+  }
+
+  aggregate_t aggregates[MAX_QUERY_AGGREGATES];
+  uint8_t aggregate_count = 0;
+  uint8_t group_indices[MAX_QUERY_AGGREGATES];
+  uint8_t group_count = 0;
+  if (!parse_aggregate_list(aggregate_str, session->catalog, aggregates, &aggregate_count, group_indices,
+                            &group_count)) {
+    goto cleanup_arena;
+  }
+
+  Operator* aggregate = NULL;
+  if (group_count == 0) {
+    // Ungrouped aggregates reduce directly over the raw pages
+    aggregate = scan_aggregate_create(session, &criteria, aggregates, aggregate_count, arena);
+    if (!aggregate) {
+      fprintf(stderr, "Failed to create ScanAggregate operator\n");
+      goto cleanup_arena;
+    }
+  } else {
+    // Build operator tree: HashAggregate -> Filter -> SeqScan
+    Operator* seq_scan = seq_scan_create_for_criteria(session, &criteria, arena);
+    if (!seq_scan) {
+      fprintf(stderr, "Failed to create SeqScan operator\n");
+      goto cleanup_arena;
+    }
+
+    Operator* filter = filter_create(seq_scan, session, &criteria, arena);
+    if (!filter) {
+      fprintf(stderr, "Failed to create Filter operator\n");
+      operator_free(seq_scan);
+      goto cleanup_arena;
+    }
+
+    aggregate =
+        hash_aggregate_create(filter, session, group_indices, group_count, aggregates, aggregate_count, 0, arena);
+    if (!aggregate) {
+      fprintf(stderr, "Failed to create HashAggregate operator\n");
+      operator_free(filter);
+      goto cleanup_arena;
+    }
+  }
+
+  // Execute aggregation
+  OP_OPEN(aggregate);
+
+  printf("Aggregate Query Results:\n");
+  printf("(");
+  for (uint8_t i = 0; i < group_count; i++) {
+    printf("%s, ", dbms_get_catalog_record(session->catalog, group_indices[i])->attribute_name);
+  }
+  for (uint8_t i = 0; i < aggregate_count; i++) {
+    const char* argument = aggregates[i].attribute_index == AGGREGATE_COUNT_STAR
+                               ? "*"
+                               : dbms_get_catalog_record(session->catalog, aggregates[i].attribute_index)->attribute_name;
+    printf("%s%s(%s)", i > 0 ? ", " : "", hash_aggregate_function_name(aggregates[i].function), argument);
+  }
+  printf(")\n");
+  printf("----------------------------------------\n");
+
+  int group_total = 0;
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(aggregate)) != NULL) {
+    print_attribute_values(tuple->attributes, group_count + aggregate_count);
+    printf("\n");
+    group_total++;
+  }
+
+  printf("----------------------------------------\n");
+  printf("%d group%s returned\n", group_total, group_total == 1 ? "" : "s");
+
+  // Cleanup (the group table and spill files are released by operator_free, the rest with the arena)
+  OP_CLOSE(aggregate);
+  operator_free(aggregate);
+  arena_free(arena);
 
   return CLI_SUCCESS_RETURN_CODE;
+
+cleanup_arena:
+  arena_free(arena);
+  return CLI_FAILURE_RETURN_CODE;
 }
 
 static bool populate_attribute_values_from_tokens(system_catalog_t* catalog, char** tokens, uint8_t num_attributes,
@@ -1205,7 +1726,115 @@ static void print_tuple_info(tuple_t* tuple, uint8_t num_attributes, system_cata
   printf(")");
 }
 
-static bool generate_proposition(char* proposition_str, proposition_t* proposition, const system_catalog_t* catalog) {
+static void print_attribute_values(const attribute_value_t* attributes, uint8_t num_attributes) {
+  printf("(");
+  for (int i = 0; i < num_attributes; i++) {
+    if (i > 0) {
+      printf(", ");
+    }
+    switch (attributes[i].type) {
+      case ATTRIBUTE_TYPE_INT:
+        printf("%d", attributes[i].int_value);
+        break;
+      case ATTRIBUTE_TYPE_FLOAT:
+        printf("%f", attributes[i].float_value);
+        break;
+      case ATTRIBUTE_TYPE_STRING:
+        printf("%s", attributes[i].string_value);
+        break;
+      case ATTRIBUTE_TYPE_BOOL:
+        printf("%s", attributes[i].bool_value ? "true" : "false");
+        break;
+    }
+  }
+  printf(")");
+}
+
+static bool parse_aggregate_list(char* aggregate_str, const system_catalog_t* catalog, aggregate_t* aggregates,
+                                 uint8_t* aggregate_count, uint8_t* group_indices, uint8_t* group_count) {
+  // Example: "count(*), avg(salary) by department, is_active"
+  static const char* function_names[] = {"count", "sum", "min", "max", "avg"};
+  static const uint8_t functions[] = {AGGREGATE_COUNT, AGGREGATE_SUM, AGGREGATE_MIN, AGGREGATE_MAX, AGGREGATE_AVG};
+
+  bool in_group_by = false;
+  char* save_ptr = NULL;
+  char* token = strtok_r(aggregate_str, ", \t\n", &save_ptr);
+  while (token) {
+    if (strcmp(token, "by") == 0) {
+      if (in_group_by) {
+        fprintf(stderr, "Duplicate 'by' in aggregate command\n");
+        return false;
+      }
+      in_group_by = true;
+    } else if (in_group_by) {
+      catalog_record_t* record = dbms_get_catalog_record_by_name(catalog, token);
+      if (!record) {
+        fprintf(stderr, "Attribute '%s' not found in catalog\n", token);
+        return false;
+      }
+      if (*group_count >= MAX_QUERY_AGGREGATES) {
+        fprintf(stderr, "Exceeded maximum number of group by attributes (%d)\n", MAX_QUERY_AGGREGATES);
+        return false;
+      }
+      group_indices[(*group_count)++] = record->attribute_order;
+    } else {
+      // Parse "function(attribute)"
+      char* open_paren = strchr(token, '(');
+      char* close_paren = strrchr(token, ')');
+      if (!open_paren || !close_paren || close_paren < open_paren || close_paren[1] != '\0') {
+        fprintf(stderr, "Invalid aggregate format: %s\n", token);
+        return false;
+      }
+      *open_paren = '\0';
+      *close_paren = '\0';
+      char* argument = open_paren + 1;
+
+      uint8_t function = 0;
+      for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+        if (strcmp(token, function_names[i]) == 0) {
+          function = functions[i];
+          break;
+        }
+      }
+      if (function == 0) {
+        fprintf(stderr, "Unknown aggregate function: %s\n", token);
+        return false;
+      }
+      if (*aggregate_count >= MAX_QUERY_AGGREGATES) {
+        fprintf(stderr, "Exceeded maximum number of aggregates (%d)\n", MAX_QUERY_AGGREGATES);
+        return false;
+      }
+
+      aggregate_t* aggregate = &aggregates[(*aggregate_count)++];
+      aggregate->function = function;
+      if (function == AGGREGATE_COUNT && strcmp(argument, "*") == 0) {
+        aggregate->attribute_index = AGGREGATE_COUNT_STAR;
+      } else {
+        catalog_record_t* record = dbms_get_catalog_record_by_name(catalog, argument);
+        if (!record) {
+          fprintf(stderr, "Attribute '%s' not found in catalog\n", argument);
+          return false;
+        }
+        if (!hash_aggregate_supports(function, record->attribute_type)) {
+          fprintf(stderr, "Aggregate %s is not supported on attribute '%s'\n", hash_aggregate_function_name(function),
+                  argument);
+          return false;
+        }
+        aggregate->attribute_index = record->attribute_order;
+      }
+    }
+    token = strtok_r(NULL, ", \t\n", &save_ptr);
+  }
+
+  if (*aggregate_count == 0) {
+    fprintf(stderr, "No aggregates provided for aggregate command\n");
+    return false;
+  }
+  return true;
+}
+
+static bool generate_proposition(char* proposition_str, proposition_t* proposition, const system_catalog_t* catalog,
+                                 arena_t* arena) {
   // Example proposition: "attribute_name operator value"
   // Remove leading/trailing whitespace
   while (*proposition_str == ' ' || *proposition_str == '\t' || *proposition_str == '\n') {
@@ -1261,7 +1890,7 @@ static bool generate_proposition(char* proposition_str, proposition_t* propositi
       proposition->value.float_value = (float)atof(value_str);
       break;
     case ATTRIBUTE_TYPE_STRING:
-      proposition->value.string_value = strdup(value_str);
+      proposition->value.string_value = arena_strdup(arena, value_str);
       if (!proposition->value.string_value) {
         fprintf(stderr, "Memory allocation failed for string value in proposition\n");
         return false;
@@ -1281,7 +1910,7 @@ static bool generate_proposition(char* proposition_str, proposition_t* propositi
 }
 
 int parse_selection_criteria(dbms_manager_t* manager, char* input_line, selection_criteria_t* criteria,
-                             dbms_session_t** out_session) {
+                             dbms_session_t** out_session, arena_t* arena) {
   // Do different things if *out_session is NULL or not
   // If *out_session is NULL, we assume that the last token is the table name, otherwise we already have a table name
 
@@ -1341,21 +1970,15 @@ int parse_selection_criteria(dbms_manager_t* manager, char* input_line, selectio
   system_catalog_t* catalog = session->catalog;
 
   criteria->proposition_count = proposition_count;
-  criteria->propositions = calloc(proposition_count, sizeof(proposition_t));
+  // Propositions and their string values live in the query arena, freed with it
+  criteria->propositions = arena_calloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(proposition_t));
   if (!criteria->propositions) {
     fprintf(stderr, "Memory allocation failed for criteria propositions\n");
     return CLI_FAILURE_RETURN_CODE;
   }
 
   for (int i = 0; i < proposition_count; i++) {
-    if (!generate_proposition(propositions[i], &criteria->propositions[i], catalog)) {
-      for (int j = 0; j < i; j++) {
-        if (criteria->propositions[j].value.type == ATTRIBUTE_TYPE_STRING &&
-            criteria->propositions[j].value.string_value) {
-          free(criteria->propositions[j].value.string_value);
-        }
-      }
-      free(criteria->propositions);
+    if (!generate_proposition(propositions[i], &criteria->propositions[i], catalog, arena)) {
       return CLI_FAILURE_RETURN_CODE;
     }
   }
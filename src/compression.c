@@ -0,0 +1,586 @@
+#include "compression.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "align.h"
+#include "ssdio.h"
+
+// LZ4 block format: sequences of [token][literal length][literals][offset][match length], the token's
+// high nibble holds the literal length and its low nibble the match length - 4, 15 meaning more
+// length bytes follow. The last sequence only has literals.
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5   // The block ends with at least this many literals
+#define LZ4_MATCH_LIMIT 12    // The last match starts at least this many bytes before the end
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+#define LZ4_LENGTH_MASK 15
+#define LZ4_COPY_SIZE 16
+
+#define COMPRESSION_MAP_MAGIC_SIZE 8
+#define COMPRESSION_MAP_INITIAL_CAPACITY 16
+#define COMPRESSION_EXTENT_ROUND_UP(n) \
+  (((n) + (COMPRESSION_EXTENT_UNIT - 1)) & ~((uint64_t)COMPRESSION_EXTENT_UNIT - 1))
+
+typedef struct {
+  char magic[COMPRESSION_MAP_MAGIC_SIZE];
+  uint64_t page_count;
+  uint64_t file_end;
+} compression_map_header_t;
+
+static uint32_t hash_sequence(uint32_t sequence);
+static bool write_length(uint8_t* destination, size_t capacity, size_t* out, size_t length);
+static bool read_length(const uint8_t* source, size_t size, size_t* in, size_t* length);
+static bool emit_sequence(uint8_t* destination, size_t capacity, size_t* out, const uint8_t* literals,
+                          size_t literal_length, size_t offset, size_t match_length);
+static char* get_filename(const char* table_filename, const char* suffix);
+static compression_map_t* allocate_map(const char* table_filename, uint32_t page_size);
+static bool ensure_capacity(compression_map_t* map, uint64_t page_count);
+static bool push_extent(compression_extent_t** extents, uint64_t* count, uint64_t* capacity,
+                        compression_extent_t extent);
+static uint64_t allocate_extent(compression_map_t* map, uint32_t capacity);
+static int compare_extents(const void* a, const void* b);
+static bool find_free_extents(compression_map_t* map);
+
+size_t compression_lz4_bound(size_t size) { return size + size / 255 + 16; }
+
+size_t compression_lz4_compress(const void* source, size_t size, void* destination, size_t capacity) {
+  if (!source || !destination) {
+    return 0;
+  }
+
+  const uint8_t* src = source;
+  uint8_t* dst = destination;
+  uint32_t table[1u << LZ4_HASH_BITS];
+  memset(table, 0, sizeof(table));
+
+  size_t out = 0;
+  size_t anchor = 0;
+  size_t position = 0;
+  size_t match_limit = size > LZ4_MATCH_LIMIT ? size - LZ4_MATCH_LIMIT : 0;
+  while (position < match_limit) {
+    uint32_t sequence = load_u32(src + position);
+    uint32_t hash = hash_sequence(sequence);
+    size_t candidate = table[hash];
+    table[hash] = (uint32_t)position;
+    if (candidate >= position || position - candidate > LZ4_MAX_OFFSET || load_u32(src + candidate) != sequence) {
+      position++;
+      continue;
+    }
+
+    // Grow the match backwards over pending literals, then forwards up to the last literals
+    while (position > anchor && candidate > 0 && src[position - 1] == src[candidate - 1]) {
+      position--;
+      candidate--;
+    }
+    size_t match_end = position + LZ4_MIN_MATCH;
+    while (match_end < size - LZ4_LAST_LITERALS && src[match_end] == src[candidate + match_end - position]) {
+      match_end++;
+    }
+
+    if (!emit_sequence(dst, capacity, &out, src + anchor, position - anchor, position - candidate,
+                       match_end - position)) {
+      return 0;
+    }
+    position = match_end;
+    anchor = position;
+  }
+
+  if (!emit_sequence(dst, capacity, &out, src + anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return out;
+}
+
+bool compression_lz4_decompress(const void* source, size_t size, void* destination, size_t destination_size) {
+  if (!source || !destination) {
+    return false;
+  }
+
+  const uint8_t* src = source;
+  uint8_t* dst = destination;
+  size_t in = 0;
+  size_t out = 0;
+  while (in < size) {
+    uint8_t token = src[in++];
+    size_t literal_length = token >> 4;
+    if (literal_length == LZ4_LENGTH_MASK && !read_length(src, size, &in, &literal_length)) {
+      return false;
+    }
+    if (literal_length > size - in || literal_length > destination_size - out) {
+      return false;
+    }
+    // Short literal runs are copied as one fixed-size block when both buffers have room for the overrun
+    if (literal_length <= LZ4_COPY_SIZE && size - in >= LZ4_COPY_SIZE && destination_size - out >= LZ4_COPY_SIZE) {
+      memcpy(dst + out, src + in, LZ4_COPY_SIZE);
+    } else {
+      memcpy(dst + out, src + in, literal_length);
+    }
+    in += literal_length;
+    out += literal_length;
+    if (in == size) {
+      break;
+    }
+
+    if (size - in < 2) {
+      return false;
+    }
+    size_t offset = (size_t)src[in] | ((size_t)src[in + 1] << 8);
+    in += 2;
+    size_t match_length = token & LZ4_LENGTH_MASK;
+    if (match_length == LZ4_LENGTH_MASK && !read_length(src, size, &in, &match_length)) {
+      return false;
+    }
+    match_length += LZ4_MIN_MATCH;
+    if (offset == 0 || offset > out || match_length > destination_size - out) {
+      return false;
+    }
+
+    // Overlapping matches repeat the bytes just written, 8 at a time when they are at least 8 back
+    if (offset >= match_length) {
+      memcpy(dst + out, dst + out - offset, match_length);
+    } else if (offset == 1) {
+      memset(dst + out, dst[out - 1], match_length);
+    } else if (offset >= sizeof(uint64_t) && destination_size - out >= match_length + sizeof(uint64_t)) {
+      for (size_t i = 0; i < match_length; i += sizeof(uint64_t)) {
+        memcpy(dst + out + i, dst + out - offset + i, sizeof(uint64_t));
+      }
+    } else {
+      for (size_t i = 0; i < match_length; i++) {
+        dst[out + i] = dst[out - offset + i];
+      }
+    }
+    out += match_length;
+  }
+  return out == destination_size;
+}
+
+bool compression_map_create(const char* table_filename, int fd, const page_t* first_page, uint32_t page_size) {
+  if (!table_filename || fd < 0 || !first_page) {
+    return false;
+  }
+
+  compression_map_t* map = allocate_map(table_filename, page_size);
+  if (!map) {
+    return false;
+  }
+  bool ok = compression_map_write_page(map, fd, 1, first_page) && ssdio_flush(fd) == 0 && compression_map_sync(map);
+  compression_map_free(map);
+  return ok;
+}
+
+compression_map_t* compression_map_open(const char* table_filename, uint32_t page_size) {
+  if (!table_filename) {
+    return NULL;
+  }
+
+  compression_map_t* map = allocate_map(table_filename, page_size);
+  if (!map) {
+    return NULL;
+  }
+
+  int fd = ssdio_open(map->filename, false);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open compression map file: %s\n", map->filename);
+    compression_map_free(map);
+    return NULL;
+  }
+
+  compression_map_header_t header = {0};
+  off_t file_size = ssdio_get_file_size(fd);
+  bool ok = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+            memcmp(header.magic, COMPRESSION_MAP_FILE_MAGIC, COMPRESSION_MAP_MAGIC_SIZE) == 0 &&
+            header.page_count <= (uint64_t)(file_size - (off_t)sizeof(header)) / sizeof(compression_extent_t) &&
+            ensure_capacity(map, header.page_count);
+  size_t extents_size = header.page_count * sizeof(compression_extent_t);
+  ok = ok && pread(fd, map->extents, extents_size, sizeof(header)) == (ssize_t)extents_size;
+  ssdio_close(fd);
+
+  map->page_count = header.page_count;
+  map->file_end = header.file_end;
+  for (uint64_t i = 0; ok && i < map->page_count; i++) {
+    const compression_extent_t* extent = &map->extents[i];
+    ok = extent->offset >= PAGE_SIZE && extent->offset % COMPRESSION_EXTENT_UNIT == 0 &&
+         extent->capacity % COMPRESSION_EXTENT_UNIT == 0 && extent->length > 0 &&
+         extent->length <= extent->capacity && extent->length <= map->page_size &&
+         extent->offset + extent->capacity <= map->file_end;
+  }
+  if (!ok || !find_free_extents(map)) {
+    fprintf(stderr, "Failed to load compression map file: %s\n", map->filename);
+    compression_map_free(map);
+    return NULL;
+  }
+  return map;
+}
+
+bool compression_map_read_page(const compression_map_t* map, int fd, uint64_t page_id, page_t* page) {
+  if (!map || !page || page_id == 0 || page_id > map->page_count) {
+    return false;
+  }
+
+  const compression_extent_t* extent = &map->extents[page_id - 1];
+  if (extent->length == map->page_size) {
+    return pread(fd, page, map->page_size, (off_t)extent->offset) == (ssize_t)map->page_size;
+  }
+
+  // Compressed pages are at most page_size - COMPRESSION_EXTENT_UNIT bytes
+  char buffer[map->page_size];
+  return pread(fd, buffer, extent->length, (off_t)extent->offset) == (ssize_t)extent->length &&
+         compression_lz4_decompress(buffer, extent->length, page, map->page_size);
+}
+
+bool compression_map_write_page(compression_map_t* map, int fd, uint64_t page_id, const page_t* page) {
+  if (!map || !page || page_id == 0 || page_id > map->page_count + 1) {
+    return false;
+  }
+  if (page_id > map->page_count && !ensure_capacity(map, page_id)) {
+    return false;
+  }
+
+  // A page that would not save a whole unit is stored as is
+  size_t length =
+      compression_lz4_compress(page, map->page_size, map->buffer, map->page_size - COMPRESSION_EXTENT_UNIT);
+  if (length == 0) {
+    memcpy(map->buffer, page, map->page_size);
+    length = map->page_size;
+  }
+  uint32_t capacity = (uint32_t)COMPRESSION_EXTENT_ROUND_UP(length);
+  memset(map->buffer + length, 0, capacity - length);
+
+  compression_extent_t* extent = &map->extents[page_id - 1];
+  if (page_id > map->page_count) {
+    *extent = (compression_extent_t){0};
+  }
+  compression_extent_t previous = *extent;
+  uint64_t offset = previous.capacity >= capacity ? previous.offset : allocate_extent(map, capacity);
+  if (pwrite(fd, map->buffer, capacity, (off_t)offset) != (ssize_t)capacity) {
+    fprintf(stderr, "Failed to write compressed page %llu\n", (unsigned long long)page_id);
+    if (offset != previous.offset) {
+      push_extent(&map->released_extents, &map->released_count, &map->released_capacity,
+                  (compression_extent_t){.offset = offset, .capacity = capacity});
+    }
+    return false;
+  }
+
+  // The old extent holds the page the map on disk points to until the next sync
+  if (offset != previous.offset) {
+    if (previous.capacity > 0 &&
+        !push_extent(&map->released_extents, &map->released_count, &map->released_capacity, previous)) {
+      return false;
+    }
+    extent->offset = offset;
+    extent->capacity = capacity;
+  }
+  extent->length = (uint32_t)length;
+  if (page_id > map->page_count) {
+    map->page_count = page_id;
+  }
+  map->is_dirty = true;
+  return true;
+}
+
+bool compression_map_sync(compression_map_t* map) {
+  if (!map || !map->is_dirty) {
+    return true;
+  }
+
+  char* temporary_filename = get_filename(map->filename, ".tmp");
+  if (!temporary_filename) {
+    return false;
+  }
+  size_t size = sizeof(compression_map_header_t) + map->page_count * sizeof(compression_extent_t);
+  char* buffer = calloc(1, size);
+  if (!buffer) {
+    fprintf(stderr, "Memory allocation failed for compression map file\n");
+    free(temporary_filename);
+    return false;
+  }
+  compression_map_header_t* header = (compression_map_header_t*)buffer;
+  memcpy(header->magic, COMPRESSION_MAP_FILE_MAGIC, COMPRESSION_MAP_MAGIC_SIZE);
+  header->page_count = map->page_count;
+  header->file_end = map->file_end;
+  memcpy(buffer + sizeof(*header), map->extents, map->page_count * sizeof(compression_extent_t));
+
+  // Renamed over the old map once complete, so a crash leaves one or the other
+  int fd = ssdio_open(temporary_filename, true);
+  bool ok = fd >= 0 && pwrite(fd, buffer, size, 0) == (ssize_t)size && ssdio_flush(fd) == 0;
+  if (fd >= 0) {
+    ssdio_close(fd);
+  }
+  ok = ok && rename(temporary_filename, map->filename) == 0;
+  if (!ok) {
+    fprintf(stderr, "Failed to write compression map file: %s\n", map->filename);
+    remove(temporary_filename);
+  }
+  free(buffer);
+  free(temporary_filename);
+  if (!ok) {
+    return false;
+  }
+
+  for (uint64_t i = 0; i < map->released_count; i++) {
+    if (!push_extent(&map->free_extents, &map->free_count, &map->free_capacity, map->released_extents[i])) {
+      return false;
+    }
+  }
+  map->released_count = 0;
+  map->is_dirty = false;
+  return true;
+}
+
+bool compression_map_truncate(compression_map_t* map, uint64_t page_count) {
+  if (!map || page_count >= map->page_count) {
+    return true;
+  }
+
+  // Like rewritten pages, the extents stay untouched until the map on disk stops using them
+  for (uint64_t i = page_count; i < map->page_count; i++) {
+    if (!push_extent(&map->released_extents, &map->released_count, &map->released_capacity, map->extents[i])) {
+      return false;
+    }
+  }
+  map->page_count = page_count;
+  map->is_dirty = true;
+  return true;
+}
+
+bool compression_map_trim(compression_map_t* map, int fd, bool punch_holes) {
+  if (!map) {
+    return true;
+  }
+  if (map->is_dirty || map->released_count > 0) {
+    fprintf(stderr, "Compression map must be synced before it is trimmed\n");
+    return false;
+  }
+
+  uint64_t end = PAGE_SIZE;
+  for (uint64_t i = 0; i < map->page_count; i++) {
+    uint64_t extent_end = map->extents[i].offset + map->extents[i].capacity;
+    end = extent_end > end ? extent_end : end;
+  }
+
+  // The free list is rebuilt from the gaps so neighbouring free extents are merged
+  map->free_count = 0;
+  if (end < map->file_end) {
+    map->file_end = end;
+    map->is_dirty = true;
+  }
+  if (!find_free_extents(map) || !compression_map_sync(map) || !ssdio_truncate(fd, (off_t)map->file_end)) {
+    return false;
+  }
+
+  for (uint64_t i = 0; punch_holes && i < map->free_count; i++) {
+    const compression_extent_t* extent = &map->free_extents[i];
+    if (!ssdio_punch_hole(fd, (off_t)extent->offset, extent->capacity)) {
+      fprintf(stderr, "Failed to punch a hole in the table file, it is kept allocated\n");
+      break;
+    }
+  }
+  return true;
+}
+
+uint64_t compression_map_stored_size(const compression_map_t* map) {
+  if (!map) {
+    return 0;
+  }
+  uint64_t size = 0;
+  for (uint64_t i = 0; i < map->page_count; i++) {
+    size += map->extents[i].capacity;
+  }
+  return size;
+}
+
+void compression_map_free(compression_map_t* map) {
+  if (!map) {
+    return;
+  }
+  free(map->filename);
+  free(map->extents);
+  free(map->free_extents);
+  free(map->released_extents);
+  free(map->buffer);
+  free(map);
+}
+
+// Multiplicative hash of four input bytes
+static uint32_t hash_sequence(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS); }
+
+static bool write_length(uint8_t* destination, size_t capacity, size_t* out, size_t length) {
+  length -= LZ4_LENGTH_MASK;
+  while (length >= UINT8_MAX) {
+    if (*out >= capacity) {
+      return false;
+    }
+    destination[(*out)++] = UINT8_MAX;
+    length -= UINT8_MAX;
+  }
+  if (*out >= capacity) {
+    return false;
+  }
+  destination[(*out)++] = (uint8_t)length;
+  return true;
+}
+
+static bool read_length(const uint8_t* source, size_t size, size_t* in, size_t* length) {
+  uint8_t byte = 0;
+  do {
+    if (*in >= size) {
+      return false;
+    }
+    byte = source[(*in)++];
+    *length += byte;
+  } while (byte == UINT8_MAX);
+  return true;
+}
+
+// A match_length of 0 ends the block with the literals alone
+static bool emit_sequence(uint8_t* destination, size_t capacity, size_t* out, const uint8_t* literals,
+                          size_t literal_length, size_t offset, size_t match_length) {
+  if (*out >= capacity) {
+    return false;
+  }
+  size_t token = *out;
+  destination[(*out)++] = (uint8_t)((literal_length < LZ4_LENGTH_MASK ? literal_length : LZ4_LENGTH_MASK) << 4);
+  if (literal_length >= LZ4_LENGTH_MASK && !write_length(destination, capacity, out, literal_length)) {
+    return false;
+  }
+  if (literal_length > capacity - *out) {
+    return false;
+  }
+  memcpy(destination + *out, literals, literal_length);
+  *out += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+
+  if (capacity - *out < 2) {
+    return false;
+  }
+  destination[(*out)++] = (uint8_t)(offset & 0xFF);
+  destination[(*out)++] = (uint8_t)(offset >> 8);
+  size_t stored_length = match_length - LZ4_MIN_MATCH;
+  destination[token] |= (uint8_t)(stored_length < LZ4_LENGTH_MASK ? stored_length : LZ4_LENGTH_MASK);
+  return stored_length < LZ4_LENGTH_MASK || write_length(destination, capacity, out, stored_length);
+}
+
+static char* get_filename(const char* table_filename, const char* suffix) {
+  size_t length = strlen(table_filename) + strlen(suffix) + 1;
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for compression map filename\n");
+    return NULL;
+  }
+  snprintf(filename, length, "%s%s", table_filename, suffix);
+  return filename;
+}
+
+static compression_map_t* allocate_map(const char* table_filename, uint32_t page_size) {
+  compression_map_t* map = calloc(1, sizeof(compression_map_t));
+  if (!map) {
+    fprintf(stderr, "Memory allocation failed for compression map\n");
+    return NULL;
+  }
+  map->filename = get_filename(table_filename, COMPRESSION_MAP_FILE_EXTENSION);
+  map->page_size = page_size;
+  map->buffer = malloc(page_size);
+  if (!map->filename || !map->buffer || !ensure_capacity(map, COMPRESSION_MAP_INITIAL_CAPACITY)) {
+    fprintf(stderr, "Memory allocation failed for compression map\n");
+    compression_map_free(map);
+    return NULL;
+  }
+  // Extents follow the catalog page
+  map->file_end = PAGE_SIZE;
+  return map;
+}
+
+static bool ensure_capacity(compression_map_t* map, uint64_t page_count) {
+  if (page_count <= map->capacity) {
+    return true;
+  }
+  uint64_t capacity = map->capacity ? map->capacity : COMPRESSION_MAP_INITIAL_CAPACITY;
+  while (capacity < page_count) {
+    capacity *= 2;
+  }
+  compression_extent_t* extents = realloc(map->extents, capacity * sizeof(compression_extent_t));
+  if (!extents) {
+    fprintf(stderr, "Memory allocation failed for compression map extents\n");
+    return false;
+  }
+  map->extents = extents;
+  map->capacity = capacity;
+  return true;
+}
+
+static bool push_extent(compression_extent_t** extents, uint64_t* count, uint64_t* capacity,
+                        compression_extent_t extent) {
+  if (*count == *capacity) {
+    uint64_t new_capacity = *capacity ? *capacity * 2 : COMPRESSION_MAP_INITIAL_CAPACITY;
+    compression_extent_t* new_extents = realloc(*extents, new_capacity * sizeof(compression_extent_t));
+    if (!new_extents) {
+      fprintf(stderr, "Memory allocation failed for compression map extents\n");
+      return false;
+    }
+    *extents = new_extents;
+    *capacity = new_capacity;
+  }
+  (*extents)[(*count)++] = extent;
+  return true;
+}
+
+// First fit among the free extents, else appended to the file
+static uint64_t allocate_extent(compression_map_t* map, uint32_t capacity) {
+  for (uint64_t i = 0; i < map->free_count; i++) {
+    compression_extent_t* extent = &map->free_extents[i];
+    if (extent->capacity < capacity) {
+      continue;
+    }
+    uint64_t offset = extent->offset;
+    extent->offset += capacity;
+    extent->capacity -= capacity;
+    if (extent->capacity == 0) {
+      *extent = map->free_extents[--map->free_count];
+    }
+    return offset;
+  }
+
+  uint64_t offset = map->file_end;
+  map->file_end += capacity;
+  return offset;
+}
+
+static int compare_extents(const void* a, const void* b) {
+  const compression_extent_t* extent_a = a;
+  const compression_extent_t* extent_b = b;
+  return (extent_a->offset > extent_b->offset) - (extent_a->offset < extent_b->offset);
+}
+
+// The gaps between the extents in use, so space freed before the last sync is found again
+static bool find_free_extents(compression_map_t* map) {
+  compression_extent_t* sorted = malloc((map->page_count + 1) * sizeof(compression_extent_t));
+  if (!sorted) {
+    fprintf(stderr, "Memory allocation failed for compression map extents\n");
+    return false;
+  }
+  memcpy(sorted, map->extents, map->page_count * sizeof(compression_extent_t));
+  qsort(sorted, map->page_count, sizeof(compression_extent_t), compare_extents);
+
+  bool ok = true;
+  uint64_t end = PAGE_SIZE;
+  for (uint64_t i = 0; ok && i < map->page_count; i++) {
+    if (sorted[i].offset < end) {
+      fprintf(stderr, "Overlapping extents in compression map file: %s\n", map->filename);
+      ok = false;
+    } else if (sorted[i].offset > end) {
+      ok = push_extent(&map->free_extents, &map->free_count, &map->free_capacity,
+                       (compression_extent_t){.offset = end, .capacity = (uint32_t)(sorted[i].offset - end)});
+    }
+    end = sorted[i].offset + sorted[i].capacity;
+  }
+  if (ok && map->file_end > end) {
+    ok = push_extent(&map->free_extents, &map->free_count, &map->free_capacity,
+                     (compression_extent_t){.offset = end, .capacity = (uint32_t)(map->file_end - end)});
+  }
+  free(sorted);
+  return ok;
+}
@@ -1,42 +1,57 @@
 #include "data_structures.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#include "simd.h"
+
+#define HASH_TABLE_TAG_MASK 0x7f
+
+_Static_assert(HASH_TABLE_MIN_CAPACITY >= HASH_TABLE_GROUP_SIZE, "A probe group must fit in the table");
 
 /**
- * @brief Inserts a key-value pair into the linked list in sorted order
+ * @brief Hashes a key for the table, the low 7 bits are the control tag and the rest pick the home slot
  *
- * @param head Pointer to the head of the linked list
- * @param key The key to insert
- * @param value The value to insert
- * @return true on success, false on failure
+ * @param key The key to hash
+ * @return The hashed value
  */
-static bool linked_list_insert(hash_node_t** head, uint64_t key, uint64_t value);
+static uint64_t hash_key(uint64_t key);
 
 /**
- * @brief Deletes a key from the linked list
+ * @brief Finds the slot of a key, or the first empty slot of its probe run
  *
- * @param head Pointer to the head of the linked list
- * @param key The key to delete
- * @return true if the key was found and deleted, false otherwise
+ * @param table Pointer to the hash table
+ * @param key The key to search for
+ * @param index_out Pointer to store the slot index
+ * @return true if the key is in the slot, false if the slot is the empty one the key would go in
  */
-static bool linked_list_delete(hash_node_t** head, uint64_t key);
+static bool find_slot(const hash_table_t* table, uint64_t key, size_t* index_out);
 
 /**
- * @brief Retrieves a value by key from the linked list
+ * @brief Sets the control byte of a slot, keeping the wrapped copy of the first group in sync
  *
- * @param head Pointer to the head of the linked list
- * @param key The key to search for
- * @param value_out Pointer to store the retrieved value
- * @return true if the key is found and value is set, false otherwise
+ * @param table Pointer to the hash table
+ * @param index The slot index
+ * @param control HASH_TABLE_EMPTY or the tag of the slot's key
  */
-static bool linked_list_get(hash_node_t** head, uint64_t key, uint64_t* value_out);
+static void set_control(hash_table_t* table, size_t index, uint8_t control);
 
 /**
- * @brief Frees the linked list
+ * @brief Allocates empty control bytes and slots for a capacity
  *
- * @param head Pointer to the head of the linked list
+ * @param table Pointer to the hash table
+ * @param capacity The new capacity (a power of two, at least HASH_TABLE_MIN_CAPACITY)
+ * @return true on success, false on failure
  */
-static void linked_list_free(hash_node_t** head);
+static bool allocate_slots(hash_table_t* table, size_t capacity);
+
+/**
+ * @brief Doubles the capacity and reinserts every entry
+ *
+ * @param table Pointer to the hash table
+ * @return true on success, false on failure (the table is left unchanged)
+ */
+static bool grow(hash_table_t* table);
 
 uint64_t fnv1a_hash(uint64_t key) {
   uint64_t hash = FNV_OFFSET_BASIS_64;
@@ -48,8 +63,8 @@ uint64_t fnv1a_hash(uint64_t key) {
   return hash;
 }
 
-hash_table_t* hash_table_init(size_t bucket_count) {
-  if (bucket_count == 0) {
+hash_table_t* hash_table_init(size_t expected_count) {
+  if (expected_count == 0) {
     return NULL;
   }
 
@@ -58,19 +73,16 @@ hash_table_t* hash_table_init(size_t bucket_count) {
     return NULL;
   }
 
-  // Make bucket count a power of two for more efficient modulus
-  size_t power_of_two_bucket_count = 1;
-  while (power_of_two_bucket_count < bucket_count) {
-    power_of_two_bucket_count <<= 1;
+  // Power of two capacity for a cheap modulus, with room to stay under the maximum load
+  size_t capacity = HASH_TABLE_MIN_CAPACITY;
+  while (capacity * HASH_TABLE_MAX_LOAD_NUMERATOR < expected_count * HASH_TABLE_MAX_LOAD_DENOMINATOR) {
+    capacity <<= 1;
   }
 
-  table->buckets = calloc(power_of_two_bucket_count, sizeof(hash_node_t*));
-  if (!table->buckets) {
+  if (!allocate_slots(table, capacity)) {
     free(table);
     return NULL;
   }
-
-  table->bucket_count = power_of_two_bucket_count;
   return table;
 }
 
@@ -79,135 +91,166 @@ void hash_table_free(hash_table_t* table) {
     return;
   }
 
-  if (table->buckets) {
-    for (size_t i = 0; i < table->bucket_count; i++) {
-      linked_list_free(&table->buckets[i]);
-    }
-    free(table->buckets);
-    table->buckets = NULL;
-  }
+  free(table->control);
+  free(table->slots);
   free(table);
 }
 
 bool hash_table_insert(hash_table_t* table, uint64_t key, uint64_t value) {
-  if (!table || table->bucket_count == 0) {
+  if (!table || table->capacity == 0) {
     return false;
   }
 
-  size_t bucket_index = fnv1a_hash(key) & (table->bucket_count - 1);
-  return linked_list_insert(&table->buckets[bucket_index], key, value);
-}
+  size_t index = 0;
+  if (find_slot(table, key, &index)) {
+    table->slots[index].value = value;
+    return true;
+  }
 
-bool hash_table_delete(hash_table_t* table, uint64_t key) {
-  if (!table || table->bucket_count == 0) {
-    return false;
+  if ((table->count + 1) * HASH_TABLE_MAX_LOAD_DENOMINATOR > table->capacity * HASH_TABLE_MAX_LOAD_NUMERATOR) {
+    if (!grow(table)) {
+      return false;
+    }
+    find_slot(table, key, &index);
   }
 
-  size_t bucket_index = fnv1a_hash(key) & (table->bucket_count - 1);
-  return linked_list_delete(&table->buckets[bucket_index], key);
+  set_control(table, index, hash_key(key) & HASH_TABLE_TAG_MASK);
+  table->slots[index].key = key;
+  table->slots[index].value = value;
+  table->count++;
+  return true;
 }
 
-bool hash_table_get(hash_table_t* table, uint64_t key, uint64_t* value_out) {
-  if (!table || table->bucket_count == 0) {
+bool hash_table_delete(hash_table_t* table, uint64_t key) {
+  if (!table || table->capacity == 0) {
     return false;
   }
 
-  size_t bucket_index = fnv1a_hash(key) & (table->bucket_count - 1);
-  return linked_list_get(&table->buckets[bucket_index], key, value_out);
-}
-
-#pragma region Linked List Helper Functions
-static bool linked_list_insert(hash_node_t** head, uint64_t key, uint64_t value) {
-  if (!head) {
+  size_t hole = 0;
+  if (!find_slot(table, key, &hole)) {
     return false;
   }
 
-  hash_node_t* current = *head;
-  hash_node_t* previous = NULL;
-
-  while (current && current->key < key) {
-    previous = current;
-    current = current->next;
+  // Backward-shift deletion: move later entries of the run into the hole when that keeps them
+  // reachable from their home slot, so probes can still stop at the first empty slot
+  size_t mask = table->capacity - 1;
+  for (size_t next = (hole + 1) & mask; table->control[next] != HASH_TABLE_EMPTY; next = (next + 1) & mask) {
+    size_t home = (hash_key(table->slots[next].key) >> 7) & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      table->slots[hole] = table->slots[next];
+      set_control(table, hole, table->control[next]);
+      hole = next;
+    }
   }
 
-  if (current && current->key == key) {
-    current->value = value;
-    return true;
-  }
+  set_control(table, hole, HASH_TABLE_EMPTY);
+  table->count--;
+  return true;
+}
 
-  hash_node_t* new_node = malloc(sizeof(hash_node_t));
-  if (!new_node) {
+bool hash_table_get(hash_table_t* table, uint64_t key, uint64_t* value_out) {
+  if (!table || table->capacity == 0) {
     return false;
   }
-  new_node->key = key;
-  new_node->value = value;
-  new_node->next = current;
 
-  if (previous == NULL) {
-    *head = new_node;
-  } else {
-    previous->next = new_node;
+  size_t index = 0;
+  if (!find_slot(table, key, &index)) {
+    return false;
+  }
+  if (value_out) {
+    *value_out = table->slots[index].value;
   }
   return true;
 }
 
-static bool linked_list_delete(hash_node_t** head, uint64_t key) {
-  if (!head) {
-    return false;
-  }
+#pragma region Open Addressing Helper Functions
+static uint64_t hash_key(uint64_t key) {
+  // Murmur3 finalizer, every input bit affects the tag and the home slot
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+static bool find_slot(const hash_table_t* table, uint64_t key, size_t* index_out) {
+  uint64_t hash = hash_key(key);
+  uint8_t tag = hash & HASH_TABLE_TAG_MASK;
+  size_t mask = table->capacity - 1;
+  size_t position = (hash >> 7) & mask;
+
+  // The load limit guarantees an empty slot, so the loop ends
+  while (true) {
+    const uint8_t* group = &table->control[position];
+    uint32_t matches = simd_match_u8x16(group, tag);
+    uint32_t empties = simd_match_u8x16(group, HASH_TABLE_EMPTY);
+    if (empties) {
+      matches &= (empties & -empties) - 1;  // Only slots before the first empty one are in the run
+    }
 
-  hash_node_t* current = *head;
-  hash_node_t* previous = NULL;
+    while (matches) {
+      size_t index = (position + __builtin_ctz(matches)) & mask;
+      if (table->slots[index].key == key) {
+        *index_out = index;
+        return true;
+      }
+      matches &= matches - 1;
+    }
 
-  while (current && current->key < key) {
-    previous = current;
-    current = current->next;
+    if (empties) {
+      *index_out = (position + __builtin_ctz(empties)) & mask;
+      return false;
+    }
+    position = (position + HASH_TABLE_GROUP_SIZE) & mask;
   }
+}
 
-  if (!current || current->key != key) {
-    return false;  // Key not found
+static void set_control(hash_table_t* table, size_t index, uint8_t control) {
+  table->control[index] = control;
+  if (index < HASH_TABLE_GROUP_SIZE) {
+    table->control[table->capacity + index] = control;
   }
+}
 
-  if (previous == NULL) {
-    *head = current->next;  // Deleting head
-  } else {
-    previous->next = current->next;  // Bypass the current node
+static bool allocate_slots(hash_table_t* table, size_t capacity) {
+  uint8_t* control = malloc(capacity + HASH_TABLE_GROUP_SIZE);
+  hash_slot_t* slots = malloc(capacity * sizeof(hash_slot_t));
+  if (!control || !slots) {
+    free(control);
+    free(slots);
+    return false;
   }
 
-  free(current);
+  memset(control, HASH_TABLE_EMPTY, capacity + HASH_TABLE_GROUP_SIZE);
+  table->control = control;
+  table->slots = slots;
+  table->capacity = capacity;
+  table->count = 0;
   return true;
 }
 
-static bool linked_list_get(hash_node_t** head, uint64_t key, uint64_t* value_out) {
-  if (!head) {
+static bool grow(hash_table_t* table) {
+  hash_table_t old = *table;
+  if (!allocate_slots(table, old.capacity << 1)) {
+    *table = old;
     return false;
   }
 
-  hash_node_t* current = *head;
-  while (current && current->key < key) {
-    current = current->next;
-  }
-  if (current && current->key == key) {
-    if (value_out) {
-      *value_out = current->value;
+  for (size_t i = 0; i < old.capacity; i++) {
+    if (old.control[i] == HASH_TABLE_EMPTY) {
+      continue;
     }
-    return true;
-  }
-  return false;
-}
-
-static void linked_list_free(hash_node_t** head) {
-  if (!head) {
-    return;
+    size_t index = 0;
+    find_slot(table, old.slots[i].key, &index);
+    set_control(table, index, old.control[i]);
+    table->slots[index] = old.slots[i];
+    table->count++;
   }
 
-  hash_node_t* current = *head;
-  while (current) {
-    hash_node_t* to_free = current;
-    current = current->next;
-    free(to_free);
-  }
-  *head = NULL;
+  free(old.control);
+  free(old.slots);
+  return true;
 }
 
 #pragma endregion
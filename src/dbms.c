@@ -1,6 +1,14 @@
 #include "dbms.h"
+#include "btree.h"
+#include "compression.h"
+#include "dictionary.h"
 #include "index.h"
+#include "slotted.h"
+#include "stats.h"
+#include "vacuum.h"
+#include "zone_map.h"
 
+#include <dirent.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,9 +16,80 @@
 #include "align.h"
 #include "ssdio.h"
 
+#define PAX_MINIPAGE_ALIGNMENT 8
+#define PAX_ALIGN_UP(n) (((n) + (PAX_MINIPAGE_ALIGNMENT - 1)) & ~((size_t)PAX_MINIPAGE_ALIGNMENT - 1))
+
+/**
+ * @brief Decodes every tuple of a raw buffer page into its tuple_t array
+ *
+ * @param session Pointer to the DBMS session
+ * @param buffer_page Pointer to the buffer page to decode
+ */
+static void decode_buffer_page(dbms_session_t* session, buffer_page_t* buffer_page);
+static buffer_page_t* load_buffer_page(dbms_session_t* session, int fd, uint16_t file_id, uint64_t page_id,
+                                       bool is_new);
+
 // Replace tuple data in buffer and in physical page
 static tuple_t* replace_tuple_data(dbms_session_t* session, tuple_t* tuple, buffer_page_t* buffer_page,
-                                   attribute_value_t* attributes);
+                                   attribute_value_t* attributes, const uint32_t* codes);
+/**
+ * @brief Resolves the codes of the values of the dictionary encoded attributes, adding new values
+ *
+ * @param session Pointer to the DBMS session
+ * @param attributes The attribute values of a tuple
+ * @param codes Filled with the code of each encoded attribute's value
+ * @return true on success, false if a value cannot be encoded
+ */
+static bool encode_attributes(dbms_session_t* session, const attribute_value_t* attributes, uint32_t* codes);
+/**
+ * @brief Resolves where every used attribute is stored in a page (see dbms_get_column_offset)
+ *
+ * @param catalog Pointer to the system catalog
+ * @param offsets Filled with the slot 0 offset of each attribute
+ * @param strides Filled with the stride of each attribute
+ */
+static void get_columns(const system_catalog_t* catalog, off_t* offsets, size_t* strides);
+/**
+ * @brief Sets a tuple from the record in a slot of a slotted page
+ *
+ * @param session Pointer to the DBMS session
+ * @param format The record format
+ * @param page Pointer to the page
+ * @param slot_id The slot
+ * @param tuple The tuple to set, null if the slot is free
+ * @return true on success, false if the record's overflow chain cannot be read
+ */
+static bool decode_slotted_tuple(const dbms_session_t* session, const slotted_format_t* format, const page_t* page,
+                                 uint64_t slot_id, tuple_t* tuple);
+/**
+ * @brief Writes a tuple as the record of a slot of a slotted page, its strings going to the overflow file
+ * when the record is too long or the page has no room for it
+ *
+ * @param session Pointer to the DBMS session
+ * @param page Pointer to the page
+ * @param slot_id The slot, free or holding the record to replace
+ * @param attributes The attribute values
+ * @param codes The codes of the dictionary encoded attributes
+ * @return true on success, false on failure
+ */
+static bool write_slotted_record(dbms_session_t* session, page_t* page, uint64_t slot_id,
+                                 const attribute_value_t* attributes, const uint32_t* codes);
+static size_t slotted_record_size(const dbms_session_t* session, const attribute_value_t* attributes);
+static bool has_free_space(const dbms_session_t* session, const page_t* page, size_t record_size);
+static buffer_page_t* find_page_with_space(dbms_session_t* session, size_t record_size);
+static size_t occupancy_bitmap_size(uint64_t tuples_per_page);
+static size_t pax_data_size(const system_catalog_t* catalog, uint64_t tuples_per_page);
+static size_t bitmap_row_size(const system_catalog_t* catalog);
+static uint64_t next_free_slot(const page_t* page, uint64_t tuples_per_page, uint64_t slot_id, uint64_t full);
+static void set_slot_bit(page_t* page, uint64_t slot_id, bool is_live);
+static char** find_composite_index_names(const char* table_filename, size_t* out_count);
+static void open_composite_indexes(dbms_session_t* session);
+static void update_hash_indexes(dbms_session_t* session, const tuple_t* tuple, bool is_insert);
+static tuple_t* insert_into_page(dbms_session_t* session, buffer_page_t* target_page, attribute_value_t* attributes,
+                                 const uint32_t* codes);
+static tuple_t* alloc_tuples(const system_catalog_t* catalog, uint64_t count);
+static void free_tuples(const system_catalog_t* catalog, tuple_t* tuples, uint64_t count);
+static bool is_writable(const dbms_session_t* session);
 
 bool dbms_create_table(const char* filename, const system_catalog_t* catalog) {
   if (!filename || !catalog) {
@@ -33,13 +112,13 @@ bool dbms_create_table(const char* filename, const system_catalog_t* catalog) {
   // Initialize first page
   // On linux, this has to be aligned to 4096 bytes
   // We just use the page size since it's a multiple of 4096
-  page_t* first_page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  page_t* first_page = aligned_alloc(PAGE_SIZE, dbms_frame_size(catalog));
   if (!first_page) {
     fprintf(stderr, "Memory allocation failed for first page\n");
     ssdio_close(fd);
     return false;
   }
-  memset(first_page, 0, sizeof(page_t));
+  memset(first_page, 0, dbms_frame_size(catalog));
   if (!dbms_init_page(catalog, first_page, 1)) {
     fprintf(stderr, "Failed to initialize first page\n");
     free(first_page);
@@ -47,7 +126,12 @@ bool dbms_create_table(const char* filename, const system_catalog_t* catalog) {
     return false;
   }
 
-  if (!ssdio_write_page(fd, 1, first_page)) {
+  // A compressed table's first page goes to an extent recorded in a new map
+  uint32_t page_size = dbms_page_size(catalog);
+  bool is_written = catalog->compression == CATALOG_COMPRESSION_NONE
+                        ? ssdio_write_table_page(fd, 1, page_size, first_page)
+                        : compression_map_create(filename, fd, first_page, page_size);
+  if (!is_written) {
     fprintf(stderr, "Failed to write first page to database file\n");
     free(first_page);
     ssdio_close(fd);
@@ -58,9 +142,206 @@ bool dbms_create_table(const char* filename, const system_catalog_t* catalog) {
 
   free(first_page);
   ssdio_close(fd);
+
+  // Index files of a table previously stored under this name no longer match it
+  for (uint8_t i = 0; i < catalog->record_count; i++) {
+    const catalog_record_t* record = &catalog->records[i];
+    if (record->attribute_type == ATTRIBUTE_TYPE_UNUSED) {
+      continue;
+    }
+    const char* extensions[] = {INDEX_FILE_EXTENSION, BTREE_FILE_EXTENSION};
+    for (size_t j = 0; j < sizeof(extensions) / sizeof(extensions[0]); j++) {
+      char* index_filename = dbms_get_index_filename(filename, record->attribute_name, extensions[j]);
+      if (index_filename) {
+        remove(index_filename);
+        free(index_filename);
+      }
+    }
+  }
+
+  size_t name_count = 0;
+  char** names = find_composite_index_names(filename, &name_count);
+  for (size_t i = 0; i < name_count; i++) {
+    size_t length = strlen(filename) + 1 + strlen(names[i]) + strlen(INDEX_FILE_EXTENSION) + 1;
+    char* index_filename = malloc(length);
+    if (index_filename) {
+      snprintf(index_filename, length, "%s.%s%s", filename, names[i], INDEX_FILE_EXTENSION);
+      remove(index_filename);
+      free(index_filename);
+    }
+    free(names[i]);
+  }
+  free(names);
+
+  // The compression map of a compressed table was just written
+  const char* extensions[] = {ZONE_MAP_FILE_EXTENSION, STATS_FILE_EXTENSION, COMPRESSION_MAP_FILE_EXTENSION};
+  size_t extension_count = catalog->compression == CATALOG_COMPRESSION_NONE ? 3 : 2;
+  for (size_t i = 0; i < extension_count; i++) {
+    size_t length = strlen(filename) + strlen(extensions[i]) + 1;
+    char* side_filename = malloc(length);
+    if (side_filename) {
+      snprintf(side_filename, length, "%s%s", filename, extensions[i]);
+      remove(side_filename);
+      free(side_filename);
+    }
+  }
+  return slotted_overflow_create(filename, catalog) && dictionary_create(filename, catalog);
+}
+
+char* dbms_get_index_filename(const char* table_filename, const char* attribute_name, const char* extension) {
+  if (!table_filename || !attribute_name || !extension) {
+    return NULL;
+  }
+
+  size_t length = strlen(table_filename) + 1 + strnlen(attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE) + strlen(extension) + 1;
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for index filename\n");
+    return NULL;
+  }
+  snprintf(filename, length, "%s.%.*s%s", table_filename, (int)CATALOG_ATTRIBUTE_NAME_SIZE, attribute_name, extension);
+  return filename;
+}
+
+char* dbms_get_composite_index_filename(const char* table_filename, const system_catalog_t* catalog,
+                                        const uint8_t* attribute_indexes, uint8_t attribute_count,
+                                        const char* extension) {
+  if (!table_filename || !catalog || !attribute_indexes || attribute_count == 0 || !extension) {
+    return NULL;
+  }
+
+  size_t length = strlen(table_filename) + 1 + strlen(extension) + 1;
+  for (uint8_t i = 0; i < attribute_count; i++) {
+    const catalog_record_t* record = dbms_get_catalog_record(catalog, attribute_indexes[i]);
+    if (!record) {
+      return NULL;
+    }
+    length += strnlen(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE) + 1;
+  }
+
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for index filename\n");
+    return NULL;
+  }
+  size_t offset = (size_t)snprintf(filename, length, "%s.", table_filename);
+  for (uint8_t i = 0; i < attribute_count; i++) {
+    const char* attribute_name = dbms_get_catalog_record(catalog, attribute_indexes[i])->attribute_name;
+    size_t name_length = strnlen(attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE);
+    if (i > 0) {
+      filename[offset++] = DBMS_INDEX_NAME_SEPARATOR;
+    }
+    memcpy(filename + offset, attribute_name, name_length);
+    offset += name_length;
+  }
+  snprintf(filename + offset, length - offset, "%s", extension);
+  return filename;
+}
+
+bool dbms_add_composite_index(dbms_session_t* session, index_t* index) {
+  if (!session || !index) {
+    return false;
+  }
+
+  index_t** new_indexes = realloc(session->composite_indexes, (session->composite_index_count + 1) * sizeof(index_t*));
+  if (!new_indexes) {
+    fprintf(stderr, "Memory allocation failed for session composite indexes\n");
+    return false;
+  }
+  session->composite_indexes = new_indexes;
+  session->composite_indexes[session->composite_index_count++] = index;
   return true;
 }
 
+index_t* dbms_find_composite_index(const dbms_session_t* session, const uint8_t* attribute_indexes,
+                                   uint8_t attribute_count) {
+  if (!session || !attribute_indexes) {
+    return NULL;
+  }
+
+  for (size_t i = 0; i < session->composite_index_count; i++) {
+    index_t* index = session->composite_indexes[i];
+    if (index->attribute_count == attribute_count &&
+        memcmp(index->attribute_indexes, attribute_indexes, attribute_count) == 0) {
+      return index;
+    }
+  }
+  return NULL;
+}
+
+// Attribute lists ("<name>+<name>...") of the composite hash index files next to a table
+static char** find_composite_index_names(const char* table_filename, size_t* out_count) {
+  *out_count = 0;
+  const char* last_slash = strrchr(table_filename, '/');
+  const char* base_name = last_slash ? last_slash + 1 : table_filename;
+  char* directory_name = last_slash ? strndup(table_filename, (size_t)(last_slash - table_filename) + 1) : strdup(".");
+  if (!directory_name) {
+    return NULL;
+  }
+  DIR* directory = opendir(directory_name);
+  free(directory_name);
+  if (!directory) {
+    return NULL;
+  }
+
+  size_t base_length = strlen(base_name);
+  size_t extension_length = strlen(INDEX_FILE_EXTENSION);
+  char** names = NULL;
+  struct dirent* entry;
+  while ((entry = readdir(directory)) != NULL) {
+    const char* name = entry->d_name;
+    size_t length = strlen(name);
+    if (length <= base_length + 1 + extension_length || strncmp(name, base_name, base_length) != 0 ||
+        name[base_length] != '.' || strcmp(name + length - extension_length, INDEX_FILE_EXTENSION) != 0) {
+      continue;
+    }
+    const char* attribute_names = name + base_length + 1;
+    size_t attribute_names_length = length - base_length - 1 - extension_length;
+    if (!memchr(attribute_names, DBMS_INDEX_NAME_SEPARATOR, attribute_names_length)) {
+      continue;
+    }
+
+    char** new_names = realloc(names, (*out_count + 1) * sizeof(char*));
+    if (!new_names) {
+      break;
+    }
+    names = new_names;
+    names[*out_count] = strndup(attribute_names, attribute_names_length);
+    if (names[*out_count]) {
+      (*out_count)++;
+    }
+  }
+  closedir(directory);
+  return names;
+}
+
+static void open_composite_indexes(dbms_session_t* session) {
+  size_t name_count = 0;
+  char** names = find_composite_index_names(session->filename, &name_count);
+  const char separator[] = {DBMS_INDEX_NAME_SEPARATOR, '\0'};
+  for (size_t i = 0; i < name_count; i++) {
+    uint8_t attribute_indexes[INDEX_MAX_ATTRIBUTES];
+    uint8_t attribute_count = 0;
+    bool is_valid = true;
+    char* save_ptr = NULL;
+    for (char* name = strtok_r(names[i], separator, &save_ptr); name && is_valid;
+         name = strtok_r(NULL, separator, &save_ptr)) {
+      catalog_record_t* record = dbms_get_catalog_record_by_name(session->catalog, name);
+      is_valid = record && attribute_count < INDEX_MAX_ATTRIBUTES;
+      if (is_valid) {
+        attribute_indexes[attribute_count++] = record->attribute_order;
+      }
+    }
+
+    index_t* index = is_valid ? index_open_composite(session, attribute_indexes, attribute_count) : NULL;
+    if (index && !dbms_add_composite_index(session, index)) {
+      index_free(index);
+    }
+    free(names[i]);
+  }
+  free(names);
+}
+
 dbms_manager_t* dbms_init_dbms_manager(void) {
   dbms_manager_t* manager = calloc(1, sizeof(dbms_manager_t));
   if (!manager) {
@@ -139,10 +420,16 @@ bool dbms_remove_session(dbms_manager_t* manager, dbms_session_t* session) {
   return true;
 }
 
-dbms_session_t* dbms_init_dbms_session(const char* filename) {
+dbms_session_t* dbms_init_dbms_session(const char* filename) { return dbms_open_dbms_session(filename, 0); }
+
+dbms_session_t* dbms_open_dbms_session(const char* filename, uint8_t flags) {
   if (!filename) {
     return NULL;
   }
+  if ((flags & DBMS_OPEN_MMAP) && !(flags & DBMS_OPEN_READONLY)) {
+    fprintf(stderr, "Only read-only sessions can map the table file\n");
+    return NULL;
+  }
 
   dbms_session_t* session = calloc(1, sizeof(dbms_session_t));
   if (!session) {
@@ -152,6 +439,7 @@ dbms_session_t* dbms_init_dbms_session(const char* filename) {
 
   session->fd = -1;
   session->update_ctr = 0;
+  session->is_readonly = (flags & DBMS_OPEN_READONLY) != 0;
   session->filename = strdup(filename);
   if (!session->filename) {
     fprintf(stderr, "Memory allocation failed for filename\n");
@@ -185,12 +473,11 @@ dbms_session_t* dbms_init_dbms_session(const char* filename) {
   }
 
   off_t file_size = ssdio_get_file_size(session->fd);
-  if (file_size < PAGE_SIZE || file_size % PAGE_SIZE != 0) {
-    fprintf(stderr, "Invalid database file size: %lld bytes\n", file_size);
+  if (file_size < PAGE_SIZE) {
+    fprintf(stderr, "Invalid database file size: %lld bytes\n", (long long)file_size);
     dbms_free_dbms_session(session);
     return NULL;
   }
-  session->page_count = (uint32_t)(file_size / PAGE_SIZE) - 1;  // Exclude catalog page
 
   session->catalog = calloc(1, sizeof(system_catalog_t));
 
@@ -206,6 +493,56 @@ dbms_session_t* dbms_init_dbms_session(const char* filename) {
     return NULL;
   }
 
+  // Compressed pages have variable sizes, only the map knows where they are
+  if (session->catalog->compression != CATALOG_COMPRESSION_NONE) {
+    session->compression_map = compression_map_open(filename, dbms_page_size(session->catalog));
+    if (!session->compression_map) {
+      fprintf(stderr, "Failed to open the compression map of %s\n", filename);
+      dbms_free_dbms_session(session);
+      return NULL;
+    }
+    session->page_count = (uint32_t)session->compression_map->page_count;
+  } else if ((file_size - PAGE_SIZE) % dbms_page_size(session->catalog) != 0) {
+    fprintf(stderr, "Invalid database file size: %lld bytes\n", (long long)file_size);
+    dbms_free_dbms_session(session);
+    return NULL;
+  } else {
+    // Exclude catalog page
+    session->page_count = (uint32_t)((file_size - PAGE_SIZE) / dbms_page_size(session->catalog));
+  }
+
+  // Pages are read in place, so they have to be stored as is
+  if (flags & DBMS_OPEN_MMAP) {
+    if (session->compression_map) {
+      fprintf(stderr, "Compressed tables cannot be mapped, their pages have to be decompressed\n");
+      dbms_free_dbms_session(session);
+      return NULL;
+    }
+    session->mapping = ssdio_map(session->fd, (size_t)file_size);
+    if (!session->mapping) {
+      fprintf(stderr, "Failed to map database file: %s\n", filename);
+      dbms_free_dbms_session(session);
+      return NULL;
+    }
+    session->mapping_size = (size_t)file_size;
+  }
+
+  // Pages of encoded attributes only hold codes, they cannot be read without the dictionary
+  session->dictionary = dictionary_open(session);
+  for (uint8_t i = 0; i < session->catalog->record_count && !session->dictionary; i++) {
+    if (dbms_is_dictionary_encoded(session->catalog, i)) {
+      fprintf(stderr, "Failed to open the dictionary of %s\n", filename);
+      dbms_free_dbms_session(session);
+      return NULL;
+    }
+  }
+  session->overflow = slotted_overflow_open(session);
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED && !session->overflow) {
+    fprintf(stderr, "Failed to open the overflow file of %s\n", filename);
+    dbms_free_dbms_session(session);
+    return NULL;
+  }
+
   session->buffer_pool = calloc(1, sizeof(buffer_pool_t));
   if (!session->buffer_pool) {
     fprintf(stderr, "Memory allocation failed for buffer pool\n");
@@ -222,69 +559,40 @@ dbms_session_t* dbms_init_dbms_session(const char* filename) {
     return NULL;
   }
 
-  // Need to align pages for O_DIRECT
-  page_t* pages = aligned_alloc(PAGE_SIZE, BUFFER_POOL_SIZE * sizeof(page_t));
+  // Need to align pages for O_DIRECT, frames hold a table page or a PAGE_SIZE index page
+  size_t page_frame_size = dbms_frame_size(session->catalog);
+  session->buffer_pool->frames_size = BUFFER_POOL_SIZE * page_frame_size;
+  char* pages =
+      ssdio_alloc_frames(session->buffer_pool->frames_size, true, &session->buffer_pool->frame_backing);
   if (!pages) {
     fprintf(stderr, "Memory allocation failed for buffer pool pages\n");
     dbms_free_dbms_session(session);
     return NULL;
   }
-  memset(pages, 0, BUFFER_POOL_SIZE * sizeof(page_t));
+  session->buffer_pool->frames = pages;
   for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
     session->buffer_pool->buffer_pages[i].is_free = true;
     session->buffer_pool->buffer_pages[i].is_dirty = false;
+    session->buffer_pool->buffer_pages[i].is_decoded = false;
     session->buffer_pool->buffer_pages[i].pin_count = 0;
     session->buffer_pool->buffer_pages[i].last_updated = 0;
+    session->buffer_pool->buffer_pages[i].file_id = DBMS_TABLE_FILE_ID;
+    session->buffer_pool->buffer_pages[i].fd = -1;
     session->buffer_pool->buffer_pages[i].page_id = 0;
-    session->buffer_pool->buffer_pages[i].page = &pages[i];
+    session->buffer_pool->buffer_pages[i].page = (page_t*)(pages + i * page_frame_size);
   }
 
   // Allocate tuples for each buffer page
   uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
-  tuple_t* all_tuples = calloc(BUFFER_POOL_SIZE * tuples_per_page, sizeof(tuple_t));
+  tuple_t* all_tuples = alloc_tuples(session->catalog, BUFFER_POOL_SIZE * tuples_per_page);
   if (!all_tuples) {
-    fprintf(stderr, "Memory allocation failed for tuples\n");
-    dbms_free_dbms_session(session);
-    return NULL;
-  }
-
-  // Allocate attribute values for each tuple
-  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
-  attribute_value_t* all_attribute_values =
-      calloc(BUFFER_POOL_SIZE * tuples_per_page * num_attributes, sizeof(attribute_value_t));
-  if (!all_attribute_values) {
-    fprintf(stderr, "Memory allocation failed for attribute values\n");
     dbms_free_dbms_session(session);
     return NULL;
   }
-
   for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
     session->buffer_pool->buffer_pages[i].tuples = &all_tuples[i * tuples_per_page];
-    for (uint64_t j = 0; j < tuples_per_page; j++) {
-      tuple_t* tuple = &session->buffer_pool->buffer_pages[i].tuples[j];
-      tuple->id.page_id = 0;
-      tuple->id.slot_id = 0;
-      tuple->is_null = true;
-      tuple->attributes = &all_attribute_values[(i * tuples_per_page + j) * num_attributes];
-
-      // For each attribute, correctly set type based on catalog
-      for (uint8_t k = 0; k < num_attributes; k++) {
-        catalog_record_t* record = dbms_get_catalog_record(session->catalog, k);
-        if (record) {
-          tuple->attributes[k].type = record->attribute_type;
-          if (record->attribute_type == ATTRIBUTE_TYPE_STRING) {
-            // Tuples allocate their own string storage to guarantee null-termination
-            tuple->attributes[k].string_value = calloc(record->attribute_size + 1, sizeof(char));
-            if (!tuple->attributes[k].string_value) {
-              fprintf(stderr, "Memory allocation failed for tuple string attribute value\n");
-              dbms_free_dbms_session(session);
-              return NULL;
-            }
-          }
-        }
-      }
-    }
   }
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
 
   // Index initialization
   session->indexes = calloc(session->catalog->record_count, sizeof(index_t*));
@@ -294,6 +602,25 @@ dbms_session_t* dbms_init_dbms_session(const char* filename) {
     return NULL;
   }
 
+  session->btrees = calloc(session->catalog->record_count, sizeof(btree_t*));
+  if (!session->btrees) {
+    fprintf(stderr, "Memory allocation failed for session B+tree indexes\n");
+    dbms_free_dbms_session(session);
+    return NULL;
+  }
+
+  // Indexes persist next to the table: hash indexes are loaded from their files without scanning
+  // the table, B+trees only read their meta pages
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    session->indexes[i] = index_open(session, i);
+    session->btrees[i] = btree_open(session, i);
+  }
+  // Composite hash indexes are found by their file names
+  open_composite_indexes(session);
+  // Rebuilt from the table if the file is missing or was not synced after the last change
+  session->zone_map = zone_map_open(session);
+  session->stats = stats_open(session);
+
   return session;
 }
 
@@ -302,6 +629,15 @@ void dbms_free_dbms_session(dbms_session_t* session) {
     if (session->fd != -1) {
       ssdio_close(session->fd);
     }
+
+    // Index pages share the buffer pool, write them back before it goes away
+    if (session->btrees) {
+      for (uint8_t i = 0; i < session->catalog->record_count; i++) {
+        btree_close(session, session->btrees[i]);
+      }
+      free(session->btrees);
+    }
+
     if (session->buffer_pool) {
       dbms_free_buffer_pool(session->catalog, session->buffer_pool);
     }
@@ -315,6 +651,17 @@ void dbms_free_dbms_session(dbms_session_t* session) {
       }
       free(session->indexes);
     }
+    for (size_t i = 0; i < session->composite_index_count; i++) {
+      index_free(session->composite_indexes[i]);
+    }
+    free(session->composite_indexes);
+    zone_map_free(session->zone_map);
+    dictionary_free(session->dictionary);
+    compression_map_free(session->compression_map);
+    slotted_overflow_free(session->overflow);
+    vacuum_free(session->vacuum);
+    stats_free(session->stats);
+    ssdio_unmap(session->mapping, session->mapping_size);
 
     if (session->catalog) {
       dbms_free_system_catalog(session->catalog);
@@ -335,32 +682,11 @@ void dbms_free_buffer_pool(const system_catalog_t* catalog, buffer_pool_t* pool)
   }
 
   hash_table_free(pool->page_table);
-  // Free each page in the buffer pages
-  // They are allocated all together, so just free first one
-  if (pool->buffer_pages[0].page) {
-    free(pool->buffer_pages[0].page);
-  }
+  // The frames are allocated all together, a frame's page may point into a mapping instead
+  ssdio_free_frames(pool->frames, pool->frames_size, pool->frame_backing);
 
   // Same for tuples/attribute values
-  if (pool->buffer_pages[0].tuples) {
-    if (pool->buffer_pages[0].tuples->attributes) {
-      // Also need to free each tuple's attribute string values
-      uint64_t tuples_per_page = dbms_catalog_tuples_per_page(catalog);
-      uint8_t num_attributes = dbms_catalog_num_used(catalog);
-      for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
-        for (uint64_t j = 0; j < tuples_per_page; j++) {
-          tuple_t* tuple = &pool->buffer_pages[i].tuples[j];
-          for (uint8_t k = 0; k < num_attributes; k++) {
-            if (tuple->attributes[k].type == ATTRIBUTE_TYPE_STRING && tuple->attributes[k].string_value) {
-              free(tuple->attributes[k].string_value);
-            }
-          }
-        }
-      }
-      free(pool->buffer_pages[0].tuples->attributes);
-    }
-    free(pool->buffer_pages[0].tuples);
-  }
+  free_tuples(catalog, pool->buffer_pages[0].tuples, BUFFER_POOL_SIZE * dbms_catalog_tuples_per_page(catalog));
   free(pool);
 }
 
@@ -380,6 +706,14 @@ void dbms_free_catalog_records(system_catalog_t catalog) {
 }
 
 buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
+  buffer_page_t* buffer_page = dbms_get_raw_buffer_page(session, page_id);
+  if (buffer_page && !buffer_page->is_decoded) {
+    decode_buffer_page(session, buffer_page);
+  }
+  return buffer_page;
+}
+
+buffer_page_t* dbms_get_raw_buffer_page(dbms_session_t* session, uint64_t page_id) {
   if (!session || !session->buffer_pool) {
     return NULL;
   }
@@ -389,9 +723,64 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
     return NULL;
   }
 
+  return load_buffer_page(session, session->fd, DBMS_TABLE_FILE_ID, page_id, false);
+}
+
+const page_t* dbms_get_mapped_page(const dbms_session_t* session, uint64_t page_id) {
+  if (!session || !session->mapping || page_id == 0 || page_id > session->page_count) {
+    return NULL;
+  }
+  return (const page_t*)(session->mapping + PAGE_SIZE + (page_id - 1) * dbms_page_size(session->catalog));
+}
+
+buffer_page_t* dbms_alloc_page_view(const dbms_session_t* session) {
+  if (!session) {
+    return NULL;
+  }
+
+  buffer_page_t* view = calloc(1, sizeof(buffer_page_t));
+  if (!view) {
+    fprintf(stderr, "Memory allocation failed for page view\n");
+    return NULL;
+  }
+  view->tuples = alloc_tuples(session->catalog, dbms_catalog_tuples_per_page(session->catalog));
+  if (!view->tuples) {
+    free(view);
+    return NULL;
+  }
+  view->is_free = true;
+  view->fd = -1;
+  return view;
+}
+
+bool dbms_view_mapped_page(dbms_session_t* session, buffer_page_t* view, uint64_t page_id) {
+  const page_t* page = dbms_get_mapped_page(session, page_id);
+  if (!page || !view) {
+    return false;
+  }
+
+  // The view never owns page bytes, it is only decoded
+  view->page = (page_t*)page;
+  view->page_id = page_id;
+  view->is_free = false;
+  decode_buffer_page(session, view);
+  return true;
+}
+
+void dbms_free_page_view(const dbms_session_t* session, buffer_page_t* view) {
+  if (!session || !view) {
+    return;
+  }
+  free_tuples(session->catalog, view->tuples, dbms_catalog_tuples_per_page(session->catalog));
+  free(view);
+}
+
+static buffer_page_t* load_buffer_page(dbms_session_t* session, int fd, uint16_t file_id, uint64_t page_id,
+                                       bool is_new) {
   // Check if page is already in buffer pool
+  uint64_t key = DBMS_PAGE_TABLE_KEY(file_id, page_id);
   uint64_t buffer_page_index = 0;
-  if (hash_table_get(session->buffer_pool->page_table, page_id, &buffer_page_index)) {
+  if (hash_table_get(session->buffer_pool->page_table, key, &buffer_page_index)) {
     buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[buffer_page_index];
     buffer_page->last_updated = session->update_ctr++;
     return buffer_page;
@@ -405,35 +794,72 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
     return NULL;
   }
 
-  // Load the requested page from disk
-  if (!ssdio_read_page(session->fd, page_id, target_page->page)) {
+  // Mapped table pages are not copied, the frame points at them until it is reused
+  const page_t* mapped_page =
+      file_id == DBMS_TABLE_FILE_ID && !is_new ? dbms_get_mapped_page(session, page_id) : NULL;
+  target_page->page = mapped_page ? (page_t*)mapped_page
+                                  : (page_t*)(session->buffer_pool->frames +
+                                              target_index * dbms_frame_size(session->catalog));
+
+  // Load the requested page from disk (new pages only exist in memory until written back)
+  if (mapped_page) {
+    // Already in place
+  } else if (is_new) {
+    memset(target_page->page, 0, dbms_frame_size(session->catalog));
+  } else if (file_id == DBMS_TABLE_FILE_ID ? !dbms_read_table_page(session, page_id, target_page->page)
+                                           : !ssdio_read_page(fd, page_id, target_page->page)) {
     fprintf(stderr, "Failed to read page %llu from disk\n", page_id);
     return NULL;
   }
 
   // Insert into page table
-  if (!hash_table_insert(session->buffer_pool->page_table, page_id, target_index)) {
+  if (!hash_table_insert(session->buffer_pool->page_table, key, target_index)) {
     fprintf(stderr, "Failed to insert page %llu into buffer pool page table\n", page_id);
     return NULL;
   }
 
   target_page->is_free = false;
-  target_page->is_dirty = false;
+  target_page->is_dirty = is_new;
+  target_page->is_decoded = false;
+  target_page->file_id = file_id;
+  target_page->fd = fd;
   target_page->page_id = page_id;
   target_page->last_updated = session->update_ctr++;
   session->buffer_pool->page_count++;
 
-  // Set all the tuples and attribute values to match the new page
+  return target_page;
+}
+
+static void decode_buffer_page(dbms_session_t* session, buffer_page_t* buffer_page) {
+  // Set all the tuples and attribute values to match the page
   uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    slotted_format_t format;
+    slotted_get_format(session->catalog, &format);
+    for (uint64_t j = 0; j < tuples_per_page; j++) {
+      tuple_t* tuple = &buffer_page->tuples[j];
+      tuple->id.page_id = buffer_page->page_id;
+      tuple->id.slot_id = j;
+      if (!decode_slotted_tuple(session, &format, buffer_page->page, j, tuple)) {
+        fprintf(stderr, "Failed to decode tuple %llu:%llu\n", (unsigned long long)buffer_page->page_id,
+                (unsigned long long)j);
+        tuple->is_null = true;
+      }
+    }
+    buffer_page->is_decoded = true;
+    return;
+  }
+
   uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  off_t offsets[num_attributes];
+  size_t strides[num_attributes];
+  get_columns(session->catalog, offsets, strides);
+
   for (uint64_t j = 0; j < tuples_per_page; j++) {
-    tuple_t* tuple = &target_page->tuples[j];
-    tuple->id.page_id = page_id;
+    tuple_t* tuple = &buffer_page->tuples[j];
+    tuple->id.page_id = buffer_page->page_id;
     tuple->id.slot_id = j;
-
-    // Check if tuple is null based on null byte
-    char* tuple_data = target_page->page->data + (j * session->catalog->tuple_size);
-    tuple->is_null = (tuple_data[0] == 0);
+    tuple->is_null = !dbms_is_slot_live(session->catalog, buffer_page->page, j);
 
     for (uint8_t k = 0; k < num_attributes; k++) {
       catalog_record_t* record = dbms_get_catalog_record(session->catalog, k);
@@ -442,8 +868,7 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
 
         // Set values
         // Even if the tuple is null, we set the attribute values for easier access later
-        off_t offset = dbms_get_attribute_offset(session->catalog, k);
-        char* attribute_data = tuple_data + offset;
+        char* attribute_data = buffer_page->page->data + offsets[k] + j * strides[k];
         switch (record->attribute_type) {
           case ATTRIBUTE_TYPE_INT:
             tuple->attributes[k].int_value = (int32_t)load_u32(attribute_data);
@@ -452,6 +877,10 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
             tuple->attributes[k].float_value = load_f32(attribute_data);
             break;
           case ATTRIBUTE_TYPE_STRING:
+            if (dbms_is_dictionary_encoded(session->catalog, k)) {
+              tuple->attributes[k].dictionary_code = load_u16(attribute_data);
+              attribute_data = (char*)dictionary_decode(session->dictionary, k, tuple->attributes[k].dictionary_code);
+            }
             strncpy(tuple->attributes[k].string_value, attribute_data, record->attribute_size);
             tuple->attributes[k].string_value[record->attribute_size] = '\0';
             break;
@@ -465,7 +894,7 @@ buffer_page_t* dbms_get_buffer_page(dbms_session_t* session, uint64_t page_id) {
     }
   }
 
-  return target_page;
+  buffer_page->is_decoded = true;
 }
 
 // Comparator for sorting buffer pages by last_updated (LRU)
@@ -550,39 +979,122 @@ buffer_page_t* dbms_run_buffer_pool_policy(dbms_session_t* session, uint64_t* ta
   return victim;
 }
 
+bool dbms_read_table_page(const dbms_session_t* session, uint64_t page_id, page_t* page) {
+  if (!session || !page) {
+    return false;
+  }
+  if (session->compression_map) {
+    return compression_map_read_page(session->compression_map, session->fd, page_id, page);
+  }
+  const page_t* mapped_page = dbms_get_mapped_page(session, page_id);
+  if (mapped_page) {
+    memcpy(page, mapped_page, dbms_page_size(session->catalog));
+    return true;
+  }
+  return ssdio_read_table_page(session->fd, page_id, dbms_page_size(session->catalog), page);
+}
+
+bool dbms_write_table_page(dbms_session_t* session, uint64_t page_id, const page_t* page) {
+  if (!session || !page) {
+    return false;
+  }
+  if (session->compression_map) {
+    return compression_map_write_page(session->compression_map, session->fd, page_id, page);
+  }
+  return ssdio_write_table_page(session->fd, page_id, dbms_page_size(session->catalog), page);
+}
+
 void dbms_flush_buffer_page(dbms_session_t* session, buffer_page_t* buffer_page, bool run_flush) {
   if (!session || !buffer_page) {
     return;
   }
 
   if (buffer_page->is_dirty && !buffer_page->is_free) {
-    if (!ssdio_write_page(session->fd, buffer_page->page_id, buffer_page->page)) {
+    bool is_written = buffer_page->file_id == DBMS_TABLE_FILE_ID
+                          ? dbms_write_table_page(session, buffer_page->page_id, buffer_page->page)
+                          : ssdio_write_page(buffer_page->fd, buffer_page->page_id, buffer_page->page);
+    if (!is_written) {
       fprintf(stderr, "Failed to flush buffer page %llu to disk\n", buffer_page->page_id);
       return;
     }
 
     if (run_flush) {
-      ssdio_flush(session->fd);
+      ssdio_flush(buffer_page->fd);
     }
   }
 
   if (!buffer_page->is_free) {
     session->buffer_pool->page_count--;
-    hash_table_delete(session->buffer_pool->page_table, buffer_page->page_id);
+    hash_table_delete(session->buffer_pool->page_table,
+                      DBMS_PAGE_TABLE_KEY(buffer_page->file_id, buffer_page->page_id));
   }
 
   buffer_page->last_updated = 0;
   buffer_page->is_free = true;
+  buffer_page->file_id = DBMS_TABLE_FILE_ID;
+  buffer_page->fd = -1;
   buffer_page->page_id = 0;
   buffer_page->is_dirty = false;
+  buffer_page->is_decoded = false;
 }
 
 void dbms_flush_buffer_pool(dbms_session_t* session) {
+  // Hash indexes write their changed buckets directly, B+tree metadata goes through the pool
+  if (session->indexes) {
+    for (uint8_t i = 0; i < session->catalog->record_count; i++) {
+      if (session->indexes[i]) {
+        index_sync(session->indexes[i]);
+      }
+    }
+  }
+  for (size_t i = 0; i < session->composite_index_count; i++) {
+    index_sync(session->composite_indexes[i]);
+  }
+  if (session->btrees) {
+    for (uint8_t i = 0; i < session->catalog->record_count; i++) {
+      if (session->btrees[i]) {
+        btree_sync(session, session->btrees[i]);
+      }
+    }
+  }
+
+  // Values must be on disk before the pages holding their codes, long strings before the records pointing to them
+  dictionary_sync(session->dictionary);
+  slotted_overflow_sync(session->overflow);
   for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
     buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
     dbms_flush_buffer_page(session, buffer_page, false);
   }
   ssdio_flush(session->fd);
+  // Points to the new extents only once the pages in them are on disk
+  compression_map_sync(session->compression_map);
+  // No record on disk points to the chains released before this flush any more
+  slotted_overflow_reclaim(session->overflow);
+  // Only marked clean once the table pages it describes are on disk
+  zone_map_sync(session->zone_map);
+
+  if (session->btrees) {
+    for (uint8_t i = 0; i < session->catalog->record_count; i++) {
+      if (session->btrees[i]) {
+        ssdio_flush(session->btrees[i]->fd);
+      }
+    }
+  }
+}
+
+void dbms_flush_file_pages(dbms_session_t* session, uint16_t file_id) {
+  if (!session || !session->buffer_pool) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
+    if (!buffer_page->is_free && buffer_page->file_id == file_id) {
+      // The file is going away, outstanding pins cannot be honoured
+      buffer_page->pin_count = 0;
+      dbms_flush_buffer_page(session, buffer_page, false);
+    }
+  }
 }
 
 off_t dbms_get_attribute_offset(const system_catalog_t* catalog, uint8_t attribute_position) {
@@ -593,46 +1105,218 @@ off_t dbms_get_attribute_offset(const system_catalog_t* catalog, uint8_t attribu
   // The first byte is reserved as a NULL byte
   off_t offset = NULL_BYTE_SIZE;
   for (uint8_t i = 0; i < attribute_position; i++) {
-    offset += catalog->records[i].attribute_size;
+    offset += dbms_get_stored_size(catalog, i);
   }
   return offset;
 }
 
-catalog_record_t* dbms_get_catalog_record(const system_catalog_t* catalog, uint8_t attribute_position) {
+off_t dbms_get_column_offset(const system_catalog_t* catalog, uint8_t attribute_position) {
   if (!catalog || attribute_position >= catalog->record_count) {
-    return NULL;
+    return -1;
   }
-  return &catalog->records[attribute_position];
+  if (catalog->layout == CATALOG_LAYOUT_NSM) {
+    return dbms_get_attribute_offset(catalog, attribute_position);
+  }
+  if (catalog->layout == CATALOG_LAYOUT_BITMAP) {
+    // Tuples follow the occupancy bitmap, without their null byte
+    return occupancy_bitmap_size(dbms_catalog_tuples_per_page(catalog)) +
+           dbms_get_attribute_offset(catalog, attribute_position) - NULL_BYTE_SIZE;
+  }
+
+  // Minipages follow the presence bitmap in attribute order, each starting PAX_MINIPAGE_ALIGNMENT aligned.
+  // The unpacked columns of a slotted page are laid out the same way, without the bitmap.
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(catalog);
+  off_t offset = catalog->layout == CATALOG_LAYOUT_PAX ? occupancy_bitmap_size(tuples_per_page) : 0;
+  for (uint8_t i = 0; i < attribute_position; i++) {
+    if (catalog->records[i].attribute_type != ATTRIBUTE_TYPE_UNUSED) {
+      offset += PAX_ALIGN_UP(tuples_per_page * dbms_get_stored_size(catalog, i));
+    }
+  }
+  return offset;
 }
 
-catalog_record_t* dbms_get_catalog_record_by_name(const system_catalog_t* catalog, const char* attribute_name) {
-  if (!catalog || !attribute_name) {
-    return NULL;
+size_t dbms_get_column_stride(const system_catalog_t* catalog, uint8_t attribute_position) {
+  if (!catalog || attribute_position >= catalog->record_count) {
+    return 0;
   }
-  for (uint8_t i = 0; i < catalog->record_count; i++) {
-    if (strncmp(catalog->records[i].attribute_name, attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE) == 0) {
-      return &catalog->records[i];
-    }
+  if (catalog->layout == CATALOG_LAYOUT_NSM) {
+    return catalog->tuple_size;
   }
-  return NULL;
+  return catalog->layout == CATALOG_LAYOUT_BITMAP ? bitmap_row_size(catalog)
+                                                  : dbms_get_stored_size(catalog, attribute_position);
 }
 
-bool dbms_init_page(const system_catalog_t* catalog, page_t* page, uint64_t page_id) {
-  if (!catalog || !page) {
+size_t dbms_get_unpacked_size(const system_catalog_t* catalog) {
+  if (!catalog || catalog->layout != CATALOG_LAYOUT_SLOTTED) {
+    return 0;
+  }
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(catalog);
+  return pax_data_size(catalog, tuples_per_page) - occupancy_bitmap_size(tuples_per_page);
+}
+
+bool dbms_unpack_page(const dbms_session_t* session, const page_t* page, const bool* attributes, char* columns) {
+  if (!session || !page || !attributes || !columns || session->catalog->layout != CATALOG_LAYOUT_SLOTTED) {
     return false;
   }
 
-  page->next_page = page_id + 1;
-  page->prev_page = page_id - 1;
+  slotted_format_t format;
+  slotted_get_format(session->catalog, &format);
+  off_t offsets[format.attribute_count + 1];
+  size_t strides[format.attribute_count + 1];
+  get_columns(session->catalog, offsets, strides);
+  // Records in the overflow file are only read if one of their strings is needed
+  bool needs_strings = false;
+  for (uint8_t i = 0; i < format.attribute_count; i++) {
+    needs_strings |= attributes[i] && format.is_variable[i];
+  }
 
-  page->free_space_head = 0;
-  page->tuples_per_page = dbms_catalog_tuples_per_page(catalog);
-  if (page->tuples_per_page == 0) {
-    fprintf(stderr, "Tuple size %u too large to fit in page\n", catalog->tuple_size);
+  char strings_buffer[format.max_record_size];
+  const char* values[format.attribute_count + 1];
+  uint8_t lengths[format.attribute_count + 1];
+  for (uint64_t slot = 0; slot < page->tuples_per_page; slot++) {
+    bool is_overflow = false;
+    const char* record = slotted_get_record(page, slot, &is_overflow);
+    if (!record) {
+      continue;
+    }
+    const char* strings = record + format.prefix_size;
+    if (is_overflow && needs_strings) {
+      if (!slotted_overflow_read(session->overflow, load_u64(strings), strings_buffer,
+                                 slotted_strings_size(&format, record))) {
+        return false;
+      }
+      strings = strings_buffer;
+    }
+    slotted_locate_values(&format, record, strings, values, lengths);
+    for (uint8_t i = 0; i < format.attribute_count; i++) {
+      if (attributes[i]) {
+        char* column = columns + offsets[i] + slot * strides[i];
+        memcpy(column, values[i], lengths[i]);
+        memset(column + lengths[i], 0, strides[i] - lengths[i]);
+      }
+    }
+  }
+  return true;
+}
+
+bool dbms_is_dictionary_encoded(const system_catalog_t* catalog, uint8_t attribute_position) {
+  if (!catalog || attribute_position >= catalog->record_count || attribute_position >= CATALOG_MAX_RECORDS) {
     return false;
   }
-  if (catalog->tuple_size % 8 != 0 || catalog->tuple_size < 16) {
-    fprintf(stderr, "Tuple size %u is invalid\n", catalog->tuple_size);
+  return (catalog->dictionary_attributes[attribute_position >> 3] >> (attribute_position & 7)) & 1;
+}
+
+bool dbms_set_dictionary_encoded(system_catalog_t* catalog, uint8_t attribute_position) {
+  if (!catalog || attribute_position >= catalog->record_count || attribute_position >= CATALOG_MAX_RECORDS ||
+      catalog->records[attribute_position].attribute_type != ATTRIBUTE_TYPE_STRING) {
+    fprintf(stderr, "Only STRING attributes can be dictionary encoded\n");
+    return false;
+  }
+  // Encoding twice would take the attribute's size off the tuple size twice
+  if (dbms_is_dictionary_encoded(catalog, attribute_position)) {
+    fprintf(stderr, "Attribute '%s' is already dictionary encoded\n",
+            catalog->records[attribute_position].attribute_name);
+    return false;
+  }
+  catalog->dictionary_attributes[attribute_position >> 3] |= (uint8_t)(1u << (attribute_position & 7));
+  return true;
+}
+
+size_t dbms_get_stored_size(const system_catalog_t* catalog, uint8_t attribute_position) {
+  if (!catalog || attribute_position >= catalog->record_count) {
+    return 0;
+  }
+  return dbms_is_dictionary_encoded(catalog, attribute_position) ? CATALOG_DICTIONARY_CODE_SIZE
+                                                                 : catalog->records[attribute_position].attribute_size;
+}
+
+bool dbms_is_slot_live(const system_catalog_t* catalog, const page_t* page, uint64_t slot_id) {
+  if (dbms_has_occupancy_bitmap(catalog)) {
+    const uint64_t* bitmap = (const uint64_t*)page->data;
+    return (bitmap[slot_id / DBMS_BITMAP_WORD_BITS] >> (slot_id % DBMS_BITMAP_WORD_BITS)) & 1;
+  }
+  if (catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    return slotted_is_live(page, slot_id);
+  }
+  // First byte of each tuple is the null byte
+  return page->data[slot_id * catalog->tuple_size] != 0;
+}
+
+uint64_t dbms_next_live_slot(const system_catalog_t* catalog, const page_t* page, uint64_t slot_id) {
+  if (!dbms_has_occupancy_bitmap(catalog)) {
+    // The slots after the directory entries of a slotted page are free
+    for (; slot_id < page->tuples_per_page; slot_id++) {
+      if (dbms_is_slot_live(catalog, page, slot_id)) {
+        return slot_id;
+      }
+    }
+    return dbms_catalog_tuples_per_page(catalog);
+  }
+
+  // Bits past the last slot are never set, an empty word is skipped in one compare
+  uint64_t tuples_per_page = page->tuples_per_page;
+  const uint64_t* bitmap = (const uint64_t*)page->data;
+  for (uint64_t word = slot_id / DBMS_BITMAP_WORD_BITS; word * DBMS_BITMAP_WORD_BITS < tuples_per_page; word++) {
+    uint64_t live = bitmap[word];
+    if (word == slot_id / DBMS_BITMAP_WORD_BITS) {
+      live &= ~0ULL << (slot_id % DBMS_BITMAP_WORD_BITS);
+    }
+    if (live != 0) {
+      return word * DBMS_BITMAP_WORD_BITS + (uint64_t)__builtin_ctzll(live);
+    }
+  }
+  return tuples_per_page;
+}
+
+bool dbms_has_occupancy_bitmap(const system_catalog_t* catalog) {
+  return catalog && (catalog->layout == CATALOG_LAYOUT_PAX || catalog->layout == CATALOG_LAYOUT_BITMAP);
+}
+
+catalog_record_t* dbms_get_catalog_record(const system_catalog_t* catalog, uint8_t attribute_position) {
+  if (!catalog || attribute_position >= catalog->record_count) {
+    return NULL;
+  }
+  return &catalog->records[attribute_position];
+}
+
+catalog_record_t* dbms_get_catalog_record_by_name(const system_catalog_t* catalog, const char* attribute_name) {
+  if (!catalog || !attribute_name) {
+    return NULL;
+  }
+  for (uint8_t i = 0; i < catalog->record_count; i++) {
+    if (strncmp(catalog->records[i].attribute_name, attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE) == 0) {
+      return &catalog->records[i];
+    }
+  }
+  return NULL;
+}
+
+bool dbms_init_page(const system_catalog_t* catalog, page_t* page, uint64_t page_id) {
+  if (!catalog || !page) {
+    return false;
+  }
+
+  page->next_page = page_id + 1;
+  page->prev_page = page_id - 1;
+
+  page->free_space_head = 0;
+  page->tuples_per_page = dbms_catalog_tuples_per_page(catalog);
+  if (page->tuples_per_page == 0) {
+    fprintf(stderr, "Tuple size %u too large to fit in page\n", catalog->tuple_size);
+    return false;
+  }
+  if (dbms_has_occupancy_bitmap(catalog)) {
+    // An empty occupancy bitmap, free_space_head is the lowest free slot
+    memset(page->data, 0, dbms_data_size(catalog));
+    return true;
+  }
+  if (catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    // An empty directory, tuples_per_page counts its entries and free_space_head is the start of the heap
+    slotted_init_page(page, dbms_data_size(catalog));
+    return true;
+  }
+  if (catalog->tuple_size % 8 != 0 || catalog->tuple_size < 16) {
+    fprintf(stderr, "Tuple size %u is invalid\n", catalog->tuple_size);
     return false;
   }
 
@@ -645,7 +1329,7 @@ bool dbms_init_page(const system_catalog_t* catalog, page_t* page, uint64_t page
 
     *null_byte_ptr = 0;  // Mark as free
     if (i == page->tuples_per_page - 1) {
-      *next_free_ptr = PAGE_SIZE;  // End of free list
+      *next_free_ptr = dbms_page_size(catalog);  // End of free list
     } else {
       // Don't add null byte size, should point to start of next tuple
       *next_free_ptr = tuple_offset + catalog->tuple_size - FREE_POINTER_OFFSET;
@@ -664,11 +1348,62 @@ uint8_t dbms_catalog_num_used(const system_catalog_t* catalog) {
   return last_record->attribute_type == ATTRIBUTE_TYPE_UNUSED ? catalog->record_count - 1 : catalog->record_count;
 }
 
+uint32_t dbms_page_size(const system_catalog_t* catalog) {
+  return catalog && catalog->page_size != 0 ? catalog->page_size : PAGE_SIZE;
+}
+
+size_t dbms_data_size(const system_catalog_t* catalog) { return dbms_page_size(catalog) - PAGE_HEADER_SIZE; }
+
+size_t dbms_frame_size(const system_catalog_t* catalog) {
+  uint32_t page_size = dbms_page_size(catalog);
+  return page_size > PAGE_SIZE ? page_size : PAGE_SIZE;
+}
+
+bool dbms_is_valid_page_size(uint32_t page_size) {
+  return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+}
+
 uint64_t dbms_catalog_tuples_per_page(const system_catalog_t* catalog) {
   if (!catalog || catalog->tuple_size == 0) {
     return 0;
   }
-  return (uint64_t)DATA_SIZE / catalog->tuple_size;
+  if (catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    return slotted_max_slots(catalog);
+  }
+  if (catalog->layout == CATALOG_LAYOUT_BITMAP) {
+    // A tuple without its null byte and an occupancy bit per slot, no minimum size or alignment
+    size_t row_size = bitmap_row_size(catalog);
+    if (row_size == 0) {
+      return 0;
+    }
+    size_t data_size = dbms_data_size(catalog);
+    uint64_t tuples_per_page = (uint64_t)data_size * 8 / (row_size * 8 + 1);
+    while (tuples_per_page > 0 && occupancy_bitmap_size(tuples_per_page) + tuples_per_page * row_size > data_size) {
+      tuples_per_page--;
+    }
+    return tuples_per_page;
+  }
+  if (catalog->layout != CATALOG_LAYOUT_PAX) {
+    return (uint64_t)dbms_data_size(catalog) / catalog->tuple_size;
+  }
+
+  // PAX pages need no null byte or padding, only a presence bit per slot
+  size_t row_size = 0;
+  for (uint8_t i = 0; i < catalog->record_count; i++) {
+    if (catalog->records[i].attribute_type != ATTRIBUTE_TYPE_UNUSED) {
+      row_size += dbms_get_stored_size(catalog, i);
+    }
+  }
+  if (row_size == 0) {
+    return 0;
+  }
+  // Start from the unaligned estimate, the minipage alignment costs at most a few slots
+  size_t data_size = dbms_data_size(catalog);
+  uint64_t tuples_per_page = (uint64_t)data_size * 8 / (row_size * 8 + 1);
+  while (tuples_per_page > 0 && pax_data_size(catalog, tuples_per_page) > data_size) {
+    tuples_per_page--;
+  }
+  return tuples_per_page;
 }
 
 buffer_page_t* dbms_find_page_with_free_space(dbms_session_t* session) {
@@ -676,17 +1411,28 @@ buffer_page_t* dbms_find_page_with_free_space(dbms_session_t* session) {
     return NULL;
   }
 
+  // Room for the smallest record, a slotted page may not fit a longer one
+  size_t record_size = 0;
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    slotted_format_t format;
+    slotted_get_format(session->catalog, &format);
+    record_size = format.min_record_size;
+  }
+  return find_page_with_space(session, record_size);
+}
+
+static buffer_page_t* find_page_with_space(dbms_session_t* session, size_t record_size) {
   // Check if any pages in buffer pool have free space
   // TODO: Optimize this search?
   bool to_check[session->page_count];
   memset(to_check, true, sizeof(to_check));
   for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
     buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
-    if (!buffer_page->is_free) {
+    if (!buffer_page->is_free && buffer_page->file_id == DBMS_TABLE_FILE_ID) {
       page_t* page = buffer_page->page;
-      // There is free space if free space head is not at end of data
-      if (page->free_space_head < PAGE_SIZE) {
-        return buffer_page;
+      if (has_free_space(session, page, record_size)) {
+        // Page may have been loaded raw, make sure its tuples are decoded before inserting
+        return dbms_get_buffer_page(session, buffer_page->page_id);
       }
       to_check[buffer_page->page_id - 1] = false;
     }
@@ -702,14 +1448,14 @@ buffer_page_t* dbms_find_page_with_free_space(dbms_session_t* session) {
         return NULL;
       }
       page_t* page = buffer_page->page;
-      if (page->free_space_head < PAGE_SIZE) {
+      if (has_free_space(session, page, record_size)) {
         return buffer_page;
       }
     }
   }
 
   // Create a new page at the end of the file
-  page_t* new_page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  page_t* new_page = aligned_alloc(PAGE_SIZE, dbms_frame_size(session->catalog));
   if (!new_page) {
     fprintf(stderr, "Failed to create new page in disk\n");
     return NULL;
@@ -718,59 +1464,180 @@ buffer_page_t* dbms_find_page_with_free_space(dbms_session_t* session) {
     fprintf(stderr, "Failed to load page with free space from disk\n");
     return NULL;
   }
-  ssdio_write_page(session->fd, ++session->page_count, new_page);
+  bool is_written = dbms_write_table_page(session, session->page_count + 1, new_page);
+  free(new_page);
+  if (!is_written) {
+    fprintf(stderr, "Failed to write new page to disk\n");
+    return NULL;
+  }
+  session->page_count++;
   ssdio_flush(session->fd);
 
   return dbms_get_buffer_page(session, session->page_count);
 }
 
 tuple_t* dbms_insert_tuple(dbms_session_t* session, attribute_value_t* attributes) {
-  if (!session || !attributes) {
+  if (!session || !attributes || !is_writable(session)) {
+    return NULL;
+  }
+
+  // New values of encoded attributes are added before any page is changed
+  uint32_t codes[dbms_catalog_num_used(session->catalog) + 1];
+  if (!encode_attributes(session, attributes, codes)) {
     return NULL;
   }
 
-  // Find a page with free space
-  buffer_page_t* target_page = dbms_find_page_with_free_space(session);
+  // Find a page with free space, slotted records need room for their actual length
+  size_t record_size =
+      session->catalog->layout == CATALOG_LAYOUT_SLOTTED ? slotted_record_size(session, attributes) : 0;
+  buffer_page_t* target_page = find_page_with_space(session, record_size);
   if (!target_page) {
     fprintf(stderr, "Failed to find a page with free space for inserting tuple\n");
     return NULL;
   }
+  return insert_into_page(session, target_page, attributes, codes);
+}
 
+static tuple_t* insert_into_page(dbms_session_t* session, buffer_page_t* target_page, attribute_value_t* attributes,
+                                 const uint32_t* codes) {
   // Insert tuple into the target page
   page_t* page = target_page->page;
   uint64_t free_space_offset = page->free_space_head;
 
-  // free_space_head = PAGE_SIZE means no free space
-  if (free_space_offset >= PAGE_SIZE) {
+  // free_space_head = page size means no free space
+  uint32_t page_size = dbms_page_size(session->catalog);
+  if (session->catalog->layout != CATALOG_LAYOUT_SLOTTED && free_space_offset >= page_size) {
     fprintf(stderr, "No free space available in the target page\n");
     return NULL;
   }
 
-  // Update free space head to next free tuple
-  uint64_t next_free_ptr = *(uint64_t*)&page->data[free_space_offset + FREE_POINTER_OFFSET];
-  page->free_space_head = next_free_ptr;
+  uint64_t slot_id = 0;
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    // Reuses the lowest free directory entry before adding one
+    slot_id = slotted_find_free_slot(page);
+  } else if (dbms_has_occupancy_bitmap(session->catalog)) {
+    // The head is the lowest free slot, every slot below it is in use
+    slot_id = free_space_offset;
+  } else {
+    // Update free space head to next free tuple
+    uint64_t next_free_ptr = *(uint64_t*)&page->data[free_space_offset + FREE_POINTER_OFFSET];
+    page->free_space_head = next_free_ptr;
+    slot_id = free_space_offset / session->catalog->tuple_size;
+  }
 
   // Write attribute values into the page and into the tuples
-  uint64_t slot_id = free_space_offset / session->catalog->tuple_size;
   tuple_t* tuple = &target_page->tuples[slot_id];
 
-  tuple_t* inserted = replace_tuple_data(session, tuple, target_page, attributes);
+  tuple_t* inserted = replace_tuple_data(session, tuple, target_page, attributes, codes);
+  if (dbms_has_occupancy_bitmap(session->catalog)) {
+    page->free_space_head = next_free_slot(page, page->tuples_per_page, slot_id + 1, page_size);
+  }
+
+  // Index pages share the buffer pool, keep the tuple's page resident while they are updated
+  target_page->pin_count++;
 
   // Update indexes
-  if (inserted && session->indexes) {
-      uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
-      for (uint8_t i = 0; i < num_attributes; i++) {
-          if (session->indexes[i]) {
-              uint64_t key = index_hash_attribute(&inserted->attributes[i]);
-              index_insert(session->indexes[i], key, inserted->id);
-          }
-      }
+  if (inserted) {
+    update_hash_indexes(session, inserted, true);
+    btree_insert_tuple(session, inserted);
+    zone_map_insert_tuple(session->zone_map, inserted);
   }
+
+  target_page->pin_count--;
   return inserted;
 }
 
+tuple_t* dbms_relocate_tuple(dbms_session_t* session, tuple_id_t tuple_id, uint64_t first_page_id) {
+  if (!session || first_page_id == 0 || first_page_id >= tuple_id.page_id || !is_writable(session)) {
+    return NULL;
+  }
+
+  // The source stays resident while its values are copied, they may point into the page
+  buffer_page_t* source_page = dbms_pin_page(session, tuple_id.page_id);
+  if (!source_page) {
+    return NULL;
+  }
+  if (tuple_id.slot_id >= dbms_catalog_tuples_per_page(session->catalog) ||
+      source_page->tuples[tuple_id.slot_id].is_null) {
+    dbms_unpin_page(session, source_page);
+    return NULL;
+  }
+
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  attribute_value_t attributes[num_attributes];
+  memcpy(attributes, source_page->tuples[tuple_id.slot_id].attributes, sizeof(attributes));
+  uint32_t codes[num_attributes + 1];
+  if (!encode_attributes(session, attributes, codes)) {
+    dbms_unpin_page(session, source_page);
+    return NULL;
+  }
+
+  size_t record_size =
+      session->catalog->layout == CATALOG_LAYOUT_SLOTTED ? slotted_record_size(session, attributes) : 0;
+  tuple_t* moved = NULL;
+  for (uint64_t page_id = first_page_id; !moved && page_id < tuple_id.page_id; page_id++) {
+    buffer_page_t* target_page = dbms_get_buffer_page(session, page_id);
+    if (!target_page) {
+      break;
+    }
+    if (!has_free_space(session, target_page->page, record_size)) {
+      continue;
+    }
+
+    moved = insert_into_page(session, target_page, attributes, codes);
+    if (moved) {
+      // The delete updates the indexes, whose pages must not evict the new copy
+      target_page->pin_count++;
+      dbms_delete_tuple(session, tuple_id);
+      target_page->pin_count--;
+    }
+    break;
+  }
+
+  dbms_unpin_page(session, source_page);
+  return moved;
+}
+
+bool dbms_truncate_table(dbms_session_t* session, uint32_t page_count, bool punch_holes) {
+  if (!session || !session->buffer_pool || page_count == 0 || page_count > session->page_count ||
+      !is_writable(session)) {
+    return false;
+  }
+
+  // The dropped pages are discarded without being written back
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
+    if (!buffer_page->is_free && buffer_page->file_id == DBMS_TABLE_FILE_ID && buffer_page->page_id > page_count &&
+        buffer_page->pin_count > 0) {
+      fprintf(stderr, "Page %llu is pinned and cannot be truncated\n", (unsigned long long)buffer_page->page_id);
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
+    if (!buffer_page->is_free && buffer_page->file_id == DBMS_TABLE_FILE_ID && buffer_page->page_id > page_count) {
+      buffer_page->is_dirty = false;
+      dbms_flush_buffer_page(session, buffer_page, false);
+    }
+  }
+
+  session->page_count = page_count;
+  if (!zone_map_truncate(session->zone_map, page_count) ||
+      !compression_map_truncate(session->compression_map, page_count)) {
+    return false;
+  }
+
+  // Everything left must be on disk before the space of the dropped pages is given back
+  dbms_flush_buffer_pool(session);
+  bool is_truncated = session->compression_map
+                          ? compression_map_trim(session->compression_map, session->fd, punch_holes)
+                          : ssdio_truncate(session->fd, PAGE_SIZE + (off_t)page_count * dbms_page_size(session->catalog));
+  ssdio_flush(session->fd);
+  return is_truncated;
+}
+
 tuple_t* dbms_update_tuple(dbms_session_t* session, tuple_id_t tuple_id, attribute_value_t* new_attributes) {
-  if (!session || !new_attributes) {
+  if (!session || !new_attributes || !is_writable(session)) {
     return NULL;
   }
 
@@ -792,33 +1659,34 @@ tuple_t* dbms_update_tuple(dbms_session_t* session, tuple_id_t tuple_id, attribu
     return NULL;
   }
 
-  // Update indexes (delete old)
-  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
-  if (session->indexes) {
-      for (uint8_t i = 0; i < num_attributes; i++) {
-          if (session->indexes[i]) {
-              uint64_t key = index_hash_attribute(&tuple->attributes[i]);
-              index_delete(session->indexes[i], key, tuple->id);
-          }
-      }
+  uint32_t codes[dbms_catalog_num_used(session->catalog) + 1];
+  if (!encode_attributes(session, new_attributes, codes)) {
+    return NULL;
   }
 
-  tuple_t* updated = replace_tuple_data(session, tuple, buffer_page, new_attributes);
+  // Index pages share the buffer pool, keep the tuple's page resident while they are updated
+  buffer_page->pin_count++;
+  btree_delete_tuple(session, tuple);
+
+  // Update indexes (delete old)
+  update_hash_indexes(session, tuple, false);
+  zone_map_delete_tuple(session->zone_map, buffer_page, tuple);
+
+  tuple_t* updated = replace_tuple_data(session, tuple, buffer_page, new_attributes, codes);
 
   // Update indexes (insert new)
-  if (updated && session->indexes) {
-      for (uint8_t i = 0; i < num_attributes; i++) {
-          if (session->indexes[i]) {
-              uint64_t key = index_hash_attribute(&updated->attributes[i]);
-              index_insert(session->indexes[i], key, updated->id);
-          }
-      }
+  if (updated) {
+    update_hash_indexes(session, updated, true);
+    btree_insert_tuple(session, updated);
+    zone_map_insert_tuple(session->zone_map, updated);
   }
+
+  buffer_page->pin_count--;
   return updated;
 }
 
 bool dbms_delete_tuple(dbms_session_t* session, tuple_id_t tuple_id) {
-  if (!session) {
+  if (!session || !is_writable(session)) {
     return false;
   }
 
@@ -842,26 +1710,54 @@ bool dbms_delete_tuple(dbms_session_t* session, tuple_id_t tuple_id) {
   }
 
   // Update indexes
-  if (session->indexes) {
+  update_hash_indexes(session, tuple, false);
+
+  // Index pages share the buffer pool, keep the tuple's page resident while they are updated
+  buffer_page->pin_count++;
+  btree_delete_tuple(session, tuple);
+  buffer_page->pin_count--;
+  zone_map_delete_tuple(session->zone_map, buffer_page, tuple);
+
+  if (dbms_has_occupancy_bitmap(session->catalog)) {
+    // Clear the occupancy bit and the values, the slot becomes the head if it is the lowest free one
+    set_slot_bit(page, tuple_id.slot_id, false);
+    if (session->catalog->layout == CATALOG_LAYOUT_BITMAP) {
+      size_t row_size = bitmap_row_size(session->catalog);
+      memset(page->data + occupancy_bitmap_size(page->tuples_per_page) + tuple_id.slot_id * row_size, 0, row_size);
+    } else {
       uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+      off_t offsets[num_attributes];
+      size_t strides[num_attributes];
+      get_columns(session->catalog, offsets, strides);
       for (uint8_t i = 0; i < num_attributes; i++) {
-          if (session->indexes[i]) {
-              uint64_t key = index_hash_attribute(&tuple->attributes[i]);
-              index_delete(session->indexes[i], key, tuple->id);
-          }
+        memset(page->data + offsets[i] + tuple_id.slot_id * strides[i], 0, strides[i]);
       }
-  }
-
-  // Get tuple data location
-  uint64_t tuple_offset = tuple_id.slot_id * session->catalog->tuple_size;
-  char* tuple_data = &page->data[tuple_offset];
-  // Nullify the tuple data
-  memset(tuple_data, 0, session->catalog->tuple_size);
+    }
+    if (tuple_id.slot_id < page->free_space_head) {
+      page->free_space_head = tuple_id.slot_id;
+    }
+  } else if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    // The record's space is reclaimed when the page is next compacted
+    bool is_overflow = false;
+    const char* record = slotted_get_record(page, tuple_id.slot_id, &is_overflow);
+    if (record && is_overflow) {
+      slotted_format_t format;
+      slotted_get_format(session->catalog, &format);
+      slotted_overflow_release(session->overflow, load_u64(record + format.prefix_size));
+    }
+    slotted_release(page, tuple_id.slot_id, dbms_data_size(session->catalog));
+  } else {
+    // Get tuple data location
+    uint64_t tuple_offset = tuple_id.slot_id * session->catalog->tuple_size;
+    char* tuple_data = &page->data[tuple_offset];
+    // Nullify the tuple data
+    memset(tuple_data, 0, session->catalog->tuple_size);
 
-  // Add tuple back to free space linked list
-  uint64_t* next_free_ptr = (uint64_t*)&tuple_data[FREE_POINTER_OFFSET];
-  *next_free_ptr = page->free_space_head;
-  page->free_space_head = tuple_offset;
+    // Add tuple back to free space linked list
+    uint64_t* next_free_ptr = (uint64_t*)&tuple_data[FREE_POINTER_OFFSET];
+    *next_free_ptr = page->free_space_head;
+    page->free_space_head = tuple_offset;
+  }
 
   // Mark tuple as null in buffer page
   tuple->is_null = true;
@@ -897,24 +1793,48 @@ tuple_t* dbms_get_tuple(dbms_session_t* session, tuple_id_t tuple_id) {
 }
 
 static tuple_t* replace_tuple_data(dbms_session_t* session, tuple_t* tuple, buffer_page_t* buffer_page,
-                                   attribute_value_t* attributes) {
-  if (!session || !tuple || !buffer_page || !attributes) {
+                                   attribute_value_t* attributes, const uint32_t* codes) {
+  if (!session || !tuple || !buffer_page || !attributes || !codes) {
     return NULL;
   }
 
   page_t* page = buffer_page->page;
-  uint64_t free_space_offset = tuple->id.slot_id * session->catalog->tuple_size;
-  char* tuple_page_loc = &page->data[free_space_offset];
-  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  uint64_t slot_id = tuple->id.slot_id;
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    slotted_format_t format;
+    slotted_get_format(session->catalog, &format);
+    if (!write_slotted_record(session, page, slot_id, attributes, codes) ||
+        !decode_slotted_tuple(session, &format, page, slot_id, tuple)) {
+      fprintf(stderr, "Failed to write tuple %llu:%llu\n", (unsigned long long)buffer_page->page_id,
+              (unsigned long long)slot_id);
+      return NULL;
+    }
+    buffer_page->is_dirty = true;
+    buffer_page->last_updated = session->update_ctr++;
+    return tuple;
+  }
 
-  tuple_page_loc[0] = 1;  // Mark as not null
-  // Zero out the rest of the tuple data
-  memset(tuple_page_loc + NULL_BYTE_SIZE, 0, session->catalog->tuple_size - NULL_BYTE_SIZE);
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  off_t offsets[num_attributes];
+  size_t strides[num_attributes];
+  get_columns(session->catalog, offsets, strides);
+
+  if (session->catalog->layout == CATALOG_LAYOUT_PAX) {
+    set_slot_bit(page, slot_id, true);  // Mark as present
+  } else if (session->catalog->layout == CATALOG_LAYOUT_BITMAP) {
+    set_slot_bit(page, slot_id, true);
+    size_t row_size = bitmap_row_size(session->catalog);
+    memset(page->data + occupancy_bitmap_size(page->tuples_per_page) + slot_id * row_size, 0, row_size);
+  } else {
+    char* tuple_page_loc = &page->data[slot_id * session->catalog->tuple_size];
+    tuple_page_loc[0] = 1;  // Mark as not null
+    // Zero out the rest of the tuple data
+    memset(tuple_page_loc + NULL_BYTE_SIZE, 0, session->catalog->tuple_size - NULL_BYTE_SIZE);
+  }
   tuple->is_null = false;
-  off_t offset = NULL_BYTE_SIZE;
   for (uint8_t i = 0; i < num_attributes; i++) {
     catalog_record_t* record = dbms_get_catalog_record(session->catalog, i);
-    char* page_attribute_ptr = tuple_page_loc + offset;
+    char* page_attribute_ptr = page->data + offsets[i] + slot_id * strides[i];
     attribute_value_t* tuple_attr = &tuple->attributes[i];
     switch (record->attribute_type) {
       case ATTRIBUTE_TYPE_INT:
@@ -927,8 +1847,14 @@ static tuple_t* replace_tuple_data(dbms_session_t* session, tuple_t* tuple, buff
         break;
       case ATTRIBUTE_TYPE_STRING: {
         size_t copy_size = strnlen(attributes[i].string_value, record->attribute_size);
-        // Rest of page tuple is already zeroed out
-        memcpy(page_attribute_ptr, attributes[i].string_value, copy_size);
+        if (dbms_is_dictionary_encoded(session->catalog, i)) {
+          store_u16(page_attribute_ptr, (uint16_t)codes[i]);
+          tuple_attr->dictionary_code = codes[i];
+        } else {
+          // Strings are zero padded (PAX minipages still hold the previous value)
+          memset(page_attribute_ptr, 0, record->attribute_size);
+          memcpy(page_attribute_ptr, attributes[i].string_value, copy_size);
+        }
 
         // Also copy to tuple attribute value, ensuring null-termination
         memcpy(tuple_attr->string_value, attributes[i].string_value, copy_size);
@@ -941,7 +1867,6 @@ static tuple_t* replace_tuple_data(dbms_session_t* session, tuple_t* tuple, buff
       default:
         break;
     }
-    offset += record->attribute_size;
   }
 
   buffer_page->is_dirty = true;
@@ -963,6 +1888,39 @@ buffer_page_t* dbms_pin_page(dbms_session_t* session, uint64_t page_id) {
   return buffer_page;
 }
 
+buffer_page_t* dbms_pin_raw_page(dbms_session_t* session, uint64_t page_id) {
+  if (!session) {
+    return NULL;
+  }
+
+  buffer_page_t* buffer_page = dbms_get_raw_buffer_page(session, page_id);
+  if (!buffer_page) {
+    return NULL;
+  }
+
+  buffer_page->pin_count++;
+  return buffer_page;
+}
+
+buffer_page_t* dbms_pin_file_page(dbms_session_t* session, int fd, uint16_t file_id, uint64_t page_id, bool is_new) {
+  if (!session || !session->buffer_pool || fd < 0 || file_id == DBMS_TABLE_FILE_ID) {
+    return NULL;
+  }
+
+  buffer_page_t* buffer_page = load_buffer_page(session, fd, file_id, page_id, is_new);
+  if (!buffer_page) {
+    return NULL;
+  }
+  if (is_new) {
+    // The page may still be cached from before the file was truncated
+    memset(buffer_page->page, 0, dbms_frame_size(session->catalog));
+    buffer_page->is_dirty = true;
+  }
+
+  buffer_page->pin_count++;
+  return buffer_page;
+}
+
 void dbms_unpin_page(dbms_session_t* session, buffer_page_t* buffer_page) {
   if (!session || !buffer_page) {
     return;
@@ -990,6 +1948,7 @@ bool dbms_copy_tuple(dbms_session_t* session, const tuple_t* src, tuple_t* dest)
     }
 
     dest->attributes[i].type = src->attributes[i].type;
+    dest->attributes[i].dictionary_code = src->attributes[i].dictionary_code;
 
     switch (record->attribute_type) {
       case ATTRIBUTE_TYPE_INT:
@@ -1014,3 +1973,307 @@ bool dbms_copy_tuple(dbms_session_t* session, const tuple_t* src, tuple_t* dest)
 
   return true;
 }
+
+// Adds (or removes) a tuple in every hash index of the session, single attribute and composite
+static void update_hash_indexes(dbms_session_t* session, const tuple_t* tuple, bool is_insert) {
+  if (session->indexes) {
+    uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+    for (uint8_t i = 0; i < num_attributes; i++) {
+      if (!session->indexes[i]) {
+        continue;
+      }
+      if (is_insert) {
+        index_insert(session->indexes[i], &tuple->attributes[i], tuple->id);
+      } else {
+        index_delete(session->indexes[i], &tuple->attributes[i], tuple->id);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < session->composite_index_count; i++) {
+    index_t* index = session->composite_indexes[i];
+    attribute_value_t values[INDEX_MAX_ATTRIBUTES];
+    index_get_key_values(index, tuple->attributes, values);
+    if (is_insert) {
+      index_insert(index, values, tuple->id);
+    } else {
+      index_delete(index, values, tuple->id);
+    }
+  }
+}
+
+static bool encode_attributes(dbms_session_t* session, const attribute_value_t* attributes, uint32_t* codes) {
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    codes[i] = DICTIONARY_NO_CODE;
+    if (dbms_is_dictionary_encoded(session->catalog, i) &&
+        !dictionary_encode(session->dictionary, i, attributes[i].string_value, &codes[i])) {
+      fprintf(stderr, "Failed to dictionary encode the value of attribute %u\n", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void get_columns(const system_catalog_t* catalog, off_t* offsets, size_t* strides) {
+  uint8_t num_attributes = dbms_catalog_num_used(catalog);
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(catalog);
+  off_t offset = dbms_has_occupancy_bitmap(catalog)            ? (off_t)occupancy_bitmap_size(tuples_per_page)
+                 : catalog->layout == CATALOG_LAYOUT_SLOTTED ? 0
+                                                             : NULL_BYTE_SIZE;
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    const catalog_record_t* record = &catalog->records[i];
+    offsets[i] = offset;
+    size_t stored_size = dbms_get_stored_size(catalog, i);
+    if (catalog->layout == CATALOG_LAYOUT_BITMAP) {
+      strides[i] = bitmap_row_size(catalog);
+      offset += stored_size;
+    } else if (catalog->layout != CATALOG_LAYOUT_NSM) {
+      strides[i] = stored_size;
+      if (record->attribute_type != ATTRIBUTE_TYPE_UNUSED) {
+        offset += PAX_ALIGN_UP(tuples_per_page * stored_size);
+      }
+    } else {
+      strides[i] = catalog->tuple_size;
+      offset += stored_size;
+    }
+  }
+}
+
+static bool decode_slotted_tuple(const dbms_session_t* session, const slotted_format_t* format, const page_t* page,
+                                 uint64_t slot_id, tuple_t* tuple) {
+  bool is_overflow = false;
+  const char* record = slotted_get_record(page, slot_id, &is_overflow);
+  tuple->is_null = record == NULL;
+  if (!record) {
+    return true;
+  }
+
+  const char* strings = record + format->prefix_size;
+  char strings_buffer[format->max_record_size];
+  if (is_overflow) {
+    if (!slotted_overflow_read(session->overflow, load_u64(strings), strings_buffer,
+                               slotted_strings_size(format, record))) {
+      return false;
+    }
+    strings = strings_buffer;
+  }
+  const char* values[format->attribute_count + 1];
+  uint8_t lengths[format->attribute_count + 1];
+  slotted_locate_values(format, record, strings, values, lengths);
+
+  for (uint8_t k = 0; k < format->attribute_count; k++) {
+    catalog_record_t* catalog_record = dbms_get_catalog_record(session->catalog, k);
+    attribute_value_t* attribute = &tuple->attributes[k];
+    attribute->type = catalog_record->attribute_type;
+    switch (catalog_record->attribute_type) {
+      case ATTRIBUTE_TYPE_INT:
+        attribute->int_value = (int32_t)load_u32(values[k]);
+        break;
+      case ATTRIBUTE_TYPE_FLOAT:
+        attribute->float_value = load_f32(values[k]);
+        break;
+      case ATTRIBUTE_TYPE_STRING:
+        if (format->is_variable[k]) {
+          memcpy(attribute->string_value, values[k], lengths[k]);
+          attribute->string_value[lengths[k]] = '\0';
+        } else {
+          attribute->dictionary_code = load_u16(values[k]);
+          const char* value = dictionary_decode(session->dictionary, k, attribute->dictionary_code);
+          strncpy(attribute->string_value, value, catalog_record->attribute_size);
+          attribute->string_value[catalog_record->attribute_size] = '\0';
+        }
+        break;
+      case ATTRIBUTE_TYPE_BOOL:
+        attribute->bool_value = load_u8(values[k]) != 0;
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+static bool write_slotted_record(dbms_session_t* session, page_t* page, uint64_t slot_id,
+                                 const attribute_value_t* attributes, const uint32_t* codes) {
+  slotted_format_t format;
+  slotted_get_format(session->catalog, &format);
+  char record[format.max_record_size];
+  size_t length = slotted_encode_record(&format, attributes, codes, record);
+
+  // The chain of the record being replaced is released once the new record is in place
+  bool was_overflow = false;
+  const char* old_record = slotted_get_record(page, slot_id, &was_overflow);
+  uint64_t old_chain = old_record && was_overflow ? load_u64(old_record + format.prefix_size) : OVERFLOW_NO_PAGE;
+
+  size_t data_size = dbms_data_size(session->catalog);
+  size_t size = length > format.min_record_size ? length : format.min_record_size;
+  bool is_long = length > SLOTTED_INLINE_LIMIT(data_size) && length > format.prefix_size;
+  char* target = is_long ? NULL : slotted_allocate(page, slot_id, size, false, data_size);
+  if (target) {
+    memcpy(target, record, length);
+  } else if (length > format.prefix_size) {
+    // Every slot has room for a stub, so an update that outgrows the page still succeeds
+    uint64_t chain = slotted_overflow_write(session->overflow, record + format.prefix_size, length - format.prefix_size);
+    target = chain != OVERFLOW_NO_PAGE ? slotted_allocate(page, slot_id, format.min_record_size, true, data_size)
+                                       : NULL;
+    if (!target) {
+      if (chain != OVERFLOW_NO_PAGE) {
+        slotted_overflow_release(session->overflow, chain);
+      }
+      return false;
+    }
+    memcpy(target, record, format.prefix_size);
+    store_u64(target + format.prefix_size, chain);
+  } else {
+    fprintf(stderr, "No room for a %zu byte record in the page\n", size);
+    return false;
+  }
+
+  if (old_chain != OVERFLOW_NO_PAGE) {
+    slotted_overflow_release(session->overflow, old_chain);
+  }
+  return true;
+}
+
+// Bytes a tuple's record takes in a slotted page, see write_slotted_record
+static size_t slotted_record_size(const dbms_session_t* session, const attribute_value_t* attributes) {
+  slotted_format_t format;
+  slotted_get_format(session->catalog, &format);
+  size_t length = format.prefix_size;
+  for (uint8_t i = 0; i < format.attribute_count; i++) {
+    if (format.is_variable[i]) {
+      length += strnlen(attributes[i].string_value, format.sizes[i]);
+    }
+  }
+  if (length > SLOTTED_INLINE_LIMIT(dbms_data_size(session->catalog)) && length > format.prefix_size) {
+    return format.min_record_size;
+  }
+  return length > format.min_record_size ? length : format.min_record_size;
+}
+
+static bool has_free_space(const dbms_session_t* session, const page_t* page, size_t record_size) {
+  if (session->catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+    return slotted_has_space(page, record_size, dbms_catalog_tuples_per_page(session->catalog),
+                             dbms_data_size(session->catalog));
+  }
+  // There is free space if free space head is not at end of data
+  return page->free_space_head < dbms_page_size(session->catalog);
+}
+
+// One occupancy bit per slot in whole words, so the first minipage or tuple is aligned
+static size_t occupancy_bitmap_size(uint64_t tuples_per_page) {
+  return (tuples_per_page + DBMS_BITMAP_WORD_BITS - 1) / DBMS_BITMAP_WORD_BITS * sizeof(uint64_t);
+}
+
+static size_t pax_data_size(const system_catalog_t* catalog, uint64_t tuples_per_page) {
+  size_t size = occupancy_bitmap_size(tuples_per_page);
+  for (uint8_t i = 0; i < catalog->record_count; i++) {
+    if (catalog->records[i].attribute_type != ATTRIBUTE_TYPE_UNUSED) {
+      size += PAX_ALIGN_UP(tuples_per_page * dbms_get_stored_size(catalog, i));
+    }
+  }
+  return size;
+}
+
+// Lowest free slot at or after slot_id, full (the page size) if the page is full
+static uint64_t next_free_slot(const page_t* page, uint64_t tuples_per_page, uint64_t slot_id, uint64_t full) {
+  const uint64_t* bitmap = (const uint64_t*)page->data;
+  for (uint64_t word = slot_id / DBMS_BITMAP_WORD_BITS; word * DBMS_BITMAP_WORD_BITS < tuples_per_page; word++) {
+    // A full word is skipped in one compare, otherwise its lowest zero bit is the free slot
+    uint64_t free_bits = ~bitmap[word];
+    if (word == slot_id / DBMS_BITMAP_WORD_BITS) {
+      free_bits &= ~0ULL << (slot_id % DBMS_BITMAP_WORD_BITS);
+    }
+    if (free_bits != 0) {
+      uint64_t free_slot = word * DBMS_BITMAP_WORD_BITS + (uint64_t)__builtin_ctzll(free_bits);
+      return free_slot < tuples_per_page ? free_slot : full;
+    }
+  }
+  return full;
+}
+
+static void set_slot_bit(page_t* page, uint64_t slot_id, bool is_live) {
+  uint64_t* word = &((uint64_t*)page->data)[slot_id / DBMS_BITMAP_WORD_BITS];
+  uint64_t bit = 1ULL << (slot_id % DBMS_BITMAP_WORD_BITS);
+  *word = is_live ? *word | bit : *word & ~bit;
+}
+
+// Bitmap pages store the tuple without its null byte
+static size_t bitmap_row_size(const system_catalog_t* catalog) {
+  return catalog->tuple_size > NULL_BYTE_SIZE ? catalog->tuple_size - NULL_BYTE_SIZE : 0;
+}
+
+// Tuples with their attribute values, as many as count slots of decoded pages
+static tuple_t* alloc_tuples(const system_catalog_t* catalog, uint64_t count) {
+  tuple_t* tuples = calloc(count, sizeof(tuple_t));
+  if (!tuples) {
+    fprintf(stderr, "Memory allocation failed for tuples\n");
+    return NULL;
+  }
+
+  // Allocate attribute values for each tuple
+  uint8_t num_attributes = dbms_catalog_num_used(catalog);
+  attribute_value_t* attribute_values = calloc(count * num_attributes, sizeof(attribute_value_t));
+  if (!attribute_values) {
+    fprintf(stderr, "Memory allocation failed for attribute values\n");
+    free(tuples);
+    return NULL;
+  }
+
+  for (uint64_t j = 0; j < count; j++) {
+    tuple_t* tuple = &tuples[j];
+    tuple->id.page_id = 0;
+    tuple->id.slot_id = 0;
+    tuple->is_null = true;
+    tuple->attributes = &attribute_values[j * num_attributes];
+
+    // For each attribute, correctly set type based on catalog
+    for (uint8_t k = 0; k < num_attributes; k++) {
+      catalog_record_t* record = dbms_get_catalog_record(catalog, k);
+      if (record) {
+        tuple->attributes[k].type = record->attribute_type;
+        if (record->attribute_type == ATTRIBUTE_TYPE_STRING) {
+          // Tuples allocate their own string storage to guarantee null-termination
+          tuple->attributes[k].string_value = calloc(record->attribute_size + 1, sizeof(char));
+          if (!tuple->attributes[k].string_value) {
+            fprintf(stderr, "Memory allocation failed for tuple string attribute value\n");
+            free_tuples(catalog, tuples, count);
+            return NULL;
+          }
+        }
+      }
+    }
+  }
+  return tuples;
+}
+
+static void free_tuples(const system_catalog_t* catalog, tuple_t* tuples, uint64_t count) {
+  if (!tuples) {
+    return;
+  }
+
+  // Also need to free each tuple's attribute string values
+  uint8_t num_attributes = dbms_catalog_num_used(catalog);
+  for (uint64_t j = 0; j < count; j++) {
+    tuple_t* tuple = &tuples[j];
+    for (uint8_t k = 0; k < num_attributes && tuple->attributes; k++) {
+      if (tuple->attributes[k].type == ATTRIBUTE_TYPE_STRING && tuple->attributes[k].string_value) {
+        free(tuple->attributes[k].string_value);
+      }
+    }
+  }
+  // The attribute values are allocated all together, so just free the first tuple's
+  if (count > 0) {
+    free(tuples[0].attributes);
+  }
+  free(tuples);
+}
+
+static bool is_writable(const dbms_session_t* session) {
+  if (session->is_readonly) {
+    fprintf(stderr, "Table %s is open read-only\n", session->table_name);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,341 @@
+#include "dictionary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssdio.h"
+
+#define DICTIONARY_MAGIC_SIZE 8
+#define DICTIONARY_INITIAL_CAPACITY 16
+
+static char* get_filename(const char* table_filename);
+static dictionary_t* allocate_dictionary(const dbms_session_t* session);
+static const dictionary_column_t* get_column(const dictionary_t* dictionary, uint8_t attribute_index);
+static uint64_t hash_value(const char* value, size_t length);
+static bool value_equals(const dictionary_column_t* column, uint32_t code, const char* value, size_t length);
+static uint32_t find_code(const dictionary_column_t* column, const char* value, size_t length);
+static bool add_value(dictionary_column_t* column, const char* value, size_t length);
+static bool load_file(dictionary_t* dictionary);
+
+bool dictionary_create(const char* table_filename, const system_catalog_t* catalog) {
+  if (!table_filename || !catalog) {
+    return false;
+  }
+
+  char* filename = get_filename(table_filename);
+  if (!filename) {
+    return false;
+  }
+  remove(filename);
+
+  bool is_encoded = false;
+  for (uint8_t i = 0; i < catalog->record_count; i++) {
+    is_encoded |= dbms_is_dictionary_encoded(catalog, i);
+  }
+  if (!is_encoded) {
+    free(filename);
+    return true;
+  }
+
+  int fd = ssdio_open(filename, true);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to create dictionary file: %s\n", filename);
+    free(filename);
+    return false;
+  }
+  bool ok = pwrite(fd, DICTIONARY_FILE_MAGIC, DICTIONARY_MAGIC_SIZE, 0) == DICTIONARY_MAGIC_SIZE &&
+            ssdio_flush(fd) == 0;
+  if (!ok) {
+    fprintf(stderr, "Failed to write dictionary file: %s\n", filename);
+  }
+  ssdio_close(fd);
+  free(filename);
+  return ok;
+}
+
+dictionary_t* dictionary_open(const dbms_session_t* session) {
+  if (!session || !session->catalog) {
+    return NULL;
+  }
+
+  dictionary_t* dictionary = allocate_dictionary(session);
+  if (!dictionary) {
+    return NULL;
+  }
+  if (dictionary->column_count == 0) {
+    dictionary_free(dictionary);
+    return NULL;
+  }
+
+  // Unlike the zone map the file cannot be rebuilt, the pages only hold codes
+  dictionary->fd = ssdio_open(dictionary->filename, false);
+  if (dictionary->fd < 0) {
+    fprintf(stderr, "Failed to open dictionary file: %s\n", dictionary->filename);
+    dictionary_free(dictionary);
+    return NULL;
+  }
+  if (!load_file(dictionary)) {
+    fprintf(stderr, "Failed to load dictionary file: %s\n", dictionary->filename);
+    dictionary_free(dictionary);
+    return NULL;
+  }
+  return dictionary;
+}
+
+bool dictionary_sync(dictionary_t* dictionary) {
+  if (!dictionary || !dictionary->is_dirty) {
+    return true;
+  }
+  if (ssdio_flush(dictionary->fd) != 0) {
+    fprintf(stderr, "Failed to flush dictionary file: %s\n", dictionary->filename);
+    return false;
+  }
+  dictionary->is_dirty = false;
+  return true;
+}
+
+void dictionary_free(dictionary_t* dictionary) {
+  if (!dictionary) {
+    return;
+  }
+
+  if (dictionary->fd >= 0) {
+    ssdio_close(dictionary->fd);
+  }
+  if (dictionary->columns) {
+    for (uint8_t i = 0; i < dictionary->column_count; i++) {
+      free(dictionary->columns[i].values);
+      hash_table_free(dictionary->columns[i].codes);
+    }
+  }
+  free(dictionary->columns);
+  free(dictionary->attribute_columns);
+  free(dictionary->filename);
+  free(dictionary);
+}
+
+bool dictionary_encode(dictionary_t* dictionary, uint8_t attribute_index, const char* value, uint32_t* code_out) {
+  dictionary_column_t* column = (dictionary_column_t*)get_column(dictionary, attribute_index);
+  if (!column || !code_out) {
+    return false;
+  }
+
+  const char* padded = value ? value : "";
+  size_t length = strnlen(padded, column->value_size);
+  uint32_t code = find_code(column, padded, length);
+  if (code != DICTIONARY_NO_CODE) {
+    *code_out = code;
+    return true;
+  }
+  if (column->count >= DICTIONARY_MAX_CODES) {
+    fprintf(stderr, "Dictionary of attribute %u is full (%u values)\n", attribute_index, DICTIONARY_MAX_CODES);
+    return false;
+  }
+
+  if (!add_value(column, padded, length)) {
+    return false;
+  }
+  code = column->count - 1;
+
+  // Written before any page can hold the code
+  size_t entry_size = 1 + column->value_size;
+  char entry[1 + UINT8_MAX] = {0};
+  entry[0] = (char)attribute_index;
+  memcpy(entry + 1, padded, length);
+  if (pwrite(dictionary->fd, entry, entry_size, dictionary->file_size) != (ssize_t)entry_size) {
+    fprintf(stderr, "Failed to write dictionary file: %s\n", dictionary->filename);
+    uint64_t hashed_code = 0;
+    uint64_t hash = hash_value(padded, length);
+    if (hash_table_get(column->codes, hash, &hashed_code) && hashed_code == code) {
+      hash_table_delete(column->codes, hash);
+    }
+    column->count--;
+    return false;
+  }
+  dictionary->file_size += entry_size;
+  dictionary->is_dirty = true;
+  *code_out = code;
+  return true;
+}
+
+uint32_t dictionary_lookup(const dictionary_t* dictionary, uint8_t attribute_index, const char* value) {
+  const dictionary_column_t* column = get_column(dictionary, attribute_index);
+  const char* padded = value ? value : "";
+  size_t length = strlen(padded);
+  // A longer value equals no stored one
+  if (!column || length > column->value_size) {
+    return DICTIONARY_NO_CODE;
+  }
+  return find_code(column, padded, length);
+}
+
+const char* dictionary_decode(const dictionary_t* dictionary, uint8_t attribute_index, uint32_t code) {
+  const dictionary_column_t* column = get_column(dictionary, attribute_index);
+  if (!column || code >= column->count) {
+    return "";
+  }
+  return column->values + (size_t)code * column->value_size;
+}
+
+uint32_t dictionary_count(const dictionary_t* dictionary, uint8_t attribute_index) {
+  const dictionary_column_t* column = get_column(dictionary, attribute_index);
+  return column ? column->count : 0;
+}
+
+static char* get_filename(const char* table_filename) {
+  size_t length = strlen(table_filename) + strlen(DICTIONARY_FILE_EXTENSION) + 1;
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for dictionary filename\n");
+    return NULL;
+  }
+  snprintf(filename, length, "%s%s", table_filename, DICTIONARY_FILE_EXTENSION);
+  return filename;
+}
+
+static dictionary_t* allocate_dictionary(const dbms_session_t* session) {
+  dictionary_t* dictionary = calloc(1, sizeof(dictionary_t));
+  if (!dictionary) {
+    fprintf(stderr, "Memory allocation failed for dictionary\n");
+    return NULL;
+  }
+  dictionary->fd = -1;
+
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  dictionary->filename = get_filename(session->filename);
+  dictionary->attribute_count = num_attributes;
+  dictionary->attribute_columns = malloc((num_attributes + 1) * sizeof(int16_t));
+  dictionary->columns = calloc(num_attributes + 1, sizeof(dictionary_column_t));
+  if (!dictionary->filename || !dictionary->attribute_columns || !dictionary->columns) {
+    fprintf(stderr, "Memory allocation failed for dictionary\n");
+    dictionary_free(dictionary);
+    return NULL;
+  }
+
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    dictionary->attribute_columns[i] = -1;
+    if (!dbms_is_dictionary_encoded(session->catalog, i)) {
+      continue;
+    }
+    dictionary_column_t* column = &dictionary->columns[dictionary->column_count];
+    column->attribute_index = i;
+    column->value_size = dbms_get_catalog_record(session->catalog, i)->attribute_size;
+    column->codes = hash_table_init(DICTIONARY_INITIAL_CAPACITY);
+    if (!column->codes) {
+      dictionary_free(dictionary);
+      return NULL;
+    }
+    dictionary->attribute_columns[i] = dictionary->column_count++;
+  }
+  return dictionary;
+}
+
+static const dictionary_column_t* get_column(const dictionary_t* dictionary, uint8_t attribute_index) {
+  if (!dictionary || attribute_index >= dictionary->attribute_count ||
+      dictionary->attribute_columns[attribute_index] < 0) {
+    return NULL;
+  }
+  return &dictionary->columns[dictionary->attribute_columns[attribute_index]];
+}
+
+// FNV-1a over the value's bytes
+static uint64_t hash_value(const char* value, size_t length) {
+  uint64_t hash = FNV_OFFSET_BASIS_64;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)value[i];
+    hash *= FNV_PRIME_64;
+  }
+  return hash;
+}
+
+static bool value_equals(const dictionary_column_t* column, uint32_t code, const char* value, size_t length) {
+  const char* stored = column->values + (size_t)code * column->value_size;
+  return strnlen(stored, column->value_size) == length && memcmp(stored, value, length) == 0;
+}
+
+static uint32_t find_code(const dictionary_column_t* column, const char* value, size_t length) {
+  uint64_t code = 0;
+  if (!hash_table_get(column->codes, hash_value(value, length), &code)) {
+    return DICTIONARY_NO_CODE;
+  }
+  if (value_equals(column, (uint32_t)code, value, length)) {
+    return (uint32_t)code;
+  }
+
+  // Hash collision, only the first value with the hash is in the table
+  for (uint32_t i = 0; i < column->count; i++) {
+    if (value_equals(column, i, value, length)) {
+      return i;
+    }
+  }
+  return DICTIONARY_NO_CODE;
+}
+
+static bool add_value(dictionary_column_t* column, const char* value, size_t length) {
+  if (column->count == column->capacity) {
+    uint32_t capacity = column->capacity ? column->capacity * 2 : DICTIONARY_INITIAL_CAPACITY;
+    char* values = realloc(column->values, (size_t)capacity * column->value_size);
+    if (!values) {
+      fprintf(stderr, "Memory allocation failed for dictionary values\n");
+      return false;
+    }
+    column->values = values;
+    column->capacity = capacity;
+  }
+
+  uint32_t code = column->count;
+  char* stored = column->values + (size_t)code * column->value_size;
+  memset(stored, 0, column->value_size);
+  memcpy(stored, value, length);
+
+  uint64_t hash = hash_value(value, length);
+  uint64_t existing = 0;
+  if (!hash_table_get(column->codes, hash, &existing) && !hash_table_insert(column->codes, hash, code)) {
+    return false;
+  }
+  column->count++;
+  return true;
+}
+
+static bool load_file(dictionary_t* dictionary) {
+  off_t file_size = ssdio_get_file_size(dictionary->fd);
+  if (file_size < DICTIONARY_MAGIC_SIZE) {
+    return false;
+  }
+  char* buffer = malloc(file_size);
+  if (!buffer) {
+    fprintf(stderr, "Memory allocation failed for dictionary file\n");
+    return false;
+  }
+  if (pread(dictionary->fd, buffer, file_size, 0) != file_size ||
+      memcmp(buffer, DICTIONARY_FILE_MAGIC, DICTIONARY_MAGIC_SIZE) != 0) {
+    free(buffer);
+    return false;
+  }
+
+  // A torn last entry is dropped and overwritten by the next one
+  off_t offset = DICTIONARY_MAGIC_SIZE;
+  while (offset < file_size) {
+    uint8_t attribute_index = (uint8_t)buffer[offset];
+    dictionary_column_t* column = (dictionary_column_t*)get_column(dictionary, attribute_index);
+    if (!column) {
+      fprintf(stderr, "Dictionary entry for attribute %u, which is not encoded\n", attribute_index);
+      free(buffer);
+      return false;
+    }
+    if (offset + 1 + column->value_size > file_size) {
+      break;
+    }
+    const char* value = buffer + offset + 1;
+    if (column->count >= DICTIONARY_MAX_CODES || !add_value(column, value, strnlen(value, column->value_size))) {
+      free(buffer);
+      return false;
+    }
+    offset += 1 + column->value_size;
+  }
+
+  free(buffer);
+  dictionary->file_size = offset;
+  return true;
+}
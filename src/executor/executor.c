@@ -2,6 +2,19 @@
 
 #include <stdlib.h>
 
+void* operator_alloc(arena_t* arena, size_t count, size_t size) {
+  if (arena != NULL) {
+    return arena_calloc(arena, count, size);
+  }
+  return calloc(count, size);
+}
+
+void operator_release(const Operator* op, void* ptr) {
+  if (op != NULL && op->arena == NULL) {
+    free(ptr);
+  }
+}
+
 void operator_free(Operator* op) {
   if (!op) {
     return;
@@ -12,7 +25,7 @@ void operator_free(Operator* op) {
     for (int i = 0; i < op->child_count; i++) {
       operator_free(op->children[i]);
     }
-    free(op->children);
+    operator_release(op, op->children);
   }
 
   // Call operator-specific destroy function to clean up internal allocations
@@ -21,10 +34,7 @@ void operator_free(Operator* op) {
   }
 
   // Free the operator's private state struct
-  if (op->state) {
-    free(op->state);
-  }
-
-  free(op);
+  operator_release(op, op->state);
+  operator_release(op, op);
 }
 
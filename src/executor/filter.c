@@ -8,42 +8,52 @@ static void filter_open(Operator* self);
 static tuple_t* filter_next(Operator* self);
 static void filter_close(Operator* self);
 static void filter_reset(Operator* self);
+static void filter_destroy(Operator* self);
 
 // Forward declarations for predicate evaluation
 static bool evaluate_proposition(const attribute_value_t* attribute, const proposition_t* proposition);
-static bool evaluate_criteria(const tuple_t* tuple, const selection_criteria_t* criteria);
+static bool evaluate_criteria(const tuple_t* tuple, const selection_criteria_t* criteria, const uint32_t* codes);
 
-Operator* filter_create(Operator* child, dbms_session_t* session, selection_criteria_t* criteria) {
+Operator* filter_create(Operator* child, dbms_session_t* session, selection_criteria_t* criteria, arena_t* arena) {
   if (!child || !session) {
     return NULL;
   }
 
-  Operator* op = calloc(1, sizeof(Operator));
+  Operator* op = operator_alloc(arena, 1, sizeof(Operator));
   if (!op) {
     return NULL;
   }
+  op->arena = arena;
 
-  FilterState* state = calloc(1, sizeof(FilterState));
+  FilterState* state = operator_alloc(arena, 1, sizeof(FilterState));
   if (!state) {
-    free(op);
+    operator_release(op, op);
     return NULL;
   }
 
   state->session = session;
   state->criteria = criteria;
+  size_t proposition_count = criteria ? criteria->proposition_count : 0;
+  state->proposition_codes = operator_alloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(uint32_t));
+  if (!state->proposition_codes) {
+    operator_release(op, state);
+    operator_release(op, op);
+    return NULL;
+  }
 
   op->state = state;
   op->open = filter_open;
   op->next = filter_next;
   op->close = filter_close;
   op->reset = filter_reset;
-  op->destroy = NULL;  // criteria is not owned by this operator
+  op->destroy = filter_destroy;  // criteria is not owned by this operator, only its codes are
 
   // Set up child relationship
-  op->children = calloc(1, sizeof(Operator*));
+  op->children = operator_alloc(arena, 1, sizeof(Operator*));
   if (!op->children) {
-    free(state);
-    free(op);
+    operator_release(op, state->proposition_codes);
+    operator_release(op, state);
+    operator_release(op, op);
     return NULL;
   }
   op->children[0] = child;
@@ -53,10 +63,14 @@ Operator* filter_create(Operator* child, dbms_session_t* session, selection_crit
 }
 
 static void filter_open(Operator* self) {
-  if (!self || !self->children || self->child_count < 1) {
+  if (!self || !self->state || !self->children || self->child_count < 1) {
     return;
   }
 
+  // The dictionary may have grown since the operator was created
+  FilterState* state = (FilterState*)self->state;
+  query_resolve_codes(state->session, state->criteria, state->proposition_codes);
+
   // Open the child operator
   Operator* child = self->children[0];
   if (child && child->open) {
@@ -85,7 +99,7 @@ static tuple_t* filter_next(Operator* self) {
     }
 
     // Evaluate criteria
-    if (evaluate_criteria(tuple, state->criteria)) {
+    if (evaluate_criteria(tuple, state->criteria, state->proposition_codes)) {
       return tuple;
     }
   }
@@ -106,18 +120,30 @@ static void filter_close(Operator* self) {
 }
 
 static void filter_reset(Operator* self) {
-  if (!self || !self->children || self->child_count < 1) {
+  if (!self || !self->state || !self->children || self->child_count < 1) {
     return;
   }
 
-  // Simply reset the child operator
+  // Reset the child operator, values may have been added to the dictionary in between
+  FilterState* state = (FilterState*)self->state;
+  query_resolve_codes(state->session, state->criteria, state->proposition_codes);
   Operator* child = self->children[0];
   if (child && child->reset) {
     child->reset(child);
   }
 }
 
-static bool evaluate_criteria(const tuple_t* tuple, const selection_criteria_t* criteria) {
+static void filter_destroy(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  FilterState* state = (FilterState*)self->state;
+  operator_release(self, state->proposition_codes);
+  state->proposition_codes = NULL;
+}
+
+static bool evaluate_criteria(const tuple_t* tuple, const selection_criteria_t* criteria, const uint32_t* codes) {
   if (!tuple || !criteria) {
     return false;
   }
@@ -127,7 +153,12 @@ static bool evaluate_criteria(const tuple_t* tuple, const selection_criteria_t*
     const proposition_t* prop = &criteria->propositions[i];
     const attribute_value_t* attr = &tuple->attributes[prop->attribute_index];
 
-    if (!evaluate_proposition(attr, prop)) {
+    // Integer compare on the page codes of a dictionary encoded attribute
+    if (codes[i] != QUERY_COMPARE_VALUES) {
+      if ((attr->dictionary_code == codes[i]) != (prop->operator == OPERATOR_EQUAL)) {
+        return false;
+      }
+    } else if (!evaluate_proposition(attr, prop)) {
       return false;
     }
   }
@@ -0,0 +1,899 @@
+#include "executor/hash_aggregate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data_structures.h"
+#include "dictionary.h"
+
+// ============================================================================
+// Group table (open addressing, linear probing)
+// ============================================================================
+
+#define AGGREGATE_INITIAL_SLOTS 64
+#define AGGREGATE_EMPTY_SLOT UINT32_MAX
+#define AGGREGATE_MAX_STRING_LENGTH 256
+
+typedef struct {
+    int64_t count;
+    int64_t int_value;    // SUM/MIN/MAX of INT inputs
+    double float_value;   // SUM/MIN/MAX of FLOAT inputs, running sum for AVG
+    uint8_t type;         // Input attribute type (set on first row)
+} AggregateAccumulator;
+
+// Slots only hold a hash tag and a group number so probing stays within a few cache lines;
+// the group keys and accumulators live in dense arrays indexed by group number.
+typedef struct {
+    uint32_t hash_tag;
+    uint32_t group;
+} AggregateSlot;
+
+struct AggregateGroupTable {
+    AggregateSlot* slots;
+    size_t slot_count;                    // Power of two
+    uint64_t* hashes;                     // Full hash per group
+    attribute_value_t* keys;              // key_width values per group (strings are owned)
+    AggregateAccumulator* accumulators;   // acc_width accumulators per group
+    size_t group_count;
+    size_t group_capacity;
+    uint8_t key_width;
+    uint8_t acc_width;
+};
+
+struct AggregateSpillPartition {
+    FILE* file;
+    size_t row_count;
+    uint8_t depth;
+    struct AggregateSpillPartition* next;
+};
+
+static AggregateGroupTable* group_table_init(uint8_t key_width, uint8_t acc_width);
+static void group_table_clear(AggregateGroupTable* table);
+static void group_table_free(AggregateGroupTable* table);
+static bool group_table_grow_slots(AggregateGroupTable* table);
+static bool group_table_grow_groups(AggregateGroupTable* table);
+static AggregateAccumulator* group_table_find_or_insert(AggregateGroupTable* table, const attribute_value_t* keys,
+                                                        uint64_t hash, bool allow_insert);
+static uint64_t hash_group_key(const attribute_value_t* keys, uint8_t count);
+static bool group_keys_equal(const attribute_value_t* a, const attribute_value_t* b, uint8_t count);
+
+static AggregateGroupTable* group_table_init(uint8_t key_width, uint8_t acc_width) {
+    AggregateGroupTable* table = calloc(1, sizeof(AggregateGroupTable));
+    if (!table) return NULL;
+
+    table->slot_count = AGGREGATE_INITIAL_SLOTS;
+    table->slots = malloc(table->slot_count * sizeof(AggregateSlot));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    for (size_t i = 0; i < table->slot_count; i++) {
+        table->slots[i].group = AGGREGATE_EMPTY_SLOT;
+    }
+
+    table->key_width = key_width;
+    table->acc_width = acc_width;
+    return table;
+}
+
+static void group_table_clear(AggregateGroupTable* table) {
+    if (!table) return;
+
+    // Free owned group key strings
+    for (size_t g = 0; g < table->group_count; g++) {
+        for (uint8_t k = 0; k < table->key_width; k++) {
+            attribute_value_t* key = &table->keys[g * table->key_width + k];
+            if (key->type == ATTRIBUTE_TYPE_STRING && key->string_value) {
+                free(key->string_value);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < table->slot_count; i++) {
+        table->slots[i].group = AGGREGATE_EMPTY_SLOT;
+    }
+    table->group_count = 0;
+}
+
+static void group_table_free(AggregateGroupTable* table) {
+    if (!table) return;
+
+    group_table_clear(table);
+    free(table->slots);
+    free(table->hashes);
+    free(table->keys);
+    free(table->accumulators);
+    free(table);
+}
+
+static bool group_table_grow_slots(AggregateGroupTable* table) {
+    size_t new_count = table->slot_count * 2;
+    AggregateSlot* new_slots = malloc(new_count * sizeof(AggregateSlot));
+    if (!new_slots) return false;
+
+    for (size_t i = 0; i < new_count; i++) {
+        new_slots[i].group = AGGREGATE_EMPTY_SLOT;
+    }
+
+    // Reinsert every group using its stored hash
+    for (size_t g = 0; g < table->group_count; g++) {
+        size_t pos = table->hashes[g] & (new_count - 1);
+        while (new_slots[pos].group != AGGREGATE_EMPTY_SLOT) {
+            pos = (pos + 1) & (new_count - 1);
+        }
+        new_slots[pos].hash_tag = (uint32_t)(table->hashes[g] >> 32);
+        new_slots[pos].group = (uint32_t)g;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->slot_count = new_count;
+    return true;
+}
+
+static bool group_table_grow_groups(AggregateGroupTable* table) {
+    size_t new_capacity = table->group_capacity ? table->group_capacity * 2 : AGGREGATE_INITIAL_SLOTS / 2;
+
+    uint64_t* new_hashes = realloc(table->hashes, new_capacity * sizeof(uint64_t));
+    if (!new_hashes) return false;
+    table->hashes = new_hashes;
+
+    if (table->key_width > 0) {
+        attribute_value_t* new_keys = realloc(table->keys, new_capacity * table->key_width * sizeof(attribute_value_t));
+        if (!new_keys) return false;
+        table->keys = new_keys;
+    }
+
+    if (table->acc_width > 0) {
+        AggregateAccumulator* new_accs =
+            realloc(table->accumulators, new_capacity * table->acc_width * sizeof(AggregateAccumulator));
+        if (!new_accs) return false;
+        table->accumulators = new_accs;
+    }
+
+    table->group_capacity = new_capacity;
+    return true;
+}
+
+static AggregateAccumulator* group_table_find_or_insert(AggregateGroupTable* table, const attribute_value_t* keys,
+                                                        uint64_t hash, bool allow_insert) {
+    uint32_t tag = (uint32_t)(hash >> 32);
+    size_t mask = table->slot_count - 1;
+    size_t pos = hash & mask;
+
+    while (table->slots[pos].group != AGGREGATE_EMPTY_SLOT) {
+        AggregateSlot* slot = &table->slots[pos];
+        if (slot->hash_tag == tag && table->hashes[slot->group] == hash &&
+            group_keys_equal(&table->keys[(size_t)slot->group * table->key_width], keys, table->key_width)) {
+            return &table->accumulators[(size_t)slot->group * table->acc_width];
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    if (!allow_insert) {
+        return NULL;
+    }
+
+    // Keep the load factor at or below 50%
+    if ((table->group_count + 1) * 2 > table->slot_count) {
+        if (!group_table_grow_slots(table)) return NULL;
+        mask = table->slot_count - 1;
+        pos = hash & mask;
+        while (table->slots[pos].group != AGGREGATE_EMPTY_SLOT) {
+            pos = (pos + 1) & mask;
+        }
+    }
+    if (table->group_count == table->group_capacity && !group_table_grow_groups(table)) {
+        return NULL;
+    }
+
+    size_t group = table->group_count;
+    attribute_value_t* group_keys = &table->keys[group * table->key_width];
+    for (uint8_t k = 0; k < table->key_width; k++) {
+        group_keys[k] = keys[k];
+        if (keys[k].type == ATTRIBUTE_TYPE_STRING) {
+            // Child tuples point into the buffer pool, so group keys need their own copy
+            group_keys[k].string_value = strdup(keys[k].string_value ? keys[k].string_value : "");
+            if (!group_keys[k].string_value) {
+                for (uint8_t j = 0; j < k; j++) {
+                    if (group_keys[j].type == ATTRIBUTE_TYPE_STRING) free(group_keys[j].string_value);
+                }
+                return NULL;
+            }
+        }
+    }
+
+    AggregateAccumulator* accs = &table->accumulators[group * table->acc_width];
+    memset(accs, 0, table->acc_width * sizeof(AggregateAccumulator));
+
+    table->hashes[group] = hash;
+    table->slots[pos].hash_tag = tag;
+    table->slots[pos].group = (uint32_t)group;
+    table->group_count++;
+    return accs;
+}
+
+static uint64_t hash_group_key(const attribute_value_t* keys, uint8_t count) {
+    uint64_t hash = FNV_OFFSET_BASIS_64;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const attribute_value_t* key = &keys[i];
+        switch (key->type) {
+            case ATTRIBUTE_TYPE_INT: {
+                uint32_t val = (uint32_t)key->int_value;
+                for (int b = 0; b < 4; b++) {
+                    hash ^= (val >> (b * 8)) & 0xFF;
+                    hash *= FNV_PRIME_64;
+                }
+                break;
+            }
+            case ATTRIBUTE_TYPE_FLOAT: {
+                union { float f; uint32_t u; } conv;
+                conv.f = key->float_value;
+                for (int b = 0; b < 4; b++) {
+                    hash ^= (conv.u >> (b * 8)) & 0xFF;
+                    hash *= FNV_PRIME_64;
+                }
+                break;
+            }
+            case ATTRIBUTE_TYPE_STRING:
+                if (key->string_value) {
+                    for (const char* p = key->string_value; *p; p++) {
+                        hash ^= (uint8_t)*p;
+                        hash *= FNV_PRIME_64;
+                    }
+                }
+                break;
+            case ATTRIBUTE_TYPE_BOOL:
+                hash ^= key->bool_value ? 1 : 0;
+                hash *= FNV_PRIME_64;
+                break;
+            default:
+                break;
+        }
+        // Column separator so ("ab", "c") and ("a", "bc") hash differently
+        hash ^= 0xFF;
+        hash *= FNV_PRIME_64;
+    }
+
+    // Final avalanche so the low bits (slot index) and high bits (spill partition) are both well mixed
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static bool group_keys_equal(const attribute_value_t* a, const attribute_value_t* b, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (a[i].type != b[i].type) return false;
+
+        switch (a[i].type) {
+            case ATTRIBUTE_TYPE_INT:
+                if (a[i].int_value != b[i].int_value) return false;
+                break;
+            case ATTRIBUTE_TYPE_FLOAT:
+                if (a[i].float_value != b[i].float_value) return false;
+                break;
+            case ATTRIBUTE_TYPE_STRING:
+                if (strcmp(a[i].string_value ? a[i].string_value : "", b[i].string_value ? b[i].string_value : "") != 0) {
+                    return false;
+                }
+                break;
+            case ATTRIBUTE_TYPE_BOOL:
+                if (a[i].bool_value != b[i].bool_value) return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Spill partitions
+// ============================================================================
+
+static bool spill_write_value(FILE* file, const attribute_value_t* value);
+static bool spill_read_value(FILE* file, attribute_value_t* value, char* string_buffer);
+static bool spill_row(HashAggregateState* state, uint64_t hash);
+static void spill_release_list(AggregateSpillPartition* list);
+static void spill_release_active(HashAggregateState* state);
+static void spill_retire_active(HashAggregateState* state);
+
+static bool spill_write_value(FILE* file, const attribute_value_t* value) {
+    uint8_t type = value->type;
+    if (fwrite(&type, sizeof(type), 1, file) != 1) return false;
+
+    switch (type) {
+        case ATTRIBUTE_TYPE_INT:
+            return fwrite(&value->int_value, sizeof(value->int_value), 1, file) == 1;
+        case ATTRIBUTE_TYPE_FLOAT:
+            return fwrite(&value->float_value, sizeof(value->float_value), 1, file) == 1;
+        case ATTRIBUTE_TYPE_BOOL: {
+            uint8_t b = value->bool_value ? 1 : 0;
+            return fwrite(&b, sizeof(b), 1, file) == 1;
+        }
+        case ATTRIBUTE_TYPE_STRING: {
+            const char* str = value->string_value ? value->string_value : "";
+            uint16_t length = (uint16_t)strnlen(str, AGGREGATE_MAX_STRING_LENGTH - 1);
+            if (fwrite(&length, sizeof(length), 1, file) != 1) return false;
+            return length == 0 || fwrite(str, 1, length, file) == length;
+        }
+        default:
+            return true;
+    }
+}
+
+static bool spill_read_value(FILE* file, attribute_value_t* value, char* string_buffer) {
+    uint8_t type;
+    if (fread(&type, sizeof(type), 1, file) != 1) return false;
+    value->type = type;
+
+    switch (type) {
+        case ATTRIBUTE_TYPE_INT:
+            return fread(&value->int_value, sizeof(value->int_value), 1, file) == 1;
+        case ATTRIBUTE_TYPE_FLOAT:
+            return fread(&value->float_value, sizeof(value->float_value), 1, file) == 1;
+        case ATTRIBUTE_TYPE_BOOL: {
+            uint8_t b;
+            if (fread(&b, sizeof(b), 1, file) != 1) return false;
+            value->bool_value = (b != 0);
+            return true;
+        }
+        case ATTRIBUTE_TYPE_STRING: {
+            uint16_t length;
+            if (fread(&length, sizeof(length), 1, file) != 1) return false;
+            if (length >= AGGREGATE_MAX_STRING_LENGTH) return false;
+            if (length > 0 && fread(string_buffer, 1, length, file) != length) return false;
+            string_buffer[length] = '\0';
+            value->string_value = string_buffer;
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+static bool spill_row(HashAggregateState* state, uint64_t hash) {
+    if (!state->active) {
+        state->active = calloc(HASH_AGGREGATE_SPILL_PARTITIONS, sizeof(AggregateSpillPartition));
+        if (!state->active) return false;
+    }
+
+    // Use the next unused group of high hash bits so each level splits the overflow further
+    unsigned shift = 64 - HASH_AGGREGATE_SPILL_BITS * (state->spill_depth + 1);
+    size_t partition_index = (hash >> shift) & (HASH_AGGREGATE_SPILL_PARTITIONS - 1);
+    AggregateSpillPartition* partition = &state->active[partition_index];
+
+    if (!partition->file) {
+        partition->file = tmpfile();
+        if (!partition->file) {
+            fprintf(stderr, "Failed to create HashAggregate spill file\n");
+            return false;
+        }
+        partition->depth = state->spill_depth + 1;
+    }
+
+    if (fwrite(&hash, sizeof(hash), 1, partition->file) != 1) return false;
+    for (uint8_t i = 0; i < state->group_count; i++) {
+        if (!spill_write_value(partition->file, &state->key_scratch[i])) return false;
+    }
+    for (uint8_t i = 0; i < state->aggregate_count; i++) {
+        if (!spill_write_value(partition->file, &state->input_scratch[i])) return false;
+    }
+
+    partition->row_count++;
+    state->spilled_rows++;
+    return true;
+}
+
+static void spill_release_list(AggregateSpillPartition* list) {
+    while (list) {
+        AggregateSpillPartition* next = list->next;
+        if (list->file) fclose(list->file);
+        free(list);
+        list = next;
+    }
+}
+
+static void spill_release_active(HashAggregateState* state) {
+    if (!state->active) return;
+
+    for (size_t i = 0; i < HASH_AGGREGATE_SPILL_PARTITIONS; i++) {
+        if (state->active[i].file) fclose(state->active[i].file);
+    }
+    free(state->active);
+    state->active = NULL;
+}
+
+// Moves the non-empty partitions written during the current pass onto the pending list
+static void spill_retire_active(HashAggregateState* state) {
+    if (!state->active) return;
+
+    for (size_t i = 0; i < HASH_AGGREGATE_SPILL_PARTITIONS; i++) {
+        AggregateSpillPartition* partition = &state->active[i];
+        if (!partition->file) continue;
+
+        AggregateSpillPartition* pending = malloc(sizeof(AggregateSpillPartition));
+        if (!pending) {
+            fprintf(stderr, "Memory allocation failed for HashAggregate spill partition\n");
+            fclose(partition->file);
+            partition->file = NULL;
+            continue;
+        }
+        *pending = *partition;
+        rewind(pending->file);
+        pending->next = state->pending;
+        state->pending = pending;
+        partition->file = NULL;
+    }
+    free(state->active);
+    state->active = NULL;
+}
+
+// ============================================================================
+// Aggregation
+// ============================================================================
+
+static void accumulate(const aggregate_t* aggregate, AggregateAccumulator* acc, const attribute_value_t* input);
+static bool aggregate_row(HashAggregateState* state);
+static bool build_from_child(HashAggregateState* state, Operator* child);
+static bool build_from_partition(HashAggregateState* state, AggregateSpillPartition* partition);
+static void fill_output(HashAggregateState* state, size_t group);
+
+static void accumulate(const aggregate_t* aggregate, AggregateAccumulator* acc, const attribute_value_t* input) {
+    if (aggregate->function == AGGREGATE_COUNT) {
+        acc->count++;
+        return;
+    }
+
+    bool first = (acc->count == 0);
+    acc->type = input->type;
+
+    switch (input->type) {
+        case ATTRIBUTE_TYPE_INT: {
+            int64_t v = input->int_value;
+            switch (aggregate->function) {
+                case AGGREGATE_SUM:
+                    acc->int_value += v;
+                    break;
+                case AGGREGATE_MIN:
+                    if (first || v < acc->int_value) acc->int_value = v;
+                    break;
+                case AGGREGATE_MAX:
+                    if (first || v > acc->int_value) acc->int_value = v;
+                    break;
+                case AGGREGATE_AVG:
+                    acc->float_value += (double)v;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+        case ATTRIBUTE_TYPE_FLOAT: {
+            double v = input->float_value;
+            switch (aggregate->function) {
+                case AGGREGATE_SUM:
+                case AGGREGATE_AVG:
+                    acc->float_value += v;
+                    break;
+                case AGGREGATE_MIN:
+                    if (first || v < acc->float_value) acc->float_value = v;
+                    break;
+                case AGGREGATE_MAX:
+                    if (first || v > acc->float_value) acc->float_value = v;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+        default:
+            // Unsupported input types are ignored (rejected by hash_aggregate_supports)
+            return;
+    }
+    acc->count++;
+}
+
+// Aggregates the row currently held in key_scratch/input_scratch
+static bool aggregate_row(HashAggregateState* state) {
+    uint64_t hash = hash_group_key(state->key_scratch, state->group_count);
+
+    // Once the budget is reached, rows of unseen groups are spilled instead of creating new groups.
+    // The deepest level keeps everything in memory so pathological inputs still terminate.
+    bool allow_insert = state->groups->group_count < state->max_groups ||
+                        state->spill_depth >= HASH_AGGREGATE_MAX_SPILL_DEPTH;
+    AggregateAccumulator* accs =
+        group_table_find_or_insert(state->groups, state->key_scratch, hash, allow_insert);
+    if (!accs) {
+        if (allow_insert) {
+            fprintf(stderr, "Memory allocation failed for HashAggregate group\n");
+            return false;
+        }
+        return spill_row(state, hash);
+    }
+
+    for (uint8_t i = 0; i < state->aggregate_count; i++) {
+        accumulate(&state->aggregates[i], &accs[i], &state->input_scratch[i]);
+    }
+    return true;
+}
+
+static bool build_from_child(HashAggregateState* state, Operator* child) {
+    tuple_t* tuple;
+    while ((tuple = child->next(child)) != NULL) {
+        // Shallow copies: strings still point into the buffer pool until the group is created,
+        // encoded strings are grouped as the integer of their code
+        for (uint8_t i = 0; i < state->group_count; i++) {
+            const attribute_value_t* key = &tuple->attributes[state->group_indices[i]];
+            if (state->encoded_groups[i]) {
+                state->key_scratch[i] = (attribute_value_t){.type = ATTRIBUTE_TYPE_INT,
+                                                            .int_value = (int32_t)key->dictionary_code};
+            } else {
+                state->key_scratch[i] = *key;
+            }
+        }
+        for (uint8_t i = 0; i < state->aggregate_count; i++) {
+            uint8_t attribute_index = state->aggregates[i].attribute_index;
+            if (attribute_index == AGGREGATE_COUNT_STAR) {
+                state->input_scratch[i] = (attribute_value_t){.type = ATTRIBUTE_TYPE_UNUSED};
+            } else {
+                state->input_scratch[i] = tuple->attributes[attribute_index];
+            }
+        }
+
+        if (!aggregate_row(state)) {
+            return false;
+        }
+    }
+
+    // Without GROUP BY an empty input still produces a single row (COUNT = 0)
+    if (state->group_count == 0 && state->groups->group_count == 0) {
+        if (!group_table_find_or_insert(state->groups, NULL, hash_group_key(NULL, 0), true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool build_from_partition(HashAggregateState* state, AggregateSpillPartition* partition) {
+    char* strings = malloc((size_t)(state->group_count + state->aggregate_count) * AGGREGATE_MAX_STRING_LENGTH);
+    if (!strings && state->group_count + state->aggregate_count > 0) {
+        return false;
+    }
+
+    state->spill_depth = partition->depth;
+    for (size_t row = 0; row < partition->row_count; row++) {
+        uint64_t hash;
+        bool ok = fread(&hash, sizeof(hash), 1, partition->file) == 1;
+        for (uint8_t i = 0; ok && i < state->group_count; i++) {
+            ok = spill_read_value(partition->file, &state->key_scratch[i], strings + i * AGGREGATE_MAX_STRING_LENGTH);
+        }
+        for (uint8_t i = 0; ok && i < state->aggregate_count; i++) {
+            char* buffer = strings + (state->group_count + i) * AGGREGATE_MAX_STRING_LENGTH;
+            ok = spill_read_value(partition->file, &state->input_scratch[i], buffer);
+        }
+        if (!ok) {
+            fprintf(stderr, "Failed to read HashAggregate spill file\n");
+            free(strings);
+            return false;
+        }
+
+        if (!aggregate_row(state)) {
+            free(strings);
+            return false;
+        }
+    }
+
+    free(strings);
+    return true;
+}
+
+static void fill_output(HashAggregateState* state, size_t group) {
+    AggregateGroupTable* table = state->groups;
+    attribute_value_t* keys = &table->keys[group * table->key_width];
+    AggregateAccumulator* accs = &table->accumulators[group * table->acc_width];
+
+    // Group columns (shallow, strings are owned by the group table), encoded ones are decoded from their code
+    for (uint8_t i = 0; i < state->group_count; i++) {
+        if (!state->encoded_groups[i]) {
+            state->output_attrs[i] = keys[i];
+            continue;
+        }
+        uint8_t attribute_index = state->group_indices[i];
+        uint32_t code = (uint32_t)keys[i].int_value;
+        size_t size = dbms_get_catalog_record(state->session->catalog, attribute_index)->attribute_size;
+        char* value = state->group_strings + (size_t)i * AGGREGATE_MAX_STRING_LENGTH;
+        strncpy(value, dictionary_decode(state->session->dictionary, attribute_index, code), size);
+        value[size] = '\0';
+        state->output_attrs[i] =
+            (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING, .dictionary_code = code, .string_value = value};
+    }
+
+    for (uint8_t i = 0; i < state->aggregate_count; i++) {
+        attribute_value_t* out = &state->output_attrs[state->group_count + i];
+        AggregateAccumulator* acc = &accs[i];
+
+        switch (state->aggregates[i].function) {
+            case AGGREGATE_COUNT:
+                out->type = ATTRIBUTE_TYPE_INT;
+                out->int_value = acc->count > INT32_MAX ? INT32_MAX : (int32_t)acc->count;
+                break;
+            case AGGREGATE_AVG:
+                out->type = ATTRIBUTE_TYPE_FLOAT;
+                out->float_value = acc->count > 0 ? (float)(acc->float_value / (double)acc->count) : 0.0f;
+                break;
+            default:
+                if (acc->type == ATTRIBUTE_TYPE_FLOAT) {
+                    out->type = ATTRIBUTE_TYPE_FLOAT;
+                    out->float_value = (float)acc->float_value;
+                } else {
+                    // INT results are 32-bit, saturate rather than wrap
+                    out->type = ATTRIBUTE_TYPE_INT;
+                    int64_t v = acc->int_value;
+                    out->int_value = v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+                }
+                break;
+        }
+    }
+}
+
+// ============================================================================
+// HashAggregate operator implementation
+// ============================================================================
+
+// Forward declarations for iterator interface
+static void hash_aggregate_open(Operator* self);
+static tuple_t* hash_aggregate_next(Operator* self);
+static void hash_aggregate_close(Operator* self);
+static void hash_aggregate_reset(Operator* self);
+static void hash_aggregate_destroy(Operator* self);
+static void hash_aggregate_discard(HashAggregateState* state);
+
+bool hash_aggregate_supports(uint8_t function, uint8_t attribute_type) {
+    switch (function) {
+        case AGGREGATE_COUNT:
+            return true;
+        case AGGREGATE_SUM:
+        case AGGREGATE_MIN:
+        case AGGREGATE_MAX:
+        case AGGREGATE_AVG:
+            return attribute_type == ATTRIBUTE_TYPE_INT || attribute_type == ATTRIBUTE_TYPE_FLOAT;
+        default:
+            return false;
+    }
+}
+
+const char* hash_aggregate_function_name(uint8_t function) {
+    switch (function) {
+        case AGGREGATE_COUNT:
+            return "count";
+        case AGGREGATE_SUM:
+            return "sum";
+        case AGGREGATE_MIN:
+            return "min";
+        case AGGREGATE_MAX:
+            return "max";
+        case AGGREGATE_AVG:
+            return "avg";
+        default:
+            return "unknown";
+    }
+}
+
+Operator* hash_aggregate_create(Operator* child, dbms_session_t* session,
+                                uint8_t* group_indices, uint8_t group_count,
+                                aggregate_t* aggregates, uint8_t aggregate_count,
+                                size_t max_groups, arena_t* arena) {
+    if (!child || !session || (group_count > 0 && !group_indices) || !aggregates || aggregate_count == 0) {
+        return NULL;
+    }
+    if ((size_t)group_count + aggregate_count > UINT8_MAX) {
+        return NULL;
+    }
+
+    Operator* op = operator_alloc(arena, 1, sizeof(Operator));
+    if (!op) {
+        return NULL;
+    }
+    op->arena = arena;
+
+    HashAggregateState* state = operator_alloc(arena, 1, sizeof(HashAggregateState));
+    if (!state) {
+        operator_release(op, op);
+        return NULL;
+    }
+    op->state = state;
+    op->destroy = hash_aggregate_destroy;
+
+    state->session = session;
+    state->group_count = group_count;
+    state->aggregate_count = aggregate_count;
+    state->max_groups = max_groups ? max_groups : HASH_AGGREGATE_DEFAULT_MAX_GROUPS;
+
+    // Copy caller arrays
+    state->group_indices = operator_alloc(arena, group_count > 0 ? group_count : 1, sizeof(uint8_t));
+    state->encoded_groups = operator_alloc(arena, group_count > 0 ? group_count : 1, sizeof(bool));
+    state->group_strings = operator_alloc(arena, group_count > 0 ? group_count : 1, AGGREGATE_MAX_STRING_LENGTH);
+    state->aggregates = operator_alloc(arena, aggregate_count, sizeof(aggregate_t));
+    state->key_scratch = operator_alloc(arena, group_count > 0 ? group_count : 1, sizeof(attribute_value_t));
+    state->input_scratch = operator_alloc(arena, aggregate_count, sizeof(attribute_value_t));
+    state->output_attrs = operator_alloc(arena, group_count + aggregate_count, sizeof(attribute_value_t));
+    state->groups = group_table_init(group_count, aggregate_count);
+    op->children = operator_alloc(arena, 1, sizeof(Operator*));
+    if (!state->group_indices || !state->encoded_groups || !state->group_strings || !state->aggregates || !state->key_scratch || !state->input_scratch ||
+        !state->output_attrs || !state->groups || !op->children) {
+        // Child is not owned until creation succeeds
+        operator_free(op);
+        return NULL;
+    }
+    if (group_count > 0) {
+        memcpy(state->group_indices, group_indices, group_count * sizeof(uint8_t));
+    }
+    for (uint8_t i = 0; i < group_count; i++) {
+        state->encoded_groups[i] = dbms_is_dictionary_encoded(session->catalog, group_indices[i]) &&
+                                   session->dictionary;
+    }
+    memcpy(state->aggregates, aggregates, aggregate_count * sizeof(aggregate_t));
+
+    // Initialize the output tuple
+    state->output_tuple.id.page_id = 0;
+    state->output_tuple.id.slot_id = 0;
+    state->output_tuple.is_null = false;
+    state->output_tuple.attributes = state->output_attrs;
+
+    op->open = hash_aggregate_open;
+    op->next = hash_aggregate_next;
+    op->close = hash_aggregate_close;
+    op->reset = hash_aggregate_reset;
+
+    op->children[0] = child;
+    op->child_count = 1;
+
+    return op;
+}
+
+static void hash_aggregate_open(Operator* self) {
+    if (!self || !self->state || !self->children || self->child_count < 1) {
+        return;
+    }
+
+    HashAggregateState* state = (HashAggregateState*)self->state;
+    hash_aggregate_discard(state);
+
+    // Open the child operator, the group table is built lazily on the first next()
+    Operator* child = self->children[0];
+    if (child && child->open) {
+        child->open(child);
+    }
+}
+
+static tuple_t* hash_aggregate_next(Operator* self) {
+    if (!self || !self->state || !self->children || self->child_count < 1) {
+        return NULL;
+    }
+
+    HashAggregateState* state = (HashAggregateState*)self->state;
+    Operator* child = self->children[0];
+    if (!child || !child->next) {
+        return NULL;
+    }
+
+    // Blocking operator: drain the child before emitting anything
+    if (!state->built) {
+        state->built = true;
+        state->spill_depth = 0;
+        if (!build_from_child(state, child)) {
+            fprintf(stderr, "HashAggregate failed while consuming input\n");
+            hash_aggregate_discard(state);
+            state->built = true;
+            return NULL;
+        }
+    }
+
+    while (true) {
+        if (state->emit_index < state->groups->group_count) {
+            fill_output(state, state->emit_index++);
+            return &state->output_tuple;
+        }
+
+        // Current pass exhausted, aggregate the next spilled partition (if any)
+        spill_retire_active(state);
+        if (!state->pending) {
+            return NULL;
+        }
+
+        AggregateSpillPartition* partition = state->pending;
+        state->pending = partition->next;
+        partition->next = NULL;
+
+        group_table_clear(state->groups);
+        state->emit_index = 0;
+        bool ok = build_from_partition(state, partition);
+        spill_release_list(partition);
+        if (!ok) {
+            hash_aggregate_discard(state);
+            state->built = true;
+            return NULL;
+        }
+    }
+}
+
+static void hash_aggregate_close(Operator* self) {
+    if (!self || !self->state || !self->children || self->child_count < 1) {
+        return;
+    }
+
+    // Release spill files eagerly, groups are kept until destroy/reset
+    HashAggregateState* state = (HashAggregateState*)self->state;
+    spill_release_active(state);
+    spill_release_list(state->pending);
+    state->pending = NULL;
+
+    // Close the child operator
+    Operator* child = self->children[0];
+    if (child && child->close) {
+        child->close(child);
+    }
+}
+
+static void hash_aggregate_reset(Operator* self) {
+    if (!self || !self->state || !self->children || self->child_count < 1) {
+        return;
+    }
+
+    HashAggregateState* state = (HashAggregateState*)self->state;
+
+    // Reset the child operator and rebuild on the next call
+    Operator* child = self->children[0];
+    if (child && child->reset) {
+        child->reset(child);
+    }
+    hash_aggregate_discard(state);
+}
+
+// Drops all groups and spill files so the next call to next() rebuilds from the child
+static void hash_aggregate_discard(HashAggregateState* state) {
+    group_table_clear(state->groups);
+    spill_release_active(state);
+    spill_release_list(state->pending);
+    state->pending = NULL;
+    state->built = false;
+    state->emit_index = 0;
+    state->spill_depth = 0;
+    state->spilled_rows = 0;
+}
+
+static void hash_aggregate_destroy(Operator* self) {
+    if (!self || !self->state) {
+        return;
+    }
+
+    HashAggregateState* state = (HashAggregateState*)self->state;
+
+    spill_release_active(state);
+    spill_release_list(state->pending);
+    state->pending = NULL;
+
+    if (state->groups) {
+        group_table_free(state->groups);
+        state->groups = NULL;
+    }
+
+    operator_release(self, state->group_indices);
+    operator_release(self, state->encoded_groups);
+    operator_release(self, state->group_strings);
+    operator_release(self, state->aggregates);
+    operator_release(self, state->key_scratch);
+    operator_release(self, state->input_scratch);
+    operator_release(self, state->output_attrs);
+    state->group_indices = NULL;
+    state->encoded_groups = NULL;
+    state->group_strings = NULL;
+    state->aggregates = NULL;
+    state->key_scratch = NULL;
+    state->input_scratch = NULL;
+    state->output_attrs = NULL;
+}
@@ -0,0 +1,360 @@
+#include "executor/index_scan.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "index.h"
+#include "stats.h"
+
+// Forward declarations for iterator interface
+static void index_scan_open(Operator* self);
+static tuple_t* index_scan_next(Operator* self);
+static void index_scan_close(Operator* self);
+static void index_scan_reset(Operator* self);
+static void index_scan_destroy(Operator* self);
+
+static Operator* allocate_index_scan(dbms_session_t* session, uint8_t attribute_index, arena_t* arena);
+static bool is_range_operator(const proposition_t* proposition, const btree_t* btree);
+static bool bound_matches(const attribute_value_t* attribute, const proposition_t* bound);
+static void release_position(IndexScanState* state);
+
+Operator* index_scan_create(dbms_session_t* session, const proposition_t* proposition, arena_t* arena) {
+  if (!session || !proposition || proposition->operator != OPERATOR_EQUAL || !session->indexes ||
+      !session->indexes[proposition->attribute_index]) {
+    return NULL;
+  }
+
+  Operator* op = allocate_index_scan(session, proposition->attribute_index, arena);
+  if (!op) {
+    return NULL;
+  }
+  IndexScanState* state = (IndexScanState*)op->state;
+  state->index = session->indexes[proposition->attribute_index];
+  state->keys[0] = proposition->value;
+  return op;
+}
+
+Operator* index_scan_create_for_criteria(dbms_session_t* session, const selection_criteria_t* criteria,
+                                         arena_t* arena) {
+  if (!session || !criteria) {
+    return NULL;
+  }
+
+  // Pick the B+tree attribute that the most propositions narrow down, or with statistics the most selective one
+  int best_attribute = -1;
+  size_t best_count = 0;
+  double best_selectivity = 2.0;
+  if (session->btrees) {
+    uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+    for (uint8_t i = 0; i < num_attributes; i++) {
+      size_t count = 0;
+      for (size_t j = 0; j < criteria->proposition_count; j++) {
+        const proposition_t* proposition = &criteria->propositions[j];
+        if (proposition->attribute_index == i && is_range_operator(proposition, session->btrees[i])) {
+          count++;
+        }
+      }
+      if (count == 0) {
+        continue;
+      }
+      double selectivity = stats_attribute_selectivity(session, criteria, i);
+      if (session->stats ? selectivity < best_selectivity : count > best_count) {
+        best_attribute = i;
+        best_count = count;
+        best_selectivity = selectivity;
+      }
+    }
+  }
+
+  // A range too wide to beat a sequential scan leaves it to the hash indexes, or to the SeqScan
+  if (best_attribute >= 0) {
+    const btree_t* btree = session->btrees[best_attribute];
+    double leaves = stats_row_count(session) * best_selectivity / BTREE_LEAF_CAPACITY;
+    if (!stats_prefer_index_scan(session, best_selectivity, btree->height + leaves)) {
+      best_attribute = -1;
+    }
+  }
+
+  if (best_attribute < 0) {
+    attribute_value_t keys[INDEX_MAX_ATTRIBUTES];
+    index_t* index = query_find_hash_index(session, criteria, keys);
+    if (!index) {
+      return NULL;
+    }
+    Operator* op = allocate_index_scan(session, index->attribute_indexes[0], arena);
+    if (!op) {
+      return NULL;
+    }
+    IndexScanState* state = (IndexScanState*)op->state;
+    state->index = index;
+    memcpy(state->keys, keys, index->attribute_count * sizeof(attribute_value_t));
+    return op;
+  }
+
+  Operator* op = allocate_index_scan(session, (uint8_t)best_attribute, arena);
+  if (!op) {
+    return NULL;
+  }
+  IndexScanState* state = (IndexScanState*)op->state;
+  state->bounds = operator_alloc(arena, best_count, sizeof(proposition_t));
+  if (!state->bounds) {
+    operator_free(op);
+    return NULL;
+  }
+
+  // Fold the bounds into one inclusive key range, bound_matches handles strictness and string prefixes
+  state->btree = session->btrees[best_attribute];
+  state->low_key = 0;
+  state->high_key = UINT64_MAX;
+  for (size_t j = 0; j < criteria->proposition_count; j++) {
+    const proposition_t* proposition = &criteria->propositions[j];
+    if (proposition->attribute_index != best_attribute || !is_range_operator(proposition, state->btree)) {
+      continue;
+    }
+
+    uint64_t key = btree_normalize_key(&proposition->value);
+    bool is_upper = proposition->operator == OPERATOR_LESS_THAN || proposition->operator == OPERATOR_LESS_EQUAL;
+    bool is_lower = proposition->operator == OPERATOR_GREATER_THAN || proposition->operator == OPERATOR_GREATER_EQUAL;
+    if (!is_upper && key > state->low_key) {
+      state->low_key = key;
+    }
+    if (!is_lower && key < state->high_key) {
+      state->high_key = key;
+    }
+    state->bounds[state->bound_count++] = *proposition;
+  }
+  return op;
+}
+
+const proposition_t* index_scan_find_proposition(const dbms_session_t* session, const selection_criteria_t* criteria) {
+  if (!session || !criteria || !session->indexes) {
+    return NULL;
+  }
+
+  for (size_t i = 0; i < criteria->proposition_count; i++) {
+    const proposition_t* proposition = &criteria->propositions[i];
+    if (proposition->operator == OPERATOR_EQUAL && session->indexes[proposition->attribute_index]) {
+      return proposition;
+    }
+  }
+  return NULL;
+}
+
+static Operator* allocate_index_scan(dbms_session_t* session, uint8_t attribute_index, arena_t* arena) {
+  Operator* op = operator_alloc(arena, 1, sizeof(Operator));
+  if (!op) {
+    return NULL;
+  }
+  op->arena = arena;
+
+  IndexScanState* state = operator_alloc(arena, 1, sizeof(IndexScanState));
+  if (!state) {
+    operator_release(op, op);
+    return NULL;
+  }
+
+  state->session = session;
+  state->attribute_index = attribute_index;
+  state->index = NULL;
+  memset(state->keys, 0, sizeof(state->keys));
+  state->btree = NULL;
+  state->low_key = 0;
+  state->high_key = 0;
+  state->bounds = NULL;
+  state->bound_count = 0;
+  state->tuple_ids = NULL;
+  state->tuple_id_count = 0;
+  state->position = 0;
+  state->current_buffer_page = NULL;
+
+  op->state = state;
+  op->open = index_scan_open;
+  op->next = index_scan_next;
+  op->close = index_scan_close;
+  op->reset = index_scan_reset;
+  op->destroy = index_scan_destroy;  // Lookup results live on the heap
+  op->children = NULL;
+  op->child_count = 0;
+
+  return op;
+}
+
+static void index_scan_open(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  IndexScanState* state = (IndexScanState*)self->state;
+  release_position(state);
+  free(state->tuple_ids);
+  state->tuple_ids = NULL;
+  state->tuple_id_count = 0;
+
+  // Either index maps keys to tuple IDs, visit them in page order
+  if (state->btree) {
+    state->tuple_ids =
+        btree_range(state->session, state->btree, state->low_key, state->high_key, &state->tuple_id_count);
+    index_sort_tuple_ids(state->tuple_ids, state->tuple_id_count);
+  } else if (state->index) {
+    state->tuple_ids = index_lookup(state->index, state->keys, &state->tuple_id_count);
+    index_sort_tuple_ids(state->tuple_ids, state->tuple_id_count);
+  }
+}
+
+static tuple_t* index_scan_next(Operator* self) {
+  if (!self || !self->state) {
+    return NULL;
+  }
+
+  IndexScanState* state = (IndexScanState*)self->state;
+
+  while (state->position < state->tuple_id_count) {
+    tuple_id_t tuple_id = state->tuple_ids[state->position++];
+    if (tuple_id.page_id == 0 || tuple_id.page_id > state->session->page_count) {
+      continue;
+    }
+
+    // Only move the pin when the page changes, sorted IDs keep each page pinned once
+    if (!state->current_buffer_page || state->current_buffer_page->page_id != tuple_id.page_id) {
+      if (state->current_buffer_page) {
+        dbms_unpin_page(state->session, state->current_buffer_page);
+      }
+      state->current_buffer_page = dbms_pin_page(state->session, tuple_id.page_id);
+      if (!state->current_buffer_page) {
+        return NULL;
+      }
+    }
+
+    if (tuple_id.slot_id >= state->current_buffer_page->page->tuples_per_page) {
+      continue;
+    }
+    tuple_t* tuple = &state->current_buffer_page->tuples[tuple_id.slot_id];
+    if (tuple->is_null) {
+      continue;
+    }
+
+    // Hash index lookups are exact
+    if (!state->btree) {
+      return tuple;
+    }
+
+    // Range keys are inclusive (and only prefixes for strings), check the original bounds
+    const attribute_value_t* attribute = &tuple->attributes[state->attribute_index];
+    bool matches = true;
+    for (size_t i = 0; i < state->bound_count && matches; i++) {
+      matches = bound_matches(attribute, &state->bounds[i]);
+    }
+    if (matches) {
+      return tuple;
+    }
+  }
+
+  // Matches exhausted, let go of the last page
+  release_position(state);
+  return NULL;
+}
+
+static void index_scan_close(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  IndexScanState* state = (IndexScanState*)self->state;
+  release_position(state);
+  free(state->tuple_ids);
+  state->tuple_ids = NULL;
+  state->tuple_id_count = 0;
+  state->position = 0;
+}
+
+static void index_scan_reset(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  // Restart over the same lookup results
+  IndexScanState* state = (IndexScanState*)self->state;
+  release_position(state);
+  state->position = 0;
+}
+
+static void index_scan_destroy(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  IndexScanState* state = (IndexScanState*)self->state;
+  release_position(state);
+  free(state->tuple_ids);
+  state->tuple_ids = NULL;
+  operator_release(self, state->bounds);
+  state->bounds = NULL;
+}
+
+static void release_position(IndexScanState* state) {
+  if (state->current_buffer_page) {
+    dbms_unpin_page(state->session, state->current_buffer_page);
+    state->current_buffer_page = NULL;
+  }
+}
+
+static bool is_range_operator(const proposition_t* proposition, const btree_t* btree) {
+  if (!btree || proposition->value.type != btree->attribute_type) {
+    return false;
+  }
+
+  switch (proposition->operator) {
+    case OPERATOR_EQUAL:
+    case OPERATOR_LESS_THAN:
+    case OPERATOR_LESS_EQUAL:
+    case OPERATOR_GREATER_THAN:
+    case OPERATOR_GREATER_EQUAL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool bound_matches(const attribute_value_t* attribute, const proposition_t* bound) {
+  const attribute_value_t* value = &bound->value;
+  if (attribute->type != value->type) {
+    return false;
+  }
+
+  int order = 0;
+  switch (value->type) {
+    case ATTRIBUTE_TYPE_INT:
+      order = (attribute->int_value > value->int_value) - (attribute->int_value < value->int_value);
+      break;
+    case ATTRIBUTE_TYPE_FLOAT:
+      order = (attribute->float_value > value->float_value) - (attribute->float_value < value->float_value);
+      break;
+    case ATTRIBUTE_TYPE_STRING:
+      if (!attribute->string_value || !value->string_value) {
+        return false;
+      }
+      order = strcmp(attribute->string_value, value->string_value);
+      break;
+    case ATTRIBUTE_TYPE_BOOL:
+      order = (int)attribute->bool_value - (int)value->bool_value;
+      break;
+    default:
+      return false;
+  }
+
+  switch (bound->operator) {
+    case OPERATOR_EQUAL:
+      return order == 0;
+    case OPERATOR_LESS_THAN:
+      return order < 0;
+    case OPERATOR_LESS_EQUAL:
+      return order <= 0;
+    case OPERATOR_GREATER_THAN:
+      return order > 0;
+    case OPERATOR_GREATER_EQUAL:
+      return order >= 0;
+    default:
+      return false;
+  }
+}
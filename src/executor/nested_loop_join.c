@@ -1,6 +1,7 @@
 #include "executor/nested_loop_join.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 // Forward declarations for iterator interface
 static void nested_loop_join_open(Operator* self);
@@ -8,23 +9,27 @@ static tuple_t* nested_loop_join_next(Operator* self);
 static void nested_loop_join_close(Operator* self);
 static void nested_loop_join_reset(Operator* self);
 static void nested_loop_join_destroy(Operator* self);
+static tuple_t* next_outer_tuple(NestedLoopJoinState* state, Operator* outer);
+static bool join_values_equal(const attribute_value_t* a, const attribute_value_t* b);
 
 Operator* nested_loop_join_create(Operator* outer, Operator* inner,
                                   dbms_session_t* session,
                                   uint8_t outer_column_count,
-                                  uint8_t inner_column_count) {
+                                  uint8_t inner_column_count,
+                                  arena_t* arena) {
     if (!outer || !inner || !session) {
         return NULL;
     }
 
-    Operator* op = calloc(1, sizeof(Operator));
+    Operator* op = operator_alloc(arena, 1, sizeof(Operator));
     if (!op) {
         return NULL;
     }
+    op->arena = arena;
 
-    NestedLoopJoinState* state = calloc(1, sizeof(NestedLoopJoinState));
+    NestedLoopJoinState* state = operator_alloc(arena, 1, sizeof(NestedLoopJoinState));
     if (!state) {
-        free(op);
+        operator_release(op, op);
         return NULL;
     }
 
@@ -33,13 +38,18 @@ Operator* nested_loop_join_create(Operator* outer, Operator* inner,
     state->outer_exhausted = false;
     state->outer_attr_count = outer_column_count;
     state->inner_attr_count = inner_column_count;
+    state->is_equi_join = false;
+    state->outer_join_attribute = 0;
+    state->inner_join_attribute = 0;
+    state->inner_index = NULL;
+    state->outer_pruned = 0;
 
     // Allocate combined attributes array
     uint8_t total_attrs = outer_column_count + inner_column_count;
-    state->combined_attrs = calloc(total_attrs, sizeof(attribute_value_t));
+    state->combined_attrs = operator_alloc(arena, total_attrs, sizeof(attribute_value_t));
     if (!state->combined_attrs) {
-        free(state);
-        free(op);
+        operator_release(op, state);
+        operator_release(op, op);
         return NULL;
     }
 
@@ -57,11 +67,11 @@ Operator* nested_loop_join_create(Operator* outer, Operator* inner,
     op->destroy = nested_loop_join_destroy;
 
     // Set up children: outer = children[0], inner = children[1]
-    op->children = calloc(2, sizeof(Operator*));
+    op->children = operator_alloc(arena, 2, sizeof(Operator*));
     if (!op->children) {
-        free(state->combined_attrs);
-        free(state);
-        free(op);
+        operator_release(op, state->combined_attrs);
+        operator_release(op, state);
+        operator_release(op, op);
         return NULL;
     }
     op->children[0] = outer;
@@ -71,6 +81,35 @@ Operator* nested_loop_join_create(Operator* outer, Operator* inner,
     return op;
 }
 
+Operator* nested_loop_join_create_equi(Operator* outer, Operator* inner,
+                                       dbms_session_t* session,
+                                       uint8_t outer_column_count,
+                                       uint8_t inner_column_count,
+                                       uint8_t outer_join_attribute,
+                                       uint8_t inner_join_attribute,
+                                       const index_t* inner_index,
+                                       arena_t* arena) {
+    if (outer_join_attribute >= outer_column_count || inner_join_attribute >= inner_column_count) {
+        return NULL;
+    }
+    // Only a single-attribute index on the join attribute can answer for one value
+    if (inner_index && (inner_index->attribute_count != 1 || inner_index->attribute_indexes[0] != inner_join_attribute)) {
+        return NULL;
+    }
+
+    Operator* op = nested_loop_join_create(outer, inner, session, outer_column_count, inner_column_count, arena);
+    if (!op) {
+        return NULL;
+    }
+
+    NestedLoopJoinState* state = (NestedLoopJoinState*)op->state;
+    state->is_equi_join = true;
+    state->outer_join_attribute = outer_join_attribute;
+    state->inner_join_attribute = inner_join_attribute;
+    state->inner_index = inner_index;
+    return op;
+}
+
 static void nested_loop_join_open(Operator* self) {
     if (!self || !self->state || !self->children || self->child_count < 2) {
         return;
@@ -90,11 +129,10 @@ static void nested_loop_join_open(Operator* self) {
 
     // Get first outer tuple
     state->outer_exhausted = false;
-    if (outer && outer->next) {
-        state->outer_tuple = outer->next(outer);
-        if (!state->outer_tuple) {
-            state->outer_exhausted = true;
-        }
+    state->outer_pruned = 0;
+    state->outer_tuple = next_outer_tuple(state, outer);
+    if (!state->outer_tuple) {
+        state->outer_exhausted = true;
     }
 }
 
@@ -119,6 +157,12 @@ static tuple_t* nested_loop_join_next(Operator* self) {
             inner_tuple = inner->next(inner);
         }
 
+        if (inner_tuple && state->is_equi_join &&
+            !join_values_equal(&state->outer_tuple->attributes[state->outer_join_attribute],
+                               &inner_tuple->attributes[state->inner_join_attribute])) {
+            continue;
+        }
+
         if (inner_tuple) {
             // Combine outer + inner tuples (shallow copy)
             for (uint8_t i = 0; i < state->outer_attr_count; i++) {
@@ -141,11 +185,7 @@ static tuple_t* nested_loop_join_next(Operator* self) {
         }
 
         // Get next outer tuple
-        if (outer && outer->next) {
-            state->outer_tuple = outer->next(outer);
-        } else {
-            state->outer_tuple = NULL;
-        }
+        state->outer_tuple = next_outer_tuple(state, outer);
 
         if (!state->outer_tuple) {
             state->outer_exhausted = true;
@@ -195,11 +235,10 @@ static void nested_loop_join_reset(Operator* self) {
 
     // Get first outer tuple again
     state->outer_exhausted = false;
-    if (outer && outer->next) {
-        state->outer_tuple = outer->next(outer);
-        if (!state->outer_tuple) {
-            state->outer_exhausted = true;
-        }
+    state->outer_pruned = 0;
+    state->outer_tuple = next_outer_tuple(state, outer);
+    if (!state->outer_tuple) {
+        state->outer_exhausted = true;
     }
 }
 
@@ -211,9 +250,42 @@ static void nested_loop_join_destroy(Operator* self) {
     NestedLoopJoinState* state = (NestedLoopJoinState*)self->state;
 
     // Free combined attributes array
-    if (state->combined_attrs) {
-        free(state->combined_attrs);
-        state->combined_attrs = NULL;
+    operator_release(self, state->combined_attrs);
+    state->combined_attrs = NULL;
+}
+
+// Next outer tuple the inner relation may hold a match for. The Bloom filter of the inner
+// index rules out most values without a match, so their inner scan never happens.
+static tuple_t* next_outer_tuple(NestedLoopJoinState* state, Operator* outer) {
+    if (!outer || !outer->next) {
+        return NULL;
     }
+
+    tuple_t* tuple;
+    while ((tuple = outer->next(outer)) != NULL) {
+        if (!state->inner_index || index_may_contain(state->inner_index, &tuple->attributes[state->outer_join_attribute])) {
+            return tuple;
+        }
+        state->outer_pruned++;
+    }
+    return NULL;
 }
 
+static bool join_values_equal(const attribute_value_t* a, const attribute_value_t* b) {
+    if (a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+        case ATTRIBUTE_TYPE_INT:
+            return a->int_value == b->int_value;
+        case ATTRIBUTE_TYPE_FLOAT:
+            return a->float_value == b->float_value;
+        case ATTRIBUTE_TYPE_STRING:
+            return strcmp(a->string_value, b->string_value) == 0;
+        case ATTRIBUTE_TYPE_BOOL:
+            return a->bool_value == b->bool_value;
+        default:
+            return false;
+    }
+}
@@ -13,7 +13,7 @@
 
 typedef struct TupleHashNode {
     uint64_t hash;                    // Pre-computed hash
-    attribute_value_t* attrs;         // Deep copy of attribute values
+    attribute_value_t* attrs;         // Deep copy of attribute values (in the key arena)
     uint8_t attr_count;
     struct TupleHashNode* next;
 } TupleHashNode;
@@ -21,23 +21,31 @@ typedef struct TupleHashNode {
 struct TupleHashSet {
     TupleHashNode** buckets;
     size_t bucket_count;
+    arena_t* keys;                    // Nodes and copied keys, reset wholesale on clear
 };
 
-static TupleHashSet* tuple_hash_set_init(size_t bucket_count);
-static void tuple_hash_set_free(TupleHashSet* set);
+static TupleHashSet* tuple_hash_set_init(arena_t* arena, size_t bucket_count);
+static void tuple_hash_set_free(TupleHashSet* set, arena_t* arena);
 static void tuple_hash_set_clear(TupleHashSet* set);
 static uint64_t hash_tuple_attrs(const attribute_value_t* attrs, uint8_t count);
 static bool attrs_equal(const attribute_value_t* a, const attribute_value_t* b, uint8_t count);
 static bool tuple_hash_set_contains(TupleHashSet* set, const attribute_value_t* attrs, uint8_t count);
 static bool tuple_hash_set_insert(TupleHashSet* set, const attribute_value_t* attrs, uint8_t count);
 
-static TupleHashSet* tuple_hash_set_init(size_t bucket_count) {
-    TupleHashSet* set = calloc(1, sizeof(TupleHashSet));
+static TupleHashSet* tuple_hash_set_init(arena_t* arena, size_t bucket_count) {
+    TupleHashSet* set = operator_alloc(arena, 1, sizeof(TupleHashSet));
     if (!set) return NULL;
 
-    set->buckets = calloc(bucket_count, sizeof(TupleHashNode*));
-    if (!set->buckets) {
-        free(set);
+    set->buckets = operator_alloc(arena, bucket_count, sizeof(TupleHashNode*));
+    // Keys get their own region so a reset (e.g. a nested loop rescanning this side)
+    // reclaims them instead of growing the query arena on every pass
+    set->keys = arena_create(0);
+    if (!set->buckets || !set->keys) {
+        arena_free(set->keys);
+        if (!arena) {
+            free(set->buckets);
+            free(set);
+        }
         return NULL;
     }
 
@@ -45,53 +53,23 @@ static TupleHashSet* tuple_hash_set_init(size_t bucket_count) {
     return set;
 }
 
-static void tuple_hash_set_free(TupleHashSet* set) {
+static void tuple_hash_set_free(TupleHashSet* set, arena_t* arena) {
     if (!set) return;
 
-    // Free all nodes and their deep-copied attributes
-    for (size_t i = 0; i < set->bucket_count; i++) {
-        TupleHashNode* node = set->buckets[i];
-        while (node) {
-            TupleHashNode* next = node->next;
-            // Free deep-copied string attributes
-            if (node->attrs) {
-                for (uint8_t j = 0; j < node->attr_count; j++) {
-                    if (node->attrs[j].type == ATTRIBUTE_TYPE_STRING && node->attrs[j].string_value) {
-                        free(node->attrs[j].string_value);
-                    }
-                }
-                free(node->attrs);
-            }
-            free(node);
-            node = next;
-        }
+    // All nodes and their deep-copied attributes live in the key arena
+    arena_free(set->keys);
+    if (!arena) {
+        free(set->buckets);
+        free(set);
     }
-
-    free(set->buckets);
-    free(set);
 }
 
 static void tuple_hash_set_clear(TupleHashSet* set) {
     if (!set) return;
 
-    // Free all nodes and their deep-copied attributes (but keep the set structure)
-    for (size_t i = 0; i < set->bucket_count; i++) {
-        TupleHashNode* node = set->buckets[i];
-        while (node) {
-            TupleHashNode* next = node->next;
-            if (node->attrs) {
-                for (uint8_t j = 0; j < node->attr_count; j++) {
-                    if (node->attrs[j].type == ATTRIBUTE_TYPE_STRING && node->attrs[j].string_value) {
-                        free(node->attrs[j].string_value);
-                    }
-                }
-                free(node->attrs);
-            }
-            free(node);
-            node = next;
-        }
-        set->buckets[i] = NULL;
-    }
+    // Drop every node at once (but keep the set structure)
+    arena_reset(set->keys);
+    memset(set->buckets, 0, set->bucket_count * sizeof(TupleHashNode*));
 }
 
 static uint64_t hash_tuple_attrs(const attribute_value_t* attrs, uint8_t count) {
@@ -196,48 +174,24 @@ static bool tuple_hash_set_insert(TupleHashSet* set, const attribute_value_t* at
     size_t bucket = hash % set->bucket_count;
 
     // Create new node with deep copy of attributes
-    TupleHashNode* node = calloc(1, sizeof(TupleHashNode));
+    TupleHashNode* node = arena_alloc(set->keys, sizeof(TupleHashNode));
     if (!node) return false;
 
     node->hash = hash;
     node->attr_count = count;
-    node->attrs = calloc(count, sizeof(attribute_value_t));
+    node->attrs = arena_calloc(set->keys, count, sizeof(attribute_value_t));
     if (!node->attrs) {
-        free(node);
         return false;
     }
 
     // Deep copy attributes
     for (uint8_t i = 0; i < count; i++) {
-        node->attrs[i].type = attrs[i].type;
-        switch (attrs[i].type) {
-            case ATTRIBUTE_TYPE_INT:
-                node->attrs[i].int_value = attrs[i].int_value;
-                break;
-            case ATTRIBUTE_TYPE_FLOAT:
-                node->attrs[i].float_value = attrs[i].float_value;
-                break;
-            case ATTRIBUTE_TYPE_STRING:
-                if (attrs[i].string_value) {
-                    node->attrs[i].string_value = strdup(attrs[i].string_value);
-                    if (!node->attrs[i].string_value) {
-                        // Cleanup on failure
-                        for (uint8_t j = 0; j < i; j++) {
-                            if (node->attrs[j].type == ATTRIBUTE_TYPE_STRING && node->attrs[j].string_value) {
-                                free(node->attrs[j].string_value);
-                            }
-                        }
-                        free(node->attrs);
-                        free(node);
-                        return false;
-                    }
-                }
-                break;
-            case ATTRIBUTE_TYPE_BOOL:
-                node->attrs[i].bool_value = attrs[i].bool_value;
-                break;
-            default:
-                break;
+        node->attrs[i] = attrs[i];
+        if (attrs[i].type == ATTRIBUTE_TYPE_STRING && attrs[i].string_value) {
+            node->attrs[i].string_value = arena_strdup(set->keys, attrs[i].string_value);
+            if (!node->attrs[i].string_value) {
+                return false;
+            }
         }
     }
 
@@ -261,19 +215,20 @@ static void project_destroy(Operator* self);
 
 Operator* project_create(Operator* child, dbms_session_t* session,
                          uint8_t* column_indices, uint8_t column_count,
-                         bool is_distinct) {
+                         bool is_distinct, arena_t* arena) {
     if (!child || !session || !column_indices || column_count == 0) {
         return NULL;
     }
 
-    Operator* op = calloc(1, sizeof(Operator));
+    Operator* op = operator_alloc(arena, 1, sizeof(Operator));
     if (!op) {
         return NULL;
     }
+    op->arena = arena;
 
-    ProjectState* state = calloc(1, sizeof(ProjectState));
+    ProjectState* state = operator_alloc(arena, 1, sizeof(ProjectState));
     if (!state) {
-        free(op);
+        operator_release(op, op);
         return NULL;
     }
 
@@ -281,33 +236,28 @@ Operator* project_create(Operator* child, dbms_session_t* session,
     state->column_count = column_count;
     state->is_distinct = is_distinct;
     state->seen_tuples = NULL;
+    op->state = state;
+    op->destroy = project_destroy;
 
-    // Copy the column indices array
-    state->column_indices = calloc(column_count, sizeof(uint8_t));
-    if (!state->column_indices) {
-        free(state);
-        free(op);
+    // Copy the column indices array and allocate the projected attributes array
+    state->column_indices = operator_alloc(arena, column_count, sizeof(uint8_t));
+    state->projected_attrs = operator_alloc(arena, column_count, sizeof(attribute_value_t));
+    op->children = operator_alloc(arena, 1, sizeof(Operator*));
+    if (!state->column_indices || !state->projected_attrs || !op->children) {
+        operator_release(op, op->children);
+        op->children = NULL;
+        operator_free(op);
         return NULL;
     }
     memcpy(state->column_indices, column_indices, column_count * sizeof(uint8_t));
 
-    // Allocate the projected attributes array
-    state->projected_attrs = calloc(column_count, sizeof(attribute_value_t));
-    if (!state->projected_attrs) {
-        free(state->column_indices);
-        free(state);
-        free(op);
-        return NULL;
-    }
-
     // Initialize TupleHashSet if DISTINCT is enabled
     if (is_distinct) {
-        state->seen_tuples = tuple_hash_set_init(TUPLE_HASH_SET_BUCKETS);
+        state->seen_tuples = tuple_hash_set_init(arena, TUPLE_HASH_SET_BUCKETS);
         if (!state->seen_tuples) {
-            free(state->projected_attrs);
-            free(state->column_indices);
-            free(state);
-            free(op);
+            operator_release(op, op->children);
+            op->children = NULL;
+            operator_free(op);
             return NULL;
         }
     }
@@ -318,23 +268,12 @@ Operator* project_create(Operator* child, dbms_session_t* session,
     state->projected_tuple.is_null = false;
     state->projected_tuple.attributes = state->projected_attrs;
 
-    op->state = state;
     op->open = project_open;
     op->next = project_next;
     op->close = project_close;
     op->reset = project_reset;
-    op->destroy = project_destroy;
 
     // Set up child relationship
-    op->children = calloc(1, sizeof(Operator*));
-    if (!op->children) {
-        if (state->seen_tuples) tuple_hash_set_free(state->seen_tuples);
-        free(state->projected_attrs);
-        free(state->column_indices);
-        free(state);
-        free(op);
-        return NULL;
-    }
     op->children[0] = child;
     op->child_count = 1;
 
@@ -423,7 +362,7 @@ static void project_reset(Operator* self) {
         child->reset(child);
     }
 
-    // Clear the TupleHashSet if DISTINCT is enabled (free strings to avoid memory leak)
+    // Clear the TupleHashSet if DISTINCT is enabled
     if (state->is_distinct && state->seen_tuples) {
         tuple_hash_set_clear(state->seen_tuples);
     }
@@ -437,19 +376,14 @@ static void project_destroy(Operator* self) {
     ProjectState* state = (ProjectState*)self->state;
 
     // Free allocated arrays within the state
-    if (state->column_indices) {
-        free(state->column_indices);
-        state->column_indices = NULL;
-    }
-
-    if (state->projected_attrs) {
-        free(state->projected_attrs);
-        state->projected_attrs = NULL;
-    }
+    operator_release(self, state->column_indices);
+    state->column_indices = NULL;
+    operator_release(self, state->projected_attrs);
+    state->projected_attrs = NULL;
 
     // Free TupleHashSet if DISTINCT was enabled
     if (state->seen_tuples) {
-        tuple_hash_set_free(state->seen_tuples);
+        tuple_hash_set_free(state->seen_tuples, self->arena);
         state->seen_tuples = NULL;
     }
 }
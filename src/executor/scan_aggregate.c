@@ -0,0 +1,674 @@
+#include "executor/scan_aggregate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "align.h"
+#include "dictionary.h"
+#include "index.h"
+#include "simd.h"
+#include "zone_map.h"
+
+struct ScanAggregateAccumulator {
+    uint64_t count;
+    int64_t int_sum;
+    int32_t int_min;
+    int32_t int_max;
+    double float_sum;
+    float float_min;
+    float float_max;
+    uint8_t type;  // Input attribute type (ATTRIBUTE_TYPE_UNUSED for COUNT)
+};
+
+// Forward declarations for iterator interface
+static void scan_aggregate_open(Operator* self);
+static tuple_t* scan_aggregate_next(Operator* self);
+static void scan_aggregate_close(Operator* self);
+static void scan_aggregate_reset(Operator* self);
+static void scan_aggregate_destroy(Operator* self);
+
+// Forward declarations for page processing
+static uint64_t build_page_mask(ScanAggregateState* state, const page_t* page, const char* data);
+static void apply_proposition(ScanAggregateState* state, const char* data, size_t proposition_index);
+static bool string_matches(const char* data, size_t size, const char* value, uint8_t operator);
+static bool resolve_codes(ScanAggregateState* state);
+static void release_matches(ScanAggregateState* state);
+static void reduce_page(ScanAggregateState* state, const char* data, uint8_t aggregate, uint64_t selected);
+static void fill_output(ScanAggregateState* state);
+static index_t* find_count_index(dbms_session_t* session, const selection_criteria_t* criteria,
+                                 const aggregate_t* aggregates, uint8_t aggregate_count);
+
+Operator* scan_aggregate_create(dbms_session_t* session, selection_criteria_t* criteria, aggregate_t* aggregates,
+                                uint8_t aggregate_count, arena_t* arena) {
+    if (!session || !aggregates || aggregate_count == 0) {
+        return NULL;
+    }
+
+    uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+    for (uint8_t i = 0; i < aggregate_count; i++) {
+        if (aggregates[i].attribute_index != AGGREGATE_COUNT_STAR && aggregates[i].attribute_index >= num_attributes) {
+            return NULL;
+        }
+    }
+    size_t proposition_count = criteria ? criteria->proposition_count : 0;
+    for (size_t i = 0; i < proposition_count; i++) {
+        if (criteria->propositions[i].attribute_index >= num_attributes) {
+            return NULL;
+        }
+    }
+
+    Operator* op = operator_alloc(arena, 1, sizeof(Operator));
+    if (!op) {
+        return NULL;
+    }
+    op->arena = arena;
+
+    ScanAggregateState* state = operator_alloc(arena, 1, sizeof(ScanAggregateState));
+    if (!state) {
+        operator_release(op, op);
+        return NULL;
+    }
+    op->state = state;
+    op->destroy = scan_aggregate_destroy;
+
+    state->session = session;
+    state->criteria = criteria;
+    state->aggregate_count = aggregate_count;
+    state->tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+    state->count_index = find_count_index(session, criteria, aggregates, aggregate_count);
+
+    state->aggregates = operator_alloc(arena, aggregate_count, sizeof(aggregate_t));
+    state->aggregate_offsets = operator_alloc(arena, aggregate_count, sizeof(off_t));
+    state->aggregate_strides = operator_alloc(arena, aggregate_count, sizeof(size_t));
+    state->proposition_offsets = operator_alloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(off_t));
+    state->proposition_strides = operator_alloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(size_t));
+    state->proposition_codes = operator_alloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(uint32_t));
+    state->proposition_matches = operator_alloc(arena, proposition_count > 0 ? proposition_count : 1, sizeof(uint8_t*));
+    state->mask = operator_alloc(arena, state->tuples_per_page > 0 ? state->tuples_per_page : 1, sizeof(uint8_t));
+    // int32_t and float are the same size, one buffer serves both
+    state->column = operator_alloc(arena, state->tuples_per_page > 0 ? state->tuples_per_page : 1, sizeof(int32_t));
+    state->accumulators = operator_alloc(arena, aggregate_count, sizeof(ScanAggregateAccumulator));
+    state->output_attrs = operator_alloc(arena, aggregate_count, sizeof(attribute_value_t));
+    if (!state->aggregates || !state->aggregate_offsets || !state->aggregate_strides || !state->proposition_offsets ||
+        !state->proposition_strides || !state->proposition_codes || !state->proposition_matches || !state->mask ||
+        !state->column || !state->accumulators || !state->output_attrs) {
+        operator_free(op);
+        return NULL;
+    }
+    memcpy(state->aggregates, aggregates, aggregate_count * sizeof(aggregate_t));
+
+    // Attribute offsets are fixed by the catalog, resolve them once
+    for (uint8_t i = 0; i < aggregate_count; i++) {
+        uint8_t attribute_index = aggregates[i].attribute_index;
+        if (attribute_index != AGGREGATE_COUNT_STAR) {
+            state->aggregate_offsets[i] = dbms_get_column_offset(session->catalog, attribute_index);
+            state->aggregate_strides[i] = dbms_get_column_stride(session->catalog, attribute_index);
+        }
+    }
+    for (size_t i = 0; i < proposition_count; i++) {
+        uint8_t attribute_index = criteria->propositions[i].attribute_index;
+        state->proposition_offsets[i] = dbms_get_column_offset(session->catalog, attribute_index);
+        state->proposition_strides[i] = dbms_get_column_stride(session->catalog, attribute_index);
+    }
+
+    // Slotted records have no fixed positions, the attributes read are unpacked into columns first
+    size_t unpacked_size = dbms_get_unpacked_size(session->catalog);
+    if (unpacked_size > 0) {
+        state->unpacked_attributes = operator_alloc(arena, num_attributes, sizeof(bool));
+        state->unpacked_columns = operator_alloc(arena, unpacked_size, sizeof(char));
+        if (!state->unpacked_attributes || !state->unpacked_columns) {
+            operator_free(op);
+            return NULL;
+        }
+        for (uint8_t i = 0; i < aggregate_count; i++) {
+            if (aggregates[i].attribute_index != AGGREGATE_COUNT_STAR) {
+                state->unpacked_attributes[aggregates[i].attribute_index] = true;
+            }
+        }
+        for (size_t i = 0; i < proposition_count; i++) {
+            state->unpacked_attributes[criteria->propositions[i].attribute_index] = true;
+        }
+    }
+
+    // Initialize the output tuple
+    state->output_tuple.id.page_id = 0;
+    state->output_tuple.id.slot_id = 0;
+    state->output_tuple.is_null = false;
+    state->output_tuple.attributes = state->output_attrs;
+
+    op->open = scan_aggregate_open;
+    op->next = scan_aggregate_next;
+    op->close = scan_aggregate_close;
+    op->reset = scan_aggregate_reset;
+    op->children = NULL;
+    op->child_count = 0;
+
+    return op;
+}
+
+static void scan_aggregate_open(Operator* self) {
+    if (!self || !self->state) {
+        return;
+    }
+
+    ScanAggregateState* state = (ScanAggregateState*)self->state;
+    state->done = false;
+}
+
+static tuple_t* scan_aggregate_next(Operator* self) {
+    if (!self || !self->state) {
+        return NULL;
+    }
+
+    ScanAggregateState* state = (ScanAggregateState*)self->state;
+    if (state->done) {
+        return NULL;
+    }
+    state->done = true;
+
+    memset(state->accumulators, 0, state->aggregate_count * sizeof(ScanAggregateAccumulator));
+    for (uint8_t i = 0; i < state->aggregate_count; i++) {
+        // Output types come from the catalog so an empty input still produces typed results
+        uint8_t attribute_index = state->aggregates[i].attribute_index;
+        if (attribute_index != AGGREGATE_COUNT_STAR) {
+            state->accumulators[i].type = dbms_get_catalog_record(state->session->catalog, attribute_index)->attribute_type;
+        }
+    }
+    state->rows_matched = 0;
+
+    // Index-only: the matching entries are the rows, the table is never read
+    if (state->count_index) {
+        state->rows_matched = index_count(state->count_index, &state->criteria->propositions[0].value);
+        for (uint8_t i = 0; i < state->aggregate_count; i++) {
+            state->accumulators[i].count = state->rows_matched;
+        }
+        fill_output(state);
+        return &state->output_tuple;
+    }
+
+    // The dictionary may have grown since the operator was created
+    if (!resolve_codes(state)) {
+        return NULL;
+    }
+
+    for (uint64_t page_id = 1; page_id <= state->session->page_count; page_id++) {
+        if (zone_map_can_skip_page(state->session->zone_map, page_id, state->criteria)) {
+            continue;
+        }
+
+        // Pin-Scan-Unpin, without decoding the page into tuple_t. Mapped pages are read in place, unpinned.
+        const page_t* page = dbms_get_mapped_page(state->session, page_id);
+        buffer_page_t* buffer_page = page ? NULL : dbms_pin_raw_page(state->session, page_id);
+        if (buffer_page) {
+            page = buffer_page->page;
+        }
+        if (!page) {
+            fprintf(stderr, "ScanAggregate failed to read page %llu\n", (unsigned long long)page_id);
+            release_matches(state);
+            return NULL;
+        }
+
+        const char* data = page->data;
+        if (state->unpacked_columns) {
+            if (!dbms_unpack_page(state->session, page, state->unpacked_attributes, state->unpacked_columns)) {
+                fprintf(stderr, "ScanAggregate failed to unpack page %llu\n", (unsigned long long)page_id);
+                if (buffer_page) {
+                    dbms_unpin_page(state->session, buffer_page);
+                }
+                release_matches(state);
+                return NULL;
+            }
+            data = state->unpacked_columns;
+        }
+
+        uint64_t selected = build_page_mask(state, page, data);
+        if (selected > 0) {
+            state->rows_matched += selected;
+            for (uint8_t i = 0; i < state->aggregate_count; i++) {
+                reduce_page(state, data, i, selected);
+            }
+        }
+
+        if (buffer_page) {
+            dbms_unpin_page(state->session, buffer_page);
+        }
+    }
+    release_matches(state);
+
+    fill_output(state);
+    return &state->output_tuple;
+}
+
+static void scan_aggregate_close(Operator* self) {
+    if (!self || !self->state) {
+        return;
+    }
+
+    // Pages are unpinned as soon as they are reduced, nothing else to release
+    ScanAggregateState* state = (ScanAggregateState*)self->state;
+    state->done = true;
+}
+
+static void scan_aggregate_reset(Operator* self) {
+    if (!self || !self->state) {
+        return;
+    }
+
+    ScanAggregateState* state = (ScanAggregateState*)self->state;
+    state->done = false;
+}
+
+static void scan_aggregate_destroy(Operator* self) {
+    if (!self || !self->state) {
+        return;
+    }
+
+    ScanAggregateState* state = (ScanAggregateState*)self->state;
+    release_matches(state);
+    operator_release(self, state->aggregates);
+    operator_release(self, state->aggregate_offsets);
+    operator_release(self, state->aggregate_strides);
+    operator_release(self, state->proposition_offsets);
+    operator_release(self, state->proposition_strides);
+    operator_release(self, state->proposition_codes);
+    operator_release(self, state->proposition_matches);
+    operator_release(self, state->mask);
+    operator_release(self, state->column);
+    operator_release(self, state->unpacked_attributes);
+    operator_release(self, state->unpacked_columns);
+    operator_release(self, state->accumulators);
+    operator_release(self, state->output_attrs);
+    state->aggregates = NULL;
+    state->aggregate_offsets = NULL;
+    state->aggregate_strides = NULL;
+    state->proposition_offsets = NULL;
+    state->proposition_strides = NULL;
+    state->proposition_codes = NULL;
+    state->proposition_matches = NULL;
+    state->mask = NULL;
+    state->column = NULL;
+    state->unpacked_attributes = NULL;
+    state->unpacked_columns = NULL;
+    state->accumulators = NULL;
+    state->output_attrs = NULL;
+}
+
+// Returns the number of live tuples on the page that satisfy every predicate, reading the values from data
+static uint64_t build_page_mask(ScanAggregateState* state, const page_t* page, const char* data) {
+    const system_catalog_t* catalog = state->session->catalog;
+    uint64_t tuples_per_page = state->tuples_per_page;
+
+    if (dbms_has_occupancy_bitmap(catalog)) {
+        // Expand the occupancy bitmap, an empty or full word takes one compare
+        const uint64_t* bitmap = (const uint64_t*)page->data;
+        uint64_t live_count = 0;
+        for (uint64_t first = 0; first < tuples_per_page; first += DBMS_BITMAP_WORD_BITS) {
+            uint64_t word = bitmap[first / DBMS_BITMAP_WORD_BITS];
+            uint64_t count = tuples_per_page - first < DBMS_BITMAP_WORD_BITS ? tuples_per_page - first
+                                                                             : DBMS_BITMAP_WORD_BITS;
+            if (word == 0 || word == UINT64_MAX) {
+                memset(state->mask + first, word != 0, count);
+            } else {
+                for (uint64_t bit = 0; bit < count; bit++) {
+                    state->mask[first + bit] = (word >> bit) & 1;
+                }
+            }
+            live_count += (uint64_t)__builtin_popcountll(word);
+        }
+        if (live_count == 0 || !state->criteria) {
+            return live_count;
+        }
+    } else if (catalog->layout == CATALOG_LAYOUT_SLOTTED) {
+        for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+            state->mask[slot] = dbms_is_slot_live(catalog, page, slot);
+        }
+    } else {
+        // First byte of each tuple is the null byte
+        for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+            state->mask[slot] = page->data[slot * catalog->tuple_size] != 0;
+        }
+    }
+
+    if (state->criteria) {
+        for (size_t i = 0; i < state->criteria->proposition_count; i++) {
+            apply_proposition(state, data, i);
+        }
+    }
+
+    uint64_t selected = 0;
+    for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+        selected += state->mask[slot];
+    }
+    return selected;
+}
+
+// Branch-free predicate loop: mask[slot] &= (value <op> constant)
+// A compile-time stride of the value size (PAX minipages) lets the compiler vectorize the loop
+#define MASK_COMPARE(load_expr, op, constant)                                  \
+    if (stride == value_size) {                                                \
+        for (uint64_t slot = 0; slot < tuples_per_page; slot++) {              \
+            const char* attribute_data = base + slot * value_size;             \
+            state->mask[slot] &= (uint8_t)((load_expr) op (constant));         \
+        }                                                                      \
+    } else {                                                                   \
+        for (uint64_t slot = 0; slot < tuples_per_page; slot++) {              \
+            const char* attribute_data = base + slot * stride;                 \
+            state->mask[slot] &= (uint8_t)((load_expr) op (constant));         \
+        }                                                                      \
+    }
+
+#define MASK_APPLY_OPERATOR(load_expr, constant)                       \
+    switch (proposition->operator) {                                   \
+        case OPERATOR_EQUAL:                                           \
+            MASK_COMPARE(load_expr, ==, constant);                     \
+            break;                                                     \
+        case OPERATOR_NOT_EQUAL:                                       \
+            MASK_COMPARE(load_expr, !=, constant);                     \
+            break;                                                     \
+        case OPERATOR_LESS_THAN:                                       \
+            MASK_COMPARE(load_expr, <, constant);                      \
+            break;                                                     \
+        case OPERATOR_LESS_EQUAL:                                      \
+            MASK_COMPARE(load_expr, <=, constant);                     \
+            break;                                                     \
+        case OPERATOR_GREATER_THAN:                                    \
+            MASK_COMPARE(load_expr, >, constant);                      \
+            break;                                                     \
+        case OPERATOR_GREATER_EQUAL:                                   \
+            MASK_COMPARE(load_expr, >=, constant);                     \
+            break;                                                     \
+        default:                                                       \
+            memset(state->mask, 0, tuples_per_page);                   \
+            break;                                                     \
+    }
+
+static void apply_proposition(ScanAggregateState* state, const char* data, size_t proposition_index) {
+    const proposition_t* proposition = &state->criteria->propositions[proposition_index];
+    uint64_t tuples_per_page = state->tuples_per_page;
+    size_t stride = state->proposition_strides[proposition_index];
+    const char* base = data + state->proposition_offsets[proposition_index];
+    catalog_record_t* record = dbms_get_catalog_record(state->session->catalog, proposition->attribute_index);
+
+    if (dbms_is_dictionary_encoded(state->session->catalog, proposition->attribute_index)) {
+        const uint8_t* matches = state->proposition_matches[proposition_index];
+        if (matches) {
+            for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+                state->mask[slot] &= matches[load_u16(base + slot * stride)];
+            }
+            return;
+        }
+        // Integer compare on the codes, a constant missing from the dictionary has no code on any page
+        const size_t value_size = CATALOG_DICTIONARY_CODE_SIZE;
+        uint32_t code = state->proposition_codes[proposition_index];
+        if (proposition->operator == OPERATOR_EQUAL) {
+            MASK_COMPARE((uint32_t)load_u16(attribute_data), ==, code);
+        } else {
+            MASK_COMPARE((uint32_t)load_u16(attribute_data), !=, code);
+        }
+        return;
+    }
+
+    switch (record->attribute_type) {
+        case ATTRIBUTE_TYPE_INT: {
+            const size_t value_size = sizeof(int32_t);
+            int32_t value = proposition->value.int_value;
+            MASK_APPLY_OPERATOR((int32_t)load_u32(attribute_data), value);
+            break;
+        }
+        case ATTRIBUTE_TYPE_FLOAT: {
+            const size_t value_size = sizeof(float);
+            float value = proposition->value.float_value;
+            MASK_APPLY_OPERATOR(load_f32(attribute_data), value);
+            break;
+        }
+        case ATTRIBUTE_TYPE_BOOL: {
+            // Booleans only support equality (same as the Filter operator)
+            const size_t value_size = sizeof(uint8_t);
+            uint8_t value = proposition->value.bool_value ? 1 : 0;
+            if (proposition->operator == OPERATOR_EQUAL) {
+                MASK_COMPARE((uint8_t)(load_u8(attribute_data) != 0), ==, value);
+            } else if (proposition->operator == OPERATOR_NOT_EQUAL) {
+                MASK_COMPARE((uint8_t)(load_u8(attribute_data) != 0), !=, value);
+            } else {
+                memset(state->mask, 0, tuples_per_page);
+            }
+            break;
+        }
+        case ATTRIBUTE_TYPE_STRING: {
+            // Page strings are zero padded but not terminated when they fill the attribute
+            const char* value = proposition->value.string_value ? proposition->value.string_value : "";
+            for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+                if (!state->mask[slot]) continue;
+                state->mask[slot] = string_matches(base + slot * stride, record->attribute_size, value,
+                                                   proposition->operator);
+            }
+            break;
+        }
+        default:
+            memset(state->mask, 0, tuples_per_page);
+            break;
+    }
+}
+
+#undef MASK_APPLY_OPERATOR
+#undef MASK_COMPARE
+
+// Compares a page string of the given attribute size with a constant
+static bool string_matches(const char* data, size_t size, const char* value, uint8_t operator) {
+    // Page strings are zero padded but not terminated when they fill the attribute
+    int cmp = strncmp(data, value, size);
+    if (cmp == 0 && strlen(value) > size) cmp = -1;
+
+    switch (operator) {
+        case OPERATOR_EQUAL:
+            return cmp == 0;
+        case OPERATOR_NOT_EQUAL:
+            return cmp != 0;
+        case OPERATOR_LESS_THAN:
+            return cmp < 0;
+        case OPERATOR_LESS_EQUAL:
+            return cmp <= 0;
+        case OPERATOR_GREATER_THAN:
+            return cmp > 0;
+        case OPERATOR_GREATER_EQUAL:
+            return cmp >= 0;
+        default:
+            return false;
+    }
+}
+
+// Resolves the predicates on dictionary encoded attributes against the current dictionary: equalities to the
+// constant's code, other operators to a table of the result for every code
+static bool resolve_codes(ScanAggregateState* state) {
+    size_t proposition_count = state->criteria ? state->criteria->proposition_count : 0;
+    const dictionary_t* dictionary = state->session->dictionary;
+    for (size_t i = 0; i < proposition_count; i++) {
+        const proposition_t* proposition = &state->criteria->propositions[i];
+        uint8_t attribute_index = proposition->attribute_index;
+        state->proposition_matches[i] = NULL;
+        if (!dbms_is_dictionary_encoded(state->session->catalog, attribute_index)) {
+            continue;
+        }
+
+        const char* value = proposition->value.string_value ? proposition->value.string_value : "";
+        if (proposition->operator == OPERATOR_EQUAL || proposition->operator == OPERATOR_NOT_EQUAL) {
+            state->proposition_codes[i] = dictionary_lookup(dictionary, attribute_index, value);
+            continue;
+        }
+
+        // Sized for every possible code so a page code never reads past the table
+        uint8_t* matches = calloc(DICTIONARY_MAX_CODES, sizeof(uint8_t));
+        if (!matches) {
+            fprintf(stderr, "Memory allocation failed for dictionary predicate\n");
+            release_matches(state);
+            return false;
+        }
+        size_t size = dbms_get_catalog_record(state->session->catalog, attribute_index)->attribute_size;
+        uint32_t count = dictionary_count(dictionary, attribute_index);
+        for (uint32_t code = 0; code < count; code++) {
+            matches[code] = string_matches(dictionary_decode(dictionary, attribute_index, code), size, value,
+                                           proposition->operator);
+        }
+        state->proposition_matches[i] = matches;
+    }
+    return true;
+}
+
+static void release_matches(ScanAggregateState* state) {
+    size_t proposition_count = state->criteria ? state->criteria->proposition_count : 0;
+    for (size_t i = 0; state->proposition_matches && i < proposition_count; i++) {
+        free(state->proposition_matches[i]);
+        state->proposition_matches[i] = NULL;
+    }
+}
+
+static void reduce_page(ScanAggregateState* state, const char* data, uint8_t aggregate, uint64_t selected) {
+    aggregate_t* agg = &state->aggregates[aggregate];
+    ScanAggregateAccumulator* acc = &state->accumulators[aggregate];
+
+    if (agg->function == AGGREGATE_COUNT) {
+        acc->count += selected;
+        return;
+    }
+
+    catalog_record_t* record = dbms_get_catalog_record(state->session->catalog, agg->attribute_index);
+    size_t stride = state->aggregate_strides[aggregate];
+    const char* base = data + state->aggregate_offsets[aggregate];
+    bool first = (acc->count == 0);
+
+    if (record->attribute_type == ATTRIBUTE_TYPE_INT) {
+        // Pack selected values (unconditional store, conditional advance) then reduce with SIMD
+        const int32_t* column = (const int32_t*)state->column;
+        size_t n = 0;
+        if (stride == sizeof(int32_t) && selected == state->tuples_per_page) {
+            // Every slot of a PAX minipage (or of a one-column bitmap page) is selected, reduce it in place
+            column = (const int32_t*)base;
+            n = selected;
+        } else {
+            int32_t* packed = (int32_t*)state->column;
+            for (uint64_t slot = 0; slot < state->tuples_per_page; slot++) {
+                packed[n] = (int32_t)load_u32(base + slot * stride);
+                n += state->mask[slot];
+            }
+        }
+
+        switch (agg->function) {
+            case AGGREGATE_SUM:
+            case AGGREGATE_AVG:
+                acc->int_sum += simd_sum_i32(column, n);
+                break;
+            case AGGREGATE_MIN: {
+                int32_t v = simd_min_i32(column, n);
+                if (first || v < acc->int_min) acc->int_min = v;
+                break;
+            }
+            case AGGREGATE_MAX: {
+                int32_t v = simd_max_i32(column, n);
+                if (first || v > acc->int_max) acc->int_max = v;
+                break;
+            }
+            default:
+                break;
+        }
+    } else if (record->attribute_type == ATTRIBUTE_TYPE_FLOAT) {
+        const float* column = (const float*)state->column;
+        size_t n = 0;
+        if (stride == sizeof(float) && selected == state->tuples_per_page) {
+            column = (const float*)base;
+            n = selected;
+        } else {
+            float* packed = (float*)state->column;
+            for (uint64_t slot = 0; slot < state->tuples_per_page; slot++) {
+                packed[n] = load_f32(base + slot * stride);
+                n += state->mask[slot];
+            }
+        }
+
+        switch (agg->function) {
+            case AGGREGATE_SUM:
+            case AGGREGATE_AVG:
+                acc->float_sum += simd_sum_f32(column, n);
+                break;
+            case AGGREGATE_MIN: {
+                float v = simd_min_f32(column, n);
+                if (first || v < acc->float_min) acc->float_min = v;
+                break;
+            }
+            case AGGREGATE_MAX: {
+                float v = simd_max_f32(column, n);
+                if (first || v > acc->float_max) acc->float_max = v;
+                break;
+            }
+            default:
+                break;
+        }
+    } else {
+        // Unsupported input types are ignored (rejected by hash_aggregate_supports)
+        return;
+    }
+    acc->count += selected;
+}
+
+static void fill_output(ScanAggregateState* state) {
+    for (uint8_t i = 0; i < state->aggregate_count; i++) {
+        attribute_value_t* out = &state->output_attrs[i];
+        ScanAggregateAccumulator* acc = &state->accumulators[i];
+
+        switch (state->aggregates[i].function) {
+            case AGGREGATE_COUNT:
+                out->type = ATTRIBUTE_TYPE_INT;
+                out->int_value = acc->count > INT32_MAX ? INT32_MAX : (int32_t)acc->count;
+                break;
+            case AGGREGATE_AVG:
+                out->type = ATTRIBUTE_TYPE_FLOAT;
+                if (acc->count == 0) {
+                    out->float_value = 0.0f;
+                } else if (acc->type == ATTRIBUTE_TYPE_INT) {
+                    out->float_value = (float)((double)acc->int_sum / (double)acc->count);
+                } else {
+                    out->float_value = (float)(acc->float_sum / (double)acc->count);
+                }
+                break;
+            default:
+                if (acc->type == ATTRIBUTE_TYPE_FLOAT) {
+                    out->type = ATTRIBUTE_TYPE_FLOAT;
+                    if (state->aggregates[i].function == AGGREGATE_SUM) {
+                        out->float_value = (float)acc->float_sum;
+                    } else {
+                        out->float_value = state->aggregates[i].function == AGGREGATE_MIN ? acc->float_min : acc->float_max;
+                    }
+                } else {
+                    // INT results are 32-bit, saturate rather than wrap
+                    out->type = ATTRIBUTE_TYPE_INT;
+                    int64_t v = acc->int_sum;
+                    if (state->aggregates[i].function == AGGREGATE_MIN) {
+                        v = acc->int_min;
+                    } else if (state->aggregates[i].function == AGGREGATE_MAX) {
+                        v = acc->int_max;
+                    }
+                    out->int_value = v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+                }
+                break;
+        }
+    }
+}
+
+static index_t* find_count_index(dbms_session_t* session, const selection_criteria_t* criteria,
+                                 const aggregate_t* aggregates, uint8_t aggregate_count) {
+    if (!session->indexes || !criteria || criteria->proposition_count != 1) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < aggregate_count; i++) {
+        if (aggregates[i].function != AGGREGATE_COUNT) {
+            return NULL;
+        }
+    }
+
+    const proposition_t* proposition = &criteria->propositions[0];
+    index_t* index = session->indexes[proposition->attribute_index];
+    if (proposition->operator != OPERATOR_EQUAL || !index || proposition->value.type != index->attribute_types[0]) {
+        return NULL;
+    }
+    return index;
+}
@@ -2,25 +2,35 @@
 
 #include <stdlib.h>
 
+#include "zone_map.h"
+
 // Forward declarations for iterator interface
 static void seq_scan_open(Operator* self);
 static tuple_t* seq_scan_next(Operator* self);
 static void seq_scan_close(Operator* self);
 static void seq_scan_reset(Operator* self);
+static void seq_scan_destroy(Operator* self);
+static void pin_next_page(SeqScanState* state);
+static void unpin_current_page(SeqScanState* state);
+
+Operator* seq_scan_create(dbms_session_t* session, arena_t* arena) {
+  return seq_scan_create_for_criteria(session, NULL, arena);
+}
 
-Operator* seq_scan_create(dbms_session_t* session) {
+Operator* seq_scan_create_for_criteria(dbms_session_t* session, const selection_criteria_t* criteria, arena_t* arena) {
   if (!session) {
     return NULL;
   }
 
-  Operator* op = calloc(1, sizeof(Operator));
+  Operator* op = operator_alloc(arena, 1, sizeof(Operator));
   if (!op) {
     return NULL;
   }
+  op->arena = arena;
 
-  SeqScanState* state = calloc(1, sizeof(SeqScanState));
+  SeqScanState* state = operator_alloc(arena, 1, sizeof(SeqScanState));
   if (!state) {
-    free(op);
+    operator_release(op, op);
     return NULL;
   }
 
@@ -29,13 +39,24 @@ Operator* seq_scan_create(dbms_session_t* session) {
   state->current_slot_id = 0;
   state->tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
   state->current_buffer_page = NULL;
+  state->criteria = criteria;
+  state->pages_skipped = 0;
+  state->page_view = NULL;
+  if (session->mapping) {
+    state->page_view = dbms_alloc_page_view(session);
+    if (!state->page_view) {
+      operator_release(op, state);
+      operator_release(op, op);
+      return NULL;
+    }
+  }
 
   op->state = state;
   op->open = seq_scan_open;
   op->next = seq_scan_next;
   op->close = seq_scan_close;
   op->reset = seq_scan_reset;
-  op->destroy = NULL;  // No extra allocations to free
+  op->destroy = seq_scan_destroy;
   op->children = NULL;
   op->child_count = 0;
 
@@ -52,13 +73,10 @@ static void seq_scan_open(Operator* self) {
   // Initialize scan position
   state->current_page_id = 1;
   state->current_slot_id = 0;
+  state->pages_skipped = 0;
 
-  // Pin the first page if there are pages
-  if (state->session->page_count > 0) {
-    state->current_buffer_page = dbms_pin_page(state->session, state->current_page_id);
-  } else {
-    state->current_buffer_page = NULL;
-  }
+  // Pin the first page that can hold a match, if any
+  pin_next_page(state);
 }
 
 static tuple_t* seq_scan_next(Operator* self) {
@@ -75,8 +93,10 @@ static tuple_t* seq_scan_next(Operator* self) {
 
   // Search for next non-null tuple
   while (state->current_buffer_page) {
-    // Check current page for valid tuples
-    while (state->current_slot_id < state->tuples_per_page) {
+    // Check current page for valid tuples, pages with an occupancy bitmap skip free slots a word at a time
+    const page_t* page = state->current_buffer_page->page;
+    while ((state->current_slot_id = dbms_next_live_slot(state->session->catalog, page, state->current_slot_id)) <
+           state->tuples_per_page) {
       tuple_t* tuple = &state->current_buffer_page->tuples[state->current_slot_id];
       state->current_slot_id++;
 
@@ -87,15 +107,11 @@ static tuple_t* seq_scan_next(Operator* self) {
 
     // Current page exhausted, move to next page
     // Unpin current page first (Pin-Scan-Unpin strategy)
-    dbms_unpin_page(state->session, state->current_buffer_page);
-    state->current_buffer_page = NULL;
+    unpin_current_page(state);
     state->current_slot_id = 0;
     state->current_page_id++;
 
-    // Check if there are more pages
-    if (state->current_page_id <= state->session->page_count) {
-      state->current_buffer_page = dbms_pin_page(state->session, state->current_page_id);
-    }
+    pin_next_page(state);
   }
 
   return NULL;
@@ -109,10 +125,7 @@ static void seq_scan_close(Operator* self) {
   SeqScanState* state = (SeqScanState*)self->state;
 
   // Unpin any held page
-  if (state->current_buffer_page) {
-    dbms_unpin_page(state->session, state->current_buffer_page);
-    state->current_buffer_page = NULL;
-  }
+  unpin_current_page(state);
 
   // Reset state
   state->current_page_id = 0;
@@ -127,19 +140,48 @@ static void seq_scan_reset(Operator* self) {
   SeqScanState* state = (SeqScanState*)self->state;
 
   // Unpin current page if held
-  if (state->current_buffer_page) {
-    dbms_unpin_page(state->session, state->current_buffer_page);
-  }
+  unpin_current_page(state);
 
   // Reset to beginning
   state->current_page_id = 1;
   state->current_slot_id = 0;
+  state->pages_skipped = 0;
 
   // Re-pin first page
-  if (state->session->page_count > 0) {
-    state->current_buffer_page = dbms_pin_page(state->session, state->current_page_id);
-  } else {
-    state->current_buffer_page = NULL;
+  pin_next_page(state);
+}
+
+// Pins the first page from current_page_id on that the zone map does not rule out (NULL at the end)
+static void pin_next_page(SeqScanState* state) {
+  state->current_buffer_page = NULL;
+  while (state->current_page_id <= state->session->page_count) {
+    if (!zone_map_can_skip_page(state->session->zone_map, state->current_page_id, state->criteria)) {
+      if (!state->page_view) {
+        state->current_buffer_page = dbms_pin_page(state->session, state->current_page_id);
+      } else if (dbms_view_mapped_page(state->session, state->page_view, state->current_page_id)) {
+        state->current_buffer_page = state->page_view;
+      }
+      return;
+    }
+    state->pages_skipped++;
+    state->current_page_id++;
+  }
+}
+
+// Mapped pages are only viewed, there is no pin to release
+static void unpin_current_page(SeqScanState* state) {
+  if (state->current_buffer_page && state->current_buffer_page != state->page_view) {
+    dbms_unpin_page(state->session, state->current_buffer_page);
   }
+  state->current_buffer_page = NULL;
 }
 
+static void seq_scan_destroy(Operator* self) {
+  if (!self || !self->state) {
+    return;
+  }
+
+  SeqScanState* state = (SeqScanState*)self->state;
+  dbms_free_page_view(state->session, state->page_view);
+  state->page_view = NULL;
+}
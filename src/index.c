@@ -1,10 +1,24 @@
 #include "index.h"
+#include <pthread.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
+
+#include "align.h"
+#include "dictionary.h"
+#include "simd.h"
+#include "ssdio.h"
 
 #define INITIAL_BUCKETS 128
 
+// Bulk build (index_create): entries are partitioned by the low bits of their bucket hash, so
+// every partition maps to its own set of buckets once there are at least as many buckets
+#define INDEX_BUILD_PARTITIONS 64
+#define INDEX_BUILD_MAX_THREADS 16
+#define INDEX_BUILD_MIN_PAGES 64  // Table pages per scan thread
+
 // Constants for the hashing
 #define FNV_PRIME_64 0x100000001b3UL
 #define FNV_OFFSET_BASIS_64 0xcbf29ce484222325UL
@@ -13,8 +27,121 @@
 #define PANIC_LOAD_NUMERATOR 2
 #define PANIC_LOAD_DENOMINATOR 1
 
-// Calculate chain length for Lazy-Split check
-static size_t get_chain_length(index_node_t* head) {
+#define INDEX_FILE_VERSION 4
+
+// Smallest Bloom filter, so a small index does not rebuild its filter on every few inserts
+#define INDEX_BLOOM_MIN_KEYS 1024
+
+#define INDEX_SLOT_MASK ((1ULL << INDEX_SLOT_BITS) - 1)
+
+_Static_assert(sizeof(index_file_page_t) <= PAGE_SIZE, "Index file page must fit in a page");
+_Static_assert(sizeof(index_file_meta_t) <= PAGE_SIZE, "Index file meta must fit in a page");
+_Static_assert(sizeof(index_block_t) == 2 * INDEX_CACHE_LINE_SIZE, "Index block must span two cache lines");
+_Static_assert(offsetof(index_block_t, tuple_ids) == INDEX_CACHE_LINE_SIZE, "Index block keys must fill the first cache line");
+_Static_assert(INDEX_BLOCK_ENTRIES * sizeof(unsigned char*) <= INDEX_CACHE_LINE_SIZE, "Index block values must fit in a cache line");
+_Static_assert(sizeof(index_file_entry_t) + INDEX_MAX_VALUE_SIZE <= sizeof(((index_file_page_t*)NULL)->data), "Index file entries must fit in a page");
+_Static_assert(INDEX_BUILD_PARTITIONS <= INITIAL_BUCKETS, "Every build partition needs its own buckets");
+_Static_assert(INITIAL_BUCKETS % INDEX_FILE_GROUP_BUCKETS == 0, "Bucket capacity must be a whole number of groups");
+
+static index_t* create_index(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count);
+static index_t* open_index(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count);
+static bool set_layout(index_t* idx, const system_catalog_t* catalog, const uint8_t* attribute_indexes,
+                       uint8_t attribute_count);
+static bool attach_file(dbms_session_t* session, index_t* idx, bool is_new);
+static void mark_bucket_dirty(index_t* idx, size_t bucket);
+static bool page_list_push(index_page_list_t* list, uint64_t page_id);
+static bool resize_page_list(index_t* idx, index_page_list_t* list, size_t count);
+static bool bulk_build(dbms_session_t* session, index_t* idx);
+static bool sync_group(index_t* idx, size_t group, index_file_page_t* page);
+static bool sync_directory(index_t* idx, index_file_page_t* page);
+static bool sync_free_pages(index_t* idx, index_file_page_t* page);
+static bool load_file(index_t* idx, index_file_page_t* page);
+static void rebuild_bloom(index_t* idx);
+
+static uint64_t pack_tuple_id(tuple_id_t tuple_id) {
+    return (tuple_id.page_id << INDEX_SLOT_BITS) | tuple_id.slot_id;
+}
+
+static tuple_id_t unpack_tuple_id(uint64_t packed) {
+    tuple_id_t tuple_id = {packed >> INDEX_SLOT_BITS, packed & INDEX_SLOT_MASK};
+    return tuple_id;
+}
+
+// Takes a block from the free list, or the next unused block of the current slab
+static index_block_t* alloc_block(index_allocator_t* allocator) {
+    index_block_t* block = allocator->free_blocks;
+    if (block) {
+        allocator->free_blocks = block->next;
+    } else {
+        if (!allocator->slabs || allocator->slabs->used == INDEX_SLAB_BLOCKS) {
+            index_slab_t* slab = aligned_alloc(INDEX_CACHE_LINE_SIZE, sizeof(index_slab_t) + INDEX_SLAB_BLOCKS * allocator->block_size);
+            if (!slab) {
+                fprintf(stderr, "Memory allocation failed for index slab\n");
+                return NULL;
+            }
+            slab->used = 0;
+            slab->next = allocator->slabs;
+            allocator->slabs = slab;
+        }
+        block = (index_block_t*)(allocator->slabs->blocks + allocator->slabs->used++ * allocator->block_size);
+    }
+
+    block->count = 0;
+    block->next = NULL;
+    return block;
+}
+
+// Returns a block to the free list, its memory is released with its slab
+static void release_block(index_allocator_t* allocator, index_block_t* block) {
+    block->next = allocator->free_blocks;
+    allocator->free_blocks = block;
+}
+
+// Adds an entry to the first block of a chain, only the first block can have room
+// bytes are the owned encoded values, NULL when the index keeps none
+static bool chain_append(index_allocator_t* allocator, index_block_t** head, uint64_t key, uint64_t packed_tuple_id,
+                         unsigned char* bytes) {
+    index_block_t* block = *head;
+    if (!block || block->count == INDEX_BLOCK_ENTRIES) {
+        block = alloc_block(allocator);
+        if (!block) return false;
+        block->next = *head;
+        *head = block;
+    }
+
+    block->keys[block->count] = key;
+    block->tuple_ids[block->count] = packed_tuple_id;
+    if (bytes) block->values[block->count] = bytes;
+    block->count++;
+    return true;
+}
+
+// Bitmask of the entries in a block that hold the values (key and bytes from encode_values)
+static uint32_t match_block(const index_t* idx, const index_block_t* block, uint64_t key, const unsigned char* bytes) {
+    uint32_t matches = simd_match_u64(block->keys, block->count, key);
+    if (idx->value_size == 0) return matches;
+
+    // Equal hashes are only candidates for strings and composite keys
+    uint32_t verified = matches;
+    while (matches) {
+        uint32_t i = (uint32_t)__builtin_ctz(matches);
+        matches &= matches - 1;
+        if (memcmp(block->values[i], bytes, idx->value_size) != 0) verified &= ~(1u << i);
+    }
+    return verified;
+}
+
+// Number of entries in a chain
+static size_t get_entry_count(const index_block_t* head) {
+    size_t count = 0;
+    for (; head; head = head->next) {
+        count += head->count;
+    }
+    return count;
+}
+
+// Calculate chain length (in blocks) for Lazy-Split check
+static size_t get_chain_length(index_block_t* head) {
     size_t count = 0;
     while (head) {
         count++;
@@ -23,43 +150,93 @@ static size_t get_chain_length(index_node_t* head) {
     return count;
 }
 
-static uint64_t hash_bytes(const void* data, size_t len) {
+// FNV-1a over a null-terminated string in one pass, without a separate strlen
+static uint64_t hash_string(const char* str) {
     uint64_t hash = FNV_OFFSET_BASIS_64;
-    const uint8_t* p = (const uint8_t*)data;
-    for (size_t i = 0; i < len; i++) {
-        hash ^= p[i];
+    for (const uint8_t* p = (const uint8_t*)str; *p; p++) {
+        hash ^= *p;
         hash *= FNV_PRIME_64;
     }
     return hash;
 }
 
-uint64_t index_hash_attribute(const attribute_value_t* value) {
+uint64_t index_encode_key(const attribute_value_t* value) {
     if (!value) return 0;
     switch (value->type) {
         case ATTRIBUTE_TYPE_INT:
-            return hash_bytes(&value->int_value, sizeof(value->int_value));
-        case ATTRIBUTE_TYPE_FLOAT:
-            return hash_bytes(&value->float_value, sizeof(value->float_value));
+            return (uint32_t)value->int_value;
+        case ATTRIBUTE_TYPE_FLOAT: {
+            // -0.0 == 0.0, so both get the same key
+            float f = value->float_value == 0.0f ? 0.0f : value->float_value;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
         case ATTRIBUTE_TYPE_BOOL:
-            return hash_bytes(&value->bool_value, sizeof(value->bool_value));
+            return value->bool_value ? 1 : 0;
         case ATTRIBUTE_TYPE_STRING:
-            return hash_bytes(value->string_value, strlen(value->string_value));
+            return value->string_value ? hash_string(value->string_value) : 0;
         default:
             return 0;
     }
 }
 
+// Spreads a key over the bucket bits, INT and BOOL keys are small consecutive values
+static uint64_t bucket_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+// Key of an entry and, when the index keeps them, its encoded values: each key attribute in key order,
+// STRING values zero-padded to the attribute size and the others as their 4-byte (or BOOL 1-byte) key.
+// Fails if a value does not have its attribute's type or a string is longer than the attribute.
+static bool encode_values(const index_t* idx, const attribute_value_t* values, uint64_t* key, unsigned char* bytes) {
+    if (!values) return false;
+    uint64_t composite_key = FNV_OFFSET_BASIS_64;
+    size_t offset = 0;
+    for (uint8_t i = 0; i < idx->attribute_count; i++) {
+        const attribute_value_t* value = &values[i];
+        if (value->type != idx->attribute_types[i]) return false;
+        if (value->type == ATTRIBUTE_TYPE_STRING &&
+            (!value->string_value || strnlen(value->string_value, idx->value_sizes[i] + 1) > idx->value_sizes[i])) {
+            return false;
+        }
+
+        uint64_t value_key = index_encode_key(value);
+        if (i == 0) *key = value_key;
+        composite_key = (composite_key ^ value_key) * FNV_PRIME_64;
+        if (idx->value_size > 0) {
+            if (value->type == ATTRIBUTE_TYPE_STRING) {
+                strncpy((char*)bytes + offset, value->string_value, idx->value_sizes[i]);
+            } else if (value->type == ATTRIBUTE_TYPE_BOOL) {
+                bytes[offset] = (unsigned char)value_key;
+            } else {
+                store_u32(bytes + offset, (uint32_t)value_key);
+            }
+        }
+        offset += idx->value_sizes[i];
+    }
+
+    if (idx->attribute_count > 1) *key = composite_key;
+    return true;
+}
+
 // Calculate the bucket address using Linear Hashing rules
 static size_t get_bucket_address(index_t* idx, uint64_t key) {
+    uint64_t hash = bucket_hash(key);
     // H_L(k) = key % (2^L * initial_buckets)
     size_t multiplier = (1ULL << idx->level);
     size_t mask = (multiplier * idx->initial_bucket_count) - 1;
-    size_t addr = key & mask;
+    size_t addr = hash & mask;
 
     if (addr < idx->next_split) {
         // H_{L+1}(k) = key % (2^{L+1} * initial_buckets)
         size_t next_mask = ((multiplier << 1) * idx->initial_bucket_count) - 1;
-        addr = key & next_mask;
+        addr = hash & next_mask;
     }
     return addr;
 }
@@ -75,35 +252,52 @@ static void perform_split(index_t* idx) {
     // Expand buckets array if necessary
     if (new_bucket_idx >= idx->capacity) {
         size_t new_capacity = idx->capacity * 2; // Double the size
-        index_node_t** new_buckets = realloc(idx->buckets, new_capacity * sizeof(index_node_t*));
+        index_block_t** new_buckets = realloc(idx->buckets, new_capacity * sizeof(index_block_t*));
         if (!new_buckets) return; // Handle allocation failure
         
         // Zero out the newly allocated region
-        memset(new_buckets + idx->capacity, 0, (new_capacity - idx->capacity) * sizeof(index_node_t*));
+        memset(new_buckets + idx->capacity, 0, (new_capacity - idx->capacity) * sizeof(index_block_t*));
         
         idx->buckets = new_buckets;
+
+        size_t group_capacity = idx->capacity / INDEX_FILE_GROUP_BUCKETS;
+        size_t new_group_capacity = new_capacity / INDEX_FILE_GROUP_BUCKETS;
+        index_page_list_t* new_pages = realloc(idx->group_pages, new_group_capacity * sizeof(index_page_list_t));
+        if (!new_pages) return;
+        memset(new_pages + group_capacity, 0, (new_group_capacity - group_capacity) * sizeof(index_page_list_t));
+        idx->group_pages = new_pages;
+
         idx->capacity = new_capacity;
     }
     
     // Redistribute items from buckets[split_idx]
-    index_node_t* current = idx->buckets[split_idx];
+    index_block_t* current = idx->buckets[split_idx];
     idx->buckets[split_idx] = NULL; // Clear old bucket, will rebuild
     idx->buckets[new_bucket_idx] = NULL;
 
     while (current) {
-        index_node_t* next = current->next;
-        
-        // Re-hash using the next level function H_{L+1}
-        size_t next_mask = ((multiplier << 1) * idx->initial_bucket_count) - 1;
-        size_t addr = current->key & next_mask;
+        index_block_t* next = current->next;
 
-        // Insert into appropriate bucket (either split_idx or new_bucket_idx)
-        current->next = idx->buckets[addr];
-        idx->buckets[addr] = current;
+        for (uint32_t i = 0; i < current->count; i++) {
+            // Re-hash using the next level function H_{L+1}
+            size_t next_mask = ((multiplier << 1) * idx->initial_bucket_count) - 1;
+            size_t addr = bucket_hash(current->keys[i]) & next_mask;
+
+            // Insert into appropriate bucket (either split_idx or new_bucket_idx)
+            unsigned char* bytes = idx->value_size > 0 ? current->values[i] : NULL;
+            chain_append(&idx->allocator, &idx->buckets[addr], current->keys[i], current->tuple_ids[i], bytes);
+        }
 
+        // Every entry was copied out, the block can be reused by the next append
+        release_block(&idx->allocator, current);
         current = next;
     }
 
+    // Both buckets have to be rewritten, a new group also needs a directory entry
+    mark_bucket_dirty(idx, split_idx);
+    mark_bucket_dirty(idx, new_bucket_idx);
+    idx->directory_pages.is_dirty = true;
+
     // Advance split pointer
     idx->next_split++;
     idx->bucket_count++; // Logically added one bucket
@@ -115,76 +309,531 @@ static void perform_split(index_t* idx) {
     }
 }
 
-index_t* index_create(dbms_session_t* session, uint8_t attribute_index) {
-    if (!session) return NULL;
+typedef struct {
+    uint64_t key;
+    uint64_t tuple_id;  // Packed
+} build_entry_t;
 
-    index_t* idx = calloc(1, sizeof(index_t));
-    if (!idx) return NULL;
+// Entries whose bucket hash has the same low bits, values is only used when the index keeps them
+typedef struct {
+    build_entry_t* entries;
+    unsigned char** values;
+    size_t count;
+    size_t capacity;
+} build_partition_t;
+
+typedef struct {
+    dbms_session_t* session;
+    index_t* idx;
+    uint64_t first_page;  // Table pages scanned by this worker
+    uint64_t last_page;
+    size_t worker_index;  // Builds partitions worker_index, worker_index + worker_count, ...
+    size_t worker_count;
+    build_partition_t partitions[INDEX_BUILD_PARTITIONS];
+    index_allocator_t allocator;  // Blocks of the buckets built by this worker, spliced into the index
+    bool ok;
+} build_worker_t;
+
+static bool partition_push(build_partition_t* partition, uint64_t key, uint64_t packed_tuple_id, unsigned char* bytes) {
+    if (partition->count == partition->capacity) {
+        size_t new_capacity = partition->capacity ? partition->capacity * 2 : 256;
+        build_entry_t* new_entries = realloc(partition->entries, new_capacity * sizeof(build_entry_t));
+        if (!new_entries) return false;
+        partition->entries = new_entries;
+        if (bytes || partition->values) {
+            unsigned char** new_values = realloc(partition->values, new_capacity * sizeof(unsigned char*));
+            if (!new_values) return false;
+            partition->values = new_values;
+        }
+        partition->capacity = new_capacity;
+    }
+
+    build_entry_t entry = {key, packed_tuple_id};
+    partition->entries[partition->count] = entry;
+    if (bytes) partition->values[partition->count] = bytes;
+    partition->count++;
+    return true;
+}
+
+// Phase 1: reads the worker's table pages straight from the file and partitions their entries
+static void* scan_pages(void* arg) {
+    build_worker_t* worker = (build_worker_t*)arg;
+    const index_t* idx = worker->idx;
+    const system_catalog_t* catalog = worker->session->catalog;
+    uint64_t tuples_per_page = dbms_catalog_tuples_per_page(catalog);
+    off_t offsets[INDEX_MAX_ATTRIBUTES];
+    size_t strides[INDEX_MAX_ATTRIBUTES];
+    for (uint8_t i = 0; i < idx->attribute_count; i++) {
+        offsets[i] = dbms_get_column_offset(catalog, idx->attribute_indexes[i]);
+        strides[i] = dbms_get_column_stride(catalog, idx->attribute_indexes[i]);
+    }
 
+    page_t* page = aligned_alloc(PAGE_SIZE, dbms_frame_size(catalog));
+    // Slotted records are unpacked into columns at those offsets, each worker has its own
+    size_t unpacked_size = dbms_get_unpacked_size(catalog);
+    char* columns = unpacked_size > 0 ? malloc(unpacked_size) : NULL;
+    bool unpacked_attributes[CATALOG_MAX_RECORDS] = {false};
+    for (uint8_t i = 0; i < idx->attribute_count; i++) {
+        unpacked_attributes[idx->attribute_indexes[i]] = true;
+    }
+    if (!page || (unpacked_size > 0 && !columns)) {
+        fprintf(stderr, "Memory allocation failed for index build page\n");
+        free(page);
+        free(columns);
+        worker->ok = false;
+        return NULL;
+    }
+
+    // Strings are not terminated in the page
+    char strings[INDEX_MAX_ATTRIBUTES][UINT8_MAX + 1];
+    for (uint64_t page_id = worker->first_page; page_id <= worker->last_page && worker->ok; page_id++) {
+        if (!dbms_read_table_page(worker->session, page_id, page) ||
+            (columns && !dbms_unpack_page(worker->session, page, unpacked_attributes, columns))) {
+            fprintf(stderr, "Failed to read page %llu while building the index\n", (unsigned long long)page_id);
+            worker->ok = false;
+            break;
+        }
+        const char* data = columns ? columns : page->data;
+
+        for (uint64_t slot = dbms_next_live_slot(catalog, page, 0); slot < tuples_per_page;
+             slot = dbms_next_live_slot(catalog, page, slot + 1)) {
+
+            attribute_value_t values[INDEX_MAX_ATTRIBUTES];
+            for (uint8_t i = 0; i < idx->attribute_count; i++) {
+                const char* attribute_data = data + offsets[i] + slot * strides[i];
+                values[i].type = idx->attribute_types[i];
+                switch (idx->attribute_types[i]) {
+                    case ATTRIBUTE_TYPE_INT:
+                        values[i].int_value = (int32_t)load_u32(attribute_data);
+                        break;
+                    case ATTRIBUTE_TYPE_FLOAT:
+                        values[i].float_value = load_f32(attribute_data);
+                        break;
+                    case ATTRIBUTE_TYPE_BOOL:
+                        values[i].bool_value = load_u8(attribute_data) != 0;
+                        break;
+                    case ATTRIBUTE_TYPE_STRING:
+                        if (dbms_is_dictionary_encoded(catalog, idx->attribute_indexes[i])) {
+                            attribute_data = dictionary_decode(worker->session->dictionary, idx->attribute_indexes[i],
+                                                               load_u16(attribute_data));
+                        }
+                        strncpy(strings[i], attribute_data, idx->value_sizes[i]);
+                        strings[i][idx->value_sizes[i]] = '\0';
+                        values[i].string_value = strings[i];
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            // The index owns the encoded values, they are handed to the bucket as is
+            unsigned char* bytes = NULL;
+            if (idx->value_size > 0) {
+                bytes = malloc(idx->value_size);
+                if (!bytes) {
+                    fprintf(stderr, "Memory allocation failed for index key\n");
+                    worker->ok = false;
+                    break;
+                }
+            }
+
+            uint64_t key = 0;
+            encode_values(idx, values, &key, bytes);
+            tuple_id_t tuple_id = {page_id, slot};
+            build_partition_t* partition = &worker->partitions[bucket_hash(key) & (INDEX_BUILD_PARTITIONS - 1)];
+            if (!partition_push(partition, key, pack_tuple_id(tuple_id), bytes)) {
+                fprintf(stderr, "Memory allocation failed for index build partition\n");
+                free(bytes);
+                worker->ok = false;
+                break;
+            }
+        }
+    }
+
+    free(page);
+    free(columns);
+    return NULL;
+}
+
+// Phase 2: moves the entries of the worker's partitions into their buckets. No other worker
+// touches those buckets, so chains are built without locks and without splits.
+static void* build_partitions(void* arg) {
+    build_worker_t* worker = (build_worker_t*)arg;
+    index_t* idx = worker->idx;
+    size_t mask = idx->bucket_count - 1;
+    build_worker_t* workers = worker - worker->worker_index;  // Workers are one array
+
+    for (size_t p = worker->worker_index; p < INDEX_BUILD_PARTITIONS; p += worker->worker_count) {
+        // Every scan thread produced its share of partition p
+        for (size_t w = 0; w < worker->worker_count; w++) {
+            build_partition_t* partition = &workers[w].partitions[p];
+            for (size_t i = 0; i < partition->count; i++) {
+                const build_entry_t* entry = &partition->entries[i];
+                unsigned char* bytes = partition->values ? partition->values[i] : NULL;
+                // After a failure the remaining values are only released
+                if (!worker->ok ||
+                    !chain_append(&worker->allocator, &idx->buckets[bucket_hash(entry->key) & mask], entry->key,
+                                  entry->tuple_id, bytes)) {
+                    free(bytes);
+                    worker->ok = false;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Runs fn on every worker, worker 0 on the calling thread
+static bool run_workers(build_worker_t* workers, size_t worker_count, void* (*fn)(void*)) {
+    pthread_t threads[INDEX_BUILD_MAX_THREADS];
+    bool started[INDEX_BUILD_MAX_THREADS] = {false};
+    for (size_t i = 1; i < worker_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, fn, &workers[i]) == 0;
+        if (!started[i]) fn(&workers[i]);
+    }
+    fn(&workers[0]);
+
+    bool ok = true;
+    for (size_t i = 0; i < worker_count; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        ok = ok && workers[i].ok;
+    }
+    return ok;
+}
+
+// Writes the dirty table frames back without evicting them, so the scan sees every change
+static bool write_back_table_pages(dbms_session_t* session) {
+    if (!session->buffer_pool) return true;
+    for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+        buffer_page_t* buffer_page = &session->buffer_pool->buffer_pages[i];
+        if (buffer_page->is_free || !buffer_page->is_dirty || buffer_page->file_id != DBMS_TABLE_FILE_ID) continue;
+        if (!dbms_write_table_page(session, buffer_page->page_id, buffer_page->page)) {
+            fprintf(stderr, "Failed to flush buffer page %llu to disk\n", (unsigned long long)buffer_page->page_id);
+            return false;
+        }
+        buffer_page->is_dirty = false;
+    }
+    return true;
+}
+
+// Populates an empty index: a parallel scan partitions the (key, tuple ID) pairs by bucket hash,
+// then the bucket array is allocated once for the final row count and filled partition by partition
+static bool bulk_build(dbms_session_t* session, index_t* idx) {
+    if (!write_back_table_pages(session)) return false;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t worker_count = session->page_count / INDEX_BUILD_MIN_PAGES;
+    if (cpus > 0 && worker_count > (size_t)cpus) worker_count = (size_t)cpus;
+    if (worker_count > INDEX_BUILD_MAX_THREADS) worker_count = INDEX_BUILD_MAX_THREADS;
+    if (worker_count == 0) worker_count = 1;
+
+    build_worker_t* workers = calloc(worker_count, sizeof(build_worker_t));
+    if (!workers) {
+        fprintf(stderr, "Memory allocation failed for index build\n");
+        return false;
+    }
+    uint64_t pages_per_worker = (session->page_count + worker_count - 1) / worker_count;
+    for (size_t i = 0; i < worker_count; i++) {
+        build_worker_t* worker = &workers[i];
+        worker->session = session;
+        worker->idx = idx;
+        worker->first_page = 1 + i * pages_per_worker;
+        worker->last_page = worker->first_page + pages_per_worker - 1;
+        if (worker->last_page > session->page_count) worker->last_page = session->page_count;
+        worker->worker_index = i;
+        worker->worker_count = worker_count;
+        worker->allocator.block_size = idx->allocator.block_size;
+        worker->ok = true;
+    }
+
+    bool ok = run_workers(workers, worker_count, scan_pages);
+
+    // Smallest level whose buckets hold every entry below the split load factor
+    size_t total = 0;
+    for (size_t i = 0; i < worker_count; i++) {
+        for (size_t p = 0; p < INDEX_BUILD_PARTITIONS; p++) {
+            total += workers[i].partitions[p].count;
+        }
+    }
     idx->initial_bucket_count = INITIAL_BUCKETS;
-    idx->bucket_count = INITIAL_BUCKETS;
     idx->level = 0;
+    while (total * LOAD_FACTOR_DENOMINATOR >
+           ((size_t)INITIAL_BUCKETS << idx->level) * INDEX_BLOCK_ENTRIES * LOAD_FACTOR_NUMERATOR) {
+        idx->level++;
+    }
+    idx->bucket_count = (size_t)INITIAL_BUCKETS << idx->level;
     idx->next_split = 0;
-    idx->num_records = 0;
+    idx->capacity = idx->bucket_count * 2;
+    idx->buckets = calloc(idx->capacity, sizeof(index_block_t*));
+    idx->group_pages = calloc(idx->capacity / INDEX_FILE_GROUP_BUCKETS, sizeof(index_page_list_t));
+    if (ok && (!idx->buckets || !idx->group_pages)) {
+        fprintf(stderr, "Memory allocation failed for index buckets\n");
+        ok = false;
+    }
 
-    idx->capacity = INITIAL_BUCKETS * 2; 
-    
-    idx->buckets = calloc(idx->capacity, sizeof(index_node_t*));
-    if (!idx->buckets) {
+    bool built = false;
+    if (ok) {
+        ok = run_workers(workers, worker_count, build_partitions);
+        built = true;
+    }
+
+    for (size_t i = 0; i < worker_count; i++) {
+        // The index takes over the blocks, index_free releases them (and their values)
+        index_slab_t* slab = workers[i].allocator.slabs;
+        while (slab) {
+            index_slab_t* next = slab->next;
+            slab->next = idx->allocator.slabs;
+            idx->allocator.slabs = slab;
+            slab = next;
+        }
+        for (size_t p = 0; p < INDEX_BUILD_PARTITIONS; p++) {
+            build_partition_t* partition = &workers[i].partitions[p];
+            for (size_t j = 0; !built && partition->values && j < partition->count; j++) {
+                free(partition->values[j]);
+            }
+            free(partition->entries);
+            free(partition->values);
+        }
+    }
+    free(workers);
+
+    idx->num_records = ok ? total : 0;
+    return ok;
+}
+
+index_t* index_create(dbms_session_t* session, uint8_t attribute_index) {
+    if (!session || attribute_index >= dbms_catalog_num_used(session->catalog)) return NULL;
+
+    // The open index shares the index file that is about to be replaced
+    if (session->indexes && session->indexes[attribute_index]) {
+        index_free(session->indexes[attribute_index]);
+        session->indexes[attribute_index] = NULL;
+    }
+    return create_index(session, &attribute_index, 1);
+}
+
+index_t* index_open(dbms_session_t* session, uint8_t attribute_index) {
+    if (!session) return NULL;
+    return open_index(session, &attribute_index, 1);
+}
+
+index_t* index_create_composite(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count) {
+    if (!session || !attribute_indexes || attribute_count < 2) return NULL;
+    return create_index(session, attribute_indexes, attribute_count);
+}
+
+index_t* index_open_composite(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count) {
+    if (!session || !attribute_indexes || attribute_count < 2) return NULL;
+    return open_index(session, attribute_indexes, attribute_count);
+}
+
+void index_get_key_values(const index_t* idx, const attribute_value_t* attributes, attribute_value_t* values) {
+    if (!idx || !attributes || !values) return;
+    for (uint8_t i = 0; i < idx->attribute_count; i++) {
+        values[i] = attributes[idx->attribute_indexes[i]];
+    }
+}
+
+static index_t* create_index(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count) {
+    index_t* idx = calloc(1, sizeof(index_t));
+    if (!idx) return NULL;
+    idx->fd = -1;
+    if (!set_layout(idx, session->catalog, attribute_indexes, attribute_count)) {
         free(idx);
         return NULL;
     }
 
     // Populate index from existing data
-    uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
-    for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
-        for (uint64_t tuple_index = 0; tuple_index < tuples_per_page; tuple_index++) {
-            tuple_id_t tid = {page_id, tuple_index};
-            tuple_t* tuple = dbms_get_tuple(session, tid);
-            if (tuple && !tuple->is_null) {
-                uint64_t key = index_hash_attribute(&tuple->attributes[attribute_index]);
-                index_insert(idx, key, tid);
-            }
-        }
+    if (!bulk_build(session, idx)) {
+        index_free(idx);
+        return NULL;
     }
+    rebuild_bloom(idx);
 
+    // Write every bucket to a fresh index file
+    if (!attach_file(session, idx, true)) {
+        index_free(idx);
+        return NULL;
+    }
+    for (size_t b = 0; b < idx->bucket_count; b += INDEX_FILE_GROUP_BUCKETS) {
+        mark_bucket_dirty(idx, b);
+    }
+    idx->directory_pages.is_dirty = true;
+    if (!index_sync(idx)) {
+        fprintf(stderr, "Failed to write index file: %s\n", idx->filename);
+        index_free(idx);
+        return NULL;
+    }
+
+    return idx;
+}
+
+static index_t* open_index(dbms_session_t* session, const uint8_t* attribute_indexes, uint8_t attribute_count) {
+    index_t* idx = calloc(1, sizeof(index_t));
+    if (!idx) return NULL;
+    idx->fd = -1;
+
+    // A missing file just means the attributes have no index
+    if (!set_layout(idx, session->catalog, attribute_indexes, attribute_count) || !attach_file(session, idx, false)) {
+        index_free(idx);
+        return NULL;
+    }
+
+    index_file_page_t* page = aligned_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (!page) {
+        fprintf(stderr, "Memory allocation failed for index page\n");
+        ssdio_close(idx->fd);
+        idx->fd = -1;
+        index_free(idx);
+        return NULL;
+    }
+
+    bool loaded = load_file(idx, page);
+    free(page);
+    if (!loaded) {
+        fprintf(stderr, "Ignoring invalid index file: %s\n", idx->filename);
+        // Nothing to write back to a file that could not be read
+        ssdio_close(idx->fd);
+        idx->fd = -1;
+        index_free(idx);
+        return NULL;
+    }
+    rebuild_bloom(idx);
     return idx;
 }
 
+bool index_sync(index_t* idx) {
+    if (!idx) return false;
+    if (idx->fd < 0) return true;
+
+    index_file_page_t* page = aligned_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (!page) {
+        fprintf(stderr, "Memory allocation failed for index page\n");
+        return false;
+    }
+
+    // Only the groups touched since the last sync are rewritten
+    bool ok = true;
+    for (size_t g = 0; g * INDEX_FILE_GROUP_BUCKETS < idx->bucket_count && ok; g++) {
+        if (idx->group_pages[g].is_dirty) {
+            ok = sync_group(idx, g, page);
+        }
+    }
+    if (ok && idx->directory_pages.is_dirty) {
+        ok = sync_directory(idx, page);
+    }
+    if (ok && idx->free_pages.is_dirty) {
+        ok = sync_free_pages(idx, page);
+    }
+
+    if (ok && idx->meta_dirty) {
+        memset(page, 0, PAGE_SIZE);
+        index_file_meta_t* meta = (index_file_meta_t*)page;
+        memcpy(meta->magic, INDEX_FILE_MAGIC, sizeof(meta->magic));
+        meta->version = INDEX_FILE_VERSION;
+        meta->attribute_count = idx->attribute_count;
+        meta->value_size = idx->value_size;
+        memcpy(meta->attribute_indexes, idx->attribute_indexes, sizeof(meta->attribute_indexes));
+        memcpy(meta->attribute_types, idx->attribute_types, sizeof(meta->attribute_types));
+        meta->initial_bucket_count = idx->initial_bucket_count;
+        meta->bucket_count = idx->bucket_count;
+        meta->level = idx->level;
+        meta->next_split = idx->next_split;
+        meta->num_records = idx->num_records;
+        meta->page_count = idx->page_count;
+        meta->directory_page = idx->directory_pages.count > 0 ? idx->directory_pages.page_ids[0] : 0;
+        meta->free_page = idx->free_pages.count > 0 ? idx->free_pages.page_ids[0] : 0;
+        ok = ssdio_write_page(idx->fd, 0, (page_t*)page);
+        if (ok) idx->meta_dirty = false;
+    }
+
+    free(page);
+    if (!ok) {
+        fprintf(stderr, "Failed to sync index file: %s\n", idx->filename);
+        return false;
+    }
+    ssdio_flush(idx->fd);
+    return true;
+}
+
 void index_free(index_t* idx) {
     if (!idx) return;
 
-    // 1. Free the chains (Linked Lists)
-    for (size_t i = 0; i < idx->capacity; i++) {
-        index_node_t* node = idx->buckets[i];
-        while (node) {
-            index_node_t* temp = node;
-            node = node->next;
-            free(temp); // Free the node
+    // 0. Write back and close the index file
+    if (idx->fd >= 0) {
+        index_sync(idx);
+        ssdio_close(idx->fd);
+        idx->fd = -1;
+    }
+
+    // 1. Free the blocks (and the encoded values they own), a whole slab at a time
+    for (size_t i = 0; idx->value_size > 0 && idx->buckets && i < idx->capacity; i++) {
+        for (index_block_t* block = idx->buckets[i]; block; block = block->next) {
+            for (uint32_t j = 0; j < block->count; j++) {
+                free(block->values[j]);
+            }
         }
     }
+    index_slab_t* slab = idx->allocator.slabs;
+    while (slab) {
+        index_slab_t* next = slab->next;
+        free(slab);
+        slab = next;
+    }
 
     // 2. Free the array and the struct
+    bloom_free(idx->bloom);
     free(idx->buckets);
+    if (idx->group_pages) {
+        for (size_t i = 0; i < idx->capacity / INDEX_FILE_GROUP_BUCKETS; i++) {
+            free(idx->group_pages[i].page_ids);
+        }
+        free(idx->group_pages);
+    }
+    free(idx->directory_pages.page_ids);
+    free(idx->free_pages.page_ids);
+    free(idx->filename);
     free(idx);
 }
 
-void index_insert(index_t* idx, uint64_t key, tuple_id_t tuple_id) {
+void index_insert(index_t* idx, const attribute_value_t* values, tuple_id_t tuple_id) {
     if (!idx) return;
 
-    size_t bucket = get_bucket_address(idx, key);
-    
-    index_node_t* new_node = malloc(sizeof(index_node_t));
-    if (!new_node) return;
+    // The packed form keeps an entry at 16 bytes
+    if ((tuple_id.page_id >> (64 - INDEX_SLOT_BITS)) != 0 || tuple_id.slot_id > INDEX_SLOT_MASK) {
+        fprintf(stderr, "Tuple ID out of range for the index\n");
+        return;
+    }
 
-    new_node->key = key;
-    new_node->tuple_id = tuple_id;
-    new_node->next = idx->buckets[bucket];
-    idx->buckets[bucket] = new_node;
+    unsigned char* bytes = NULL;
+    if (idx->value_size > 0) {
+        bytes = malloc(idx->value_size);
+        if (!bytes) {
+            fprintf(stderr, "Memory allocation failed for index key\n");
+            return;
+        }
+    }
+
+    uint64_t key = 0;
+    if (!encode_values(idx, values, &key, bytes)) {
+        free(bytes);
+        return;
+    }
+    size_t bucket = get_bucket_address(idx, key);
+    if (!chain_append(&idx->allocator, &idx->buckets[bucket], key, pack_tuple_id(tuple_id), bytes)) {
+        free(bytes);
+        return;
+    }
     idx->num_records++;
+    mark_bucket_dirty(idx, bucket);
+    if (idx->bloom && idx->num_records > idx->bloom->capacity) {
+        rebuild_bloom(idx);
+    } else {
+        bloom_add(idx->bloom, key);
+    }
     
     size_t load_num = idx->num_records;
-    size_t load_den = idx->bucket_count;
+    size_t load_den = idx->bucket_count * INDEX_BLOCK_ENTRIES;
 
     // 1. Normal Trigger: Global Load > 75%
     bool high_load = (load_num * LOAD_FACTOR_DENOMINATOR) > (load_den * LOAD_FACTOR_NUMERATOR);
@@ -206,64 +855,413 @@ void index_insert(index_t* idx, uint64_t key, tuple_id_t tuple_id) {
     }
 }
 
-bool index_delete(index_t* idx, uint64_t key, tuple_id_t tuple_id) {
-    if (!idx) return false;
+bool index_delete(index_t* idx, const attribute_value_t* values, tuple_id_t tuple_id) {
+    uint64_t key = 0;
+    unsigned char bytes[INDEX_MAX_VALUE_SIZE];
+    if (!idx || !encode_values(idx, values, &key, bytes)) return false;
     
     size_t bucket = get_bucket_address(idx, key);
-    index_node_t* curr = idx->buckets[bucket];
-    index_node_t* prev = NULL;
-
-    while (curr) {
-        if (curr->key == key && 
-            curr->tuple_id.page_id == tuple_id.page_id && 
-            curr->tuple_id.slot_id == tuple_id.slot_id) {
-            
-            if (prev) {
-                prev->next = curr->next;
-            } else {
-                idx->buckets[bucket] = curr->next;
+    uint64_t packed_tuple_id = pack_tuple_id(tuple_id);
+    index_block_t* head = idx->buckets[bucket];
+
+    for (index_block_t* block = head; block; block = block->next) {
+        uint32_t matches = match_block(idx, block, key, bytes);
+        while (matches) {
+            uint32_t i = (uint32_t)__builtin_ctz(matches);
+            matches &= matches - 1;
+            if (block->tuple_ids[i] != packed_tuple_id) continue;
+
+            // Fill the hole with the last entry of the first block so the other blocks stay full
+            head->count--;
+            block->keys[i] = head->keys[head->count];
+            block->tuple_ids[i] = head->tuple_ids[head->count];
+            if (idx->value_size > 0) {
+                free(block->values[i]);
+                block->values[i] = head->values[head->count];
+            }
+            if (head->count == 0) {
+                idx->buckets[bucket] = head->next;
+                release_block(&idx->allocator, head);
             }
-            free(curr);
             idx->num_records--;
+            mark_bucket_dirty(idx, bucket);
             return true;
         }
-        prev = curr;
-        curr = curr->next;
     }
     return false;
 }
 
-tuple_id_t* index_lookup(index_t* idx, uint64_t key, size_t* out_count) {
+tuple_id_t* index_lookup(index_t* idx, const attribute_value_t* values, size_t* out_count) {
     if (!idx || !out_count) return NULL;
     
     *out_count = 0;
+    uint64_t key = 0;
+    unsigned char bytes[INDEX_MAX_VALUE_SIZE];
+    if (!encode_values(idx, values, &key, bytes) || !bloom_may_contain(idx->bloom, key)) return NULL;
     size_t bucket = get_bucket_address(idx, key);
     
-    // First pass: count matches
+    // Single pass, the result array grows as matches are found
+    tuple_id_t* results = NULL;
     size_t count = 0;
-    index_node_t* curr = idx->buckets[bucket];
-    while (curr) {
-        if (curr->key == key) {
-            count++;
+    size_t capacity = 0;
+    for (index_block_t* block = idx->buckets[bucket]; block; block = block->next) {
+        uint32_t matches = match_block(idx, block, key, bytes);
+        while (matches) {
+            uint32_t i = (uint32_t)__builtin_ctz(matches);
+            matches &= matches - 1;
+
+            if (count == capacity) {
+                size_t new_capacity = capacity ? capacity * 2 : INDEX_BLOCK_ENTRIES;
+                tuple_id_t* new_results = realloc(results, new_capacity * sizeof(tuple_id_t));
+                if (!new_results) {
+                    free(results);
+                    return NULL;
+                }
+                results = new_results;
+                capacity = new_capacity;
+            }
+            results[count++] = unpack_tuple_id(block->tuple_ids[i]);
+        }
+    }
+
+    *out_count = count;
+    return results;
+}
+
+size_t index_count(index_t* idx, const attribute_value_t* values) {
+    uint64_t key = 0;
+    unsigned char bytes[INDEX_MAX_VALUE_SIZE];
+    if (!idx || !encode_values(idx, values, &key, bytes) || !bloom_may_contain(idx->bloom, key)) return 0;
+
+    size_t count = 0;
+    for (index_block_t* block = idx->buckets[get_bucket_address(idx, key)]; block; block = block->next) {
+        count += (size_t)__builtin_popcount(match_block(idx, block, key, bytes));
+    }
+    return count;
+}
+
+bool index_may_contain(const index_t* idx, const attribute_value_t* values) {
+    uint64_t key = 0;
+    unsigned char bytes[INDEX_MAX_VALUE_SIZE];
+    if (!idx || !encode_values(idx, values, &key, bytes)) return false;
+    return bloom_may_contain(idx->bloom, key);
+}
+
+static int compare_tuple_ids(const void* a, const void* b) {
+    const tuple_id_t* lhs = (const tuple_id_t*)a;
+    const tuple_id_t* rhs = (const tuple_id_t*)b;
+    if (lhs->page_id != rhs->page_id) return lhs->page_id < rhs->page_id ? -1 : 1;
+    if (lhs->slot_id != rhs->slot_id) return lhs->slot_id < rhs->slot_id ? -1 : 1;
+    return 0;
+}
+
+void index_sort_tuple_ids(tuple_id_t* tuple_ids, size_t count) {
+    if (!tuple_ids || count < 2) return;
+    qsort(tuple_ids, count, sizeof(tuple_id_t), compare_tuple_ids);
+}
+
+// Block and file entry sizes depend on whether the entries keep their encoded values
+static bool set_layout(index_t* idx, const system_catalog_t* catalog, const uint8_t* attribute_indexes,
+                       uint8_t attribute_count) {
+    if (attribute_count == 0 || attribute_count > INDEX_MAX_ATTRIBUTES) {
+        fprintf(stderr, "An index covers 1 to %d attributes\n", INDEX_MAX_ATTRIBUTES);
+        return false;
+    }
+
+    idx->attribute_count = attribute_count;
+    idx->value_size = 0;
+    for (uint8_t i = 0; i < attribute_count; i++) {
+        const catalog_record_t* record = attribute_indexes[i] < dbms_catalog_num_used(catalog)
+            ? dbms_get_catalog_record(catalog, attribute_indexes[i]) : NULL;
+        if (!record || record->attribute_type == ATTRIBUTE_TYPE_UNUSED) return false;
+        for (uint8_t j = 0; j < i; j++) {
+            if (attribute_indexes[j] == attribute_indexes[i]) {
+                fprintf(stderr, "Attribute %s appears twice in the index\n", record->attribute_name);
+                return false;
+            }
         }
-        curr = curr->next;
+
+        idx->attribute_indexes[i] = attribute_indexes[i];
+        idx->attribute_types[i] = record->attribute_type;
+        switch (record->attribute_type) {
+            case ATTRIBUTE_TYPE_STRING:
+                idx->value_sizes[i] = record->attribute_size;
+                break;
+            case ATTRIBUTE_TYPE_BOOL:
+                idx->value_sizes[i] = 1;
+                break;
+            default:
+                idx->value_sizes[i] = sizeof(uint32_t);
+                break;
+        }
+        idx->value_size += idx->value_sizes[i];
+    }
+
+    // The key alone is exact for a single INT, FLOAT or BOOL attribute
+    if (attribute_count == 1 && idx->attribute_types[0] != ATTRIBUTE_TYPE_STRING) {
+        idx->value_size = 0;
+    }
+
+    idx->allocator.block_size = sizeof(index_block_t) + (idx->value_size > 0 ? INDEX_CACHE_LINE_SIZE : 0);
+    idx->file_entry_size = sizeof(index_file_entry_t) + idx->value_size;
+    idx->file_page_entries = sizeof(((index_file_page_t*)NULL)->data) / idx->file_entry_size;
+    return true;
+}
+
+// Composite index files are named after their attributes joined by DBMS_INDEX_NAME_SEPARATOR
+static bool attach_file(dbms_session_t* session, index_t* idx, bool is_new) {
+    idx->filename = dbms_get_composite_index_filename(session->filename, session->catalog, idx->attribute_indexes,
+                                                      idx->attribute_count, INDEX_FILE_EXTENSION);
+    if (!idx->filename) return false;
+
+    idx->fd = ssdio_open(idx->filename, is_new);
+    if (idx->fd < 0) {
+        if (is_new) fprintf(stderr, "Failed to create index file: %s\n", idx->filename);
+        return false;
     }
 
-    if (count == 0) return NULL;
+    // Page 0 is the metadata page
+    idx->page_count = 1;
+    idx->meta_dirty = true;
+    return true;
+}
 
-    tuple_id_t* results = malloc(count * sizeof(tuple_id_t));
-    if (!results) return NULL;
+static void mark_bucket_dirty(index_t* idx, size_t bucket) {
+    if (idx->group_pages) {
+        idx->group_pages[bucket / INDEX_FILE_GROUP_BUCKETS].is_dirty = true;
+    }
+    idx->meta_dirty = true;
+}
 
-    // Second pass: fill results
-    size_t i = 0;
-    curr = idx->buckets[bucket];
-    while (curr) {
-        if (curr->key == key) {
-            results[i++] = curr->tuple_id;
+static bool page_list_push(index_page_list_t* list, uint64_t page_id) {
+    if (list->count == list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 2;
+        uint64_t* new_ids = realloc(list->page_ids, new_capacity * sizeof(uint64_t));
+        if (!new_ids) {
+            fprintf(stderr, "Memory allocation failed for index page list\n");
+            return false;
         }
-        curr = curr->next;
+        list->page_ids = new_ids;
+        list->capacity = new_capacity;
     }
+    list->page_ids[list->count++] = page_id;
+    return true;
+}
 
-    *out_count = count;
-    return results;
+// Grows or shrinks a page list, reusing free pages before extending the file
+static bool resize_page_list(index_t* idx, index_page_list_t* list, size_t count) {
+    while (list->count > count) {
+        if (!page_list_push(&idx->free_pages, list->page_ids[--list->count])) return false;
+        idx->free_pages.is_dirty = true;
+    }
+    while (list->count < count) {
+        index_page_list_t* free_pages = &idx->free_pages;
+        uint64_t page_id = free_pages->count > 0 ? free_pages->page_ids[--free_pages->count] : idx->page_count++;
+        if (!page_list_push(list, page_id)) return false;
+        free_pages->is_dirty = true;
+    }
+    idx->meta_dirty = true;
+    return true;
+}
+
+static bool sync_group(index_t* idx, size_t group, index_file_page_t* page) {
+    index_page_list_t* pages = &idx->group_pages[group];
+    size_t first_bucket = group * INDEX_FILE_GROUP_BUCKETS;
+    size_t end_bucket = first_bucket + INDEX_FILE_GROUP_BUCKETS;
+    if (end_bucket > idx->bucket_count) end_bucket = idx->bucket_count;
+
+    size_t entry_count = 0;
+    for (size_t b = first_bucket; b < end_bucket; b++) {
+        entry_count += get_entry_count(idx->buckets[b]);
+    }
+    size_t page_count = entry_count == 0 ? 1 : (entry_count + idx->file_page_entries - 1) / idx->file_page_entries;
+    if (pages->count == 0) {
+        idx->directory_pages.is_dirty = true; // New primary page
+    }
+    if (pages->count != page_count && !resize_page_list(idx, pages, page_count)) return false;
+
+    // Primary page first, then overflow pages, the buckets of the group one after another
+    size_t bucket = first_bucket;
+    index_block_t* block = idx->buckets[bucket];
+    uint32_t position = 0;
+    for (size_t p = 0; p < pages->count; p++) {
+        memset(page, 0, PAGE_SIZE);
+        page->header.next_page = p + 1 < pages->count ? pages->page_ids[p + 1] : 0;
+        page->header.first = group;
+        while (page->header.count < idx->file_page_entries) {
+            if (!block || position == block->count) {
+                if (block) block = block->next;
+                while (!block && ++bucket < end_bucket) block = idx->buckets[bucket];
+                if (!block) break;
+                position = 0;
+                continue;
+            }
+            // Entries are packed at file_entry_size, which need not keep them aligned
+            unsigned char* entry = page->data + page->header.count * idx->file_entry_size;
+            index_file_entry_t file_entry = {block->keys[position], unpack_tuple_id(block->tuple_ids[position])};
+            memcpy(entry, &file_entry, sizeof(file_entry));
+            if (idx->value_size > 0) {
+                memcpy(entry + sizeof(file_entry), block->values[position], idx->value_size);
+            }
+            page->header.count++;
+            position++;
+        }
+        if (!ssdio_write_page(idx->fd, pages->page_ids[p], (page_t*)page)) return false;
+    }
+
+    pages->is_dirty = false;
+    return true;
+}
+
+static bool sync_directory(index_t* idx, index_file_page_t* page) {
+    index_page_list_t* pages = &idx->directory_pages;
+    size_t group_count = (idx->bucket_count + INDEX_FILE_GROUP_BUCKETS - 1) / INDEX_FILE_GROUP_BUCKETS;
+    size_t page_count = group_count == 0 ? 1 : (group_count + INDEX_FILE_DIRECTORY_ENTRIES - 1) / INDEX_FILE_DIRECTORY_ENTRIES;
+    if (pages->count != page_count && !resize_page_list(idx, pages, page_count)) return false;
+
+    for (size_t p = 0; p < pages->count; p++) {
+        memset(page, 0, PAGE_SIZE);
+        page->header.next_page = p + 1 < pages->count ? pages->page_ids[p + 1] : 0;
+        page->header.first = p * INDEX_FILE_DIRECTORY_ENTRIES;
+        for (size_t g = page->header.first; g < group_count && page->header.count < INDEX_FILE_DIRECTORY_ENTRIES; g++) {
+            const index_page_list_t* group_pages = &idx->group_pages[g];
+            page->group_pages[page->header.count++] = group_pages->count > 0 ? group_pages->page_ids[0] : 0;
+        }
+        if (!ssdio_write_page(idx->fd, pages->page_ids[p], (page_t*)page)) return false;
+    }
+
+    pages->is_dirty = false;
+    idx->meta_dirty = true;
+    return true;
+}
+
+static bool sync_free_pages(index_t* idx, index_file_page_t* page) {
+    // Free pages are chained so the next open can reuse them
+    index_page_list_t* pages = &idx->free_pages;
+    for (size_t p = 0; p < pages->count; p++) {
+        memset(page, 0, PAGE_SIZE);
+        page->header.next_page = p + 1 < pages->count ? pages->page_ids[p + 1] : 0;
+        if (!ssdio_write_page(idx->fd, pages->page_ids[p], (page_t*)page)) return false;
+    }
+
+    pages->is_dirty = false;
+    idx->meta_dirty = true;
+    return true;
+}
+
+static bool load_file(index_t* idx, index_file_page_t* page) {
+    if (!ssdio_read_page(idx->fd, 0, (page_t*)page)) return false;
+
+    index_file_meta_t meta;
+    memcpy(&meta, page, sizeof(meta));
+    if (memcmp(meta.magic, INDEX_FILE_MAGIC, sizeof(meta.magic)) != 0 || meta.version != INDEX_FILE_VERSION ||
+        meta.attribute_count != idx->attribute_count || meta.value_size != idx->value_size ||
+        memcmp(meta.attribute_indexes, idx->attribute_indexes, sizeof(meta.attribute_indexes)) != 0 ||
+        memcmp(meta.attribute_types, idx->attribute_types, sizeof(meta.attribute_types)) != 0 ||
+        meta.initial_bucket_count == 0 || meta.initial_bucket_count % INDEX_FILE_GROUP_BUCKETS != 0 ||
+        meta.bucket_count < meta.initial_bucket_count ||
+        meta.page_count == 0) {
+        return false;
+    }
+
+    idx->initial_bucket_count = meta.initial_bucket_count;
+    idx->bucket_count = meta.bucket_count;
+    idx->level = meta.level;
+    idx->next_split = meta.next_split;
+    idx->num_records = meta.num_records;
+    idx->page_count = meta.page_count;
+
+    // Room for the next split, like index_create
+    idx->capacity = idx->initial_bucket_count * 2;
+    while (idx->capacity <= idx->bucket_count) idx->capacity *= 2;
+    idx->buckets = calloc(idx->capacity, sizeof(index_block_t*));
+    idx->group_pages = calloc(idx->capacity / INDEX_FILE_GROUP_BUCKETS, sizeof(index_page_list_t));
+    if (!idx->buckets || !idx->group_pages) return false;
+    size_t group_count = (idx->bucket_count + INDEX_FILE_GROUP_BUCKETS - 1) / INDEX_FILE_GROUP_BUCKETS;
+
+    // Every page is visited at most once, which also stops on cycles in a damaged file
+    uint64_t pages_left = idx->page_count;
+
+    // Directory: primary page of every group
+    for (uint64_t page_id = meta.directory_page; page_id != 0; page_id = page->header.next_page) {
+        if (page_id >= idx->page_count || pages_left-- == 0) return false;
+        if (!ssdio_read_page(idx->fd, page_id, (page_t*)page)) return false;
+        if (!page_list_push(&idx->directory_pages, page_id)) return false;
+
+        uint64_t first = page->header.first;
+        uint64_t count = page->header.count;
+        if (count > INDEX_FILE_DIRECTORY_ENTRIES || first > group_count || count > group_count - first) return false;
+        for (uint64_t i = 0; i < count; i++) {
+            if (page->group_pages[i] != 0 && !page_list_push(&idx->group_pages[first + i], page->group_pages[i])) {
+                return false;
+            }
+        }
+    }
+
+    // Groups: follow each overflow chain and rebuild the in-memory chains of its buckets
+    for (size_t g = 0; g < group_count; g++) {
+        index_page_list_t* pages = &idx->group_pages[g];
+        if (pages->count == 0) {
+            pages->is_dirty = true; // Written (empty) by the next sync
+            continue;
+        }
+
+        uint64_t page_id = pages->page_ids[0];
+        pages->count = 0;
+        while (page_id != 0) {
+            if (page_id >= idx->page_count || pages_left-- == 0) return false;
+            if (!ssdio_read_page(idx->fd, page_id, (page_t*)page)) return false;
+            if (!page_list_push(pages, page_id) || page->header.count > idx->file_page_entries) return false;
+
+            for (uint64_t i = 0; i < page->header.count; i++) {
+                const unsigned char* entry = page->data + i * idx->file_entry_size;
+                index_file_entry_t file_entry;
+                memcpy(&file_entry, entry, sizeof(file_entry));
+                tuple_id_t tuple_id = file_entry.tuple_id;
+                if ((tuple_id.page_id >> (64 - INDEX_SLOT_BITS)) != 0 || tuple_id.slot_id > INDEX_SLOT_MASK) return false;
+                size_t bucket = get_bucket_address(idx, file_entry.key);
+                if (bucket / INDEX_FILE_GROUP_BUCKETS != g) return false;
+
+                unsigned char* bytes = NULL;
+                if (idx->value_size > 0) {
+                    bytes = malloc(idx->value_size);
+                    if (!bytes) return false;
+                    memcpy(bytes, entry + sizeof(file_entry), idx->value_size);
+                }
+                if (!chain_append(&idx->allocator, &idx->buckets[bucket], file_entry.key, pack_tuple_id(tuple_id), bytes)) {
+                    free(bytes);
+                    return false;
+                }
+            }
+            page_id = page->header.next_page;
+        }
+    }
+
+    // Unused pages
+    for (uint64_t page_id = meta.free_page; page_id != 0; page_id = page->header.next_page) {
+        if (page_id >= idx->page_count || pages_left-- == 0) return false;
+        if (!ssdio_read_page(idx->fd, page_id, (page_t*)page)) return false;
+        if (!page_list_push(&idx->free_pages, page_id)) return false;
+    }
+
+    idx->meta_dirty = false;
+    return true;
+}
+
+// Sizes a new filter for twice the current entries and adds every key. Without a filter
+// (allocation failure) probes just fall through to the buckets.
+static void rebuild_bloom(index_t* idx) {
+    uint64_t capacity = idx->num_records * 2;
+    bloom_filter_t* bloom = bloom_create(capacity > INDEX_BLOOM_MIN_KEYS ? capacity : INDEX_BLOOM_MIN_KEYS);
+    if (bloom) {
+        for (size_t i = 0; i < idx->bucket_count; i++) {
+            for (index_block_t* block = idx->buckets[i]; block; block = block->next) {
+                for (uint32_t j = 0; j < block->count; j++) {
+                    bloom_add(bloom, block->keys[j]);
+                }
+            }
+        }
+    }
+    bloom_free(idx->bloom);
+    idx->bloom = bloom;
 }
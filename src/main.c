@@ -4,6 +4,12 @@
 #include "dbms.h"
 #include "linenoise.h"
 
+#include <errno.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+static char* read_line(dbms_manager_t* manager);
+
 int main(int argc, char* argv[]) {
   // Read existing database
   // Make dbms manager
@@ -19,7 +25,7 @@ int main(int argc, char* argv[]) {
 
   // CLI loop
   while (true) {
-    char* input = linenoise(CLI_PROMPT);
+    char* input = read_line(manager);
     if (input == NULL) {
       printf("Exiting CLI.\n");
       break;
@@ -49,3 +55,50 @@ int main(int argc, char* argv[]) {
   dbms_free_dbms_manager(manager);
   return EXIT_SUCCESS;
 }
+
+// Runs vacuum steps while the user is not typing, so they make progress between commands
+static char* read_line(dbms_manager_t* manager) {
+  if (!isatty(STDIN_FILENO)) {
+    // Scripts see every vacuum finish before their next command
+    while (cli_has_background_work(manager)) {
+      cli_background_step(manager);
+      cli_background_finish(manager);
+    }
+    return linenoise(CLI_PROMPT);
+  }
+  if (!cli_has_background_work(manager)) {
+    return linenoise(CLI_PROMPT);
+  }
+
+  char buffer[INPUT_BUFFER_SIZE];
+  struct linenoiseState state;
+  if (linenoiseEditStart(&state, -1, -1, buffer, sizeof(buffer), CLI_PROMPT) == -1) {
+    return NULL;
+  }
+
+  char* line = linenoiseEditMore;
+  while (line == linenoiseEditMore) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(state.ifd, &read_fds);
+    struct timeval no_wait = {0};
+    bool has_work = cli_has_background_work(manager);
+    int ready = select(state.ifd + 1, &read_fds, NULL, NULL, has_work ? &no_wait : NULL);
+    if (ready == -1 && errno == EINTR) {
+      continue;
+    }
+    if (ready == -1) {
+      line = NULL;
+    } else if (ready == 0) {
+      if (cli_background_step(manager)) {
+        linenoiseHide(&state);
+        cli_background_finish(manager);
+        linenoiseShow(&state);
+      }
+    } else {
+      line = linenoiseEditFeed(&state);
+    }
+  }
+  linenoiseEditStop(&state);
+  return line;
+}
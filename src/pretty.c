@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "stats.h"
+
+static void print_stats_key(uint64_t key, uint8_t attribute_type);
+
 void print_catalog(const system_catalog_t* catalog) {
   if (!catalog) {
     printf("Catalog is NULL\n");
@@ -12,6 +16,12 @@ void print_catalog(const system_catalog_t* catalog) {
 
   printf("System Catalog:\n");
   printf("Tuple Size: %u bytes\n", catalog->tuple_size);
+  printf("Page Layout: %s\n", catalog->layout == CATALOG_LAYOUT_PAX       ? "PAX"
+                               : catalog->layout == CATALOG_LAYOUT_SLOTTED ? "Slotted"
+                               : catalog->layout == CATALOG_LAYOUT_BITMAP  ? "Bitmap"
+                                                                           : "NSM");
+  printf("Page Compression: %s\n", catalog->compression == CATALOG_COMPRESSION_LZ4 ? "LZ4" : "None");
+  printf("Page Size: %u bytes\n", dbms_page_size(catalog));
   printf("Record Count: %u\n", catalog->record_count);
   printf("Attributes:\n");
   for (uint8_t i = 0; i < catalog->record_count; i++) {
@@ -21,6 +31,36 @@ void print_catalog(const system_catalog_t* catalog) {
     printf("    Size: %u bytes\n", record->attribute_size);
     printf("    Type: %s\n", attribute_type_to_string(record->attribute_type));
     printf("    Order: %u\n", record->attribute_order);
+    if (dbms_is_dictionary_encoded(catalog, i)) {
+      printf("    Encoding: Dictionary (%u byte codes)\n", CATALOG_DICTIONARY_CODE_SIZE);
+    }
+  }
+}
+
+void print_stats(const dbms_session_t* session) {
+  if (!session || !session->stats) {
+    printf("Table has not been analyzed\n");
+    return;
+  }
+
+  const stats_file_meta_t* meta = &session->stats->meta;
+  printf("Statistics:\n");
+  printf("Rows: %.0f on %llu pages (%.0f estimated now on %u pages)\n", meta->row_count,
+         (unsigned long long)meta->page_count, stats_row_count(session), session->page_count);
+  printf("Pages Sampled: %llu\n", (unsigned long long)meta->pages_sampled);
+  printf("Null Fraction: %.3f\n", meta->null_fraction);
+  for (uint8_t i = 0; i < meta->column_count; i++) {
+    const stats_column_t* column = &session->stats->columns[i];
+    printf("  %s: ", dbms_get_catalog_record(session->catalog, i)->attribute_name);
+    if (column->bucket_count == 0) {
+      printf("no values sampled\n");
+      continue;
+    }
+    printf("%.0f distinct, min ", column->distinct_count);
+    print_stats_key(column->min_key, column->attribute_type);
+    printf(", max ");
+    print_stats_key(column->max_key, column->attribute_type);
+    printf(", %u histogram buckets\n", column->bucket_count);
   }
 }
 
@@ -49,12 +89,15 @@ void print_page(dbms_session_t* session, uint64_t page_id, bool print_nulls) {
   uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
   char* data = page->data;
   for (uint64_t i = 0; i < tuples_per_page; i++) {
-    char* tuple_data = data + (i * session->catalog->tuple_size);
     tuple_t* tuple = &buffer_page->tuples[i];
     if (tuple->is_null) {
       if (print_nulls) {
         printf("NULL Tuple %llu (%llu, %llu):\n", i, tuple->id.page_id, tuple->id.slot_id);
-        printf("  Next Free: %llu\n", *(uint64_t*)(tuple_data + FREE_POINTER_OFFSET));
+        // Only NSM pages have a free list, free_space_head is the lowest free slot (the heap start if slotted)
+        if (session->catalog->layout == CATALOG_LAYOUT_NSM) {
+          char* tuple_data = data + (i * session->catalog->tuple_size);
+          printf("  Next Free: %llu\n", *(uint64_t*)(tuple_data + FREE_POINTER_OFFSET));
+        }
       }
       continue;
     }
@@ -223,3 +266,34 @@ const char* attribute_type_to_string(uint8_t attribute_type) {
       return "UNUSED";
   }
 }
+
+// Inverts btree_normalize_key, STRING keys only hold the first 8 characters
+static void print_stats_key(uint64_t key, uint8_t attribute_type) {
+  switch (attribute_type) {
+    case ATTRIBUTE_TYPE_INT:
+      printf("%d", (int32_t)((uint32_t)key ^ 0x80000000u));
+      break;
+    case ATTRIBUTE_TYPE_FLOAT: {
+      uint32_t bits = (uint32_t)key;
+      bits = (bits & 0x80000000u) ? (bits & 0x7fffffffu) : ~bits;
+      float value = 0.0f;
+      memcpy(&value, &bits, sizeof(value));
+      printf("%f", value);
+      break;
+    }
+    case ATTRIBUTE_TYPE_BOOL:
+      printf("%s", key ? "true" : "false");
+      break;
+    case ATTRIBUTE_TYPE_STRING: {
+      char prefix[sizeof(key) + 1] = {0};
+      for (size_t i = 0; i < sizeof(key); i++) {
+        prefix[i] = (char)(key >> (8 * (sizeof(key) - 1 - i)));
+      }
+      printf("%s", prefix);
+      break;
+    }
+    default:
+      printf("?");
+      break;
+  }
+}
@@ -1,12 +1,28 @@
 #include "query.h"
+#include "dictionary.h"
 #include "index.h"
+#include "stats.h"
+#include "zone_map.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static query_result_t* allocate_query_result(size_t column_count);
-static void copy_attribute_values(attribute_value_t* dest, const attribute_value_t* src, size_t count);
+#define QUERY_RESULT_INITIAL_ROWS 64
+
+// Materialization state used by query_select
+typedef struct {
+  query_result_t* result;
+  const system_catalog_t* catalog;
+  size_t row_size;  // Attribute array plus inline string storage, 8 byte aligned
+  bool failed;
+} result_builder_t;
+
+static query_result_t* allocate_query_result(arena_t* arena, size_t column_count);
+static bool append_result_row(const tuple_t* tuple, void* context);
+static attribute_value_t* allocate_result_row(result_builder_t* builder);
+static bool tuple_matches(const tuple_t* tuple, const selection_criteria_t* criteria, const uint32_t* codes);
+static const proposition_t* find_equality(const selection_criteria_t* criteria, uint8_t attribute_index);
 static bool evaluate_proposition(const attribute_value_t* attribute, const proposition_t* proposition);
 static bool check_operator_equal(const attribute_value_t* attribute, const attribute_value_t* value);
 static bool check_operator_not_equal(const attribute_value_t* attribute, const attribute_value_t* value);
@@ -17,27 +33,11 @@ static bool check_operator_greater_equal(const attribute_value_t* attribute, con
 
 void query_free_query_result(query_result_t* result) {
   if (!result) return;
-  
-  if (result->rows) {
-    for (size_t i = 0; i < result->row_count; i++) {
-      if (result->rows[i]) {
-        for (size_t j = 0; j < result->column_count; j++) {
-          attribute_value_t* attr = &result->rows[i][j];
-          if (attr->type == ATTRIBUTE_TYPE_STRING && attr->string_value) free(attr->string_value);
-        }
-        free(result->rows[i]);
-      }
-    }
-    free(result->rows);
-  }
 
-  if (result->column_names) {
-    for (size_t j = 0; j < result->column_count; j++) {
-      if (result->column_names[j]) free(result->column_names[j]);
-    }
-    free(result->column_names);
+  // The result, its rows and strings all live in the arena, no per-row frees
+  if (result->owns_arena) {
+    arena_free(result->arena);
   }
-  free(result);
 }
 
 query_result_t* query_select(dbms_session_t* session, selection_criteria_t* criteria) {
@@ -45,21 +45,57 @@ query_result_t* query_select(dbms_session_t* session, selection_criteria_t* crit
     return NULL;
   }
 
+  arena_t* arena = arena_create(0);
+  if (!arena) {
+    return NULL;
+  }
+  query_result_t* result = query_select_arena(session, criteria, arena);
+  if (!result) {
+    arena_free(arena);
+    return NULL;
+  }
+  result->owns_arena = true;
+  return result;
+}
+
+query_result_t* query_select_arena(dbms_session_t* session, selection_criteria_t* criteria, arena_t* arena) {
+  if (!session || !criteria || !arena) {
+    return NULL;
+  }
+
   // Allocate query result
-  query_result_t* result = allocate_query_result(dbms_catalog_num_used(session->catalog));
+  query_result_t* result = allocate_query_result(arena, dbms_catalog_num_used(session->catalog));
   if (!result) {
     return NULL;
   }
 
-  // Create column names from catalog
+  // Create column names from catalog, and size the rows (strings are stored inline after the attributes)
+  result_builder_t builder = {.result = result, .catalog = session->catalog, .failed = false};
+  builder.row_size = result->column_count * sizeof(attribute_value_t);
   for (uint8_t i = 0; i < result->column_count; i++) {
     catalog_record_t* record = dbms_get_catalog_record(session->catalog, i);
     if (!record) {
       fprintf(stderr, "Failed to retrieve catalog record for attribute index %u\n", i);
-      query_free_query_result(result);
       return NULL;
     }
-    result->column_names[i] = strndup(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE);
+    result->column_names[i] = arena_strndup(arena, record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE);
+    if (record->attribute_type == ATTRIBUTE_TYPE_STRING) {
+      builder.row_size += record->attribute_size + 1;
+    }
+  }
+  builder.row_size = (builder.row_size + 7) & ~(size_t)7;
+
+  if (query_select_stream(session, criteria, append_result_row, &builder) < 0 || builder.failed) {
+    return NULL;
+  }
+
+  return result;
+}
+
+int query_select_stream(dbms_session_t* session, selection_criteria_t* criteria, query_row_callback_t callback,
+                        void* context) {
+  if (!session || !criteria || !callback) {
+    return -1;
   }
 
   // Check if we can use an index
@@ -67,92 +103,144 @@ query_result_t* query_select(dbms_session_t* session, selection_criteria_t* crit
   size_t indexed_count = 0;
   bool using_index = false;
 
-  if (session->indexes) {
-    for (size_t i = 0; i < criteria->proposition_count; i++) {
-      proposition_t* prop = &criteria->propositions[i];
-      if (prop->operator == OPERATOR_EQUAL && session->indexes[prop->attribute_index]) {
-        uint64_t key = index_hash_attribute(&prop->value);
-        indexed_tids = index_lookup(session->indexes[prop->attribute_index], key, &indexed_count);
-        if (indexed_tids) {
-          using_index = true;
-          break; 
-        }
-      }
+  attribute_value_t keys[INDEX_MAX_ATTRIBUTES];
+  index_t* index = query_find_hash_index(session, criteria, keys);
+  if (index) {
+    // The Bloom filter answers most probes for absent keys without touching a bucket or a page
+    if (!index_may_contain(index, keys)) {
+      return 0;
     }
+    indexed_tids = index_lookup(index, keys, &indexed_count);
+    using_index = indexed_tids != NULL;
   }
 
+  // Equalities on dictionary encoded attributes compare the page codes
+  uint32_t codes[criteria->proposition_count > 0 ? criteria->proposition_count : 1];
+  query_resolve_codes(session, criteria, codes);
+
+  int streamed = 0;
   if (using_index) {
-    // Indexed Scan
+    // Indexed Scan, in page order so consecutive matches hit the same buffer page
+    index_sort_tuple_ids(indexed_tids, indexed_count);
     for (size_t i = 0; i < indexed_count; i++) {
       tuple_t* tuple = dbms_get_tuple(session, indexed_tids[i]);
-      if (!tuple) continue;
+      if (!tuple || !tuple_matches(tuple, criteria, codes)) continue;
 
-      bool matches = true;
-      for (size_t p = 0; p < criteria->proposition_count; p++) {
-        if (!evaluate_proposition(&tuple->attributes[criteria->propositions[p].attribute_index], &criteria->propositions[p])) {
-          matches = false;
-          break;
-        }
-      }
-      
-      if (matches) {
-        attribute_value_t* result_row = calloc(result->column_count, sizeof(attribute_value_t));
-        copy_attribute_values(result_row, tuple->attributes, result->column_count);
-        attribute_value_t** new_rows = realloc(result->rows, (result->row_count + 1) * sizeof(attribute_value_t*));
-        result->rows = new_rows;
-        result->rows[result->row_count++] = result_row;
+      streamed++;
+      if (!callback(tuple, context)) {
+        break;
       }
     }
     free(indexed_tids);
-  } else {
-    // Full Table Scan
-    uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
-    for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
-      for (uint64_t tuple_index = 0; tuple_index < tuples_per_page; tuple_index++) {
-        tuple_t* tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = page_id, .slot_id = tuple_index});
-        // Skip null tuples
-        if (!tuple) {
-          continue;
-        }
+    return streamed;
+  }
 
-        // Evaluate selection criteria
-        bool matches = true;
-        for (size_t proposition_index = 0; proposition_index < criteria->proposition_count; proposition_index++) {
-          proposition_t* proposition = &criteria->propositions[proposition_index];
-          attribute_value_t* attribute = &tuple->attributes[proposition->attribute_index];
-          if (!evaluate_proposition(attribute, proposition)) {
-            matches = false;
-            break;
-          }
-        }
+  // Full Table Scan, pin each page once instead of looking up every slot
+  // and skip the pages whose zone map ranges rule out the criteria
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
+    if (zone_map_can_skip_page(session->zone_map, page_id, criteria)) {
+      continue;
+    }
 
-        if (matches) {
-          // Add tuple to result set
-          attribute_value_t* result_row = calloc(result->column_count, sizeof(attribute_value_t));
-          if (!result_row) {
-            fprintf(stderr, "Memory allocation failed for query result row\n");
-            query_free_query_result(result);
-            return NULL;
-          }
-
-          copy_attribute_values(result_row, tuple->attributes, result->column_count);
-
-          // Append row to result
-          attribute_value_t** new_rows = realloc(result->rows, (result->row_count + 1) * sizeof(attribute_value_t*));
-          if (!new_rows) {
-            fprintf(stderr, "Memory allocation failed for expanding query result rows\n");
-            free(result_row);
-            query_free_query_result(result);
-            return NULL;
-          }
-          result->rows = new_rows;
-          result->rows[result->row_count++] = result_row;
-        }
+    buffer_page_t* buffer_page = dbms_pin_page(session, page_id);
+    if (!buffer_page) {
+      fprintf(stderr, "Failed to read page %llu during select\n", (unsigned long long)page_id);
+      return -1;
+    }
+
+    bool stop = false;
+    for (uint64_t tuple_index = 0; tuple_index < tuples_per_page && !stop; tuple_index++) {
+      tuple_t* tuple = &buffer_page->tuples[tuple_index];
+      // Skip null tuples
+      if (tuple->is_null || !tuple_matches(tuple, criteria, codes)) {
+        continue;
       }
+
+      streamed++;
+      stop = !callback(tuple, context);
+    }
+
+    dbms_unpin_page(session, buffer_page);
+    if (stop) {
+      break;
     }
   }
 
-  return result;
+  return streamed;
+}
+
+index_t* query_find_hash_index(const dbms_session_t* session, const selection_criteria_t* criteria,
+                               attribute_value_t* keys) {
+  if (!session || !criteria || !keys) {
+    return NULL;
+  }
+
+  index_t* best = NULL;
+  for (size_t i = 0; i < session->composite_index_count; i++) {
+    index_t* index = session->composite_indexes[i];
+    if (best && best->attribute_count >= index->attribute_count) {
+      continue;
+    }
+
+    attribute_value_t values[INDEX_MAX_ATTRIBUTES];
+    bool is_covered = true;
+    for (uint8_t k = 0; k < index->attribute_count && is_covered; k++) {
+      const proposition_t* proposition = find_equality(criteria, index->attribute_indexes[k]);
+      is_covered = proposition != NULL;
+      if (is_covered) {
+        values[k] = proposition->value;
+      }
+    }
+    if (is_covered) {
+      best = index;
+      memcpy(keys, values, index->attribute_count * sizeof(attribute_value_t));
+    }
+  }
+
+  // With statistics the most selective equality wins, otherwise the first one
+  double best_selectivity = 1.0;
+  if (best) {
+    for (uint8_t k = 0; k < best->attribute_count; k++) {
+      best_selectivity *= stats_attribute_selectivity(session, criteria, best->attribute_indexes[k]);
+    }
+  } else if (session->indexes) {
+    best_selectivity = 2.0;
+    for (size_t i = 0; i < criteria->proposition_count; i++) {
+      const proposition_t* proposition = &criteria->propositions[i];
+      if (proposition->operator != OPERATOR_EQUAL || !session->indexes[proposition->attribute_index]) {
+        continue;
+      }
+      double selectivity = stats_attribute_selectivity(session, criteria, proposition->attribute_index);
+      if (selectivity < best_selectivity) {
+        best = session->indexes[proposition->attribute_index];
+        best_selectivity = selectivity;
+        keys[0] = proposition->value;
+      }
+    }
+  }
+
+  // The buckets are in memory, the cost is in fetching the matching pages
+  if (best && !stats_prefer_index_scan(session, best_selectivity, 0.0)) {
+    return NULL;
+  }
+  return best;
+}
+
+void query_resolve_codes(const dbms_session_t* session, const selection_criteria_t* criteria, uint32_t* codes) {
+  if (!session || !criteria || !codes) {
+    return;
+  }
+
+  for (size_t i = 0; i < criteria->proposition_count; i++) {
+    const proposition_t* proposition = &criteria->propositions[i];
+    codes[i] = QUERY_COMPARE_VALUES;
+    if ((proposition->operator == OPERATOR_EQUAL || proposition->operator == OPERATOR_NOT_EQUAL) &&
+        dbms_is_dictionary_encoded(session->catalog, proposition->attribute_index)) {
+      const char* value = proposition->value.string_value ? proposition->value.string_value : "";
+      codes[i] = dictionary_lookup(session->dictionary, proposition->attribute_index, value);
+    }
+  }
 }
 
 int query_delete(dbms_session_t* session, selection_criteria_t* criteria) {
@@ -165,6 +253,10 @@ int query_delete(dbms_session_t* session, selection_criteria_t* criteria) {
 
   uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
   for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
+    if (zone_map_can_skip_page(session->zone_map, page_id, criteria)) {
+      continue;
+    }
+
     for (uint64_t tuple_index = 0; tuple_index < tuples_per_page; tuple_index++) {
       tuple_t* tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = page_id, .slot_id = tuple_index});
       // Skip null tuples
@@ -207,6 +299,10 @@ int query_update(dbms_session_t* session, selection_criteria_t* criteria, attrib
 
   uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
   for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
+    if (zone_map_can_skip_page(session->zone_map, page_id, criteria)) {
+      continue;
+    }
+
     for (uint64_t tuple_index = 0; tuple_index < tuples_per_page; tuple_index++) {
       tuple_t* tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = page_id, .slot_id = tuple_index});
       // Skip null tuples
@@ -262,46 +358,101 @@ static bool evaluate_proposition(const attribute_value_t* attribute, const propo
   }
 }
 
-static query_result_t* allocate_query_result(size_t column_count) {
-  query_result_t* result = calloc(1, sizeof(query_result_t));
+static query_result_t* allocate_query_result(arena_t* arena, size_t column_count) {
+  query_result_t* result = arena_calloc(arena, 1, sizeof(query_result_t));
   if (!result) {
     fprintf(stderr, "Memory allocation failed for query result\n");
     return NULL;
   }
+  result->arena = arena;
   result->column_count = column_count;
-  result->column_names = calloc(column_count, sizeof(char*));
+  result->column_names = arena_calloc(arena, column_count > 0 ? column_count : 1, sizeof(char*));
   if (!result->column_names) {
     fprintf(stderr, "Memory allocation failed for query result column names\n");
-    free(result);
     return NULL;
   }
   return result;
 }
 
-static void copy_attribute_values(attribute_value_t* dest, const attribute_value_t* src, size_t count) {
-  for (size_t i = 0; i < count; i++) {
-    dest[i].type = src[i].type;
-    switch (src[i].type) {
-      case ATTRIBUTE_TYPE_INT:
-        dest[i].int_value = src[i].int_value;
-        break;
-      case ATTRIBUTE_TYPE_FLOAT:
-        dest[i].float_value = src[i].float_value;
-        break;
-      case ATTRIBUTE_TYPE_STRING:
-        if (src[i].string_value) {
-          dest[i].string_value = strdup(src[i].string_value);
-        } else {
-          dest[i].string_value = NULL;
-        }
-        break;
-      case ATTRIBUTE_TYPE_BOOL:
-        dest[i].bool_value = src[i].bool_value;
-        break;
-      default:
-        break;
+static attribute_value_t* allocate_result_row(result_builder_t* builder) {
+  query_result_t* result = builder->result;
+
+  // Grow the row pointer array by doubling (the old array stays in the arena, at most doubling its footprint)
+  if (result->row_count == result->row_capacity) {
+    size_t new_capacity = result->row_capacity ? result->row_capacity * 2 : QUERY_RESULT_INITIAL_ROWS;
+    attribute_value_t** new_rows = arena_alloc(result->arena, new_capacity * sizeof(attribute_value_t*));
+    if (!new_rows) {
+      fprintf(stderr, "Memory allocation failed for expanding query result rows\n");
+      return NULL;
+    }
+    if (result->row_count > 0) {
+      memcpy(new_rows, result->rows, result->row_count * sizeof(attribute_value_t*));
+    }
+    result->rows = new_rows;
+    result->row_capacity = new_capacity;
+  }
+
+  // Rows are bumped out of the arena back to back
+  attribute_value_t* row = arena_alloc(result->arena, builder->row_size);
+  if (!row) {
+    fprintf(stderr, "Memory allocation failed for query result row\n");
+    return NULL;
+  }
+  result->rows[result->row_count++] = row;
+  return row;
+}
+
+static bool append_result_row(const tuple_t* tuple, void* context) {
+  result_builder_t* builder = (result_builder_t*)context;
+  size_t column_count = builder->result->column_count;
+
+  attribute_value_t* row = allocate_result_row(builder);
+  if (!row) {
+    builder->failed = true;
+    return false;
+  }
+
+  // Copy values, strings go into the inline storage that follows the attribute array
+  char* strings = (char*)&row[column_count];
+  for (size_t i = 0; i < column_count; i++) {
+    row[i] = tuple->attributes[i];
+    if (row[i].type == ATTRIBUTE_TYPE_STRING) {
+      uint8_t size = builder->catalog->records[i].attribute_size;
+      const char* src = tuple->attributes[i].string_value ? tuple->attributes[i].string_value : "";
+      size_t length = strnlen(src, size);
+      memcpy(strings, src, length);
+      strings[length] = '\0';
+      row[i].string_value = strings;
+      strings += size + 1;
+    }
+  }
+  return true;
+}
+
+static bool tuple_matches(const tuple_t* tuple, const selection_criteria_t* criteria, const uint32_t* codes) {
+  for (size_t p = 0; p < criteria->proposition_count; p++) {
+    const proposition_t* proposition = &criteria->propositions[p];
+    const attribute_value_t* attribute = &tuple->attributes[proposition->attribute_index];
+    if (codes[p] != QUERY_COMPARE_VALUES) {
+      if ((attribute->dictionary_code == codes[p]) != (proposition->operator == OPERATOR_EQUAL)) {
+        return false;
+      }
+    } else if (!evaluate_proposition(attribute, proposition)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// First equality proposition on an attribute
+static const proposition_t* find_equality(const selection_criteria_t* criteria, uint8_t attribute_index) {
+  for (size_t i = 0; i < criteria->proposition_count; i++) {
+    const proposition_t* proposition = &criteria->propositions[i];
+    if (proposition->operator == OPERATOR_EQUAL && proposition->attribute_index == attribute_index) {
+      return proposition;
     }
   }
+  return NULL;
 }
 
 static bool check_operator_equal(const attribute_value_t* attribute, const attribute_value_t* value) {
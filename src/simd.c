@@ -0,0 +1,254 @@
+#include "simd.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_USE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_USE_NEON
+#endif
+
+// Every kernel processes a full vector at a time and finishes the tail with scalar code
+
+int64_t simd_sum_i32(const int32_t* values, size_t count) {
+  size_t i = 0;
+  int64_t sum = 0;
+
+#if defined(SIMD_USE_SSE2)
+  // Sign-extend each lane to 64 bits so large sums cannot overflow
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i*)&values[i]);
+    __m128i sign = _mm_srai_epi32(v, 31);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+  }
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  sum = lanes[0] + lanes[1];
+#elif defined(SIMD_USE_NEON)
+  int64x2_t acc = vdupq_n_s64(0);
+  for (; i + 4 <= count; i += 4) {
+    acc = vpadalq_s32(acc, vld1q_s32(&values[i]));
+  }
+  sum = vaddvq_s64(acc);
+#endif
+
+  for (; i < count; i++) {
+    sum += values[i];
+  }
+  return sum;
+}
+
+int32_t simd_min_i32(const int32_t* values, size_t count) {
+  size_t i = 0;
+  int32_t result = count > 0 ? values[0] : 0;
+
+#if defined(SIMD_USE_SSE2)
+  if (count >= 4) {
+    // SSE2 has no pminsd, select through a compare mask instead
+    __m128i acc = _mm_loadu_si128((const __m128i*)values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i*)&values[i]);
+      __m128i less = _mm_cmplt_epi32(v, acc);
+      acc = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, acc));
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    result = lanes[0];
+    for (int j = 1; j < 4; j++) {
+      if (lanes[j] < result) result = lanes[j];
+    }
+  }
+#elif defined(SIMD_USE_NEON)
+  if (count >= 4) {
+    int32x4_t acc = vld1q_s32(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = vminq_s32(acc, vld1q_s32(&values[i]));
+    }
+    result = vminvq_s32(acc);
+  }
+#endif
+
+  for (; i < count; i++) {
+    if (values[i] < result) result = values[i];
+  }
+  return result;
+}
+
+int32_t simd_max_i32(const int32_t* values, size_t count) {
+  size_t i = 0;
+  int32_t result = count > 0 ? values[0] : 0;
+
+#if defined(SIMD_USE_SSE2)
+  if (count >= 4) {
+    __m128i acc = _mm_loadu_si128((const __m128i*)values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i*)&values[i]);
+      __m128i greater = _mm_cmpgt_epi32(v, acc);
+      acc = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, acc));
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    result = lanes[0];
+    for (int j = 1; j < 4; j++) {
+      if (lanes[j] > result) result = lanes[j];
+    }
+  }
+#elif defined(SIMD_USE_NEON)
+  if (count >= 4) {
+    int32x4_t acc = vld1q_s32(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = vmaxq_s32(acc, vld1q_s32(&values[i]));
+    }
+    result = vmaxvq_s32(acc);
+  }
+#endif
+
+  for (; i < count; i++) {
+    if (values[i] > result) result = values[i];
+  }
+  return result;
+}
+
+double simd_sum_f32(const float* values, size_t count) {
+  size_t i = 0;
+  double sum = 0.0;
+
+#if defined(SIMD_USE_SSE2)
+  // Widen to double before adding to match the precision of the scalar path
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_loadu_ps(&values[i]);
+    acc = _mm_add_pd(acc, _mm_cvtps_pd(v));
+    acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  sum = lanes[0] + lanes[1];
+#elif defined(SIMD_USE_NEON)
+  float64x2_t acc = vdupq_n_f64(0.0);
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t v = vld1q_f32(&values[i]);
+    acc = vaddq_f64(acc, vcvt_f64_f32(vget_low_f32(v)));
+    acc = vaddq_f64(acc, vcvt_high_f64_f32(v));
+  }
+  sum = vaddvq_f64(acc);
+#endif
+
+  for (; i < count; i++) {
+    sum += values[i];
+  }
+  return sum;
+}
+
+float simd_min_f32(const float* values, size_t count) {
+  size_t i = 0;
+  float result = count > 0 ? values[0] : 0.0f;
+
+#if defined(SIMD_USE_SSE2)
+  if (count >= 4) {
+    __m128 acc = _mm_loadu_ps(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = _mm_min_ps(acc, _mm_loadu_ps(&values[i]));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    result = lanes[0];
+    for (int j = 1; j < 4; j++) {
+      if (lanes[j] < result) result = lanes[j];
+    }
+  }
+#elif defined(SIMD_USE_NEON)
+  if (count >= 4) {
+    float32x4_t acc = vld1q_f32(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = vminq_f32(acc, vld1q_f32(&values[i]));
+    }
+    result = vminvq_f32(acc);
+  }
+#endif
+
+  for (; i < count; i++) {
+    if (values[i] < result) result = values[i];
+  }
+  return result;
+}
+
+float simd_max_f32(const float* values, size_t count) {
+  size_t i = 0;
+  float result = count > 0 ? values[0] : 0.0f;
+
+#if defined(SIMD_USE_SSE2)
+  if (count >= 4) {
+    __m128 acc = _mm_loadu_ps(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = _mm_max_ps(acc, _mm_loadu_ps(&values[i]));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    result = lanes[0];
+    for (int j = 1; j < 4; j++) {
+      if (lanes[j] > result) result = lanes[j];
+    }
+  }
+#elif defined(SIMD_USE_NEON)
+  if (count >= 4) {
+    float32x4_t acc = vld1q_f32(values);
+    for (i = 4; i + 4 <= count; i += 4) {
+      acc = vmaxq_f32(acc, vld1q_f32(&values[i]));
+    }
+    result = vmaxvq_f32(acc);
+  }
+#endif
+
+  for (; i < count; i++) {
+    if (values[i] > result) result = values[i];
+  }
+  return result;
+}
+
+uint32_t simd_match_u64(const uint64_t* values, size_t count, uint64_t key) {
+  size_t i = 0;
+  uint32_t mask = 0;
+
+#if defined(SIMD_USE_SSE2)
+  // SSE2 has no pcmpeqq, a 64-bit lane matches when both of its 32-bit halves do
+  __m128i needle = _mm_set1_epi64x((long long)key);
+  for (; i + 2 <= count; i += 2) {
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&values[i]), needle);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    mask |= (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+  }
+#elif defined(SIMD_USE_NEON)
+  uint64x2_t needle = vdupq_n_u64(key);
+  for (; i + 2 <= count; i += 2) {
+    uint64x2_t eq = vceqq_u64(vld1q_u64(&values[i]), needle);
+    mask |= (uint32_t)((vgetq_lane_u64(eq, 0) & 1) | ((vgetq_lane_u64(eq, 1) & 1) << 1)) << i;
+  }
+#endif
+
+  for (; i < count; i++) {
+    mask |= (uint32_t)(values[i] == key) << i;
+  }
+  return mask;
+}
+
+uint32_t simd_match_u8x16(const uint8_t* bytes, uint8_t byte) {
+#if defined(SIMD_USE_SSE2)
+  __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)bytes), _mm_set1_epi8((char)byte));
+  return (uint32_t)_mm_movemask_epi8(eq);
+#elif defined(SIMD_USE_NEON)
+  // NEON has no movemask, weight each matching lane by its bit and add the halves horizontally
+  static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t eq = vceqq_u8(vld1q_u8(bytes), vdupq_n_u8(byte));
+  uint8x16_t bits = vandq_u8(eq, vld1q_u8(weights));
+  return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < 16; i++) {
+    mask |= (uint32_t)(bytes[i] == byte) << i;
+  }
+  return mask;
+#endif
+}
@@ -0,0 +1,507 @@
+#include "slotted.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "align.h"
+#include "ssdio.h"
+
+#define OVERFLOW_MAGIC_SIZE 8
+#define OVERFLOW_INITIAL_CAPACITY 16
+
+typedef struct {
+  char magic[OVERFLOW_MAGIC_SIZE];
+  uint64_t page_count;
+  uint64_t free_head;
+} overflow_header_t;
+
+static uint16_t entry_offset(const page_t* page, uint64_t slot_id);
+static uint16_t entry_length(const page_t* page, uint64_t slot_id);
+static void set_entry(page_t* page, uint64_t slot_id, uint16_t offset, uint16_t length);
+static size_t free_space(const page_t* page, size_t data_size);
+static char* get_filename(const char* table_filename);
+static uint64_t take_page(overflow_file_t* overflow);
+static bool read_next_page(const overflow_file_t* overflow, uint64_t page_id, uint64_t* next_page);
+
+void slotted_get_format(const system_catalog_t* catalog, slotted_format_t* format) {
+  memset(format, 0, sizeof(slotted_format_t));
+  format->attribute_count = dbms_catalog_num_used(catalog);
+
+  // Fixed-size values first, so their offsets do not depend on the string lengths
+  uint16_t offset = NULL_BYTE_SIZE;
+  uint16_t variable_size = 0;
+  for (uint8_t i = 0; i < format->attribute_count; i++) {
+    format->types[i] = catalog->records[i].attribute_type;
+    format->sizes[i] = (uint8_t)dbms_get_stored_size(catalog, i);
+    format->is_variable[i] = format->types[i] == ATTRIBUTE_TYPE_STRING && !dbms_is_dictionary_encoded(catalog, i);
+    if (!format->is_variable[i]) {
+      format->offsets[i] = offset;
+      offset += format->sizes[i];
+    }
+  }
+  for (uint8_t i = 0; i < format->attribute_count; i++) {
+    if (format->is_variable[i]) {
+      format->offsets[i] = offset++;
+      variable_size += format->sizes[i];
+    }
+  }
+
+  format->prefix_size = offset;
+  format->min_record_size = offset + (variable_size > 0 ? SLOTTED_OVERFLOW_POINTER_SIZE : 0);
+  format->max_record_size = offset + variable_size;
+  if (format->max_record_size < format->min_record_size) {
+    format->max_record_size = format->min_record_size;
+  }
+}
+
+uint64_t slotted_max_slots(const system_catalog_t* catalog) {
+  slotted_format_t format;
+  slotted_get_format(catalog, &format);
+  return (uint64_t)dbms_data_size(catalog) / (SLOTTED_SLOT_SIZE + format.min_record_size);
+}
+
+size_t slotted_encode_record(const slotted_format_t* format, const attribute_value_t* attributes,
+                             const uint32_t* codes, char* record) {
+  memset(record, 0, format->prefix_size);
+  record[0] = 1;  // Mark as not null
+
+  size_t length = format->prefix_size;
+  for (uint8_t i = 0; i < format->attribute_count; i++) {
+    char* value = record + format->offsets[i];
+    switch (format->types[i]) {
+      case ATTRIBUTE_TYPE_INT:
+        store_u32(value, (uint32_t)attributes[i].int_value);
+        break;
+      case ATTRIBUTE_TYPE_FLOAT:
+        store_f32(value, attributes[i].float_value);
+        break;
+      case ATTRIBUTE_TYPE_STRING:
+        if (format->is_variable[i]) {
+          size_t string_length = strnlen(attributes[i].string_value, format->sizes[i]);
+          store_u8(value, (uint8_t)string_length);
+          memcpy(record + length, attributes[i].string_value, string_length);
+          length += string_length;
+        } else {
+          store_u16(value, (uint16_t)codes[i]);
+        }
+        break;
+      case ATTRIBUTE_TYPE_BOOL:
+        store_u8(value, attributes[i].bool_value ? 1 : 0);
+        break;
+      default:
+        break;
+    }
+  }
+  return length;
+}
+
+void slotted_locate_values(const slotted_format_t* format, const char* record, const char* strings,
+                           const char** values, uint8_t* lengths) {
+  size_t string_offset = 0;
+  for (uint8_t i = 0; i < format->attribute_count; i++) {
+    if (format->is_variable[i]) {
+      lengths[i] = load_u8(record + format->offsets[i]);
+      values[i] = strings + string_offset;
+      string_offset += lengths[i];
+    } else {
+      lengths[i] = format->sizes[i];
+      values[i] = record + format->offsets[i];
+    }
+  }
+}
+
+size_t slotted_strings_size(const slotted_format_t* format, const char* record) {
+  size_t size = 0;
+  for (uint8_t i = 0; i < format->attribute_count; i++) {
+    if (format->is_variable[i]) {
+      size += load_u8(record + format->offsets[i]);
+    }
+  }
+  return size;
+}
+
+void slotted_init_page(page_t* page, size_t data_size) {
+  page->tuples_per_page = 0;
+  page->free_space_head = data_size;
+  memset(page->data, 0, data_size);
+}
+
+bool slotted_is_live(const page_t* page, uint64_t slot_id) {
+  return slot_id < page->tuples_per_page && entry_offset(page, slot_id) != 0;
+}
+
+const char* slotted_get_record(const page_t* page, uint64_t slot_id, bool* is_overflow) {
+  if (!slotted_is_live(page, slot_id)) {
+    return NULL;
+  }
+  if (is_overflow) {
+    *is_overflow = (entry_length(page, slot_id) & SLOTTED_OVERFLOW_FLAG) != 0;
+  }
+  return page->data + entry_offset(page, slot_id);
+}
+
+uint64_t slotted_find_free_slot(const page_t* page) {
+  for (uint64_t slot = 0; slot < page->tuples_per_page; slot++) {
+    if (entry_offset(page, slot) == 0) {
+      return slot;
+    }
+  }
+  return page->tuples_per_page;
+}
+
+bool slotted_has_space(const page_t* page, size_t size, uint64_t max_slots, size_t data_size) {
+  uint64_t slot_id = slotted_find_free_slot(page);
+  if (slot_id >= max_slots) {
+    return false;
+  }
+  size_t growth = slot_id == page->tuples_per_page ? SLOTTED_SLOT_SIZE : 0;
+  return free_space(page, data_size) >= size + growth;
+}
+
+char* slotted_allocate(page_t* page, uint64_t slot_id, size_t size, bool is_overflow, size_t data_size) {
+  uint64_t slot_count = page->tuples_per_page;
+  if (slot_id > slot_count || size == 0 || size > SLOTTED_LENGTH_MASK) {
+    return NULL;
+  }
+
+  // The slot's current record is replaced, its space counts as free
+  size_t old_length = slot_id < slot_count && entry_offset(page, slot_id) != 0
+                          ? (entry_length(page, slot_id) & SLOTTED_LENGTH_MASK)
+                          : 0;
+  size_t growth = slot_id == slot_count ? SLOTTED_SLOT_SIZE : 0;
+  if (free_space(page, data_size) + old_length < size + growth) {
+    return NULL;
+  }
+
+  if (slot_id < slot_count) {
+    slotted_release(page, slot_id, data_size);
+    // Releasing may have trimmed the slot off the end of the directory
+    slot_count = page->tuples_per_page;
+    growth = slot_id >= slot_count ? (slot_id + 1 - slot_count) * SLOTTED_SLOT_SIZE : 0;
+  }
+  if (page->free_space_head < slot_count * SLOTTED_SLOT_SIZE + growth + size) {
+    slotted_compact(page, data_size);
+  }
+
+  for (uint64_t slot = slot_count; slot <= slot_id; slot++) {
+    set_entry(page, slot, 0, 0);
+  }
+  if (slot_id >= slot_count) {
+    page->tuples_per_page = slot_id + 1;
+  }
+  page->free_space_head -= size;
+  set_entry(page, slot_id, (uint16_t)page->free_space_head, (uint16_t)(size | (is_overflow ? SLOTTED_OVERFLOW_FLAG : 0)));
+  char* record = page->data + page->free_space_head;
+  memset(record, 0, size);
+  return record;
+}
+
+void slotted_release(page_t* page, uint64_t slot_id, size_t data_size) {
+  if (!slotted_is_live(page, slot_id)) {
+    return;
+  }
+
+  uint16_t offset = entry_offset(page, slot_id);
+  uint16_t length = entry_length(page, slot_id) & SLOTTED_LENGTH_MASK;
+  memset(page->data + offset, 0, length);
+  // The lowest record gives its space straight back to the heap, others wait for a compaction
+  if (offset == page->free_space_head) {
+    page->free_space_head += length;
+  }
+  set_entry(page, slot_id, 0, 0);
+
+  while (page->tuples_per_page > 0 && entry_offset(page, page->tuples_per_page - 1) == 0) {
+    page->tuples_per_page--;
+  }
+  if (page->tuples_per_page == 0) {
+    page->free_space_head = data_size;
+  }
+}
+
+void slotted_compact(page_t* page, size_t data_size) {
+  char heap[data_size];
+  uint64_t heap_start = data_size;
+  for (uint64_t slot = 0; slot < page->tuples_per_page; slot++) {
+    uint16_t offset = entry_offset(page, slot);
+    if (offset == 0) {
+      continue;
+    }
+    uint16_t length = entry_length(page, slot);
+    size_t size = length & SLOTTED_LENGTH_MASK;
+    heap_start -= size;
+    memcpy(heap + heap_start, page->data + offset, size);
+    set_entry(page, slot, (uint16_t)heap_start, length);
+  }
+
+  size_t directory_size = page->tuples_per_page * SLOTTED_SLOT_SIZE;
+  memset(page->data + directory_size, 0, heap_start - directory_size);
+  memcpy(page->data + heap_start, heap + heap_start, data_size - heap_start);
+  page->free_space_head = heap_start;
+}
+
+bool slotted_overflow_create(const char* table_filename, const system_catalog_t* catalog) {
+  if (!table_filename || !catalog) {
+    return false;
+  }
+
+  char* filename = get_filename(table_filename);
+  if (!filename) {
+    return false;
+  }
+  remove(filename);
+  if (catalog->layout != CATALOG_LAYOUT_SLOTTED) {
+    free(filename);
+    return true;
+  }
+
+  int fd = ssdio_open(filename, true);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to create overflow file: %s\n", filename);
+    free(filename);
+    return false;
+  }
+  char header_page[PAGE_SIZE] = {0};
+  overflow_header_t header = {.page_count = 0, .free_head = OVERFLOW_NO_PAGE};
+  memcpy(header.magic, OVERFLOW_FILE_MAGIC, OVERFLOW_MAGIC_SIZE);
+  memcpy(header_page, &header, sizeof(header));
+  bool ok = pwrite(fd, header_page, PAGE_SIZE, 0) == PAGE_SIZE && ssdio_flush(fd) == 0;
+  if (!ok) {
+    fprintf(stderr, "Failed to write overflow file: %s\n", filename);
+  }
+  ssdio_close(fd);
+  free(filename);
+  return ok;
+}
+
+overflow_file_t* slotted_overflow_open(const dbms_session_t* session) {
+  if (!session || !session->catalog || session->catalog->layout != CATALOG_LAYOUT_SLOTTED) {
+    return NULL;
+  }
+
+  overflow_file_t* overflow = calloc(1, sizeof(overflow_file_t));
+  if (!overflow) {
+    fprintf(stderr, "Memory allocation failed for overflow file\n");
+    return NULL;
+  }
+  overflow->fd = -1;
+  overflow->filename = get_filename(session->filename);
+  if (!overflow->filename) {
+    slotted_overflow_free(overflow);
+    return NULL;
+  }
+
+  // Long strings are only in this file, it cannot be rebuilt
+  overflow->fd = ssdio_open(overflow->filename, false);
+  if (overflow->fd < 0) {
+    fprintf(stderr, "Failed to open overflow file: %s\n", overflow->filename);
+    slotted_overflow_free(overflow);
+    return NULL;
+  }
+  overflow_header_t header;
+  if (pread(overflow->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      memcmp(header.magic, OVERFLOW_FILE_MAGIC, OVERFLOW_MAGIC_SIZE) != 0) {
+    fprintf(stderr, "Invalid overflow file: %s\n", overflow->filename);
+    slotted_overflow_free(overflow);
+    return NULL;
+  }
+
+  // Pages appended after the last sync may already be referenced by evicted table pages, never reuse them
+  off_t file_size = ssdio_get_file_size(overflow->fd);
+  uint64_t file_pages = file_size > PAGE_SIZE ? (uint64_t)file_size / PAGE_SIZE - 1 : 0;
+  overflow->page_count = header.page_count > file_pages ? header.page_count : file_pages;
+  overflow->free_head = header.free_head <= overflow->page_count ? header.free_head : OVERFLOW_NO_PAGE;
+  return overflow;
+}
+
+uint64_t slotted_overflow_write(overflow_file_t* overflow, const char* data, size_t size) {
+  if (!overflow || !data || size == 0) {
+    return OVERFLOW_NO_PAGE;
+  }
+
+  size_t page_count = (size + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY;
+  uint64_t pages[page_count];
+  for (size_t i = 0; i < page_count; i++) {
+    pages[i] = take_page(overflow);
+    if (pages[i] == OVERFLOW_NO_PAGE) {
+      return OVERFLOW_NO_PAGE;
+    }
+  }
+
+  char buffer[PAGE_SIZE];
+  for (size_t i = 0; i < page_count; i++) {
+    size_t offset = i * OVERFLOW_PAGE_CAPACITY;
+    size_t length = size - offset < OVERFLOW_PAGE_CAPACITY ? size - offset : OVERFLOW_PAGE_CAPACITY;
+    memset(buffer, 0, OVERFLOW_PAGE_HEADER_SIZE);
+    store_u64(buffer, i + 1 < page_count ? pages[i + 1] : OVERFLOW_NO_PAGE);
+    store_u32(buffer + sizeof(uint64_t), (uint32_t)length);
+    memcpy(buffer + OVERFLOW_PAGE_HEADER_SIZE, data + offset, length);
+    size_t write_size = OVERFLOW_PAGE_HEADER_SIZE + length;
+    if (pwrite(overflow->fd, buffer, write_size, pages[i] * PAGE_SIZE) != (ssize_t)write_size) {
+      fprintf(stderr, "Failed to write overflow page %llu\n", (unsigned long long)pages[i]);
+      return OVERFLOW_NO_PAGE;
+    }
+  }
+  overflow->is_dirty = true;
+  return pages[0];
+}
+
+bool slotted_overflow_read(const overflow_file_t* overflow, uint64_t first_page, char* data, size_t size) {
+  if (!overflow || !data) {
+    return false;
+  }
+
+  char buffer[PAGE_SIZE];
+  uint64_t page_id = first_page;
+  size_t offset = 0;
+  while (offset < size) {
+    if (page_id == OVERFLOW_NO_PAGE || page_id > overflow->page_count) {
+      fprintf(stderr, "Overflow chain %llu ends early\n", (unsigned long long)first_page);
+      return false;
+    }
+    ssize_t bytes_read = pread(overflow->fd, buffer, PAGE_SIZE, page_id * PAGE_SIZE);
+    uint32_t length = bytes_read >= OVERFLOW_PAGE_HEADER_SIZE ? load_u32(buffer + sizeof(uint64_t)) : 0;
+    if (length == 0 || length > size - offset || OVERFLOW_PAGE_HEADER_SIZE + length > (size_t)bytes_read) {
+      fprintf(stderr, "Invalid overflow page %llu\n", (unsigned long long)page_id);
+      return false;
+    }
+    memcpy(data + offset, buffer + OVERFLOW_PAGE_HEADER_SIZE, length);
+    offset += length;
+    page_id = load_u64(buffer);
+  }
+  return true;
+}
+
+bool slotted_overflow_release(overflow_file_t* overflow, uint64_t first_page) {
+  if (!overflow || first_page == OVERFLOW_NO_PAGE) {
+    return false;
+  }
+  if (overflow->released_count == overflow->released_capacity) {
+    size_t capacity = overflow->released_capacity ? overflow->released_capacity * 2 : OVERFLOW_INITIAL_CAPACITY;
+    uint64_t* released = realloc(overflow->released, capacity * sizeof(uint64_t));
+    if (!released) {
+      fprintf(stderr, "Memory allocation failed for released overflow chains\n");
+      return false;
+    }
+    overflow->released = released;
+    overflow->released_capacity = capacity;
+  }
+  overflow->released[overflow->released_count++] = first_page;
+  return true;
+}
+
+bool slotted_overflow_sync(overflow_file_t* overflow) {
+  if (!overflow || !overflow->is_dirty) {
+    return true;
+  }
+
+  overflow_header_t header = {.page_count = overflow->page_count, .free_head = overflow->free_head};
+  memcpy(header.magic, OVERFLOW_FILE_MAGIC, OVERFLOW_MAGIC_SIZE);
+  if (pwrite(overflow->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      ssdio_flush(overflow->fd) != 0) {
+    fprintf(stderr, "Failed to sync overflow file: %s\n", overflow->filename);
+    return false;
+  }
+  overflow->is_dirty = false;
+  return true;
+}
+
+void slotted_overflow_reclaim(overflow_file_t* overflow) {
+  if (!overflow) {
+    return;
+  }
+
+  // Each chain is linked in front of the free list through its last page
+  for (size_t i = 0; i < overflow->released_count; i++) {
+    uint64_t last_page = overflow->released[i];
+    uint64_t next_page = OVERFLOW_NO_PAGE;
+    uint64_t steps = 0;
+    bool ok = read_next_page(overflow, last_page, &next_page);
+    while (ok && next_page != OVERFLOW_NO_PAGE && ++steps <= overflow->page_count) {
+      last_page = next_page;
+      ok = read_next_page(overflow, last_page, &next_page);
+    }
+    char link[sizeof(uint64_t)];
+    store_u64(link, overflow->free_head);
+    if (!ok || next_page != OVERFLOW_NO_PAGE ||
+        pwrite(overflow->fd, link, sizeof(link), last_page * PAGE_SIZE) != (ssize_t)sizeof(link)) {
+      // Leaves the chain unused rather than linking a corrupt one into the free list
+      fprintf(stderr, "Failed to free overflow chain %llu\n", (unsigned long long)overflow->released[i]);
+      continue;
+    }
+    overflow->free_head = overflow->released[i];
+    overflow->is_dirty = true;
+  }
+  overflow->released_count = 0;
+}
+
+void slotted_overflow_free(overflow_file_t* overflow) {
+  if (!overflow) {
+    return;
+  }
+
+  if (overflow->fd >= 0) {
+    ssdio_close(overflow->fd);
+  }
+  free(overflow->released);
+  free(overflow->filename);
+  free(overflow);
+}
+
+static uint16_t entry_offset(const page_t* page, uint64_t slot_id) {
+  return load_u16(page->data + slot_id * SLOTTED_SLOT_SIZE);
+}
+
+static uint16_t entry_length(const page_t* page, uint64_t slot_id) {
+  return load_u16(page->data + slot_id * SLOTTED_SLOT_SIZE + sizeof(uint16_t));
+}
+
+static void set_entry(page_t* page, uint64_t slot_id, uint16_t offset, uint16_t length) {
+  store_u16(page->data + slot_id * SLOTTED_SLOT_SIZE, offset);
+  store_u16(page->data + slot_id * SLOTTED_SLOT_SIZE + sizeof(uint16_t), length);
+}
+
+// Bytes neither in the directory nor in a record, contiguous only after a compaction
+static size_t free_space(const page_t* page, size_t data_size) {
+  size_t used = page->tuples_per_page * SLOTTED_SLOT_SIZE;
+  for (uint64_t slot = 0; slot < page->tuples_per_page; slot++) {
+    if (entry_offset(page, slot) != 0) {
+      used += entry_length(page, slot) & SLOTTED_LENGTH_MASK;
+    }
+  }
+  return used < data_size ? data_size - used : 0;
+}
+
+static char* get_filename(const char* table_filename) {
+  size_t length = strlen(table_filename) + strlen(OVERFLOW_FILE_EXTENSION) + 1;
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for overflow filename\n");
+    return NULL;
+  }
+  snprintf(filename, length, "%s%s", table_filename, OVERFLOW_FILE_EXTENSION);
+  return filename;
+}
+
+static uint64_t take_page(overflow_file_t* overflow) {
+  uint64_t page_id = overflow->free_head;
+  uint64_t next_page = OVERFLOW_NO_PAGE;
+  if (page_id != OVERFLOW_NO_PAGE && read_next_page(overflow, page_id, &next_page) &&
+      next_page <= overflow->page_count) {
+    overflow->free_head = next_page;
+    return page_id;
+  }
+  // An unreadable free list is dropped, its pages stay unused
+  overflow->free_head = OVERFLOW_NO_PAGE;
+  return ++overflow->page_count;
+}
+
+static bool read_next_page(const overflow_file_t* overflow, uint64_t page_id, uint64_t* next_page) {
+  char link[sizeof(uint64_t)];
+  if (page_id == OVERFLOW_NO_PAGE || page_id > overflow->page_count ||
+      pread(overflow->fd, link, sizeof(link), page_id * PAGE_SIZE) != (ssize_t)sizeof(link)) {
+    return false;
+  }
+  *next_page = load_u64(link);
+  return true;
+}
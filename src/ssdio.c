@@ -14,9 +14,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+_Static_assert(sizeof(catalog_options_t) == CATALOG_RECORD_SIZE, "Catalog options must fill one record slot");
+
 int ssdio_open(const char* filename, bool is_new) {
   // Open file with appropriate flags based on OS
   // 0644 says read/write for owner, read for group and others
@@ -71,6 +74,19 @@ bool ssdio_write_page(int fd, uint64_t page_id, const page_t* page) {
   return bytes_written == PAGE_SIZE;
 }
 
+bool ssdio_read_table_page(int fd, uint64_t page_id, uint32_t page_size, page_t* page) {
+  // The catalog page keeps PAGE_SIZE whatever the size of the table's pages
+  off_t offset = PAGE_SIZE + (off_t)(page_id - 1) * page_size;
+  ssize_t bytes_read = pread(fd, page, page_size, offset);
+  return bytes_read == (ssize_t)page_size;
+}
+
+bool ssdio_write_table_page(int fd, uint64_t page_id, uint32_t page_size, const page_t* page) {
+  off_t offset = PAGE_SIZE + (off_t)(page_id - 1) * page_size;
+  ssize_t bytes_written = pwrite(fd, page, page_size, offset);
+  return bytes_written == (ssize_t)page_size;
+}
+
 bool ssdio_read_catalog(int fd, system_catalog_t* catalog) {
   catalog_record_t buffer[PAGE_SIZE / sizeof(catalog_record_t)];
   ssize_t bytes_read = pread(fd, buffer, PAGE_SIZE, 0);
@@ -91,14 +107,41 @@ bool ssdio_read_catalog(int fd, system_catalog_t* catalog) {
     return false;
   }
 
-  uint16_t tuple_size = 0;
   for (int i = 0; i < catalog->record_count; i++) {
     catalog->records[i] = buffer[i];
-    tuple_size += buffer[i].attribute_size;
   }
 
-  // +1 for null byte
-  catalog->tuple_size = tuple_size + NULL_BYTE_SIZE;
+  // Tables created before the options were stored have uncompressed NSM pages and no encoded attributes
+  const catalog_options_t* options = (const catalog_options_t*)&buffer[CATALOG_MAX_RECORDS];
+  bool has_options = memcmp(options->magic, CATALOG_OPTIONS_MAGIC, sizeof(options->magic)) == 0;
+  catalog->layout = CATALOG_LAYOUT_NSM;
+  catalog->compression = CATALOG_COMPRESSION_NONE;
+  catalog->page_size = PAGE_SIZE;
+  memset(catalog->dictionary_attributes, 0, sizeof(catalog->dictionary_attributes));
+  if (has_options) {
+    if (options->layout != CATALOG_LAYOUT_NSM && options->layout != CATALOG_LAYOUT_PAX &&
+        options->layout != CATALOG_LAYOUT_SLOTTED && options->layout != CATALOG_LAYOUT_BITMAP) {
+      fprintf(stderr, "Unknown page layout %u in catalog\n", options->layout);
+      free(catalog->records);
+      catalog->records = NULL;
+      return false;
+    }
+    catalog->layout = options->layout;
+    if (options->compression != CATALOG_COMPRESSION_NONE && options->compression != CATALOG_COMPRESSION_LZ4) {
+      fprintf(stderr, "Unknown page compression %u in catalog\n", options->compression);
+      free(catalog->records);
+      catalog->records = NULL;
+      return false;
+    }
+    catalog->compression = options->compression;
+    catalog->page_size = options->page_shift == 0 ? PAGE_SIZE : 1u << (options->page_shift & 31);
+    if (options->page_shift >= 32 || !dbms_is_valid_page_size(catalog->page_size)) {
+      fprintf(stderr, "Unsupported page size shift %u in catalog\n", options->page_shift);
+      free(catalog->records);
+      catalog->records = NULL;
+      return false;
+    }
+  }
 
   // Sort the records by attribute order
   for (int i = 0; i < ((int)catalog->record_count) - 1; i++) {
@@ -111,6 +154,24 @@ bool ssdio_read_catalog(int fd, system_catalog_t* catalog) {
     }
   }
 
+  // The options mark encoded attributes by order, the catalog by position
+  for (int i = 0; has_options && i < catalog->record_count; i++) {
+    uint8_t order = catalog->records[i].attribute_order;
+    if (order < CATALOG_MAX_RECORDS && ((options->dictionary_attributes[order >> 3] >> (order & 7)) & 1) &&
+        !dbms_set_dictionary_encoded(catalog, i)) {
+      free(catalog->records);
+      catalog->records = NULL;
+      return false;
+    }
+  }
+
+  // +1 for null byte, encoded attributes only store their code
+  uint16_t tuple_size = 0;
+  for (int i = 0; i < catalog->record_count; i++) {
+    tuple_size += dbms_get_stored_size(catalog, i);
+  }
+  catalog->tuple_size = tuple_size + NULL_BYTE_SIZE;
+
   return true;
 }
 
@@ -124,7 +185,7 @@ bool ssdio_write_catalog(int fd, const system_catalog_t* catalog) {
   }
 
   for (int i = 0; i < catalog->record_count; i++) {
-    if (i >= PAGE_SIZE / sizeof(catalog_record_t)) {
+    if (i >= CATALOG_MAX_RECORDS) {
       fprintf(stderr, "Catalog too large to write to a single page\n");
       return false;
     }
@@ -142,6 +203,32 @@ bool ssdio_write_catalog(int fd, const system_catalog_t* catalog) {
     buffer[i] = catalog->records[i];
   }
 
+  catalog_options_t options = {0};
+  memcpy(options.magic, CATALOG_OPTIONS_MAGIC, sizeof(options.magic));
+  options.layout = catalog->layout;
+  options.compression = catalog->compression;
+  uint32_t page_size = dbms_page_size(catalog);
+  if (!dbms_is_valid_page_size(page_size)) {
+    fprintf(stderr, "Page size %u is not a power of two from %u to %u\n", page_size, MIN_PAGE_SIZE, MAX_PAGE_SIZE);
+    free(buffer);
+    return false;
+  }
+  // The default size is stored as 0, like files written before the page size was an option
+  options.page_shift = page_size == PAGE_SIZE ? 0 : (uint8_t)__builtin_ctz(page_size);
+  for (int i = 0; i < catalog->record_count; i++) {
+    if (dbms_is_dictionary_encoded(catalog, i)) {
+      if (catalog->records[i].attribute_type != ATTRIBUTE_TYPE_STRING ||
+          catalog->records[i].attribute_order >= CATALOG_MAX_RECORDS) {
+        fprintf(stderr, "Only STRING attributes can be dictionary encoded\n");
+        free(buffer);
+        return false;
+      }
+      uint8_t order = catalog->records[i].attribute_order;
+      options.dictionary_attributes[order >> 3] |= (uint8_t)(1u << (order & 7));
+    }
+  }
+  memcpy(&buffer[CATALOG_MAX_RECORDS], &options, sizeof(options));
+
   ssize_t bytes_written = pwrite(fd, buffer, PAGE_SIZE, 0);
   free(buffer);
   return bytes_written == PAGE_SIZE;
@@ -155,3 +242,95 @@ off_t ssdio_get_file_size(int fd) {
   }
   return (s.st_size);
 }
+
+bool ssdio_truncate(int fd, off_t size) {
+  if (ftruncate(fd, size) != 0) {
+    fprintf(stderr, "ftruncate(%d, %lld) failed\n", fd, (long long)size);
+    return false;
+  }
+  return true;
+}
+
+bool ssdio_punch_hole(int fd, off_t offset, off_t length) {
+#if defined(ON_LINUX)
+  // Deallocates the range while keeping the file size, the SSD can then TRIM the freed blocks
+  return fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) == 0;
+#else
+  (void)fd;
+  (void)offset;
+  (void)length;
+  return false;
+#endif
+}
+
+const char* ssdio_map(int fd, size_t size) {
+  if (size == 0) {
+    return NULL;
+  }
+  void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    fprintf(stderr, "mmap(%d, %zu) failed\n", fd, size);
+    return NULL;
+  }
+  // Start reading the whole file in, the fd itself is opened for random access without read-ahead
+  madvise(mapping, size, MADV_WILLNEED);
+  return mapping;
+}
+
+void ssdio_unmap(const char* mapping, size_t size) {
+  if (mapping) {
+    munmap((void*)mapping, size);
+  }
+}
+
+char* ssdio_alloc_frames(size_t size, bool use_huge_pages, uint8_t* backing) {
+  // Huge pages only pay off once the frames span more than one of them
+  if (use_huge_pages && size >= SSDIO_HUGE_PAGE_SIZE) {
+    size_t huge_size = (size + SSDIO_HUGE_PAGE_SIZE - 1) & ~(size_t)(SSDIO_HUGE_PAGE_SIZE - 1);
+#if defined(MAP_HUGETLB)
+    // Fails unless enough huge pages are reserved, anonymous memory is zeroed
+    void* frames = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (frames != MAP_FAILED) {
+      *backing = SSDIO_FRAMES_HUGETLB;
+      return frames;
+    }
+#endif
+#if defined(MADV_HUGEPAGE)
+    // THP only backs 2 MB aligned ranges, so map one huge page more and trim both ends to the aligned range
+    char* mapping = mmap(NULL, huge_size + SSDIO_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+    if (mapping != MAP_FAILED) {
+      char* aligned = (char*)(((uintptr_t)mapping + SSDIO_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(SSDIO_HUGE_PAGE_SIZE - 1));
+      size_t head = aligned - mapping;
+      if (head > 0) {
+        munmap(mapping, head);
+      }
+      if (SSDIO_HUGE_PAGE_SIZE - head > 0) {
+        munmap(aligned + huge_size, SSDIO_HUGE_PAGE_SIZE - head);
+      }
+      // Only a hint, the kernel may still use 4 KB pages (e.g. THP disabled or memory fragmented)
+      madvise(aligned, huge_size, MADV_HUGEPAGE);
+      *backing = SSDIO_FRAMES_THP;
+      return aligned;
+    }
+#endif
+  }
+
+  *backing = SSDIO_FRAMES_HEAP;
+  char* frames = aligned_alloc(PAGE_SIZE, size);
+  if (frames) {
+    memset(frames, 0, size);
+  }
+  return frames;
+}
+
+void ssdio_free_frames(char* frames, size_t size, uint8_t backing) {
+  if (!frames) {
+    return;
+  }
+  if (backing == SSDIO_FRAMES_HEAP) {
+    free(frames);
+  } else {
+    munmap(frames, (size + SSDIO_HUGE_PAGE_SIZE - 1) & ~(size_t)(SSDIO_HUGE_PAGE_SIZE - 1));
+  }
+}
@@ -0,0 +1,613 @@
+#include "stats.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btree.h"
+#include "index.h"
+#include "ssdio.h"
+#include "zone_map.h"
+
+#define STATS_VERSION 1
+#define STATS_META_PAGE_ID 0
+#define STATS_HLL_REGISTERS (1u << STATS_HLL_BITS)
+#define STATS_INITIAL_SAMPLE_ROWS 1024
+
+_Static_assert(sizeof(stats_file_meta_t) % 8 == 0, "Stats meta must keep the columns aligned");
+_Static_assert(sizeof(stats_file_meta_t) + sizeof(stats_column_t) <= sizeof(page_t), "Stats meta must fit in a page");
+
+// One sampled value of an attribute
+typedef struct {
+  uint64_t key;       // btree_normalize_key, orders the values
+  uint64_t identity;  // index_encode_key, tells values apart (a STRING key alone only holds a prefix)
+} sample_value_t;
+
+typedef struct {
+  sample_value_t* values;
+  uint8_t registers[STATS_HLL_REGISTERS];  // HyperLogLog sketch of the identities
+} column_sample_t;
+
+static char* stats_filename(const char* table_filename);
+static uint64_t mix(uint64_t key);
+static void hll_add(uint8_t* registers, uint64_t identity);
+static double hll_estimate(const uint8_t* registers);
+static int compare_sample_values(const void* a, const void* b);
+static void summarize_column(stats_column_t* column, sample_value_t* values, size_t count, const uint8_t* registers,
+                             double row_count, bool is_full_scan);
+static void apply_zone_map_range(stats_column_t* column, const zone_map_t* zone_map, uint8_t attribute_index);
+static double cumulative_fraction(const stats_column_t* column, uint64_t key);
+static double equality_fraction(const stats_column_t* column, uint64_t key);
+static bool write_file(const dbms_session_t* session, const table_stats_t* stats);
+
+table_stats_t* stats_open(const dbms_session_t* session) {
+  if (!session || !session->catalog || !session->filename) {
+    return NULL;
+  }
+
+  char* filename = stats_filename(session->filename);
+  if (!filename) {
+    return NULL;
+  }
+  // Never analyzed is the common case, so a missing file is not an error
+  int fd = ssdio_open(filename, false);
+  free(filename);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  table_stats_t* stats = calloc(1, sizeof(table_stats_t));
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  if (!stats || !page || !ssdio_read_page(fd, STATS_META_PAGE_ID, page)) {
+    free(page);
+    free(stats);
+    ssdio_close(fd);
+    return NULL;
+  }
+
+  memcpy(&stats->meta, page, sizeof(stats->meta));
+  if (memcmp(stats->meta.magic, STATS_FILE_MAGIC, sizeof(stats->meta.magic)) != 0 ||
+      stats->meta.version != STATS_VERSION || stats->meta.column_count != dbms_catalog_num_used(session->catalog) ||
+      stats->meta.tuple_size != session->catalog->tuple_size) {
+    fprintf(stderr, "Ignoring statistics that do not match %s, analyze it again\n", session->filename);
+    free(page);
+    free(stats);
+    ssdio_close(fd);
+    return NULL;
+  }
+
+  stats->columns = calloc(stats->meta.column_count ? stats->meta.column_count : 1, sizeof(stats_column_t));
+  if (!stats->columns) {
+    fprintf(stderr, "Memory allocation failed for statistics columns\n");
+    free(page);
+    free(stats);
+    ssdio_close(fd);
+    return NULL;
+  }
+
+  // The columns run on from the meta across as many pages as they need
+  size_t offset = sizeof(stats_file_meta_t);
+  uint64_t page_id = STATS_META_PAGE_ID;
+  for (uint8_t i = 0; i < stats->meta.column_count; i++) {
+    if (offset + sizeof(stats_column_t) > sizeof(page_t)) {
+      offset = 0;
+      if (!ssdio_read_page(fd, ++page_id, page)) {
+        fprintf(stderr, "Failed to read statistics page %llu\n", (unsigned long long)page_id);
+        free(page);
+        stats_free(stats);
+        ssdio_close(fd);
+        return NULL;
+      }
+    }
+    memcpy(&stats->columns[i], (const char*)page + offset, sizeof(stats_column_t));
+    offset += sizeof(stats_column_t);
+  }
+
+  free(page);
+  ssdio_close(fd);
+  return stats;
+}
+
+bool stats_analyze(dbms_session_t* session, uint64_t sample_pages) {
+  if (!session || !session->catalog) {
+    return false;
+  }
+
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  uint64_t page_count = session->page_count;
+  if (sample_pages == 0) {
+    sample_pages = STATS_SAMPLE_PAGES;
+  }
+  if (sample_pages > page_count) {
+    sample_pages = page_count;
+  }
+
+  table_stats_t* stats = calloc(1, sizeof(table_stats_t));
+  column_sample_t* samples = calloc(num_attributes ? num_attributes : 1, sizeof(column_sample_t));
+  if (!stats || !samples) {
+    fprintf(stderr, "Memory allocation failed for statistics\n");
+    free(samples);
+    free(stats);
+    return false;
+  }
+  stats->columns = calloc(num_attributes ? num_attributes : 1, sizeof(stats_column_t));
+  if (!stats->columns) {
+    fprintf(stderr, "Memory allocation failed for statistics columns\n");
+    free(samples);
+    stats_free(stats);
+    return false;
+  }
+
+  // Selection sampling (Knuth's algorithm S): each page is taken with probability
+  // (pages still needed) / (pages left), so the sample is uniform and comes out in file order
+  size_t sample_count = 0;
+  size_t sample_capacity = 0;
+  uint64_t slot_count = 0;
+  uint64_t seed = mix(page_count) | 1;  // Repeatable for a table size, never the all-zero xorshift state
+  uint64_t taken = 0;
+  bool success = true;
+  for (uint64_t page_id = 1; page_id <= page_count && taken < sample_pages && success; page_id++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    double uniform = (double)(seed >> 11) / (double)(1ULL << 53);
+    if ((double)(page_count - page_id + 1) * uniform >= (double)(sample_pages - taken)) {
+      continue;
+    }
+    taken++;
+
+    buffer_page_t* buffer_page = dbms_pin_page(session, page_id);
+    if (!buffer_page) {
+      fprintf(stderr, "Failed to read page %llu during analyze\n", (unsigned long long)page_id);
+      success = false;
+      break;
+    }
+    for (uint64_t slot = 0; slot < tuples_per_page; slot++) {
+      const tuple_t* tuple = &buffer_page->tuples[slot];
+      slot_count++;
+      if (tuple->is_null) {
+        continue;
+      }
+
+      if (sample_count == sample_capacity) {
+        size_t new_capacity = sample_capacity ? sample_capacity * 2 : STATS_INITIAL_SAMPLE_ROWS;
+        for (uint8_t i = 0; i < num_attributes && success; i++) {
+          sample_value_t* values = realloc(samples[i].values, new_capacity * sizeof(sample_value_t));
+          if (!values) {
+            fprintf(stderr, "Memory allocation failed for statistics sample\n");
+            success = false;
+            break;
+          }
+          samples[i].values = values;
+        }
+        if (!success) {
+          break;
+        }
+        sample_capacity = new_capacity;
+      }
+
+      for (uint8_t i = 0; i < num_attributes; i++) {
+        const attribute_value_t* value = &tuple->attributes[i];
+        sample_value_t* sample = &samples[i].values[sample_count];
+        sample->key = btree_normalize_key(value);
+        sample->identity = index_encode_key(value);
+        hll_add(samples[i].registers, sample->identity);
+      }
+      sample_count++;
+    }
+    dbms_unpin_page(session, buffer_page);
+  }
+
+  if (success) {
+    memcpy(stats->meta.magic, STATS_FILE_MAGIC, sizeof(stats->meta.magic));
+    stats->meta.version = STATS_VERSION;
+    stats->meta.column_count = num_attributes;
+    stats->meta.tuple_size = session->catalog->tuple_size;
+    stats->meta.page_count = page_count;
+    stats->meta.pages_sampled = taken;
+    stats->meta.null_fraction = slot_count ? 1.0 - (double)sample_count / (double)slot_count : 0.0;
+
+    // The zone map counts the live tuples of every page, otherwise scale the sample up
+    zone_map_t* zone_map = session->zone_map;
+    if (zone_map) {
+      double row_count = 0;
+      for (uint64_t entry = 0; entry < zone_map->page_count && entry < page_count; entry++) {
+        row_count += zone_map->tuple_counts[entry];
+      }
+      stats->meta.row_count = row_count;
+    } else {
+      stats->meta.row_count = taken ? (double)sample_count * (double)page_count / (double)taken : 0.0;
+    }
+
+    for (uint8_t i = 0; i < num_attributes; i++) {
+      stats_column_t* column = &stats->columns[i];
+      column->attribute_type = dbms_get_catalog_record(session->catalog, i)->attribute_type;
+      summarize_column(column, samples[i].values, sample_count, samples[i].registers, stats->meta.row_count,
+                       taken == page_count);
+      apply_zone_map_range(column, zone_map, i);
+    }
+    success = write_file(session, stats);
+  }
+
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    free(samples[i].values);
+  }
+  free(samples);
+  if (!success) {
+    stats_free(stats);
+    return false;
+  }
+
+  stats_free(session->stats);
+  session->stats = stats;
+  return true;
+}
+
+void stats_free(table_stats_t* stats) {
+  if (!stats) {
+    return;
+  }
+  free(stats->columns);
+  free(stats);
+}
+
+double stats_row_count(const dbms_session_t* session) {
+  if (!session) {
+    return 0.0;
+  }
+  const table_stats_t* stats = session->stats;
+  if (!stats || stats->meta.page_count == 0) {
+    return (double)session->page_count * (double)dbms_catalog_tuples_per_page(session->catalog);
+  }
+  // Inserts and vacuums since the analyze change the page count, the density stays about the same
+  return stats->meta.row_count * (double)session->page_count / (double)stats->meta.page_count;
+}
+
+double stats_attribute_selectivity(const dbms_session_t* session, const selection_criteria_t* criteria,
+                                   uint8_t attribute_index) {
+  if (!session || !session->stats || !criteria || attribute_index >= session->stats->meta.column_count) {
+    return 1.0;
+  }
+  const stats_column_t* column = &session->stats->columns[attribute_index];
+  if (column->bucket_count == 0) {
+    return 1.0;
+  }
+
+  // Ranges narrow one interval of the distribution, equalities pick a share of it
+  double low = 0.0;
+  double high = 1.0;
+  double equality = 1.0;
+  double not_equal = 1.0;
+  bool has_equality = false;
+  for (size_t i = 0; i < criteria->proposition_count; i++) {
+    const proposition_t* proposition = &criteria->propositions[i];
+    if (proposition->attribute_index != attribute_index) {
+      continue;
+    }
+
+    uint64_t key = btree_normalize_key(&proposition->value);
+    double equal = equality_fraction(column, key);
+    double below = cumulative_fraction(column, key);
+    switch (proposition->operator) {
+      case OPERATOR_EQUAL:
+        equality = fmin(equality, equal);
+        has_equality = true;
+        break;
+      case OPERATOR_NOT_EQUAL:
+        not_equal *= 1.0 - equal;
+        break;
+      case OPERATOR_LESS_THAN:
+        high = fmin(high, below);
+        break;
+      case OPERATOR_LESS_EQUAL:
+        high = fmin(high, below + equal);
+        break;
+      case OPERATOR_GREATER_THAN:
+        low = fmax(low, below + equal);
+        break;
+      case OPERATOR_GREATER_EQUAL:
+        low = fmax(low, below);
+        break;
+      default:
+        break;
+    }
+  }
+
+  double range = fmax(high - low, 0.0);
+  double selectivity = (has_equality ? fmin(equality, range) : range) * not_equal;
+  return fmin(fmax(selectivity, 0.0), 1.0);
+}
+
+double stats_selectivity(const dbms_session_t* session, const selection_criteria_t* criteria) {
+  if (!session || !session->stats || !criteria) {
+    return 1.0;
+  }
+
+  double selectivity = 1.0;
+  for (uint8_t i = 0; i < session->stats->meta.column_count; i++) {
+    selectivity *= stats_attribute_selectivity(session, criteria, i);
+  }
+  return selectivity;
+}
+
+double stats_seq_scan_cost(const dbms_session_t* session) {
+  if (!session) {
+    return 0.0;
+  }
+  return (double)session->page_count * STATS_SEQ_PAGE_COST + stats_row_count(session) * STATS_CPU_TUPLE_COST;
+}
+
+double stats_index_scan_cost(const dbms_session_t* session, double selectivity, double probe_pages) {
+  if (!session) {
+    return 0.0;
+  }
+
+  // Cardenas: m matches spread over P pages touch P * (1 - (1 - 1/P)^m) of them
+  double table_rows = stats_row_count(session);
+  double rows = table_rows * selectivity;
+  double pages = (double)session->page_count;
+  if (pages <= 0) {
+    return probe_pages * STATS_RANDOM_PAGE_COST;
+  }
+  double pages_fetched = pages * (1.0 - pow(1.0 - 1.0 / pages, rows));
+  // A pinned page is decoded whole, so every tuple on a fetched page costs CPU
+  return (probe_pages + pages_fetched) * STATS_RANDOM_PAGE_COST +
+         pages_fetched * (table_rows / pages) * STATS_CPU_TUPLE_COST;
+}
+
+bool stats_prefer_index_scan(const dbms_session_t* session, double selectivity, double probe_pages) {
+  // Without statistics an applicable index is always used
+  if (!session || !session->stats) {
+    return true;
+  }
+  return stats_index_scan_cost(session, selectivity, probe_pages) <= stats_seq_scan_cost(session);
+}
+
+double stats_nested_loop_cost(const dbms_session_t* outer, const dbms_session_t* inner, int outer_attribute,
+                              int inner_attribute, bool is_inner_filtered) {
+  if (!outer || !inner) {
+    return 0.0;
+  }
+
+  // Outer values the Bloom filter rules out skip the inner scan, at best all but the inner's distinct values
+  double probe_fraction = 1.0;
+  if (is_inner_filtered && outer_attribute >= 0 && inner_attribute >= 0 && outer->stats && inner->stats &&
+      outer_attribute < outer->stats->meta.column_count && inner_attribute < inner->stats->meta.column_count) {
+    double outer_distinct = outer->stats->columns[outer_attribute].distinct_count;
+    double inner_distinct = inner->stats->columns[inner_attribute].distinct_count;
+    if (outer_distinct > 0) {
+      probe_fraction = fmin(1.0, inner_distinct / outer_distinct);
+    }
+  }
+  return stats_seq_scan_cost(outer) + stats_row_count(outer) * probe_fraction * stats_seq_scan_cost(inner);
+}
+
+static char* stats_filename(const char* table_filename) {
+  size_t length = strlen(table_filename) + strlen(STATS_FILE_EXTENSION) + 1;
+  char* filename = malloc(length);
+  if (!filename) {
+    fprintf(stderr, "Memory allocation failed for statistics filename\n");
+    return NULL;
+  }
+  snprintf(filename, length, "%s%s", table_filename, STATS_FILE_EXTENSION);
+  return filename;
+}
+
+// SplitMix64 finalizer, spreads the identities of close INT values over all 64 bits
+static uint64_t mix(uint64_t key) {
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+// The top bits pick a register, which keeps the longest run of leading zeros seen in the rest
+static void hll_add(uint8_t* registers, uint64_t identity) {
+  uint64_t hash = mix(identity);
+  uint32_t index = (uint32_t)(hash >> (64 - STATS_HLL_BITS));
+  uint64_t rest = (hash << STATS_HLL_BITS) | (1ULL << (STATS_HLL_BITS - 1));
+  uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+  if (rank > registers[index]) {
+    registers[index] = rank;
+  }
+}
+
+static double hll_estimate(const uint8_t* registers) {
+  double m = STATS_HLL_REGISTERS;
+  double sum = 0.0;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < STATS_HLL_REGISTERS; i++) {
+    sum += ldexp(1.0, -registers[i]);
+    zeros += registers[i] == 0;
+  }
+  double estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+  // Linear counting is more accurate while many registers are still empty
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * log(m / zeros);
+  }
+  return estimate;
+}
+
+static int compare_sample_values(const void* a, const void* b) {
+  const sample_value_t* left = (const sample_value_t*)a;
+  const sample_value_t* right = (const sample_value_t*)b;
+  if (left->key != right->key) {
+    return left->key < right->key ? -1 : 1;
+  }
+  if (left->identity != right->identity) {
+    return left->identity < right->identity ? -1 : 1;
+  }
+  return 0;
+}
+
+static void summarize_column(stats_column_t* column, sample_value_t* values, size_t count, const uint8_t* registers,
+                             double row_count, bool is_full_scan) {
+  if (count == 0) {
+    return;
+  }
+
+  // Equal values end up next to each other
+  qsort(values, count, sizeof(sample_value_t), compare_sample_values);
+  column->min_key = values[0].key;
+  column->max_key = values[count - 1].key;
+  column->bucket_count = count < STATS_HISTOGRAM_BUCKETS ? (uint8_t)count : STATS_HISTOGRAM_BUCKETS;
+  for (uint8_t i = 0; i <= column->bucket_count; i++) {
+    column->bounds[i] = values[(size_t)i * (count - 1) / column->bucket_count].key;
+  }
+
+  double distinct = fmin(hll_estimate(registers), (double)count);
+  if (is_full_scan || row_count <= (double)count) {
+    column->distinct_count = fmax(distinct, 1.0);
+    return;
+  }
+
+  // Values seen once in the sample hint at more unseen ones: Haas and Stokes' Duj1 estimator
+  double singletons = 0;
+  for (size_t i = 0; i < count; i++) {
+    bool is_first = i == 0 || compare_sample_values(&values[i - 1], &values[i]) != 0;
+    bool is_last = i + 1 == count || compare_sample_values(&values[i], &values[i + 1]) != 0;
+    singletons += is_first && is_last;
+  }
+  double n = (double)count;
+  double scaled = n * distinct / (n - singletons + singletons * n / row_count);
+  column->distinct_count = fmax(fmin(scaled, row_count), fmax(distinct, 1.0));
+}
+
+// The zone map has the exact min and max of every INT and FLOAT attribute, the sample only its own
+static void apply_zone_map_range(stats_column_t* column, const zone_map_t* zone_map, uint8_t attribute_index) {
+  if (!zone_map || column->bucket_count == 0 || attribute_index >= zone_map->attribute_count ||
+      zone_map->attribute_columns[attribute_index] < 0) {
+    return;
+  }
+
+  uint8_t zone_column = (uint8_t)zone_map->attribute_columns[attribute_index];
+  double min = INFINITY;
+  double max = -INFINITY;
+  for (uint64_t entry = 0; entry < zone_map->page_count; entry++) {
+    const zone_range_t* range = &zone_map->ranges[entry * zone_map->column_count + zone_column];
+    if (range->min <= range->max) {
+      min = fmin(min, range->min);
+      max = fmax(max, range->max);
+    }
+  }
+  if (min > max) {
+    return;
+  }
+
+  attribute_value_t low = {.type = column->attribute_type};
+  attribute_value_t high = {.type = column->attribute_type};
+  if (column->attribute_type == ATTRIBUTE_TYPE_INT) {
+    low.int_value = (int32_t)min;
+    high.int_value = (int32_t)max;
+  } else {
+    low.float_value = (float)min;
+    high.float_value = (float)max;
+  }
+  column->min_key = btree_normalize_key(&low);
+  column->max_key = btree_normalize_key(&high);
+  column->bounds[0] = column->min_key;
+  column->bounds[column->bucket_count] = column->max_key;
+}
+
+// Fraction of the values below the key, interpolated linearly within its bucket
+static double cumulative_fraction(const stats_column_t* column, uint64_t key) {
+  uint8_t bucket_count = column->bucket_count;
+  if (key <= column->bounds[0]) {
+    return 0.0;
+  }
+  if (key > column->bounds[bucket_count]) {
+    return 1.0;
+  }
+
+  // First bound at or above the key, the bucket before it holds the key
+  uint8_t low = 1;
+  uint8_t high = bucket_count;
+  while (low < high) {
+    uint8_t middle = (uint8_t)((low + high) / 2);
+    if (column->bounds[middle] >= key) {
+      high = middle;
+    } else {
+      low = (uint8_t)(middle + 1);
+    }
+  }
+  uint8_t bucket = (uint8_t)(low - 1);
+  double width = (double)(column->bounds[low] - column->bounds[bucket]);
+  return (bucket + (double)(key - column->bounds[bucket]) / width) / bucket_count;
+}
+
+// A value repeated across several bounds fills the buckets between them and part of the ones on either side,
+// others fit in one bucket and get 1 / distinct count
+static double equality_fraction(const stats_column_t* column, uint64_t key) {
+  if (key < column->min_key || key > column->max_key) {
+    return 0.0;
+  }
+
+  uint32_t equal_bounds = 0;
+  for (uint8_t i = 0; i <= column->bucket_count; i++) {
+    equal_bounds += column->bounds[i] == key;
+  }
+  if (equal_bounds > 1) {
+    return fmin((double)equal_bounds / column->bucket_count, 1.0);
+  }
+  double distinct = column->distinct_count > 1.0 ? 1.0 / column->distinct_count : 1.0;
+  return fmin(distinct, 1.0 / column->bucket_count);
+}
+
+static bool write_file(const dbms_session_t* session, const table_stats_t* stats) {
+  char* filename = stats_filename(session->filename);
+  if (!filename) {
+    return false;
+  }
+  int fd = ssdio_open(filename, true);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to create statistics file: %s\n", filename);
+    free(filename);
+    return false;
+  }
+  free(filename);
+
+  size_t columns_per_page = sizeof(page_t) / sizeof(stats_column_t);
+  size_t first_page_columns = (sizeof(page_t) - sizeof(stats_file_meta_t)) / sizeof(stats_column_t);
+  uint8_t column_count = stats->meta.column_count;
+  uint64_t page_count = 1;
+  if (column_count > first_page_columns) {
+    page_count += (column_count - first_page_columns + columns_per_page - 1) / columns_per_page;
+  }
+
+  char* pages = aligned_alloc(PAGE_SIZE, page_count * sizeof(page_t));
+  if (!pages) {
+    fprintf(stderr, "Memory allocation failed for statistics pages\n");
+    ssdio_close(fd);
+    return false;
+  }
+  memset(pages, 0, page_count * sizeof(page_t));
+  memcpy(pages, &stats->meta, sizeof(stats->meta));
+  size_t offset = sizeof(stats_file_meta_t);
+  for (uint8_t i = 0; i < column_count; i++) {
+    if (offset % sizeof(page_t) + sizeof(stats_column_t) > sizeof(page_t)) {
+      offset += sizeof(page_t) - offset % sizeof(page_t);
+    }
+    memcpy(pages + offset, &stats->columns[i], sizeof(stats_column_t));
+    offset += sizeof(stats_column_t);
+  }
+
+  // The meta page goes last, a file cut short by a crash has no magic and is ignored
+  bool success = true;
+  for (uint64_t page_id = page_count; page_id-- > 0 && success;) {
+    success = ssdio_write_page(fd, page_id, (page_t*)(pages + page_id * sizeof(page_t)));
+    if (page_id == 1) {
+      ssdio_flush(fd);
+    }
+  }
+  if (success) {
+    ssdio_flush(fd);
+  } else {
+    fprintf(stderr, "Failed to write statistics file of %s\n", session->filename);
+  }
+  free(pages);
+  ssdio_close(fd);
+  return success;
+}
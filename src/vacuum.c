@@ -0,0 +1,68 @@
+#include "vacuum.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+vacuum_t* vacuum_start(dbms_session_t* session, bool punch_holes) {
+  if (!session) {
+    return NULL;
+  }
+
+  vacuum_t* vacuum = calloc(1, sizeof(vacuum_t));
+  if (!vacuum) {
+    fprintf(stderr, "Memory allocation failed for vacuum\n");
+    return NULL;
+  }
+  vacuum->punch_holes = punch_holes;
+  vacuum->target_page_id = 1;
+  vacuum->start_page_count = session->page_count;
+  return vacuum;
+}
+
+bool vacuum_step(dbms_session_t* session, vacuum_t* vacuum, size_t budget) {
+  if (!session || !vacuum || vacuum->is_done) {
+    return false;
+  }
+
+  // Commands run between steps may have added pages, the tail is found again every step
+  uint32_t page_count = session->page_count;
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  for (size_t work = 0; work < budget; work++) {
+    if (page_count <= 1 || vacuum->target_page_id >= page_count) {
+      vacuum->is_done = true;
+      break;
+    }
+
+    buffer_page_t* tail_page = dbms_get_buffer_page(session, page_count);
+    if (!tail_page) {
+      vacuum->is_done = true;
+      break;
+    }
+    uint64_t slot_id = dbms_next_live_slot(session->catalog, tail_page->page, 0);
+    if (slot_id >= tuples_per_page) {
+      page_count--;
+      continue;
+    }
+
+    // Nothing left to move the tuple to ends the vacuum, the pages after its page stay empty
+    tuple_id_t tuple_id = {.page_id = page_count, .slot_id = slot_id};
+    tuple_t* moved = dbms_relocate_tuple(session, tuple_id, vacuum->target_page_id);
+    if (!moved) {
+      vacuum->is_done = true;
+      break;
+    }
+    vacuum->target_page_id = moved->id.page_id;
+    vacuum->tuples_moved++;
+  }
+
+  if (page_count < session->page_count) {
+    vacuum->pages_freed += session->page_count - page_count;
+    if (!dbms_truncate_table(session, page_count, vacuum->punch_holes)) {
+      fprintf(stderr, "Failed to truncate %s to %u pages\n", session->table_name, page_count);
+      vacuum->is_done = true;
+    }
+  }
+  return !vacuum->is_done;
+}
+
+void vacuum_free(vacuum_t* vacuum) { free(vacuum); }
@@ -0,0 +1,514 @@
+#include "zone_map.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "align.h"
+#include "ssdio.h"
+
+#define ZONE_MAP_VERSION 1
+#define ZONE_MAP_META_PAGE_ID 0
+#define ZONE_MAP_INITIAL_CAPACITY 64
+
+_Static_assert(sizeof(zone_map_file_meta_t) <= sizeof(page_t), "Zone map meta must fit in a page");
+
+static zone_map_t* allocate_zone_map(const dbms_session_t* session);
+static bool ensure_capacity(zone_map_t* zone_map, uint64_t page_count);
+static void reset_entry(zone_map_t* zone_map, uint64_t entry);
+static double column_value(const zone_map_t* zone_map, const attribute_value_t* attributes, uint8_t column);
+static void widen_range(zone_range_t* range, double value);
+static bool mark_changed(zone_map_t* zone_map, uint64_t page_id);
+static bool write_meta(zone_map_t* zone_map, page_t* page, bool is_clean);
+static bool load_file(zone_map_t* zone_map, const dbms_session_t* session);
+static bool rebuild(zone_map_t* zone_map, const dbms_session_t* session);
+
+zone_map_t* zone_map_open(dbms_session_t* session) {
+  if (!session || !session->catalog) {
+    return NULL;
+  }
+
+  zone_map_t* zone_map = allocate_zone_map(session);
+  if (!zone_map) {
+    return NULL;
+  }
+
+  // Tables without numeric attributes have nothing to prune on
+  if (zone_map->column_count == 0) {
+    zone_map_free(zone_map);
+    return NULL;
+  }
+
+  zone_map->fd = ssdio_open(zone_map->filename, false);
+  if (zone_map->fd >= 0 && load_file(zone_map, session)) {
+    zone_map->is_clean = true;
+    return zone_map;
+  }
+
+  // Missing, stale or unreadable: build it from the table and write it out
+  if (zone_map->fd < 0) {
+    zone_map->fd = ssdio_open(zone_map->filename, true);
+    if (zone_map->fd < 0) {
+      fprintf(stderr, "Failed to create zone map file: %s\n", zone_map->filename);
+      zone_map_free(zone_map);
+      return NULL;
+    }
+  }
+  if (!rebuild(zone_map, session)) {
+    fprintf(stderr, "Failed to build zone map for %s\n", session->filename);
+    zone_map_free(zone_map);
+    return NULL;
+  }
+
+  zone_map->is_clean = false;
+  if (!zone_map_sync(zone_map)) {
+    zone_map_free(zone_map);
+    return NULL;
+  }
+  return zone_map;
+}
+
+bool zone_map_sync(zone_map_t* zone_map) {
+  if (!zone_map) {
+    return false;
+  }
+  if (zone_map->is_clean) {
+    return true;
+  }
+
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  if (!page) {
+    fprintf(stderr, "Memory allocation failed for zone map page\n");
+    return false;
+  }
+
+  uint64_t file_pages = (zone_map->page_count + zone_map->file_page_entries - 1) / zone_map->file_page_entries;
+  for (uint64_t file_page = 0; file_page < file_pages; file_page++) {
+    if (!zone_map->dirty_pages[file_page]) {
+      continue;
+    }
+
+    memset(page, 0, sizeof(page_t));
+    unsigned char* data = (unsigned char*)page;
+    uint64_t first = file_page * zone_map->file_page_entries;
+    for (uint64_t entry = first; entry < zone_map->page_count && entry < first + zone_map->file_page_entries;
+         entry++) {
+      unsigned char* out = data + (entry - first) * zone_map->entry_size;
+      store_u64(out, zone_map->tuple_counts[entry]);
+      out += sizeof(uint64_t);
+      for (uint8_t column = 0; column < zone_map->column_count; column++) {
+        const zone_range_t* range = &zone_map->ranges[entry * zone_map->column_count + column];
+        store_f64(out, range->min);
+        store_f64(out + sizeof(double), range->max);
+        out += sizeof(zone_range_t);
+      }
+    }
+
+    if (!ssdio_write_page(zone_map->fd, file_page + 1, page)) {
+      fprintf(stderr, "Failed to write zone map page %llu\n", (unsigned long long)(file_page + 1));
+      free(page);
+      return false;
+    }
+    zone_map->dirty_pages[file_page] = false;
+  }
+  // Entries must be on disk before the meta page says they are current
+  ssdio_flush(zone_map->fd);
+
+  bool success = write_meta(zone_map, page, true);
+  free(page);
+  zone_map->is_clean = success;
+  return success;
+}
+
+void zone_map_free(zone_map_t* zone_map) {
+  if (!zone_map) {
+    return;
+  }
+
+  if (zone_map->fd >= 0) {
+    ssdio_close(zone_map->fd);
+  }
+  free(zone_map->filename);
+  free(zone_map->column_attributes);
+  free(zone_map->column_types);
+  free(zone_map->column_offsets);
+  free(zone_map->column_strides);
+  free(zone_map->attribute_columns);
+  free(zone_map->tuple_counts);
+  free(zone_map->ranges);
+  free(zone_map->dirty_pages);
+  free(zone_map);
+}
+
+void zone_map_insert_tuple(zone_map_t* zone_map, const tuple_t* tuple) {
+  if (!zone_map || !tuple || tuple->id.page_id == 0) {
+    return;
+  }
+  if (!ensure_capacity(zone_map, tuple->id.page_id) || !mark_changed(zone_map, tuple->id.page_id)) {
+    return;
+  }
+
+  uint64_t entry = tuple->id.page_id - 1;
+  zone_map->tuple_counts[entry]++;
+  for (uint8_t column = 0; column < zone_map->column_count; column++) {
+    widen_range(&zone_map->ranges[entry * zone_map->column_count + column],
+                column_value(zone_map, tuple->attributes, column));
+  }
+}
+
+void zone_map_delete_tuple(zone_map_t* zone_map, const buffer_page_t* buffer_page, const tuple_t* tuple) {
+  if (!zone_map || !buffer_page || !tuple || tuple->id.page_id == 0 || tuple->id.page_id > zone_map->page_count) {
+    return;
+  }
+  if (!mark_changed(zone_map, tuple->id.page_id)) {
+    return;
+  }
+
+  uint64_t entry = tuple->id.page_id - 1;
+  if (zone_map->tuple_counts[entry] <= 1) {
+    reset_entry(zone_map, entry);
+    return;
+  }
+  zone_map->tuple_counts[entry]--;
+
+  // Only a range bounded by this tuple can shrink
+  for (uint8_t column = 0; column < zone_map->column_count; column++) {
+    zone_range_t* range = &zone_map->ranges[entry * zone_map->column_count + column];
+    double value = column_value(zone_map, tuple->attributes, column);
+    if (value != range->min && value != range->max) {
+      continue;
+    }
+
+    zone_range_t recomputed = {.min = INFINITY, .max = -INFINITY};
+    for (uint64_t slot = 0; slot < zone_map->tuples_per_page; slot++) {
+      const tuple_t* other = &buffer_page->tuples[slot];
+      if (other != tuple && !other->is_null) {
+        widen_range(&recomputed, column_value(zone_map, other->attributes, column));
+      }
+    }
+    *range = recomputed;
+  }
+}
+
+bool zone_map_can_skip_page(zone_map_t* zone_map, uint64_t page_id, const selection_criteria_t* criteria) {
+  // Pages the zone map does not cover are always read
+  if (!zone_map || page_id == 0 || page_id > zone_map->page_count) {
+    return false;
+  }
+
+  uint64_t entry = page_id - 1;
+  bool skip = zone_map->tuple_counts[entry] == 0;
+  for (size_t i = 0; criteria && !skip && i < criteria->proposition_count; i++) {
+    const proposition_t* proposition = &criteria->propositions[i];
+    if (proposition->attribute_index >= zone_map->attribute_count) {
+      continue;
+    }
+    int16_t column = zone_map->attribute_columns[proposition->attribute_index];
+    if (column < 0 || proposition->value.type != zone_map->column_types[column]) {
+      continue;
+    }
+
+    double value = proposition->value.type == ATTRIBUTE_TYPE_INT ? (double)proposition->value.int_value
+                                                                 : (double)proposition->value.float_value;
+    if (isnan(value)) {
+      continue;
+    }
+
+    const zone_range_t* range = &zone_map->ranges[entry * zone_map->column_count + column];
+    switch (proposition->operator) {
+      case OPERATOR_EQUAL:
+        skip = value < range->min || value > range->max;
+        break;
+      case OPERATOR_NOT_EQUAL:
+        skip = range->min == value && range->max == value;
+        break;
+      case OPERATOR_LESS_THAN:
+        skip = range->min >= value;
+        break;
+      case OPERATOR_LESS_EQUAL:
+        skip = range->min > value;
+        break;
+      case OPERATOR_GREATER_THAN:
+        skip = range->max <= value;
+        break;
+      case OPERATOR_GREATER_EQUAL:
+        skip = range->max < value;
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (skip) {
+    zone_map->pages_skipped++;
+  }
+  return skip;
+}
+
+bool zone_map_truncate(zone_map_t* zone_map, uint64_t page_count) {
+  if (!zone_map || page_count >= zone_map->page_count) {
+    return true;
+  }
+  if (!mark_changed(zone_map, page_count + 1)) {
+    return false;
+  }
+
+  zone_map->page_count = page_count;
+  uint64_t file_pages = (page_count + zone_map->file_page_entries - 1) / zone_map->file_page_entries;
+  return ssdio_truncate(zone_map->fd, (off_t)(file_pages + 1) * PAGE_SIZE);
+}
+
+static zone_map_t* allocate_zone_map(const dbms_session_t* session) {
+  zone_map_t* zone_map = calloc(1, sizeof(zone_map_t));
+  if (!zone_map) {
+    fprintf(stderr, "Memory allocation failed for zone map\n");
+    return NULL;
+  }
+  zone_map->fd = -1;
+
+  size_t length = strlen(session->filename) + strlen(ZONE_MAP_FILE_EXTENSION) + 1;
+  zone_map->filename = malloc(length);
+  uint8_t num_attributes = dbms_catalog_num_used(session->catalog);
+  zone_map->attribute_count = num_attributes;
+  zone_map->attribute_columns = malloc((num_attributes + 1) * sizeof(int16_t));
+  zone_map->column_attributes = malloc(num_attributes + 1);
+  zone_map->column_types = malloc(num_attributes + 1);
+  zone_map->column_offsets = malloc((num_attributes + 1) * sizeof(off_t));
+  zone_map->column_strides = malloc((num_attributes + 1) * sizeof(size_t));
+  if (!zone_map->filename || !zone_map->attribute_columns || !zone_map->column_attributes ||
+      !zone_map->column_types || !zone_map->column_offsets || !zone_map->column_strides) {
+    fprintf(stderr, "Memory allocation failed for zone map\n");
+    zone_map_free(zone_map);
+    return NULL;
+  }
+  snprintf(zone_map->filename, length, "%s%s", session->filename, ZONE_MAP_FILE_EXTENSION);
+
+  for (uint8_t i = 0; i < num_attributes; i++) {
+    catalog_record_t* record = dbms_get_catalog_record(session->catalog, i);
+    zone_map->attribute_columns[i] = -1;
+    if (record && (record->attribute_type == ATTRIBUTE_TYPE_INT || record->attribute_type == ATTRIBUTE_TYPE_FLOAT)) {
+      uint8_t column = zone_map->column_count++;
+      zone_map->attribute_columns[i] = column;
+      zone_map->column_attributes[column] = i;
+      zone_map->column_types[column] = record->attribute_type;
+      zone_map->column_offsets[column] = dbms_get_column_offset(session->catalog, i);
+      zone_map->column_strides[column] = dbms_get_column_stride(session->catalog, i);
+    }
+  }
+
+  zone_map->tuple_size = session->catalog->tuple_size;
+  zone_map->tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  zone_map->entry_size = sizeof(uint64_t) + zone_map->column_count * sizeof(zone_range_t);
+  zone_map->file_page_entries = PAGE_SIZE / zone_map->entry_size;
+  return zone_map;
+}
+
+static bool ensure_capacity(zone_map_t* zone_map, uint64_t page_count) {
+  if (page_count > zone_map->capacity) {
+    uint64_t capacity = zone_map->capacity ? zone_map->capacity : ZONE_MAP_INITIAL_CAPACITY;
+    while (capacity < page_count) {
+      capacity *= 2;
+    }
+
+    uint32_t* tuple_counts = realloc(zone_map->tuple_counts, capacity * sizeof(uint32_t));
+    if (!tuple_counts) {
+      fprintf(stderr, "Memory allocation failed for zone map entries\n");
+      return false;
+    }
+    zone_map->tuple_counts = tuple_counts;
+
+    zone_range_t* ranges = realloc(zone_map->ranges, capacity * zone_map->column_count * sizeof(zone_range_t));
+    if (!ranges) {
+      fprintf(stderr, "Memory allocation failed for zone map entries\n");
+      return false;
+    }
+    zone_map->ranges = ranges;
+
+    uint64_t old_file_pages = (zone_map->capacity + zone_map->file_page_entries - 1) / zone_map->file_page_entries;
+    uint64_t file_pages = (capacity + zone_map->file_page_entries - 1) / zone_map->file_page_entries;
+    bool* dirty_pages = realloc(zone_map->dirty_pages, file_pages * sizeof(bool));
+    if (!dirty_pages) {
+      fprintf(stderr, "Memory allocation failed for zone map entries\n");
+      return false;
+    }
+    memset(dirty_pages + old_file_pages, 0, (file_pages - old_file_pages) * sizeof(bool));
+    zone_map->dirty_pages = dirty_pages;
+    zone_map->capacity = capacity;
+  }
+
+  // Pages added since hold no tuples yet
+  while (zone_map->page_count < page_count) {
+    reset_entry(zone_map, zone_map->page_count);
+    zone_map->dirty_pages[zone_map->page_count / zone_map->file_page_entries] = true;
+    zone_map->page_count++;
+  }
+  return true;
+}
+
+static void reset_entry(zone_map_t* zone_map, uint64_t entry) {
+  zone_map->tuple_counts[entry] = 0;
+  for (uint8_t column = 0; column < zone_map->column_count; column++) {
+    zone_map->ranges[entry * zone_map->column_count + column] = (zone_range_t){.min = INFINITY, .max = -INFINITY};
+  }
+}
+
+static double column_value(const zone_map_t* zone_map, const attribute_value_t* attributes, uint8_t column) {
+  const attribute_value_t* value = &attributes[zone_map->column_attributes[column]];
+  return zone_map->column_types[column] == ATTRIBUTE_TYPE_INT ? (double)value->int_value : (double)value->float_value;
+}
+
+static void widen_range(zone_range_t* range, double value) {
+  // NaN never satisfies an ordered comparison, so it does not widen the range
+  if (value < range->min) {
+    range->min = value;
+  }
+  if (value > range->max) {
+    range->max = value;
+  }
+}
+
+static bool mark_changed(zone_map_t* zone_map, uint64_t page_id) {
+  // The file stops describing the table with the first change after a sync
+  if (zone_map->is_clean) {
+    page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+    if (!page) {
+      fprintf(stderr, "Memory allocation failed for zone map page\n");
+      return false;
+    }
+    bool success = write_meta(zone_map, page, false);
+    free(page);
+    if (!success) {
+      return false;
+    }
+    zone_map->is_clean = false;
+  }
+
+  zone_map->dirty_pages[(page_id - 1) / zone_map->file_page_entries] = true;
+  return true;
+}
+
+static bool write_meta(zone_map_t* zone_map, page_t* page, bool is_clean) {
+  memset(page, 0, sizeof(page_t));
+  zone_map_file_meta_t meta = {0};
+  memcpy(meta.magic, ZONE_MAP_FILE_MAGIC, sizeof(meta.magic));
+  meta.version = ZONE_MAP_VERSION;
+  meta.column_count = zone_map->column_count;
+  meta.is_clean = is_clean ? 1 : 0;
+  meta.tuple_size = zone_map->tuple_size;
+  meta.page_count = zone_map->page_count;
+  memcpy(page, &meta, sizeof(meta));
+
+  if (!ssdio_write_page(zone_map->fd, ZONE_MAP_META_PAGE_ID, page)) {
+    fprintf(stderr, "Failed to write zone map file: %s\n", zone_map->filename);
+    return false;
+  }
+  ssdio_flush(zone_map->fd);
+  return true;
+}
+
+static bool load_file(zone_map_t* zone_map, const dbms_session_t* session) {
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  if (!page) {
+    fprintf(stderr, "Memory allocation failed for zone map page\n");
+    return false;
+  }
+
+  zone_map_file_meta_t meta;
+  if (!ssdio_read_page(zone_map->fd, ZONE_MAP_META_PAGE_ID, page)) {
+    free(page);
+    return false;
+  }
+  memcpy(&meta, page, sizeof(meta));
+  if (memcmp(meta.magic, ZONE_MAP_FILE_MAGIC, sizeof(meta.magic)) != 0 || meta.version != ZONE_MAP_VERSION ||
+      meta.column_count != zone_map->column_count || meta.tuple_size != zone_map->tuple_size || !meta.is_clean ||
+      meta.page_count > session->page_count) {
+    free(page);
+    return false;
+  }
+
+  if (!ensure_capacity(zone_map, meta.page_count)) {
+    free(page);
+    return false;
+  }
+
+  const unsigned char* data = (const unsigned char*)page;
+  for (uint64_t entry = 0; entry < meta.page_count; entry++) {
+    uint64_t slot = entry % zone_map->file_page_entries;
+    if (slot == 0 && !ssdio_read_page(zone_map->fd, entry / zone_map->file_page_entries + 1, page)) {
+      free(page);
+      return false;
+    }
+
+    const unsigned char* in = data + slot * zone_map->entry_size;
+    zone_map->tuple_counts[entry] = (uint32_t)load_u64(in);
+    in += sizeof(uint64_t);
+    for (uint8_t column = 0; column < zone_map->column_count; column++) {
+      zone_range_t* range = &zone_map->ranges[entry * zone_map->column_count + column];
+      range->min = load_f64(in);
+      range->max = load_f64(in + sizeof(double));
+      in += sizeof(zone_range_t);
+    }
+  }
+  free(page);
+
+  // Pages the table gained after the sync were still empty then
+  if (!ensure_capacity(zone_map, session->page_count)) {
+    return false;
+  }
+  memset(zone_map->dirty_pages, 0,
+         ((zone_map->capacity + zone_map->file_page_entries - 1) / zone_map->file_page_entries) * sizeof(bool));
+  return true;
+}
+
+static bool rebuild(zone_map_t* zone_map, const dbms_session_t* session) {
+  if (!ensure_capacity(zone_map, session->page_count)) {
+    return false;
+  }
+
+  page_t* page = aligned_alloc(PAGE_SIZE, dbms_frame_size(session->catalog));
+  // Slotted records are unpacked into columns at the column offsets first
+  size_t unpacked_size = dbms_get_unpacked_size(session->catalog);
+  char* columns = unpacked_size > 0 ? malloc(unpacked_size) : NULL;
+  if (!page || (unpacked_size > 0 && !columns)) {
+    fprintf(stderr, "Memory allocation failed for zone map page\n");
+    free(page);
+    free(columns);
+    return false;
+  }
+  bool unpacked_attributes[CATALOG_MAX_RECORDS] = {false};
+  for (uint8_t column = 0; column < zone_map->column_count; column++) {
+    unpacked_attributes[zone_map->column_attributes[column]] = true;
+  }
+
+  // Read the table pages directly, the buffer pool is still empty when the session opens
+  for (uint64_t page_id = 1; page_id <= session->page_count; page_id++) {
+    if (!dbms_read_table_page(session, page_id, page) ||
+        (columns && !dbms_unpack_page(session, page, unpacked_attributes, columns))) {
+      fprintf(stderr, "Failed to read page %llu while building the zone map\n", (unsigned long long)page_id);
+      free(page);
+      free(columns);
+      return false;
+    }
+    const char* data = columns ? columns : page->data;
+
+    uint64_t entry = page_id - 1;
+    reset_entry(zone_map, entry);
+    for (uint64_t slot = dbms_next_live_slot(session->catalog, page, 0); slot < zone_map->tuples_per_page;
+         slot = dbms_next_live_slot(session->catalog, page, slot + 1)) {
+      zone_map->tuple_counts[entry]++;
+      for (uint8_t column = 0; column < zone_map->column_count; column++) {
+        const char* attribute_data =
+            data + zone_map->column_offsets[column] + slot * zone_map->column_strides[column];
+        double value = zone_map->column_types[column] == ATTRIBUTE_TYPE_INT ? (double)(int32_t)load_u32(attribute_data)
+                                                                            : (double)load_f32(attribute_data);
+        widen_range(&zone_map->ranges[entry * zone_map->column_count + column], value);
+      }
+    }
+    zone_map->dirty_pages[entry / zone_map->file_page_entries] = true;
+  }
+
+  free(page);
+  free(columns);
+  return true;
+}
@@ -0,0 +1,86 @@
+#ifndef TABLE_FIXTURE_H
+#define TABLE_FIXTURE_H
+
+// Table and session setup shared by the tests of the table formats (layouts, dictionary encoding,
+// compression, vacuum). Included once per test binary, after the binary defines DB_PATH.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dbms.h"
+#include "unity.h"
+
+#define FIXTURE_MAX_RECORDS 16
+#define EMPLOYEE_ATTRIBUTE_COUNT 5  // id, name, salary, department, is_active
+
+static const char* departments[] = {"Engineering", "Sales", "Marketing", "Support", "Finance"};
+#define DEPARTMENT_COUNT (sizeof(departments) / sizeof(departments[0]))
+
+catalog_record_t test_catalog_records[FIXTURE_MAX_RECORDS] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+static inline void open_session(void) {
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  TEST_ASSERT_NOT_NULL(test_dbms_session);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+static inline void close_session(void) {
+  dbms_free_dbms_manager(test_dbms_manager);
+  test_dbms_manager = NULL;
+  test_dbms_session = NULL;
+}
+
+// Creates DB_PATH from test_system_catalog, whose records and options are already set, and opens it
+static inline void create_table_from_catalog(void) {
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (uint8_t i = 0; i < test_system_catalog.record_count; i++) {
+    tuple_size += dbms_get_stored_size(&test_system_catalog, i);
+  }
+  test_system_catalog.tuple_size = tuple_size;
+
+  TEST_ASSERT_TRUE(dbms_create_table(DB_PATH, &test_system_catalog));
+  open_session();
+}
+
+// Padded to a multiple of 8 bytes: 1 + 4 + 50 + 4 + 30 + 1 + 6 = 96, or 1 + 4 + 2 + 4 + 2 + 1 + 2 = 16 with
+// name and department dictionary encoded
+static inline void create_employee_table(uint8_t layout, uint8_t compression, bool is_encoded) {
+  catalog_record_t records[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},         {"name", 50, ATTRIBUTE_TYPE_STRING, 1},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_active", 1, ATTRIBUTE_TYPE_BOOL, 4}, {PADDING_NAME, is_encoded ? 2 : 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+  memcpy(test_catalog_records, records, sizeof(records));
+
+  memset(&test_system_catalog, 0, sizeof(test_system_catalog));
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.record_count = EMPLOYEE_ATTRIBUTE_COUNT + 1;
+  test_system_catalog.layout = layout;
+  test_system_catalog.compression = compression;
+  if (is_encoded) {
+    TEST_ASSERT_TRUE(dbms_set_dictionary_encoded(&test_system_catalog, 1));
+    TEST_ASSERT_TRUE(dbms_set_dictionary_encoded(&test_system_catalog, 3));
+  }
+  create_table_from_catalog();
+}
+
+// Row i: id i, name Name<i> (Name<i % name_count> if name_count is not 0), salary i, the department
+// i % DEPARTMENT_COUNT, active if i is even
+static inline void insert_employees(int count, int name_count) {
+  char name[16];
+  for (int i = 0; i < count; i++) {
+    snprintf(name, sizeof(name), "Name%d", name_count ? i % name_count : i);
+    attribute_value_t attrs[EMPLOYEE_ATTRIBUTE_COUNT] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = i},
+        {.type = ATTRIBUTE_TYPE_STRING, .string_value = name},
+        {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = (float)i},
+        {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)departments[i % DEPARTMENT_COUNT]},
+        {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = i % 2 == 0}};
+    TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+  }
+}
+
+#endif /* TABLE_FIXTURE_H */
@@ -4,12 +4,16 @@
 #include "dbms.h"
 #include "executor/executor.h"
 #include "executor/filter.h"
+#include "executor/hash_aggregate.h"
 #include "executor/nested_loop_join.h"
 #include "executor/project.h"
+#include "executor/scan_aggregate.h"
 #include "executor/seq_scan.h"
+#include "index.h"
 #include "query.h"
 #include "ssdio.h"
 #include "unity.h"
+#include "zone_map.h"
 
 #define TEST_CATALOG_SIZE 6
 #define TEST_TUPLE_SIZE 96
@@ -57,7 +61,10 @@ void setUp() {
 void tearDown() {
     dbms_free_dbms_manager(test_dbms_manager);
     remove(DB_PATH_A);
+    remove(DB_PATH_A ZONE_MAP_FILE_EXTENSION);
     remove(DB_PATH_B);
+    remove(DB_PATH_B ZONE_MAP_FILE_EXTENSION);
+    remove(DB_PATH_B ".id" INDEX_FILE_EXTENSION);
 }
 
 // Helper to insert test tuples into a session
@@ -81,7 +88,7 @@ static void insert_tuples(dbms_session_t* session, int count, int start_id) {
 static void test_seq_scan_reset() {
     insert_tuples(session_a, 5, 1);
 
-    Operator* scan = seq_scan_create(session_a);
+    Operator* scan = seq_scan_create(session_a, NULL);
     TEST_ASSERT_NOT_NULL(scan);
 
     OP_OPEN(scan);
@@ -116,8 +123,8 @@ static void test_filter_reset() {
         .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 5}};
     selection_criteria_t criteria = {.propositions = &prop, .proposition_count = 1};
 
-    Operator* scan = seq_scan_create(session_a);
-    Operator* filter = filter_create(scan, session_a, &criteria);
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* filter = filter_create(scan, session_a, &criteria, NULL);
 
     OP_OPEN(filter);
 
@@ -155,9 +162,9 @@ static void test_cross_product_basic() {
 
     uint8_t num_attrs = dbms_catalog_num_used(session_a->catalog);
 
-    Operator* scan_a = seq_scan_create(session_a);
-    Operator* scan_b = seq_scan_create(session_b);
-    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs);
+    Operator* scan_a = seq_scan_create(session_a, NULL);
+    Operator* scan_b = seq_scan_create(session_b, NULL);
+    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs, NULL);
     TEST_ASSERT_NOT_NULL(join);
 
     OP_OPEN(join);
@@ -190,9 +197,9 @@ static void test_cross_product_empty_inner() {
 
     uint8_t num_attrs = dbms_catalog_num_used(session_a->catalog);
 
-    Operator* scan_a = seq_scan_create(session_a);
-    Operator* scan_b = seq_scan_create(session_b);
-    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs);
+    Operator* scan_a = seq_scan_create(session_a, NULL);
+    Operator* scan_b = seq_scan_create(session_b, NULL);
+    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs, NULL);
 
     OP_OPEN(join);
 
@@ -211,9 +218,9 @@ static void test_cross_product_empty_outer() {
 
     uint8_t num_attrs = dbms_catalog_num_used(session_a->catalog);
 
-    Operator* scan_a = seq_scan_create(session_a);
-    Operator* scan_b = seq_scan_create(session_b);
-    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs);
+    Operator* scan_a = seq_scan_create(session_a, NULL);
+    Operator* scan_b = seq_scan_create(session_b, NULL);
+    Operator* join = nested_loop_join_create(scan_a, scan_b, session_a, num_attrs, num_attrs, NULL);
 
     OP_OPEN(join);
 
@@ -225,6 +232,52 @@ static void test_cross_product_empty_outer() {
     operator_free(join);
 }
 
+static int count_equi_join(index_t* inner_index, uint64_t* outer_pruned) {
+    uint8_t num_attrs = dbms_catalog_num_used(session_a->catalog);
+    Operator* scan_a = seq_scan_create(session_a, NULL);
+    Operator* scan_b = seq_scan_create(session_b, NULL);
+    Operator* join = nested_loop_join_create_equi(scan_a, scan_b, session_a, num_attrs, num_attrs, 0, 0, inner_index, NULL);
+    TEST_ASSERT_NOT_NULL(join);
+
+    OP_OPEN(join);
+    int count = 0;
+    tuple_t* tuple;
+    while ((tuple = OP_NEXT(join)) != NULL) {
+        TEST_ASSERT_EQUAL_INT(tuple->attributes[0].int_value, tuple->attributes[num_attrs].int_value);
+        count++;
+    }
+    *outer_pruned = ((NestedLoopJoinState*)join->state)->outer_pruned;
+
+    OP_CLOSE(join);
+    operator_free(join);
+    return count;
+}
+
+static void test_equi_join_prunes_with_bloom_filter() {
+    // Only ids 15..20 are in both tables
+    insert_tuples(session_a, 20, 1);
+    insert_tuples(session_b, 10, 15);
+
+    uint64_t outer_pruned = 0;
+    TEST_ASSERT_EQUAL_INT(6, count_equi_join(NULL, &outer_pruned));
+    TEST_ASSERT_EQUAL_UINT64(0, outer_pruned);
+
+    // With a hash index on B.id the outer ids 1..14 never scan B (but for false positives)
+    session_b->indexes[0] = index_create(session_b, 0);
+    TEST_ASSERT_NOT_NULL(session_b->indexes[0]);
+    TEST_ASSERT_EQUAL_INT(6, count_equi_join(session_b->indexes[0], &outer_pruned));
+    TEST_ASSERT_TRUE(outer_pruned >= 12 && outer_pruned <= 14);
+
+    // The index must be on the inner join attribute
+    uint8_t num_attrs = dbms_catalog_num_used(session_a->catalog);
+    Operator* scan_a = seq_scan_create(session_a, NULL);
+    Operator* scan_b = seq_scan_create(session_b, NULL);
+    TEST_ASSERT_NULL(nested_loop_join_create_equi(scan_a, scan_b, session_a, num_attrs, num_attrs, 2, 2,
+                                                  session_b->indexes[0], NULL));
+    operator_free(scan_a);
+    operator_free(scan_b);
+}
+
 // ============================================================================
 // DISTINCT (duplicate elimination) tests
 // ============================================================================
@@ -281,8 +334,8 @@ static void test_distinct_eliminates_duplicates() {
         columns[i] = i;
     }
 
-    Operator* scan = seq_scan_create(session_a);
-    Operator* project = project_create(scan, session_a, columns, num_attrs, true);  // is_distinct = true
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* project = project_create(scan, session_a, columns, num_attrs, true, NULL);  // is_distinct = true
 
     OP_OPEN(project);
 
@@ -331,8 +384,8 @@ static void test_distinct_on_single_column() {
     // Project only column 0 (id) with DISTINCT
     uint8_t columns[] = {0};
 
-    Operator* scan = seq_scan_create(session_a);
-    Operator* project = project_create(scan, session_a, columns, 1, true);
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* project = project_create(scan, session_a, columns, 1, true, NULL);
 
     OP_OPEN(project);
 
@@ -370,9 +423,9 @@ static void test_distinct_with_filter() {
     // Project id column with DISTINCT
     uint8_t columns[] = {0};
 
-    Operator* scan = seq_scan_create(session_a);
-    Operator* filter = filter_create(scan, session_a, &criteria);
-    Operator* project = project_create(filter, session_a, columns, 1, true);
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* filter = filter_create(scan, session_a, &criteria, NULL);
+    Operator* project = project_create(filter, session_a, columns, 1, true, NULL);
 
     OP_OPEN(project);
 
@@ -399,8 +452,8 @@ static void test_project_reset_clears_distinct_set() {
     dbms_flush_buffer_pool(session_a);
 
     uint8_t columns[] = {0};  // Just id
-    Operator* scan = seq_scan_create(session_a);
-    Operator* project = project_create(scan, session_a, columns, 1, true);
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* project = project_create(scan, session_a, columns, 1, true, NULL);
 
     OP_OPEN(project);
 
@@ -421,6 +474,369 @@ static void test_project_reset_clears_distinct_set() {
     operator_free(project);
 }
 
+static void test_operator_tree_in_arena() {
+    insert_tuples(session_a, 4, 1);
+    insert_tuples(session_a, 4, 1);  // Duplicates
+    insert_tuples(session_b, 3, 1);
+
+    arena_t* arena = arena_create(1024);  // Small first chunk to force growth
+    TEST_ASSERT_NOT_NULL(arena);
+
+    // DISTINCT ids of A crossed with B, every operator allocated from the arena
+    uint8_t columns[] = {0};
+    uint8_t num_attrs = dbms_catalog_num_used(session_b->catalog);
+    Operator* scan_a = seq_scan_create(session_a, arena);
+    Operator* project = project_create(scan_a, session_a, columns, 1, true, arena);
+    Operator* scan_b = seq_scan_create(session_b, arena);
+    Operator* join = nested_loop_join_create(project, scan_b, session_a, 1, num_attrs, arena);
+    TEST_ASSERT_NOT_NULL(join);
+    TEST_ASSERT_EQUAL_PTR(arena, join->arena);
+    TEST_ASSERT_TRUE(arena->bytes_allocated > 0);
+
+    OP_OPEN(join);
+    int count = 0;
+    while (OP_NEXT(join) != NULL) count++;
+    TEST_ASSERT_EQUAL_INT(4 * 3, count);
+
+    // Reset reruns the DISTINCT set without growing the query arena
+    size_t allocated = arena->bytes_allocated;
+    OP_RESET(join);
+    count = 0;
+    while (OP_NEXT(join) != NULL) count++;
+    TEST_ASSERT_EQUAL_INT(4 * 3, count);
+    TEST_ASSERT_EQUAL_size_t(allocated, arena->bytes_allocated);
+
+    OP_CLOSE(join);
+    operator_free(join);
+    arena_free(arena);
+}
+
+// ============================================================================
+// HashAggregate (GROUP BY) tests
+// ============================================================================
+
+static void test_hash_aggregate_group_by() {
+    // is_active alternates: ids 1,3,5,7,9 are active (i even), 2,4,6,8,10 are not
+    insert_tuples(session_a, 10, 1);
+
+    uint8_t group_columns[] = {4};  // is_active
+    aggregate_t aggregates[] = {
+        {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+        {.function = AGGREGATE_SUM, .attribute_index = 0},
+        {.function = AGGREGATE_MIN, .attribute_index = 2},
+        {.function = AGGREGATE_MAX, .attribute_index = 2},
+        {.function = AGGREGATE_AVG, .attribute_index = 0}};
+
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* aggregate = hash_aggregate_create(scan, session_a, group_columns, 1, aggregates, 5, 0, NULL);
+    TEST_ASSERT_NOT_NULL(aggregate);
+
+    OP_OPEN(aggregate);
+
+    int groups = 0;
+    tuple_t* tuple;
+    while ((tuple = OP_NEXT(aggregate)) != NULL) {
+        TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_BOOL, tuple->attributes[0].type);
+        TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_INT, tuple->attributes[1].type);
+        TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_INT, tuple->attributes[2].type);
+        TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_FLOAT, tuple->attributes[3].type);
+        TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_FLOAT, tuple->attributes[5].type);
+
+        TEST_ASSERT_EQUAL_INT(5, tuple->attributes[1].int_value);
+        if (tuple->attributes[0].bool_value) {
+            TEST_ASSERT_EQUAL_INT(1 + 3 + 5 + 7 + 9, tuple->attributes[2].int_value);
+            TEST_ASSERT_EQUAL_FLOAT(50000.0f, tuple->attributes[3].float_value);
+            TEST_ASSERT_EQUAL_FLOAT(58000.0f, tuple->attributes[4].float_value);
+            TEST_ASSERT_EQUAL_FLOAT(5.0f, tuple->attributes[5].float_value);
+        } else {
+            TEST_ASSERT_EQUAL_INT(2 + 4 + 6 + 8 + 10, tuple->attributes[2].int_value);
+            TEST_ASSERT_EQUAL_FLOAT(51000.0f, tuple->attributes[3].float_value);
+            TEST_ASSERT_EQUAL_FLOAT(59000.0f, tuple->attributes[4].float_value);
+            TEST_ASSERT_EQUAL_FLOAT(6.0f, tuple->attributes[5].float_value);
+        }
+        groups++;
+    }
+    TEST_ASSERT_EQUAL_INT(2, groups);
+
+    OP_CLOSE(aggregate);
+    operator_free(aggregate);
+}
+
+static void test_hash_aggregate_with_filter_and_string_key() {
+    insert_tuples(session_a, 6, 1);
+
+    // Filter: id > 2
+    proposition_t props[1] = {
+        {.attribute_index = 0,
+         .operator= OPERATOR_GREATER_THAN,
+         .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 2}}};
+    selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+    uint8_t group_columns[] = {3};  // department
+    aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = 0}};
+
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* filter = filter_create(scan, session_a, &criteria, NULL);
+    Operator* aggregate = hash_aggregate_create(filter, session_a, group_columns, 1, aggregates, 1, 0, NULL);
+
+    OP_OPEN(aggregate);
+
+    tuple_t* tuple = OP_NEXT(aggregate);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_STRING("Engineering", tuple->attributes[0].string_value);
+    TEST_ASSERT_EQUAL_INT(4, tuple->attributes[1].int_value);
+    TEST_ASSERT_NULL(OP_NEXT(aggregate));
+
+    OP_CLOSE(aggregate);
+    operator_free(aggregate);
+}
+
+static void test_hash_aggregate_spills_when_over_budget() {
+    // 40 distinct ids, each inserted twice
+    insert_tuples(session_a, 40, 1);
+    insert_tuples(session_a, 40, 1);
+
+    uint8_t group_columns[] = {0};  // id
+    aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                                {.function = AGGREGATE_SUM, .attribute_index = 0}};
+
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* aggregate = hash_aggregate_create(scan, session_a, group_columns, 1, aggregates, 2, 4, NULL);
+
+    OP_OPEN(aggregate);
+
+    bool seen[41] = {false};
+    int groups = 0;
+    tuple_t* tuple;
+    while ((tuple = OP_NEXT(aggregate)) != NULL) {
+        int id = tuple->attributes[0].int_value;
+        TEST_ASSERT_TRUE(id >= 1 && id <= 40);
+        TEST_ASSERT_FALSE(seen[id]);
+        seen[id] = true;
+        TEST_ASSERT_EQUAL_INT(2, tuple->attributes[1].int_value);
+        TEST_ASSERT_EQUAL_INT(2 * id, tuple->attributes[2].int_value);
+        groups++;
+    }
+    TEST_ASSERT_EQUAL_INT(40, groups);
+
+    HashAggregateState* state = (HashAggregateState*)aggregate->state;
+    TEST_ASSERT_TRUE(state->spilled_rows > 0);
+
+    // Reset rebuilds the same result
+    OP_RESET(aggregate);
+    groups = 0;
+    while (OP_NEXT(aggregate) != NULL) groups++;
+    TEST_ASSERT_EQUAL_INT(40, groups);
+
+    OP_CLOSE(aggregate);
+    operator_free(aggregate);
+}
+
+static void test_hash_aggregate_empty_input() {
+    aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR}};
+
+    // Without GROUP BY an empty table still produces one row
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* aggregate = hash_aggregate_create(scan, session_a, NULL, 0, aggregates, 1, 0, NULL);
+
+    OP_OPEN(aggregate);
+    tuple_t* tuple = OP_NEXT(aggregate);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT(0, tuple->attributes[0].int_value);
+    TEST_ASSERT_NULL(OP_NEXT(aggregate));
+    OP_CLOSE(aggregate);
+    operator_free(aggregate);
+
+    // With GROUP BY there are no groups
+    uint8_t group_columns[] = {0};
+    scan = seq_scan_create(session_a, NULL);
+    aggregate = hash_aggregate_create(scan, session_a, group_columns, 1, aggregates, 1, 0, NULL);
+
+    OP_OPEN(aggregate);
+    TEST_ASSERT_NULL(OP_NEXT(aggregate));
+    OP_CLOSE(aggregate);
+    operator_free(aggregate);
+}
+
+// ============================================================================
+// ScanAggregate (ungrouped, raw page) tests
+// ============================================================================
+
+static void test_scan_aggregate_matches_hash_aggregate() {
+    // Spans several pages (84 tuples per page) so the kernels see full vectors and tails
+    insert_tuples(session_a, 301, -150);
+
+    proposition_t props[2] = {
+        {.attribute_index = 0,
+         .operator= OPERATOR_GREATER_THAN,
+         .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = -100}},
+        {.attribute_index = 4,
+         .operator= OPERATOR_EQUAL,
+         .value = {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}}};
+    selection_criteria_t criteria = {.propositions = props, .proposition_count = 2};
+
+    aggregate_t aggregates[] = {
+        {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+        {.function = AGGREGATE_SUM, .attribute_index = 0},
+        {.function = AGGREGATE_MIN, .attribute_index = 0},
+        {.function = AGGREGATE_MAX, .attribute_index = 0},
+        {.function = AGGREGATE_SUM, .attribute_index = 2},
+        {.function = AGGREGATE_MIN, .attribute_index = 2},
+        {.function = AGGREGATE_MAX, .attribute_index = 2},
+        {.function = AGGREGATE_AVG, .attribute_index = 0}};
+    uint8_t aggregate_count = sizeof(aggregates) / sizeof(aggregates[0]);
+
+    Operator* fast = scan_aggregate_create(session_a, &criteria, aggregates, aggregate_count, NULL);
+    TEST_ASSERT_NOT_NULL(fast);
+    OP_OPEN(fast);
+    tuple_t* fast_tuple = OP_NEXT(fast);
+    TEST_ASSERT_NOT_NULL(fast_tuple);
+
+    Operator* scan = seq_scan_create(session_a, NULL);
+    Operator* filter = filter_create(scan, session_a, &criteria, NULL);
+    Operator* slow = hash_aggregate_create(filter, session_a, NULL, 0, aggregates, aggregate_count, 0, NULL);
+    OP_OPEN(slow);
+    tuple_t* slow_tuple = OP_NEXT(slow);
+    TEST_ASSERT_NOT_NULL(slow_tuple);
+
+    // Active rows are i = 0, 2, ..., 300 and id = i - 150 > -100 keeps i = 52..300
+    TEST_ASSERT_EQUAL_INT(125, fast_tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_INT(-98, fast_tuple->attributes[2].int_value);
+    TEST_ASSERT_EQUAL_INT(150, fast_tuple->attributes[3].int_value);
+    for (uint8_t i = 0; i < aggregate_count; i++) {
+        TEST_ASSERT_EQUAL_INT(slow_tuple->attributes[i].type, fast_tuple->attributes[i].type);
+        if (fast_tuple->attributes[i].type == ATTRIBUTE_TYPE_INT) {
+            TEST_ASSERT_EQUAL_INT(slow_tuple->attributes[i].int_value, fast_tuple->attributes[i].int_value);
+        } else {
+            TEST_ASSERT_EQUAL_FLOAT(slow_tuple->attributes[i].float_value, fast_tuple->attributes[i].float_value);
+        }
+    }
+
+    // Single row, then rerun after reset
+    TEST_ASSERT_NULL(OP_NEXT(fast));
+    OP_RESET(fast);
+    fast_tuple = OP_NEXT(fast);
+    TEST_ASSERT_NOT_NULL(fast_tuple);
+    TEST_ASSERT_EQUAL_INT(125, fast_tuple->attributes[0].int_value);
+
+    OP_CLOSE(fast);
+    operator_free(fast);
+    OP_CLOSE(slow);
+    operator_free(slow);
+}
+
+static void test_scan_aggregate_string_predicate_and_deletes() {
+    insert_tuples(session_a, 10, 1);
+    dbms_delete_tuple(session_a, (tuple_id_t){.page_id = 1, .slot_id = 0});
+
+    proposition_t props[1] = {
+        {.attribute_index = 3,
+         .operator= OPERATOR_EQUAL,
+         .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"}}};
+    selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+    aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = 0},
+                                {.function = AGGREGATE_MIN, .attribute_index = 0}};
+
+    Operator* op = scan_aggregate_create(session_a, &criteria, aggregates, 2, NULL);
+    OP_OPEN(op);
+    tuple_t* tuple = OP_NEXT(op);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT(9, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_INT(2, tuple->attributes[1].int_value);
+    OP_CLOSE(op);
+    operator_free(op);
+
+    // A longer constant sharing the stored prefix must not match
+    props[0].value.string_value = "Engineering-and-more-text-that-is-longer-than-30";
+    op = scan_aggregate_create(session_a, &criteria, aggregates, 1, NULL);
+    OP_OPEN(op);
+    tuple = OP_NEXT(op);
+    TEST_ASSERT_EQUAL_INT(0, tuple->attributes[0].int_value);
+    OP_CLOSE(op);
+    operator_free(op);
+}
+
+static void test_scan_aggregate_empty_table() {
+    aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                                {.function = AGGREGATE_MAX, .attribute_index = 2}};
+
+    Operator* op = scan_aggregate_create(session_a, NULL, aggregates, 2, NULL);
+    OP_OPEN(op);
+    tuple_t* tuple = OP_NEXT(op);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT(0, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_INT(ATTRIBUTE_TYPE_FLOAT, tuple->attributes[1].type);
+    TEST_ASSERT_NULL(OP_NEXT(op));
+    OP_CLOSE(op);
+    operator_free(op);
+}
+
+static void test_scan_aggregate_on_pax_pages() {
+    // Recreate table B with PAX pages and fill both tables the same way
+    dbms_remove_session(test_dbms_manager, session_b);
+    system_catalog_t pax_catalog = test_system_catalog;
+    pax_catalog.layout = CATALOG_LAYOUT_PAX;
+    TEST_ASSERT_TRUE(dbms_create_table(DB_PATH_B, &pax_catalog));
+    session_b = dbms_init_dbms_session(DB_PATH_B);
+    TEST_ASSERT_NOT_NULL(session_b);
+    dbms_add_session(test_dbms_manager, session_b);
+
+    insert_tuples(session_a, 301, -150);
+    insert_tuples(session_b, 301, -150);
+    dbms_delete_tuple(session_a, (tuple_id_t){.page_id = 1, .slot_id = 5});
+    dbms_delete_tuple(session_b, (tuple_id_t){.page_id = 1, .slot_id = 5});
+
+    proposition_t props[2] = {
+        {.attribute_index = 2,
+         .operator= OPERATOR_LESS_THAN,
+         .value = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 250000.0f}},
+        {.attribute_index = 3,
+         .operator= OPERATOR_EQUAL,
+         .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"}}};
+    aggregate_t aggregates[] = {
+        {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+        {.function = AGGREGATE_SUM, .attribute_index = 0},
+        {.function = AGGREGATE_MIN, .attribute_index = 2},
+        {.function = AGGREGATE_MAX, .attribute_index = 0}};
+    uint8_t aggregate_count = sizeof(aggregates) / sizeof(aggregates[0]);
+
+    // Salary below 250000 keeps i = 0..199 except the deleted one, without predicates full pages are
+    // reduced straight from the minipage
+    for (size_t proposition_count = 0; proposition_count <= 2; proposition_count += 2) {
+        selection_criteria_t criteria = {.propositions = props, .proposition_count = proposition_count};
+        Operator* nsm = scan_aggregate_create(session_a, &criteria, aggregates, aggregate_count, NULL);
+        Operator* pax = scan_aggregate_create(session_b, &criteria, aggregates, aggregate_count, NULL);
+        OP_OPEN(nsm);
+        OP_OPEN(pax);
+        tuple_t* nsm_tuple = OP_NEXT(nsm);
+        tuple_t* pax_tuple = OP_NEXT(pax);
+        TEST_ASSERT_NOT_NULL(nsm_tuple);
+        TEST_ASSERT_NOT_NULL(pax_tuple);
+        TEST_ASSERT_EQUAL_INT(proposition_count ? 199 : 300, pax_tuple->attributes[0].int_value);
+        TEST_ASSERT_EQUAL_INT(nsm_tuple->attributes[0].int_value, pax_tuple->attributes[0].int_value);
+        TEST_ASSERT_EQUAL_INT(nsm_tuple->attributes[1].int_value, pax_tuple->attributes[1].int_value);
+        TEST_ASSERT_EQUAL_FLOAT(nsm_tuple->attributes[2].float_value, pax_tuple->attributes[2].float_value);
+        TEST_ASSERT_EQUAL_INT(nsm_tuple->attributes[3].int_value, pax_tuple->attributes[3].int_value);
+        OP_CLOSE(nsm);
+        operator_free(nsm);
+        OP_CLOSE(pax);
+        operator_free(pax);
+    }
+
+    // Decoded scans see the same tuples
+    selection_criteria_t criteria = {.propositions = props, .proposition_count = 2};
+    Operator* scan = seq_scan_create(session_b, NULL);
+    Operator* filter = filter_create(scan, session_b, &criteria, NULL);
+    OP_OPEN(filter);
+    int rows = 0;
+    while (OP_NEXT(filter)) {
+        rows++;
+    }
+    TEST_ASSERT_EQUAL_INT(199, rows);
+    OP_CLOSE(filter);
+    operator_free(filter);
+}
+
 int main() {
     UNITY_BEGIN();
 
@@ -432,12 +848,26 @@ int main() {
     RUN_TEST(test_cross_product_basic);
     RUN_TEST(test_cross_product_empty_inner);
     RUN_TEST(test_cross_product_empty_outer);
+    RUN_TEST(test_equi_join_prunes_with_bloom_filter);
 
     // DISTINCT tests
     RUN_TEST(test_distinct_eliminates_duplicates);
     RUN_TEST(test_distinct_on_single_column);
     RUN_TEST(test_distinct_with_filter);
     RUN_TEST(test_project_reset_clears_distinct_set);
+    RUN_TEST(test_operator_tree_in_arena);
+
+    // HashAggregate tests
+    RUN_TEST(test_hash_aggregate_group_by);
+    RUN_TEST(test_hash_aggregate_with_filter_and_string_key);
+    RUN_TEST(test_hash_aggregate_spills_when_over_budget);
+    RUN_TEST(test_hash_aggregate_empty_input);
+
+    // ScanAggregate tests
+    RUN_TEST(test_scan_aggregate_matches_hash_aggregate);
+    RUN_TEST(test_scan_aggregate_string_predicate_and_deletes);
+    RUN_TEST(test_scan_aggregate_empty_table);
+    RUN_TEST(test_scan_aggregate_on_pax_pages);
 
     return UNITY_END();
 }
@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "btree.h"
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/index_scan.h"
+#include "query.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+
+#define DB_PATH "test_btree.dat"
+#define ID_INDEX_PATH DB_PATH ".id" BTREE_FILE_EXTENSION
+#define NAME_INDEX_PATH DB_PATH ".name" BTREE_FILE_EXTENSION
+
+catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+static void open_session() {
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+void setUp() {
+  // Create a system catalog for testing
+  catalog_record_t test_catalog_records_temp[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},         {"name", 50, ATTRIBUTE_TYPE_STRING, 1},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_active", 1, ATTRIBUTE_TYPE_BOOL, 4}, {PADDING_NAME, 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+
+  memcpy(test_catalog_records, test_catalog_records_temp, sizeof(test_catalog_records_temp));
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (size_t i = 0; i < sizeof(test_catalog_records_temp) / sizeof(catalog_record_t); i++) {
+    tuple_size += test_catalog_records[i].attribute_size;
+  }
+
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.tuple_size = tuple_size;
+  test_system_catalog.record_count = sizeof(test_catalog_records_temp) / sizeof(catalog_record_t);
+
+  remove(ID_INDEX_PATH);
+  remove(NAME_INDEX_PATH);
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+}
+
+void tearDown() {
+  dbms_free_dbms_manager(test_dbms_manager);
+  remove(DB_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(ID_INDEX_PATH);
+  remove(NAME_INDEX_PATH);
+}
+
+static void insert_tuple(int id, const char* name) {
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = id},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)name},
+                                                    {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = (float)id / 2},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+                                                    {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+}
+
+static size_t count_int_range(int low, int high) {
+  attribute_value_t low_value = {.type = ATTRIBUTE_TYPE_INT, .int_value = low};
+  attribute_value_t high_value = {.type = ATTRIBUTE_TYPE_INT, .int_value = high};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = btree_range(test_dbms_session, test_dbms_session->btrees[0], btree_normalize_key(&low_value),
+                                      btree_normalize_key(&high_value), &count);
+  free(tuple_ids);
+  return count;
+}
+
+static void assert_no_pins() {
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    TEST_ASSERT_EQUAL_UINT32(0, test_dbms_session->buffer_pool->buffer_pages[i].pin_count);
+  }
+}
+
+static void test_btree_normalized_keys_keep_order() {
+  int ints[] = {-2147483647 - 1, -1000, -1, 0, 1, 42, 2147483647};
+  for (size_t i = 1; i < sizeof(ints) / sizeof(ints[0]); i++) {
+    attribute_value_t a = {.type = ATTRIBUTE_TYPE_INT, .int_value = ints[i - 1]};
+    attribute_value_t b = {.type = ATTRIBUTE_TYPE_INT, .int_value = ints[i]};
+    TEST_ASSERT_TRUE(btree_normalize_key(&a) < btree_normalize_key(&b));
+  }
+
+  float floats[] = {-1e30f, -2.5f, -0.5f, 0.0f, 0.25f, 3.0f, 1e30f};
+  for (size_t i = 1; i < sizeof(floats) / sizeof(floats[0]); i++) {
+    attribute_value_t a = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = floats[i - 1]};
+    attribute_value_t b = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = floats[i]};
+    TEST_ASSERT_TRUE(btree_normalize_key(&a) < btree_normalize_key(&b));
+  }
+  attribute_value_t zero = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 0.0f};
+  attribute_value_t negative_zero = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = -0.0f};
+  TEST_ASSERT_EQUAL_UINT64(btree_normalize_key(&zero), btree_normalize_key(&negative_zero));
+
+  const char* strings[] = {"", "A", "AB", "ABC", "B", "Zebra"};
+  for (size_t i = 1; i < sizeof(strings) / sizeof(strings[0]); i++) {
+    attribute_value_t a = {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)strings[i - 1]};
+    attribute_value_t b = {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)strings[i]};
+    TEST_ASSERT_TRUE(btree_normalize_key(&a) < btree_normalize_key(&b));
+  }
+}
+
+static void test_btree_create_and_range() {
+  // Enough entries for several leaves under one root
+  for (int i = 0; i < 3000; i++) {
+    insert_tuple(i, "TestName");
+  }
+
+  test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0);
+  btree_t* tree = test_dbms_session->btrees[0];
+  TEST_ASSERT_NOT_NULL(tree);
+  TEST_ASSERT_EQUAL_UINT64(3000, tree->entry_count);
+  TEST_ASSERT_EQUAL_UINT32(2, tree->height);
+
+  TEST_ASSERT_EQUAL_size_t(100, count_int_range(100, 199));
+  TEST_ASSERT_EQUAL_size_t(1, count_int_range(2999, 5000));
+  TEST_ASSERT_EQUAL_size_t(3000, count_int_range(-10, 3000));
+  TEST_ASSERT_EQUAL_size_t(0, count_int_range(3000, 4000));
+
+  // Results come back in key order
+  attribute_value_t low = {.type = ATTRIBUTE_TYPE_INT, .int_value = 500};
+  attribute_value_t high = {.type = ATTRIBUTE_TYPE_INT, .int_value = 1500};
+  size_t count = 0;
+  tuple_id_t* tuple_ids =
+      btree_range(test_dbms_session, tree, btree_normalize_key(&low), btree_normalize_key(&high), &count);
+  TEST_ASSERT_EQUAL_size_t(1001, count);
+  for (size_t i = 0; i < count; i++) {
+    tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_ids[i]);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT(500 + (int)i, tuple->attributes[0].int_value);
+  }
+  free(tuple_ids);
+  assert_no_pins();
+}
+
+static void test_btree_insert_splits() {
+  test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, test_dbms_session->btrees[0]->height);
+
+  // Descending keys keep splitting the leftmost leaf, duplicates share a key
+  for (int i = 2499; i >= -2500; i--) {
+    insert_tuple(i / 2, "TestName");
+  }
+
+  btree_t* tree = test_dbms_session->btrees[0];
+  TEST_ASSERT_EQUAL_UINT64(5000, tree->entry_count);
+  TEST_ASSERT_TRUE(tree->height >= 2);
+  TEST_ASSERT_EQUAL_size_t(5000, count_int_range(-2000000, 2000000));
+  TEST_ASSERT_EQUAL_size_t(2, count_int_range(7, 7));
+  TEST_ASSERT_EQUAL_size_t(3, count_int_range(0, 0));  // -1 / 2 and 1 / 2 both round to 0
+  TEST_ASSERT_EQUAL_size_t(21, count_int_range(-5, 4));
+  assert_no_pins();
+}
+
+static void test_btree_delete_and_update() {
+  for (int i = 0; i < 1000; i++) {
+    insert_tuple(i, "TestName");
+  }
+  test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[0]);
+
+  // Delete ids 0..49 through the table
+  proposition_t delete_props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 50}}};
+  selection_criteria_t delete_criteria = {.propositions = delete_props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(50, query_delete(test_dbms_session, &delete_criteria));
+  TEST_ASSERT_EQUAL_size_t(0, count_int_range(0, 49));
+  TEST_ASSERT_EQUAL_size_t(950, count_int_range(0, 999));
+  TEST_ASSERT_EQUAL_UINT64(950, test_dbms_session->btrees[0]->entry_count);
+
+  // Move id 500 to 5000
+  proposition_t update_props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 500}}};
+  selection_criteria_t update_criteria = {.propositions = update_props, .proposition_count = 1};
+  attribute_value_t new_attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 5000},
+                                                        {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Moved"},
+                                                        {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 1.0f},
+                                                        {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"},
+                                                        {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = false}};
+  TEST_ASSERT_EQUAL_INT(1, query_update(test_dbms_session, &update_criteria, new_attrs));
+  TEST_ASSERT_EQUAL_size_t(0, count_int_range(500, 500));
+  TEST_ASSERT_EQUAL_size_t(1, count_int_range(5000, 5000));
+  TEST_ASSERT_EQUAL_UINT64(950, test_dbms_session->btrees[0]->entry_count);
+  assert_no_pins();
+}
+
+static void test_btree_persists_across_sessions() {
+  for (int i = 0; i < 2000; i++) {
+    insert_tuple(i, "TestName");
+  }
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0));
+  insert_tuple(-7, "Late");
+
+  dbms_flush_buffer_pool(test_dbms_session);
+  dbms_free_dbms_manager(test_dbms_manager);
+
+  // Reopening only reads the meta page
+  open_session();
+  btree_t* tree = test_dbms_session->btrees[0];
+  TEST_ASSERT_NOT_NULL(tree);
+  TEST_ASSERT_NULL(test_dbms_session->btrees[1]);
+  TEST_ASSERT_EQUAL_UINT64(2001, tree->entry_count);
+  TEST_ASSERT_EQUAL_size_t(11, count_int_range(-7, 9));
+  TEST_ASSERT_EQUAL_size_t(2001, count_int_range(-100, 100000));
+}
+
+static void test_btree_index_scan_range() {
+  const char* names[] = {"Alice", "Bob", "Carol", "Dave", "Eve"};
+  for (int i = 0; i < 1000; i++) {
+    insert_tuple(i, names[i % 5]);
+  }
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0));
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[1] = btree_create(test_dbms_session, 1));
+
+  // BETWEEN 100 AND 199 with a strict upper bound on a second proposition
+  proposition_t props[3] = {
+      {.attribute_index = 0, .operator= OPERATOR_GREATER_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}},
+      {.attribute_index = 0, .operator= OPERATOR_LESS_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 199}},
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 150}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 3};
+
+  Operator* scan = index_scan_create_for_criteria(test_dbms_session, &criteria, NULL);
+  TEST_ASSERT_NOT_NULL(scan);
+  IndexScanState* state = (IndexScanState*)scan->state;
+  TEST_ASSERT_EQUAL_PTR(test_dbms_session->btrees[0], state->btree);
+  TEST_ASSERT_EQUAL_size_t(3, state->bound_count);
+
+  OP_OPEN(scan);
+  int count = 0;
+  int id_sum = 0;
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(scan)) != NULL) {
+    count++;
+    id_sum += tuple->attributes[0].int_value;
+  }
+  TEST_ASSERT_EQUAL_INT(50, count);
+  TEST_ASSERT_EQUAL_INT((100 + 149) * 50 / 2, id_sum);
+  OP_CLOSE(scan);
+  operator_free(scan);
+  assert_no_pins();
+
+  // Strict string bounds on prefix keys: "Bob" < name < "Dave"
+  proposition_t name_props[2] = {
+      {.attribute_index = 1, .operator= OPERATOR_GREATER_THAN, .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Bob"}},
+      {.attribute_index = 1, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Dave"}}};
+  selection_criteria_t name_criteria = {.propositions = name_props, .proposition_count = 2};
+
+  arena_t* arena = arena_create(0);
+  scan = index_scan_create_for_criteria(test_dbms_session, &name_criteria, arena);
+  TEST_ASSERT_NOT_NULL(scan);
+  OP_OPEN(scan);
+  count = 0;
+  while ((tuple = OP_NEXT(scan)) != NULL) {
+    TEST_ASSERT_EQUAL_STRING("Carol", tuple->attributes[1].string_value);
+    count++;
+  }
+  TEST_ASSERT_EQUAL_INT(200, count);
+  OP_CLOSE(scan);
+  operator_free(scan);
+  arena_free(arena);
+
+  // Not-equal cannot use the tree
+  proposition_t other_props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_NOT_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 3}}};
+  selection_criteria_t other_criteria = {.propositions = other_props, .proposition_count = 1};
+  TEST_ASSERT_NULL(index_scan_create_for_criteria(test_dbms_session, &other_criteria, NULL));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_btree_normalized_keys_keep_order);
+  RUN_TEST(test_btree_create_and_range);
+  RUN_TEST(test_btree_insert_splits);
+  RUN_TEST(test_btree_delete_and_update);
+  RUN_TEST(test_btree_persists_across_sessions);
+  RUN_TEST(test_btree_index_scan_range);
+  return UNITY_END();
+}
@@ -0,0 +1,275 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "compression.h"
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "index.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_ROW_COUNT 2000
+
+#define DB_PATH "test_compression.dat"
+#define MAP_PATH DB_PATH COMPRESSION_MAP_FILE_EXTENSION
+#define DEPARTMENT_INDEX_PATH DB_PATH ".department" INDEX_FILE_EXTENSION
+#define RAW_PATH "test_compression_raw.dat"
+
+#include "table_fixture.h"
+
+void setUp() {}
+
+void tearDown() {
+  close_session();
+  remove(DB_PATH);
+  remove(MAP_PATH);
+  remove(DEPARTMENT_INDEX_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(RAW_PATH);
+  remove(RAW_PATH COMPRESSION_MAP_FILE_EXTENSION);
+}
+
+// Deterministic bytes that LZ4 cannot shrink
+static void fill_random(char* buffer, size_t size, uint32_t seed) {
+  for (size_t i = 0; i < size; i++) {
+    seed = seed * 1103515245u + 12345u;
+    buffer[i] = (char)(seed >> 16);
+  }
+}
+
+static void assert_round_trip(const char* input, size_t size) {
+  size_t capacity = compression_lz4_bound(size);
+  char* compressed = malloc(capacity);
+  char* output = malloc(size + 1);
+  size_t length = compression_lz4_compress(input, size, compressed, capacity);
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_TRUE(length <= capacity);
+  TEST_ASSERT_TRUE(compression_lz4_decompress(compressed, length, output, size));
+  if (size > 0) {
+    TEST_ASSERT_EQUAL_MEMORY(input, output, size);
+  }
+  free(compressed);
+  free(output);
+}
+
+static void test_compression_lz4() {
+  char* buffer = calloc(1, PAGE_SIZE);
+  assert_round_trip(buffer, PAGE_SIZE);
+  assert_round_trip(buffer, 0);
+  assert_round_trip(buffer, 13);
+
+  // Runs longer than 15 + 255 bytes need extended match lengths, random bytes extended literal lengths
+  for (size_t i = 0; i < PAGE_SIZE; i++) {
+    buffer[i] = (char)("abcabcabd"[i % 9]);
+  }
+  assert_round_trip(buffer, PAGE_SIZE);
+  fill_random(buffer, PAGE_SIZE, 42);
+  assert_round_trip(buffer, PAGE_SIZE);
+  memset(buffer + 1000, 'x', 3000);
+  assert_round_trip(buffer, PAGE_SIZE);
+
+  // An empty page shrinks to a few dozen bytes
+  memset(buffer, 0, PAGE_SIZE);
+  char compressed[PAGE_SIZE];
+  size_t length = compression_lz4_compress(buffer, PAGE_SIZE, compressed, sizeof(compressed));
+  TEST_ASSERT_TRUE(length > 0 && length < 64);
+
+  // Too small an output buffer, corrupt or truncated input
+  fill_random(buffer, PAGE_SIZE, 7);
+  TEST_ASSERT_EQUAL_size_t(0, compression_lz4_compress(buffer, PAGE_SIZE, compressed, PAGE_SIZE / 2));
+  memset(buffer, 0, PAGE_SIZE);
+  length = compression_lz4_compress(buffer, PAGE_SIZE, compressed, sizeof(compressed));
+  char output[PAGE_SIZE];
+  TEST_ASSERT_FALSE(compression_lz4_decompress(compressed, length - 1, output, PAGE_SIZE));
+  TEST_ASSERT_FALSE(compression_lz4_decompress(compressed, length, output, PAGE_SIZE - 1));
+  compressed[2] = (char)0xFF;
+  compressed[3] = (char)0xFF;
+  TEST_ASSERT_FALSE(compression_lz4_decompress(compressed, length, output, PAGE_SIZE));
+  free(buffer);
+}
+
+static void test_compression_catalog() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_LZ4, false);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_COMPRESSION_LZ4, test_dbms_session->catalog->compression);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->compression_map);
+  TEST_ASSERT_EQUAL_UINT32(1, test_dbms_session->page_count);
+  // The empty first page takes one small extent after the catalog page
+  uint64_t stored_size = compression_map_stored_size(test_dbms_session->compression_map);
+  TEST_ASSERT_TRUE(stored_size > 0 && stored_size <= PAGE_SIZE / 4);
+  TEST_ASSERT_EQUAL_UINT64(0, stored_size % COMPRESSION_EXTENT_UNIT);
+  TEST_ASSERT_EQUAL_INT64(PAGE_SIZE + stored_size, ssdio_get_file_size(test_dbms_session->fd));
+  close_session();
+
+  // Uncompressed tables keep their format and remove a stale map
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_NONE, false);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_COMPRESSION_NONE, test_dbms_session->catalog->compression);
+  TEST_ASSERT_NULL(test_dbms_session->compression_map);
+  TEST_ASSERT_EQUAL_INT64(2 * PAGE_SIZE, ssdio_get_file_size(test_dbms_session->fd));
+  TEST_ASSERT_NULL(fopen(MAP_PATH, "r"));
+}
+
+static void test_compression_round_trip() {
+  uint8_t layouts[] = {CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX};
+  for (size_t i = 0; i < sizeof(layouts); i++) {
+    create_employee_table(layouts[i], CATALOG_COMPRESSION_LZ4, false);
+    insert_employees(TEST_ROW_COUNT, 0);
+    uint32_t page_count = test_dbms_session->page_count;
+    TEST_ASSERT_TRUE(page_count > BUFFER_POOL_SIZE);
+
+    // Updates and deletes rewrite pages that were already evicted once
+    tuple_id_t updated_id = {.page_id = 1, .slot_id = 3};
+    attribute_value_t attrs[EMPLOYEE_ATTRIBUTE_COUNT] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = -3},
+                                                         {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Updated"},
+                                                         {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 0.5f},
+                                                         {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Legal"},
+                                                         {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+    TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, updated_id, attrs));
+    TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, (tuple_id_t){.page_id = 2, .slot_id = 0}));
+    dbms_flush_buffer_pool(test_dbms_session);
+
+    // Repetitive tuples and the free slots of the last page compress well
+    uint64_t stored_size = compression_map_stored_size(test_dbms_session->compression_map);
+    TEST_ASSERT_TRUE(stored_size < (uint64_t)page_count * PAGE_SIZE / 2);
+
+    close_session();
+    open_session();
+    TEST_ASSERT_EQUAL_UINT32(page_count, test_dbms_session->page_count);
+    tuple_t* tuple = dbms_get_tuple(test_dbms_session, updated_id);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT32(-3, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_STRING("Legal", tuple->attributes[3].string_value);
+    TEST_ASSERT_NULL(dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 2, .slot_id = 0}));
+
+    uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+    tuple_id_t last_id = {.page_id = 1 + (TEST_ROW_COUNT - 1) / tuples_per_page,
+                          .slot_id = (TEST_ROW_COUNT - 1) % tuples_per_page};
+    tuple = dbms_get_tuple(test_dbms_session, last_id);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT32(TEST_ROW_COUNT - 1, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_STRING("Name1999", tuple->attributes[1].string_value);
+
+    // Inserts after reopening fill the free slot and then append
+    insert_employees(tuples_per_page, 0);
+    TEST_ASSERT_EQUAL_UINT32(page_count + 1, test_dbms_session->page_count);
+
+    close_session();
+    remove(DB_PATH);
+    remove(MAP_PATH);
+    remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  }
+}
+
+static void test_compression_extents() {
+  int fd = ssdio_open(RAW_PATH, true);
+  TEST_ASSERT_TRUE(fd >= 0);
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  page_t* read_page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  memset(page, 0, sizeof(page_t));
+  TEST_ASSERT_TRUE(compression_map_create(RAW_PATH, fd, page, PAGE_SIZE));
+
+  compression_map_t* map = compression_map_open(RAW_PATH, PAGE_SIZE);
+  TEST_ASSERT_NOT_NULL(map);
+  TEST_ASSERT_TRUE(compression_map_write_page(map, fd, 2, page));
+  TEST_ASSERT_FALSE(compression_map_write_page(map, fd, 4, page));
+  uint64_t small_offset = map->extents[0].offset;
+
+  // A page that no longer fits moves to a new extent, stored as is when it does not compress
+  fill_random((char*)page, PAGE_SIZE, 3);
+  TEST_ASSERT_TRUE(compression_map_write_page(map, fd, 1, page));
+  TEST_ASSERT_EQUAL_UINT32(PAGE_SIZE, map->extents[0].length);
+  TEST_ASSERT_EQUAL_UINT32(PAGE_SIZE, map->extents[0].capacity);
+  TEST_ASSERT_TRUE(map->extents[0].offset != small_offset);
+  TEST_ASSERT_TRUE(compression_map_read_page(map, fd, 1, read_page));
+  TEST_ASSERT_EQUAL_MEMORY(page, read_page, PAGE_SIZE);
+
+  // The old extent is only reused once the map on disk no longer points to it
+  memset(page, 0, sizeof(page_t));
+  TEST_ASSERT_TRUE(compression_map_write_page(map, fd, 3, page));
+  TEST_ASSERT_TRUE(map->extents[2].offset != small_offset);
+  TEST_ASSERT_TRUE(compression_map_sync(map));
+  page->next_page = 5;
+  TEST_ASSERT_TRUE(compression_map_write_page(map, fd, 4, page));
+  TEST_ASSERT_EQUAL_UINT64(small_offset, map->extents[3].offset);
+  TEST_ASSERT_TRUE(compression_map_sync(map));
+  compression_map_free(map);
+
+  // Reopened maps find the same pages
+  map = compression_map_open(RAW_PATH, PAGE_SIZE);
+  TEST_ASSERT_NOT_NULL(map);
+  TEST_ASSERT_EQUAL_UINT64(4, map->page_count);
+  TEST_ASSERT_TRUE(compression_map_read_page(map, fd, 4, read_page));
+  TEST_ASSERT_EQUAL_UINT64(5, read_page->next_page);
+  TEST_ASSERT_TRUE(compression_map_read_page(map, fd, 1, read_page));
+  fill_random((char*)page, PAGE_SIZE, 3);
+  TEST_ASSERT_EQUAL_MEMORY(page, read_page, PAGE_SIZE);
+  TEST_ASSERT_FALSE(compression_map_read_page(map, fd, 5, read_page));
+  compression_map_free(map);
+
+  free(page);
+  free(read_page);
+  ssdio_close(fd);
+}
+
+static void test_compression_scans() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_LZ4, false);
+  insert_employees(TEST_ROW_COUNT, 0);
+  int64_t per_department = TEST_ROW_COUNT / DEPARTMENT_COUNT;
+
+  proposition_t proposition = {.attribute_index = 3,
+                               .operator= OPERATOR_EQUAL,
+                               .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"}};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  aggregate_t aggregate = {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR};
+  Operator* op = scan_aggregate_create(test_dbms_session, &criteria, &aggregate, 1, NULL);
+  OP_OPEN(op);
+  tuple_t* result = OP_NEXT(op);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_INT64(per_department, result->attributes[0].int_value);
+  OP_CLOSE(op);
+  operator_free(op);
+
+  int64_t filtered = 0;
+  Operator* filter = filter_create(seq_scan_create(test_dbms_session, NULL), test_dbms_session, &criteria, NULL);
+  OP_OPEN(filter);
+  while (OP_NEXT(filter)) {
+    filtered++;
+  }
+  OP_CLOSE(filter);
+  operator_free(filter);
+  TEST_ASSERT_EQUAL_INT64(per_department, filtered);
+
+  // The bulk index build reads the pages directly, with dirty frames written back first
+  test_dbms_session->indexes[3] = index_create(test_dbms_session, 3);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[3]);
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Finance"};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[3], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(per_department, count);
+  free(tuple_ids);
+}
+
+static void test_compression_map_required() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_LZ4, false);
+  insert_employees(10, 0);
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+
+  // Page offsets are only in the map
+  remove(MAP_PATH);
+  TEST_ASSERT_NULL(dbms_init_dbms_session(DB_PATH));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_compression_lz4);
+  RUN_TEST(test_compression_catalog);
+  RUN_TEST(test_compression_round_trip);
+  RUN_TEST(test_compression_extents);
+  RUN_TEST(test_compression_scans);
+  RUN_TEST(test_compression_map_required);
+  return UNITY_END();
+}
@@ -1,3 +1,7 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "arena.h"
 #include "data_structures.h"
 #include "unity.h"
 
@@ -12,7 +16,14 @@ void tearDown(void) {
 
 static void test_hash_table_init(void) {
   TEST_ASSERT_NOT_NULL(test_table);
-  TEST_ASSERT_EQUAL_UINT64(8, test_table->bucket_count);  // Next power of two
+  TEST_ASSERT_EQUAL_UINT64(HASH_TABLE_MIN_CAPACITY, test_table->capacity);
+  TEST_ASSERT_EQUAL_UINT64(0, test_table->count);
+
+  // Sized to stay under the maximum load
+  hash_table_t* large_table = hash_table_init(100);
+  TEST_ASSERT_NOT_NULL(large_table);
+  TEST_ASSERT_EQUAL_UINT64(128, large_table->capacity);
+  hash_table_free(large_table);
 }
 
 static void test_hash_table_insert_and_get(void) {
@@ -99,6 +110,116 @@ static void test_hash_table_large_number_of_elements(void) {
   }
 }
 
+static void test_hash_table_grow_and_backward_shift_delete(void) {
+  TEST_ASSERT_NOT_NULL(test_table);
+
+  const uint64_t num_elements = 1000;
+  for (uint64_t i = 0; i < num_elements; i++) {
+    TEST_ASSERT_TRUE(hash_table_insert(test_table, i << 48 | i, i));
+  }
+  TEST_ASSERT_EQUAL_UINT64(num_elements, test_table->count);
+  TEST_ASSERT_EQUAL_UINT64(2048, test_table->capacity);
+
+  // Replacing a value does not add an entry
+  TEST_ASSERT_TRUE(hash_table_insert(test_table, 7ULL << 48 | 7, 70));
+  TEST_ASSERT_EQUAL_UINT64(num_elements, test_table->count);
+
+  // Delete every third key, the entries shifted back into the holes must stay reachable
+  for (uint64_t i = 0; i < num_elements; i += 3) {
+    TEST_ASSERT_TRUE(hash_table_delete(test_table, i << 48 | i));
+  }
+  TEST_ASSERT_FALSE(hash_table_delete(test_table, 0));
+
+  uint64_t value;
+  for (uint64_t i = 0; i < num_elements; i++) {
+    bool found = hash_table_get(test_table, i << 48 | i, &value);
+    if (i % 3 == 0) {
+      TEST_ASSERT_FALSE(found);
+    } else {
+      TEST_ASSERT_TRUE(found);
+      TEST_ASSERT_EQUAL_UINT64(i == 7 ? 70 : i, value);
+    }
+  }
+
+  // Churn at a steady size must not grow the table, there are no tombstones to fill it
+  for (uint64_t round = 0; round < 10; round++) {
+    for (uint64_t i = 0; i < num_elements; i += 3) {
+      TEST_ASSERT_TRUE(hash_table_insert(test_table, i << 48 | i, round));
+    }
+    for (uint64_t i = 0; i < num_elements; i += 3) {
+      TEST_ASSERT_TRUE(hash_table_delete(test_table, i << 48 | i));
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT64(2048, test_table->capacity);
+  TEST_ASSERT_EQUAL_UINT64(num_elements - (num_elements + 2) / 3, test_table->count);
+}
+
+static void test_arena_alloc_alignment_and_strings(void) {
+  arena_t* arena = arena_create(0);
+  TEST_ASSERT_NOT_NULL(arena);
+
+  char* a = arena_alloc(arena, 3);
+  char* b = arena_alloc(arena, 1);
+  TEST_ASSERT_NOT_NULL(a);
+  TEST_ASSERT_NOT_NULL(b);
+  TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)a % ARENA_ALIGNMENT);
+  TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)b % ARENA_ALIGNMENT);
+  TEST_ASSERT_TRUE(b - a >= 3);
+
+  uint64_t* zeros = arena_calloc(arena, 16, sizeof(uint64_t));
+  TEST_ASSERT_NOT_NULL(zeros);
+  for (int i = 0; i < 16; i++) {
+    TEST_ASSERT_EQUAL_UINT64(0, zeros[i]);
+  }
+
+  TEST_ASSERT_EQUAL_STRING("hello", arena_strdup(arena, "hello"));
+  TEST_ASSERT_EQUAL_STRING("wor", arena_strndup(arena, "world", 3));
+  TEST_ASSERT_NULL(arena_strdup(arena, NULL));
+
+  arena_free(arena);
+}
+
+static void test_arena_grows_in_chunks(void) {
+  arena_t* arena = arena_create(64);
+  TEST_ASSERT_NOT_NULL(arena);
+
+  // Many small allocations spill into new chunks, older data stays intact
+  char* first = arena_strdup(arena, "first");
+  for (int i = 0; i < 1000; i++) {
+    int* value = arena_alloc(arena, sizeof(int));
+    TEST_ASSERT_NOT_NULL(value);
+    *value = i;
+  }
+  TEST_ASSERT_NOT_NULL(arena->head->next);
+  TEST_ASSERT_EQUAL_STRING("first", first);
+
+  // An allocation larger than the next chunk gets a chunk of its own
+  char* big = arena_alloc(arena, ARENA_MAX_CHUNK_SIZE + 1);
+  TEST_ASSERT_NOT_NULL(big);
+  memset(big, 'x', ARENA_MAX_CHUNK_SIZE + 1);
+  TEST_ASSERT_TRUE(arena->head->size >= ARENA_MAX_CHUNK_SIZE + 1);
+
+  arena_free(arena);
+}
+
+static void test_arena_reset_reuses_first_chunk(void) {
+  arena_t* arena = arena_create(128);
+  TEST_ASSERT_NOT_NULL(arena);
+
+  void* start = arena_alloc(arena, 16);
+  for (int i = 0; i < 100; i++) {
+    TEST_ASSERT_NOT_NULL(arena_alloc(arena, 64));
+  }
+  TEST_ASSERT_TRUE(arena->bytes_allocated > 128);
+
+  arena_reset(arena);
+  TEST_ASSERT_EQUAL_size_t(0, arena->bytes_allocated);
+  TEST_ASSERT_NULL(arena->head->next);
+  TEST_ASSERT_EQUAL_PTR(start, arena_alloc(arena, 16));
+
+  arena_free(arena);
+}
+
 int main() {
   UNITY_BEGIN();
 
@@ -106,6 +227,11 @@ int main() {
   RUN_TEST(test_hash_table_insert_and_get);
   RUN_TEST(test_hash_table_delete);
   RUN_TEST(test_hash_table_large_number_of_elements);
+  RUN_TEST(test_hash_table_grow_and_backward_shift_delete);
+
+  RUN_TEST(test_arena_alloc_alignment_and_strings);
+  RUN_TEST(test_arena_grows_in_chunks);
+  RUN_TEST(test_arena_reset_reuses_first_chunk);
 
   return UNITY_END();
 }
\ No newline at end of file
@@ -1,13 +1,19 @@
 #include <string.h>
 
+#include "compression.h"
 #include "dbms.h"
+#include "slotted.h"
 #include "ssdio.h"
 #include "unity.h"
+#include "zone_map.h"
 
 #define TEST_CATALOG_SIZE 6
 #define TEST_TUPLE_SIZE 96
 
 #define DB_PATH "test_dbms.dat"
+#define DB_PAX_PATH "test_dbms_pax.dat"
+#define DB_BITMAP_PATH "test_dbms_bitmap.dat"
+#define DB_PAGE_SIZE_PATH "test_dbms_page_size.dat"
 
 catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
 system_catalog_t test_system_catalog = {0};
@@ -39,6 +45,15 @@ void setUp() {
 void tearDown() {
   dbms_free_dbms_manager(test_dbms_manager);
   remove(DB_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PAX_PATH);
+  remove(DB_PAX_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_BITMAP_PATH);
+  remove(DB_BITMAP_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PAGE_SIZE_PATH);
+  remove(DB_PAGE_SIZE_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PAGE_SIZE_PATH OVERFLOW_FILE_EXTENSION);
+  remove(DB_PAGE_SIZE_PATH COMPRESSION_MAP_FILE_EXTENSION);
 }
 
 static void test_page_size() {
@@ -247,6 +262,284 @@ static void test_cflru_eviction() {
   TEST_ASSERT_TRUE(hash_table_get(test_dbms_session->buffer_pool->page_table, 5, &index_out));
 }
 
+static void test_pax_layout() {
+  system_catalog_t pax_catalog = test_system_catalog;
+  pax_catalog.layout = CATALOG_LAYOUT_PAX;
+  TEST_ASSERT_TRUE(dbms_create_table(DB_PAX_PATH, &pax_catalog));
+  dbms_session_t* session = dbms_init_dbms_session(DB_PAX_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_LAYOUT_PAX, session->catalog->layout);
+
+  // No null byte or padding per tuple
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  TEST_ASSERT_TRUE(tuples_per_page > dbms_catalog_tuples_per_page(&test_system_catalog));
+
+  // Minipages are contiguous and fit in the page
+  TEST_ASSERT_EQUAL_UINT64(4, dbms_get_column_stride(session->catalog, 0));
+  TEST_ASSERT_EQUAL_UINT64(50, dbms_get_column_stride(session->catalog, 1));
+  off_t last_offset = dbms_get_column_offset(session->catalog, 4);
+  TEST_ASSERT_TRUE(dbms_get_column_offset(session->catalog, 1) >= dbms_get_column_offset(session->catalog, 0) +
+                                                                       (off_t)(tuples_per_page * 4));
+  TEST_ASSERT_TRUE(last_offset + (off_t)tuples_per_page <= DATA_SIZE);
+
+  attribute_value_t insert_attributes[TEST_CATALOG_SIZE - 1] = {
+      {.type = ATTRIBUTE_TYPE_INT, .int_value = 0},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "John Doe"},
+      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 55000.0f},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  for (uint64_t i = 0; i < tuples_per_page + 1; i++) {
+    insert_attributes[0].int_value = (int32_t)i;
+    tuple_t* tuple = dbms_insert_tuple(session, insert_attributes);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_UINT64(i < tuples_per_page ? 1 : 2, tuple->id.page_id);
+    TEST_ASSERT_EQUAL_UINT64(i % tuples_per_page, tuple->id.slot_id);
+  }
+
+  // Deleting frees the lowest slot first for the next insert
+  TEST_ASSERT_TRUE(dbms_delete_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 9}));
+  TEST_ASSERT_TRUE(dbms_delete_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 3}));
+  TEST_ASSERT_NULL(dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 3}));
+  buffer_page_t* buffer_page = dbms_get_buffer_page(session, 1);
+  TEST_ASSERT_EQUAL_UINT64(3, buffer_page->page->free_space_head);
+
+  insert_attributes[0].int_value = -3;
+  insert_attributes[1].string_value = "Jane";
+  tuple_t* tuple = dbms_insert_tuple(session, insert_attributes);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_UINT64(1, tuple->id.page_id);
+  TEST_ASSERT_EQUAL_UINT64(3, tuple->id.slot_id);
+  TEST_ASSERT_EQUAL_UINT64(9, buffer_page->page->free_space_head);
+
+  // The layout and values survive reopening
+  dbms_flush_buffer_pool(session);
+  dbms_free_dbms_session(session);
+  session = dbms_init_dbms_session(DB_PAX_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_LAYOUT_PAX, session->catalog->layout);
+  tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 3});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT(-3, tuple->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_STRING("Jane", tuple->attributes[1].string_value);
+  TEST_ASSERT_EQUAL_FLOAT(55000.0f, tuple->attributes[2].float_value);
+  TEST_ASSERT_EQUAL_STRING("Engineering", tuple->attributes[3].string_value);
+  TEST_ASSERT_TRUE(tuple->attributes[4].bool_value);
+  TEST_ASSERT_NULL(dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 9}));
+  tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 2, .slot_id = 0});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT((int32_t)tuples_per_page, tuple->attributes[0].int_value);
+  dbms_free_dbms_session(session);
+}
+
+static void test_bitmap_layout() {
+  system_catalog_t bitmap_catalog = test_system_catalog;
+  bitmap_catalog.layout = CATALOG_LAYOUT_BITMAP;
+  TEST_ASSERT_TRUE(dbms_create_table(DB_BITMAP_PATH, &bitmap_catalog));
+  dbms_session_t* session = dbms_init_dbms_session(DB_BITMAP_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_LAYOUT_BITMAP, session->catalog->layout);
+  TEST_ASSERT_TRUE(dbms_has_occupancy_bitmap(session->catalog));
+
+  // Tuples follow the bitmap words without their null byte
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(session->catalog);
+  TEST_ASSERT_TRUE(tuples_per_page >= dbms_catalog_tuples_per_page(&test_system_catalog));
+  size_t bitmap_size = (tuples_per_page + DBMS_BITMAP_WORD_BITS - 1) / DBMS_BITMAP_WORD_BITS * sizeof(uint64_t);
+  TEST_ASSERT_EQUAL_UINT64(TEST_TUPLE_SIZE - NULL_BYTE_SIZE, dbms_get_column_stride(session->catalog, 1));
+  TEST_ASSERT_EQUAL_INT64(bitmap_size, dbms_get_column_offset(session->catalog, 0));
+  TEST_ASSERT_EQUAL_INT64(bitmap_size + 4, dbms_get_column_offset(session->catalog, 1));
+  TEST_ASSERT_TRUE(bitmap_size + tuples_per_page * (TEST_TUPLE_SIZE - NULL_BYTE_SIZE) <= DATA_SIZE);
+
+  attribute_value_t insert_attributes[TEST_CATALOG_SIZE - 1] = {
+      {.type = ATTRIBUTE_TYPE_INT, .int_value = 0},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "John Doe"},
+      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 55000.0f},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  for (uint64_t i = 0; i < tuples_per_page + 1; i++) {
+    insert_attributes[0].int_value = (int32_t)i;
+    tuple_t* tuple = dbms_insert_tuple(session, insert_attributes);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_UINT64(i < tuples_per_page ? 1 : 2, tuple->id.page_id);
+    TEST_ASSERT_EQUAL_UINT64(i % tuples_per_page, tuple->id.slot_id);
+  }
+
+  // A full page has no free slot, deleting frees the lowest slot first for the next insert
+  buffer_page_t* buffer_page = dbms_get_buffer_page(session, 1);
+  TEST_ASSERT_EQUAL_UINT64(PAGE_SIZE, buffer_page->page->free_space_head);
+  TEST_ASSERT_TRUE(dbms_delete_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 70}));
+  TEST_ASSERT_TRUE(dbms_delete_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 3}));
+  TEST_ASSERT_FALSE(dbms_is_slot_live(session->catalog, buffer_page->page, 3));
+  TEST_ASSERT_EQUAL_UINT64(3, buffer_page->page->free_space_head);
+  TEST_ASSERT_EQUAL_UINT64(4, dbms_next_live_slot(session->catalog, buffer_page->page, 3));
+  TEST_ASSERT_EQUAL_UINT64(71, dbms_next_live_slot(session->catalog, buffer_page->page, 70));
+
+  insert_attributes[0].int_value = -3;
+  insert_attributes[1].string_value = "Jane";
+  tuple_t* tuple = dbms_insert_tuple(session, insert_attributes);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_UINT64(3, tuple->id.slot_id);
+  TEST_ASSERT_EQUAL_UINT64(70, buffer_page->page->free_space_head);
+
+  // Only the first slot of page 2 is live, the rest of its words are skipped
+  buffer_page_t* second_page = dbms_get_buffer_page(session, 2);
+  TEST_ASSERT_EQUAL_UINT64(0, dbms_next_live_slot(session->catalog, second_page->page, 0));
+  TEST_ASSERT_EQUAL_UINT64(tuples_per_page, dbms_next_live_slot(session->catalog, second_page->page, 1));
+
+  // The layout and values survive reopening
+  dbms_flush_buffer_pool(session);
+  dbms_free_dbms_session(session);
+  session = dbms_init_dbms_session(DB_BITMAP_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_LAYOUT_BITMAP, session->catalog->layout);
+  tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 3});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT(-3, tuple->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_STRING("Jane", tuple->attributes[1].string_value);
+  TEST_ASSERT_EQUAL_FLOAT(55000.0f, tuple->attributes[2].float_value);
+  TEST_ASSERT_EQUAL_STRING("Engineering", tuple->attributes[3].string_value);
+  TEST_ASSERT_TRUE(tuple->attributes[4].bool_value);
+  TEST_ASSERT_NULL(dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 70}));
+  tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = 71});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT(71, tuple->attributes[0].int_value);
+  dbms_free_dbms_session(session);
+}
+
+static void test_bitmap_layout_packs_small_tuples() {
+  // A single INT needs no padding, the NSM free list pointer forces 16-byte tuples
+  catalog_record_t records[] = {{"id", 4, ATTRIBUTE_TYPE_INT, 0}};
+  system_catalog_t catalog = {.records = records,
+                              .record_count = 1,
+                              .tuple_size = NULL_BYTE_SIZE + 4,
+                              .layout = CATALOG_LAYOUT_BITMAP};
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(&catalog);
+  TEST_ASSERT_EQUAL_UINT64(4, dbms_get_column_stride(&catalog, 0));
+  TEST_ASSERT_TRUE(tuples_per_page >= 3 * (DATA_SIZE / 16));
+  TEST_ASSERT_TRUE(dbms_get_column_offset(&catalog, 0) + tuples_per_page * 4 <= DATA_SIZE);
+
+  TEST_ASSERT_TRUE(dbms_create_table(DB_BITMAP_PATH, &catalog));
+  dbms_session_t* session = dbms_init_dbms_session(DB_BITMAP_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  for (uint64_t i = 0; i < tuples_per_page; i++) {
+    attribute_value_t value = {.type = ATTRIBUTE_TYPE_INT, .int_value = (int32_t)i};
+    tuple_t* tuple = dbms_insert_tuple(session, &value);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_UINT64(1, tuple->id.page_id);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, session->page_count);
+  dbms_flush_buffer_pool(session);
+  dbms_free_dbms_session(session);
+
+  session = dbms_init_dbms_session(DB_BITMAP_PATH);
+  TEST_ASSERT_NOT_NULL(session);
+  tuple_t* tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 1, .slot_id = tuples_per_page - 1});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT((int32_t)tuples_per_page - 1, tuple->attributes[0].int_value);
+  dbms_free_dbms_session(session);
+}
+
+static void test_table_page_sizes() {
+  // Only powers of two from 4 KB to 64 KB are accepted
+  system_catalog_t catalog = test_system_catalog;
+  catalog.page_size = 12288;
+  TEST_ASSERT_FALSE(dbms_create_table(DB_PAGE_SIZE_PATH, &catalog));
+  catalog.page_size = MAX_PAGE_SIZE * 2;
+  TEST_ASSERT_FALSE(dbms_create_table(DB_PAGE_SIZE_PATH, &catalog));
+
+  const uint32_t page_sizes[] = {MIN_PAGE_SIZE, 16384, MAX_PAGE_SIZE};
+  const uint8_t layouts[] = {CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX, CATALOG_LAYOUT_SLOTTED, CATALOG_LAYOUT_BITMAP};
+  attribute_value_t insert_attributes[TEST_CATALOG_SIZE - 1] = {
+      {.type = ATTRIBUTE_TYPE_INT, .int_value = 0},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "John Doe"},
+      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 55000.0f},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  for (size_t i = 0; i < sizeof(page_sizes) / sizeof(page_sizes[0]); i++) {
+    for (size_t j = 0; j < sizeof(layouts) / sizeof(layouts[0]); j++) {
+      catalog = test_system_catalog;
+      catalog.page_size = page_sizes[i];
+      catalog.layout = layouts[j];
+      catalog.compression = j % 2 == 1 ? CATALOG_COMPRESSION_LZ4 : CATALOG_COMPRESSION_NONE;
+
+      // Slots scale with the page, less the fixed header
+      system_catalog_t default_catalog = catalog;
+      default_catalog.page_size = 0;
+      uint64_t tuples_per_page = dbms_catalog_tuples_per_page(&catalog);
+      uint64_t default_tuples_per_page = dbms_catalog_tuples_per_page(&default_catalog);
+      TEST_ASSERT_TRUE(tuples_per_page * PAGE_SIZE / page_sizes[i] + 2 >= default_tuples_per_page);
+      TEST_ASSERT_TRUE(tuples_per_page * PAGE_SIZE / page_sizes[i] <= default_tuples_per_page + 2);
+
+      TEST_ASSERT_TRUE(dbms_create_table(DB_PAGE_SIZE_PATH, &catalog));
+      dbms_session_t* session = dbms_init_dbms_session(DB_PAGE_SIZE_PATH);
+      TEST_ASSERT_NOT_NULL(session);
+      TEST_ASSERT_EQUAL_UINT32(page_sizes[i], dbms_page_size(session->catalog));
+      // Slotted pages fit as many records as their length allows, the others exactly tuples_per_page
+      tuple_id_t last_id = {0};
+      for (uint64_t k = 0; k < 2 * tuples_per_page + 1; k++) {
+        insert_attributes[0].int_value = (int32_t)k;
+        tuple_t* tuple = dbms_insert_tuple(session, insert_attributes);
+        TEST_ASSERT_NOT_NULL(tuple);
+        if (catalog.layout != CATALOG_LAYOUT_SLOTTED) {
+          TEST_ASSERT_EQUAL_UINT64(k / tuples_per_page + 1, tuple->id.page_id);
+        }
+        last_id = tuple->id;
+      }
+      uint32_t page_count = session->page_count;
+      TEST_ASSERT_EQUAL_UINT32(catalog.layout == CATALOG_LAYOUT_SLOTTED ? last_id.page_id : 3, page_count);
+      dbms_flush_buffer_pool(session);
+      dbms_free_dbms_session(session);
+
+      // The catalog page keeps PAGE_SIZE, the table pages follow it at their own size
+      if (catalog.compression == CATALOG_COMPRESSION_NONE) {
+        int fd = ssdio_open(DB_PAGE_SIZE_PATH, false);
+        TEST_ASSERT_TRUE(fd >= 0);
+        TEST_ASSERT_EQUAL_INT64(PAGE_SIZE + page_count * (off_t)page_sizes[i], ssdio_get_file_size(fd));
+        ssdio_close(fd);
+      }
+
+      session = dbms_init_dbms_session(DB_PAGE_SIZE_PATH);
+      TEST_ASSERT_NOT_NULL(session);
+      TEST_ASSERT_EQUAL_UINT32(page_sizes[i], dbms_page_size(session->catalog));
+      TEST_ASSERT_EQUAL_UINT32(page_count, session->page_count);
+      tuple_t* tuple = dbms_get_tuple(session, last_id);
+      TEST_ASSERT_NOT_NULL(tuple);
+      TEST_ASSERT_EQUAL_INT((int32_t)(2 * tuples_per_page), tuple->attributes[0].int_value);
+      TEST_ASSERT_EQUAL_STRING("Engineering", tuple->attributes[3].string_value);
+      if (catalog.layout != CATALOG_LAYOUT_SLOTTED) {
+        tuple = dbms_get_tuple(session, (tuple_id_t){.page_id = 2, .slot_id = tuples_per_page - 1});
+        TEST_ASSERT_NOT_NULL(tuple);
+        TEST_ASSERT_EQUAL_INT((int32_t)(2 * tuples_per_page - 1), tuple->attributes[0].int_value);
+      }
+      dbms_free_dbms_session(session);
+      remove(DB_PAGE_SIZE_PATH);
+      remove(DB_PAGE_SIZE_PATH ZONE_MAP_FILE_EXTENSION);
+      remove(DB_PAGE_SIZE_PATH OVERFLOW_FILE_EXTENSION);
+      remove(DB_PAGE_SIZE_PATH COMPRESSION_MAP_FILE_EXTENSION);
+    }
+  }
+}
+
+void test_frame_allocation(void) {
+  // Small pools stay on the heap, large ones get huge pages if the platform has any way to provide them
+  size_t sizes[] = {BUFFER_POOL_SIZE * PAGE_SIZE, SSDIO_HUGE_PAGE_SIZE + 3 * PAGE_SIZE};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    for (int use_huge_pages = 0; use_huge_pages < 2; use_huge_pages++) {
+      uint8_t backing = 0xFF;
+      char* frames = ssdio_alloc_frames(sizes[i], use_huge_pages, &backing);
+      TEST_ASSERT_NOT_NULL(frames);
+      TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)frames % PAGE_SIZE);
+      if (!use_huge_pages || sizes[i] < SSDIO_HUGE_PAGE_SIZE) {
+        TEST_ASSERT_EQUAL_UINT8(SSDIO_FRAMES_HEAP, backing);
+      } else if (backing != SSDIO_FRAMES_HEAP) {
+        TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)frames % SSDIO_HUGE_PAGE_SIZE);
+      }
+      TEST_ASSERT_EACH_EQUAL_CHAR(0, frames, sizes[i]);
+      memset(frames, 0xAB, sizes[i]);
+      ssdio_free_frames(frames, sizes[i], backing);
+    }
+  }
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(test_page_size);
@@ -257,6 +550,11 @@ int main() {
   RUN_TEST(test_dbms_insert_tuple);
   RUN_TEST(test_dbms_fill_and_empty_page);
   RUN_TEST(test_cflru_eviction);
+  RUN_TEST(test_pax_layout);
+  RUN_TEST(test_bitmap_layout);
+  RUN_TEST(test_bitmap_layout_packs_small_tuples);
+  RUN_TEST(test_table_page_sizes);
+  RUN_TEST(test_frame_allocation);
 
   return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbms.h"
+#include "dictionary.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/hash_aggregate.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "index.h"
+#include "query.h"
+#include "slotted.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_ROW_COUNT 500
+
+#define DB_PATH "test_dictionary.dat"
+#define DICTIONARY_PATH DB_PATH DICTIONARY_FILE_EXTENSION
+#define DEPARTMENT_INDEX_PATH DB_PATH ".department" INDEX_FILE_EXTENSION
+
+#include "table_fixture.h"
+
+void setUp() {}
+
+void tearDown() {
+  close_session();
+  remove(DB_PATH);
+  remove(DICTIONARY_PATH);
+  remove(DEPARTMENT_INDEX_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PATH OVERFLOW_FILE_EXTENSION);
+}
+
+// Rows whose decoded department compares with the value as the operator asks
+static int64_t count_by_strings(uint8_t operator, const char* value) {
+  int64_t count = 0;
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
+  OP_OPEN(scan);
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(scan))) {
+    int order = strcmp(tuple->attributes[3].string_value, value);
+    switch (operator) {
+      case OPERATOR_EQUAL:
+        count += order == 0;
+        break;
+      case OPERATOR_NOT_EQUAL:
+        count += order != 0;
+        break;
+      case OPERATOR_LESS_THAN:
+        count += order < 0;
+        break;
+      default:
+        count += order >= 0;
+        break;
+    }
+  }
+  OP_CLOSE(scan);
+  operator_free(scan);
+  return count;
+}
+
+// Rows matching one predicate, counted by ScanAggregate on the raw pages, by Filter and the legacy select
+// on the codes of the decoded tuples, and by comparing the decoded strings
+static void assert_counts_agree(uint8_t operator, const char* value, int64_t expected) {
+  proposition_t proposition = {.attribute_index = 3,
+                               .operator= operator,
+                               .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)value}};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  aggregate_t aggregate = {.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR};
+
+  Operator* op = scan_aggregate_create(test_dbms_session, &criteria, &aggregate, 1, NULL);
+  TEST_ASSERT_NOT_NULL(op);
+  OP_OPEN(op);
+  tuple_t* result = OP_NEXT(op);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_INT64(expected, result->attributes[0].int_value);
+  OP_CLOSE(op);
+  operator_free(op);
+
+  int64_t filtered = 0;
+  Operator* filter = filter_create(seq_scan_create(test_dbms_session, NULL), test_dbms_session, &criteria, NULL);
+  OP_OPEN(filter);
+  while (OP_NEXT(filter)) {
+    filtered++;
+  }
+  OP_CLOSE(filter);
+  operator_free(filter);
+  TEST_ASSERT_EQUAL_INT64(expected, filtered);
+
+  query_result_t* selected = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(selected);
+  TEST_ASSERT_EQUAL_INT64(expected, (int64_t)selected->row_count);
+  query_free_query_result(selected);
+
+  TEST_ASSERT_EQUAL_INT64(expected, count_by_strings(operator, value));
+}
+
+static void test_dictionary_catalog() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_NONE, true);
+  const system_catalog_t* catalog = test_dbms_session->catalog;
+  // Only STRING attributes can be encoded, each of them once
+  TEST_ASSERT_FALSE(dbms_set_dictionary_encoded(&test_system_catalog, 0));
+  TEST_ASSERT_FALSE(dbms_set_dictionary_encoded(&test_system_catalog, 1));
+  TEST_ASSERT_TRUE(dbms_is_dictionary_encoded(catalog, 1));
+  TEST_ASSERT_TRUE(dbms_is_dictionary_encoded(catalog, 3));
+  TEST_ASSERT_FALSE(dbms_is_dictionary_encoded(catalog, 0));
+  TEST_ASSERT_EQUAL_UINT16(16, catalog->tuple_size);
+  TEST_ASSERT_EQUAL_UINT64(CATALOG_DICTIONARY_CODE_SIZE, dbms_get_stored_size(catalog, 3));
+  TEST_ASSERT_EQUAL_UINT8(30, dbms_get_catalog_record(catalog, 3)->attribute_size);
+  // Attributes after an encoded one move up
+  TEST_ASSERT_EQUAL_INT64(NULL_BYTE_SIZE + 4 + CATALOG_DICTIONARY_CODE_SIZE, dbms_get_attribute_offset(catalog, 2));
+  TEST_ASSERT_EQUAL_UINT64(DATA_SIZE / 16, dbms_catalog_tuples_per_page(catalog));
+  TEST_ASSERT_NOT_NULL(test_dbms_session->dictionary);
+}
+
+static void test_dictionary_round_trip() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_NONE, true);
+  insert_employees(TEST_ROW_COUNT, 20);
+  dictionary_t* dictionary = test_dbms_session->dictionary;
+  TEST_ASSERT_EQUAL_UINT32(20, dictionary_count(dictionary, 1));
+  TEST_ASSERT_EQUAL_UINT32(DEPARTMENT_COUNT, dictionary_count(dictionary, 3));
+  TEST_ASSERT_EQUAL_UINT32(0, dictionary_count(dictionary, 0));
+  TEST_ASSERT_EQUAL_UINT32(1, dictionary_lookup(dictionary, 3, "Sales"));
+  TEST_ASSERT_EQUAL_UINT32(DICTIONARY_NO_CODE, dictionary_lookup(dictionary, 3, "Legal"));
+
+  tuple_t* tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 7});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_STRING("Name7", tuple->attributes[1].string_value);
+  TEST_ASSERT_EQUAL_STRING("Marketing", tuple->attributes[3].string_value);
+
+  // An update adds its new value, the old codes stay valid
+  attribute_value_t attrs[EMPLOYEE_ATTRIBUTE_COUNT] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 7},
+                                                       {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name7"},
+                                                       {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 7.0f},
+                                                       {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Legal"},
+                                                       {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = false}};
+  TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, tuple->id, attrs));
+  TEST_ASSERT_EQUAL_UINT32(DEPARTMENT_COUNT + 1, dictionary_count(dictionary, 3));
+
+  // Values and codes survive reopening
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+  open_session();
+  dictionary = test_dbms_session->dictionary;
+  TEST_ASSERT_NOT_NULL(dictionary);
+  TEST_ASSERT_EQUAL_UINT32(DEPARTMENT_COUNT + 1, dictionary_count(dictionary, 3));
+  TEST_ASSERT_EQUAL_UINT32(DEPARTMENT_COUNT, dictionary_lookup(dictionary, 3, "Legal"));
+  tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 7});
+  TEST_ASSERT_EQUAL_STRING("Legal", tuple->attributes[3].string_value);
+  tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 8});
+  TEST_ASSERT_EQUAL_STRING("Support", tuple->attributes[3].string_value);
+}
+
+static void test_dictionary_predicates() {
+  uint8_t layouts[] = {CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX};
+  for (size_t i = 0; i < sizeof(layouts); i++) {
+    create_employee_table(layouts[i], CATALOG_COMPRESSION_NONE, true);
+    insert_employees(TEST_ROW_COUNT, 20);
+    int64_t per_department = TEST_ROW_COUNT / DEPARTMENT_COUNT;
+
+    assert_counts_agree(OPERATOR_EQUAL, "Sales", per_department);
+    assert_counts_agree(OPERATOR_NOT_EQUAL, "Sales", TEST_ROW_COUNT - per_department);
+    // Not in the dictionary
+    assert_counts_agree(OPERATOR_EQUAL, "Legal", 0);
+    assert_counts_agree(OPERATOR_NOT_EQUAL, "Legal", TEST_ROW_COUNT);
+    // Ordering follows the strings, not the codes: Engineering, Finance and Marketing
+    assert_counts_agree(OPERATOR_LESS_THAN, "N", 3 * per_department);
+    assert_counts_agree(OPERATOR_GREATER_EQUAL, "Sales", 2 * per_department);
+
+    // A written tuple carries the code of its new value without being decoded again
+    attribute_value_t attrs[EMPLOYEE_ATTRIBUTE_COUNT] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 7},
+                                                         {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name7"},
+                                                         {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 7.0f},
+                                                         {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Legal"},
+                                                         {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = false}};
+    TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 7}, attrs));
+    assert_counts_agree(OPERATOR_EQUAL, "Legal", 1);
+    assert_counts_agree(OPERATOR_EQUAL, "Marketing", per_department - 1);
+
+    close_session();
+    remove(DB_PATH);
+    remove(DICTIONARY_PATH);
+    remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  }
+}
+
+// Groups by department and name, with a budget of max_groups groups before spilling
+static void assert_groups_agree(size_t max_groups) {
+  uint8_t group_indices[] = {3, 1};
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_MIN, .attribute_index = 0}};
+  Operator* op = hash_aggregate_create(seq_scan_create(test_dbms_session, NULL), test_dbms_session, group_indices,
+                                       2, aggregates, 2, max_groups, NULL);
+  TEST_ASSERT_NOT_NULL(op);
+  TEST_ASSERT_TRUE(((HashAggregateState*)op->state)->encoded_groups[0]);
+
+  // The name (i % 20) decides the department (i % 5), so there are 20 groups and the first i of each is below 20
+  int64_t rows = 0;
+  size_t groups = 0;
+  bool seen[20] = {false};
+  OP_OPEN(op);
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(op))) {
+    int32_t first = tuple->attributes[3].int_value;
+    TEST_ASSERT_TRUE(first >= 0 && first < 20);
+    TEST_ASSERT_FALSE(seen[first]);
+    seen[first] = true;
+    char name[16];
+    snprintf(name, sizeof(name), "Name%d", first % 20);
+    TEST_ASSERT_EQUAL_STRING(departments[first % DEPARTMENT_COUNT], tuple->attributes[0].string_value);
+    TEST_ASSERT_EQUAL_STRING(name, tuple->attributes[1].string_value);
+    TEST_ASSERT_EQUAL_INT32(TEST_ROW_COUNT / 20, tuple->attributes[2].int_value);
+    rows += tuple->attributes[2].int_value;
+    groups++;
+  }
+  OP_CLOSE(op);
+  operator_free(op);
+  TEST_ASSERT_EQUAL_size_t(20, groups);
+  TEST_ASSERT_EQUAL_INT64(TEST_ROW_COUNT, rows);
+}
+
+static void test_dictionary_group_by() {
+  uint8_t layouts[] = {CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX, CATALOG_LAYOUT_SLOTTED};
+  for (size_t i = 0; i < sizeof(layouts); i++) {
+    create_employee_table(layouts[i], CATALOG_COMPRESSION_NONE, true);
+    insert_employees(TEST_ROW_COUNT, 20);
+    assert_groups_agree(0);
+    // Spilled rows keep their codes
+    assert_groups_agree(8);
+
+    close_session();
+    remove(DB_PATH);
+    remove(DICTIONARY_PATH);
+    remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+    remove(DB_PATH OVERFLOW_FILE_EXTENSION);
+  }
+}
+
+static void test_dictionary_index_build() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_NONE, true);
+  insert_employees(TEST_ROW_COUNT, 20);
+  dbms_flush_buffer_pool(test_dbms_session);
+
+  // The bulk build reads codes from the pages and indexes the strings
+  test_dbms_session->indexes[3] = index_create(test_dbms_session, 3);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[3]);
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Finance"};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[3], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(TEST_ROW_COUNT / DEPARTMENT_COUNT, count);
+  tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_ids[0]);
+  TEST_ASSERT_EQUAL_STRING("Finance", tuple->attributes[3].string_value);
+  free(tuple_ids);
+}
+
+static void test_dictionary_file_required() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_NONE, true);
+  insert_employees(10, 20);
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+
+  // The pages only hold codes, the table cannot be read without its values
+  remove(DICTIONARY_PATH);
+  TEST_ASSERT_NULL(dbms_init_dbms_session(DB_PATH));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_dictionary_catalog);
+  RUN_TEST(test_dictionary_round_trip);
+  RUN_TEST(test_dictionary_predicates);
+  RUN_TEST(test_dictionary_group_by);
+  RUN_TEST(test_dictionary_index_build);
+  RUN_TEST(test_dictionary_file_required);
+  return UNITY_END();
+}
@@ -3,11 +3,15 @@
 #include "dbms.h"
 #include "executor/executor.h"
 #include "executor/filter.h"
+#include "executor/index_scan.h"
 #include "executor/project.h"
+#include "executor/scan_aggregate.h"
 #include "executor/seq_scan.h"
+#include "index.h"
 #include "query.h"
 #include "ssdio.h"
 #include "unity.h"
+#include "zone_map.h"
 
 #define TEST_CATALOG_SIZE 6
 #define TEST_TUPLE_SIZE 96
@@ -48,6 +52,9 @@ void setUp() {
 void tearDown() {
   dbms_free_dbms_manager(test_dbms_manager);
   remove(DB_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PATH ".id" INDEX_FILE_EXTENSION);
+  remove(DB_PATH ".is_active" INDEX_FILE_EXTENSION);
 }
 
 // Helper to insert test tuples
@@ -66,7 +73,7 @@ static void insert_test_tuples(int count) {
 
 static void test_seq_scan_empty_table() {
   // Test scanning an empty table
-  Operator* scan = seq_scan_create(test_dbms_session);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
   TEST_ASSERT_NOT_NULL(scan);
 
   OP_OPEN(scan);
@@ -81,7 +88,7 @@ static void test_seq_scan_single_tuple() {
   // Insert one tuple
   insert_test_tuples(1);
 
-  Operator* scan = seq_scan_create(test_dbms_session);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
   TEST_ASSERT_NOT_NULL(scan);
 
   OP_OPEN(scan);
@@ -102,7 +109,7 @@ static void test_seq_scan_multiple_tuples() {
   // Insert 10 tuples
   insert_test_tuples(10);
 
-  Operator* scan = seq_scan_create(test_dbms_session);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
   TEST_ASSERT_NOT_NULL(scan);
 
   OP_OPEN(scan);
@@ -130,8 +137,8 @@ static void test_filter_with_predicate() {
       .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 5}};
   selection_criteria_t criteria = {.propositions = &prop, .proposition_count = 1};
 
-  Operator* scan = seq_scan_create(test_dbms_session);
-  Operator* filter = filter_create(scan, test_dbms_session, &criteria);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
+  Operator* filter = filter_create(scan, test_dbms_session, &criteria, NULL);
   TEST_ASSERT_NOT_NULL(filter);
 
   OP_OPEN(filter);
@@ -155,8 +162,8 @@ static void test_project_columns() {
   // Project only columns 0 (id) and 2 (salary)
   uint8_t columns[] = {0, 2};
 
-  Operator* scan = seq_scan_create(test_dbms_session);
-  Operator* project = project_create(scan, test_dbms_session, columns, 2, false);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
+  Operator* project = project_create(scan, test_dbms_session, columns, 2, false, NULL);
   TEST_ASSERT_NOT_NULL(project);
 
   OP_OPEN(project);
@@ -190,9 +197,9 @@ static void test_left_deep_tree() {
   // Project only id and name (columns 0 and 1)
   uint8_t columns[] = {0, 1};
 
-  Operator* scan = seq_scan_create(test_dbms_session);
-  Operator* filter = filter_create(scan, test_dbms_session, &criteria);
-  Operator* project = project_create(filter, test_dbms_session, columns, 2, false);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
+  Operator* filter = filter_create(scan, test_dbms_session, &criteria, NULL);
+  Operator* project = project_create(filter, test_dbms_session, columns, 2, false, NULL);
   TEST_ASSERT_NOT_NULL(project);
 
   OP_OPEN(project);
@@ -214,7 +221,7 @@ static void test_pin_count_after_close() {
   // Insert some tuples
   insert_test_tuples(5);
 
-  Operator* scan = seq_scan_create(test_dbms_session);
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
   TEST_ASSERT_NOT_NULL(scan);
 
   OP_OPEN(scan);
@@ -268,6 +275,146 @@ static void test_pinned_page_not_evicted() {
   TEST_ASSERT_EQUAL_UINT32(0, p1->pin_count);
 }
 
+static void test_index_scan_visits_pages_in_order() {
+  insert_test_tuples(500);  // Several pages, is_active alternates
+  test_dbms_session->indexes[4] = index_create(test_dbms_session, 4);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[4]);
+
+  proposition_t props[2] = {
+      {.attribute_index = 0, .operator= OPERATOR_GREATER_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 0}},
+      {.attribute_index = 4, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 2};
+
+  const proposition_t* proposition = index_scan_find_proposition(test_dbms_session, &criteria);
+  TEST_ASSERT_EQUAL_PTR(&props[1], proposition);
+
+  Operator* scan = index_scan_create(test_dbms_session, proposition, NULL);
+  TEST_ASSERT_NOT_NULL(scan);
+  OP_OPEN(scan);
+
+  int count = 0;
+  tuple_id_t previous = {0};
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(scan)) != NULL) {
+    TEST_ASSERT_TRUE(tuple->attributes[4].bool_value);
+    TEST_ASSERT_TRUE(tuple->id.page_id > previous.page_id ||
+                     (tuple->id.page_id == previous.page_id && tuple->id.slot_id > previous.slot_id));
+    previous = tuple->id;
+    count++;
+  }
+  TEST_ASSERT_EQUAL_INT(250, count);
+
+  // Reset replays the same matches
+  OP_RESET(scan);
+  count = 0;
+  while (OP_NEXT(scan) != NULL) count++;
+  TEST_ASSERT_EQUAL_INT(250, count);
+
+  OP_CLOSE(scan);
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    TEST_ASSERT_EQUAL_UINT32(0, test_dbms_session->buffer_pool->buffer_pages[i].pin_count);
+  }
+  operator_free(scan);
+}
+
+static void test_index_scan_under_filter() {
+  insert_test_tuples(100);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+
+  proposition_t props[2] = {
+      {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 42}},
+      {.attribute_index = 4, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 2};
+
+  // No usable index without an equality on an indexed attribute
+  selection_criteria_t range = {.propositions = &props[1], .proposition_count = 1};
+  TEST_ASSERT_NULL(index_scan_find_proposition(test_dbms_session, &range));
+  TEST_ASSERT_NULL(index_scan_create(test_dbms_session, &props[1], NULL));
+
+  Operator* scan = index_scan_create(test_dbms_session, index_scan_find_proposition(test_dbms_session, &criteria), NULL);
+  Operator* filter = filter_create(scan, test_dbms_session, &criteria, NULL);
+  TEST_ASSERT_NOT_NULL(filter);
+
+  // id 42 was inserted with i = 41, so is_active is false
+  OP_OPEN(filter);
+  TEST_ASSERT_NULL(OP_NEXT(filter));
+  OP_CLOSE(filter);
+
+  props[1].value.bool_value = false;
+  OP_OPEN(filter);
+  tuple_t* tuple = OP_NEXT(filter);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT(42, tuple->attributes[0].int_value);
+  TEST_ASSERT_NULL(OP_NEXT(filter));
+  OP_CLOSE(filter);
+
+  operator_free(filter);
+}
+
+static void test_mapped_readonly_session() {
+  // Several pages, read by a second session over the mapped file
+  insert_test_tuples(200);
+  TEST_ASSERT_NULL(dbms_open_dbms_session(DB_PATH, DBMS_OPEN_MMAP));
+  dbms_session_t* mapped = dbms_open_dbms_session(DB_PATH, DBMS_OPEN_READONLY | DBMS_OPEN_MMAP);
+  TEST_ASSERT_NOT_NULL(mapped);
+  TEST_ASSERT_NOT_NULL(mapped->mapping);
+  TEST_ASSERT_TRUE(mapped->page_count > 1);
+
+  // SeqScan -> Filter decodes the mapped pages without a buffer pool frame
+  proposition_t prop = {.attribute_index = 0,
+                        .operator= OPERATOR_GREATER_THAN,
+                        .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}};
+  selection_criteria_t criteria = {.propositions = &prop, .proposition_count = 1};
+  Operator* filter = filter_create(seq_scan_create(mapped, NULL), mapped, &criteria, NULL);
+  TEST_ASSERT_NOT_NULL(filter);
+  OP_OPEN(filter);
+  int count = 0;
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(filter)) != NULL) {
+    count++;
+    TEST_ASSERT_EQUAL_INT(100 + count, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_STRING("Engineering", tuple->attributes[3].string_value);
+  }
+  OP_CLOSE(filter);
+  operator_free(filter);
+  TEST_ASSERT_EQUAL_INT(100, count);
+  TEST_ASSERT_EQUAL_UINT32(0, mapped->buffer_pool->page_count);
+
+  // ScanAggregate reads the same bytes as the read-write session
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 0}};
+  Operator* aggregate = scan_aggregate_create(mapped, &criteria, aggregates, 2, NULL);
+  OP_OPEN(aggregate);
+  tuple = OP_NEXT(aggregate);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT(100, tuple->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_INT(15050, tuple->attributes[1].int_value);
+  OP_CLOSE(aggregate);
+  operator_free(aggregate);
+  TEST_ASSERT_EQUAL_UINT32(0, mapped->buffer_pool->page_count);
+
+  // Point lookups still go through a frame, pointed at the mapping instead of filled from the file
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(mapped->catalog);
+  tuple = dbms_get_tuple(mapped, (tuple_id_t){.page_id = 2, .slot_id = 0});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT((int32_t)tuples_per_page + 1, tuple->attributes[0].int_value);
+  buffer_page_t* buffer_page = dbms_get_buffer_page(mapped, 2);
+  TEST_ASSERT_EQUAL_PTR(dbms_get_mapped_page(mapped, 2), buffer_page->page);
+
+  // Writes are rejected, the read-write session is unaffected
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {
+      {.type = ATTRIBUTE_TYPE_INT, .int_value = 500},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "TestName"},
+      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 1.0f},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  TEST_ASSERT_NULL(dbms_insert_tuple(mapped, attrs));
+  TEST_ASSERT_FALSE(dbms_delete_tuple(mapped, (tuple_id_t){.page_id = 1, .slot_id = 0}));
+  TEST_ASSERT_NOT_NULL(dbms_get_tuple(mapped, (tuple_id_t){.page_id = 1, .slot_id = 0}));
+  TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+  dbms_free_dbms_session(mapped);
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(test_seq_scan_empty_table);
@@ -278,6 +425,9 @@ int main() {
   RUN_TEST(test_left_deep_tree);
   RUN_TEST(test_pin_count_after_close);
   RUN_TEST(test_pinned_page_not_evicted);
+  RUN_TEST(test_index_scan_visits_pages_in_order);
+  RUN_TEST(test_index_scan_under_filter);
+  RUN_TEST(test_mapped_readonly_session);
 
   return UNITY_END();
 }
@@ -0,0 +1,559 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbms.h"
+#include "executor/index_scan.h"
+#include "executor/scan_aggregate.h"
+#include "index.h"
+#include "query.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+
+#define DB_PATH "test_index.dat"
+#define ID_INDEX_PATH DB_PATH ".id" INDEX_FILE_EXTENSION
+#define NAME_INDEX_PATH DB_PATH ".name" INDEX_FILE_EXTENSION
+#define ACTIVE_INDEX_PATH DB_PATH ".is_active" INDEX_FILE_EXTENSION
+#define SALARY_INDEX_PATH DB_PATH ".salary" INDEX_FILE_EXTENSION
+#define DEPARTMENT_NAME_INDEX_PATH DB_PATH ".department+name" INDEX_FILE_EXTENSION
+
+catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+static void open_session() {
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+// Flushes everything and reopens the table, like restarting the CLI
+static void reopen_session() {
+  dbms_flush_buffer_pool(test_dbms_session);
+  dbms_free_dbms_manager(test_dbms_manager);
+  open_session();
+}
+
+void setUp() {
+  // Create a system catalog for testing
+  catalog_record_t test_catalog_records_temp[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},         {"name", 50, ATTRIBUTE_TYPE_STRING, 1},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_active", 1, ATTRIBUTE_TYPE_BOOL, 4}, {PADDING_NAME, 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+
+  memcpy(test_catalog_records, test_catalog_records_temp, sizeof(test_catalog_records_temp));
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (size_t i = 0; i < sizeof(test_catalog_records_temp) / sizeof(catalog_record_t); i++) {
+    tuple_size += test_catalog_records[i].attribute_size;
+  }
+
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.tuple_size = tuple_size;
+  test_system_catalog.record_count = sizeof(test_catalog_records_temp) / sizeof(catalog_record_t);
+
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+}
+
+void tearDown() {
+  dbms_free_dbms_manager(test_dbms_manager);
+  remove(DB_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(ID_INDEX_PATH);
+  remove(NAME_INDEX_PATH);
+  remove(ACTIVE_INDEX_PATH);
+  remove(SALARY_INDEX_PATH);
+  remove(DEPARTMENT_NAME_INDEX_PATH);
+}
+
+static void insert_tuples(int count, int start_id) {
+  for (int i = 0; i < count; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "Name%d", (start_id + i) % 100);
+    attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = start_id + i},
+                                                      {.type = ATTRIBUTE_TYPE_STRING, .string_value = name},
+                                                      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 1.0f},
+                                                      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"},
+                                                      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+    TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+  }
+}
+
+static size_t lookup_int(uint8_t attribute_index, int value) {
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_INT, .int_value = value};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[attribute_index], &key, &count);
+  free(tuple_ids);
+  return count;
+}
+
+static void test_index_survives_reopen() {
+  insert_tuples(5000, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  index_t* created = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(created);
+  TEST_ASSERT_TRUE(created->bucket_count > created->initial_bucket_count);
+  size_t bucket_count = created->bucket_count;
+  size_t level = created->level;
+  size_t next_split = created->next_split;
+
+  reopen_session();
+
+  // Loaded from the index file with the same linear hashing state
+  index_t* loaded = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(loaded);
+  TEST_ASSERT_NULL(test_dbms_session->indexes[1]);
+  TEST_ASSERT_EQUAL_size_t(5000, loaded->num_records);
+  TEST_ASSERT_EQUAL_size_t(bucket_count, loaded->bucket_count);
+  TEST_ASSERT_EQUAL_size_t(level, loaded->level);
+  TEST_ASSERT_EQUAL_size_t(next_split, loaded->next_split);
+
+  for (int id = 0; id < 5000; id += 499) {
+    TEST_ASSERT_EQUAL_size_t(1, lookup_int(0, id));
+  }
+  TEST_ASSERT_EQUAL_size_t(0, lookup_int(0, 5000));
+
+  // The legacy select uses the loaded index
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 4321}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(1, result->row_count);
+  TEST_ASSERT_EQUAL_INT(4321, result->rows[0][0].int_value);
+  query_free_query_result(result);
+}
+
+static void test_index_changes_are_persisted() {
+  insert_tuples(1000, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+  reopen_session();
+
+  // Maintained incrementally after the reload, including splits
+  insert_tuples(3000, 1000);
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(100, query_delete(test_dbms_session, &criteria));
+  TEST_ASSERT_EQUAL_size_t(3900, test_dbms_session->indexes[0]->num_records);
+
+  reopen_session();
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+  TEST_ASSERT_EQUAL_size_t(3900, test_dbms_session->indexes[0]->num_records);
+  TEST_ASSERT_EQUAL_size_t(0, lookup_int(0, 50));
+  TEST_ASSERT_EQUAL_size_t(1, lookup_int(0, 100));
+  TEST_ASSERT_EQUAL_size_t(1, lookup_int(0, 3999));
+}
+
+static void test_index_overflow_pages() {
+  // Every tuple has the same is_active value, so the group of one bucket needs overflow pages
+  insert_tuples(1000, 0);
+  test_dbms_session->indexes[4] = index_create(test_dbms_session, 4);
+  index_t* idx = test_dbms_session->indexes[4];
+  TEST_ASSERT_NOT_NULL(idx);
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true};
+  size_t bucket = 0;
+  while (idx->buckets[bucket] == NULL) bucket++;
+  TEST_ASSERT_EQUAL_size_t((1000 + INDEX_FILE_PAGE_ENTRIES - 1) / INDEX_FILE_PAGE_ENTRIES, idx->group_pages[bucket / INDEX_FILE_GROUP_BUCKETS].count);
+
+  reopen_session();
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[4], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(1000, count);
+  free(tuple_ids);
+
+  // Pages dropped from a shrinking chain are reused before the file grows
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 900}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(900, query_delete(test_dbms_session, &criteria));
+  idx = test_dbms_session->indexes[4];
+  TEST_ASSERT_TRUE(index_sync(idx));
+  TEST_ASSERT_EQUAL_size_t(1, idx->group_pages[bucket / INDEX_FILE_GROUP_BUCKETS].count);
+  TEST_ASSERT_TRUE(idx->free_pages.count > 0);
+  uint64_t page_count = idx->page_count;
+
+  insert_tuples(300, 5000);
+  TEST_ASSERT_TRUE(index_sync(idx));
+  TEST_ASSERT_EQUAL_size_t(2, idx->group_pages[bucket / INDEX_FILE_GROUP_BUCKETS].count);
+  TEST_ASSERT_EQUAL_UINT64(page_count, idx->page_count);
+
+  reopen_session();
+  tuple_ids = index_lookup(test_dbms_session->indexes[4], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(400, count);
+  free(tuple_ids);
+}
+
+static void test_index_string_attribute_reopen() {
+  insert_tuples(1000, 0);
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[1]);
+  reopen_session();
+
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name42"};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[1], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(10, count);
+  free(tuple_ids);
+}
+
+static void test_create_table_removes_stale_index_files() {
+  insert_tuples(10, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+  dbms_free_dbms_manager(test_dbms_manager);
+
+  // A new table under the same name must not pick up the old index
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+  TEST_ASSERT_NULL(test_dbms_session->indexes[0]);
+
+  // A damaged index file is ignored
+  FILE* file = fopen(ID_INDEX_PATH, "wb");
+  TEST_ASSERT_NOT_NULL(file);
+  char garbage[PAGE_SIZE] = "not an index";
+  fwrite(garbage, 1, sizeof(garbage), file);
+  fclose(file);
+  dbms_free_dbms_manager(test_dbms_manager);
+  open_session();
+  TEST_ASSERT_NULL(test_dbms_session->indexes[0]);
+}
+
+// Every block but the first of a chain is full and the counts add up
+static void assert_blocks_packed(const index_t* idx) {
+  size_t total = 0;
+  for (size_t b = 0; b < idx->bucket_count; b++) {
+    for (const index_block_t* block = idx->buckets[b]; block; block = block->next) {
+      TEST_ASSERT_TRUE(block->count > 0);
+      if (block != idx->buckets[b]) {
+        TEST_ASSERT_EQUAL_UINT32(INDEX_BLOCK_ENTRIES, block->count);
+      }
+      total += block->count;
+    }
+  }
+  TEST_ASSERT_EQUAL_size_t(idx->num_records, total);
+}
+
+static void test_index_blocks_stay_packed() {
+  insert_tuples(3000, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  index_t* idx = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(idx);
+  assert_blocks_packed(idx);
+
+  // Deleting from the middle of a chain moves an entry out of its first block
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 1000}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(1000, query_delete(test_dbms_session, &criteria));
+  assert_blocks_packed(idx);
+  for (int id = 0; id < 3000; id += 7) {
+    TEST_ASSERT_EQUAL_size_t(id < 1000 ? 0 : 1, lookup_int(0, id));
+  }
+
+  reopen_session();
+  assert_blocks_packed(test_dbms_session->indexes[0]);
+  TEST_ASSERT_EQUAL_size_t(1, lookup_int(0, 2999));
+}
+
+static void test_index_blocks_come_from_slabs() {
+  // One bucket holds every entry, enough blocks to need a second slab
+  insert_tuples(INDEX_SLAB_BLOCKS * INDEX_BLOCK_ENTRIES + 1, 0);
+  test_dbms_session->indexes[4] = index_create(test_dbms_session, 4);
+  index_t* idx = test_dbms_session->indexes[4];
+  TEST_ASSERT_NOT_NULL(idx);
+  TEST_ASSERT_NOT_NULL(idx->allocator.slabs);
+  TEST_ASSERT_NOT_NULL(idx->allocator.slabs->next);
+  TEST_ASSERT_NULL(idx->allocator.slabs->next->next);
+  TEST_ASSERT_NULL(idx->allocator.free_blocks);
+  size_t used = idx->allocator.slabs->used;
+
+  // Emptied blocks are reused before the slab is bumped
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 50}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(50, query_delete(test_dbms_session, &criteria));
+  TEST_ASSERT_NOT_NULL(idx->allocator.free_blocks);
+
+  insert_tuples(50, 100000);
+  TEST_ASSERT_NULL(idx->allocator.free_blocks);
+  TEST_ASSERT_EQUAL_size_t(used, idx->allocator.slabs->used);
+  assert_blocks_packed(idx);
+
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(idx, &key, &count);
+  TEST_ASSERT_EQUAL_size_t(INDEX_SLAB_BLOCKS * INDEX_BLOCK_ENTRIES + 1, count);
+  free(tuple_ids);
+}
+
+static void test_index_lookup_compares_values() {
+  insert_tuples(1000, 0);
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  test_dbms_session->indexes[2] = index_create(test_dbms_session, 2);
+  index_t* names = test_dbms_session->indexes[1];
+  TEST_ASSERT_NOT_NULL(names);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[2]);
+
+  // Strings are compared in full, not just by hash
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name4"};
+  TEST_ASSERT_EQUAL_size_t(10, index_count(names, &key));
+  key.string_value = "Name";
+  TEST_ASSERT_EQUAL_size_t(0, index_count(names, &key));
+
+  // A value of another type never matches
+  attribute_value_t wrong_type = {.type = ATTRIBUTE_TYPE_INT, .int_value = 4};
+  size_t count = 1;
+  TEST_ASSERT_NULL(index_lookup(names, &wrong_type, &count));
+  TEST_ASSERT_EQUAL_size_t(0, count);
+
+  // Float keys are the value, -0.0 equals 0.0
+  attribute_value_t salary = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = -0.0f};
+  TEST_ASSERT_EQUAL_size_t(0, index_count(test_dbms_session->indexes[2], &salary));
+  salary.float_value = 1.0f;
+  TEST_ASSERT_EQUAL_size_t(1000, index_count(test_dbms_session->indexes[2], &salary));
+
+  // String keys are owned by the index and written to the index file
+  reopen_session();
+  key.string_value = "Name99";
+  TEST_ASSERT_EQUAL_size_t(10, index_count(test_dbms_session->indexes[1], &key));
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[1], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(10, count);
+  for (size_t i = 0; i < count; i++) {
+    tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_ids[i]);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_STRING("Name99", tuple->attributes[1].string_value);
+  }
+  free(tuple_ids);
+}
+
+static void test_count_uses_index_only() {
+  insert_tuples(1000, 0);
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[1]);
+
+  proposition_t props[1] = {{.attribute_index = 1,
+                             .operator= OPERATOR_EQUAL,
+                             .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name7"}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_COUNT, .attribute_index = 0}};
+  Operator* op = scan_aggregate_create(test_dbms_session, &criteria, aggregates, 2, NULL);
+  TEST_ASSERT_NOT_NULL(op);
+  TEST_ASSERT_EQUAL_PTR(test_dbms_session->indexes[1], ((ScanAggregateState*)op->state)->count_index);
+
+  // Hide the table pages, the count must come from the index alone
+  uint64_t page_count = test_dbms_session->page_count;
+  test_dbms_session->page_count = 0;
+  op->open(op);
+  tuple_t* row = op->next(op);
+  TEST_ASSERT_NOT_NULL(row);
+  TEST_ASSERT_EQUAL_INT(10, row->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_INT(10, row->attributes[1].int_value);
+  op->close(op);
+  test_dbms_session->page_count = page_count;
+  operator_free(op);
+
+  // Other aggregates still scan the table
+  aggregates[1].function = AGGREGATE_SUM;
+  op = scan_aggregate_create(test_dbms_session, &criteria, aggregates, 2, NULL);
+  TEST_ASSERT_NOT_NULL(op);
+  TEST_ASSERT_NULL(((ScanAggregateState*)op->state)->count_index);
+  op->open(op);
+  row = op->next(op);
+  TEST_ASSERT_NOT_NULL(row);
+  TEST_ASSERT_EQUAL_INT(10, row->attributes[0].int_value);
+  op->close(op);
+  operator_free(op);
+}
+
+static void test_index_bulk_build() {
+  // Enough pages for several scan threads, the last page is still dirty in the buffer pool
+  insert_tuples(20000, 0);
+  tuple_id_t deleted = {test_dbms_session->page_count, 0};
+  tuple_t* tuple = dbms_get_tuple(test_dbms_session, deleted);
+  TEST_ASSERT_NOT_NULL(tuple);
+  int deleted_id = tuple->attributes[0].int_value;
+  TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, deleted));
+
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  index_t* idx = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(idx);
+  TEST_ASSERT_EQUAL_size_t(19999, idx->num_records);
+
+  // Built at its final size: a whole level, the smallest one below the split load factor
+  TEST_ASSERT_EQUAL_size_t(0, idx->next_split);
+  TEST_ASSERT_EQUAL_size_t(idx->initial_bucket_count << idx->level, idx->bucket_count);
+  size_t capacity = idx->bucket_count * INDEX_BLOCK_ENTRIES;
+  TEST_ASSERT_TRUE(idx->num_records * LOAD_FACTOR_DENOMINATOR <= capacity * LOAD_FACTOR_NUMERATOR);
+  TEST_ASSERT_TRUE(idx->num_records * LOAD_FACTOR_DENOMINATOR > capacity / 2 * LOAD_FACTOR_NUMERATOR);
+
+  for (int id = 0; id < 20000; id += 997) {
+    TEST_ASSERT_EQUAL_size_t(id == deleted_id ? 0 : 1, lookup_int(0, id));
+  }
+  TEST_ASSERT_EQUAL_size_t(0, lookup_int(0, deleted_id));
+
+  // STRING keys are copied from the raw pages
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[1]);
+  attribute_value_t name = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name42"};
+  TEST_ASSERT_EQUAL_size_t(200, index_count(test_dbms_session->indexes[1], &name));
+
+  reopen_session();
+  TEST_ASSERT_EQUAL_size_t(19999, test_dbms_session->indexes[0]->num_records);
+  TEST_ASSERT_EQUAL_size_t(1, lookup_int(0, 12345));
+  TEST_ASSERT_EQUAL_size_t(200, index_count(test_dbms_session->indexes[1], &name));
+}
+
+static size_t count_bloom_matches(const index_t* idx, int start_id, int count) {
+  size_t matches = 0;
+  for (int id = start_id; id < start_id + count; id++) {
+    attribute_value_t key = {.type = ATTRIBUTE_TYPE_INT, .int_value = id};
+    matches += index_may_contain(idx, &key) ? 1 : 0;
+  }
+  return matches;
+}
+
+static void test_index_bloom_filter() {
+  insert_tuples(5000, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  index_t* idx = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(idx);
+  TEST_ASSERT_NOT_NULL(idx->bloom);
+  TEST_ASSERT_TRUE(idx->bloom->capacity >= 2 * idx->num_records);
+
+  // Every key is found, absent keys only by a false positive
+  TEST_ASSERT_EQUAL_size_t(5000, count_bloom_matches(idx, 0, 5000));
+  TEST_ASSERT_TRUE(count_bloom_matches(idx, 100000, 10000) < 200);
+  TEST_ASSERT_EQUAL_size_t(0, lookup_int(0, 100000));
+
+  // Inserts past the capacity rebuild a larger filter
+  uint64_t capacity = idx->bloom->capacity;
+  insert_tuples((int)capacity, 5000);
+  TEST_ASSERT_TRUE(idx->bloom->capacity > capacity);
+  TEST_ASSERT_EQUAL_size_t(5000 + capacity, count_bloom_matches(idx, 0, 5000 + (int)capacity));
+
+  // Rebuilt from the buckets when the index is loaded
+  reopen_session();
+  idx = test_dbms_session->indexes[0];
+  TEST_ASSERT_NOT_NULL(idx->bloom);
+  TEST_ASSERT_EQUAL_size_t(5000 + capacity, count_bloom_matches(idx, 0, 5000 + (int)capacity));
+
+  // The legacy select answers an absent key from the filter
+  proposition_t prop = {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = -7}};
+  selection_criteria_t criteria = {.propositions = &prop, .proposition_count = 1};
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(0, result->row_count);
+  query_free_query_result(result);
+}
+
+static size_t lookup_department_name(const char* department, const char* name) {
+  uint8_t attribute_indexes[] = {3, 1};
+  index_t* idx = dbms_find_composite_index(test_dbms_session, attribute_indexes, 2);
+  TEST_ASSERT_NOT_NULL(idx);
+  attribute_value_t keys[] = {{.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)department},
+                              {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)name}};
+  return index_count(idx, keys);
+}
+
+static void test_composite_index() {
+  insert_tuples(1000, 0);
+  for (int i = 0; i < 5; i++) {
+    attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 5000 + i},
+                                                      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name7"},
+                                                      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 2.0f},
+                                                      {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Ops"},
+                                                      {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = false}};
+    TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+  }
+
+  uint8_t attribute_indexes[] = {3, 1};
+  index_t* idx = index_create_composite(test_dbms_session, attribute_indexes, 2);
+  TEST_ASSERT_NOT_NULL(idx);
+  TEST_ASSERT_TRUE(dbms_add_composite_index(test_dbms_session, idx));
+  TEST_ASSERT_EQUAL_STRING(DEPARTMENT_NAME_INDEX_PATH, idx->filename);
+  TEST_ASSERT_EQUAL_size_t(1005, idx->num_records);
+  TEST_ASSERT_EQUAL_size_t(10, lookup_department_name("Sales", "Name7"));
+  TEST_ASSERT_EQUAL_size_t(5, lookup_department_name("Ops", "Name7"));
+  TEST_ASSERT_EQUAL_size_t(0, lookup_department_name("Ops", "Name8"));
+  TEST_ASSERT_EQUAL_size_t(0, lookup_department_name("Name7", "Ops"));
+
+  // Kept up to date by deletes and inserts
+  proposition_t props[2] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}},
+      {.attribute_index = 1, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Name7"}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(100, query_delete(test_dbms_session, &criteria));
+  insert_tuples(100, 2000);
+  TEST_ASSERT_EQUAL_size_t(10, lookup_department_name("Sales", "Name7"));
+
+  // Only used when every key attribute has an equality
+  props[0] = (proposition_t){
+      .attribute_index = 3, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Ops"}};
+  criteria.propositions = &props[1];
+  TEST_ASSERT_NULL(index_scan_create_for_criteria(test_dbms_session, &criteria, NULL));
+  criteria.propositions = props;
+  criteria.proposition_count = 2;
+  Operator* scan = index_scan_create_for_criteria(test_dbms_session, &criteria, NULL);
+  TEST_ASSERT_NOT_NULL(scan);
+  TEST_ASSERT_EQUAL_PTR(idx, ((IndexScanState*)scan->state)->index);
+  OP_OPEN(scan);
+  int count = 0;
+  tuple_t* tuple;
+  while ((tuple = OP_NEXT(scan)) != NULL) {
+    TEST_ASSERT_EQUAL_STRING("Ops", tuple->attributes[3].string_value);
+    TEST_ASSERT_EQUAL_STRING("Name7", tuple->attributes[1].string_value);
+    count++;
+  }
+  OP_CLOSE(scan);
+  operator_free(scan);
+  TEST_ASSERT_EQUAL_INT(5, count);
+
+  // A composite index wins over a single attribute one
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  attribute_value_t keys[INDEX_MAX_ATTRIBUTES];
+  TEST_ASSERT_EQUAL_PTR(idx, query_find_hash_index(test_dbms_session, &criteria, keys));
+  TEST_ASSERT_EQUAL_STRING("Ops", keys[0].string_value);
+  TEST_ASSERT_EQUAL_STRING("Name7", keys[1].string_value);
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(5, result->row_count);
+  query_free_query_result(result);
+
+  // Found again by its file name
+  reopen_session();
+  TEST_ASSERT_EQUAL_size_t(1, test_dbms_session->composite_index_count);
+  TEST_ASSERT_EQUAL_size_t(1005, test_dbms_session->composite_indexes[0]->num_records);
+  TEST_ASSERT_EQUAL_size_t(10, lookup_department_name("Sales", "Name7"));
+  TEST_ASSERT_EQUAL_size_t(5, lookup_department_name("Ops", "Name7"));
+
+  // and removed with the table
+  dbms_free_dbms_manager(test_dbms_manager);
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+  TEST_ASSERT_EQUAL_size_t(0, test_dbms_session->composite_index_count);
+  TEST_ASSERT_NULL(fopen(DEPARTMENT_NAME_INDEX_PATH, "rb"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_index_survives_reopen);
+  RUN_TEST(test_index_changes_are_persisted);
+  RUN_TEST(test_index_overflow_pages);
+  RUN_TEST(test_index_string_attribute_reopen);
+  RUN_TEST(test_create_table_removes_stale_index_files);
+  RUN_TEST(test_index_blocks_stay_packed);
+  RUN_TEST(test_index_blocks_come_from_slabs);
+  RUN_TEST(test_index_lookup_compares_values);
+  RUN_TEST(test_count_uses_index_only);
+  RUN_TEST(test_index_bulk_build);
+  RUN_TEST(test_composite_index);
+  RUN_TEST(test_index_bloom_filter);
+  return UNITY_END();
+}
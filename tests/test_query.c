@@ -0,0 +1,201 @@
+#include <string.h>
+
+#include "dbms.h"
+#include "index.h"
+#include "query.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+
+#define DB_PATH "test_query.dat"
+
+catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+void setUp() {
+  // Create a system catalog for testing
+  catalog_record_t test_catalog_records_temp[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},         {"name", 50, ATTRIBUTE_TYPE_STRING, 1},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_active", 1, ATTRIBUTE_TYPE_BOOL, 4}, {PADDING_NAME, 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+
+  memcpy(test_catalog_records, test_catalog_records_temp, sizeof(test_catalog_records_temp));
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (size_t i = 0; i < sizeof(test_catalog_records_temp) / sizeof(catalog_record_t); i++) {
+    tuple_size += test_catalog_records[i].attribute_size;
+  }
+
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.tuple_size = tuple_size;
+  test_system_catalog.record_count = sizeof(test_catalog_records_temp) / sizeof(catalog_record_t);
+
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+void tearDown() {
+  dbms_free_dbms_manager(test_dbms_manager);
+  remove(DB_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PATH ".id" INDEX_FILE_EXTENSION);
+}
+
+// Helper to insert test tuples, department alternates between Engineering and Sales
+static void insert_tuples(int count, int start_id) {
+  for (int i = 0; i < count; i++) {
+    attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = start_id + i},
+        {.type = ATTRIBUTE_TYPE_STRING, .string_value = "TestName"},
+        {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 1000.0f * (float)i},
+        {.type = ATTRIBUTE_TYPE_STRING, .string_value = i % 2 == 0 ? "Engineering" : "Sales"},
+        {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = (i % 2 == 0)}};
+    dbms_insert_tuple(test_dbms_session, attrs);
+  }
+}
+
+typedef struct {
+  int seen;
+  int stop_after;
+  int id_sum;
+} stream_counter_t;
+
+static bool count_rows(const tuple_t* tuple, void* context) {
+  stream_counter_t* counter = (stream_counter_t*)context;
+  counter->seen++;
+  counter->id_sum += tuple->attributes[0].int_value;
+  return counter->stop_after == 0 || counter->seen < counter->stop_after;
+}
+
+static void test_query_select_materializes_rows() {
+  // Enough rows to cross several pages and result batches
+  insert_tuples(1000, 0);
+
+  proposition_t props[1] = {{.attribute_index = 3,
+                             .operator= OPERATOR_EQUAL,
+                             .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(500, result->row_count);
+  TEST_ASSERT_EQUAL_size_t(TEST_CATALOG_SIZE - 1, result->column_count);
+  TEST_ASSERT_EQUAL_STRING("department", result->column_names[3]);
+  TEST_ASSERT_TRUE(result->row_capacity >= result->row_count);
+
+  for (size_t i = 0; i < result->row_count; i++) {
+    TEST_ASSERT_EQUAL_INT(2 * (int)i + 1, result->rows[i][0].int_value);
+    TEST_ASSERT_EQUAL_STRING("TestName", result->rows[i][1].string_value);
+    TEST_ASSERT_EQUAL_STRING("Sales", result->rows[i][3].string_value);
+    TEST_ASSERT_FALSE(result->rows[i][4].bool_value);
+  }
+
+  // Rows must not alias the buffer pool
+  dbms_flush_buffer_pool(test_dbms_session);
+  TEST_ASSERT_EQUAL_STRING("Sales", result->rows[0][3].string_value);
+
+  query_free_query_result(result);
+}
+
+static void test_query_select_empty_result() {
+  insert_tuples(10, 0);
+
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_GREATER_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(0, result->row_count);
+  query_free_query_result(result);
+}
+
+static void test_query_select_stream() {
+  insert_tuples(200, 1);
+
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 100}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+  stream_counter_t counter = {0};
+  TEST_ASSERT_EQUAL_INT(100, query_select_stream(test_dbms_session, &criteria, count_rows, &counter));
+  TEST_ASSERT_EQUAL_INT(100, counter.seen);
+  TEST_ASSERT_EQUAL_INT(5050, counter.id_sum);
+
+  // Returning false stops the stream
+  stream_counter_t limited = {.stop_after = 7};
+  TEST_ASSERT_EQUAL_INT(7, query_select_stream(test_dbms_session, &criteria, count_rows, &limited));
+  TEST_ASSERT_EQUAL_INT(7, limited.seen);
+
+  // No pages are left pinned
+  for (uint32_t i = 0; i < BUFFER_POOL_SIZE; i++) {
+    TEST_ASSERT_EQUAL_UINT32(0, test_dbms_session->buffer_pool->buffer_pages[i].pin_count);
+  }
+}
+
+static void test_query_select_stream_with_index() {
+  insert_tuples(50, 0);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 42}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+  stream_counter_t counter = {0};
+  TEST_ASSERT_EQUAL_INT(1, query_select_stream(test_dbms_session, &criteria, count_rows, &counter));
+  TEST_ASSERT_EQUAL_INT(42, counter.id_sum);
+
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(1, result->row_count);
+  TEST_ASSERT_EQUAL_INT(42, result->rows[0][0].int_value);
+  query_free_query_result(result);
+}
+
+static void test_query_select_into_arena() {
+  insert_tuples(300, 0);
+
+  proposition_t props[1] = {{.attribute_index = 3,
+                             .operator= OPERATOR_EQUAL,
+                             .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+
+  arena_t* arena = arena_create(0);
+  TEST_ASSERT_NOT_NULL(arena);
+
+  query_result_t* result = query_select_arena(test_dbms_session, &criteria, arena);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_FALSE(result->owns_arena);
+  TEST_ASSERT_EQUAL_PTR(arena, result->arena);
+  TEST_ASSERT_EQUAL_size_t(150, result->row_count);
+  TEST_ASSERT_EQUAL_INT(298, result->rows[149][0].int_value);
+  TEST_ASSERT_EQUAL_STRING("Engineering", result->rows[149][3].string_value);
+  TEST_ASSERT_EQUAL_STRING("id", result->column_names[0]);
+
+  // Freeing a result that lives in a caller's arena leaves the arena alone
+  query_free_query_result(result);
+  TEST_ASSERT_EQUAL_STRING("Engineering", result->rows[0][3].string_value);
+
+  // The same arena can be reset and reused for the next query
+  arena_reset(arena);
+  result = query_select_arena(test_dbms_session, &criteria, arena);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(150, result->row_count);
+  arena_free(arena);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_query_select_materializes_rows);
+  RUN_TEST(test_query_select_empty_result);
+  RUN_TEST(test_query_select_stream);
+  RUN_TEST(test_query_select_stream_with_index);
+  RUN_TEST(test_query_select_into_arena);
+  return UNITY_END();
+}
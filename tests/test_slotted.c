@@ -0,0 +1,406 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/scan_aggregate.h"
+#include "executor/seq_scan.h"
+#include "index.h"
+#include "slotted.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+#define TEST_ROW_COUNT 2000
+#define WIDE_STRING_COUNT 12
+
+#define DB_PATH "test_slotted.dat"
+#define OVERFLOW_PATH DB_PATH OVERFLOW_FILE_EXTENSION
+#define DEPARTMENT_INDEX_PATH DB_PATH ".department" INDEX_FILE_EXTENSION
+
+#include "table_fixture.h"
+
+// A text-heavy table: 1 + 4 + 100 + 200 + 30 + 4 + 5 = 344 bytes as NSM tuples
+static void create_table(uint8_t layout) {
+  catalog_record_t records[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},           {"name", 100, ATTRIBUTE_TYPE_STRING, 1},
+      {"notes", 200, ATTRIBUTE_TYPE_STRING, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 4},     {PADDING_NAME, 5, ATTRIBUTE_TYPE_UNUSED, 5}};
+  memcpy(test_catalog_records, records, sizeof(records));
+
+  memset(&test_system_catalog, 0, sizeof(test_system_catalog));
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.record_count = TEST_CATALOG_SIZE;
+  test_system_catalog.layout = layout;
+  create_table_from_catalog();
+}
+
+// An INT and twelve 255-byte strings, 3068 bytes at full length
+static void create_wide_table() {
+  test_catalog_records[0] = (catalog_record_t){"id", 4, ATTRIBUTE_TYPE_INT, 0};
+  for (int i = 0; i < WIDE_STRING_COUNT; i++) {
+    catalog_record_t* record = &test_catalog_records[1 + i];
+    snprintf(record->attribute_name, CATALOG_ATTRIBUTE_NAME_SIZE, "text%d", i);
+    record->attribute_size = UINT8_MAX;
+    record->attribute_type = ATTRIBUTE_TYPE_STRING;
+    record->attribute_order = 1 + i;
+  }
+  test_catalog_records[1 + WIDE_STRING_COUNT] =
+      (catalog_record_t){PADDING_NAME, 3, ATTRIBUTE_TYPE_UNUSED, 1 + WIDE_STRING_COUNT};
+
+  memset(&test_system_catalog, 0, sizeof(test_system_catalog));
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.record_count = WIDE_STRING_COUNT + 2;
+  test_system_catalog.layout = CATALOG_LAYOUT_SLOTTED;
+  create_table_from_catalog();
+}
+
+void setUp() {}
+
+void tearDown() {
+  close_session();
+  remove(DB_PATH);
+  remove(OVERFLOW_PATH);
+  remove(DEPARTMENT_INDEX_PATH);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+}
+
+static tuple_t* insert_row(int i, const char* notes) {
+  char name[16];
+  snprintf(name, sizeof(name), "Name%d", i);
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {
+      {.type = ATTRIBUTE_TYPE_INT, .int_value = i},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = name},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)notes},
+      {.type = ATTRIBUTE_TYPE_STRING, .string_value = (char*)departments[i % DEPARTMENT_COUNT]},
+      {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = (float)i}};
+  return dbms_insert_tuple(test_dbms_session, attrs);
+}
+
+static void insert_rows(int count) {
+  for (int i = 0; i < count; i++) {
+    TEST_ASSERT_NOT_NULL(insert_row(i, "short note"));
+  }
+}
+
+static void fill_text(char* text, int row, int column, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    text[i] = (char)('a' + (row * 7 + column * 3 + i) % 26);
+  }
+  text[length] = '\0';
+}
+
+static tuple_t* write_wide_row(tuple_id_t* tuple_id, int row, size_t length) {
+  char texts[WIDE_STRING_COUNT][UINT8_MAX + 1];
+  attribute_value_t attrs[WIDE_STRING_COUNT + 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = row}};
+  for (int i = 0; i < WIDE_STRING_COUNT; i++) {
+    fill_text(texts[i], row, i, length);
+    attrs[1 + i] = (attribute_value_t){.type = ATTRIBUTE_TYPE_STRING, .string_value = texts[i]};
+  }
+  return tuple_id ? dbms_update_tuple(test_dbms_session, *tuple_id, attrs)
+                  : dbms_insert_tuple(test_dbms_session, attrs);
+}
+
+static void assert_wide_row(tuple_id_t tuple_id, int row, size_t length) {
+  tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_id);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT32(row, tuple->attributes[0].int_value);
+  char text[UINT8_MAX + 1];
+  for (int i = 0; i < WIDE_STRING_COUNT; i++) {
+    fill_text(text, row, i, length);
+    TEST_ASSERT_EQUAL_STRING(text, tuple->attributes[1 + i].string_value);
+  }
+}
+
+static void test_slotted_page() {
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  slotted_init_page(page, DATA_SIZE);
+  TEST_ASSERT_EQUAL_UINT64(0, page->tuples_per_page);
+  TEST_ASSERT_EQUAL_UINT64(DATA_SIZE, page->free_space_head);
+  TEST_ASSERT_EQUAL_UINT64(0, slotted_find_free_slot(page));
+
+  // Three records, then the middle one is freed and its slot is the first free one
+  for (uint64_t slot = 0; slot < 3; slot++) {
+    char* record = slotted_allocate(page, slot, 100, false, DATA_SIZE);
+    TEST_ASSERT_NOT_NULL(record);
+    memset(record, 'a' + (int)slot, 100);
+  }
+  TEST_ASSERT_EQUAL_UINT64(3, page->tuples_per_page);
+  slotted_release(page, 1, DATA_SIZE);
+  TEST_ASSERT_FALSE(slotted_is_live(page, 1));
+  TEST_ASSERT_EQUAL_UINT64(1, slotted_find_free_slot(page));
+  TEST_ASSERT_EQUAL_UINT64(3, page->tuples_per_page);
+
+  // Compaction closes the hole, the other records keep their slots and bytes
+  uint64_t heap_start = page->free_space_head;
+  slotted_compact(page, DATA_SIZE);
+  TEST_ASSERT_EQUAL_UINT64(heap_start + 100, page->free_space_head);
+  bool is_overflow = true;
+  const char* record = slotted_get_record(page, 2, &is_overflow);
+  TEST_ASSERT_NOT_NULL(record);
+  TEST_ASSERT_FALSE(is_overflow);
+  TEST_ASSERT_EACH_EQUAL_CHAR('c', record, 100);
+  TEST_ASSERT_EACH_EQUAL_CHAR('a', slotted_get_record(page, 0, NULL), 100);
+
+  // Only the space that is actually free counts, and the directory entry of a new slot with it
+  size_t free_bytes = DATA_SIZE - 3 * SLOTTED_SLOT_SIZE - 200;
+  TEST_ASSERT_TRUE(slotted_has_space(page, free_bytes, 16, DATA_SIZE));
+  TEST_ASSERT_FALSE(slotted_has_space(page, free_bytes + 1, 16, DATA_SIZE));
+  TEST_ASSERT_NULL(slotted_allocate(page, 1, free_bytes + 1, false, DATA_SIZE));
+  TEST_ASSERT_NULL(slotted_allocate(page, 5, 10, false, DATA_SIZE));
+
+  // Freeing the last slots shrinks the directory, an empty page starts over
+  slotted_release(page, 2, DATA_SIZE);
+  TEST_ASSERT_EQUAL_UINT64(1, page->tuples_per_page);
+  slotted_release(page, 0, DATA_SIZE);
+  TEST_ASSERT_EQUAL_UINT64(0, page->tuples_per_page);
+  TEST_ASSERT_EQUAL_UINT64(DATA_SIZE, page->free_space_head);
+  free(page);
+}
+
+static void test_slotted_catalog() {
+  create_table(CATALOG_LAYOUT_NSM);
+  uint64_t nsm_tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  TEST_ASSERT_NULL(test_dbms_session->overflow);
+  close_session();
+
+  create_table(CATALOG_LAYOUT_SLOTTED);
+  TEST_ASSERT_EQUAL_UINT8(CATALOG_LAYOUT_SLOTTED, test_dbms_session->catalog->layout);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->overflow);
+  TEST_ASSERT_TRUE(dbms_catalog_tuples_per_page(test_dbms_session->catalog) > nsm_tuples_per_page);
+  close_session();
+
+  // Other layouts remove a stale overflow file
+  create_table(CATALOG_LAYOUT_PAX);
+  TEST_ASSERT_NULL(fopen(OVERFLOW_PATH, "r"));
+}
+
+static void test_slotted_rows_per_page() {
+  create_table(CATALOG_LAYOUT_NSM);
+  insert_rows(TEST_ROW_COUNT);
+  uint32_t nsm_pages = test_dbms_session->page_count;
+  close_session();
+  remove(DB_PATH);
+
+  // Short strings take their length, not their declared size
+  create_table(CATALOG_LAYOUT_SLOTTED);
+  insert_rows(TEST_ROW_COUNT);
+  uint32_t slotted_pages = test_dbms_session->page_count;
+  TEST_ASSERT_TRUE(slotted_pages * 3 <= nsm_pages);
+}
+
+static void test_slotted_round_trip() {
+  create_table(CATALOG_LAYOUT_SLOTTED);
+  insert_rows(TEST_ROW_COUNT);
+  uint32_t page_count = test_dbms_session->page_count;
+  TEST_ASSERT_TRUE(page_count > BUFFER_POOL_SIZE);
+
+  // Longer and shorter values, on a page that was already evicted once
+  tuple_id_t updated_id = {.page_id = 1, .slot_id = 3};
+  char notes[201];
+  memset(notes, 'n', 200);
+  notes[200] = '\0';
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = -3},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = ""},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = notes},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Legal"},
+                                                    {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 0.5f}};
+  TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, updated_id, attrs));
+  tuple_id_t deleted_id = {.page_id = 2, .slot_id = 0};
+  TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, deleted_id));
+  dbms_flush_buffer_pool(test_dbms_session);
+
+  close_session();
+  open_session();
+  TEST_ASSERT_EQUAL_UINT32(page_count, test_dbms_session->page_count);
+  tuple_t* tuple = dbms_get_tuple(test_dbms_session, updated_id);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT32(-3, tuple->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_STRING("", tuple->attributes[1].string_value);
+  TEST_ASSERT_EQUAL_STRING(notes, tuple->attributes[2].string_value);
+  TEST_ASSERT_EQUAL_STRING("Legal", tuple->attributes[3].string_value);
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, tuple->attributes[4].float_value);
+  TEST_ASSERT_NULL(dbms_get_tuple(test_dbms_session, deleted_id));
+
+  tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 4});
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_INT32(4, tuple->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_STRING("Name4", tuple->attributes[1].string_value);
+  TEST_ASSERT_EQUAL_STRING("short note", tuple->attributes[2].string_value);
+
+  // Freed space is reused before the table grows
+  tuple = insert_row(TEST_ROW_COUNT, "reused");
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_TRUE(tuple->id.page_id <= deleted_id.page_id);
+  TEST_ASSERT_EQUAL_UINT32(page_count, test_dbms_session->page_count);
+}
+
+static void test_slotted_compaction() {
+  create_table(CATALOG_LAYOUT_SLOTTED);
+  char long_notes[201];
+  memset(long_notes, 'x', 200);
+  long_notes[200] = '\0';
+
+  // Fill the first page with short rows, then free every other one
+  uint64_t row_count = 0;
+  while (test_dbms_session->page_count == 1) {
+    TEST_ASSERT_NOT_NULL(insert_row((int)row_count++, "short note"));
+  }
+  uint64_t first_page_rows = row_count - 1;
+  for (uint64_t slot = 0; slot < first_page_rows; slot += 2) {
+    TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = slot}));
+  }
+
+  // Long rows only fit in the freed holes once the page is compacted
+  page_t* page = dbms_get_buffer_page(test_dbms_session, 1)->page;
+  uint64_t heap_start = page->free_space_head;
+  tuple_t* tuple = insert_row(-1, long_notes);
+  TEST_ASSERT_NOT_NULL(tuple);
+  TEST_ASSERT_EQUAL_UINT64(1, tuple->id.page_id);
+  TEST_ASSERT_EQUAL_UINT64(0, tuple->id.slot_id);
+  page = dbms_get_buffer_page(test_dbms_session, 1)->page;
+  TEST_ASSERT_TRUE(page->free_space_head > heap_start - 200);
+
+  // Surviving rows kept their tuple IDs and values
+  for (uint64_t slot = 1; slot < first_page_rows; slot += 2) {
+    tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = slot});
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT32((int32_t)slot, tuple->attributes[0].int_value);
+    TEST_ASSERT_EQUAL_STRING("short note", tuple->attributes[2].string_value);
+  }
+
+  // Growing a row in place compacts around it as well
+  tuple_id_t grown_id = {.page_id = 1, .slot_id = 1};
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 1},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Grown"},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = long_notes},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"},
+                                                    {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 1.0f}};
+  TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, grown_id, attrs));
+  tuple = dbms_get_tuple(test_dbms_session, grown_id);
+  TEST_ASSERT_EQUAL_STRING(long_notes, tuple->attributes[2].string_value);
+  tuple = dbms_get_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 3});
+  TEST_ASSERT_EQUAL_STRING("Name3", tuple->attributes[1].string_value);
+}
+
+static void test_slotted_overflow() {
+  create_wide_table();
+
+  // Full-length rows are too long for a quarter page, their strings go to overflow chains
+  tuple_t* tuple = write_wide_row(NULL, 0, UINT8_MAX);
+  TEST_ASSERT_NOT_NULL(tuple);
+  tuple_id_t long_id = tuple->id;
+  tuple = write_wide_row(NULL, 1, 10);
+  TEST_ASSERT_NOT_NULL(tuple);
+  tuple_id_t short_id = tuple->id;
+  TEST_ASSERT_EQUAL_UINT64(1, test_dbms_session->overflow->page_count);
+  assert_wide_row(long_id, 0, UINT8_MAX);
+  assert_wide_row(short_id, 1, 10);
+
+  // Growing past the limit moves the strings out, shrinking brings them back and frees the chain
+  TEST_ASSERT_NOT_NULL(write_wide_row(&short_id, 1, 200));
+  TEST_ASSERT_EQUAL_UINT64(2, test_dbms_session->overflow->page_count);
+  TEST_ASSERT_NOT_NULL(write_wide_row(&long_id, 0, 20));
+  assert_wide_row(long_id, 0, 20);
+  dbms_flush_buffer_pool(test_dbms_session);
+  TEST_ASSERT_TRUE(test_dbms_session->overflow->free_head != OVERFLOW_NO_PAGE);
+
+  // A freed chain is reused only after the flush
+  tuple = write_wide_row(NULL, 2, UINT8_MAX);
+  TEST_ASSERT_NOT_NULL(tuple);
+  tuple_id_t reused_id = tuple->id;
+  TEST_ASSERT_EQUAL_UINT64(2, test_dbms_session->overflow->page_count);
+  dbms_flush_buffer_pool(test_dbms_session);
+
+  close_session();
+  open_session();
+  assert_wide_row(long_id, 0, 20);
+  assert_wide_row(short_id, 1, 200);
+  assert_wide_row(reused_id, 2, UINT8_MAX);
+
+  // Deleting a row frees its chain too
+  TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, short_id));
+  dbms_flush_buffer_pool(test_dbms_session);
+  TEST_ASSERT_TRUE(test_dbms_session->overflow->free_head != OVERFLOW_NO_PAGE);
+  close_session();
+
+  // Long strings are only in the overflow file
+  remove(OVERFLOW_PATH);
+  TEST_ASSERT_NULL(dbms_init_dbms_session(DB_PATH));
+}
+
+static void test_slotted_scans() {
+  create_table(CATALOG_LAYOUT_SLOTTED);
+  insert_rows(TEST_ROW_COUNT);
+  int64_t per_department = TEST_ROW_COUNT / DEPARTMENT_COUNT;
+
+  // ScanAggregate unpacks the records, SeqScan decodes them
+  proposition_t propositions[] = {{.attribute_index = 3,
+                                   .operator= OPERATOR_EQUAL,
+                                   .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"}},
+                                  {.attribute_index = 0,
+                                   .operator= OPERATOR_LESS_THAN,
+                                   .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 1000}}};
+  selection_criteria_t criteria = {.propositions = propositions, .proposition_count = 2};
+  aggregate_t aggregates[] = {{.function = AGGREGATE_COUNT, .attribute_index = AGGREGATE_COUNT_STAR},
+                              {.function = AGGREGATE_SUM, .attribute_index = 0}};
+  Operator* op = scan_aggregate_create(test_dbms_session, &criteria, aggregates, 2, NULL);
+  OP_OPEN(op);
+  tuple_t* result = OP_NEXT(op);
+  TEST_ASSERT_NOT_NULL(result);
+  int64_t expected_count = 0;
+  int64_t expected_sum = 0;
+  for (int i = 1; i < 1000; i += DEPARTMENT_COUNT) {
+    expected_count++;
+    expected_sum += i;
+  }
+  TEST_ASSERT_EQUAL_INT64(expected_count, result->attributes[0].int_value);
+  TEST_ASSERT_EQUAL_INT64(expected_sum, result->attributes[1].int_value);
+  OP_CLOSE(op);
+  operator_free(op);
+
+  int64_t filtered = 0;
+  Operator* filter = filter_create(seq_scan_create(test_dbms_session, NULL), test_dbms_session, &criteria, NULL);
+  OP_OPEN(filter);
+  while (OP_NEXT(filter)) {
+    filtered++;
+  }
+  OP_CLOSE(filter);
+  operator_free(filter);
+  TEST_ASSERT_EQUAL_INT64(expected_count, filtered);
+
+  // The bulk index build unpacks the pages it reads
+  test_dbms_session->indexes[3] = index_create(test_dbms_session, 3);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[3]);
+  attribute_value_t key = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Finance"};
+  size_t count = 0;
+  tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[3], &key, &count);
+  TEST_ASSERT_EQUAL_size_t(per_department, count);
+  free(tuple_ids);
+
+  // So does a zone map rebuilt from the pages
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  open_session();
+  proposition_t beyond = {.attribute_index = 0,
+                          .operator= OPERATOR_GREATER_THAN,
+                          .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = TEST_ROW_COUNT / 2}};
+  selection_criteria_t beyond_criteria = {.propositions = &beyond, .proposition_count = 1};
+  TEST_ASSERT_TRUE(zone_map_can_skip_page(test_dbms_session->zone_map, 1, &beyond_criteria));
+  TEST_ASSERT_FALSE(zone_map_can_skip_page(test_dbms_session->zone_map, test_dbms_session->page_count,
+                                           &beyond_criteria));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_slotted_page);
+  RUN_TEST(test_slotted_catalog);
+  RUN_TEST(test_slotted_rows_per_page);
+  RUN_TEST(test_slotted_round_trip);
+  RUN_TEST(test_slotted_compaction);
+  RUN_TEST(test_slotted_overflow);
+  RUN_TEST(test_slotted_scans);
+  return UNITY_END();
+}
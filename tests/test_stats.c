@@ -0,0 +1,288 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btree.h"
+#include "dbms.h"
+#include "executor/index_scan.h"
+#include "index.h"
+#include "query.h"
+#include "stats.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+#define TEST_ROWS 5000
+#define TEST_CATEGORIES 10
+#define TEST_NAMES 50
+
+#define DB_PATH "test_stats.dat"
+#define STATS_PATH DB_PATH STATS_FILE_EXTENSION
+#define SMALL_DB_PATH "test_stats_small.dat"
+
+catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+static void open_session() {
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+static void close_session() {
+  dbms_free_dbms_manager(test_dbms_manager);
+  test_dbms_manager = NULL;
+  test_dbms_session = NULL;
+}
+
+static void remove_table(const char* path) {
+  const char* extensions[] = {"", ZONE_MAP_FILE_EXTENSION, STATS_FILE_EXTENSION, ".id" INDEX_FILE_EXTENSION,
+                              ".category" INDEX_FILE_EXTENSION, ".id" BTREE_FILE_EXTENSION};
+  for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++) {
+    char filename[128];
+    snprintf(filename, sizeof(filename), "%s%s", path, extensions[i]);
+    remove(filename);
+  }
+}
+
+void setUp() {
+  catalog_record_t test_catalog_records_temp[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},        {"category", 4, ATTRIBUTE_TYPE_INT, 1},
+      {"score", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"name", 20, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_rare", 1, ATTRIBUTE_TYPE_BOOL, 4},  {PADDING_NAME, 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+
+  memcpy(test_catalog_records, test_catalog_records_temp, sizeof(test_catalog_records_temp));
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (size_t i = 0; i < sizeof(test_catalog_records_temp) / sizeof(catalog_record_t); i++) {
+    tuple_size += test_catalog_records[i].attribute_size;
+  }
+
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.tuple_size = tuple_size;
+  test_system_catalog.record_count = sizeof(test_catalog_records_temp) / sizeof(catalog_record_t);
+
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+}
+
+void tearDown() {
+  close_session();
+  remove_table(DB_PATH);
+  remove_table(SMALL_DB_PATH);
+}
+
+// id is unique, category has TEST_CATEGORIES values, name TEST_NAMES and is_rare is true for 10% of the rows
+static void fill_table(dbms_session_t* session, int rows) {
+  for (int id = 0; id < rows; id++) {
+    char name[21];
+    snprintf(name, sizeof(name), "name-%03d", id % TEST_NAMES);
+    attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = id},
+        {.type = ATTRIBUTE_TYPE_INT, .int_value = id % TEST_CATEGORIES},
+        {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = (float)id / 4},
+        {.type = ATTRIBUTE_TYPE_STRING, .string_value = name},
+        {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = id % 10 == 0}};
+    TEST_ASSERT_NOT_NULL(dbms_insert_tuple(session, attrs));
+  }
+}
+
+static double selectivity(uint8_t attribute_index, uint8_t operator, attribute_value_t value) {
+  proposition_t proposition = {.attribute_index = attribute_index, .operator= operator, .value = value};
+  selection_criteria_t criteria = {.propositions = &proposition, .proposition_count = 1};
+  return stats_selectivity(test_dbms_session, &criteria);
+}
+
+static attribute_value_t int_value(int32_t value) {
+  return (attribute_value_t){.type = ATTRIBUTE_TYPE_INT, .int_value = value};
+}
+
+void test_analyze_every_page(void) {
+  fill_table(test_dbms_session, TEST_ROWS);
+  TEST_ASSERT_NULL(test_dbms_session->stats);
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 0));
+
+  const table_stats_t* stats = test_dbms_session->stats;
+  TEST_ASSERT_NOT_NULL(stats);
+  TEST_ASSERT_EQUAL_UINT64(test_dbms_session->page_count, stats->meta.pages_sampled);
+  TEST_ASSERT_EQUAL_FLOAT(TEST_ROWS, stats->meta.row_count);
+  TEST_ASSERT_EQUAL_FLOAT(TEST_ROWS, stats_row_count(test_dbms_session));
+  TEST_ASSERT_TRUE(stats->meta.null_fraction >= 0.0 && stats->meta.null_fraction < 0.1);
+
+  // HyperLogLog counts are within a few percent
+  TEST_ASSERT_FLOAT_WITHIN(TEST_ROWS * 0.05, TEST_ROWS, stats->columns[0].distinct_count);
+  TEST_ASSERT_FLOAT_WITHIN(1, TEST_CATEGORIES, stats->columns[1].distinct_count);
+  TEST_ASSERT_FLOAT_WITHIN(2, TEST_NAMES, stats->columns[3].distinct_count);
+  TEST_ASSERT_FLOAT_WITHIN(0.5, 2, stats->columns[4].distinct_count);
+
+  attribute_value_t low = int_value(0);
+  attribute_value_t high = int_value(TEST_ROWS - 1);
+  TEST_ASSERT_EQUAL_UINT64(btree_normalize_key(&low), stats->columns[0].min_key);
+  TEST_ASSERT_EQUAL_UINT64(btree_normalize_key(&high), stats->columns[0].max_key);
+  TEST_ASSERT_EQUAL_UINT8(STATS_HISTOGRAM_BUCKETS, stats->columns[0].bucket_count);
+
+  // Ranges from the histogram, equalities from the distinct counts or the skew of the histogram
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.25, selectivity(0, OPERATOR_LESS_THAN, int_value(TEST_ROWS / 4)));
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.6, selectivity(0, OPERATOR_GREATER_EQUAL, int_value(TEST_ROWS * 2 / 5)));
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.1, selectivity(1, OPERATOR_EQUAL, int_value(3)));
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.9, selectivity(1, OPERATOR_NOT_EQUAL, int_value(3)));
+  TEST_ASSERT_EQUAL_FLOAT(0.0, selectivity(0, OPERATOR_EQUAL, int_value(TEST_ROWS * 2)));
+  TEST_ASSERT_EQUAL_FLOAT(0.0, selectivity(0, OPERATOR_GREATER_THAN, int_value(TEST_ROWS)));
+  TEST_ASSERT_FLOAT_WITHIN(0.03, 0.1,
+                            selectivity(4, OPERATOR_EQUAL, (attribute_value_t){.type = ATTRIBUTE_TYPE_BOOL,
+                                                                               .bool_value = true}));
+  TEST_ASSERT_FLOAT_WITHIN(0.03, 0.9,
+                            selectivity(4, OPERATOR_EQUAL, (attribute_value_t){.type = ATTRIBUTE_TYPE_BOOL,
+                                                                               .bool_value = false}));
+
+  // Two bounds on one attribute make a single range, not two independent ones
+  proposition_t bounds[] = {{.attribute_index = 0, .operator= OPERATOR_GREATER_EQUAL, .value = int_value(1000)},
+                            {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = int_value(2000)},
+                            {.attribute_index = 1, .operator= OPERATOR_EQUAL, .value = int_value(4)}};
+  selection_criteria_t criteria = {.propositions = bounds, .proposition_count = 2};
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.2, stats_selectivity(test_dbms_session, &criteria));
+  criteria.proposition_count = 3;
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 0.02, stats_selectivity(test_dbms_session, &criteria));
+}
+
+void test_analyze_sample(void) {
+  fill_table(test_dbms_session, TEST_ROWS * 8);
+  uint32_t page_count = test_dbms_session->page_count;
+  TEST_ASSERT_TRUE(page_count > 40);
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 60));
+
+  // The zone map gives the exact row count and INT/FLOAT min/max even though only 60 pages were read
+  const table_stats_t* stats = test_dbms_session->stats;
+  TEST_ASSERT_EQUAL_UINT64(60, stats->meta.pages_sampled);
+  TEST_ASSERT_EQUAL_FLOAT(TEST_ROWS * 8, stats->meta.row_count);
+  attribute_value_t high = int_value(TEST_ROWS * 8 - 1);
+  TEST_ASSERT_EQUAL_UINT64(btree_normalize_key(&high), stats->columns[0].max_key);
+
+  // A unique column is scaled up from the sample, repeated values are not
+  TEST_ASSERT_FLOAT_WITHIN(TEST_ROWS * 8 * 0.2, TEST_ROWS * 8, stats->columns[0].distinct_count);
+  TEST_ASSERT_FLOAT_WITHIN(1, TEST_CATEGORIES, stats->columns[1].distinct_count);
+  TEST_ASSERT_FLOAT_WITHIN(0.1, 0.5, selectivity(0, OPERATOR_LESS_THAN, int_value(TEST_ROWS * 4)));
+}
+
+void test_stats_persist_across_sessions(void) {
+  fill_table(test_dbms_session, TEST_ROWS);
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 0));
+  table_stats_t saved = *test_dbms_session->stats;
+  stats_column_t columns[TEST_CATALOG_SIZE - 1];
+  memcpy(columns, saved.columns, sizeof(columns));
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+
+  open_session();
+  const table_stats_t* stats = test_dbms_session->stats;
+  TEST_ASSERT_NOT_NULL(stats);
+  TEST_ASSERT_EQUAL_MEMORY(&saved.meta, &stats->meta, sizeof(stats_file_meta_t));
+  TEST_ASSERT_EQUAL_MEMORY(columns, stats->columns, sizeof(columns));
+
+  // Rows inserted since the analyze are estimated from the page count
+  fill_table(test_dbms_session, TEST_ROWS);
+  TEST_ASSERT_FLOAT_WITHIN(TEST_ROWS * 0.1, TEST_ROWS * 2, stats_row_count(test_dbms_session));
+  close_session();
+
+  // A table created again under the name drops the old statistics
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+  TEST_ASSERT_NULL(test_dbms_session->stats);
+  FILE* file = fopen(STATS_PATH, "rb");
+  TEST_ASSERT_NULL(file);
+}
+
+static int count_matches(selection_criteria_t* criteria) {
+  query_result_t* result = query_select(test_dbms_session, criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  int count = (int)result->row_count;
+  query_free_query_result(result);
+  return count;
+}
+
+void test_cost_model_chooses_index_or_scan(void) {
+  fill_table(test_dbms_session, TEST_ROWS);
+  test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+  test_dbms_session->indexes[1] = index_create(test_dbms_session, 1);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[1]);
+
+  proposition_t propositions[] = {{.attribute_index = 1, .operator= OPERATOR_EQUAL, .value = int_value(3)},
+                                  {.attribute_index = 0, .operator= OPERATOR_EQUAL, .value = int_value(43)}};
+  selection_criteria_t category = {.propositions = propositions, .proposition_count = 1};
+  selection_criteria_t both = {.propositions = propositions, .proposition_count = 2};
+
+  // Without statistics the first indexed equality is used
+  attribute_value_t keys[INDEX_MAX_ATTRIBUTES];
+  TEST_ASSERT_EQUAL_PTR(test_dbms_session->indexes[1], query_find_hash_index(test_dbms_session, &category, keys));
+  TEST_ASSERT_EQUAL_PTR(test_dbms_session->indexes[1], query_find_hash_index(test_dbms_session, &both, keys));
+  int category_count = count_matches(&category);
+  TEST_ASSERT_EQUAL_INT(TEST_ROWS / TEST_CATEGORIES, category_count);
+  TEST_ASSERT_EQUAL_INT(1, count_matches(&both));
+
+  // A tenth of the rows is on every page: the scan is cheaper than fetching them through the index
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 0));
+  TEST_ASSERT_NULL(query_find_hash_index(test_dbms_session, &category, keys));
+  TEST_ASSERT_NULL(index_scan_create_for_criteria(test_dbms_session, &category, NULL));
+  TEST_ASSERT_EQUAL_INT(category_count, count_matches(&category));
+
+  // The unique id is the more selective of the two equalities
+  TEST_ASSERT_EQUAL_PTR(test_dbms_session->indexes[0], query_find_hash_index(test_dbms_session, &both, keys));
+  TEST_ASSERT_EQUAL_INT(43, keys[0].int_value);
+  TEST_ASSERT_EQUAL_INT(1, count_matches(&both));
+  Operator* scan = index_scan_create_for_criteria(test_dbms_session, &both, NULL);
+  TEST_ASSERT_NOT_NULL(scan);
+  operator_free(scan);
+}
+
+void test_cost_model_btree_range(void) {
+  fill_table(test_dbms_session, TEST_ROWS);
+  test_dbms_session->btrees[0] = btree_create(test_dbms_session, 0);
+  TEST_ASSERT_NOT_NULL(test_dbms_session->btrees[0]);
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 0));
+
+  // A narrow range reads a few pages through the tree, a wide one is left to the SeqScan
+  proposition_t narrow[] = {{.attribute_index = 0, .operator= OPERATOR_GREATER_EQUAL, .value = int_value(100)},
+                            {.attribute_index = 0, .operator= OPERATOR_LESS_EQUAL, .value = int_value(110)}};
+  proposition_t wide = {.attribute_index = 0, .operator= OPERATOR_GREATER_THAN, .value = int_value(100)};
+  selection_criteria_t narrow_criteria = {.propositions = narrow, .proposition_count = 2};
+  selection_criteria_t wide_criteria = {.propositions = &wide, .proposition_count = 1};
+  Operator* scan = index_scan_create_for_criteria(test_dbms_session, &narrow_criteria, NULL);
+  TEST_ASSERT_NOT_NULL(scan);
+  operator_free(scan);
+  TEST_ASSERT_NULL(index_scan_create_for_criteria(test_dbms_session, &wide_criteria, NULL));
+}
+
+void test_cost_model_join_order(void) {
+  fill_table(test_dbms_session, TEST_ROWS);
+  TEST_ASSERT_TRUE(stats_analyze(test_dbms_session, 0));
+
+  dbms_create_table(SMALL_DB_PATH, &test_system_catalog);
+  dbms_session_t* small = dbms_init_dbms_session(SMALL_DB_PATH);
+  TEST_ASSERT_NOT_NULL(small);
+  dbms_add_session(test_dbms_manager, small);
+  fill_table(small, 100);
+  TEST_ASSERT_TRUE(stats_analyze(small, 0));
+
+  // The inner table is scanned once per outer tuple, so the small table goes outside
+  double small_outer = stats_nested_loop_cost(small, test_dbms_session, -1, -1, false);
+  double large_outer = stats_nested_loop_cost(test_dbms_session, small, -1, -1, false);
+  TEST_ASSERT_TRUE(small_outer < large_outer);
+
+  // A Bloom filter on the inner attribute only lets the outer values it holds through
+  double filtered = stats_nested_loop_cost(test_dbms_session, small, 0, 0, true);
+  TEST_ASSERT_TRUE(filtered < large_outer);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_analyze_every_page);
+  RUN_TEST(test_analyze_sample);
+  RUN_TEST(test_stats_persist_across_sessions);
+  RUN_TEST(test_cost_model_chooses_index_or_scan);
+  RUN_TEST(test_cost_model_btree_range);
+  RUN_TEST(test_cost_model_join_order);
+  return UNITY_END();
+}
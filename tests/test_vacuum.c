@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "compression.h"
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/seq_scan.h"
+#include "index.h"
+#include "slotted.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "vacuum.h"
+#include "zone_map.h"
+
+#define TEST_ROW_COUNT 2000
+#define TEST_KEEP_EVERY 10
+
+#define DB_PATH "test_vacuum.dat"
+#define ID_INDEX_PATH DB_PATH ".id" INDEX_FILE_EXTENSION
+
+#include "table_fixture.h"
+
+void setUp() {}
+
+void tearDown() {
+  close_session();
+  remove(DB_PATH);
+  remove(DB_PATH COMPRESSION_MAP_FILE_EXTENSION);
+  remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+  remove(DB_PATH OVERFLOW_FILE_EXTENSION);
+  remove(ID_INDEX_PATH);
+}
+
+// Leaves every TEST_KEEP_EVERY-th row, spread over every page
+static void delete_most_rows() {
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  for (uint64_t page_id = 1; page_id <= test_dbms_session->page_count; page_id++) {
+    for (uint64_t slot_id = 0; slot_id < tuples_per_page; slot_id++) {
+      tuple_id_t tuple_id = {.page_id = page_id, .slot_id = slot_id};
+      tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_id);
+      if (tuple && tuple->attributes[0].int_value % TEST_KEEP_EVERY != 0) {
+        TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, tuple_id));
+      }
+    }
+  }
+}
+
+static void run_vacuum(bool punch_holes, size_t budget) {
+  vacuum_t* vacuum = vacuum_start(test_dbms_session, punch_holes);
+  TEST_ASSERT_NOT_NULL(vacuum);
+  size_t steps = 0;
+  while (vacuum_step(test_dbms_session, vacuum, budget)) {
+    steps++;
+  }
+  TEST_ASSERT_TRUE(vacuum->is_done);
+  TEST_ASSERT_TRUE(steps > 0);
+  TEST_ASSERT_EQUAL_UINT64(vacuum->start_page_count - test_dbms_session->page_count, vacuum->pages_freed);
+  vacuum_free(vacuum);
+}
+
+// Every surviving row is found once by a scan, with its values intact
+static void assert_rows_intact() {
+  int expected = TEST_ROW_COUNT / TEST_KEEP_EVERY;
+  bool* seen = calloc(TEST_ROW_COUNT, sizeof(bool));
+  Operator* scan = seq_scan_create(test_dbms_session, NULL);
+  OP_OPEN(scan);
+  int count = 0;
+  tuple_t* tuple = NULL;
+  while ((tuple = OP_NEXT(scan))) {
+    int32_t id = tuple->attributes[0].int_value;
+    TEST_ASSERT_TRUE(id >= 0 && id < TEST_ROW_COUNT && id % TEST_KEEP_EVERY == 0);
+    TEST_ASSERT_FALSE(seen[id]);
+    seen[id] = true;
+    char name[16];
+    snprintf(name, sizeof(name), "Name%d", id);
+    TEST_ASSERT_EQUAL_STRING(name, tuple->attributes[1].string_value);
+    TEST_ASSERT_EQUAL_FLOAT((float)id, tuple->attributes[2].float_value);
+    TEST_ASSERT_EQUAL_STRING(departments[id % DEPARTMENT_COUNT], tuple->attributes[3].string_value);
+    count++;
+  }
+  OP_CLOSE(scan);
+  operator_free(scan);
+  free(seen);
+  TEST_ASSERT_EQUAL_INT(expected, count);
+}
+
+static void test_vacuum_shrinks_table() {
+  uint8_t layouts[] = {CATALOG_LAYOUT_NSM, CATALOG_LAYOUT_PAX, CATALOG_LAYOUT_SLOTTED, CATALOG_LAYOUT_BITMAP};
+  for (size_t i = 0; i < sizeof(layouts); i++) {
+    create_employee_table(layouts[i], CATALOG_COMPRESSION_NONE, false);
+    insert_employees(TEST_ROW_COUNT, 0);
+    test_dbms_session->indexes[0] = index_create(test_dbms_session, 0);
+    TEST_ASSERT_NOT_NULL(test_dbms_session->indexes[0]);
+    delete_most_rows();
+    dbms_flush_buffer_pool(test_dbms_session);
+    uint32_t page_count = test_dbms_session->page_count;
+    TEST_ASSERT_EQUAL_INT64((off_t)(page_count + 1) * PAGE_SIZE, ssdio_get_file_size(test_dbms_session->fd));
+
+    run_vacuum(false, VACUUM_STEP_BUDGET);
+
+    // The surviving tenth of the rows is packed into about a tenth of the pages
+    uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+    uint64_t needed = (TEST_ROW_COUNT / TEST_KEEP_EVERY + tuples_per_page - 1) / tuples_per_page;
+    TEST_ASSERT_TRUE(test_dbms_session->page_count < page_count);
+    TEST_ASSERT_TRUE(test_dbms_session->page_count <= needed + 1);
+    TEST_ASSERT_EQUAL_INT64((off_t)(test_dbms_session->page_count + 1) * PAGE_SIZE,
+                            ssdio_get_file_size(test_dbms_session->fd));
+    assert_rows_intact();
+
+    // The index follows the moved tuples
+    attribute_value_t key = {.type = ATTRIBUTE_TYPE_INT, .int_value = TEST_ROW_COUNT - TEST_KEEP_EVERY};
+    size_t count = 0;
+    tuple_id_t* tuple_ids = index_lookup(test_dbms_session->indexes[0], &key, &count);
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_TRUE(tuple_ids[0].page_id <= test_dbms_session->page_count);
+    tuple_t* tuple = dbms_get_tuple(test_dbms_session, tuple_ids[0]);
+    TEST_ASSERT_NOT_NULL(tuple);
+    TEST_ASSERT_EQUAL_INT32(key.int_value, tuple->attributes[0].int_value);
+    free(tuple_ids);
+    key.int_value = 1;
+    tuple_ids = index_lookup(test_dbms_session->indexes[0], &key, &count);
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    free(tuple_ids);
+
+    // The zone map and the pages agree after the table is opened again
+    uint32_t vacuumed_page_count = test_dbms_session->page_count;
+    close_session();
+    open_session();
+    TEST_ASSERT_EQUAL_UINT32(vacuumed_page_count, test_dbms_session->page_count);
+    TEST_ASSERT_TRUE(test_dbms_session->zone_map->is_clean);
+    TEST_ASSERT_EQUAL_UINT64(vacuumed_page_count, test_dbms_session->zone_map->page_count);
+    assert_rows_intact();
+
+    // New rows go after the live ones
+    insert_employees(1, 0);
+    TEST_ASSERT_EQUAL_UINT32(vacuumed_page_count, test_dbms_session->page_count);
+    close_session();
+    remove(DB_PATH);
+    remove(DB_PATH ZONE_MAP_FILE_EXTENSION);
+    remove(DB_PATH OVERFLOW_FILE_EXTENSION);
+    remove(ID_INDEX_PATH);
+  }
+}
+
+static void test_vacuum_compressed() {
+  create_employee_table(CATALOG_LAYOUT_NSM, CATALOG_COMPRESSION_LZ4, false);
+  insert_employees(TEST_ROW_COUNT, 0);
+  delete_most_rows();
+  dbms_flush_buffer_pool(test_dbms_session);
+  uint32_t page_count = test_dbms_session->page_count;
+  off_t file_size = ssdio_get_file_size(test_dbms_session->fd);
+
+  run_vacuum(true, VACUUM_STEP_BUDGET);
+  TEST_ASSERT_TRUE(test_dbms_session->page_count < page_count);
+  TEST_ASSERT_EQUAL_UINT64(test_dbms_session->page_count, test_dbms_session->compression_map->page_count);
+
+  // The file ends after the last extent in use
+  off_t vacuumed_size = ssdio_get_file_size(test_dbms_session->fd);
+  TEST_ASSERT_TRUE(vacuumed_size < file_size);
+  TEST_ASSERT_EQUAL_INT64((off_t)test_dbms_session->compression_map->file_end, vacuumed_size);
+  assert_rows_intact();
+
+  close_session();
+  open_session();
+  TEST_ASSERT_NOT_NULL(test_dbms_session->compression_map);
+  assert_rows_intact();
+}
+
+static void test_vacuum_steps() {
+  create_employee_table(CATALOG_LAYOUT_BITMAP, CATALOG_COMPRESSION_NONE, false);
+  insert_employees(TEST_ROW_COUNT, 0);
+
+  // A full table has nothing to move
+  vacuum_t* vacuum = vacuum_start(test_dbms_session, false);
+  uint32_t page_count = test_dbms_session->page_count;
+  while (vacuum_step(test_dbms_session, vacuum, VACUUM_STEP_BUDGET)) {
+  }
+  TEST_ASSERT_EQUAL_UINT64(0, vacuum->tuples_moved);
+  TEST_ASSERT_EQUAL_UINT64(0, vacuum->pages_freed);
+  TEST_ASSERT_EQUAL_UINT32(page_count, test_dbms_session->page_count);
+  TEST_ASSERT_FALSE(vacuum_step(test_dbms_session, vacuum, VACUUM_STEP_BUDGET));
+  vacuum_free(vacuum);
+
+  // A step moves at most its budget, and the table shrinks as it goes
+  delete_most_rows();
+  vacuum = vacuum_start(test_dbms_session, false);
+  uint64_t tuples_moved = 0;
+  uint32_t last_page_count = test_dbms_session->page_count;
+  while (vacuum_step(test_dbms_session, vacuum, 1)) {
+    TEST_ASSERT_TRUE(vacuum->tuples_moved <= tuples_moved + 1);
+    TEST_ASSERT_TRUE(test_dbms_session->page_count <= last_page_count);
+    tuples_moved = vacuum->tuples_moved;
+    last_page_count = test_dbms_session->page_count;
+  }
+  TEST_ASSERT_TRUE(vacuum->tuples_moved > 0);
+  TEST_ASSERT_TRUE(test_dbms_session->page_count < page_count);
+  vacuum_free(vacuum);
+  assert_rows_intact();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_vacuum_shrinks_table);
+  RUN_TEST(test_vacuum_compressed);
+  RUN_TEST(test_vacuum_steps);
+  return UNITY_END();
+}
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbms.h"
+#include "executor/executor.h"
+#include "executor/filter.h"
+#include "executor/seq_scan.h"
+#include "query.h"
+#include "ssdio.h"
+#include "unity.h"
+#include "zone_map.h"
+
+#define TEST_CATALOG_SIZE 6
+
+#define DB_PATH "test_zone_map.dat"
+#define ZONE_MAP_PATH DB_PATH ZONE_MAP_FILE_EXTENSION
+
+catalog_record_t test_catalog_records[TEST_CATALOG_SIZE] = {0};
+system_catalog_t test_system_catalog = {0};
+dbms_session_t* test_dbms_session = NULL;
+dbms_manager_t* test_dbms_manager = NULL;
+
+static void open_session() {
+  test_dbms_manager = dbms_init_dbms_manager();
+  test_dbms_session = dbms_init_dbms_session(DB_PATH);
+  dbms_add_session(test_dbms_manager, test_dbms_session);
+}
+
+static void close_session() {
+  dbms_free_dbms_manager(test_dbms_manager);
+  test_dbms_manager = NULL;
+  test_dbms_session = NULL;
+}
+
+void setUp() {
+  // Create a system catalog for testing
+  catalog_record_t test_catalog_records_temp[] = {
+      {"id", 4, ATTRIBUTE_TYPE_INT, 0},         {"name", 50, ATTRIBUTE_TYPE_STRING, 1},
+      {"salary", 4, ATTRIBUTE_TYPE_FLOAT, 2},   {"department", 30, ATTRIBUTE_TYPE_STRING, 3},
+      {"is_active", 1, ATTRIBUTE_TYPE_BOOL, 4}, {PADDING_NAME, 6, ATTRIBUTE_TYPE_UNUSED, 5}};
+
+  memcpy(test_catalog_records, test_catalog_records_temp, sizeof(test_catalog_records_temp));
+  uint16_t tuple_size = NULL_BYTE_SIZE;
+  for (size_t i = 0; i < sizeof(test_catalog_records_temp) / sizeof(catalog_record_t); i++) {
+    tuple_size += test_catalog_records[i].attribute_size;
+  }
+
+  test_system_catalog.records = test_catalog_records;
+  test_system_catalog.tuple_size = tuple_size;
+  test_system_catalog.record_count = sizeof(test_catalog_records_temp) / sizeof(catalog_record_t);
+
+  dbms_create_table(DB_PATH, &test_system_catalog);
+  open_session();
+}
+
+void tearDown() {
+  close_session();
+  remove(DB_PATH);
+  remove(ZONE_MAP_PATH);
+}
+
+static void insert_tuple(int id) {
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = id},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "TestName"},
+                                                    {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = (float)id / 2},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Engineering"},
+                                                    {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = true}};
+  TEST_ASSERT_NOT_NULL(dbms_insert_tuple(test_dbms_session, attrs));
+}
+
+static const zone_range_t* page_range(uint64_t page_id, uint8_t column) {
+  zone_map_t* zone_map = test_dbms_session->zone_map;
+  return &zone_map->ranges[(page_id - 1) * zone_map->column_count + column];
+}
+
+// Runs Filter -> SeqScan over the criteria and returns the number of matches
+static int scan_count(selection_criteria_t* criteria, uint64_t* pages_skipped) {
+  arena_t* arena = arena_create(0);
+  TEST_ASSERT_NOT_NULL(arena);
+  Operator* scan = seq_scan_create_for_criteria(test_dbms_session, criteria, arena);
+  TEST_ASSERT_NOT_NULL(scan);
+  Operator* filter = filter_create(scan, test_dbms_session, criteria, arena);
+  TEST_ASSERT_NOT_NULL(filter);
+
+  int count = 0;
+  OP_OPEN(filter);
+  while (OP_NEXT(filter) != NULL) {
+    count++;
+  }
+  *pages_skipped = ((SeqScanState*)scan->state)->pages_skipped;
+  OP_CLOSE(filter);
+  operator_free(filter);
+  arena_free(arena);
+  return count;
+}
+
+static void test_zone_map_tracks_ranges() {
+  zone_map_t* zone_map = test_dbms_session->zone_map;
+  TEST_ASSERT_NOT_NULL(zone_map);
+  // id and salary are tracked, the strings and the bool are not
+  TEST_ASSERT_EQUAL_UINT8(2, zone_map->column_count);
+  TEST_ASSERT_EQUAL_INT16(0, zone_map->attribute_columns[0]);
+  TEST_ASSERT_EQUAL_INT16(-1, zone_map->attribute_columns[1]);
+  TEST_ASSERT_EQUAL_INT16(1, zone_map->attribute_columns[2]);
+
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  int total = (int)(tuples_per_page * 3);
+  for (int i = 0; i < total; i++) {
+    insert_tuple(i);
+  }
+
+  TEST_ASSERT_EQUAL_UINT64(3, zone_map->page_count);
+  for (uint64_t page_id = 1; page_id <= 3; page_id++) {
+    double first = (double)((page_id - 1) * tuples_per_page);
+    TEST_ASSERT_EQUAL_UINT32(tuples_per_page, zone_map->tuple_counts[page_id - 1]);
+    TEST_ASSERT_EQUAL_FLOAT(first, page_range(page_id, 0)->min);
+    TEST_ASSERT_EQUAL_FLOAT(first + tuples_per_page - 1, page_range(page_id, 0)->max);
+    TEST_ASSERT_EQUAL_FLOAT(first / 2, page_range(page_id, 1)->min);
+  }
+}
+
+static void test_zone_map_skips_pages() {
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  int total = (int)(tuples_per_page * 10);
+  for (int i = 0; i < total; i++) {
+    insert_tuple(i);
+  }
+
+  // Only the last page can hold id >= total - 10
+  proposition_t props[2] = {
+      {.attribute_index = 0, .operator= OPERATOR_GREATER_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = total - 10}},
+      {.attribute_index = 1, .operator= OPERATOR_NOT_EQUAL, .value = {.type = ATTRIBUTE_TYPE_STRING, .string_value = "x"}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 2};
+  uint64_t pages_skipped = 0;
+  TEST_ASSERT_EQUAL_INT(10, scan_count(&criteria, &pages_skipped));
+  TEST_ASSERT_EQUAL_UINT64(9, pages_skipped);
+
+  uint64_t skipped_before = test_dbms_session->zone_map->pages_skipped;
+  query_result_t* result = query_select(test_dbms_session, &criteria);
+  TEST_ASSERT_NOT_NULL(result);
+  TEST_ASSERT_EQUAL_size_t(10, result->row_count);
+  query_free_query_result(result);
+  TEST_ASSERT_EQUAL_UINT64(9, test_dbms_session->zone_map->pages_skipped - skipped_before);
+
+  // Equality on a FLOAT, one page
+  proposition_t salary_props[1] = {
+      {.attribute_index = 2, .operator= OPERATOR_EQUAL, .value = {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = 100.5f}}};
+  selection_criteria_t salary_criteria = {.propositions = salary_props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(1, scan_count(&salary_criteria, &pages_skipped));
+  TEST_ASSERT_EQUAL_UINT64(9, pages_skipped);
+
+  // Nothing is skipped when every page can match
+  proposition_t all_props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_LESS_THAN, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = total}}};
+  selection_criteria_t all_criteria = {.propositions = all_props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT(total, scan_count(&all_criteria, &pages_skipped));
+  TEST_ASSERT_EQUAL_UINT64(0, pages_skipped);
+
+  // Deletes skip the pages too
+  TEST_ASSERT_EQUAL_INT(10, query_delete(test_dbms_session, &criteria));
+  TEST_ASSERT_EQUAL_INT(0, scan_count(&criteria, &pages_skipped));
+}
+
+static void test_zone_map_delete_and_update() {
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  for (int i = 0; i < (int)tuples_per_page; i++) {
+    insert_tuple(i);
+  }
+  zone_map_t* zone_map = test_dbms_session->zone_map;
+
+  // Deleting the max shrinks the range, deleting a middle value keeps it
+  TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = tuples_per_page - 1}));
+  TEST_ASSERT_EQUAL_FLOAT(tuples_per_page - 2, page_range(1, 0)->max);
+  TEST_ASSERT_TRUE(dbms_delete_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 5}));
+  TEST_ASSERT_EQUAL_FLOAT(0, page_range(1, 0)->min);
+  TEST_ASSERT_EQUAL_FLOAT(tuples_per_page - 2, page_range(1, 0)->max);
+  TEST_ASSERT_EQUAL_UINT32(tuples_per_page - 2, zone_map->tuple_counts[0]);
+
+  // Updating the min moves both ends
+  attribute_value_t attrs[TEST_CATALOG_SIZE - 1] = {{.type = ATTRIBUTE_TYPE_INT, .int_value = 1000},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Updated"},
+                                                    {.type = ATTRIBUTE_TYPE_FLOAT, .float_value = -1.0f},
+                                                    {.type = ATTRIBUTE_TYPE_STRING, .string_value = "Sales"},
+                                                    {.type = ATTRIBUTE_TYPE_BOOL, .bool_value = false}};
+  TEST_ASSERT_NOT_NULL(dbms_update_tuple(test_dbms_session, (tuple_id_t){.page_id = 1, .slot_id = 0}, attrs));
+  TEST_ASSERT_EQUAL_FLOAT(1, page_range(1, 0)->min);
+  TEST_ASSERT_EQUAL_FLOAT(1000, page_range(1, 0)->max);
+  TEST_ASSERT_EQUAL_FLOAT(-1, page_range(1, 1)->min);
+
+  // An emptied page is skipped by every scan
+  proposition_t props[1] = {
+      {.attribute_index = 0, .operator= OPERATOR_GREATER_EQUAL, .value = {.type = ATTRIBUTE_TYPE_INT, .int_value = 0}}};
+  selection_criteria_t criteria = {.propositions = props, .proposition_count = 1};
+  TEST_ASSERT_EQUAL_INT((int)tuples_per_page - 2, query_delete(test_dbms_session, &criteria));
+  TEST_ASSERT_EQUAL_UINT32(0, zone_map->tuple_counts[0]);
+  TEST_ASSERT_TRUE(zone_map_can_skip_page(zone_map, 1, NULL));
+  uint64_t pages_skipped = 0;
+  TEST_ASSERT_EQUAL_INT(0, scan_count(&criteria, &pages_skipped));
+  TEST_ASSERT_EQUAL_UINT64(1, pages_skipped);
+}
+
+static void test_zone_map_persists_across_sessions() {
+  uint64_t tuples_per_page = dbms_catalog_tuples_per_page(test_dbms_session->catalog);
+  for (int i = 0; i < (int)tuples_per_page * 2; i++) {
+    insert_tuple(i);
+  }
+  dbms_flush_buffer_pool(test_dbms_session);
+  TEST_ASSERT_TRUE(test_dbms_session->zone_map->is_clean);
+  close_session();
+
+  // Loaded from the synced file
+  open_session();
+  zone_map_t* zone_map = test_dbms_session->zone_map;
+  TEST_ASSERT_NOT_NULL(zone_map);
+  TEST_ASSERT_TRUE(zone_map->is_clean);
+  TEST_ASSERT_EQUAL_UINT64(2, zone_map->page_count);
+  TEST_ASSERT_EQUAL_FLOAT(tuples_per_page, page_range(2, 0)->min);
+  TEST_ASSERT_EQUAL_FLOAT(tuples_per_page * 2 - 1, page_range(2, 0)->max);
+
+  // A change marks the file stale on disk until the next sync
+  insert_tuple(-5);
+  TEST_ASSERT_FALSE(zone_map->is_clean);
+  int fd = ssdio_open(ZONE_MAP_PATH, false);
+  TEST_ASSERT_TRUE(fd >= 0);
+  page_t* page = aligned_alloc(PAGE_SIZE, sizeof(page_t));
+  TEST_ASSERT_NOT_NULL(page);
+  TEST_ASSERT_TRUE(ssdio_read_page(fd, 0, page));
+  zone_map_file_meta_t meta;
+  memcpy(&meta, page, sizeof(meta));
+  TEST_ASSERT_EQUAL_UINT8(0, meta.is_clean);
+  free(page);
+  ssdio_close(fd);
+  dbms_flush_buffer_pool(test_dbms_session);
+  close_session();
+
+  // Lost changes are never trusted: the file is stale, so it is rebuilt from the table
+  open_session();
+  insert_tuple(-10);
+  close_session();
+  open_session();
+  zone_map = test_dbms_session->zone_map;
+  TEST_ASSERT_NOT_NULL(zone_map);
+  TEST_ASSERT_EQUAL_UINT64(3, zone_map->page_count);
+  TEST_ASSERT_EQUAL_UINT32(1, zone_map->tuple_counts[2]);
+  TEST_ASSERT_EQUAL_FLOAT(-5, page_range(3, 0)->min);
+  TEST_ASSERT_EQUAL_FLOAT(-5, page_range(3, 0)->max);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_zone_map_tracks_ranges);
+  RUN_TEST(test_zone_map_skips_pages);
+  RUN_TEST(test_zone_map_delete_and_update);
+  RUN_TEST(test_zone_map_persists_across_sessions);
+  return UNITY_END();
+}